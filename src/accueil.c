@@ -1341,7 +1341,6 @@ static void update_liste_echeances_manuelles_accueil (gboolean force)
 		GtkWidget *label;
 		GtkWidget *vbox;
 		GSList *pointeur_liste;
-		gint manual = 1;
 
 		/* s'il y avait déjà un fils dans la frame, le détruit */
 		utils_container_remove_children (frame_etat_echeances_manuelles_accueil);
@@ -1362,9 +1361,8 @@ static void update_liste_echeances_manuelles_accueil (gboolean force)
 
 		gtk_widget_destroy (label);
 
-		pointeur_liste = g_slist_sort_with_data (scheduled_transactions_to_take,
-												 (GCompareDataFunc) classement_gslist_echeance_par_date,
-												 GINT_TO_POINTER (manual));
+		/* the list is already sorted by date by the index of the due dates */
+		pointeur_liste = scheduled_transactions_to_take;
 
 		while (pointeur_liste)
 		{
@@ -1500,9 +1498,10 @@ static void update_liste_echeances_auto_accueil (gboolean force)
 		gtk_container_add (GTK_CONTAINER (frame_etat_echeances_auto_accueil), vbox);
 		gtk_widget_show (vbox);
 
-		pointeur_liste = g_slist_sort_with_data (scheduled_transactions_taken,
-												 (GCompareDataFunc) classement_gslist_echeance_par_date,
-												 GINT_TO_POINTER (manual));
+		scheduled_transactions_taken = g_slist_sort_with_data (scheduled_transactions_taken,
+															   (GCompareDataFunc) classement_gslist_echeance_par_date,
+															   GINT_TO_POINTER (manual));
+		pointeur_liste = scheduled_transactions_taken;
 
 		while (pointeur_liste)
 		{
@@ -0,0 +1,651 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*     Copyright (C)         2026 Grisbi Development Team                     */
+/*             https://www.grisbi.org/                                         */
+/*                                                                            */
+/*  This program is free software; you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation; either version 2 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This program is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program; if not, see <https://www.gnu.org/licenses/>.     */
+/*                                                                            */
+/* ************************************************************************** */
+
+/**
+ * \file bet_consolidated.c
+ * forecast of a group of accounts, for example the accounts of a partial
+ * balance. The data of the accounts are read in the main thread, then the
+ * events of each account are developed and sorted in a thread pool and
+ * merged in one timeline with a combined balance.
+ */
+
+#include "config.h"
+
+#include "include.h"
+
+/*START_INCLUDE*/
+#include "bet_consolidated.h"
+#include "bet_data.h"
+#include "gsb_data_account.h"
+#include "gsb_data_currency_link.h"
+#include "gsb_data_partial_balance.h"
+#include "gsb_data_scheduled.h"
+#include "gsb_data_transaction.h"
+#include "gsb_scheduler.h"
+#include "structures.h"
+#include "utils_str.h"
+#include "erreur.h"
+/*END_INCLUDE*/
+
+typedef struct _BetConsolidatedJob			BetConsolidatedJob;
+typedef struct _BetConsolidatedScheduled	BetConsolidatedScheduled;
+
+/* opération planifiée dont les occurrences sont calculées par un thread */
+struct _BetConsolidatedScheduled
+{
+	GsbSchedulerRecurrence	recurrence;
+	gint					scheduled_number;
+	GsbReal					amount;				/* in the currency of the consolidation */
+};
+
+/* données d'un compte, lues dans le thread principal */
+struct _BetConsolidatedJob
+{
+	gint			account_number;
+	GsbReal			initial_balance;			/* in the currency of the account */
+	BetForecast *	forecast;					/* sorted by the thread */
+	GArray *		scheduled;					/* BetConsolidatedScheduled */
+	guint32			first_day;
+	guint32			last_day;
+};
+
+/*START_STATIC*/
+/*END_STATIC*/
+
+/*START_EXTERN*/
+/*END_EXTERN*/
+
+/******************************************************************************/
+/* Private functions                                                          */
+/******************************************************************************/
+/**
+ * convert an amount of an account in the currency of the consolidation
+ * with the link between the currencies, as the partial balances do
+ *
+ * \param amount
+ * \param account_number
+ * \param currency_number
+ *
+ * \return the converted amount
+ **/
+static GsbReal bet_consolidated_convert_amount (GsbReal amount,
+												gint account_number,
+												gint currency_number)
+{
+	gint account_currency;
+	gint link_number;
+
+	account_currency = gsb_data_account_get_currency (account_number);
+	if (amount.mantissa == 0 || account_currency == currency_number)
+		return amount;
+
+	link_number = gsb_data_currency_link_search (account_currency, currency_number);
+	if (!link_number)
+		return amount;
+
+	if (gsb_data_currency_link_get_first_currency (link_number) == account_currency)
+		return gsb_real_mul (amount, gsb_data_currency_link_get_change_rate (link_number));
+	else
+		return gsb_real_div (amount, gsb_data_currency_link_get_change_rate (link_number));
+}
+
+/**
+ * return the job of an account
+ *
+ * \param jobs
+ * \param account_number
+ *
+ * \return the job or NULL if the account is not consolidated
+ **/
+static BetConsolidatedJob *bet_consolidated_get_job (GPtrArray *jobs,
+													 gint account_number)
+{
+	guint i;
+
+	for (i = 0; i < jobs->len; i++)
+	{
+		BetConsolidatedJob *job;
+
+		job = g_ptr_array_index (jobs, i);
+		if (job->account_number == account_number)
+			return job;
+	}
+
+	return NULL;
+}
+
+/**
+ * add an occurrence to develop to the job of an account
+ *
+ * \param job
+ * \param scheduled_number
+ * \param amount
+ *
+ * \return
+ **/
+static void bet_consolidated_add_scheduled (BetConsolidatedJob *job,
+											gint scheduled_number,
+											GsbReal amount)
+{
+	BetConsolidatedScheduled scheduled;
+
+	if (!gsb_scheduler_recurrence_init (&scheduled.recurrence, scheduled_number))
+		return;
+
+	scheduled.scheduled_number = scheduled_number;
+	scheduled.amount = amount;
+	g_array_append_val (job->scheduled, scheduled);
+}
+
+/**
+ * read the transactions, the scheduled transactions and the future data of
+ * the consolidated accounts, in the same way as the array of forecast.
+ * the initial balance of each account is computed in the same walk of the
+ * transactions, with the same date, so a transaction is either in the
+ * initial balance or in the events
+ *
+ * \param jobs
+ * \param currency_number
+ * \param date_min
+ * \param date_max
+ *
+ * \return
+ **/
+static void bet_consolidated_collect_data (GPtrArray *jobs,
+										   gint currency_number,
+										   const GDate *date_min,
+										   const GDate *date_max)
+{
+	GHashTableIter iter;
+	gpointer key;
+	gpointer value;
+	GSList *tmp_list;
+	guint32 first_day;
+	guint32 last_day;
+	guint i;
+
+	first_day = g_date_get_julian (date_min);
+	last_day = g_date_get_julian (date_max);
+
+	/* transactions before the period and of the period */
+	tmp_list = gsb_data_transaction_get_complete_transactions_list ();
+	while (tmp_list)
+	{
+		BetConsolidatedJob *job;
+		const GDate *date;
+		gint transaction_number;
+		guint32 julian_day;
+		GsbReal amount;
+
+		transaction_number = gsb_data_transaction_get_transaction_number (tmp_list->data);
+		tmp_list = tmp_list->next;
+
+		job = bet_consolidated_get_job (jobs, gsb_data_transaction_get_account_number (transaction_number));
+		if (!job)
+			continue;
+
+		/* ignore splitted transactions */
+		if (gsb_data_transaction_get_split_of_transaction (transaction_number) == TRUE)
+			continue;
+
+		date = gsb_data_transaction_get_value_date_or_date (transaction_number);
+		if (!date || !g_date_valid (date))
+			continue;
+
+		julian_day = g_date_get_julian (date);
+		if (julian_day > last_day)
+			continue;
+
+		amount = bet_data_get_amount_in_account_currency (gsb_data_transaction_get_amount (transaction_number),
+														  job->account_number,
+														  transaction_number,
+														  SPP_ORIGIN_TRANSACTION);
+		if (julian_day < first_day)
+		{
+			job->initial_balance = gsb_real_add (job->initial_balance, amount);
+			continue;
+		}
+
+		bet_forecast_append_event (job->forecast,
+								   julian_day,
+								   SPP_ORIGIN_TRANSACTION,
+								   transaction_number,
+								   bet_consolidated_convert_amount (amount, job->account_number, currency_number),
+								   FALSE);
+	}
+
+	/* scheduled transactions, a transfer is in the two accounts */
+	tmp_list = gsb_data_scheduled_get_scheduled_list ();
+	while (tmp_list)
+	{
+		BetConsolidatedJob *job;
+		gint scheduled_number;
+		gint account_number;
+		GsbReal amount;
+
+		scheduled_number = gsb_data_scheduled_get_scheduled_number (tmp_list->data);
+		tmp_list = tmp_list->next;
+
+		/* ignore splitted transactions */
+		if (gsb_data_scheduled_get_split_of_scheduled (scheduled_number) == TRUE)
+			continue;
+
+		account_number = gsb_data_scheduled_get_account_number (scheduled_number);
+		job = bet_consolidated_get_job (jobs, account_number);
+		if (job)
+		{
+			amount = bet_data_get_amount_in_account_currency (gsb_data_scheduled_get_amount (scheduled_number),
+															  account_number,
+															  scheduled_number,
+															  SPP_ORIGIN_SCHEDULED);
+			bet_consolidated_add_scheduled (job,
+											scheduled_number,
+											bet_consolidated_convert_amount (amount, account_number, currency_number));
+		}
+
+		if (!gsb_data_scheduled_is_transfer (scheduled_number))
+			continue;
+
+		account_number = gsb_data_scheduled_get_account_number_transfer (scheduled_number);
+		job = bet_consolidated_get_job (jobs, account_number);
+		if (job)
+		{
+			amount = gsb_data_scheduled_get_adjusted_amount_for_currency (scheduled_number,
+																		  gsb_data_account_get_currency (account_number),
+																		  gsb_data_account_get_currency_floating_point (account_number));
+			bet_consolidated_add_scheduled (job,
+											scheduled_number,
+											bet_consolidated_convert_amount (gsb_real_opposite (amount),
+																			 account_number,
+																			 currency_number));
+		}
+	}
+
+	/* the initial balances in the currency of the consolidation */
+	for (i = 0; i < jobs->len; i++)
+	{
+		BetConsolidatedJob *job;
+
+		job = g_ptr_array_index (jobs, i);
+		job->forecast->initial_balance = bet_consolidated_convert_amount (job->initial_balance,
+																		  job->account_number,
+																		  currency_number);
+	}
+
+	/* future data, in the currency of their account */
+	if (!bet_data_future_get_list ())
+		return;
+
+	g_hash_table_iter_init (&iter, bet_data_future_get_list ());
+	while (g_hash_table_iter_next (&iter, &key, &value))
+	{
+		FuturData *future = (FuturData *) value;
+		BetConsolidatedJob *job;
+		guint32 julian_day;
+
+		julian_day = g_date_get_julian (future->date);
+		if (julian_day < first_day || julian_day > last_day)
+			continue;
+
+		job = bet_consolidated_get_job (jobs, future->account_number);
+		if (job)
+			bet_forecast_append_event (job->forecast,
+									   julian_day,
+									   SPP_ORIGIN_FUTURE,
+									   future->number,
+									   bet_consolidated_convert_amount (future->amount,
+																		future->account_number,
+																		currency_number),
+									   FALSE);
+
+		if (!future->is_transfert)
+			continue;
+
+		job = bet_consolidated_get_job (jobs, future->account_transfert);
+		if (job)
+			bet_forecast_append_event (job->forecast,
+									   julian_day,
+									   SPP_ORIGIN_FUTURE,
+									   future->number,
+									   bet_consolidated_convert_amount (gsb_real_opposite (future->amount),
+																		future->account_transfert,
+																		currency_number),
+									   FALSE);
+	}
+}
+
+/**
+ * GFunc of the thread pool : develop the scheduled transactions of an
+ * account, sort its events and compute its running balance. Only the job
+ * is used, the data of grisbi are not read here.
+ *
+ * \param data			the BetConsolidatedJob
+ * \param user_data		not used
+ *
+ * \return
+ **/
+static void bet_consolidated_job_run (gpointer data,
+									  gpointer user_data)
+{
+	BetConsolidatedJob *job = (BetConsolidatedJob *) data;
+	guint i;
+
+	for (i = 0; i < job->scheduled->len; i++)
+	{
+		BetConsolidatedScheduled *scheduled;
+		guint32 julian_day;
+
+		scheduled = &g_array_index (job->scheduled, BetConsolidatedScheduled, i);
+		julian_day = gsb_scheduler_recurrence_first_from (&scheduled->recurrence, job->first_day);
+		while (julian_day && julian_day <= job->last_day)
+		{
+			bet_forecast_append_event (job->forecast,
+									   julian_day,
+									   SPP_ORIGIN_SCHEDULED,
+									   scheduled->scheduled_number,
+									   scheduled->amount,
+									   FALSE);
+			julian_day = gsb_scheduler_recurrence_next (&scheduled->recurrence);
+		}
+	}
+
+	bet_forecast_sort (job->forecast);
+	bet_forecast_compute_balances (job->forecast, 0);
+}
+
+/**
+ * free a job and its forecast
+ *
+ * \param job
+ *
+ * \return
+ **/
+static void bet_consolidated_job_free (BetConsolidatedJob *job)
+{
+	bet_forecast_free (job->forecast);
+	g_array_free (job->scheduled, TRUE);
+	g_free (job);
+}
+
+/******************************************************************************/
+/* Public functions                                                           */
+/******************************************************************************/
+/**
+ * compute the forecast of a group of accounts between two dates. The
+ * initial balance is the sum of the balances of the accounts the day before
+ * date_min, by value date as the events, and all the amounts are in
+ * currency_number.
+ *
+ * \param accounts
+ * \param nb_accounts
+ * \param currency_number
+ * \param date_min
+ * \param date_max
+ *
+ * \return a new BetConsolidated to free with bet_consolidated_free
+ **/
+BetConsolidated *bet_consolidated_new (const gint *accounts,
+									   guint nb_accounts,
+									   gint currency_number,
+									   const GDate *date_min,
+									   const GDate *date_max)
+{
+	BetConsolidated *consolidated;
+	BetForecast **forecasts;
+	GPtrArray *jobs;
+	GArray *sources;
+	GThreadPool *pool = NULL;
+	guint i;
+
+	devel_debug_int (nb_accounts);
+	jobs = g_ptr_array_new_with_free_func ((GDestroyNotify) bet_consolidated_job_free);
+	for (i = 0; i < nb_accounts; i++)
+	{
+		BetConsolidatedJob *job;
+
+		if (bet_consolidated_get_job (jobs, accounts[i]))
+			continue;
+
+		job = g_malloc0 (sizeof (BetConsolidatedJob));
+		job->account_number = accounts[i];
+		job->initial_balance = gsb_data_account_get_init_balance (accounts[i],
+																  gsb_data_account_get_currency_floating_point
+																  (accounts[i]));
+		job->forecast = bet_forecast_new (null_real, SPP_ORIGIN_SOLDE, 0);
+		job->scheduled = g_array_new (FALSE, FALSE, sizeof (BetConsolidatedScheduled));
+		job->first_day = g_date_get_julian (date_min);
+		job->last_day = g_date_get_julian (date_max);
+		g_ptr_array_add (jobs, job);
+	}
+
+	bet_consolidated_collect_data (jobs, currency_number, date_min, date_max);
+
+	/* one account per thread, the jobs are done here if there is no pool */
+	if (jobs->len > 1)
+		pool = g_thread_pool_new (bet_consolidated_job_run,
+								  NULL,
+								  (gint) MIN (jobs->len, g_get_num_processors ()),
+								  FALSE,
+								  NULL);
+	for (i = 0; i < jobs->len; i++)
+	{
+		if (pool)
+			g_thread_pool_push (pool, g_ptr_array_index (jobs, i), NULL);
+		else
+			bet_consolidated_job_run (g_ptr_array_index (jobs, i), NULL);
+	}
+	if (pool)
+		g_thread_pool_free (pool, FALSE, TRUE);
+
+	/* one timeline for all the accounts */
+	forecasts = g_new (BetForecast *, jobs->len);
+	for (i = 0; i < jobs->len; i++)
+		forecasts[i] = ((BetConsolidatedJob *) g_ptr_array_index (jobs, i))->forecast;
+
+	sources = g_array_new (FALSE, FALSE, sizeof (guint));
+	consolidated = g_malloc0 (sizeof (BetConsolidated));
+	consolidated->forecast = bet_forecast_merge (forecasts, jobs->len, sources);
+	consolidated->accounts = g_array_sized_new (FALSE, FALSE, sizeof (gint), sources->len);
+	consolidated->currency_number = currency_number;
+	for (i = 0; i < sources->len; i++)
+	{
+		BetConsolidatedJob *job;
+
+		job = g_ptr_array_index (jobs, g_array_index (sources, guint, i));
+		g_array_append_val (consolidated->accounts, job->account_number);
+	}
+
+	g_array_free (sources, TRUE);
+	g_free (forecasts);
+	g_ptr_array_free (jobs, TRUE);
+
+	return consolidated;
+}
+
+/**
+ * compute the forecast of the accounts of a partial balance, in the
+ * currency of the partial balance
+ *
+ * \param partial_balance_number
+ * \param date_min
+ * \param date_max
+ *
+ * \return a new BetConsolidated to free with bet_consolidated_free or NULL
+ **/
+BetConsolidated *bet_consolidated_new_for_partial_balance (gint partial_balance_number,
+														   const GDate *date_min,
+														   const GDate *date_max)
+{
+	BetConsolidated *consolidated;
+	GArray *accounts;
+	const gchar *liste_cptes;
+	gchar **tab;
+	gint i;
+
+	liste_cptes = gsb_data_partial_balance_get_liste_cptes (partial_balance_number);
+	if (liste_cptes == NULL || strlen (liste_cptes) == 0)
+		return NULL;
+
+	accounts = g_array_new (FALSE, FALSE, sizeof (gint));
+	tab = g_strsplit (liste_cptes, ";", 0);
+	for (i = 0; tab[i]; i++)
+	{
+		gint account_number;
+
+		account_number = utils_str_atoi (tab[i]);
+		g_array_append_val (accounts, account_number);
+	}
+	g_strfreev (tab);
+
+	consolidated = bet_consolidated_new ((const gint *) accounts->data,
+										 accounts->len,
+										 gsb_data_partial_balance_get_currency (partial_balance_number),
+										 date_min,
+										 date_max);
+	g_array_free (accounts, TRUE);
+
+	return consolidated;
+}
+
+/**
+ * return the combined balance at the end of the consolidated forecast
+ *
+ * \param consolidated
+ *
+ * \return the balance after the last event
+ **/
+GsbReal bet_consolidated_get_final_balance (BetConsolidated *consolidated)
+{
+	guint nb_events;
+
+	nb_events = bet_forecast_get_nb_events (consolidated->forecast);
+	if (nb_events == 0)
+		return consolidated->forecast->initial_balance;
+
+	return bet_forecast_get_event (consolidated->forecast, nb_events - 1)->balance;
+}
+
+/**
+ * return the lowest combined balance of the consolidated forecast
+ *
+ * \param consolidated
+ * \param julian_day		if not NULL, set to the day of the lowest balance,
+ *						0 if it is the initial balance
+ *
+ * \return the lowest balance
+ **/
+GsbReal bet_consolidated_get_minimum_balance (BetConsolidated *consolidated,
+											  guint32 *julian_day)
+{
+	GsbReal min_balance;
+	guint32 min_day = 0;
+	guint nb_events;
+	guint i;
+
+	min_balance = consolidated->forecast->initial_balance;
+	nb_events = bet_forecast_get_nb_events (consolidated->forecast);
+	for (i = 0; i < nb_events; i++)
+	{
+		BetForecastEvent *event;
+
+		event = bet_forecast_get_event (consolidated->forecast, i);
+		if (gsb_real_cmp (event->balance, min_balance) < 0)
+		{
+			min_balance = event->balance;
+			min_day = event->julian_day;
+		}
+	}
+
+	if (julian_day)
+		*julian_day = min_day;
+
+	return min_balance;
+}
+
+/**
+ * return the first partial balance which contains the account
+ *
+ * \param account_number
+ *
+ * \return the number of the partial balance or 0
+ **/
+gint bet_consolidated_get_partial_balance_of_account (gint account_number)
+{
+	GSList *tmp_list;
+
+	tmp_list = gsb_data_partial_balance_get_list ();
+	while (tmp_list)
+	{
+		const gchar *liste_cptes;
+		gint partial_balance_number;
+
+		partial_balance_number = gsb_data_partial_balance_get_number (tmp_list->data);
+		tmp_list = tmp_list->next;
+
+		liste_cptes = gsb_data_partial_balance_get_liste_cptes (partial_balance_number);
+		if (liste_cptes && strlen (liste_cptes))
+		{
+			gchar **tab;
+			gint i;
+
+			tab = g_strsplit (liste_cptes, ";", 0);
+			for (i = 0; tab[i]; i++)
+			{
+				if (utils_str_atoi (tab[i]) == account_number)
+				{
+					g_strfreev (tab);
+
+					return partial_balance_number;
+				}
+			}
+			g_strfreev (tab);
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * free a consolidated forecast
+ *
+ * \param consolidated
+ *
+ * \return
+ **/
+void bet_consolidated_free (BetConsolidated *consolidated)
+{
+	if (!consolidated)
+		return;
+
+	bet_forecast_free (consolidated->forecast);
+	g_array_free (consolidated->accounts, TRUE);
+	g_free (consolidated);
+}
+
+/**
+ *
+ *
+ * \param
+ *
+ * \return
+ **/
+/* Local Variables: */
+/* c-basic-offset: 4 */
+/* End: */
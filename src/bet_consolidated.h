@@ -0,0 +1,36 @@
+#ifndef _BET_CONSOLIDATED_H
+#define _BET_CONSOLIDATED_H
+
+#include <glib.h>
+
+/* START_INCLUDE_H */
+#include "bet_forecast.h"
+/* END_INCLUDE_H */
+
+typedef struct _BetConsolidated				BetConsolidated;
+
+/* prévision consolidée d'un groupe de comptes */
+struct _BetConsolidated
+{
+	BetForecast *	forecast;					/* events of all the accounts with the combined balance */
+	GArray *		accounts;					/* account number of each event of forecast */
+	gint			currency_number;			/* currency of the amounts */
+};
+
+/* START_DECLARATION */
+void				bet_consolidated_free				(BetConsolidated *consolidated);
+GsbReal				bet_consolidated_get_final_balance	(BetConsolidated *consolidated);
+GsbReal				bet_consolidated_get_minimum_balance	(BetConsolidated *consolidated,
+															 guint32 *julian_day);
+gint				bet_consolidated_get_partial_balance_of_account	(gint account_number);
+BetConsolidated *	bet_consolidated_new				(const gint *accounts,
+														 guint nb_accounts,
+														 gint currency_number,
+														 const GDate *date_min,
+														 const GDate *date_max);
+BetConsolidated *	bet_consolidated_new_for_partial_balance	(gint partial_balance_number,
+																 const GDate *date_min,
+																 const GDate *date_max);
+/* END_DECLARATION */
+
+#endif
@@ -372,7 +372,7 @@ static void bet_data_hist_set_account_number (gpointer key,
  * \return
  **/
 static gboolean bet_data_hist_update_data (HistData *shd,
-										   gint transaction_number,
+										   gint account_number,
 										   gint sub_div,
 										   gint type_de_transaction,
 										   GsbReal amount)
@@ -401,15 +401,15 @@ static gboolean bet_data_hist_update_data (HistData *shd,
 	key = utils_str_itoa (sub_div);
 	if ((tmp_shd = g_hash_table_lookup (shd->sub_div_list, key)))
 	{
-		bet_data_hist_update_data (tmp_shd, transaction_number, -1, type_de_transaction, amount);
+		bet_data_hist_update_data (tmp_shd, account_number, -1, type_de_transaction, amount);
 		g_free (key);
 	}
 	else
 	{
 		tmp_shd = bet_data_hist_struct_init ();
 		tmp_shd->div_number = sub_div;
-		tmp_shd->account_nb = gsb_data_transaction_get_account_number (transaction_number);
-		bet_data_hist_update_data (tmp_shd, transaction_number, -1, type_de_transaction, amount);
+		tmp_shd->account_nb = account_number;
+		bet_data_hist_update_data (tmp_shd, account_number, -1, type_de_transaction, amount);
 		g_hash_table_insert (shd->sub_div_list, key, tmp_shd);
 	}
 
@@ -534,21 +534,21 @@ gint bet_data_get_selected_currency (void)
 }
 
 /**
+ * return the amount of a line of the array of forecast in the currency
+ * of the account
  *
+ * \param amount
+ * \param account_number
+ * \param line_number		transaction or scheduled number, currency for SPP_ORIGIN_ACCOUNT
+ * \param origin
  *
- * \param
- * \param
- * \param
- * \param
- *
- * \return
+ * \return the amount
  **/
-gchar *bet_data_get_str_amount_in_account_currency (GsbReal amount,
-													gint account_number,
-													gint line_number,
-													gint origin)
+GsbReal bet_data_get_amount_in_account_currency (GsbReal amount,
+												 gint account_number,
+												 gint line_number,
+												 gint origin)
 {
-	gchar *str_amount = NULL;
 	gint account_currency;
 	gint floating_point;
 	GsbReal new_amount = {0, 0};
@@ -584,9 +584,7 @@ gchar *bet_data_get_str_amount_in_account_currency (GsbReal amount,
 		break;
 	}
 
-	str_amount = utils_real_get_string (new_amount);
-
-	return str_amount;
+	return new_amount;
 }
 
 /**
@@ -1401,7 +1399,7 @@ gboolean bet_data_future_remove_line (gint account_number,
 
 	if (maj)
 	{
-		gsb_data_account_set_bet_maj (account_number, BET_MAJ_ESTIMATE);
+		bet_array_mark_source_changed (account_number, SPP_ORIGIN_FUTURE, number);
 		bet_data_update_bet_module (account_number, GSB_ESTIMATE_PAGE);
 	}
 
@@ -1764,58 +1762,44 @@ void bet_data_hist_div_insert (HistData *shd,
 }
 
 /**
- * Ajoute les données de la transaction à la division et la sous division
+ * Ajoute un montant à la division et la sous division
  * création des nouvelles divisions et si existantes ajout des données
  * par appel à bet_data_hist_update_data ()
  *
- * \param
- * \param
- * \param
- * \param
- * \param
+ * \param account_number		compte de l'opération ou des opérations
+ * \param div
+ * \param sub_div
+ * \param amount
+ * \param type_de_transaction
+ * \param list_div
  *
  * \return
 **/
-gboolean bet_data_hist_div_populate (gint transaction_number,
-									 gboolean is_transaction,
-									 GHashTable  *list_div,
+gboolean bet_data_hist_div_populate (gint account_number,
+									 gint div,
+									 gint sub_div,
+									 GsbReal amount,
 									 gint type_de_transaction,
-									 TransactionCurrentFyear *tcf)
+									 GHashTable  *list_div)
 {
-	gint div = 0;
-	gint sub_div = 0;
 	gchar *key;
 	HistData *shd = NULL;
-	GsbReal amount;
 
-	div = ptr_div (transaction_number, is_transaction);
-	if (div > 0)
-		sub_div = ptr_sub_div (transaction_number, is_transaction);
-	else
+	if (div <= 0)
 		return FALSE;
 
-	amount = gsb_data_transaction_get_amount (transaction_number);
-
-	/* on complète la structure tcf pour les graphiques */
-	if (tcf)
-	{
-		tcf->div_nb = div;
-		tcf->sub_div_nb = sub_div;
-		tcf->amount = amount;
-	}
-
 	key = utils_str_itoa (div);
 	if ((shd = g_hash_table_lookup (list_div, key)))
 	{
-		bet_data_hist_update_data (shd, transaction_number, sub_div, type_de_transaction, amount);
+		bet_data_hist_update_data (shd, account_number, sub_div, type_de_transaction, amount);
 		g_free (key);
 	}
 	else
 	{
 		shd = bet_data_hist_struct_init ();
 		shd->div_number = div;
-		shd->account_nb = gsb_data_transaction_get_account_number (transaction_number);
-		bet_data_hist_update_data (shd, transaction_number, sub_div, type_de_transaction, amount);
+		shd->account_nb = account_number;
+		bet_data_hist_update_data (shd, account_number, sub_div, type_de_transaction, amount);
 		g_hash_table_insert (list_div, key, shd);
 	}
 
@@ -117,6 +117,9 @@ enum BetEstimationTreeColumns
 	SPP_ESTIMATE_TREE_BALANCE_COLOR,
 	SPP_ESTIMATE_TREE_BACKGROUND_COLOR,
 	SPP_ESTIMATE_TREE_COLOR_STRING,
+	SPP_ESTIMATE_TREE_AMOUNT_MANTISSA,			/* the amount as a number : mantissa */
+	SPP_ESTIMATE_TREE_AMOUNT_EXPONENT,			/* the amount as a number : exponent */
+	SPP_ESTIMATE_TREE_EVENT_KEY,				/* key of the event of the line in the forecast */
 	SPP_ESTIMATE_TREE_NUM_COLUMNS
 };
 
@@ -144,6 +147,10 @@ enum BetHistoricalTreeColumns {
 /* START_DECLARATION */
 void						bet_data_bet_range_struct_free					(BetRange *sbr);
 BetRange *					bet_data_bet_range_struct_init 					(void);
+GsbReal						bet_data_get_amount_in_account_currency			(GsbReal amount,
+																			 gint account_number,
+																			 gint line_number,
+																			 gint origin);
 gchar *						bet_data_get_div_name 							(gint div_num,
 																			 gint sub_div,
 																			 const gchar *return_value_error);
@@ -151,10 +158,6 @@ gint 						bet_data_get_div_number 						(gint transaction_number,
 																			 gboolean is_transaction);
 gint 						bet_data_get_div_type 							(gint div_number);
 gint 						bet_data_get_selected_currency 					(void);
-gchar *						bet_data_get_str_amount_in_account_currency		(GsbReal amount,
-																			 gint account_number,
-																			 gint line_number,
-																			 gint origin);
 GPtrArray *					bet_data_get_strings_to_save 					(void);
 gint 						bet_data_get_sub_div_nb 						(gint transaction_number,
 																			 gboolean is_transaction);
@@ -211,11 +214,12 @@ gboolean 					bet_data_hist_div_add 							(gint account_number,
 																			 gint sub_div_nb);
 void 						bet_data_hist_div_insert 						(HistData *shd,
 																			 HistData *sub_shd);
-gboolean 					bet_data_hist_div_populate 						(gint transaction_number,
-																			 gboolean is_transaction,
-																			 GHashTable  *list_div,
+gboolean 					bet_data_hist_div_populate 						(gint account_number,
+																			 gint div,
+																			 gint sub_div,
+																			 GsbReal amount,
 																			 gint type_de_transaction,
-																			 TransactionCurrentFyear *tcf);
+																			 GHashTable  *list_div);
 gboolean 					bet_data_hist_div_remove 						(gint account_number,
 																			 gint div_number,
 																			 gint sub_div_nb);
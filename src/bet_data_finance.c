@@ -39,14 +39,223 @@
 
 /*START_STATIC*/
 static GSList *bet_loan_list = NULL;
+
+/* tableaux d'amortissement déjà calculés, la clé est le BetFinanceSchedule dont le cache a une référence */
+static GHashTable *bet_schedule_cache = NULL;
 /*END_STATIC*/
 
+/* nombre maximum de tableaux d'amortissement gardés en cache */
+#define BET_SCHEDULE_CACHE_SIZE 64
+
 /*START_EXTERN*/
 /*END_EXTERN*/
 
 /******************************************************************************/
 /* Private functions                                                          */
 /******************************************************************************/
+/**
+ * arrondit un montant exprimé en plus petites unités de la devise à
+ * l'entier le plus proche, la moitié étant arrondie en s'éloignant de zéro
+ *
+ * \param units
+ *
+ * \return the mantissa of the amount
+ **/
+static gint64 bet_data_finance_round_units (gdouble units)
+{
+	if (units < 0)
+		return - (gint64) floor (- units + 0.5);
+	else
+		return (gint64) floor (units + 0.5);
+}
+
+/**
+ * retourne la mantisse d'un montant à l'exposant demandé
+ *
+ * \param amount
+ * \param exponent
+ *
+ * \return the mantissa, rounded with bet_data_finance_round_units
+ **/
+static gint64 bet_data_finance_get_mantissa (gdouble amount,
+											 gint exponent)
+{
+	return bet_data_finance_round_units (amount * pow (10, exponent));
+}
+
+/**
+ * GHashFunc du cache des tableaux d'amortissement
+ *
+ * \param key		a BetFinanceSchedule
+ *
+ * \return
+ **/
+static guint bet_data_finance_schedule_hash (gconstpointer key)
+{
+	const BetFinanceSchedule *schedule = (const BetFinanceSchedule *) key;
+	guint hash;
+
+	hash = g_int64_hash (&schedule->capital);
+	hash = hash * 31 + (guint) schedule->exponent;
+	hash = hash * 31 + g_int64_hash (&schedule->frais);
+	hash = hash * 31 + g_double_hash (&schedule->taux_periodique);
+	hash = hash * 31 + (guint) schedule->nbre_echeances;
+
+	return hash;
+}
+
+/**
+ * GEqualFunc du cache des tableaux d'amortissement
+ *
+ * \param key_a
+ * \param key_b
+ *
+ * \return TRUE if the loan parameters are the same
+ **/
+static gboolean bet_data_finance_schedule_equal (gconstpointer key_a,
+												 gconstpointer key_b)
+{
+	const BetFinanceSchedule *schedule_a = (const BetFinanceSchedule *) key_a;
+	const BetFinanceSchedule *schedule_b = (const BetFinanceSchedule *) key_b;
+
+	return schedule_a->capital == schedule_b->capital
+		&& schedule_a->exponent == schedule_b->exponent
+		&& schedule_a->frais == schedule_b->frais
+		&& schedule_a->taux_periodique == schedule_b->taux_periodique
+		&& schedule_a->nbre_echeances == schedule_b->nbre_echeances;
+}
+
+/**
+ * GDestroyNotify du cache : le tableau n'est libéré qu'avec sa dernière référence
+ *
+ * \param data		a BetFinanceSchedule
+ *
+ * \return
+ **/
+static void bet_data_finance_schedule_destroy (gpointer data)
+{
+	bet_data_finance_schedule_unref ((BetFinanceSchedule *) data);
+}
+
+/**
+ * calcule le tableau d'amortissement complet à l'exposant du tableau :
+ * échéance constante hors frais, la dernière échéance solde le capital
+ * restant du. Chaque montant est arrondi au plus proche, la moitié en
+ * s'éloignant de zéro.
+ *
+ * \param schedule		capital, frais, taux_periodique, nbre_echeances and exponent are set
+ *
+ * \return
+ **/
+static void bet_data_finance_schedule_compute (BetFinanceSchedule *schedule)
+{
+	gint64 capital_du;
+	gint64 cost = 0;
+	gdouble taux_periodique;
+	gint nbre_echeances;
+	gint i;
+
+	taux_periodique = schedule->taux_periodique;
+	nbre_echeances = schedule->nbre_echeances;
+
+	if (taux_periodique < GSB_EPSILON)
+		schedule->echeance = bet_data_finance_round_units ((gdouble) schedule->capital / nbre_echeances);
+	else
+	{
+		gdouble coeff;
+
+		coeff = pow ((1 + taux_periodique), nbre_echeances);
+		schedule->echeance = bet_data_finance_round_units ((schedule->capital * taux_periodique * coeff)
+														   / (coeff - 1));
+	}
+
+	/* un seul bloc pour les trois tableaux */
+	schedule->interets = g_new (gint64, 3 * nbre_echeances);
+	schedule->principal = schedule->interets + nbre_echeances;
+	schedule->capital_du = schedule->principal + nbre_echeances;
+
+	capital_du = schedule->capital;
+	for (i = 0; i < nbre_echeances; i++)
+	{
+		schedule->capital_du[i] = capital_du;
+		schedule->interets[i] = bet_data_finance_round_units (capital_du * taux_periodique);
+
+		if (i == nbre_echeances - 1)
+			schedule->principal[i] = capital_du;
+		else
+			schedule->principal[i] = schedule->echeance - schedule->interets[i];
+
+		capital_du -= schedule->principal[i];
+		cost += schedule->interets[i];
+	}
+
+	i = nbre_echeances - 1;
+	schedule->last_echeance = schedule->principal[i] + schedule->interets[i] + schedule->frais;
+	schedule->total_cost = cost + schedule->frais * nbre_echeances;
+}
+
+/**
+ * retourne le tableau d'amortissement du cache ou le calcule. Quand le
+ * cache est plein il est vidé, les tableaux encore utilisés restent
+ * valides jusqu'à leur dernière référence.
+ *
+ * \param capital			mantissa at exponent
+ * \param taux_periodique
+ * \param frais				fees by installment, mantissa at exponent
+ * \param nbre_echeances
+ * \param exponent
+ *
+ * \return a new reference to the schedule or NULL
+ **/
+static BetFinanceSchedule *bet_data_finance_schedule_lookup (gint64 capital,
+															 gdouble taux_periodique,
+															 gint64 frais,
+															 gint nbre_echeances,
+															 gint exponent)
+{
+	BetFinanceSchedule key;
+	BetFinanceSchedule *schedule;
+
+	if (nbre_echeances <= 0)
+		return NULL;
+
+	if (!bet_schedule_cache)
+		bet_schedule_cache = g_hash_table_new_full (bet_data_finance_schedule_hash,
+													bet_data_finance_schedule_equal,
+													bet_data_finance_schedule_destroy,
+													NULL);
+
+	key.exponent = exponent;
+	key.capital = capital;
+	key.taux_periodique = taux_periodique;
+	key.frais = frais;
+	key.nbre_echeances = nbre_echeances;
+
+	schedule = g_hash_table_lookup (bet_schedule_cache, &key);
+	if (schedule)
+	{
+		schedule->ref_count++;
+
+		return schedule;
+	}
+
+	if (g_hash_table_size (bet_schedule_cache) >= BET_SCHEDULE_CACHE_SIZE)
+		g_hash_table_remove_all (bet_schedule_cache);
+
+	schedule = g_malloc0 (sizeof (BetFinanceSchedule));
+	schedule->ref_count = 2;				/* the cache and the caller */
+	schedule->exponent = exponent;
+	schedule->capital = capital;
+	schedule->taux_periodique = taux_periodique;
+	schedule->frais = frais;
+	schedule->nbre_echeances = nbre_echeances;
+	bet_data_finance_schedule_compute (schedule);
+
+	g_hash_table_add (bet_schedule_cache, schedule);
+
+	return schedule;
+}
+
 /******************************************************************************/
 /* Public functions                                                           */
 /******************************************************************************/
@@ -241,41 +450,120 @@ GDate *bet_data_finance_get_date_last_installment_paid (GDate *date_depart)
  **/
 gdouble bet_data_finance_get_total_cost (EcheanceStruct *s_echeance)
 {
-    gdouble capital_du;
-    gdouble cost;
-    gdouble echeance = 0.0;
-    gdouble interets;
-    gdouble principal;
-    gint index;
+    BetFinanceSchedule *schedule;
+    gdouble total_cost;
 
+    schedule = bet_data_finance_schedule_get (s_echeance->capital,
+                                              s_echeance->taux_periodique,
+                                              s_echeance->frais,
+                                              s_echeance->nbre_echeances,
+                                              gsb_data_currency_get_floating_point (s_echeance->devise));
+    if (!schedule)
+        return 0.0;
 
-    capital_du = s_echeance->capital;
+    total_cost = gsb_real_real_to_double (gsb_real_new (schedule->total_cost, schedule->exponent));
+    bet_data_finance_schedule_unref (schedule);
 
-    for (index = 1; index <= s_echeance->nbre_echeances; index++)
-    {
-        interets = bet_data_finance_get_interets (capital_du, s_echeance->taux_periodique);
-
-        if (index == s_echeance->nbre_echeances)
-        {
-            echeance = bet_data_finance_get_last_echeance (
-                        capital_du,
-                        interets,
-                        s_echeance->frais);
-            principal = capital_du;
-        }
-        else
-            principal = bet_data_finance_get_principal (
-                        s_echeance->total_echeance,
-                        interets,
-                        s_echeance->frais);
-
-        capital_du -= principal;
-    }
+    return total_cost;
+}
+
+/**
+ * vide le cache des tableaux d'amortissement, les tableaux encore
+ * utilisés restent valides jusqu'à leur dernière référence
+ *
+ * \param
+ *
+ * \return
+ **/
+void bet_data_finance_schedule_cache_clear (void)
+{
+	if (bet_schedule_cache)
+	{
+		g_hash_table_destroy (bet_schedule_cache);
+		bet_schedule_cache = NULL;
+	}
+}
+
+/**
+ * retourne le tableau d'amortissement d'un prêt à échéances constantes,
+ * calculé une seule fois par jeu de paramètres
+ *
+ * \param capital
+ * \param taux_periodique
+ * \param frais				frais par échéance
+ * \param nbre_echeances
+ * \param exponent			nombre de décimales des montants, celui de la devise
+ *
+ * \return a reference to the schedule to release with bet_data_finance_schedule_unref, or NULL
+ **/
+BetFinanceSchedule *bet_data_finance_schedule_get (gdouble capital,
+												   gdouble taux_periodique,
+												   gdouble frais,
+												   gint nbre_echeances,
+												   gint exponent)
+{
+	return bet_data_finance_schedule_lookup (bet_data_finance_get_mantissa (capital, exponent),
+											 taux_periodique,
+											 bet_data_finance_get_mantissa (frais, exponent),
+											 nbre_echeances,
+											 exponent);
+}
+
+/**
+ * calcule en une fois les tableaux d'amortissement de la grille des durées
+ * du simulateur, les frais par échéance sont communs à toutes les durées
+ *
+ * \param capital
+ * \param taux_periodique
+ * \param taux_frais			taux annuel des frais
+ * \param nbre_echeances		the durations of the grid
+ * \param nb_durations
+ * \param exponent			nombre de décimales des montants, celui de la devise
+ * \param schedules			filled with nb_durations references, to release with bet_data_finance_schedule_unref
+ *
+ * \return
+ **/
+void bet_data_finance_schedule_get_grid (gdouble capital,
+										 gdouble taux_periodique,
+										 gdouble taux_frais,
+										 const gint *nbre_echeances,
+										 guint nb_durations,
+										 gint exponent,
+										 BetFinanceSchedule **schedules)
+{
+	gint64 capital_mantissa;
+	gint64 frais;
+	guint i;
+
+	capital_mantissa = bet_data_finance_get_mantissa (capital, exponent);
+	frais = bet_data_finance_get_mantissa (capital * taux_frais / 100 / 12, exponent);
+
+	for (i = 0; i < nb_durations; i++)
+		schedules[i] = bet_data_finance_schedule_lookup (capital_mantissa,
+														 taux_periodique,
+														 frais,
+														 nbre_echeances[i],
+														 exponent);
+}
 
-    cost = (s_echeance->total_echeance * (s_echeance->nbre_echeances - 1))
-                        + echeance - s_echeance->capital;
+/**
+ * libère une référence à un tableau d'amortissement
+ *
+ * \param schedule
+ *
+ * \return
+ **/
+void bet_data_finance_schedule_unref (BetFinanceSchedule *schedule)
+{
+	if (!schedule)
+		return;
 
-    return cost;
+	schedule->ref_count--;
+	if (schedule->ref_count > 0)
+		return;
+
+	g_free (schedule->interets);
+	g_free (schedule);
 }
 
 /**
@@ -332,6 +620,8 @@ void bet_data_finance_data_simulator_init (void)
     w_etat->bet_index_duree = 0;
     w_etat->bet_frais = 0;
     w_etat->bet_type_taux = 1;
+
+	bet_data_finance_schedule_cache_clear ();
 }
 
 /**
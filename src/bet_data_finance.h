@@ -10,6 +10,7 @@
 #define BET_TAUX_DIGITS 3
 #define BET_PERCENTAGE_FEES_DIGITS 5
 typedef struct _AmortissementStruct		AmortissementStruct;
+typedef struct _BetFinanceSchedule		BetFinanceSchedule;
 typedef struct _EcheanceStruct			EcheanceStruct;
 typedef struct _LoanStruct				LoanStruct;
 
@@ -29,6 +30,23 @@ struct _AmortissementStruct {
     gchar *str_frais;
 };
 
+/* tableau d'amortissement complet d'un prêt à échéances constantes,
+ * montants en mantisses de GsbReal à l'exposant exponent */
+struct _BetFinanceSchedule {
+    gint ref_count;
+    gint exponent;                  /* nombre de décimales des montants */
+    gint64 capital;
+    gdouble taux_periodique;
+    gint64 frais;                   /* frais par échéance */
+    gint nbre_echeances;
+    gint64 echeance;                /* échéance hors frais */
+    gint64 last_echeance;           /* dernière échéance frais compris */
+    gint64 total_cost;              /* intérêts et frais */
+    gint64 *interets;               /* nbre_echeances values */
+    gint64 *principal;              /* nbre_echeances values */
+    gint64 *capital_du;             /* nbre_echeances values, capital du avant l'échéance */
+};
+
 /* structure échéance */
 struct _EcheanceStruct {
     gint duree;
@@ -94,6 +112,20 @@ gdouble 				bet_data_finance_get_principal 						(gdouble echeance,
 gdouble 				bet_data_finance_get_taux_periodique 				(gdouble taux,
 																			 gint type_taux);
 gdouble 				bet_data_finance_get_total_cost 					(EcheanceStruct *s_echeance);
+void					bet_data_finance_schedule_cache_clear				(void);
+BetFinanceSchedule *	bet_data_finance_schedule_get						(gdouble capital,
+																			 gdouble taux_periodique,
+																			 gdouble frais,
+																			 gint nbre_echeances,
+																			 gint exponent);
+void					bet_data_finance_schedule_get_grid					(gdouble capital,
+																			 gdouble taux_periodique,
+																			 gdouble taux_frais,
+																			 const gint *nbre_echeances,
+																			 guint nb_durations,
+																			 gint exponent,
+																			 BetFinanceSchedule **schedules);
+void					bet_data_finance_schedule_unref						(BetFinanceSchedule *schedule);
 void 					bet_data_finance_structure_amortissement_free 		(AmortissementStruct *s_amortissement);
 AmortissementStruct *	bet_data_finance_structure_amortissement_init 		(void);
 gdouble 				bet_data_finance_troncate_number 					(gdouble number,
@@ -34,6 +34,7 @@
 #include "gsb_combo_box.h"
 #include "gsb_currency.h"
 #include "gsb_data_account.h"
+#include "gsb_data_currency.h"
 #include "gsb_data_scheduled.h"
 #include "gsb_dirs.h"
 #include "gsb_file.h"
@@ -254,41 +255,89 @@ static void bet_finance_fill_data_ligne (GtkTreeModel *model,
 }
 
 /**
- * Affiche une ligne du tableau d'amortissement en mois
+ * retourne un montant d'un tableau d'amortissement
  *
- * \param
- * \param
- * \param
+ * \param schedule
+ * \param mantissa		a mantissa at the exponent of the schedule
+ *
+ * \return a double
+ **/
+static gdouble bet_finance_schedule_get_amount (const BetFinanceSchedule *schedule,
+												gint64 mantissa)
+{
+    return gsb_real_real_to_double (gsb_real_new (mantissa, schedule->exponent));
+}
+
+/**
+ * Affiche les lignes du simulateur pour une plage de durées, les tableaux
+ * d'amortissement de toutes les durées sont calculés en une fois
+ *
+ * \param model
+ * \param s_echeance
+ * \param taux_frais
+ * \param duree_min
+ * \param duree_max
+ * \param nbre_mois		nombre de mois par unité de durée : 1 ou 12
  *
  * \return
  **/
-static void bet_finance_calcule_show_months_tab (GtkTreeModel *model,
-												 EcheanceStruct *s_echeance,
-												 gdouble taux_frais)
+static void bet_finance_calcule_show_tab (GtkTreeModel *model,
+										  EcheanceStruct *s_echeance,
+										  gdouble taux_frais,
+										  gint duree_min,
+										  gint duree_max,
+										  gint nbre_mois)
 {
-    gint index;
+    BetFinanceSchedule **schedules;
+    gint *nbre_echeances;
+    guint nb_durations;
+    guint i;
 
-    for (index = DUREE_MIN_MOIS; index <= DUREE_MAX_MOIS; index++)
-    {
-        s_echeance->duree = index;
-        s_echeance->nbre_echeances = index;
-        s_echeance->frais = bet_data_finance_get_frais_par_echeance (s_echeance->capital,
-																	 taux_frais,
-																	 s_echeance->nbre_echeances);
+    if (duree_max < duree_min)
+        return;
 
-        s_echeance->echeance = bet_data_finance_get_echeance (s_echeance->capital,
-															  s_echeance->taux_periodique,
-															  s_echeance->nbre_echeances);
+    nb_durations = duree_max - duree_min + 1;
+    nbre_echeances = g_new (gint, nb_durations);
+    schedules = g_new (BetFinanceSchedule *, nb_durations);
 
-        s_echeance->total_echeance = s_echeance->echeance + s_echeance->frais;
-        s_echeance->total_cost = bet_data_finance_get_total_cost (s_echeance);
+    for (i = 0; i < nb_durations; i++)
+        nbre_echeances[i] = (duree_min + i) * nbre_mois;
 
-        bet_finance_fill_data_ligne (model, s_echeance, _("months"));
+    bet_data_finance_schedule_get_grid (s_echeance->capital,
+                                        s_echeance->taux_periodique,
+                                        taux_frais,
+                                        nbre_echeances,
+                                        nb_durations,
+                                        gsb_data_currency_get_floating_point (s_echeance->devise),
+                                        schedules);
+
+    for (i = 0; i < nb_durations; i++)
+    {
+        const BetFinanceSchedule *schedule = schedules[i];
+
+        s_echeance->duree = duree_min + i;
+        s_echeance->nbre_echeances = nbre_echeances[i];
+        s_echeance->frais = bet_finance_schedule_get_amount (schedule, schedule->frais);
+        s_echeance->echeance = bet_finance_schedule_get_amount (schedule, schedule->echeance);
+        s_echeance->total_echeance = bet_finance_schedule_get_amount (schedule,
+																	  schedule->echeance + schedule->frais);
+        s_echeance->total_cost = bet_finance_schedule_get_amount (schedule, schedule->total_cost);
+
+        if (nbre_mois == 1)
+            bet_finance_fill_data_ligne (model, s_echeance, _("months"));
+        else if (s_echeance->duree == 1)
+            bet_finance_fill_data_ligne (model, s_echeance, _("year"));
+        else
+            bet_finance_fill_data_ligne (model, s_echeance, _("years"));
 
         s_echeance->duree = 0;
         s_echeance->nbre_echeances = 0;
         s_echeance->echeance = 0;
+        bet_data_finance_schedule_unref (schedules[i]);
     }
+
+    g_free (nbre_echeances);
+    g_free (schedules);
 }
 
 /**
@@ -377,6 +426,7 @@ static void bet_finance_fill_amortization_array (GtkWidget *menu_item,
     gint nbre_echeances;
     gdouble taux_periodique;
     AmortissementStruct *s_amortissement;
+    BetFinanceSchedule *schedule;
 
     devel_debug (NULL);
     if (!gtk_tree_selection_get_selected (GTK_TREE_SELECTION (tree_selection), &model, &iter))
@@ -419,34 +469,36 @@ static void bet_finance_fill_amortization_array (GtkWidget *menu_item,
     store = gtk_tree_view_get_model (GTK_TREE_VIEW (tree_view));
     gtk_tree_store_clear (GTK_TREE_STORE (store));
 
-    for (index = 1; index <= nbre_echeances; index++)
+    /* the schedule is usually in the cache since the grid of the simulator */
+    schedule = bet_data_finance_schedule_get (s_amortissement->capital_du,
+                                              taux_periodique,
+                                              s_amortissement->frais,
+                                              nbre_echeances,
+                                              gsb_data_currency_get_floating_point (s_amortissement->devise));
+
+    for (index = 1; schedule && index <= nbre_echeances; index++)
     {
         s_amortissement->num_echeance = index;
-        s_amortissement->interets = bet_data_finance_get_interets (s_amortissement->capital_du,
-																   taux_periodique);
+        s_amortissement->capital_du = bet_finance_schedule_get_amount (schedule, schedule->capital_du[index - 1]);
+        s_amortissement->interets = bet_finance_schedule_get_amount (schedule, schedule->interets[index - 1]);
+        s_amortissement->principal = bet_finance_schedule_get_amount (schedule, schedule->principal[index - 1]);
 
         if (index == nbre_echeances)
         {
 			gchar *amount;
 
-			s_amortissement->echeance = bet_data_finance_get_last_echeance (s_amortissement->capital_du,
-																			s_amortissement->interets,
-																			s_amortissement->frais);
+			s_amortissement->echeance = bet_finance_schedule_get_amount (schedule, schedule->last_echeance);
             g_free (s_amortissement->str_echeance);
-			amount = utils_real_get_string_with_currency (gsb_real_double_to_real (s_amortissement->echeance),
+			amount = utils_real_get_string_with_currency (gsb_real_new (schedule->last_echeance,
+																		schedule->exponent),
 														  s_amortissement-> devise,
 														  TRUE);
             s_amortissement->str_echeance = amount;
-            s_amortissement->principal = s_amortissement->capital_du;
         }
-        else
-            s_amortissement->principal = bet_data_finance_get_principal (s_amortissement->echeance,
-																		 s_amortissement->interets,
-																		 s_amortissement->frais);
 
         bet_finance_fill_amortization_ligne (store, s_amortissement);
-        s_amortissement->capital_du -= s_amortissement->principal;
     }
+    bet_data_finance_schedule_unref (schedule);
 
     utils_set_tree_store_background_color (tree_view, BET_AMORTIZATION_BACKGROUND_COLOR);
     path = gtk_tree_path_new_first ();
@@ -575,34 +627,9 @@ static void bet_finance_ui_calculer_clicked (GtkButton *button,
     gtk_tree_store_clear (GTK_TREE_STORE (model));
 
     if (index == 0)
-        bet_finance_calcule_show_months_tab (model, s_echeance, taux_frais);
+        bet_finance_calcule_show_tab (model, s_echeance, taux_frais, duree_min, duree_max, 1);
     else
-    {
-        for (index = duree_min; index <= duree_max; index++)
-        {
-            s_echeance->duree = index;
-            s_echeance->nbre_echeances = index * 12;
-            s_echeance->frais = bet_data_finance_get_frais_par_echeance (s_echeance->capital,
-																		 taux_frais,
-																		 s_echeance->nbre_echeances);
-
-            s_echeance->echeance = bet_data_finance_get_echeance (s_echeance->capital,
-																  s_echeance->taux_periodique,
-																  s_echeance->nbre_echeances);
-
-            s_echeance->total_echeance = s_echeance->echeance + s_echeance->frais;
-            s_echeance->total_cost = bet_data_finance_get_total_cost (s_echeance);
-
-            if (s_echeance->duree == 1)
-                bet_finance_fill_data_ligne (model, s_echeance, _("year"));
-            else
-                bet_finance_fill_data_ligne (model, s_echeance, _("years"));
-
-            s_echeance->duree = 0;
-            s_echeance->nbre_echeances = 0;
-            s_echeance->echeance = 0;
-        }
-    }
+        bet_finance_calcule_show_tab (model, s_echeance, taux_frais, duree_min, duree_max, 12);
 
     utils_set_tree_store_background_color (tree_view, BET_FINANCE_BACKGROUND_COLOR);
     path = gtk_tree_path_new_first ();
@@ -0,0 +1,553 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*     Copyright (C)         2026 Grisbi Development Team                     */
+/*             https://www.grisbi.org/                                         */
+/*                                                                            */
+/*  This program is free software; you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation; either version 2 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This program is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program; if not, see <https://www.gnu.org/licenses/>.     */
+/*                                                                            */
+/* ************************************************************************** */
+
+/**
+ * \file bet_forecast.c
+ * numeric part of the array of forecast : the events and their running
+ * balance. This file doesn't use gtk, the tree view of bet_tab.c only
+ * shows the result.
+ */
+
+#include "config.h"
+
+#include "include.h"
+
+/*START_INCLUDE*/
+#include "bet_forecast.h"
+/*END_INCLUDE*/
+
+/*START_EXTERN*/
+/*END_EXTERN*/
+
+/******************************************************************************/
+/* Private functions                                                          */
+/******************************************************************************/
+/**
+ * GCompareDataFunc used by bet_forecast_sort
+ *
+ * \param event_a
+ * \param event_b
+ * \param data		the BetForecast
+ *
+ * \return
+ **/
+static gint bet_forecast_sort_function (gconstpointer event_a,
+										gconstpointer event_b,
+										gpointer data)
+{
+	BetForecast *forecast = (BetForecast *) data;
+	gint result;
+
+	result = bet_forecast_compare_events ((const BetForecastEvent *) event_a,
+										  (const BetForecastEvent *) event_b,
+										  forecast->balance_origin);
+	if (result == 0)
+	{
+		guint key_a = ((const BetForecastEvent *) event_a)->key;
+		guint key_b = ((const BetForecastEvent *) event_b)->key;
+
+		if (key_a != key_b)
+			result = key_a < key_b ? -1 : 1;
+	}
+
+	return result;
+}
+
+/**
+ * append the points of a bucket of days to a series : its lowest and its
+ * highest balance in the order of their dates, once if they are the same day
+ *
+ * \param days
+ * \param balances
+ * \param nb_points		number of points already in the series
+ * \param min_day
+ * \param min_balance
+ * \param max_day
+ * \param max_balance
+ *
+ * \return the new number of points
+ **/
+static guint bet_forecast_add_bucket_points (guint32 *days,
+											 gdouble *balances,
+											 guint nb_points,
+											 guint32 min_day,
+											 gdouble min_balance,
+											 guint32 max_day,
+											 gdouble max_balance)
+{
+	if (min_day == max_day)
+	{
+		days[nb_points] = min_day;
+		balances[nb_points] = min_balance;
+
+		return nb_points + 1;
+	}
+
+	if (min_day < max_day)
+	{
+		days[nb_points] = min_day;
+		balances[nb_points] = min_balance;
+		days[nb_points + 1] = max_day;
+		balances[nb_points + 1] = max_balance;
+	}
+	else
+	{
+		days[nb_points] = max_day;
+		balances[nb_points] = max_balance;
+		days[nb_points + 1] = min_day;
+		balances[nb_points + 1] = min_balance;
+	}
+
+	return nb_points + 2;
+}
+
+/******************************************************************************/
+/* Public functions                                                           */
+/******************************************************************************/
+/**
+ * create a new forecast without event
+ *
+ * \param initial_balance	balance before the first event
+ * \param balance_origin	origin of the balance lines
+ * \param reserved_size		number of events expected, 0 if unknown
+ *
+ * \return a new BetForecast to free with bet_forecast_free
+ **/
+BetForecast *bet_forecast_new (GsbReal initial_balance,
+							   gint balance_origin,
+							   guint reserved_size)
+{
+	BetForecast *forecast;
+
+	forecast = g_malloc0 (sizeof (BetForecast));
+	forecast->events = g_array_sized_new (FALSE, FALSE, sizeof (BetForecastEvent), reserved_size);
+	forecast->initial_balance = initial_balance;
+	forecast->balance_origin = balance_origin;
+
+	return forecast;
+}
+
+/**
+ * free a forecast and its events
+ *
+ * \param forecast
+ *
+ * \return
+ **/
+void bet_forecast_free (BetForecast *forecast)
+{
+	if (!forecast)
+		return;
+
+	g_array_free (forecast->events, TRUE);
+	g_free (forecast);
+}
+
+/**
+ * append an event at the end of the forecast, the balances are not
+ * computed, see bet_forecast_compute_balances
+ *
+ * \param forecast
+ * \param julian_day
+ * \param origin
+ * \param number
+ * \param amount
+ * \param selected		TRUE if the event is left out of the balance
+ *
+ * \return the new event, valid until the next append
+ **/
+BetForecastEvent *bet_forecast_append_event (BetForecast *forecast,
+											 guint32 julian_day,
+											 gint origin,
+											 gint number,
+											 GsbReal amount,
+											 gboolean selected)
+{
+	BetForecastEvent event;
+
+	event.julian_day = julian_day;
+	event.origin = origin;
+	event.number = number;
+	event.selected = selected;
+	event.amount = amount;
+	event.balance = null_real;
+	event.key = 0;
+	g_array_append_val (forecast->events, event);
+
+	return &g_array_index (forecast->events, BetForecastEvent, forecast->events->len - 1);
+}
+
+/**
+ * insert an event at its place in a sorted forecast, after the equal
+ * events whatever their key. The balances are not computed, see bet_forecast_compute_balances
+ *
+ * \param forecast
+ * \param julian_day
+ * \param origin
+ * \param number
+ * \param amount
+ * \param selected		TRUE if the event is left out of the balance
+ *
+ * \return the index of the new event
+ **/
+guint bet_forecast_insert_event (BetForecast *forecast,
+								 guint32 julian_day,
+								 gint origin,
+								 gint number,
+								 GsbReal amount,
+								 gboolean selected)
+{
+	BetForecastEvent event;
+	guint low = 0;
+	guint high;
+
+	event.julian_day = julian_day;
+	event.origin = origin;
+	event.number = number;
+	event.selected = selected;
+	event.amount = amount;
+	event.balance = null_real;
+	event.key = 0;
+
+	/* first event greater than the new one */
+	high = forecast->events->len;
+	while (low < high)
+	{
+		guint middle;
+
+		middle = low + (high - low) / 2;
+		if (bet_forecast_compare_events (&g_array_index (forecast->events, BetForecastEvent, middle),
+										 &event,
+										 forecast->balance_origin) <= 0)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+	g_array_insert_val (forecast->events, low, event);
+
+	return low;
+}
+
+/**
+ * remove an event of the forecast, the balances are not computed, see
+ * bet_forecast_compute_balances
+ *
+ * \param forecast
+ * \param index
+ *
+ * \return
+ **/
+void bet_forecast_remove_event (BetForecast *forecast,
+								guint index)
+{
+	if (!forecast || index >= forecast->events->len)
+		return;
+
+	g_array_remove_index (forecast->events, index);
+}
+
+/**
+ * order of the events in the array of forecast : by date, the balance
+ * lines first, then by origin and for the same origin the biggest amount
+ * first
+ *
+ * \param event_a
+ * \param event_b
+ * \param balance_origin	origin of the balance lines
+ *
+ * \return less than 0 if event_a comes before event_b, 0 if equal, more than 0 else
+ **/
+gint bet_forecast_compare_events (const BetForecastEvent *event_a,
+								  const BetForecastEvent *event_b,
+								  gint balance_origin)
+{
+	if (event_a->julian_day != event_b->julian_day)
+		return event_a->julian_day < event_b->julian_day ? -1 : 1;
+
+	if (event_a->origin == event_b->origin)
+		return gsb_real_cmp (event_b->amount, event_a->amount);
+	else if (event_a->origin == balance_origin)
+		return -1;
+	else if (event_b->origin == balance_origin)
+		return 1;
+	else
+		return event_a->origin - event_b->origin;
+}
+
+/**
+ * sort the events with bet_forecast_compare_events, the equal events in
+ * the order of their key
+ *
+ * \param forecast
+ *
+ * \return
+ **/
+void bet_forecast_sort (BetForecast *forecast)
+{
+	g_array_sort_with_data (forecast->events, bet_forecast_sort_function, forecast);
+}
+
+/**
+ * compute the running balance of the events from first_event to the end,
+ * the events before first_event are supposed up to date
+ *
+ * \param forecast
+ * \param first_event
+ *
+ * \return
+ **/
+void bet_forecast_compute_balances (BetForecast *forecast,
+									guint first_event)
+{
+	GsbReal balance;
+	guint i;
+
+	if (first_event > 0 && first_event <= forecast->events->len)
+		balance = g_array_index (forecast->events, BetForecastEvent, first_event - 1).balance;
+	else
+	{
+		balance = forecast->initial_balance;
+		first_event = 0;
+	}
+
+	for (i = first_event; i < forecast->events->len; i++)
+	{
+		BetForecastEvent *event;
+
+		event = &g_array_index (forecast->events, BetForecastEvent, i);
+		if (!event->selected)
+			balance = gsb_real_add (balance, event->amount);
+		event->balance = balance;
+	}
+}
+
+/**
+ * change the selection of an event and update the balances from it
+ *
+ * \param forecast
+ * \param index
+ * \param selected		TRUE to leave the event out of the balance
+ *
+ * \return
+ **/
+void bet_forecast_set_selected (BetForecast *forecast,
+								guint index,
+								gboolean selected)
+{
+	BetForecastEvent *event;
+
+	event = bet_forecast_get_event (forecast, index);
+	if (!event || event->selected == selected)
+		return;
+
+	event->selected = selected;
+	bet_forecast_compute_balances (forecast, index);
+}
+
+/**
+ * return an event of the forecast
+ *
+ * \param forecast
+ * \param index
+ *
+ * \return the event or NULL
+ **/
+BetForecastEvent *bet_forecast_get_event (BetForecast *forecast,
+										  guint index)
+{
+	if (!forecast || index >= forecast->events->len)
+		return NULL;
+
+	return &g_array_index (forecast->events, BetForecastEvent, index);
+}
+
+/**
+ *
+ *
+ * \param forecast
+ *
+ * \return the number of events
+ **/
+guint bet_forecast_get_nb_events (BetForecast *forecast)
+{
+	if (!forecast)
+		return 0;
+
+	return forecast->events->len;
+}
+
+/**
+ * merge several sorted forecasts in a new one, in the order of
+ * bet_forecast_compare_events, the forecasts coming first winning the
+ * ties. The initial balance is the sum of the initial balances and the
+ * balances of the events are the combined running balance.
+ *
+ * \param forecasts		sorted forecasts with the same balance origin
+ * \param nb_forecasts
+ * \param sources		if not NULL, the index in forecasts of each merged event is appended as a guint
+ *
+ * \return a new BetForecast to free with bet_forecast_free
+ **/
+BetForecast *bet_forecast_merge (BetForecast **forecasts,
+								 guint nb_forecasts,
+								 GArray *sources)
+{
+	BetForecast *merged;
+	GsbReal initial_balance = null_real;
+	guint *heads;
+	guint nb_events = 0;
+	guint i;
+
+	for (i = 0; i < nb_forecasts; i++)
+	{
+		initial_balance = gsb_real_add (initial_balance, forecasts[i]->initial_balance);
+		nb_events += forecasts[i]->events->len;
+	}
+
+	merged = bet_forecast_new (initial_balance,
+							   nb_forecasts > 0 ? forecasts[0]->balance_origin : 0,
+							   nb_events);
+	heads = g_new0 (guint, nb_forecasts);
+
+	while (merged->events->len < nb_events)
+	{
+		const BetForecastEvent *next_event = NULL;
+		guint next_forecast = 0;
+
+		for (i = 0; i < nb_forecasts; i++)
+		{
+			const BetForecastEvent *event;
+
+			if (heads[i] >= forecasts[i]->events->len)
+				continue;
+
+			event = &g_array_index (forecasts[i]->events, BetForecastEvent, heads[i]);
+			if (next_event == NULL
+				|| bet_forecast_compare_events (event, next_event, merged->balance_origin) < 0)
+			{
+				next_event = event;
+				next_forecast = i;
+			}
+		}
+
+		g_array_append_vals (merged->events, next_event, 1);
+		if (sources)
+			g_array_append_val (sources, next_forecast);
+		heads[next_forecast]++;
+	}
+	g_free (heads);
+
+	bet_forecast_compute_balances (merged, 0);
+
+	return merged;
+}
+
+/**
+ * fill the series of the balances at the end of each day of a period.
+ * When the period has more days than max_points, the days are grouped in
+ * max_points / 2 buckets and each bucket gives its lowest and its highest
+ * balance, in the order of their dates, so that the peaks stay in the
+ * graph. days and balances must hold 2 * nb_buckets entries, that is at
+ * most max_points entries.
+ *
+ * \param forecast		with its balances computed
+ * \param first_day		julian day of the first day
+ * \param last_day		julian day of the last day
+ * \param max_points	size of days and balances, at least 2
+ * \param days			filled with the julian day of each point
+ * \param balances		filled with the balance of each point
+ *
+ * \return the number of points, 0 if max_points is less than 2
+ **/
+guint bet_forecast_get_balance_series (BetForecast *forecast,
+									   guint32 first_day,
+									   guint32 last_day,
+									   guint max_points,
+									   guint32 *days,
+									   gdouble *balances)
+{
+	GsbReal balance;
+	gdouble min_balance = 0.0;
+	gdouble max_balance = 0.0;
+	guint32 day;
+	guint32 min_day = 0;
+	guint32 max_day = 0;
+	guint nb_days;
+	guint nb_buckets;
+	guint bucket = 0;
+	guint nb_points = 0;
+	guint index = 0;
+
+	/* a bucket can give two points */
+	if (!forecast || last_day < first_day || max_points < 2)
+		return 0;
+
+	nb_days = last_day - first_day + 1;
+	if (nb_days <= max_points)
+		nb_buckets = nb_days;
+	else
+		nb_buckets = max_points / 2;
+
+	balance = forecast->initial_balance;
+	for (day = first_day; day <= last_day; day++)
+	{
+		gdouble day_balance;
+		guint day_bucket;
+
+		/* balance at the end of the day */
+		while (index < forecast->events->len
+			   && g_array_index (forecast->events, BetForecastEvent, index).julian_day <= day)
+		{
+			balance = g_array_index (forecast->events, BetForecastEvent, index).balance;
+			index++;
+		}
+		day_balance = gsb_real_real_to_double (balance);
+
+		day_bucket = (guint) (((guint64) (day - first_day) * nb_buckets) / nb_days);
+		if (day == first_day || day_bucket != bucket)
+		{
+			if (day != first_day)
+				nb_points = bet_forecast_add_bucket_points (days, balances, nb_points,
+															min_day, min_balance,
+															max_day, max_balance);
+			bucket = day_bucket;
+			min_day = max_day = day;
+			min_balance = max_balance = day_balance;
+		}
+		else if (day_balance < min_balance)
+		{
+			min_day = day;
+			min_balance = day_balance;
+		}
+		else if (day_balance > max_balance)
+		{
+			max_day = day;
+			max_balance = day_balance;
+		}
+	}
+
+	return bet_forecast_add_bucket_points (days, balances, nb_points,
+										   min_day, min_balance,
+										   max_day, max_balance);
+}
+
+/* Local Variables: */
+/* c-basic-offset: 4 */
+/* End: */
@@ -0,0 +1,75 @@
+#ifndef _BET_FORECAST_H
+#define _BET_FORECAST_H
+
+#include <glib.h>
+
+/* START_INCLUDE_H */
+#include "gsb_real.h"
+/* END_INCLUDE_H */
+
+typedef struct _BetForecast					BetForecast;
+typedef struct _BetForecastEvent			BetForecastEvent;
+
+/* une ligne du tableau des prévisions, sans aucune donnée d'affichage */
+struct _BetForecastEvent
+{
+	guint32			julian_day;					/* date of the event */
+	gint			origin;						/* SPP_ORIGIN_TRANSACTION, SPP_ORIGIN_SCHEDULED... */
+	gint			number;						/* transaction, scheduled, future or div number */
+	gboolean		selected;					/* TRUE if the event is left out of the balance */
+	GsbReal			amount;						/* in the currency of the account */
+	GsbReal			balance;					/* running balance after the event */
+	guint			key;						/* given by the caller, orders the equal events */
+};
+
+/* moteur de calcul des soldes du tableau des prévisions, indépendant de gtk */
+struct _BetForecast
+{
+	GArray *		events;						/* the BetForecastEvent, in the order of the array */
+	GsbReal			initial_balance;			/* balance before the first event */
+	gint			balance_origin;				/* origin of the balance lines, first of each day */
+};
+
+/* START_DECLARATION */
+BetForecastEvent *	bet_forecast_append_event			(BetForecast *forecast,
+														 guint32 julian_day,
+														 gint origin,
+														 gint number,
+														 GsbReal amount,
+														 gboolean selected);
+gint				bet_forecast_compare_events			(const BetForecastEvent *event_a,
+														 const BetForecastEvent *event_b,
+														 gint balance_origin);
+void				bet_forecast_compute_balances		(BetForecast *forecast,
+														 guint first_event);
+guint				bet_forecast_get_balance_series		(BetForecast *forecast,
+														 guint32 first_day,
+														 guint32 last_day,
+														 guint max_points,
+														 guint32 *days,
+														 gdouble *balances);
+void				bet_forecast_free					(BetForecast *forecast);
+BetForecastEvent *	bet_forecast_get_event				(BetForecast *forecast,
+														 guint index);
+guint				bet_forecast_get_nb_events			(BetForecast *forecast);
+guint				bet_forecast_insert_event			(BetForecast *forecast,
+														 guint32 julian_day,
+														 gint origin,
+														 gint number,
+														 GsbReal amount,
+														 gboolean selected);
+BetForecast *		bet_forecast_merge					(BetForecast **forecasts,
+														 guint nb_forecasts,
+														 GArray *sources);
+BetForecast *		bet_forecast_new					(GsbReal initial_balance,
+														 gint balance_origin,
+														 guint reserved_size);
+void				bet_forecast_remove_event			(BetForecast *forecast,
+														 guint index);
+void				bet_forecast_set_selected			(BetForecast *forecast,
+														 guint index,
+														 gboolean selected);
+void				bet_forecast_sort					(BetForecast *forecast);
+/* END_DECLARATION */
+
+#endif
@@ -1944,7 +1944,7 @@ dialog_return:
         else
             bet_data_future_add_lines (scheduled);
 
-        gsb_data_account_set_bet_maj (account_number, BET_MAJ_ESTIMATE);
+        bet_array_mark_source_changed (account_number, SPP_ORIGIN_FUTURE, scheduled->number);
         bet_data_update_bet_module (account_number, GSB_ESTIMATE_PAGE);
     }
 
@@ -2012,7 +2012,7 @@ dialog_return:
             bet_data_future_modify_lines (scheduled);
         }
 
-        gsb_data_account_set_bet_maj (account_number, BET_MAJ_ESTIMATE);
+        bet_array_mark_source_changed (account_number, SPP_ORIGIN_FUTURE, number);
         bet_data_update_bet_module (account_number, GSB_ESTIMATE_PAGE);
     }
 
@@ -30,6 +30,7 @@
 /*START_INCLUDE*/
 #include "bet_graph.h"
 #include "bet_data.h"
+#include "bet_forecast.h"
 #include "bet_hist.h"
 #include "bet_tab.h"
 #include "dialog.h"
@@ -395,9 +396,11 @@ GtkToolItem *bet_graph_button_menu_new (GtkWidget *toolbar,
 }
 
 /**
+ * récupère les soldes de la prévision affichée dans le tableau. Au delà de
+ * MAX_POINTS_GRAPHIQUE jours la série est réduite aux soldes mini et maxi
+ * de chaque intervalle de jours.
  *
- *
- * \param
+ * \param BetGraphDataStruct
  *
  * \return TRUE if OK FALSE otherwise
  **/
@@ -405,127 +408,63 @@ gboolean bet_graph_populate_lines_by_forecast_data (BetGraphDataStruct *self)
 {
     GtkTreeModel *model = NULL;
     GtkTreeIter iter;
-    gdouble prev_montant = 0.0;
+    GValue date_value = G_VALUE_INIT;
+    GDate *date;
+    BetForecast *forecast;
+    gchar *libelle_axe_x = self->tab_libelle[0];
+    guint32 tab_days[MAX_POINTS_GRAPHIQUE];
+    guint32 first_day;
+    guint32 last_day;
+    guint nb_events;
+    guint nb_points;
+    guint i;
 
     model = gtk_tree_view_get_model (GTK_TREE_VIEW (self->tree_view));
     if (model == NULL)
         return FALSE;
 
-    if (gtk_tree_model_get_iter_first (model, &iter))
-    {
-        gchar *libelle_axe_x = self->tab_libelle[0];
-        gdouble *tab_Y = self->tab_Y;
-        gdouble montant = 0.;
-        GDate *first_date;
-        GDate *last_date;
-        GDate *date_courante = NULL;
-        GDateDay day_courant = G_DATE_BAD_DAY;
-        GDateMonth month_courant = G_DATE_BAD_MONTH;
-        gint nbre_iterations = 0;
-
-        do
-        {
-            gchar *amount;
-            gchar *str_date;
-            GValue date_value = G_VALUE_INIT;
-            GDate *date;
-            GDateDay day;
-            GDateMonth month;
-            gint diff_jours;
-            gint i;
-
-			if (G_IS_VALUE (&date_value))
-				g_value_init (&date_value, G_TYPE_DATE);
-
-            gtk_tree_model_get_value (model,
-									  &iter,
-									  SPP_ESTIMATE_TREE_SORT_DATE_COLUMN, &date_value);
-
-            gtk_tree_model_get (GTK_TREE_MODEL(model),
-								&iter,
-								SPP_ESTIMATE_TREE_AMOUNT_COLUMN, &amount,
-								-1);
-            date = g_value_get_boxed (&date_value);
-
-            montant += (gdouble) utils_str_strtod ((amount == NULL) ? "0" : amount, NULL);
-
-            if (self->nbre_elemnts == 0)
-            {
-                /* on ajoute 1 jour pour passer au 1er du mois */
-                g_date_add_days (date, 1);
-
-                /* on calcule le nombre maxi d'itération pour une année */
-                first_date = gsb_date_copy (date);
-                last_date = gsb_date_copy (date);
-                g_date_add_years (last_date, 1);
-                nbre_iterations = g_date_days_between (first_date, last_date);
-
-                date_courante = gsb_date_copy (date);
-                day_courant = g_date_get_day (date);
-                month_courant = g_date_get_month (date);
-
-                str_date = gsb_format_gdate (date_courante);
-                strncpy (&libelle_axe_x[self->nbre_elemnts * TAILLE_MAX_LIBELLE], str_date, TAILLE_MAX_LIBELLE-1);
-
-                self->nbre_elemnts++;
-                g_free (str_date);
-                g_date_free (first_date);
-                g_date_free (last_date);
-            }
-            else
-            {
-                day = g_date_get_day (date);
-                month = g_date_get_month (date);
-                if (day != day_courant || month != month_courant)
-                {
-                    /* nombre de jours manquants */
-                    diff_jours = g_date_days_between (date_courante, date);
-                    for (i = diff_jours; i > 0; i--)
-                    {
-                        g_date_add_days (date_courante, 1);
-                        str_date = gsb_format_gdate (date_courante);
-
-                        strncpy (&libelle_axe_x[self->nbre_elemnts * TAILLE_MAX_LIBELLE], str_date, TAILLE_MAX_LIBELLE-1);
-						g_free (str_date);
-                        tab_Y[self->nbre_elemnts-1] = prev_montant;
-                        self->nbre_elemnts++;
-
-                        /* on dépasse d'un jour pour obtenir le solde du dernier jour */
-                        if (self->nbre_elemnts > nbre_iterations)
-                        {
-                            self->nbre_elemnts = nbre_iterations + 1;
-							g_value_unset (&date_value);
-
-							break;
-                        }
-                    }
-                    day_courant = day;
-                    if (g_date_is_first_of_month (date))
-                        month_courant = g_date_get_month (date);
-                }
-            }
-            prev_montant = montant;
-
-            if (self->nbre_elemnts > nbre_iterations)
-            {
-                self->nbre_elemnts = nbre_iterations;
-                dialogue_hint (_("You can not exceed one year of visualization"), _("Overflow"));
-				g_value_unset (&date_value);
-
-                break;
-            }
-			g_value_unset (&date_value);
-        }
-        while (gtk_tree_model_iter_next (GTK_TREE_MODEL (model), &iter));
-
-        tab_Y[self->nbre_elemnts-1] = prev_montant;
+    forecast = g_object_get_data (G_OBJECT (model), "bet_forecast");
+    if (forecast == NULL || !gtk_tree_model_get_iter_first (model, &iter))
+        return FALSE;
 
-        g_date_free (date_courante);
+    /* la première ligne donne le solde de la veille du début de la prévision */
+    gtk_tree_model_get_value (model, &iter, SPP_ESTIMATE_TREE_SORT_DATE_COLUMN, &date_value);
+    date = g_value_get_boxed (&date_value);
+    if (date == NULL || !g_date_valid (date))
+    {
+        g_value_unset (&date_value);
 
-        return TRUE;
+        return FALSE;
     }
+    first_day = g_date_get_julian (date) + 1;
+    g_value_unset (&date_value);
+
+    nb_events = bet_forecast_get_nb_events (forecast);
+    last_day = first_day;
+    if (nb_events > 0)
+        last_day = MAX (first_day, bet_forecast_get_event (forecast, nb_events - 1)->julian_day);
+
+    nb_points = bet_forecast_get_balance_series (forecast,
+                                                 first_day,
+                                                 last_day,
+                                                 MAX_POINTS_GRAPHIQUE,
+                                                 tab_days,
+                                                 self->tab_Y);
+
+    for (i = 0; i < nb_points; i++)
+    {
+        GDate date_point;
+        gchar *str_date;
+
+        g_date_clear (&date_point, 1);
+        g_date_set_julian (&date_point, tab_days[i]);
+        str_date = gsb_format_gdate (&date_point);
+        strncpy (&libelle_axe_x[i * TAILLE_MAX_LIBELLE], str_date, TAILLE_MAX_LIBELLE-1);
+        g_free (str_date);
+    }
+    self->nbre_elemnts = nb_points;
 
-    return FALSE;
+    return nb_points > 0;
 }
 
 /**
@@ -540,10 +479,7 @@ gboolean bet_graph_populate_lines_by_hist_line (BetGraphDataStruct *self)
     GtkTreeSelection *selection;
     GtkTreeModel *model = NULL;
     GtkTreeIter iter;
-    GHashTable *list_transactions;
-    GHashTableIter hash_iter;
-    gpointer key;
-    gpointer value;
+    GPtrArray *list_transactions;
     GDate *start_current_fyear;
     GDateMonth date_month = G_DATE_BAD_MONTH;
     GDateMonth today_month = G_DATE_BAD_MONTH;
@@ -556,6 +492,7 @@ gboolean bet_graph_populate_lines_by_hist_line (BetGraphDataStruct *self)
     gint sub_div_nb;
     gint fyear_number;
     gint i;
+    guint j;
     GsbReal tab[12];
     GsbReal tab2[12];
 
@@ -573,9 +510,9 @@ gboolean bet_graph_populate_lines_by_hist_line (BetGraphDataStruct *self)
 
     fyear_number = gsb_data_account_get_bet_hist_fyear (self->account_number);
 
-    /* on calcule les montants par mois en premier */
+    /* on calcule les montants par mois en premier à partir des agrégats mensuels */
     list_transactions = bet_hist_get_list_trans_current_fyear ();
-    if (g_hash_table_size (list_transactions) == 0)
+    if (list_transactions == NULL || list_transactions->len == 0)
         return FALSE;
 
     /* on initialise les tableaux des montants */
@@ -586,10 +523,9 @@ gboolean bet_graph_populate_lines_by_hist_line (BetGraphDataStruct *self)
             tab2[i] = null_real;
     }
 
-    g_hash_table_iter_init (&hash_iter, list_transactions);
-    while (g_hash_table_iter_next (&hash_iter, &key, &value))
+    for (j = 0; j < list_transactions->len; j++)
     {
-        TransactionCurrentFyear *tcf = (TransactionCurrentFyear*) value;
+        TransactionCurrentFyear *tcf = g_ptr_array_index (list_transactions, j);
 
         if (tcf->div_nb == div_number)
         {
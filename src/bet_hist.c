@@ -28,6 +28,7 @@
 /*START_INCLUDE*/
 #include "bet_hist.h"
 #include "bet_data.h"
+#include "bet_hist_cube.h"
 #ifdef HAVE_GOFFICE
 #include "bet_graph.h"
 #endif /* HAVE_GOFFICE */
@@ -65,8 +66,8 @@ static gboolean hist_block_signal = FALSE;
 /* toolbar */
 static GtkWidget *bet_hist_toolbar;
 
-/* liste qui contient les transactions concernées */
-static GHashTable *list_trans_hist = NULL;
+/* liste des montants (TransactionCurrentFyear) pour les graphiques mensuels */
+static GPtrArray *list_trans_hist = NULL;
 
 /**
  * this is a tree model filter with 3 columns :
@@ -84,6 +85,18 @@ static GtkTreeModel *bet_fyear_model_filter = NULL;
 /*START_EXTERN*/
 /*END_EXTERN*/
 
+/* données communes aux montants ajoutés par bet_hist_populate_item () */
+typedef struct _BetHistPopulate		BetHistPopulate;
+struct _BetHistPopulate
+{
+	gint			account_number;
+	gint			origin_data;			/* 0 = categories, 1 = budgetary lines */
+	GArray *		garray;					/* the cards to aggregate or NULL */
+	GHashTable *	list_div;
+	GDate *			start_current_fyear;
+	GDate *			date_max;
+};
+
 /******************************************************************************/
 /* Private functions                                                          */
 /******************************************************************************/
@@ -1547,7 +1560,7 @@ static GArray *bet_hist_get_cards_account_array_for_aggregate (gint account_numb
  * \return
  **/
 static gboolean bet_hist_valid_card_data_to_aggregate (gint tmp_account_number,
-													   gint transaction_number,
+													   const BetHistCubeItem *item,
 													   GArray *garray)
 {
 	gint nbre_items;
@@ -1567,8 +1580,8 @@ static gboolean bet_hist_valid_card_data_to_aggregate (gint tmp_account_number,
 			origin_data = gsb_data_account_get_bet_hist_data (std->card_account_number);
 			if (!origin_data)
 			{
-				div = gsb_data_transaction_get_category_number (transaction_number);
-				sub_div = gsb_data_transaction_get_sub_category_number (transaction_number);
+				div = item->category_number;
+				sub_div = item->sub_category_number;
 				if (div == std->card_category_number && sub_div == std->card_sub_category_number)
 					return FALSE;
 				else
@@ -1576,8 +1589,8 @@ static gboolean bet_hist_valid_card_data_to_aggregate (gint tmp_account_number,
 			}
 			else
 			{
-				div = gsb_data_transaction_get_budgetary_number (transaction_number);
-				sub_div = gsb_data_transaction_get_sub_budgetary_number (transaction_number);
+				div = item->budgetary_number;
+				sub_div = item->sub_budgetary_number;
 				if (div == std->card_budgetary_number && sub_div == std->card_sub_budgetary_number)
 					return FALSE;
 				else
@@ -1589,8 +1602,8 @@ static gboolean bet_hist_valid_card_data_to_aggregate (gint tmp_account_number,
 			origin_data = gsb_data_account_get_bet_hist_data (std->main_account_number);
 			if (!origin_data)
 			{
-				div = gsb_data_transaction_get_category_number (transaction_number);
-				sub_div = gsb_data_transaction_get_sub_category_number (transaction_number);
+				div = item->category_number;
+				sub_div = item->sub_category_number;
 				if (div == std->main_category_number && sub_div == std->main_sub_category_number)
 					return FALSE;
 				else
@@ -1598,8 +1611,8 @@ static gboolean bet_hist_valid_card_data_to_aggregate (gint tmp_account_number,
 			}
 			else
 			{
-				div = gsb_data_transaction_get_budgetary_number (transaction_number);
-				sub_div = gsb_data_transaction_get_sub_budgetary_number (transaction_number);
+				div = item->budgetary_number;
+				sub_div = item->sub_budgetary_number;
 				if (div == std->main_budgetary_number && sub_div == std->main_sub_budgetary_number)
 					return FALSE;
 				else
@@ -1611,6 +1624,63 @@ static gboolean bet_hist_valid_card_data_to_aggregate (gint tmp_account_number,
 	return FALSE;
 }
 
+/**
+ * BetHistCubeFunc : ajoute un montant des agrégats mensuels aux divisions
+ * et à la liste des montants pour les graphiques mensuels
+ *
+ * \param item		une opération ou la somme d'un mois
+ * \param data		BetHistPopulate
+ *
+ * \return
+ **/
+static void bet_hist_populate_item (const BetHistCubeItem *item,
+									gpointer data)
+{
+	BetHistPopulate *populate = (BetHistPopulate *) data;
+	TransactionCurrentFyear *tcf;
+	gint div;
+	gint sub_div;
+	gint type_de_transaction;
+
+	if (item->account_number != populate->account_number
+		&& !bet_hist_valid_card_data_to_aggregate (item->account_number, item, populate->garray))
+		return;
+
+	if (populate->origin_data)
+	{
+		div = item->budgetary_number;
+		sub_div = item->sub_budgetary_number;
+	}
+	else
+	{
+		div = item->category_number;
+		sub_div = item->sub_category_number;
+	}
+	if (div <= 0)
+		return;
+
+	/* on détermine le type de transaction pour l'affichage */
+	type_de_transaction = bet_hist_get_type_transaction (item->date,
+														 populate->start_current_fyear,
+														 populate->date_max);
+
+	tcf = bet_data_struct_transaction_current_fyear_init ();
+	tcf->transaction_number = item->transaction_number;
+	tcf->date = gsb_date_copy (item->date);
+	tcf->type_de_transaction = type_de_transaction;
+	tcf->div_nb = div;
+	tcf->sub_div_nb = sub_div;
+	tcf->amount = item->amount;
+	g_ptr_array_add (list_trans_hist, tcf);
+
+	bet_data_hist_div_populate (item->account_number,
+								div,
+								sub_div,
+								item->amount,
+								type_de_transaction,
+								populate->list_div);
+}
+
 /******************************************************************************/
 /* Public functions                                                           */
 /******************************************************************************/
@@ -1689,13 +1759,15 @@ void bet_hist_populate_data (gint account_number)
 	GtkWidget *tree_view;
 	GtkTreeModel *model;
 	GtkTreePath *path = NULL;
+	BetHistPopulate populate;
 	gint fyear_number;
 	GArray *garray = NULL;
 	GDate *date_jour;
 	GDate *date_min;
 	GDate *date_max;
+	GDate *day_after_date_max;
 	GDate *start_current_fyear;
-	GSList* tmp_list;
+	const GDate *cut_dates[2];
 	GHashTable *list_div;
 
 	devel_debug_int (account_number);
@@ -1734,14 +1806,11 @@ void bet_hist_populate_data (gint account_number)
 									  (GDestroyNotify) g_free,
 									  (GDestroyNotify) bet_data_hist_struct_free);
 
-	/* on initialise ici la liste des transactions pour les graphiques mensuels */
+	/* on initialise ici la liste des montants pour les graphiques mensuels */
 	if (list_trans_hist)
-		g_hash_table_remove_all (list_trans_hist);
+		g_ptr_array_unref (list_trans_hist);
 
-	list_trans_hist = g_hash_table_new_full (g_str_hash,
-											 g_str_equal,
-											 (GDestroyNotify) g_free,
-											 (GDestroyNotify) bet_data_struct_transaction_current_fyear_free);
+	list_trans_hist = g_ptr_array_new_with_free_func ((GDestroyNotify) bet_data_struct_transaction_current_fyear_free);
 
 	/* on traite la fusion des données des comptes CB à débit différé */
 	if (gsb_data_account_get_bet_hist_use_data_in_account (account_number)
@@ -1750,58 +1819,55 @@ void bet_hist_populate_data (gint account_number)
 		garray = bet_hist_get_cards_account_array_for_aggregate (account_number);
 	}
 
-	/* search transactions of the account  */
-	tmp_list = gsb_data_transaction_get_complete_transactions_list ();
-	while (tmp_list)
+	populate.account_number = account_number;
+	populate.origin_data = gsb_data_account_get_bet_hist_data (account_number);
+	populate.garray = garray;
+	populate.list_div = list_div;
+	populate.start_current_fyear = start_current_fyear;
+	populate.date_max = date_max;
+
+	/* the type of transaction changes at these dates, the other months are read as monthly sums */
+	day_after_date_max = gsb_date_copy (date_max);
+	g_date_add_days (day_after_date_max, 1);
+	cut_dates[0] = start_current_fyear;
+	cut_dates[1] = day_after_date_max;
+
+	/* search the amounts of the account between date_min and date_jour */
+	bet_hist_cube_foreach (account_number,
+						   date_min,
+						   date_jour,
+						   cut_dates,
+						   G_N_ELEMENTS (cut_dates),
+						   bet_hist_populate_item,
+						   &populate);
+	if (garray)
 	{
-		gint transaction_number;
-		gint tmp_account_number;
-		const GDate *date;
-		gint type_de_transaction;
-		TransactionCurrentFyear *tcf = NULL;
-
-		transaction_number = gsb_data_transaction_get_transaction_number (tmp_list->data);
-		tmp_list = tmp_list->next;
+		guint i;
 
-		tmp_account_number =  gsb_data_transaction_get_account_number (transaction_number);
-		if (tmp_account_number != account_number)
+		for (i = 0; i < garray->len; i++)
 		{
-			if (garray == NULL)
-			{
+			TransfertData *std;
+			guint j;
+
+			std = g_array_index (garray, TransfertData *, i);
+			if (std->card_account_number == account_number)
 				continue;
-			}
-			else
+
+			/* a card can be in several transfers, its amounts are read one time */
+			for (j = 0; j < i; j++)
 			{
-				if (!bet_hist_valid_card_data_to_aggregate (tmp_account_number, transaction_number, garray))
-					continue;
+				if (g_array_index (garray, TransfertData *, j)->card_account_number == std->card_account_number)
+					break;
 			}
+			if (j == i)
+				bet_hist_cube_foreach (std->card_account_number,
+									   date_min,
+									   date_jour,
+									   cut_dates,
+									   G_N_ELEMENTS (cut_dates),
+									   bet_hist_populate_item,
+									   &populate);
 		}
-
-		date = gsb_data_transaction_get_date (transaction_number);
-
-		/* ignore transaction which are before date_min */
-		if (g_date_compare (date, date_min) < 0)
-			continue;
-
-		/* ignore transaction which is after date_jour */
-		if (g_date_compare (date, date_jour) > 0)
-			continue;
-
-		/* ignore splitted transactions */
-		if (gsb_data_transaction_get_split_of_transaction (
-		 transaction_number) == TRUE)
-			continue;
-
-		/* on détermine le type de transaction pour l'affichage */
-		type_de_transaction = bet_hist_get_type_transaction (date, start_current_fyear, date_max);
-
-		tcf = bet_data_struct_transaction_current_fyear_init ();
-		tcf->transaction_number = transaction_number;
-		tcf->date = gsb_date_copy (date);
-		tcf->type_de_transaction = type_de_transaction;
-
-		g_hash_table_insert (list_trans_hist, utils_str_itoa (transaction_number), tcf);
-		bet_data_hist_div_populate (transaction_number, TRUE, list_div, type_de_transaction, tcf);
 	}
 
 	bet_hist_affiche_div (list_div, tree_view);
@@ -1811,6 +1877,7 @@ void bet_hist_populate_data (gint account_number)
 	g_date_free (date_jour);
 	g_date_free (date_min);
 	g_date_free (date_max);
+	g_date_free (day_after_date_max);
 	g_date_free (start_current_fyear);
 
 	bet_hist_set_background_color (tree_view);
@@ -2160,7 +2227,7 @@ gchar *bet_hist_get_hist_source_name (gint account_number)
  *
  * \return TRUE
  * */
-GHashTable *bet_hist_get_list_trans_current_fyear (void)
+GPtrArray *bet_hist_get_list_trans_current_fyear (void)
 {
 	return list_trans_hist;
 }
@@ -13,7 +13,7 @@ gboolean		bet_hist_fyear_create_combobox_store		(void);
 void			bet_hist_fyear_hide_present_futures_fyears	(void);
 gint 			bet_hist_get_fyear_from_combobox 			(GtkWidget *combo_box);
 gchar *			bet_hist_get_hist_source_name 				(gint account_number);
-GHashTable *	bet_hist_get_list_trans_current_fyear 		(void);
+GPtrArray *	bet_hist_get_list_trans_current_fyear 		(void);
 GDate *			bet_hist_get_start_date_current_fyear 		(void);
 GtkWidget *		bet_hist_get_toolbar						(void);
 void 			bet_hist_g_signal_block_tree_view 			(void);
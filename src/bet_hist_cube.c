@@ -0,0 +1,482 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*     Copyright (C)         2026 Grisbi Development Team                     */
+/*             https://www.grisbi.org/                                         */
+/*                                                                            */
+/*  This program is free software; you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation; either version 2 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This program is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program; if not, see <https://www.gnu.org/licenses/>.     */
+/*                                                                            */
+/* ************************************************************************** */
+
+/**
+ * \file bet_hist_cube.c
+ * monthly aggregates of the transactions by account, category and budgetary
+ * line, used by the historical data of the budget module.
+ * The aggregates are built at the first use from all the transactions,
+ * archives included, then the modified transactions are marked by
+ * gsb_data_transaction and taken into account at the next use.
+ */
+
+#include "config.h"
+
+#include "include.h"
+#include <string.h>
+
+/*START_INCLUDE*/
+#include "bet_hist_cube.h"
+#include "gsb_data_transaction.h"
+/*END_INCLUDE*/
+
+/*START_EXTERN*/
+/*END_EXTERN*/
+
+/* la somme des opérations d'un mois pour une catégorie et une imputation */
+typedef struct _BetHistCell			BetHistCell;
+struct _BetHistCell
+{
+	gint			category_number;
+	gint			sub_category_number;
+	gint			budgetary_number;
+	gint			sub_budgetary_number;
+	GsbReal			amount;
+	gint			nb_transactions;
+};
+
+/* les agrégats d'un mois d'un compte */
+typedef struct _BetHistMonth		BetHistMonth;
+struct _BetHistMonth
+{
+	guint			month;						/* year * 12 + month - 1 */
+	GHashTable *	cells;						/* the BetHistCell, key and value */
+	GHashTable *	transactions;				/* the numbers of the transactions of the month */
+};
+
+/* ce qu'une opération a ajouté aux agrégats, pour pouvoir le retirer */
+typedef struct _BetHistContribution	BetHistContribution;
+struct _BetHistContribution
+{
+	gint			account_number;
+	guint			month;
+	guint32			julian_day;
+	BetHistCell		cell;						/* the key of the cell and the amount of the transaction */
+};
+
+/*START_STATIC*/
+/** the months of each account, key : the account number, value : a GHashTable
+ * of the BetHistMonth with the month as key */
+static GHashTable *cube_accounts = NULL;
+
+/** the BetHistContribution of each transaction, key : the transaction number */
+static GHashTable *cube_contributions = NULL;
+
+/** the transactions modified since the last use, key : the transaction number */
+static GHashTable *cube_pending = NULL;
+
+/** the aggregates are built */
+static gboolean cube_valid = FALSE;
+/*END_STATIC*/
+
+/******************************************************************************/
+/* Private functions                                                          */
+/******************************************************************************/
+/**
+ * GHashFunc of the cells
+ *
+ * \param key
+ *
+ * \return
+ **/
+static guint bet_hist_cube_cell_hash (gconstpointer key)
+{
+	const BetHistCell *cell = key;
+	guint hash;
+
+	hash = (guint) cell->category_number;
+	hash = hash * 31 + (guint) cell->sub_category_number;
+	hash = hash * 31 + (guint) cell->budgetary_number;
+	hash = hash * 31 + (guint) cell->sub_budgetary_number;
+
+	return hash;
+}
+
+/**
+ * GEqualFunc of the cells
+ *
+ * \param a
+ * \param b
+ *
+ * \return
+ **/
+static gboolean bet_hist_cube_cell_equal (gconstpointer a,
+										  gconstpointer b)
+{
+	const BetHistCell *cell_a = a;
+	const BetHistCell *cell_b = b;
+
+	return cell_a->category_number == cell_b->category_number
+		&& cell_a->sub_category_number == cell_b->sub_category_number
+		&& cell_a->budgetary_number == cell_b->budgetary_number
+		&& cell_a->sub_budgetary_number == cell_b->sub_budgetary_number;
+}
+
+/**
+ * free a month and its cells
+ *
+ * \param month
+ *
+ * \return
+ **/
+static void bet_hist_cube_month_free (BetHistMonth *month)
+{
+	g_hash_table_destroy (month->cells);
+	g_hash_table_destroy (month->transactions);
+	g_free (month);
+}
+
+/**
+ * return the months of an account
+ *
+ * \param account_number
+ * \param create			TRUE to create the table if it doesn't exist
+ *
+ * \return the GHashTable of the months or NULL
+ **/
+static GHashTable *bet_hist_cube_get_months (gint account_number,
+											 gboolean create)
+{
+	GHashTable *months;
+
+	months = g_hash_table_lookup (cube_accounts, GINT_TO_POINTER (account_number));
+	if (!months && create)
+	{
+		months = g_hash_table_new_full (g_direct_hash,
+										g_direct_equal,
+										NULL,
+										(GDestroyNotify) bet_hist_cube_month_free);
+		g_hash_table_insert (cube_accounts, GINT_TO_POINTER (account_number), months);
+	}
+
+	return months;
+}
+
+/**
+ * remove from the aggregates what the transaction added
+ *
+ * \param transaction_number
+ *
+ * \return
+ **/
+static void bet_hist_cube_remove_contribution (gint transaction_number)
+{
+	BetHistContribution *contribution;
+	BetHistMonth *month;
+	BetHistCell *cell;
+	GHashTable *months;
+
+	contribution = g_hash_table_lookup (cube_contributions, GINT_TO_POINTER (transaction_number));
+	if (!contribution)
+		return;
+
+	months = bet_hist_cube_get_months (contribution->account_number, FALSE);
+	month = g_hash_table_lookup (months, GUINT_TO_POINTER (contribution->month));
+
+	cell = g_hash_table_lookup (month->cells, &contribution->cell);
+	cell->amount = gsb_real_sub (cell->amount, contribution->cell.amount);
+	if (--cell->nb_transactions == 0)
+		g_hash_table_remove (month->cells, cell);
+
+	g_hash_table_remove (month->transactions, GINT_TO_POINTER (transaction_number));
+	if (g_hash_table_size (month->transactions) == 0)
+		g_hash_table_remove (months, GUINT_TO_POINTER (contribution->month));
+
+	g_hash_table_remove (cube_contributions, GINT_TO_POINTER (transaction_number));
+}
+
+/**
+ * add the transaction to the aggregates of its month,
+ * the split of transactions are not added, only their children
+ *
+ * \param transaction_number
+ *
+ * \return
+ **/
+static void bet_hist_cube_add_transaction (gint transaction_number)
+{
+	BetHistContribution *contribution;
+	BetHistMonth *month;
+	BetHistCell *cell;
+	GHashTable *months;
+	const GDate *date;
+	gint account_number;
+
+	if (transaction_number <= 0)
+		return;
+
+	account_number = gsb_data_transaction_get_account_number (transaction_number);
+	date = gsb_data_transaction_get_date (transaction_number);
+	if (account_number < 0
+		|| !date
+		|| !g_date_valid (date)
+		|| gsb_data_transaction_get_split_of_transaction (transaction_number))
+		return;
+
+	contribution = g_malloc0 (sizeof (BetHistContribution));
+	contribution->account_number = account_number;
+	contribution->month = g_date_get_year (date) * 12 + g_date_get_month (date) - 1;
+	contribution->julian_day = g_date_get_julian (date);
+	contribution->cell.category_number = gsb_data_transaction_get_category_number (transaction_number);
+	contribution->cell.sub_category_number = gsb_data_transaction_get_sub_category_number (transaction_number);
+	contribution->cell.budgetary_number = gsb_data_transaction_get_budgetary_number (transaction_number);
+	contribution->cell.sub_budgetary_number = gsb_data_transaction_get_sub_budgetary_number (transaction_number);
+	contribution->cell.amount = gsb_data_transaction_get_amount (transaction_number);
+	g_hash_table_insert (cube_contributions, GINT_TO_POINTER (transaction_number), contribution);
+
+	months = bet_hist_cube_get_months (account_number, TRUE);
+	month = g_hash_table_lookup (months, GUINT_TO_POINTER (contribution->month));
+	if (!month)
+	{
+		month = g_malloc0 (sizeof (BetHistMonth));
+		month->month = contribution->month;
+		month->cells = g_hash_table_new_full (bet_hist_cube_cell_hash,
+											  bet_hist_cube_cell_equal,
+											  NULL,
+											  g_free);
+		month->transactions = g_hash_table_new (g_direct_hash, g_direct_equal);
+		g_hash_table_insert (months, GUINT_TO_POINTER (month->month), month);
+	}
+
+	cell = g_hash_table_lookup (month->cells, &contribution->cell);
+	if (!cell)
+	{
+		cell = g_malloc0 (sizeof (BetHistCell));
+		*cell = contribution->cell;
+		cell->amount = null_real;
+		g_hash_table_add (month->cells, cell);
+	}
+	cell->amount = gsb_real_add (cell->amount, contribution->cell.amount);
+	cell->nb_transactions++;
+
+	g_hash_table_add (month->transactions, GINT_TO_POINTER (transaction_number));
+}
+
+/**
+ * build the aggregates at the first use, then update them
+ * with the transactions modified since the last use
+ *
+ * \param
+ *
+ * \return
+ **/
+static void bet_hist_cube_update (void)
+{
+	GHashTableIter iter;
+	gpointer key;
+
+	if (!cube_valid)
+	{
+		GSList *tmp_list;
+
+		bet_hist_cube_reset ();
+		cube_accounts = g_hash_table_new_full (g_direct_hash,
+											   g_direct_equal,
+											   NULL,
+											   (GDestroyNotify) g_hash_table_destroy);
+		cube_contributions = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, g_free);
+		cube_pending = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+		tmp_list = gsb_data_transaction_get_complete_transactions_list ();
+		while (tmp_list)
+		{
+			bet_hist_cube_add_transaction (gsb_data_transaction_get_transaction_number (tmp_list->data));
+			tmp_list = tmp_list->next;
+		}
+		cube_valid = TRUE;
+
+		return;
+	}
+
+	g_hash_table_iter_init (&iter, cube_pending);
+	while (g_hash_table_iter_next (&iter, &key, NULL))
+	{
+		bet_hist_cube_remove_contribution (GPOINTER_TO_INT (key));
+		bet_hist_cube_add_transaction (GPOINTER_TO_INT (key));
+	}
+	g_hash_table_remove_all (cube_pending);
+}
+
+/******************************************************************************/
+/* Public functions                                                           */
+/******************************************************************************/
+/**
+ * call func for the amounts of an account between 2 dates.
+ * a month which doesn't contain a cut date (except on its first day)
+ * is given as the sums of its cells, dated of the first day of the month ;
+ * the transactions of the other months are given one by one.
+ * So the caller can sort the amounts by date with the cut dates.
+ *
+ * \param account_number
+ * \param date_min		first day of the period
+ * \param date_max		last day of the period
+ * \param cut_dates		the days where the caller changes of period, can be NULL
+ * \param nb_cut_dates
+ * \param func
+ * \param data			given to func
+ *
+ * \return
+ **/
+void bet_hist_cube_foreach (gint account_number,
+							const GDate *date_min,
+							const GDate *date_max,
+							const GDate **cut_dates,
+							guint nb_cut_dates,
+							BetHistCubeFunc func,
+							gpointer data)
+{
+	BetHistCubeItem item;
+	GHashTable *months;
+	GHashTableIter month_iter;
+	gpointer value;
+	guint32 julian_min;
+	guint32 julian_max;
+
+	bet_hist_cube_update ();
+
+	months = bet_hist_cube_get_months (account_number, FALSE);
+	if (!months)
+		return;
+
+	julian_min = g_date_get_julian (date_min);
+	julian_max = g_date_get_julian (date_max);
+
+	memset (&item, 0, sizeof (BetHistCubeItem));
+	item.account_number = account_number;
+
+	g_hash_table_iter_init (&month_iter, months);
+	while (g_hash_table_iter_next (&month_iter, NULL, &value))
+	{
+		BetHistMonth *month = value;
+		GHashTableIter iter;
+		GDate date;
+		gpointer key;
+		guint32 first_day;
+		guint32 last_day;
+		gboolean whole_month;
+		guint i;
+
+		g_date_clear (&date, 1);
+		g_date_set_dmy (&date, 1, month->month % 12 + 1, month->month / 12);
+		first_day = g_date_get_julian (&date);
+		last_day = first_day + g_date_get_days_in_month (g_date_get_month (&date), g_date_get_year (&date)) - 1;
+
+		if (last_day < julian_min || first_day > julian_max)
+			continue;
+
+		whole_month = first_day >= julian_min && last_day <= julian_max;
+		for (i = 0; whole_month && i < nb_cut_dates; i++)
+		{
+			guint32 cut_day;
+
+			cut_day = g_date_get_julian (cut_dates[i]);
+			if (cut_day > first_day && cut_day <= last_day)
+				whole_month = FALSE;
+		}
+
+		if (whole_month)
+		{
+			item.transaction_number = 0;
+			item.date = &date;
+
+			g_hash_table_iter_init (&iter, month->cells);
+			while (g_hash_table_iter_next (&iter, &key, NULL))
+			{
+				BetHistCell *cell = key;
+
+				item.category_number = cell->category_number;
+				item.sub_category_number = cell->sub_category_number;
+				item.budgetary_number = cell->budgetary_number;
+				item.sub_budgetary_number = cell->sub_budgetary_number;
+				item.amount = cell->amount;
+				func (&item, data);
+			}
+			continue;
+		}
+
+		g_hash_table_iter_init (&iter, month->transactions);
+		while (g_hash_table_iter_next (&iter, &key, NULL))
+		{
+			BetHistContribution *contribution;
+
+			contribution = g_hash_table_lookup (cube_contributions, key);
+			if (contribution->julian_day < julian_min || contribution->julian_day > julian_max)
+				continue;
+
+			g_date_set_julian (&date, contribution->julian_day);
+			item.transaction_number = GPOINTER_TO_INT (key);
+			item.date = &date;
+			item.category_number = contribution->cell.category_number;
+			item.sub_category_number = contribution->cell.sub_category_number;
+			item.budgetary_number = contribution->cell.budgetary_number;
+			item.sub_budgetary_number = contribution->cell.sub_budgetary_number;
+			item.amount = contribution->cell.amount;
+			func (&item, data);
+		}
+	}
+}
+
+/**
+ * the transaction is created, modified or deleted, it will be
+ * taken into account at the next use of the aggregates
+ *
+ * \param transaction_number
+ *
+ * \return
+ **/
+void bet_hist_cube_mark_transaction (gint transaction_number)
+{
+	if (!cube_valid || transaction_number <= 0)
+		return;
+
+	g_hash_table_add (cube_pending, GINT_TO_POINTER (transaction_number));
+}
+
+/**
+ * free the aggregates, they will be built again at the next use
+ *
+ * \param
+ *
+ * \return
+ **/
+void bet_hist_cube_reset (void)
+{
+	cube_valid = FALSE;
+
+	if (cube_accounts)
+	{
+		g_hash_table_destroy (cube_accounts);
+		cube_accounts = NULL;
+	}
+	if (cube_contributions)
+	{
+		g_hash_table_destroy (cube_contributions);
+		cube_contributions = NULL;
+	}
+	if (cube_pending)
+	{
+		g_hash_table_destroy (cube_pending);
+		cube_pending = NULL;
+	}
+}
+
+/* Local Variables: */
+/* c-basic-offset: 4 */
+/* End: */
@@ -0,0 +1,40 @@
+#ifndef _BET_HIST_CUBE_H
+#define _BET_HIST_CUBE_H
+
+#include <glib.h>
+
+/* START_INCLUDE_H */
+#include "gsb_real.h"
+/* END_INCLUDE_H */
+
+typedef struct _BetHistCubeItem				BetHistCubeItem;
+
+/* un montant donné par les agrégats mensuels des données historiques */
+struct _BetHistCubeItem
+{
+	gint			account_number;
+	gint			category_number;
+	gint			sub_category_number;
+	gint			budgetary_number;
+	gint			sub_budgetary_number;
+	gint			transaction_number;			/* 0 for the sum of a month */
+	const GDate *	date;						/* date of the transaction or first day of the month */
+	GsbReal			amount;
+};
+
+typedef void (*BetHistCubeFunc) (const BetHistCubeItem *item,
+								 gpointer data);
+
+/* START_DECLARATION */
+void	bet_hist_cube_foreach						(gint account_number,
+													 const GDate *date_min,
+													 const GDate *date_max,
+													 const GDate **cut_dates,
+													 guint nb_cut_dates,
+													 BetHistCubeFunc func,
+													 gpointer data);
+void	bet_hist_cube_mark_transaction				(gint transaction_number);
+void	bet_hist_cube_reset							(void);
+/* END_DECLARATION */
+
+#endif
@@ -28,6 +28,8 @@
 
 /*START_INCLUDE*/
 #include "bet_tab.h"
+#include "bet_consolidated.h"
+#include "bet_forecast.h"
 #include "bet_future.h"
 #ifdef HAVE_GOFFICE
 #include "bet_graph.h"
@@ -69,7 +71,38 @@
 /*END_INCLUDE*/
 
 
+typedef struct _BetArrayLine				BetArrayLine;
+typedef struct _BetArraySource				BetArraySource;
+typedef struct _BetArrayView				BetArrayView;
+
+/* une ligne du tableau qui montre un événement de la prévision */
+struct _BetArrayLine
+{
+	GtkTreeIter		iter;
+	gboolean		shown;						/* TRUE if the balance column shows selected and balance */
+	gboolean		selected;
+	GsbReal			balance;
+};
+
+/* une source de lignes du tableau des prévisions modifiée depuis son dernier calcul */
+struct _BetArraySource
+{
+	gint			origin;						/* SPP_ORIGIN_FUTURE or SPP_ORIGIN_SCHEDULED */
+	gint			number;						/* future or scheduled number */
+};
+
+/* les lignes du tableau des prévisions, la clé d'un événement est son index dans lines */
+struct _BetArrayView
+{
+	GArray *		lines;						/* the BetArrayLine, the line 0 is the balance beginning of period */
+	gboolean		sorted;						/* TRUE if the new events are inserted at their place */
+	guint			first_changed;				/* first event whose balance must be computed again */
+};
+
 /*START_STATIC*/
+/* sources changed since the last computation of the array, see bet_array_mark_source_changed */
+static GArray *				bet_array_changed_sources = NULL;
+static gint					bet_array_changed_sources_account = 0;
 /* largeur des colonnes effectives */
 static gint 				bet_array_col_width[BET_ARRAY_COLUMNS];
 /* the initial width of each column */
@@ -86,6 +119,214 @@ static GtkTreeViewColumn *	bet_array_tree_view_columns[BET_ARRAY_COLUMNS];	/* ta
 /******************************************************************************/
 /* Private functions                                                          */
 /******************************************************************************/
+/**
+ * return the amount of a line of the array of forecast
+ *
+ * \param model
+ * \param iter
+ *
+ * \return the amount in the currency of the account
+ **/
+static GsbReal bet_array_model_get_amount (GtkTreeModel *model,
+										   GtkTreeIter *iter)
+{
+	gint64 mantissa;
+	gint exponent;
+
+	gtk_tree_model_get (model,
+						iter,
+						SPP_ESTIMATE_TREE_AMOUNT_MANTISSA, &mantissa,
+						SPP_ESTIMATE_TREE_AMOUNT_EXPONENT, &exponent,
+						-1);
+
+	return gsb_real_new (mantissa, exponent);
+}
+
+/**
+ * free the lines of the array
+ *
+ * \param view
+ *
+ * \return
+ **/
+static void bet_array_view_free (BetArrayView *view)
+{
+	g_array_free (view->lines, TRUE);
+	g_free (view);
+}
+
+/**
+ * start a new forecast for the lines of the array. The lines are added
+ * with bet_array_list_add_event, the forecast is kept in the model.
+ *
+ * \param model
+ * \param initial_balance	the balance beginning of period
+ *
+ * \return
+ **/
+static void bet_array_list_new_forecast (GtkTreeModel *model,
+										 GsbReal initial_balance)
+{
+    BetArrayView *view;
+    BetArrayLine line = {0};
+
+    view = g_malloc0 (sizeof (BetArrayView));
+    view->lines = g_array_new (FALSE, FALSE, sizeof (BetArrayLine));
+    view->sorted = FALSE;
+    view->first_changed = 0;
+
+    /* the key 0 is the line of the balance beginning of period, it is not an event */
+    g_array_append_val (view->lines, line);
+
+    g_object_set_data_full (G_OBJECT (model),
+							"bet_forecast",
+							bet_forecast_new (initial_balance, SPP_ORIGIN_SOLDE, 0),
+							(GDestroyNotify) bet_forecast_free);
+    g_object_set_data_full (G_OBJECT (model), "bet_array_view", view, (GDestroyNotify) bet_array_view_free);
+}
+
+/**
+ * return the index of the event of a line of the array
+ *
+ * \param forecast
+ * \param model
+ * \param iter
+ *
+ * \return the index of the event or -1 for the balance beginning of period
+ **/
+static gint bet_array_list_find_event (BetForecast *forecast,
+									   GtkTreeModel *model,
+									   GtkTreeIter *iter)
+{
+    guint key = 0;
+    guint i;
+
+    gtk_tree_model_get (model, iter, SPP_ESTIMATE_TREE_EVENT_KEY, &key, -1);
+    if (key == 0)
+        return -1;
+
+    for (i = 0; i < bet_forecast_get_nb_events (forecast); i++)
+    {
+        if (bet_forecast_get_event (forecast, i)->key == key)
+            return i;
+    }
+
+    return -1;
+}
+
+/**
+ * add the event of a new line of the array to the forecast, at the end
+ * while the array is filled and at its place after
+ *
+ * \param model
+ * \param iter			the new line
+ * \param julian_day
+ * \param origin
+ * \param number
+ * \param amount		in the currency of the account
+ *
+ * \return
+ **/
+static void bet_array_list_add_event (GtkTreeModel *model,
+									  GtkTreeIter *iter,
+									  guint32 julian_day,
+									  gint origin,
+									  gint number,
+									  GsbReal amount)
+{
+    BetForecast *forecast;
+    BetArrayView *view;
+    BetArrayLine line = {0};
+    guint key;
+    guint index;
+
+    forecast = g_object_get_data (G_OBJECT (model), "bet_forecast");
+    view = g_object_get_data (G_OBJECT (model), "bet_array_view");
+    if (!forecast || !view)
+        return;
+
+    key = view->lines->len;
+    line.iter = *iter;
+    g_array_append_val (view->lines, line);
+    gtk_tree_store_set (GTK_TREE_STORE (model), iter, SPP_ESTIMATE_TREE_EVENT_KEY, key, -1);
+
+    if (view->sorted)
+    {
+        index = bet_forecast_insert_event (forecast, julian_day, origin, number, amount, FALSE);
+        bet_forecast_get_event (forecast, index)->key = key;
+    }
+    else
+    {
+        bet_forecast_append_event (forecast, julian_day, origin, number, amount, FALSE)->key = key;
+        index = bet_forecast_get_nb_events (forecast) - 1;
+    }
+
+    view->first_changed = MIN (view->first_changed, index);
+}
+
+/**
+ * remove a line of the array and its event
+ *
+ * \param model
+ * \param iter
+ *
+ * \return
+ **/
+static void bet_array_list_remove_line (GtkTreeModel *model,
+										GtkTreeIter *iter)
+{
+    BetForecast *forecast;
+    BetArrayView *view;
+
+    forecast = g_object_get_data (G_OBJECT (model), "bet_forecast");
+    view = g_object_get_data (G_OBJECT (model), "bet_array_view");
+    if (forecast && view)
+    {
+        gint index;
+
+        index = bet_array_list_find_event (forecast, model, iter);
+        if (index >= 0)
+        {
+            bet_forecast_remove_event (forecast, index);
+            view->first_changed = MIN (view->first_changed, (guint) index);
+        }
+    }
+
+    gtk_tree_store_remove (GTK_TREE_STORE (model), iter);
+}
+
+/**
+ * change the amount of the event of a line of the array
+ *
+ * \param model
+ * \param iter
+ * \param amount
+ *
+ * \return
+ **/
+static void bet_array_list_set_event_amount (GtkTreeModel *model,
+											 GtkTreeIter *iter,
+											 GsbReal amount)
+{
+    BetForecast *forecast;
+    BetArrayView *view;
+    gint index;
+
+    forecast = g_object_get_data (G_OBJECT (model), "bet_forecast");
+    view = g_object_get_data (G_OBJECT (model), "bet_array_view");
+    if (!forecast || !view)
+        return;
+
+    index = bet_array_list_find_event (forecast, model, iter);
+    if (index < 0)
+        return;
+
+    bet_forecast_get_event (forecast, index)->amount = amount;
+
+    /* the amount is a part of the order of the events */
+    view->sorted = FALSE;
+}
+
 /**
  * Cette fonction recalcule le montant des données historiques en fonction de la
  * consommation mensuelle précédente. affiche le nouveau montant si même signe ou 0
@@ -148,7 +389,7 @@ static void bet_array_adjust_hist_amount (gint div_number,
                 date_today = gdate_today ();
                 if (g_date_get_month (date) - g_date_get_month (date_today) == 0)
                 {
-                    number = utils_real_get_from_string (str_amount);
+                    number = bet_array_model_get_amount (model, &iter);
                     if (number.mantissa != 0)
                     {
                         sign = bet_data_get_div_type (div_number);
@@ -173,6 +414,7 @@ static void bet_array_adjust_hist_amount (gint div_number,
                                             null_real,
                                             currency_number,
                                             TRUE);
+                                number = null_real;
                                 str_amount = g_strdup ("0.00");
                                 str_desc = g_strconcat (div_name, _(" (budget exceeded)"), NULL);
                             }
@@ -194,6 +436,7 @@ static void bet_array_adjust_hist_amount (gint div_number,
                                             null_real,
                                             currency_number,
                                             TRUE);
+                                number = null_real;
                                 str_amount = g_strdup ("0.00");
                                 str_desc = g_strconcat (div_name, _(" (budget exceeded)"), NULL);
                             }
@@ -204,7 +447,10 @@ static void bet_array_adjust_hist_amount (gint div_number,
                                             SPP_ESTIMATE_TREE_DEBIT_COLUMN, str_debit,
                                             SPP_ESTIMATE_TREE_CREDIT_COLUMN, str_credit,
                                             SPP_ESTIMATE_TREE_AMOUNT_COLUMN, str_amount,
+                                            SPP_ESTIMATE_TREE_AMOUNT_MANTISSA, number.mantissa,
+                                            SPP_ESTIMATE_TREE_AMOUNT_EXPONENT, number.exponent,
                                             -1);
+                        bet_array_list_set_event_amount (model, &iter, number);
 
 						g_free (str_credit);
 						g_free (str_debit);
@@ -304,50 +550,35 @@ static gint bet_array_date_sort_function (GtkTreeModel *model,
     result = g_date_compare (date_b, date_a);
     if (result == 0)
     {
-        gint origine_a;
-        gint origine_b;
-        gchar *str_amount_a;
-        gchar *str_amount_b;
-		gchar *str_description_a;
- 		gchar *str_description_b;
+        BetForecastEvent event_a;
+        BetForecastEvent event_b;
 
-        gtk_tree_model_get (GTK_TREE_MODEL (model),
+        /* same order as bet_forecast_sort, the model is sorted descending */
+        event_a.julian_day = event_b.julian_day = 0;
+        gtk_tree_model_get (model,
 							itera,
-							SPP_ESTIMATE_TREE_ORIGIN_DATA, &origine_a,
-							SPP_ESTIMATE_TREE_AMOUNT_COLUMN, &str_amount_a,
-							SPP_ESTIMATE_TREE_DESC_COLUMN, &str_description_a,
+							SPP_ESTIMATE_TREE_ORIGIN_DATA, &event_a.origin,
+							SPP_ESTIMATE_TREE_AMOUNT_MANTISSA, &event_a.amount.mantissa,
+							SPP_ESTIMATE_TREE_AMOUNT_EXPONENT, &event_a.amount.exponent,
 							-1);
-
-		gtk_tree_model_get (GTK_TREE_MODEL (model),
+        gtk_tree_model_get (model,
 							iterb,
-							SPP_ESTIMATE_TREE_ORIGIN_DATA, &origine_b,
-							SPP_ESTIMATE_TREE_AMOUNT_COLUMN, &str_amount_b,
-							SPP_ESTIMATE_TREE_DESC_COLUMN, &str_description_b,
+							SPP_ESTIMATE_TREE_ORIGIN_DATA, &event_b.origin,
+							SPP_ESTIMATE_TREE_AMOUNT_MANTISSA, &event_b.amount.mantissa,
+							SPP_ESTIMATE_TREE_AMOUNT_EXPONENT, &event_b.amount.exponent,
 							-1);
-		//~ printf ("date_a = %s amount_a = %s str_description_a = %s origine_a = %d\ndate_b = %s amount_b = %s str_description_b =%s origine_b = %d\n",
-				//~ gsb_format_gdate (date_a), str_amount_a, str_description_a,origine_a,
-				//~ gsb_format_gdate (date_b), str_amount_b, str_description_b, origine_b);
 
-        if (origine_a == SPP_ORIGIN_SOLDE)
+        result = -bet_forecast_compare_events (&event_a, &event_b, SPP_ORIGIN_SOLDE);
+        if (result == 0)
         {
-            result = 1;
-        }
-		else if (origine_a == origine_b)
-		{
-			GsbReal amount_a = null_real;
-			GsbReal amount_b = null_real;
-
-			amount_a = utils_real_get_from_string (str_amount_a);
-			amount_b = utils_real_get_from_string (str_amount_b);
-			result = (gsb_real_cmp (amount_a, amount_b));
-		}
-		else
-			result = (origine_b -origine_a);
+            guint key_a = 0;
+            guint key_b = 0;
 
-		g_free (str_amount_a);
-		g_free (str_amount_b);
-		g_free (str_description_a);
-		g_free (str_description_b);
+            gtk_tree_model_get (model, itera, SPP_ESTIMATE_TREE_EVENT_KEY, &key_a, -1);
+            gtk_tree_model_get (model, iterb, SPP_ESTIMATE_TREE_EVENT_KEY, &key_b, -1);
+            if (key_a != key_b)
+                result = key_a < key_b ? 1 : -1;
+        }
     }
 
     g_value_unset (&date_value_b);
@@ -514,106 +745,104 @@ static gboolean bet_array_initializes_account_settings (gint account_number)
 }
 
 /**
- * This function is called for each line of the array.
- * It calculates the balance column by adding the amount of the line
- * to the balance of the previous line.
- * It calculates the minimum and the maximum values of the balance column.
+ * write the balance of an event in its line
  *
- * \param
- * \param
- * \param
- * \param	BetRange tmp_range
+ * \param model
+ * \param iter
+ * \param event
+ * \param currency_number
  *
  * \return
  **/
-static gboolean bet_array_update_average_column (GtkTreeModel *model,
-                        						 GtkTreePath *path,
-                        						 GtkTreeIter *iter,
-                        						 gpointer data)
+static void bet_array_list_set_balance (GtkTreeModel *model,
+										GtkTreeIter *iter,
+										BetForecastEvent *event,
+										gint currency_number)
 {
-    gchar *str_balance = NULL;
-    gchar *tmp_str;
-    const gchar *color_str = NULL;
-    gint selected_account;
-    gboolean select = FALSE;
-    BetRange *tmp_range = (BetRange*) data;
-    GsbReal amount;
-
-    if (tmp_range->first_pass)
-    {
-        tmp_range->first_pass = FALSE;
-        return FALSE;
-    }
+    gchar str_balance[GSB_REAL_FORMAT_BUF_SIZE];
 
-	gtk_tree_model_get (model, iter, SPP_ESTIMATE_TREE_SELECT_COLUMN, &select, -1);
-    if (select)
+    if (event->selected)
     {
         gtk_tree_store_set (GTK_TREE_STORE (model),
 							iter,
-                        	SPP_ESTIMATE_TREE_BALANCE_COLUMN, "",
-                        	-1);
-
-        return FALSE;
+							SPP_ESTIMATE_TREE_BALANCE_COLUMN, "",
+							-1);
+        return;
     }
 
-    selected_account = gsb_gui_navigation_get_current_account ();
-    if (selected_account == -1)
-        return FALSE;
-
-    gtk_tree_model_get (model, iter, SPP_ESTIMATE_TREE_AMOUNT_COLUMN, &tmp_str, -1);
-
-	amount = utils_real_get_from_string (tmp_str);
-	g_free (tmp_str);
-
-    tmp_range->current_balance = gsb_real_add (tmp_range->current_balance, amount);
-    str_balance = utils_real_get_string_with_currency (tmp_range->current_balance,
-													   gsb_data_account_get_currency (selected_account),
-													   TRUE);
-
-    if (tmp_range->current_balance.mantissa < 0)
-        color_str = "red";
-    else
-        color_str = NULL;
-
+    utils_real_write_string_with_currency (event->balance,
+										   currency_number,
+										   TRUE,
+										   str_balance,
+										   sizeof (str_balance));
     gtk_tree_store_set (GTK_TREE_STORE (model),
-                        iter,
-                        SPP_ESTIMATE_TREE_BALANCE_COLUMN, str_balance,
-                        SPP_ESTIMATE_TREE_BALANCE_COLOR, color_str,
-                        -1);
-    g_free (str_balance);
-
-    return FALSE;
+						iter,
+						SPP_ESTIMATE_TREE_BALANCE_COLUMN, str_balance,
+						SPP_ESTIMATE_TREE_BALANCE_COLOR, event->balance.mantissa < 0 ? "red" : NULL,
+						-1);
 }
 
 /**
+ * Update the balance column of the array. The balances are computed by
+ * bet_forecast from the first changed event, only the lines whose balance
+ * changed are formatted again.
  *
- *
- * \param
+ * \param model
+ * \param account_number
  *
  * \return
  **/
-static void bet_array_list_update_balance (GtkTreeModel *model)
+static void bet_array_list_update_balance (GtkTreeModel *model,
+										   gint account_number)
 {
-    GtkTreeIter iter;
+    BetForecast *forecast;
+    BetArrayView *view;
+    gint currency_number;
+    guint i;
 
-    if (gtk_tree_model_get_iter_first (model, &iter))
+    forecast = g_object_get_data (G_OBJECT (model), "bet_forecast");
+    view = g_object_get_data (G_OBJECT (model), "bet_array_view");
+    if (!forecast || !view || account_number == -1)
+        return;
+
+    /* the events are sorted once the array is filled */
+    if (!view->sorted)
     {
-        gchar *str_current_balance;
-        GsbReal current_balance;
-        BetRange *tmp_range;
+        bet_forecast_sort (forecast);
+        view->sorted = TRUE;
+        view->first_changed = 0;
+    }
 
-        gtk_tree_model_get (model,
-							&iter,
-							SPP_ESTIMATE_TREE_AMOUNT_COLUMN, &str_current_balance,
-							-1);
-        current_balance = utils_real_get_from_string (str_current_balance);
+    if (view->first_changed < bet_forecast_get_nb_events (forecast))
+    {
+        bet_forecast_compute_balances (forecast, view->first_changed);
+        currency_number = gsb_data_account_get_currency (account_number);
 
-        tmp_range = bet_data_bet_range_struct_init ();
-        tmp_range->first_pass = TRUE;
-        tmp_range->current_balance = current_balance;
+        for (i = view->first_changed; i < bet_forecast_get_nb_events (forecast); i++)
+        {
+            BetForecastEvent *event;
+            BetArrayLine *line;
+
+            event = bet_forecast_get_event (forecast, i);
+            line = &g_array_index (view->lines, BetArrayLine, event->key);
+
+            /* the line shows already this balance */
+            if (line->shown
+                && line->selected == event->selected
+                && (event->selected
+                    || (line->balance.mantissa == event->balance.mantissa
+                        && line->balance.exponent == event->balance.exponent)))
+                continue;
 
-        gtk_tree_model_foreach (GTK_TREE_MODEL (model), bet_array_update_average_column, tmp_range);
+            bet_array_list_set_balance (model, &line->iter, event, currency_number);
+            line->shown = TRUE;
+            line->selected = event->selected;
+            line->balance = event->balance;
+        }
     }
+    view->first_changed = G_MAXUINT;
+
+    g_object_set_data (G_OBJECT (model), "bet_forecast_account", GINT_TO_POINTER (account_number));
 }
 
 /**
@@ -629,7 +858,10 @@ static void bet_array_list_add_substract_menu (GtkWidget *menu_item,
 {
     GtkTreeModel *model;
     GtkTreeIter iter;
+    BetForecast *forecast;
+    BetArrayView *view;
     gboolean select = FALSE;
+    gint index;
 
     if (!gtk_tree_selection_get_selected (GTK_TREE_SELECTION (tree_selection), &model, &iter))
         return;
@@ -639,7 +871,19 @@ static void bet_array_list_add_substract_menu (GtkWidget *menu_item,
 						&iter,
                         SPP_ESTIMATE_TREE_SELECT_COLUMN, 1 - select,
                         -1);
-    bet_array_list_update_balance (model);
+
+    forecast = g_object_get_data (G_OBJECT (model), "bet_forecast");
+    view = g_object_get_data (G_OBJECT (model), "bet_array_view");
+    if (!forecast || !view)
+        return;
+
+    index = bet_array_list_find_event (forecast, model, &iter);
+    if (index < 0)
+        return;
+
+    bet_forecast_get_event (forecast, index)->selected = !select;
+    view->first_changed = MIN (view->first_changed, (guint) index);
+    bet_array_list_update_balance (model, gsb_gui_navigation_get_current_account ());
 }
 /**
  *
@@ -733,7 +977,9 @@ static void bet_array_list_delete_all_future_menu (GtkWidget *menu_item,
         account_number = gsb_gui_navigation_get_current_account ();
         bet_data_future_remove_lines (account_number, number, mother_row);
 
-        gsb_data_account_set_bet_maj (account_number, BET_MAJ_ESTIMATE);
+        bet_array_mark_source_changed (account_number, SPP_ORIGIN_FUTURE, number);
+        if (mother_row > 0)
+            bet_array_mark_source_changed (account_number, SPP_ORIGIN_FUTURE, mother_row);
         bet_data_update_bet_module (account_number, GSB_ESTIMATE_PAGE);
     }
 }
@@ -905,7 +1151,7 @@ static void bet_array_list_delete_menu (GtkWidget *menu_item,
                         SPP_ESTIMATE_TREE_SUB_DIV_COLUMN, &sub_div_nb,
                         -1);
         bet_data_hist_div_remove (account_number, number, sub_div_nb);
-        gtk_tree_store_remove (GTK_TREE_STORE (model), &iter);
+        bet_array_list_remove_line (model, &iter);
 
         gsb_data_account_set_bet_maj (account_number, BET_MAJ_HISTORICAL);
     }
@@ -920,7 +1166,7 @@ static void bet_array_list_delete_menu (GtkWidget *menu_item,
 
     tree_view = gtk_tree_selection_get_tree_view (tree_selection);
     bet_array_list_set_background_color (GTK_WIDGET (tree_view));
-    bet_array_list_update_balance (model);
+    bet_array_list_update_balance (model, gsb_gui_navigation_get_current_account ());
 }
 
 /**
@@ -1619,9 +1865,12 @@ static gboolean bet_array_shows_balance_at_beginning_of_month (GtkTreeModel *tab
                         	SPP_ESTIMATE_TREE_DATE_COLUMN, str_date,
                         	SPP_ESTIMATE_TREE_DESC_COLUMN, str_description,
                         	SPP_ESTIMATE_TREE_AMOUNT_COLUMN, str_amount,
+                        	SPP_ESTIMATE_TREE_AMOUNT_MANTISSA, null_real.mantissa,
+                        	SPP_ESTIMATE_TREE_AMOUNT_EXPONENT, null_real.exponent,
                         	SPP_ESTIMATE_TREE_BALANCE_COLOR, NULL,
                         	SPP_ESTIMATE_TREE_BACKGROUND_COLOR, gsb_rgba_get_couleur ("background_bet_solde"),
                         	-1);
+        bet_array_list_add_event (tab_model, &tab_iter, g_date_get_julian (date), SPP_ORIGIN_SOLDE, 0, null_real);
 
         g_value_unset (&date_value);
         g_free (str_date);
@@ -1832,7 +2081,7 @@ static gboolean bet_array_list_replace_line_by_transfert (GtkTreeModel *tab_mode
 
 			if (transfert->main_payee_number == tmp_payee_number)
 			{
-				gtk_tree_store_remove (GTK_TREE_STORE (tab_model), &iter);
+				bet_array_list_remove_line (tab_model, &iter);
 
 				g_date_free (date);
 				trouve = TRUE;
@@ -1975,7 +2224,10 @@ static GtkWidget *bet_array_create_tree_view (GtkWidget *container)
                     G_TYPE_STRING,      /* SPP_ESTIMATE_TREE_AMOUNT_COLUMN */
                     G_TYPE_STRING,      /* SPP_ESTIMATE_TREE_BALANCE_COLOR */
                     GDK_TYPE_RGBA,      /* SPP_ESTIMATE_TREE_BACKGROUND_COLOR */
-                    G_TYPE_STRING);    /* SPP_ESTIMATE_TREE_COLOR_STRING */
+                    G_TYPE_STRING,      /* SPP_ESTIMATE_TREE_COLOR_STRING */
+                    G_TYPE_INT64,       /* SPP_ESTIMATE_TREE_AMOUNT_MANTISSA */
+                    G_TYPE_INT,         /* SPP_ESTIMATE_TREE_AMOUNT_EXPONENT */
+                    G_TYPE_UINT);       /* SPP_ESTIMATE_TREE_EVENT_KEY */
 
     gtk_tree_view_set_model (GTK_TREE_VIEW (tree_view), GTK_TREE_MODEL (tree_model));
 
@@ -2166,6 +2418,86 @@ static GtkWidget *bet_array_list_create_toolbar (GtkWidget *parent,
     return (toolbar);
 }
 
+/**
+ * Ajoute une ligne future au tableau des résultats
+ *
+ * \param tab_model
+ * \param account_number
+ * \param scheduled			the future data
+ * \param inverse_amount		TRUE for the account of destination of a transfer
+ *
+ * \return
+ **/
+static void bet_array_refresh_futur_line (GtkTreeModel *tab_model,
+										  gint account_number,
+										  FuturData *scheduled,
+										  gboolean inverse_amount)
+{
+    GtkTreeIter tab_iter;
+    GValue date_value = G_VALUE_INIT;
+    gchar *str_debit = NULL;
+    gchar *str_credit = NULL;
+    gchar *str_date;
+    gchar *str_description;
+    gchar *str_amount;
+    GsbReal amount;
+    gint currency_number;
+
+    str_description = bet_array_list_get_description (account_number, SPP_ORIGIN_FUTURE, scheduled);
+
+    if (inverse_amount)
+        amount = gsb_real_opposite (scheduled->amount);
+    else
+        amount = scheduled->amount;
+
+    currency_number = gsb_data_account_get_currency (account_number);
+    str_amount = utils_real_get_string (amount);
+
+    if (amount.mantissa < 0)
+        str_debit = utils_real_get_string_with_currency (gsb_real_opposite (amount),
+														 currency_number,
+														 TRUE);
+    else
+        str_credit = utils_real_get_string_with_currency (amount, currency_number, TRUE);
+
+    str_date = gsb_format_gdate (scheduled->date);
+
+    g_value_init (&date_value, G_TYPE_DATE);
+    g_value_set_boxed (&date_value, scheduled->date);
+
+    /* add a line in the estimate array */
+    gtk_tree_store_append (GTK_TREE_STORE (tab_model), &tab_iter, NULL);
+    gtk_tree_store_set_value (GTK_TREE_STORE (tab_model),
+							  &tab_iter,
+							  SPP_ESTIMATE_TREE_SORT_DATE_COLUMN, &date_value);
+    gtk_tree_store_set (GTK_TREE_STORE (tab_model),
+						&tab_iter,
+                        SPP_ESTIMATE_TREE_ORIGIN_DATA, SPP_ORIGIN_FUTURE,
+                        SPP_ESTIMATE_TREE_DIVISION_COLUMN, scheduled->number,
+                        SPP_ESTIMATE_TREE_SUB_DIV_COLUMN, scheduled->mother_row,
+                        SPP_ESTIMATE_TREE_DATE_COLUMN, str_date,
+                        SPP_ESTIMATE_TREE_DESC_COLUMN, str_description,
+                        SPP_ESTIMATE_TREE_DEBIT_COLUMN, str_debit,
+                        SPP_ESTIMATE_TREE_CREDIT_COLUMN, str_credit,
+                        SPP_ESTIMATE_TREE_AMOUNT_COLUMN, str_amount,
+                        SPP_ESTIMATE_TREE_AMOUNT_MANTISSA, amount.mantissa,
+                        SPP_ESTIMATE_TREE_AMOUNT_EXPONENT, amount.exponent,
+                        -1);
+    bet_array_list_add_event (tab_model,
+							  &tab_iter,
+							  g_date_get_julian (scheduled->date),
+							  SPP_ORIGIN_FUTURE,
+							  scheduled->number,
+							  amount);
+
+    g_value_unset (&date_value);
+    g_free (str_date);
+    g_free (str_description);
+    g_free (str_amount);
+    g_free (str_debit);
+    g_free (str_credit);
+}
+
 /**
  * Ajoute la ligne future au tableau des résultats
  *
@@ -2198,16 +2530,7 @@ static gboolean bet_array_refresh_futur_data (GtkTreeModel *tab_model,
     while (g_hash_table_iter_next (&iter, &key, &value))
     {
         FuturData *scheduled = (FuturData *) value;
-        GtkTreeIter tab_iter;
-        GValue date_value = G_VALUE_INIT;
-        gchar *str_debit = NULL;
-        gchar *str_credit = NULL;
-        gchar *str_date;
-        gchar *str_description;
-        gchar *str_amount;
-        GsbReal amount;
         gboolean inverse_amount = FALSE;
-        gint currency_number;
 
         if (account_number != scheduled->account_number)
         {
@@ -2236,51 +2559,7 @@ static gboolean bet_array_refresh_futur_data (GtkTreeModel *tab_model,
         if (g_date_compare (scheduled->date, date_min) < 0)
             continue;
 
-        str_description = bet_array_list_get_description (account_number, SPP_ORIGIN_FUTURE, value);
-
-        if (inverse_amount)
-            amount = gsb_real_opposite (scheduled->amount);
-        else
-            amount = scheduled->amount;
-
-        currency_number = gsb_data_account_get_currency (account_number);
-        str_amount = utils_real_get_string (amount);
-
-        if (amount.mantissa < 0)
-            str_debit = utils_real_get_string_with_currency (gsb_real_opposite (amount),
-															 currency_number,
-															 TRUE);
-        else
-            str_credit = utils_real_get_string_with_currency (amount, currency_number, TRUE);
-
-        str_date = gsb_format_gdate (scheduled->date);
-
-        g_value_init (&date_value, G_TYPE_DATE);
-        g_value_set_boxed (&date_value, scheduled->date);
-
-        /* add a line in the estimate array */
-        gtk_tree_store_append (GTK_TREE_STORE (tab_model), &tab_iter, NULL);
-        gtk_tree_store_set_value (GTK_TREE_STORE (tab_model),
-								  &tab_iter,
-								  SPP_ESTIMATE_TREE_SORT_DATE_COLUMN, &date_value);
-        gtk_tree_store_set (GTK_TREE_STORE (tab_model),
-							&tab_iter,
-                        	SPP_ESTIMATE_TREE_ORIGIN_DATA, SPP_ORIGIN_FUTURE,
-                        	SPP_ESTIMATE_TREE_DIVISION_COLUMN, scheduled->number,
-                        	SPP_ESTIMATE_TREE_SUB_DIV_COLUMN, scheduled->mother_row,
-                        	SPP_ESTIMATE_TREE_DATE_COLUMN, str_date,
-                        	SPP_ESTIMATE_TREE_DESC_COLUMN, str_description,
-                        	SPP_ESTIMATE_TREE_DEBIT_COLUMN, str_debit,
-                        	SPP_ESTIMATE_TREE_CREDIT_COLUMN, str_credit,
-                        	SPP_ESTIMATE_TREE_AMOUNT_COLUMN, str_amount,
-                        	-1);
-
-        g_value_unset (&date_value);
-        g_free (str_date);
-        g_free (str_description);
-        g_free (str_amount);
-        g_free (str_debit);
-        g_free (str_credit);
+        bet_array_refresh_futur_line (tab_model, account_number, scheduled, inverse_amount);
     }
 
     g_date_free (date_tomorrow);
@@ -2289,191 +2568,201 @@ static gboolean bet_array_refresh_futur_data (GtkTreeModel *tab_model,
 }
 
 /**
+ * Ajoute les occurrences d'une opération planifiée au tableau des résultats
  *
- *
- * \param
- * \param
- * \param
- * \param
+ * \param tab_model
+ * \param selected_account
+ * \param scheduled_number
+ * \param date_min
+ * \param date_max
  *
  * \return
  **/
-static void bet_array_refresh_scheduled_data (GtkTreeModel *tab_model,
-                        					  gint selected_account,
-                        					  GDate *date_min,
-                        					  GDate *date_max)
+static void bet_array_refresh_scheduled_line (GtkTreeModel *tab_model,
+											  gint selected_account,
+											  gint scheduled_number,
+											  GDate *date_min,
+											  GDate *date_max)
 {
     GtkTreeIter iter;
-    GSList* tmp_list;
+    gchar *str_amount;
+    gchar *str_debit = NULL;
+    gchar *str_credit = NULL;
+    gchar *str_description = NULL;
+    gchar *str_date;
+    gint account_number;
+    gint transfer_account_number;
+    gint div_number;
+    gint sub_div_nb;
+    gint currency_number;
+    GsbSchedulerRecurrence recurrence;
+    GDate date;
+    guint32 julian_day;
+    GValue date_value = G_VALUE_INIT;
+    GsbReal amount;
+    GsbReal account_amount;
 
-    /* devel_debug (NULL); */
-    tmp_list = gsb_data_scheduled_get_scheduled_list ();
+    /* ignore splitted transactions */
+    if (gsb_data_scheduled_get_split_of_scheduled (scheduled_number) == TRUE)
+        return;
 
-    while (tmp_list)
-    {
-        gchar *str_amount;
-        gchar *str_debit = NULL;
-        gchar *str_credit = NULL;
-        gchar *str_description = NULL;
-        gchar *str_date;
-        gint scheduled_number;
-        gint account_number;
-        gint transfer_account_number;
-        gint div_number;
-        gint sub_div_nb;
-        gint currency_number;
-        GDate *date;
-        GValue date_value = G_VALUE_INIT;
-        GsbReal amount;
+    /* ignores transactions replaced with historical data */
+    account_number = gsb_data_scheduled_get_account_number (scheduled_number);
 
-        scheduled_number = gsb_data_scheduled_get_scheduled_number (tmp_list->data);
-
-        tmp_list = tmp_list->next;
-
-         /* ignore splitted transactions */
-        if (gsb_data_scheduled_get_split_of_scheduled (scheduled_number) == TRUE)
-            continue;
+    div_number = bet_data_get_div_number (scheduled_number, FALSE);
+    sub_div_nb = bet_data_get_sub_div_nb (scheduled_number, FALSE);
 
-        /* ignores transactions replaced with historical data */
-        account_number = gsb_data_scheduled_get_account_number (scheduled_number);
+    if (div_number > 0
+     &&
+     bet_data_hist_div_search (account_number, div_number, 0)
+     &&
+     bet_array_sort_scheduled_transactions (div_number, sub_div_nb, tab_model))
+        return;
 
-        div_number = bet_data_get_div_number (scheduled_number, FALSE);
-        sub_div_nb = bet_data_get_sub_div_nb (scheduled_number, FALSE);
+    /* ignore scheduled operations of other account */
+    if (gsb_data_scheduled_is_transfer (scheduled_number))
+    {
+        transfer_account_number = gsb_data_scheduled_get_account_number_transfer (
+                    scheduled_number);
+        if (transfer_account_number == selected_account)
+        {
+            gint floating_point;
 
-        if (div_number > 0
-         &&
-         bet_data_hist_div_search (account_number, div_number, 0)
-         &&
-         bet_array_sort_scheduled_transactions (div_number, sub_div_nb, tab_model))
-            continue;
+            currency_number = gsb_data_account_get_currency (selected_account);
+            floating_point = gsb_data_account_get_currency_floating_point (selected_account);
+            str_description = g_strdup_printf (_("Transfer between account: %s\n"
+												 "and account: %s"),
+											   gsb_data_account_get_name (transfer_account_number),
+											   gsb_data_account_get_name (account_number));
 
-        /* ignore scheduled operations of other account */
-        if (gsb_data_scheduled_is_transfer (scheduled_number))
-        {
-            transfer_account_number = gsb_data_scheduled_get_account_number_transfer (
-                        scheduled_number);
-            if (transfer_account_number == selected_account)
-            {
-                gint floating_point;
-
-                currency_number = gsb_data_account_get_currency (selected_account);
-                floating_point = gsb_data_account_get_currency_floating_point (selected_account);
-                str_description = g_strdup_printf (_("Transfer between account: %s\n"
-													 "and account: %s"),
-												   gsb_data_account_get_name (transfer_account_number),
-												   gsb_data_account_get_name (account_number));
-
-                amount = gsb_real_opposite (gsb_data_scheduled_get_adjusted_amount_for_currency
-											(scheduled_number, currency_number, floating_point));
-                str_amount = utils_real_get_string (amount);
-            }
-            else if (account_number == selected_account)
-            {
-                currency_number = gsb_data_scheduled_get_currency_number (scheduled_number);
-                str_description = g_strdup_printf (_("Transfer between account: %s\n"
-													 "and account: %s"),
-												   gsb_data_account_get_name (account_number),
-												   gsb_data_account_get_name (transfer_account_number));
-
-                amount = gsb_data_scheduled_get_amount (scheduled_number);
-                str_amount = bet_data_get_str_amount_in_account_currency (amount,
-																		  account_number,
-                        												  scheduled_number,
-                        												  SPP_ORIGIN_SCHEDULED);
-            }
-            else
-                continue;
+            amount = gsb_real_opposite (gsb_data_scheduled_get_adjusted_amount_for_currency
+										(scheduled_number, currency_number, floating_point));
+            account_amount = amount;
+            str_amount = utils_real_get_string (amount);
         }
         else if (account_number == selected_account)
         {
             currency_number = gsb_data_scheduled_get_currency_number (scheduled_number);
-            str_description = bet_array_list_get_description (account_number,
-															  SPP_ORIGIN_SCHEDULED,
-															  GINT_TO_POINTER (scheduled_number));
+            str_description = g_strdup_printf (_("Transfer between account: %s\n"
+												 "and account: %s"),
+											   gsb_data_account_get_name (account_number),
+											   gsb_data_account_get_name (transfer_account_number));
 
             amount = gsb_data_scheduled_get_amount (scheduled_number);
-            str_amount = bet_data_get_str_amount_in_account_currency (amount,
-                        											  account_number,
-                       											 	  scheduled_number,
-                        											  SPP_ORIGIN_SCHEDULED);
+            account_amount = bet_data_get_amount_in_account_currency (amount,
+																	  account_number,
+                    												  scheduled_number,
+                    												  SPP_ORIGIN_SCHEDULED);
+            str_amount = utils_real_get_string (account_amount);
         }
         else
-            continue;
+            return;
+    }
+    else if (account_number == selected_account)
+    {
+        currency_number = gsb_data_scheduled_get_currency_number (scheduled_number);
+        str_description = bet_array_list_get_description (account_number,
+														  SPP_ORIGIN_SCHEDULED,
+														  GINT_TO_POINTER (scheduled_number));
+
+        amount = gsb_data_scheduled_get_amount (scheduled_number);
+        account_amount = bet_data_get_amount_in_account_currency (amount,
+                    											  account_number,
+                   											 	  scheduled_number,
+                    											  SPP_ORIGIN_SCHEDULED);
+        str_amount = utils_real_get_string (account_amount);
+    }
+    else
+        return;
 
-        if (amount.mantissa < 0)
-            str_debit = utils_real_get_string_with_currency (gsb_real_abs (amount), currency_number, TRUE);
-        else
-            str_credit = utils_real_get_string_with_currency (amount, currency_number, TRUE);
+    if (amount.mantissa < 0)
+        str_debit = utils_real_get_string_with_currency (gsb_real_abs (amount), currency_number, TRUE);
+    else
+        str_credit = utils_real_get_string_with_currency (amount, currency_number, TRUE);
 
-        /* calculate each instance of the scheduled operation
-         * in the range from date_min (today) to date_max */
-        date = gsb_date_copy (gsb_data_scheduled_get_date (scheduled_number));
+    /* calculate each instance of the scheduled operation
+     * in the range from date_min (today) to date_max */
+    if (gsb_scheduler_recurrence_init (&recurrence, scheduled_number))
+        julian_day = gsb_scheduler_recurrence_first_from (&recurrence, g_date_get_julian (date_min));
+    else
+        julian_day = 0;
 
-        while (date != NULL && g_date_valid (date))
-        {
-			GDate *tmp_date = NULL;
-			GDate *limit_date = NULL;
+    g_date_clear (&date, 1);
+    while (julian_day && julian_day <= g_date_get_julian (date_max))
+    {
+        g_date_set_julian (&date, julian_day);
+        str_date = gsb_format_gdate (&date);
 
-            if (g_date_compare (date, date_max) > 0)
-			{
-				g_date_free (date);
-                break;
-			}
-            if (g_date_compare (date, date_min) < 0)
-            {
-				tmp_date = date;
-                date = gsb_scheduler_get_next_date (scheduled_number, tmp_date);
-				g_date_free (tmp_date);
-                continue;
-            }
-			limit_date = gsb_data_scheduled_get_limit_date (scheduled_number);
-			if (limit_date && g_date_valid (limit_date))
-			{
-				if (g_date_compare (date, limit_date) > 0)
-				{
-					g_date_free (date);
-					break;
-				}
-			}
-            if (date == NULL || g_date_valid (date) == FALSE)
-			{
-				if (date)
-					g_date_free (date);
-                return;
-			}
+        g_value_init (&date_value, G_TYPE_DATE);
+        g_value_set_boxed (&date_value, &date);
 
-            str_date = gsb_format_gdate (date);
+        /* add a line in the estimate array */
+        gtk_tree_store_append (GTK_TREE_STORE (tab_model), &iter, NULL);
+        gtk_tree_store_set_value (GTK_TREE_STORE (tab_model),
+								  &iter,
+                    			  SPP_ESTIMATE_TREE_SORT_DATE_COLUMN, &date_value);
+        gtk_tree_store_set (GTK_TREE_STORE (tab_model),
+							&iter,
+                    		SPP_ESTIMATE_TREE_ORIGIN_DATA, SPP_ORIGIN_SCHEDULED,
+                    		SPP_ESTIMATE_TREE_DIVISION_COLUMN, scheduled_number,
+                    		SPP_ESTIMATE_TREE_SUB_DIV_COLUMN, 0,
+                    		SPP_ESTIMATE_TREE_DATE_COLUMN, str_date,
+                    		SPP_ESTIMATE_TREE_DESC_COLUMN, str_description,
+                    		SPP_ESTIMATE_TREE_DEBIT_COLUMN, str_debit,
+                    		SPP_ESTIMATE_TREE_CREDIT_COLUMN, str_credit,
+                    		SPP_ESTIMATE_TREE_AMOUNT_COLUMN, str_amount,
+                    		SPP_ESTIMATE_TREE_AMOUNT_MANTISSA, account_amount.mantissa,
+                    		SPP_ESTIMATE_TREE_AMOUNT_EXPONENT, account_amount.exponent,
+                    		-1);
+        bet_array_list_add_event (tab_model,
+								  &iter,
+								  julian_day,
+								  SPP_ORIGIN_SCHEDULED,
+								  scheduled_number,
+								  account_amount);
 
-            g_value_init (&date_value, G_TYPE_DATE);
-            g_value_set_boxed (&date_value, date);
+        g_value_unset (&date_value);
+        g_free (str_date);
+        julian_day = gsb_scheduler_recurrence_next (&recurrence);
+    }
+    g_free (str_amount);
+    g_free (str_credit);
+    g_free (str_debit);
+	g_free (str_description);
+}
 
-            /* add a line in the estimate array */
-            gtk_tree_store_append (GTK_TREE_STORE (tab_model), &iter, NULL);
-            gtk_tree_store_set_value (GTK_TREE_STORE (tab_model),
-									  &iter,
-                        			  SPP_ESTIMATE_TREE_SORT_DATE_COLUMN, &date_value);
-            gtk_tree_store_set (GTK_TREE_STORE (tab_model),
-								&iter,
-                        		SPP_ESTIMATE_TREE_ORIGIN_DATA, SPP_ORIGIN_SCHEDULED,
-                        		SPP_ESTIMATE_TREE_DIVISION_COLUMN, scheduled_number,
-                        		SPP_ESTIMATE_TREE_SUB_DIV_COLUMN, 0,
-                        		SPP_ESTIMATE_TREE_DATE_COLUMN, str_date,
-                        		SPP_ESTIMATE_TREE_DESC_COLUMN, str_description,
-                        		SPP_ESTIMATE_TREE_DEBIT_COLUMN, str_debit,
-                        		SPP_ESTIMATE_TREE_CREDIT_COLUMN, str_credit,
-                        		SPP_ESTIMATE_TREE_AMOUNT_COLUMN, str_amount,
-                        		-1);
+/**
+ *
+ *
+ * \param
+ * \param
+ * \param
+ * \param
+ *
+ * \return
+ **/
+static void bet_array_refresh_scheduled_data (GtkTreeModel *tab_model,
+                        					  gint selected_account,
+                        					  GDate *date_min,
+                        					  GDate *date_max)
+{
+    GSList* tmp_list;
 
-            g_value_unset (&date_value);
-            g_free (str_date);
-			tmp_date = date;
-			date = gsb_scheduler_get_next_date (scheduled_number, tmp_date);
-			g_date_free (tmp_date);
-        }
-        g_free (str_amount);
-        g_free (str_credit);
-        g_free (str_debit);
-		g_free (str_description);
+    /* devel_debug (NULL); */
+    tmp_list = gsb_data_scheduled_get_scheduled_list ();
+
+    while (tmp_list)
+    {
+        gint scheduled_number;
+
+        scheduled_number = gsb_data_scheduled_get_scheduled_number (tmp_list->data);
+        tmp_list = tmp_list->next;
+
+        bet_array_refresh_scheduled_line (tab_model,
+										  selected_account,
+										  scheduled_number,
+										  date_min,
+										  date_max);
     }
 }
 
@@ -2527,6 +2816,7 @@ static void bet_array_refresh_transactions_data (GtkTreeModel *tab_model,
         const GDate *date;
         GValue date_value = G_VALUE_INIT;
         GsbReal amount;
+        GsbReal account_amount;
 
         transaction_number = gsb_data_transaction_get_transaction_number (tmp_list->data);
         tmp_list = tmp_list->next;
@@ -2570,10 +2860,11 @@ static void bet_array_refresh_transactions_data (GtkTreeModel *tab_model,
         g_value_init (&date_value, G_TYPE_DATE);
         g_value_set_boxed (&date_value, date);
 
-        str_amount = bet_data_get_str_amount_in_account_currency (amount,
+        account_amount = bet_data_get_amount_in_account_currency (amount,
 																  account_number,
                         										  transaction_number,
                         										  SPP_ORIGIN_TRANSACTION);
+        str_amount = utils_real_get_string (account_amount);
 
         currency_number = gsb_data_transaction_get_currency_number (transaction_number);
         if (amount.mantissa < 0)
@@ -2612,7 +2903,15 @@ static void bet_array_refresh_transactions_data (GtkTreeModel *tab_model,
                         	SPP_ESTIMATE_TREE_DEBIT_COLUMN, str_debit,
                         	SPP_ESTIMATE_TREE_CREDIT_COLUMN, str_credit,
                         	SPP_ESTIMATE_TREE_AMOUNT_COLUMN, str_amount,
+                        	SPP_ESTIMATE_TREE_AMOUNT_MANTISSA, account_amount.mantissa,
+                        	SPP_ESTIMATE_TREE_AMOUNT_EXPONENT, account_amount.exponent,
                         	-1);
+        bet_array_list_add_event (tab_model,
+								  &iter,
+								  g_date_get_julian (date),
+								  SPP_ORIGIN_TRANSACTION,
+								  transaction_number,
+								  account_amount);
 
         g_value_unset (&date_value);
         g_free (str_date);
@@ -2663,6 +2962,7 @@ static gboolean bet_array_refresh_transfert_data (GtkTreeModel *tab_model,
         gchar *str_description;
         gchar *str_amount;
         GsbReal amount;
+        GsbReal account_amount;
         TransfertData *transfert = (TransfertData *) value;
 
         if (account_number != transfert->main_account_number)
@@ -2709,10 +3009,11 @@ static gboolean bet_array_refresh_transfert_data (GtkTreeModel *tab_model,
             replace_currency = gsb_data_partial_balance_get_currency (transfert->card_account_number);
         }
 
-        str_amount = bet_data_get_str_amount_in_account_currency (amount,
+        account_amount = bet_data_get_amount_in_account_currency (amount,
                         account_number,
                         replace_currency,
                         SPP_ORIGIN_ACCOUNT);
+        str_amount = utils_real_get_string (account_amount);
 
         currency_number = gsb_data_account_get_currency (transfert->card_account_number);
         if (amount.mantissa < 0)
@@ -2738,7 +3039,15 @@ static gboolean bet_array_refresh_transfert_data (GtkTreeModel *tab_model,
                         SPP_ESTIMATE_TREE_DEBIT_COLUMN, str_debit,
                         SPP_ESTIMATE_TREE_CREDIT_COLUMN, str_credit,
                         SPP_ESTIMATE_TREE_AMOUNT_COLUMN, str_amount,
+                        SPP_ESTIMATE_TREE_AMOUNT_MANTISSA, account_amount.mantissa,
+                        SPP_ESTIMATE_TREE_AMOUNT_EXPONENT, account_amount.exponent,
                         -1);
+        bet_array_list_add_event (tab_model,
+								  &tab_iter,
+								  g_date_get_julian (date_debit),
+								  SPP_ORIGIN_ACCOUNT,
+								  transfert->number,
+								  account_amount);
 
         g_value_unset (&date_value);
 		g_date_free (date_debit);
@@ -2752,6 +3061,334 @@ static gboolean bet_array_refresh_transfert_data (GtkTreeModel *tab_model,
     return FALSE;
 }
 
+/**
+ * forget the changed sources. If they belong to another account, its
+ * array must be computed again.
+ *
+ * \param account_number	account whose array is computed
+ *
+ * \return
+ **/
+static void bet_array_list_forget_sources (gint account_number)
+{
+    if (!bet_array_changed_sources)
+        return;
+
+    if (bet_array_changed_sources_account != account_number
+        && gsb_data_account_get_bet_maj (bet_array_changed_sources_account) == BET_MAJ_SOURCES)
+        gsb_data_account_set_bet_maj (bet_array_changed_sources_account, BET_MAJ_ESTIMATE);
+
+    g_array_free (bet_array_changed_sources, TRUE);
+    bet_array_changed_sources = NULL;
+    bet_array_changed_sources_account = 0;
+}
+
+/**
+ * check if a line of the array comes from a source
+ *
+ * \param model
+ * \param iter
+ * \param event		the event of the line
+ * \param source
+ *
+ * \return TRUE if the line is a line of the source
+ **/
+static gboolean bet_array_list_line_is_from_source (GtkTreeModel *model,
+													GtkTreeIter *iter,
+													BetForecastEvent *event,
+													BetArraySource *source)
+{
+    if (event->origin != source->origin)
+        return FALSE;
+
+    if (event->number == source->number)
+        return TRUE;
+
+    /* the other occurrences of a future data or the children of a split */
+    if (source->origin == SPP_ORIGIN_FUTURE)
+    {
+        gint mother_row = 0;
+
+        gtk_tree_model_get (model, iter, SPP_ESTIMATE_TREE_SUB_DIV_COLUMN, &mother_row, -1);
+
+        return mother_row == source->number;
+    }
+    else
+        return gsb_data_scheduled_get_mother_scheduled_number (event->number) == source->number;
+}
+
+/**
+ * add the lines of a source to the array, with the same filters as
+ * bet_array_refresh_estimate_tab
+ *
+ * \param model
+ * \param account_number
+ * \param source
+ * \param date_min					start date of the array
+ * \param first_day_current_month
+ * \param date_max
+ *
+ * \return
+ **/
+static void bet_array_list_add_source_lines (GtkTreeModel *model,
+											 gint account_number,
+											 BetArraySource *source,
+											 GDate *date_min,
+											 GDate *first_day_current_month,
+											 GDate *date_max)
+{
+    if (source->origin == SPP_ORIGIN_FUTURE)
+    {
+        GHashTableIter iter;
+        GDate *date_tomorrow;
+        gpointer key, value;
+
+        date_tomorrow = gsb_date_tomorrow ();
+        g_hash_table_iter_init (&iter, bet_data_future_get_list ());
+        while (g_hash_table_iter_next (&iter, &key, &value))
+        {
+            FuturData *scheduled = (FuturData *) value;
+            gboolean inverse_amount = FALSE;
+
+            if (scheduled->number != source->number && scheduled->mother_row != source->number)
+                continue;
+
+            if (account_number != scheduled->account_number)
+            {
+                if (scheduled->is_transfert == 0 || account_number != scheduled->account_transfert)
+                    continue;
+                else
+                    inverse_amount = TRUE;
+            }
+
+            /* the past lines are removed by the next full computation */
+            if (g_date_compare (scheduled->date, date_tomorrow) < 0
+                || g_date_compare (scheduled->date, date_max) > 0
+                || g_date_compare (scheduled->date, first_day_current_month) < 0)
+                continue;
+
+            bet_array_refresh_futur_line (model, account_number, scheduled, inverse_amount);
+        }
+        g_date_free (date_tomorrow);
+    }
+    else if (gsb_data_scheduled_get_split_of_scheduled (source->number))
+    {
+        GSList *children;
+        GSList *tmp_list;
+
+        children = gsb_data_scheduled_get_children (source->number, FALSE);
+        for (tmp_list = children; tmp_list; tmp_list = tmp_list->next)
+            bet_array_refresh_scheduled_line (model,
+											  account_number,
+											  gsb_data_scheduled_get_scheduled_number (tmp_list->data),
+											  date_min,
+											  date_max);
+        g_slist_free (children);
+    }
+    else if (gsb_data_scheduled_get_account_number (source->number) != -1)
+        bet_array_refresh_scheduled_line (model, account_number, source->number, date_min, date_max);
+}
+
+/**
+ * check if the scheduled transactions of the account can be replaced by
+ * the balance of a deferred debit card
+ *
+ * \param account_number
+ *
+ * \return TRUE if a transfert replaces a transaction
+ **/
+static gboolean bet_array_list_has_replaced_transactions (gint account_number)
+{
+    GHashTableIter iter;
+    gpointer key, value;
+
+    g_hash_table_iter_init (&iter, bet_data_transfert_get_list ());
+    while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+        TransfertData *transfert = (TransfertData *) value;
+
+        if (transfert->main_account_number == account_number && transfert->replace_transaction)
+            return TRUE;
+    }
+
+    return FALSE;
+}
+
+/**
+ * update the array with the changed sources only : their lines are
+ * removed and added again, and the balances are computed from the first
+ * changed line.
+ *
+ * \param account_number
+ *
+ * \return FALSE if the array must be computed again
+ **/
+static gboolean bet_array_list_update_sources (gint account_number)
+{
+    GtkWidget *tree_view;
+    GtkTreeModel *model;
+    GDate *date_min;
+    GDate *date_max;
+    GDate *first_day_current_month;
+    BetArrayView *view;
+    BetForecast *forecast;
+    guint i;
+
+    if (!bet_array_changed_sources || bet_array_changed_sources_account != account_number)
+        return FALSE;
+
+    tree_view = g_object_get_data (G_OBJECT (grisbi_win_get_account_page ()), "bet_estimate_treeview");
+    if (!tree_view)
+        return FALSE;
+
+    model = gtk_tree_view_get_model (GTK_TREE_VIEW (tree_view));
+    forecast = g_object_get_data (G_OBJECT (model), "bet_forecast");
+    view = g_object_get_data (G_OBJECT (model), "bet_array_view");
+    if (!forecast
+        || !view
+        || !view->sorted
+        || GPOINTER_TO_INT (g_object_get_data (G_OBJECT (model), "bet_forecast_account")) != account_number)
+        return FALSE;
+
+    /* the replacement by the balance of a card needs all the lines */
+    for (i = 0; i < bet_array_changed_sources->len; i++)
+    {
+        BetArraySource *source;
+
+        source = &g_array_index (bet_array_changed_sources, BetArraySource, i);
+        if (source->origin == SPP_ORIGIN_SCHEDULED)
+        {
+            if (bet_array_list_has_replaced_transactions (account_number))
+                return FALSE;
+
+            break;
+        }
+    }
+
+    devel_debug_int (account_number);
+
+    /* removes the lines of the sources */
+    i = bet_forecast_get_nb_events (forecast);
+    while (i > 0)
+    {
+        BetForecastEvent *event;
+        GtkTreeIter iter;
+        guint j;
+
+        i--;
+        event = bet_forecast_get_event (forecast, i);
+        iter = g_array_index (view->lines, BetArrayLine, event->key).iter;
+        for (j = 0; j < bet_array_changed_sources->len; j++)
+        {
+            if (bet_array_list_line_is_from_source (model,
+													&iter,
+													event,
+													&g_array_index (bet_array_changed_sources, BetArraySource, j)))
+            {
+                gtk_tree_store_remove (GTK_TREE_STORE (model), &iter);
+                bet_forecast_remove_event (forecast, i);
+                view->first_changed = MIN (view->first_changed, i);
+                break;
+            }
+        }
+    }
+
+    /* adds the new lines, their events are inserted at their place */
+    date_min = gsb_data_account_get_bet_start_date (account_number);
+    date_max = bet_data_array_get_date_max (account_number);
+    first_day_current_month = gsb_date_get_first_day_of_current_month ();
+
+    for (i = 0; i < bet_array_changed_sources->len; i++)
+        bet_array_list_add_source_lines (model,
+										 account_number,
+										 &g_array_index (bet_array_changed_sources, BetArraySource, i),
+										 date_min,
+										 first_day_current_month,
+										 date_max);
+
+    /* the balances before the first changed line are the same */
+    bet_array_list_update_balance (model, account_number);
+
+    bet_array_list_set_background_color (tree_view);
+
+    g_date_free (date_min);
+    g_date_free (date_max);
+    g_date_free (first_day_current_month);
+
+    return TRUE;
+}
+
+/**
+ * affiche sous le titre la prévision consolidée du premier solde partiel
+ * qui contient le compte, sur la même période que le tableau
+ *
+ * \param account_number
+ * \param date_min
+ * \param date_max
+ *
+ * \return
+ **/
+static void bet_array_refresh_consolidated_label (gint account_number,
+												  GDate *date_min,
+												  GDate *date_max)
+{
+    GtkWidget *label;
+    BetConsolidated *consolidated = NULL;
+    GDate date_lowest;
+    GsbReal final_balance;
+    GsbReal lowest_balance;
+    gchar *str_date_max;
+    gchar *str_date_lowest;
+    gchar *str_final_balance;
+    gchar *str_lowest_balance;
+    gchar *tmp_str;
+    guint32 lowest_day;
+    gint partial_balance_number;
+
+    label = g_object_get_data (G_OBJECT (grisbi_win_get_account_page ()), "bet_array_consolidated");
+    if (!label)
+        return;
+
+    partial_balance_number = bet_consolidated_get_partial_balance_of_account (account_number);
+    if (partial_balance_number)
+        consolidated = bet_consolidated_new_for_partial_balance (partial_balance_number, date_min, date_max);
+
+    if (!consolidated)
+    {
+        gtk_widget_hide (label);
+        return;
+    }
+
+    final_balance = bet_consolidated_get_final_balance (consolidated);
+    lowest_balance = bet_consolidated_get_minimum_balance (consolidated, &lowest_day);
+    if (lowest_day == 0)
+        lowest_day = g_date_get_julian (date_min);
+
+    g_date_clear (&date_lowest, 1);
+    g_date_set_julian (&date_lowest, lowest_day);
+
+    str_date_max = gsb_format_gdate (date_max);
+    str_date_lowest = gsb_format_gdate (&date_lowest);
+    str_final_balance = utils_real_get_string_with_currency (final_balance, consolidated->currency_number, TRUE);
+    str_lowest_balance = utils_real_get_string_with_currency (lowest_balance, consolidated->currency_number, TRUE);
+
+    tmp_str = g_strdup_printf (_("Consolidated forecast of \"%s\": %s on %s, lowest balance %s on %s"),
+                               gsb_data_partial_balance_get_name (partial_balance_number),
+                               str_final_balance,
+                               str_date_max,
+                               str_lowest_balance,
+                               str_date_lowest);
+    gtk_label_set_text (GTK_LABEL (label), tmp_str);
+    gtk_widget_show (label);
+
+    g_free (tmp_str);
+    g_free (str_date_max);
+    g_free (str_date_lowest);
+    g_free (str_final_balance);
+    g_free (str_lowest_balance);
+    bet_consolidated_free (consolidated);
+}
+
 /**
  * This function clears the estimate array and calculates new estimates.
  * It updates the estimate graph.
@@ -2782,14 +3419,14 @@ static void bet_array_refresh_estimate_tab (gint account_number)
     GDate *date_min;
     GDate *date_max;
     GsbReal current_balance;
-    BetRange *tmp_range;
     GValue date_value = G_VALUE_INIT;
     gint currency_number;
 
     devel_debug (NULL);
     account_page = grisbi_win_get_account_page ();
 
-    tmp_range = bet_data_bet_range_struct_init ();
+    /* the full computation includes the changed sources */
+    bet_array_list_forget_sources (account_number);
 
     /* calculate date_min, date_max and first_day_current_month with user choice */
     date_min = gsb_data_account_get_bet_start_date (account_number);
@@ -2846,8 +3483,12 @@ static void bet_array_refresh_estimate_tab (gint account_number)
 	else
 		path = gtk_tree_path_new_first ();
 
-    /* clear the model */
+    /* clear the model, the lines are sorted only once at the end of the fill */
     gtk_tree_store_clear (GTK_TREE_STORE (tree_model));
+    bet_array_list_new_forecast (tree_model, current_balance);
+    gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (tree_model),
+										  GTK_TREE_SORTABLE_UNSORTED_SORT_COLUMN_ID,
+										  GTK_SORT_DESCENDING);
 
     tmp_str = g_strdup (_("balance beginning of period"));
     gtk_tree_store_append (GTK_TREE_STORE (tree_model), &iter, NULL);
@@ -2861,6 +3502,8 @@ static void bet_array_refresh_estimate_tab (gint account_number)
                         SPP_ESTIMATE_TREE_DESC_COLUMN, tmp_str,
                         SPP_ESTIMATE_TREE_BALANCE_COLUMN, str_current_balance,
                         SPP_ESTIMATE_TREE_AMOUNT_COLUMN, str_amount,
+                        SPP_ESTIMATE_TREE_AMOUNT_MANTISSA, current_balance.mantissa,
+                        SPP_ESTIMATE_TREE_AMOUNT_EXPONENT, current_balance.exponent,
                         SPP_ESTIMATE_TREE_BALANCE_COLOR, color_str,
                         SPP_ESTIMATE_TREE_BACKGROUND_COLOR, gsb_rgba_get_couleur ("background_bet_solde"),
                         -1);
@@ -2893,25 +3536,27 @@ static void bet_array_refresh_estimate_tab (gint account_number)
                         			  date_min,
                         			  date_max);
 
+    /* the replacement of the transactions by transfert needs the sorted lines */
+    gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (tree_model),
+										  SPP_ESTIMATE_TREE_SORT_DATE_COLUMN,
+										  GTK_SORT_DESCENDING);
+
     bet_array_list_replace_transactions_by_transfert (tree_model, account_number);
 
     /* shows the balance at beginning of month */
     bet_array_shows_balance_at_beginning_of_month (tree_model, date_min, date_max);
 
+    /* consolidated forecast of the partial balance of the account */
+    bet_array_refresh_consolidated_label (account_number, date_min, date_max);
+
     g_date_free (date_min);
     g_date_free (date_init);
     g_date_free (date_max);
 	g_date_free (first_day_current_month);
 
-    /* Calculate the balance column */
-    tmp_range->first_pass = TRUE;
-    tmp_range->current_balance = current_balance;
+    /* sort the events and calculate the balance column */
+    bet_array_list_update_balance (tree_model, account_number);
 
-    gtk_tree_model_foreach (GTK_TREE_MODEL (tree_model),
-							bet_array_update_average_column,
-							tmp_range);
-
-	bet_data_bet_range_struct_free (tmp_range);
     bet_array_list_set_background_color (tree_view);
     bet_array_list_select_path (tree_view, path);
     gtk_tree_path_free (path);
@@ -2957,6 +3602,13 @@ GtkWidget *bet_array_create_page (void)
                         "bet_array_title",
                         label_title);
 
+    /* consolidated forecast of the partial balance, hidden if the account has none */
+    label = gtk_label_new (NULL);
+	gtk_widget_set_halign (label, GTK_ALIGN_CENTER);
+    gtk_widget_set_no_show_all (label, TRUE);
+    gtk_box_pack_start (GTK_BOX (page), label, FALSE, FALSE, 0);
+    g_object_set_data (G_OBJECT (account_page), "bet_array_consolidated", label);
+
     /* set the duration widget */
     hbox = utils_widget_get_duration_widget (SPP_ORIGIN_ARRAY);
 	gtk_widget_set_halign (hbox, GTK_ALIGN_CENTER);
@@ -3406,7 +4058,15 @@ void bet_array_list_add_new_hist_line (GtkTreeModel *tab_model,
                         SPP_ESTIMATE_TREE_DEBIT_COLUMN, str_debit,
                         SPP_ESTIMATE_TREE_CREDIT_COLUMN, str_credit,
                         SPP_ESTIMATE_TREE_AMOUNT_COLUMN, str_amount,
+                        SPP_ESTIMATE_TREE_AMOUNT_MANTISSA, amount.mantissa,
+                        SPP_ESTIMATE_TREE_AMOUNT_EXPONENT, amount.exponent,
                         -1);
+        bet_array_list_add_event (tab_model,
+								  &tab_iter,
+								  g_date_get_julian (date),
+								  SPP_ORIGIN_HISTORICAL,
+								  div_number,
+								  amount);
 
         g_value_unset (&date_value);
         g_free (str_date);
@@ -3470,6 +4130,69 @@ gboolean bet_array_list_set_largeur_col_treeview (void)
     return FALSE;
 }
 
+/**
+ * note that the lines of a future data or of a scheduled transaction
+ * changed. If the array shows the account, only these lines will be
+ * computed again by bet_array_update_estimate_tab, else the account
+ * needs a full update.
+ *
+ * \param account_number
+ * \param origin			SPP_ORIGIN_FUTURE or SPP_ORIGIN_SCHEDULED
+ * \param number			future or scheduled number, for a split the mother
+ *
+ * \return
+ **/
+void bet_array_mark_source_changed (gint account_number,
+									gint origin,
+									gint number)
+{
+    GtkWidget *tree_view;
+    BetArraySource source;
+    gint type_maj;
+    guint i;
+
+    type_maj = gsb_data_account_get_bet_maj (account_number);
+    if (type_maj == BET_MAJ_HISTORICAL)
+    {
+        gsb_data_account_set_bet_maj (account_number, BET_MAJ_ALL);
+        return;
+    }
+    else if (type_maj != BET_MAJ_FALSE && type_maj != BET_MAJ_SOURCES)
+        return;
+
+    /* the array must show the up to date forecast of the account */
+    tree_view = g_object_get_data (G_OBJECT (grisbi_win_get_account_page ()), "bet_estimate_treeview");
+    if (!tree_view
+        || GPOINTER_TO_INT (g_object_get_data (G_OBJECT (gtk_tree_view_get_model (GTK_TREE_VIEW (tree_view))),
+											   "bet_forecast_account")) != account_number)
+    {
+        gsb_data_account_set_bet_maj (account_number, BET_MAJ_ESTIMATE);
+        return;
+    }
+
+    if (bet_array_changed_sources_account != account_number)
+        bet_array_list_forget_sources (account_number);
+
+    if (!bet_array_changed_sources)
+        bet_array_changed_sources = g_array_new (FALSE, FALSE, sizeof (BetArraySource));
+
+    for (i = 0; i < bet_array_changed_sources->len; i++)
+    {
+        BetArraySource *tmp_source;
+
+        tmp_source = &g_array_index (bet_array_changed_sources, BetArraySource, i);
+        if (tmp_source->origin == origin && tmp_source->number == number)
+            return;
+    }
+
+    source.origin = origin;
+    source.number = number;
+    g_array_append_val (bet_array_changed_sources, source);
+    bet_array_changed_sources_account = account_number;
+
+    gsb_data_account_set_bet_maj (account_number, BET_MAJ_SOURCES);
+}
+
 /**
  * Met à jour les données à afficher dans les différentes vues du module
  *
@@ -3495,6 +4218,11 @@ void bet_array_update_estimate_tab (gint account_number, gint type_maj)
             bet_hist_populate_data (account_number);
             bet_array_refresh_estimate_tab (account_number);
         break;
+        case BET_MAJ_SOURCES:
+            if (!bet_array_list_update_sources (account_number))
+                bet_array_refresh_estimate_tab (account_number);
+            bet_array_list_forget_sources (account_number);
+        break;
     }
 }
 
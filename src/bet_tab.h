@@ -39,6 +39,9 @@ void 		bet_array_list_add_new_hist_line 				(GtkTreeModel *tab_model,
 gboolean 	bet_array_list_select_path 						(GtkWidget *tree_view,
 															 GtkTreePath *path);
 gboolean 	bet_array_list_set_largeur_col_treeview 		(void);
+void		bet_array_mark_source_changed					(gint account_number,
+															 gint origin,
+															 gint number);
 void 		bet_array_update_estimate_tab 					(gint account_number,
 															 gint type_maj);
 void 		bet_array_update_toolbar 						(gint toolbar_style);
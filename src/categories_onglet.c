@@ -199,11 +199,11 @@ GtkWidget *categories_create_list (void)
     cell = gtk_cell_renderer_text_new ();
 	gtk_cell_renderer_set_padding (GTK_CELL_RENDERER (cell), MARGIN_BOX, 0);
     column = gtk_tree_view_column_new_with_attributes (_("Amount"), cell,
-						       "text", META_TREE_BALANCE_COLUMN,
 						       "weight", META_TREE_FONT_COLUMN,
 						       "xalign", META_TREE_XALIGN_COLUMN,
                                "cell-background-rgba", META_TREE_BACKGROUND_COLOR,
 						       NULL);
+    gtk_tree_view_column_set_cell_data_func (column, cell, metatree_balance_cell_data_func, NULL, NULL);
     gtk_tree_view_column_set_alignment (column, 1.0);
     gtk_tree_view_append_column (GTK_TREE_VIEW (arbre_categ),
 				  GTK_TREE_VIEW_COLUMN (column));
@@ -279,7 +279,7 @@ GtkWidget *categories_create_list (void)
 void categories_fill_list (void)
 {
     GSList *category_list;
-    GtkTreeIter iter_categ, iter_sous_categ;
+    GtkTreeIter iter_categ;
     GtkTreeSelection *selection;
     MetatreeInterface *category_interface;
 
@@ -316,43 +316,11 @@ void categories_fill_list (void)
 
 	category_number = gsb_data_category_get_no_category (category_list->data);
 
+	/* the sub-categories are added when the category is expanded */
 	gtk_tree_store_append (GTK_TREE_STORE (categ_tree_model), &iter_categ, NULL);
 	fill_division_row (GTK_TREE_MODEL(categ_tree_model), category_interface,
 			    &iter_categ, category_number);
 
-	/** Each category has subcategories. */
-	if (category_number)
-	{
-	    GSList *sub_category_list;
-
-	    sub_category_list = gsb_data_category_get_sub_category_list (category_number);
-
-	    while (sub_category_list)
-	    {
-		gint sub_category_number;
-
-		sub_category_number = gsb_data_category_get_no_sub_category (sub_category_list->data);
-
-		gtk_tree_store_append (GTK_TREE_STORE (categ_tree_model),
-				       &iter_sous_categ, &iter_categ);
-		fill_sub_division_row (GTK_TREE_MODEL(categ_tree_model), category_interface,
-					&iter_sous_categ,
-					category_number,
-					sub_category_number);
-
-		sub_category_list = sub_category_list->next;
-	    }
-	}
-
-	/* add the no sub category only if category */
-	if (category_number)
-	{
-	    gtk_tree_store_append (GTK_TREE_STORE (categ_tree_model),
-				   &iter_sous_categ, &iter_categ);
-	    fill_sub_division_row (GTK_TREE_MODEL(categ_tree_model), category_interface,
-				    &iter_sous_categ, category_number, 0);
-	}
-
 	category_list = category_list->next;
     }
 
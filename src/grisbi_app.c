@@ -85,6 +85,10 @@ struct _GrisbiAppPrivate
 	gboolean			new_window;
 	gint				debug_level;
 	GSList *			file_list;
+	gchar *				import_dir;			/* --import-dir: files imported without user */
+	gchar *				import_rule;		/* --import-rule: name of the rule to use */
+	gchar *				import_report;		/* --import-report: file for the summary */
+	gint				import_status;		/* exit status of --import-dir */
 
 	/* Menuapp et menubar */
 	gchar **			recent_array;
@@ -108,6 +112,17 @@ struct AcceleratorStruct
 	const gchar *translate_string;
 };
 
+static const GOptionEntry options[] =
+{
+	{"import-dir", 0, 0, G_OPTION_ARG_FILENAME, NULL,
+	 N_("Import with the import rules the files of DIRECTORY, save the file and quit"), N_("DIRECTORY")},
+	{"import-rule", 0, 0, G_OPTION_ARG_STRING, NULL,
+	 N_("Name of the import rule to use with --import-dir"), N_("NAME")},
+	{"import-report", 0, 0, G_OPTION_ARG_FILENAME, NULL,
+	 N_("Write the summary of --import-dir in FILE"), N_("FILE")},
+	{NULL}
+};
+
 static struct AcceleratorStruct accels[] = {
 		{ "app.prefs", { "<Primary><Shift>P", NULL }, N_("Preferences")},
 		{ "app.quit", { "<Primary>Q", NULL }, N_("Quit")},
@@ -864,6 +879,61 @@ static gboolean grisbi_app_load_file_if_necessary (GrisbiApp *app)
 	return FALSE;
 }
 
+/**
+ * stop an import of --import-dir which can't be done : the error is written
+ * on the standard error, no dialog is shown and grisbi quits with a failure status
+ *
+ * \param GApplication *app
+ * \param message
+ *
+ * \return
+ **/
+static void grisbi_app_import_directory_failed (GrisbiApp *app,
+												const gchar *message)
+{
+	GrisbiAppPrivate *priv;
+
+	priv = grisbi_app_get_instance_private (GRISBI_APP (app));
+
+	g_printerr ("grisbi: --import-dir: %s\n", message);
+	priv->import_status = EXIT_FAILURE;
+	has_started = TRUE;
+
+	g_application_quit (G_APPLICATION (app));
+}
+
+/**
+ * import the files of the directory given by --import-dir in the opened file,
+ * save the file and quit
+ *
+ * \param GApplication *app
+ *
+ * \return
+ **/
+static void grisbi_app_import_directory_if_necessary (GrisbiApp *app)
+{
+	GrisbiAppPrivate *priv;
+	gint nb_files;
+
+	priv = grisbi_app_get_instance_private (GRISBI_APP (app));
+	if (!priv->import_dir)
+		return;
+
+	nb_files = gsb_import_by_rule_directory (priv->import_dir, priv->import_rule, priv->import_report);
+	if (nb_files < 0)
+	{
+		grisbi_app_import_directory_failed (app, _("the directory can't be read"));
+		return;
+	}
+	else if (nb_files > 0 && !gsb_file_save ())
+	{
+		grisbi_app_import_directory_failed (app, _("the file can't be saved"));
+		return;
+	}
+
+	g_application_quit (G_APPLICATION (app));
+}
+
 /**
  * lancement de l'application
  *
@@ -992,6 +1062,19 @@ static void grisbi_app_activate (GApplication *application)
 	/* création de la fenêtre pincipale */
 	win = grisbi_app_create_window (GRISBI_APP (application));
 
+	/* without user, a file must be opened to import the directory */
+	if (priv->import_dir)
+	{
+		if ((priv->a_conf)->first_use || !grisbi_app_load_file_if_necessary (GRISBI_APP (application)))
+			grisbi_app_import_directory_failed (GRISBI_APP (application), _("no file opened"));
+		else
+		{
+			has_started = TRUE;
+			grisbi_app_import_directory_if_necessary (GRISBI_APP (application));
+		}
+		return;
+	}
+
 	/* lance un assistant si première utilisation */
 	if ((priv->a_conf)->first_use)
 	{
@@ -1003,9 +1086,7 @@ static void grisbi_app_activate (GApplication *application)
 		/* ouvre un fichier si demandé */
 		load_file = grisbi_app_load_file_if_necessary (GRISBI_APP (application));
 		if (load_file)
-		{
 			display_tip (FALSE);
-		}
 		else
 		{
 			grisbi_win_stack_box_show (win, "accueil_page");
@@ -1030,6 +1111,16 @@ static void grisbi_app_open (GApplication *application,
 {
 	GList *windows;
 	GrisbiWin *win;
+	GrisbiAppPrivate *priv;
+
+	priv = grisbi_app_get_instance_private (GRISBI_APP (application));
+
+	/* without user, only one file can be opened and the errors are not shown in a dialog */
+	if (priv->import_dir && n_files != 1)
+	{
+		grisbi_app_import_directory_failed (GRISBI_APP (application), _("only one file can be opened"));
+		return;
+	}
 
 	windows = gtk_application_get_windows (GTK_APPLICATION (application));
 	if (windows)
@@ -1040,6 +1131,14 @@ static void grisbi_app_open (GApplication *application,
 	if (n_files == 1)
 	{
 		grisbi_win_open (win, files[0]);
+		if (priv->import_dir)
+		{
+			if (grisbi_win_file_is_loading ())
+				grisbi_app_import_directory_if_necessary (GRISBI_APP (application));
+			else
+				grisbi_app_import_directory_failed (GRISBI_APP (application), _("the file can't be opened"));
+			return;
+		}
 	}
 	else
 	{
@@ -1062,6 +1161,28 @@ static void grisbi_app_open (GApplication *application,
 /******************************************************************************/
 /* Fonctions propres à l'initialisation de l'application                      */
 /******************************************************************************/
+/**
+ * récupère les options de la ligne de commande
+ *
+ * \param GApplication *app
+ * \param GVariantDict *options
+ *
+ * \return -1 to continue the default processing
+ **/
+static gint grisbi_app_handle_local_options (GApplication *application,
+											 GVariantDict *options)
+{
+	GrisbiAppPrivate *priv;
+
+	priv = grisbi_app_get_instance_private (GRISBI_APP (application));
+
+	g_variant_dict_lookup (options, "import-dir", "^ay", &priv->import_dir);
+	g_variant_dict_lookup (options, "import-rule", "s", &priv->import_rule);
+	g_variant_dict_lookup (options, "import-report", "^ay", &priv->import_report);
+
+	return -1;
+}
+
 /**
  * grisbi_app_init
  *
@@ -1077,6 +1198,8 @@ static void grisbi_app_init (GrisbiApp *app)
 #endif
 
 	g_set_prgname ("grisbi");
+
+	g_application_add_main_option_entries (G_APPLICATION (app), options);
 }
 
 /**
@@ -1103,6 +1226,10 @@ static void grisbi_app_dispose (GObject *object)
 	if (priv->recent_array && g_strv_length (priv->recent_array) > 0)
 		g_strfreev (priv->recent_array);
 
+	g_clear_pointer (&priv->import_dir, g_free);
+	g_clear_pointer (&priv->import_rule, g_free);
+	g_clear_pointer (&priv->import_report, g_free);
+
 	G_OBJECT_CLASS (grisbi_app_parent_class)->dispose (object);
 }
 
@@ -1163,6 +1290,7 @@ static void grisbi_app_class_init (GrisbiAppClass *class)
 	G_APPLICATION_CLASS (class)->startup = grisbi_app_startup;
 	G_APPLICATION_CLASS (class)->activate = grisbi_app_activate;
 	G_APPLICATION_CLASS (class)->open = grisbi_app_open;
+	G_APPLICATION_CLASS (class)->handle_local_options = grisbi_app_handle_local_options;
 
 	G_APPLICATION_CLASS (class)->shutdown = grisbi_app_shutdown;
 	G_OBJECT_CLASS (class)->dispose = grisbi_app_dispose;
@@ -1392,6 +1520,22 @@ gboolean grisbi_app_get_has_app_menu (GrisbiApp *app)
 
 }
 
+/**
+ * return the exit status of the import of --import-dir
+ *
+ * \param GrisbiApp *app
+ *
+ * \return EXIT_SUCCESS or EXIT_FAILURE
+ **/
+gint grisbi_app_get_import_status (GrisbiApp *app)
+{
+	GrisbiAppPrivate *priv;
+
+	priv = grisbi_app_get_instance_private (GRISBI_APP (app));
+
+	return priv->import_status;
+}
+
 /**
  * grisbi_app_get_menu_edit
  *
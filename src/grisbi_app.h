@@ -23,6 +23,7 @@ GrisbiWin *			grisbi_app_get_active_window			(GrisbiApp *app);
 const gchar *		grisbi_app_get_css_data					(void);
 GtkCssProvider *	grisbi_app_get_css_provider				(void);
 gboolean			grisbi_app_get_has_app_menu				(GrisbiApp *app);
+gint				grisbi_app_get_import_status			(GrisbiApp *app);
 gboolean			grisbi_app_get_low_definition_screen	(void);
 GMenu *				grisbi_app_get_menu_edit				(void);
 GAction *			grisbi_app_get_prefs_action				(void);
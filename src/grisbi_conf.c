@@ -94,6 +94,7 @@ static void grisbi_conf_clean_config (GrisbiAppConf *a_conf)
 
     /* settings_file */
 	a_conf->archives_check_auto = TRUE;
+	a_conf->archives_cold_storage = FALSE;
 	a_conf->compress_file = FALSE;
 	a_conf->dernier_fichier_auto = FALSE;
 	a_conf->force_enregistrement = FALSE;
@@ -326,6 +327,10 @@ gboolean grisbi_conf_load_app_config (void)
 														  "File",
 														  "archives-check-auto",
 														  NULL);
+	a_conf->archives_cold_storage = g_key_file_get_boolean (config,
+															"File",
+															"archives-cold-storage",
+															NULL);
 	a_conf->compress_file = g_key_file_get_boolean (config,
 													"File",
 													"compress-file",
@@ -846,6 +851,10 @@ gboolean grisbi_conf_save_app_config (void)
 							"File",
 							"archives-check-auto",
 							a_conf->archives_check_auto);
+	g_key_file_set_boolean (config,
+							"File",
+							"archives-cold-storage",
+							a_conf->archives_cold_storage);
 	g_key_file_set_boolean (config,
 							"File",
 							"compress-file",
@@ -50,6 +50,7 @@
 #include "navigation.h"
 #include "gsb_report.h"
 #include "gsb_transactions_list.h"
+#include "transaction_list.h"
 #include "dialog.h"
 #include "traitement_variables.h"
 #include "utils_str.h"
@@ -944,13 +945,28 @@ static gboolean gsb_assistant_archive_switch_to_success (GtkWidget *assistant,
 		tmp_list = tmp_list->next;
 	}
 
-	/* create the list of archives by account when file is loaded */
+	/* create the archive stores of the new archive when file is loaded,
+	 * the stores of the others archives don't change */
 	w_run = (GrisbiWinRun *) grisbi_win_get_w_run ();
 	if (w_run->file_is_loading)
 	{
-		gsb_data_archive_store_init_variables ();
-		gsb_data_archive_store_create_list ();
-		gsb_transactions_list_fill_archive_store ();
+		tmp_list = list_transaction_to_archive;
+		while (tmp_list)
+		{
+			gsb_data_archive_store_add_transaction (gsb_data_transaction_get_transaction_number (tmp_list->data));
+			tmp_list = tmp_list->next;
+		}
+
+		tmp_list = gsb_data_archive_store_get_archives_list ();
+		while (tmp_list)
+		{
+			gint archive_store_number;
+
+			archive_store_number = gsb_data_archive_store_get_number (tmp_list->data);
+			if (gsb_data_archive_store_get_archive_number (archive_store_number) == archive_number)
+				transaction_list_append_archive (archive_store_number);
+			tmp_list = tmp_list->next;
+		}
 	}
 
 	/* set the message */
@@ -99,6 +99,9 @@ gboolean gsb_calendar_update ( void )
 {
     time_t temps;
     GSList *tmp_list;
+    GDate date;
+    guint32 first_day;
+    guint32 last_day;
     guint calendar_day;
     guint calendar_month;
     guint calendar_year;
@@ -119,30 +122,32 @@ gboolean gsb_calendar_update ( void )
     else
         gtk_calendar_select_day ( GTK_CALENDAR ( scheduled_calendar ), FALSE );
 
+    /* the days of the month shown by the calendar */
     calendar_month = calendar_month + 1;
-    calendar_year = calendar_year + 25;
+    g_date_clear ( &date, 1 );
+    g_date_set_dmy ( &date, 1, calendar_month, calendar_year );
+    first_day = g_date_get_julian ( &date );
+    last_day = first_day + g_date_get_days_in_month ( calendar_month, calendar_year ) - 1;
 
     /* check the scheduled transactions and bold them in the calendar */
     tmp_list = gsb_data_scheduled_get_scheduled_list ();
 
     while ( tmp_list )
     {
-	GDate *tmp_date;
+	GsbSchedulerRecurrence recurrence;
+	guint32 days[31];
+	guint nb_days;
+	guint i;
 	gint scheduled_number;
 
 	scheduled_number = gsb_data_scheduled_get_scheduled_number (tmp_list -> data);
 
-	tmp_date = gsb_date_copy (gsb_data_scheduled_get_date (scheduled_number));
-
-	while (tmp_date && g_date_get_month (tmp_date) == calendar_month && g_date_get_year (tmp_date) < calendar_year)
+	if ( gsb_scheduler_recurrence_init ( &recurrence, scheduled_number ) )
 	{
-	    GDate *new_date;
-
-	    gtk_calendar_mark_day ( GTK_CALENDAR ( scheduled_calendar ),
-				    g_date_get_day (tmp_date));
-	    new_date = gsb_scheduler_get_next_date (scheduled_number, tmp_date);
-	    g_free (tmp_date);
-	    tmp_date = new_date;
+	    nb_days = gsb_scheduler_recurrence_fill ( &recurrence, first_day, last_day, days, 31 );
+	    for ( i = 0 ; i < nb_days ; i++ )
+		gtk_calendar_mark_day ( GTK_CALENDAR ( scheduled_calendar ),
+					days[i] - first_day + 1 );
 	}
 	tmp_list = tmp_list -> next;
     }
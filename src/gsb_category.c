@@ -282,6 +282,45 @@ gboolean gsb_category_assistant_create_categories ( GtkWidget *assistant )
 
 
 
+/**
+ * append a new category or sub-category to the form's combofix
+ * without rebuilding the whole list
+ *
+ * \param category_number
+ * \param sub_category_number	0 for a category
+ *
+ * \return
+ * */
+void gsb_category_append_to_combofix ( gint category_number,
+                        gint sub_category_number )
+{
+    GtkWidget *widget;
+    gchar *category_name;
+    gchar *sub_category_name = NULL;
+
+    if ( !gsb_data_form_check_for_value ( TRANSACTION_FORM_CATEGORY ) )
+        return;
+
+    widget = gsb_form_widget_get_widget (TRANSACTION_FORM_CATEGORY);
+    if ( !widget )
+        return;
+
+    category_name = gsb_data_category_get_name ( category_number, 0, NULL );
+    if ( sub_category_number )
+        sub_category_name = gsb_data_category_get_sub_category_name ( category_number,
+                        sub_category_number,
+                        NULL );
+
+    /* same lists as gsb_category_update_combofix () : debit first, then credit */
+    gtk_combofix_append_division ( GTK_COMBOFIX (widget),
+                        category_name,
+                        sub_category_name,
+                        gsb_data_category_get_type ( category_number ) ? 0 : 1 );
+
+    g_free ( category_name );
+    g_free ( sub_category_name );
+}
+
 /**
  * update the form's combofix category
  *
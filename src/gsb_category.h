@@ -10,6 +10,8 @@
 /* START_DECLARATION */
 gboolean 	gsb_category_assistant_create_categories 	(GtkWidget *assistant);
 GtkWidget *	gsb_category_assistant_create_choice_page	(GtkWidget *assistant);
+void		gsb_category_append_to_combofix				(gint category_number,
+														 gint sub_category_number);
 gboolean 	gsb_category_update_combofix 				(gboolean force);
 /* END_DECLARATION */
 
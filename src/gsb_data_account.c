@@ -47,6 +47,7 @@
 #include "gsb_data_transaction.h"
 #include "gsb_dirs.h"
 #include "gsb_file.h"
+#include "gsb_file_archive_segment.h"
 #include "gsb_select_icon.h"
 #include "gsb_transactions_list.h"
 #include "navigation.h"
@@ -1141,10 +1142,10 @@ GsbReal gsb_data_account_calculate_current_and_marked_balances (gint account_num
     AccountStruct *account;
     GDate *date_jour;
     GSList *tmp_list;
+	GPtrArray *current_transactions;
+	GPtrArray *marked_transactions;
     GsbReal current_balance;
-	GsbReal current_balance_later = null_real;
     GsbReal marked_balance;
-	GsbReal marked_balance_later = null_real;
     gint floating_point;
 	gboolean has_pointed = FALSE;
 	GrisbiAppConf *a_conf;
@@ -1170,14 +1171,24 @@ GsbReal gsb_data_account_calculate_current_and_marked_balances (gint account_num
 	}
 	else
 	{
-		current_balance = gsb_real_adjust_exponent (account->init_balance, floating_point);
-		marked_balance = gsb_real_adjust_exponent (account->init_balance, floating_point);
+		GsbReal archived_balance;
+
+		/* the transactions of the archive segment not loaded are reconciled and in the past */
+		archived_balance = gsb_file_archive_segment_get_account_balance (account_number);
+		current_balance = gsb_real_add (gsb_real_adjust_exponent (account->init_balance, floating_point),
+										archived_balance);
+		marked_balance = gsb_real_add (gsb_real_adjust_exponent (account->init_balance, floating_point),
+									   archived_balance);
 	}
 
     date_jour = gdate_today ( );
 
 	a_conf = (GrisbiAppConf *) grisbi_app_get_a_conf ();
 
+	/* the transactions are collected and their amounts are summed in one time */
+	current_transactions = g_ptr_array_new ();
+	marked_transactions = g_ptr_array_new ();
+
 	tmp_list = gsb_data_transaction_get_active_transactions_list ();
     while (tmp_list)
     {
@@ -1203,27 +1214,12 @@ GsbReal gsb_data_account_calculate_current_and_marked_balances (gint account_num
 			&& res >= 0)
 		{
 			gint marked_transaction;
-			GsbReal adjusted_amout;
-			GsbReal tmp_balance;
 
-			adjusted_amout = gsb_data_transaction_get_adjusted_amount (transaction_number, floating_point);
-			tmp_balance = gsb_real_add (current_balance, adjusted_amout);
-			if(tmp_balance.mantissa != error_real.mantissa)
-			{
-				current_balance = tmp_balance;
-			}
-			else
-			{
-				current_balance_later = gsb_real_add (current_balance_later, adjusted_amout);
-			}
+			g_ptr_array_add (current_transactions, tmp_list->data);
 			marked_transaction = gsb_data_transaction_get_marked_transaction (transaction_number);
 			if (marked_transaction)
 			{
-				tmp_balance = gsb_real_add (marked_balance, adjusted_amout);
-				if(tmp_balance.mantissa != error_real.mantissa)
-					marked_balance = tmp_balance;
-				else
-					marked_balance_later = gsb_real_add (marked_balance_later, adjusted_amout);
+				g_ptr_array_add (marked_transactions, tmp_list->data);
 				if (marked_transaction == OPERATION_POINTEE)
 					has_pointed = TRUE;
 			}
@@ -1232,10 +1228,19 @@ GsbReal gsb_data_account_calculate_current_and_marked_balances (gint account_num
     }
 
     g_date_free (date_jour);
-    account->current_balance = gsb_real_add (current_balance, current_balance_later);
-    account->marked_balance = gsb_real_add (marked_balance, marked_balance_later);
+    account->current_balance = gsb_real_add (current_balance,
+											 gsb_data_transaction_get_adjusted_amounts_sum (current_transactions,
+																							account->currency,
+																							floating_point));
+    account->marked_balance = gsb_real_add (marked_balance,
+											gsb_data_transaction_get_adjusted_amounts_sum (marked_transactions,
+																						   account->currency,
+																						   floating_point));
 	account->has_pointed = has_pointed;
 
+	g_ptr_array_free (current_transactions, TRUE);
+	g_ptr_array_free (marked_transactions, TRUE);
+
     return account->current_balance;
 }
 
@@ -2744,12 +2749,16 @@ GsbReal gsb_data_account_calculate_current_day_balance (gint account_number,
         return null_real;
 
     floating_point = gsb_data_currency_get_floating_point (account->currency);
-    current_balance = gsb_real_adjust_exponent (account->init_balance, floating_point);
     if (day == NULL)
         date_jour = gdate_today ();
     else
         date_jour = gsb_date_copy (day);
 
+    /* the archive segment is loaded if some of its transactions are not before the day */
+    gsb_file_archive_segment_load_before_date (account_number, date_jour);
+    current_balance = gsb_real_add (gsb_real_adjust_exponent (account->init_balance, floating_point),
+									gsb_file_archive_segment_get_account_balance (account_number));
+
     tmp_list = gsb_data_transaction_get_active_transactions_list ();
     while (tmp_list)
     {
@@ -3682,7 +3691,11 @@ GsbReal gsb_data_account_get_balance_at_date (gint account_number,
         return null_real;
 
     floating_point = gsb_data_currency_get_floating_point (account->currency);
-    current_balance = gsb_real_adjust_exponent (account->init_balance, floating_point);
+
+    /* the archive segment is loaded if some of its transactions are not before the date */
+    gsb_file_archive_segment_load_before_date (account_number, date);
+    current_balance = gsb_real_add (gsb_real_adjust_exponent (account->init_balance, floating_point),
+									gsb_file_archive_segment_get_account_balance (account_number));
     tmp_list = gsb_data_transaction_get_active_transactions_list ();
     while (tmp_list)
     {
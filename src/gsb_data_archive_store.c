@@ -28,6 +28,9 @@
  * at the opening of grisbi, we create an intermediate list of structures which contains
  * the link to the archive, but 1 structure per account, with the number of transactions
  * and the balance for each.
+ * the stores are found through an index by archive and account, and a new
+ * archive only adds its own stores. the archives kept out of memory in the
+ * archive segment have a store made with the summary saved in the grisbi file
  */
 
 
@@ -41,6 +44,7 @@
 #include "gsb_data_account.h"
 #include "gsb_data_currency.h"
 #include "gsb_data_transaction.h"
+#include "gsb_file_archive_segment.h"
 #include "gsb_real.h"
 #include "transaction_list.h"
 #include "erreur.h"
@@ -51,6 +55,9 @@
 static void _gsb_data_archive_store_free ( StoreArchive *archive );
 static StoreArchive *gsb_data_archive_store_find_struct ( gint archive_number,
                         gint account_number );
+static gboolean gsb_data_archive_store_index_equal ( gconstpointer a,
+                        gconstpointer b );
+static guint gsb_data_archive_store_index_hash ( gconstpointer key );
 static gint gsb_data_archive_store_max_number ( void );
 static gint gsb_data_archive_store_new ( void );
 /*END_STATIC*/
@@ -64,6 +71,43 @@ static GSList *archive_store_list = NULL;
 /** a pointer to the last archive_store used (to increase the speed) */
 static StoreArchive *archive_store_buffer;
 
+/** the StoreArchive by archive number and account number */
+static GHashTable *archive_store_index = NULL;
+
+
+/**
+ * hash function of the index : an archive store is identified
+ * by its archive and its account
+ *
+ * \param key a StoreArchive
+ *
+ * \return the hash value
+ * */
+static guint gsb_data_archive_store_index_hash ( gconstpointer key )
+{
+    const StoreArchive *archive = key;
+
+    return ( guint ) archive -> archive_number * 31 + ( guint ) archive -> account_number;
+}
+
+/**
+ * equal function of the index
+ *
+ * \param a a StoreArchive
+ * \param b a StoreArchive
+ *
+ * \return TRUE if a and b are for the same archive and the same account
+ * */
+static gboolean gsb_data_archive_store_index_equal ( gconstpointer a,
+                        gconstpointer b )
+{
+    const StoreArchive *archive_1 = a;
+    const StoreArchive *archive_2 = b;
+
+    return archive_1 -> archive_number == archive_2 -> archive_number
+        && archive_1 -> account_number == archive_2 -> account_number;
+}
+
 
 /**
  * set the archives global variables to NULL,
@@ -94,6 +138,12 @@ gboolean gsb_data_archive_store_init_variables ( void )
     archive_store_list = NULL;
     archive_store_buffer = NULL;
 
+    if ( archive_store_index )
+    {
+        g_hash_table_destroy ( archive_store_index );
+        archive_store_index = NULL;
+    }
+
     return FALSE;
 }
 
@@ -133,6 +183,89 @@ gint gsb_data_archive_store_get_number ( gpointer archive_ptr )
 
 
 
+/**
+ * add an archived transaction to the archive store of its archive and its account,
+ * the archive store is created if necessary
+ *
+ * \param transaction_number an archived transaction
+ *
+ * \return
+ * */
+void gsb_data_archive_store_add_transaction ( gint transaction_number )
+{
+    StoreArchive *archive_store;
+    gint archive_number;
+    gint floating_point;
+    gint account_number;
+
+    archive_number = gsb_data_transaction_get_archive_number (transaction_number);
+    if (!archive_number)
+        return;
+
+    account_number = gsb_data_transaction_get_account_number (transaction_number);
+    floating_point = gsb_data_currency_get_floating_point (
+                        gsb_data_account_get_currency (account_number) );
+    archive_store = gsb_data_archive_store_find_struct ( archive_number, account_number);
+    if (archive_store)
+    {
+        /* there is already a StoreArchive for the same archive and the same account,
+         * we increase the balance except for operations */
+        if ( !gsb_data_transaction_get_mother_transaction_number ( transaction_number ) )
+            archive_store -> balance = gsb_real_add ( archive_store -> balance,
+                                gsb_data_transaction_get_adjusted_amount (
+                                transaction_number,
+                                floating_point));
+        archive_store -> nb_transactions++;
+    }
+    else
+    {
+        /* there is no StoreArchive for that transaction, we make a new one
+         * with the balance of the transaction as balance */
+        gsb_data_archive_store_new_with_summary ( archive_number,
+                        account_number,
+                        gsb_data_transaction_get_adjusted_amount ( transaction_number,
+                        floating_point ),
+                        gsb_data_transaction_get_mother_transaction_number ( transaction_number ) ? 0 : 1 );
+    }
+}
+
+/**
+ * create the archive store of an archive for an account
+ * with its balance and its number of transactions
+ *
+ * \param archive_number
+ * \param account_number
+ * \param balance
+ * \param nb_transactions
+ *
+ * \return the number of the new archive store
+ * */
+gint gsb_data_archive_store_new_with_summary ( gint archive_number,
+                        gint account_number,
+                        GsbReal balance,
+                        gint nb_transactions )
+{
+    StoreArchive *archive_store;
+    gint archive_store_number;
+
+    archive_store_number = gsb_data_archive_store_new ();
+    archive_store = gsb_data_archive_store_get_structure (archive_store_number);
+    if ( !archive_store )
+        return 0;
+
+    archive_store -> archive_number = archive_number;
+    archive_store -> account_number = account_number;
+    archive_store -> balance = balance;
+    archive_store -> nb_transactions = nb_transactions;
+
+    if ( !archive_store_index )
+        archive_store_index = g_hash_table_new ( gsb_data_archive_store_index_hash,
+                            gsb_data_archive_store_index_equal );
+    g_hash_table_add ( archive_store_index, archive_store );
+
+    return archive_store_number;
+}
+
 /**
  * function called at the opening of grisbi
  * create all the archive store according to the archives in grisbi
@@ -145,56 +278,16 @@ void gsb_data_archive_store_create_list ( void )
 {
     GSList *tmp_list;
 
-    tmp_list = gsb_data_transaction_get_complete_transactions_list ();
+    tmp_list = gsb_data_transaction_get_loaded_transactions_list ();
     while (tmp_list)
     {
-    gint transaction_number;
-    gint archive_number;
-
-    transaction_number = gsb_data_transaction_get_transaction_number (tmp_list -> data);
-
-    archive_number = gsb_data_transaction_get_archive_number (transaction_number);
-
-    if (archive_number)
-    {
-        StoreArchive *archive_store;
-        gint floating_point;
-        gint account_number;
-
-        account_number = gsb_data_transaction_get_account_number (transaction_number);
-        floating_point = gsb_data_currency_get_floating_point (
-                            gsb_data_account_get_currency (account_number) );
-        archive_store = gsb_data_archive_store_find_struct ( archive_number, account_number);
-        if (archive_store)
-        {
-            /* there is already a StoreArchive for the same archive and the same account,
-             * we increase the balance except for operations */
-            if ( !gsb_data_transaction_get_mother_transaction_number ( transaction_number ) )
-                archive_store -> balance = gsb_real_add ( archive_store -> balance,
-                                    gsb_data_transaction_get_adjusted_amount (
-                                    transaction_number,
-                                    floating_point));
-            archive_store -> nb_transactions++;
-        }
-        else
-        {
-            /* there is no StoreArchive for that transaction, we make a new one
-             * with the balance of the transaction as balance */
-            gint archive_store_number;
-
-            archive_store_number = gsb_data_archive_store_new ();
-            archive_store = gsb_data_archive_store_get_structure (archive_store_number);
-
-            archive_store -> archive_number = archive_number;
-            archive_store -> account_number = account_number;
-            archive_store -> balance = gsb_data_transaction_get_adjusted_amount (
-                            transaction_number, floating_point);
-            if ( ! gsb_data_transaction_get_mother_transaction_number ( transaction_number ) )
-                archive_store -> nb_transactions = 1;
-        }
-    }
+    gsb_data_archive_store_add_transaction (
+                        gsb_data_transaction_get_transaction_number (tmp_list -> data));
     tmp_list = tmp_list -> next;
     }
+
+    /* the archives of the archive segment are not loaded, their stores are made with their summaries */
+    gsb_file_archive_segment_add_stores ();
 }
 
 /**
@@ -205,6 +298,9 @@ static void _gsb_data_archive_store_free ( StoreArchive *archive )
     if ( !archive )
         return;
 
+    if ( archive_store_index )
+        g_hash_table_remove ( archive_store_index, archive );
+
     g_free ( archive );
 
     if ( archive_store_buffer == archive )
@@ -423,23 +519,29 @@ static gint gsb_data_archive_store_max_number ( void )
 static StoreArchive *gsb_data_archive_store_find_struct ( gint archive_number,
                         gint account_number )
 {
-    GSList *tmp_list;
+    StoreArchive key;
 
-    tmp_list = archive_store_list;
-    while (tmp_list)
-    {
-    StoreArchive *archive;
+    if ( !archive_store_index )
+        return NULL;
 
-    archive = tmp_list -> data;
+    key.archive_number = archive_number;
+    key.account_number = account_number;
 
-    if (archive -> archive_number == archive_number
-        &&
-        archive -> account_number == account_number )
-        return archive;
+    return g_hash_table_lookup ( archive_store_index, &key );
+}
 
-    tmp_list = tmp_list -> next;
-    }
-    return NULL;
+/**
+ * return the archive store of the archive for the account
+ *
+ * \param archive_number
+ * \param account_number
+ *
+ * \return a pointer to the StoreArchive or NULL
+ * */
+gpointer gsb_data_archive_store_get_structure_by_archive ( gint archive_number,
+                        gint account_number )
+{
+    return gsb_data_archive_store_find_struct ( archive_number, account_number );
 }
 
 /**
@@ -37,6 +37,7 @@ struct _StoreArchive
 
 /* START_DECLARATION */
 gboolean 	gsb_data_archive_store_account_have_transactions_visibles 	(gint account_number);
+void 		gsb_data_archive_store_add_transaction 						(gint transaction_number);
 void 		gsb_data_archive_store_create_list 							(void);
 gint 		gsb_data_archive_store_get_account_number 					(gint archive_store_number);
 gint 		gsb_data_archive_store_get_archive_number 					(gint archive_store_number);
@@ -45,10 +46,16 @@ GSList *	gsb_data_archive_store_get_archives_list 					(void);
 GsbReal 	gsb_data_archive_store_get_balance 							(gint archive_store_number);
 gint 		gsb_data_archive_store_get_number 							(gpointer archive_ptr);
 gpointer 	gsb_data_archive_store_get_structure 						(gint archive_store_number);
+gpointer 	gsb_data_archive_store_get_structure_by_archive 			(gint archive_number,
+																		 gint account_number);
 gint 		gsb_data_archive_store_get_transactions_number 				(gint archive_store_number);
 gboolean 	gsb_data_archive_store_get_transactions_visibles 			(gint archive_number,
 																		 gint account_number);
 gboolean 	gsb_data_archive_store_init_variables 						(void);
+gint 		gsb_data_archive_store_new_with_summary 					(gint archive_number,
+																		 gint account_number,
+																		 GsbReal balance,
+																		 gint nb_transactions);
 gboolean 	gsb_data_archive_store_remove 								(gint archive_store_number);
 gboolean 	gsb_data_archive_store_remove_by_archive 					(gint archive_number);
 gboolean 	gsb_data_archive_store_set_transactions_visibles 			(gint archive_number,
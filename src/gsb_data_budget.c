@@ -85,6 +85,18 @@ struct _SubBudgetStruct
 };
 
 
+/* struct Describe what a transaction has added to the counters of the budgets */
+typedef struct _BudgetCounterStruct		BudgetCounterStruct;
+
+struct _BudgetCounterStruct
+{
+    gint budget_number;			/**< 0 for the empty budget */
+    gint sub_budget_number;		/**< 0 if counted in the direct balance */
+    gboolean counted;
+    TransactionCountedAmount amount;
+};
+
+
 /*START_STATIC*/
 static void _gsb_data_budget_free ( BudgetStruct* budget );
 static void _gsb_data_sub_budget_free ( SubBudgetStruct* sub_budget );
@@ -101,7 +113,9 @@ static gint gsb_data_budget_max_sub_budget_number ( gint budget_number );
 static gint gsb_data_budget_new ( const gchar *name );
 static gint gsb_data_budget_new_sub_budget ( gint budget_number,
                         const gchar *name );
-static void gsb_data_budget_reset_counters ( void );
+static BudgetCounterStruct *gsb_data_budget_get_counter ( gint transaction_number,
+                        gboolean create );
+static GHashTable *gsb_data_budget_get_index ( void );
 static gint gsb_data_sub_budget_compare ( SubBudgetStruct * a, SubBudgetStruct * b );
 /*END_STATIC*/
 
@@ -119,6 +133,12 @@ static SubBudgetStruct *sub_budget_buffer;
  * the number of the empty budget is 0 */
 static BudgetStruct *empty_budget = NULL;
 
+/** the budgets by number, built at the first use */
+static GHashTable *budget_index = NULL;
+
+/** what the transactions have added to the counters, indexed by transaction number */
+static GArray *budget_counters = NULL;
+
 
 /**
  * set the budgets global variables to NULL, usually when we init all the global variables
@@ -134,6 +154,14 @@ gboolean gsb_data_budget_init_variables (gboolean cleanup)
         g_slist_free_full ( budget_list, (GDestroyNotify) _gsb_data_budget_free );
     }
 
+    if ( budget_index )
+    {
+        g_hash_table_destroy ( budget_index );
+        budget_index = NULL;
+    }
+    if ( budget_counters )
+        g_array_set_size ( budget_counters, 0 );
+
 	if (cleanup)
 	{
         budget_list = NULL;
@@ -192,6 +220,8 @@ static void _gsb_data_sub_budget_free ( SubBudgetStruct* sub_budget )
  * */
 gpointer gsb_data_budget_get_structure ( gint no_budget )
 {
+    BudgetStruct *budget;
+
     if (!no_budget)
 	return empty_budget;
 
@@ -202,8 +232,41 @@ gpointer gsb_data_budget_get_structure ( gint no_budget )
 	 budget_buffer -> budget_number == no_budget )
 	return budget_buffer;
 
-    return gsb_data_budget_get_structure_in_list ( no_budget,
-						   budget_list );
+    budget = g_hash_table_lookup ( gsb_data_budget_get_index (),
+                        GINT_TO_POINTER ( no_budget ) );
+    if ( budget )
+        budget_buffer = budget;
+
+    return budget;
+}
+
+
+/**
+ * return the budgets by number, the index is built at the first call
+ *
+ * \param
+ *
+ * \return the index
+ * */
+static GHashTable *gsb_data_budget_get_index ( void )
+{
+    GSList *tmp_list;
+
+    if ( budget_index )
+        return budget_index;
+
+    budget_index = g_hash_table_new ( g_direct_hash, g_direct_equal );
+    tmp_list = budget_list;
+    while ( tmp_list )
+    {
+        BudgetStruct *budget;
+
+        budget = tmp_list -> data;
+        g_hash_table_insert ( budget_index, GINT_TO_POINTER ( budget -> budget_number ), budget );
+        tmp_list = tmp_list -> next;
+    }
+
+    return budget_index;
 }
 
 
@@ -468,9 +531,15 @@ gint gsb_data_budget_new ( const gchar *name )
 
     /* append the name if necessary */
 
+    /* the name is set without gsb_data_budget_set_name () to not rebuild
+     * the combofix, the callers append the new budget to it */
     if (name)
-	gsb_data_budget_set_name ( budget_number,
-				   name );
+    {
+	BudgetStruct *budget;
+
+	budget = gsb_data_budget_get_structure ( budget_number );
+	budget -> budget_name = my_strdup ( name );
+    }
     return budget_number;
 }
 
@@ -495,6 +564,8 @@ gint gsb_data_budget_new_with_number ( gint number )
 
     budget_list = g_slist_append ( budget_list,
 				   budget );
+    if ( budget_index )
+        g_hash_table_insert ( budget_index, GINT_TO_POINTER ( number ), budget );
 
     budget_buffer = budget;
 
@@ -524,6 +595,8 @@ gboolean gsb_data_budget_remove ( gint no_budget )
 
     budget_list = g_slist_remove ( budget_list,
 				   budget );
+    if ( budget_index )
+        g_hash_table_remove ( budget_index, GINT_TO_POINTER ( no_budget ) );
 
     _gsb_data_budget_free (budget);
 
@@ -675,7 +748,7 @@ gint gsb_data_budget_get_number_by_name ( const gchar *name,
 	{
 	    budget_number = gsb_data_budget_new (name);
 	    gsb_data_budget_set_type ( budget_number, budget_type );
-	    gsb_budget_update_combofix ( FALSE );
+	    gsb_budget_append_to_combofix ( budget_number, 0 );
 	}
     }
     return budget_number;
@@ -725,7 +798,7 @@ gint gsb_data_budget_get_sub_budget_number_by_name ( gint budget_number,
         if ( create )
         {
             sub_budget_number = gsb_data_budget_new_sub_budget ( budget_number, name );
-            gsb_budget_update_combofix ( FALSE );
+            gsb_budget_append_to_combofix ( budget_number, sub_budget_number );
         }
     }
     return sub_budget_number;
@@ -1228,68 +1301,80 @@ void gsb_data_budget_reset_counters ( void )
     empty_budget -> budget_nb_transactions = 0;
     empty_budget -> budget_direct_balance = null_real;
     empty_budget -> budget_nb_direct_transactions = 0;
+
+    if ( budget_counters )
+        g_array_set_size ( budget_counters, 0 );
 }
 
 /**
- * update the counters of the budgets
+ * return what the transaction has added to the counters
  *
- * \param
+ * \param transaction_number
+ * \param create TRUE to grow the array if necessary
  *
- * \return
+ * \return the structure or NULL
  * */
-void gsb_data_budget_update_counters ( void )
+static BudgetCounterStruct *gsb_data_budget_get_counter ( gint transaction_number,
+                        gboolean create )
 {
-    GSList *list_tmp_transactions;
-	GrisbiWinEtat *w_etat;
-
-	w_etat = grisbi_win_get_w_etat ();
+    if ( transaction_number <= 0 )
+        return NULL;
 
-    gsb_data_budget_reset_counters ();
-
-    if ( w_etat->metatree_add_archive_in_totals )
-        list_tmp_transactions = gsb_data_transaction_get_complete_transactions_list ();
-    else
-        list_tmp_transactions = gsb_data_transaction_get_transactions_list ();
-
-    while ( list_tmp_transactions )
+    if ( !budget_counters )
     {
-	gint transaction_number_tmp = gsb_data_transaction_get_transaction_number ( list_tmp_transactions -> data);
-
-	gsb_data_budget_add_transaction_to_budget ( transaction_number_tmp,
-						    gsb_data_transaction_get_budgetary_number ( transaction_number_tmp ),
-						    gsb_data_transaction_get_sub_budgetary_number ( transaction_number_tmp ) );
+        if ( !create )
+            return NULL;
+        budget_counters = g_array_new ( FALSE, TRUE, sizeof ( BudgetCounterStruct ) );
+    }
 
-	list_tmp_transactions = list_tmp_transactions -> next;
+    if ( (guint) transaction_number >= budget_counters -> len )
+    {
+        if ( !create )
+            return NULL;
+        g_array_set_size ( budget_counters, transaction_number + 1 );
     }
+
+    return &g_array_index ( budget_counters, BudgetCounterStruct, transaction_number );
 }
 
 
 /**
- * Add the given transaction to a budget in the counters if no budget
- * is specified, add it to the blank budget.
+ * Add the given transaction to a budget in the counters if no
+ * budget is specified, add it to the blank budget.
+ * if the transaction was already counted, it is removed before from its
+ * previous budget
  *
- * \param transaction_number	Transaction we want to work with.
- * \param budget_id		Budget to add transaction into total.
- * \param sub_budget_id		Sub-budget to add transaction into total.
- */
-void gsb_data_budget_add_transaction_to_budget ( gint transaction_number,
+ * \param transaction_number the transaction we want to work with
+ * \param budget_id
+ * \param sub_budget_id
+ * \param batch a batch of balances to sum the amount later, NULL to add it now
+ *
+ * \return
+ * */
+void gsb_data_budget_add_transaction_to_counters ( gint transaction_number,
                         gint budget_id,
-                        gint sub_budget_id )
+                        gint sub_budget_id,
+                        GHashTable *batch )
 {
     BudgetStruct *budget;
     SubBudgetStruct *sub_budget;
+    BudgetCounterStruct *counter;
+    GsbReal amount = null_real;
+
+    gsb_data_budget_remove_transaction_from_budget ( transaction_number );
+
+    if ( !gsb_data_transaction_is_in_counters ( transaction_number ) )
+        return;
 
     /* if the transaction is a transfer or a split transaction, don't take it */
     if (gsb_data_transaction_get_split_of_transaction (transaction_number)
-		||
-		gsb_data_transaction_get_contra_transaction_number (transaction_number) > 0)
-	{
-		return;
-	}
+	||
+	gsb_data_transaction_get_contra_transaction_number (transaction_number) > 0)
+	return;
 
-	budget = gsb_data_budget_get_structure (  budget_id );
-    sub_budget = gsb_data_budget_get_sub_budget_structure ( budget_id ,
-							    sub_budget_id );
+    budget = gsb_data_budget_get_structure ( budget_id );
+    sub_budget = gsb_data_budget_get_sub_budget_structure ( budget_id,
+                        sub_budget_id );
 
     /* should not happen, this is if the transaction has a budget which doesn't exist
      * we show a debug warning and get without budget */
@@ -1306,38 +1391,81 @@ void gsb_data_budget_add_transaction_to_budget ( gint transaction_number,
         budget = empty_budget;
     }
 
-    /* now budget is on the budget structure or on empty_budget */
-    if ( budget )
-    {
-	budget -> budget_nb_transactions ++;
-    budget -> budget_balance = gsb_real_add ( budget -> budget_balance,
-                        gsb_data_transaction_get_adjusted_amount_for_currency (
-                        transaction_number, budgetary_line_tree_currency (), -1));
-    }
+    /* if we were on empty budget, no sub-budget */
+    if ( budget == empty_budget )
+        sub_budget = NULL;
+
+    counter = gsb_data_budget_get_counter ( transaction_number, TRUE );
+    counter -> budget_number = budget -> budget_number;
+    counter -> sub_budget_number = sub_budget ? sub_budget -> sub_budget_number : 0;
+    counter -> counted = TRUE;
+    gsb_data_transaction_get_counted_amount ( transaction_number, budgetary_line_tree_currency (), &counter -> amount );
+    if ( !batch )
+        amount = gsb_data_transaction_get_counted_amount_value ( &counter -> amount, budgetary_line_tree_currency () );
+
+    /* ok, now budget is on the structure or on empty_budget */
+    budget -> budget_nb_transactions ++;
+    if ( batch )
+        gsb_data_transaction_balances_batch_append ( batch, &budget -> budget_balance, transaction_number );
+    else
+        budget -> budget_balance = gsb_real_add ( budget -> budget_balance, amount );
 
-    /* if we are on empty_budget, no sub-budget */
     if (budget == empty_budget)
 	return;
 
     if ( sub_budget )
     {
 	sub_budget -> sub_budget_nb_transactions ++;
-    sub_budget -> sub_budget_balance = gsb_real_add (sub_budget -> sub_budget_balance,
-                        gsb_data_transaction_get_adjusted_amount_for_currency (
-                        transaction_number, budgetary_line_tree_currency (), -1));
+	if ( batch )
+	    gsb_data_transaction_balances_batch_append ( batch, &sub_budget -> sub_budget_balance, transaction_number );
+	else
+	    sub_budget -> sub_budget_balance = gsb_real_add ( sub_budget -> sub_budget_balance, amount );
     }
     else
     {
 	budget -> budget_nb_direct_transactions ++;
-    budget -> budget_direct_balance = gsb_real_add (budget -> budget_direct_balance,
-                            gsb_data_transaction_get_adjusted_amount_for_currency (
-                            transaction_number, budgetary_line_tree_currency (), -1));
+	if ( batch )
+	    gsb_data_transaction_balances_batch_append ( batch, &budget -> budget_direct_balance, transaction_number );
+	else
+	    budget -> budget_direct_balance = gsb_real_add ( budget -> budget_direct_balance, amount );
     }
 }
 
+
+/**
+ * update the counters of the budgets
+ * the payees, the categories and the budgets are counted together,
+ * and only the transactions modified since the last time are counted again
+ *
+ * \param
+ *
+ * \return
+ * */
+void gsb_data_budget_update_counters ( void )
+{
+    gsb_data_transaction_update_counters ();
+}
+
+
+/**
+ * Add the given transaction to a budget in the counters if no budget
+ * is specified, add it to the blank budget.
+ *
+ * \param transaction_number	Transaction we want to work with.
+ * \param budget_id		Budget to add transaction into total.
+ * \param sub_budget_id		Sub-budget to add transaction into total.
+ */
+void gsb_data_budget_add_transaction_to_budget ( gint transaction_number,
+                        gint budget_id,
+                        gint sub_budget_id )
+{
+    gsb_data_budget_add_transaction_to_counters ( transaction_number, budget_id, sub_budget_id, NULL );
+}
+
 /**
- * remove the given transaction to its budget in the counters
- * if the transaction has no budget, remove it to the blank budget
+ * remove the given transaction from the counters
+ * the transaction is removed from the budget it was added to,
+ * even if its budget or its amount have been changed since
  *
  * \param transaction_number the transaction we want to work with
  *
@@ -1347,40 +1475,45 @@ void gsb_data_budget_remove_transaction_from_budget ( gint transaction_number )
 {
     BudgetStruct *budget;
     SubBudgetStruct *sub_budget;
+    BudgetCounterStruct *counter;
+    GsbReal amount;
 
-    budget = gsb_data_budget_get_structure ( gsb_data_transaction_get_budgetary_number (transaction_number));
-    sub_budget = gsb_data_budget_get_sub_budget_structure ( gsb_data_transaction_get_budgetary_number (transaction_number),
-							    gsb_data_transaction_get_sub_budgetary_number (transaction_number));
+    counter = gsb_data_budget_get_counter ( transaction_number, FALSE );
+    if ( !counter || !counter -> counted )
+        return;
 
-    if ( budget )
-    {
-	budget -> budget_nb_transactions --;
-	budget -> budget_balance = gsb_real_sub ( budget -> budget_balance,
-						  gsb_data_transaction_get_adjusted_amount_for_currency ( transaction_number,
-													  budgetary_line_tree_currency (), -1));
-	if ( !budget -> budget_nb_transactions ) /* Cope with float errors */
-	    budget -> budget_balance = null_real;
-    }
+    counter -> counted = FALSE;
+    amount = gsb_data_transaction_get_counted_amount_value ( &counter -> amount, budgetary_line_tree_currency () );
 
-    if ( sub_budget )
+    /* the budget or the sub-budget can have been removed since */
+    budget = gsb_data_budget_get_structure ( counter -> budget_number );
+    if ( !budget )
+        return;
+
+    if ( counter -> sub_budget_number )
     {
-	sub_budget -> sub_budget_nb_transactions --;
-	sub_budget -> sub_budget_balance = gsb_real_sub ( sub_budget -> sub_budget_balance,
-							  gsb_data_transaction_get_adjusted_amount_for_currency ( transaction_number,
-														  budgetary_line_tree_currency (), -1));
-	if ( !sub_budget -> sub_budget_nb_transactions ) /* Cope with float errors */
-	    sub_budget -> sub_budget_balance = null_real;
+        sub_budget = gsb_data_budget_get_sub_budget_structure ( counter -> budget_number,
+                        counter -> sub_budget_number );
+        if ( sub_budget )
+        {
+            sub_budget -> sub_budget_nb_transactions --;
+            sub_budget -> sub_budget_balance = gsb_real_sub ( sub_budget -> sub_budget_balance,
+                        amount );
+            if ( !sub_budget -> sub_budget_nb_transactions ) /* Cope with float errors */
+                sub_budget -> sub_budget_balance = null_real;
+        }
     }
-    else
+    else if ( budget != empty_budget )
     {
-	if ( budget )
-	{
-	    budget -> budget_nb_direct_transactions --;
-	    budget -> budget_direct_balance = gsb_real_sub ( budget -> budget_direct_balance,
-							     gsb_data_transaction_get_adjusted_amount_for_currency ( transaction_number,
-														     budgetary_line_tree_currency (), -1));
-	}
+        budget -> budget_nb_direct_transactions --;
+        budget -> budget_direct_balance = gsb_real_sub ( budget -> budget_direct_balance,
+                        amount );
     }
+
+    budget -> budget_nb_transactions --;
+    budget -> budget_balance = gsb_real_sub ( budget -> budget_balance, amount );
+    if ( !budget -> budget_nb_transactions ) /* Cope with float errors */
+        budget -> budget_balance = null_real;
 }
 
 
@@ -1648,7 +1781,7 @@ gint gsb_data_budget_test_create_budget ( gint no_budget,
         {
             budget_number = gsb_data_budget_new (name);
             gsb_data_budget_set_type ( budget_number, budget_type );
-            gsb_budget_update_combofix ( FALSE );
+            gsb_budget_append_to_combofix ( budget_number, 0 );
         }
         return budget_number;
     }
@@ -1695,8 +1828,8 @@ gboolean gsb_data_budget_test_create_sub_budget ( gint no_budget,
         }
         else
         {
-            gsb_data_budget_new_sub_budget ( no_budget, name );
-            gsb_budget_update_combofix ( FALSE );
+            gsb_budget_append_to_combofix ( no_budget,
+                        gsb_data_budget_new_sub_budget ( no_budget, name ) );
         }
         return TRUE;
     }
@@ -9,6 +9,10 @@
 void 		gsb_data_budget_add_transaction_to_budget 		(gint transaction_number,
 															 gint budget_id,
 															 gint sub_budget_id);
+void 		gsb_data_budget_add_transaction_to_counters 	(gint transaction_number,
+															 gint budget_id,
+															 gint sub_budget_id,
+															 GHashTable *batch);
 GsbReal 	gsb_data_budget_get_balance 					(gint no_budget);
 GSList *	gsb_data_budget_get_budgets_list 				(void);
 GsbReal 	gsb_data_budget_get_direct_balance 				(gint no_budget);
@@ -49,6 +53,7 @@ gint 		gsb_data_budget_new_sub_budget_with_number 		(gint number,
 gint 		gsb_data_budget_new_with_number 				(gint number);
 gboolean 	gsb_data_budget_remove 							(gint no_budget);
 void 		gsb_data_budget_remove_transaction_from_budget 	(gint transaction_number);
+void 		gsb_data_budget_reset_counters 					(void);
 void 		gsb_data_budget_set_budget_from_string 			(gint transaction_number,
 															 const gchar *string,
 															 gboolean is_transaction);
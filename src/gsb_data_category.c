@@ -84,6 +84,18 @@ struct _SubCategoryStruct
     GsbReal sub_category_balance;
 };
 
+
+/* struct Describe what a transaction has added to the counters of the categories */
+typedef struct _CategoryCounterStruct		CategoryCounterStruct;
+
+struct _CategoryCounterStruct
+{
+    gint category_number;		/**< 0 for the empty category */
+    gint sub_category_number;	/**< 0 if counted in the direct balance */
+    gboolean counted;
+    TransactionCountedAmount amount;
+};
+
 /*START_STATIC*/
 static void _gsb_data_category_free ( CategoryStruct *category );
 static void _gsb_data_sub_category_free ( SubCategoryStruct *sub_category );
@@ -100,7 +112,9 @@ static gint gsb_data_category_max_sub_category_number ( gint category_number );
 static gint gsb_data_category_new ( const gchar *name );
 static gint gsb_data_category_new_sub_category ( gint category_number,
                         const gchar *name );
-static void gsb_data_category_reset_counters ( void );
+static CategoryCounterStruct *gsb_data_category_get_counter ( gint transaction_number,
+                        gboolean create );
+static GHashTable *gsb_data_category_get_index ( void );
 static gint gsb_data_sub_category_compare ( SubCategoryStruct * a, SubCategoryStruct * b );
 /*END_STATIC*/
 
@@ -119,6 +133,12 @@ static SubCategoryStruct *sub_category_buffer;
  * the number of the empty category is 0 */
 static CategoryStruct *empty_category = NULL;
 
+/** the categories by number, built at the first use */
+static GHashTable *category_index = NULL;
+
+/** what the transactions have added to the counters, indexed by transaction number */
+static GArray *category_counters = NULL;
+
 /* used to choose the kind of categories list */
 enum CategoryChoiceValues {
     CATEGORY_CHOICE_NONE = 0,
@@ -152,6 +172,14 @@ gboolean gsb_data_category_init_variables (gboolean cleanup)
 	    g_slist_free (category_list);
     }
 
+    if ( category_index )
+    {
+        g_hash_table_destroy ( category_index );
+        category_index = NULL;
+    }
+    if ( category_counters )
+        g_array_set_size ( category_counters, 0 );
+
 	if (cleanup)
 	{
 		category_list = NULL;
@@ -181,6 +209,8 @@ gboolean gsb_data_category_init_variables (gboolean cleanup)
  * */
 gpointer gsb_data_category_get_structure ( gint no_category )
 {
+    CategoryStruct *category;
+
     if (!no_category)
 	return empty_category;
 
@@ -191,8 +221,41 @@ gpointer gsb_data_category_get_structure ( gint no_category )
 	 category_buffer -> category_number == no_category )
 	return category_buffer;
 
-    return gsb_data_category_get_structure_in_list ( no_category,
-						     category_list );
+    category = g_hash_table_lookup ( gsb_data_category_get_index (),
+                        GINT_TO_POINTER ( no_category ) );
+    if ( category )
+        category_buffer = category;
+
+    return category;
+}
+
+
+/**
+ * return the categories by number, the index is built at the first call
+ *
+ * \param
+ *
+ * \return the index
+ * */
+static GHashTable *gsb_data_category_get_index ( void )
+{
+    GSList *tmp_list;
+
+    if ( category_index )
+        return category_index;
+
+    category_index = g_hash_table_new ( g_direct_hash, g_direct_equal );
+    tmp_list = category_list;
+    while ( tmp_list )
+    {
+        CategoryStruct *category;
+
+        category = tmp_list -> data;
+        g_hash_table_insert ( category_index, GINT_TO_POINTER ( category -> category_number ), category );
+        tmp_list = tmp_list -> next;
+    }
+
+    return category_index;
 }
 
 
@@ -453,9 +516,15 @@ gint gsb_data_category_new ( const gchar *name )
 
     /* append the name if necessary */
 
+    /* the name is set without gsb_data_category_set_name () to not rebuild
+     * the combofix, the callers append the new category to it */
     if (name)
-	gsb_data_category_set_name ( category_number,
-				     name );
+    {
+	CategoryStruct *category;
+
+	category = gsb_data_category_get_structure ( category_number );
+	category -> category_name = my_strdup ( name );
+    }
     return category_number;
 }
 
@@ -478,6 +547,8 @@ gint gsb_data_category_new_with_number ( gint number )
 
     category_list = g_slist_append ( category_list,
 				     category );
+    if ( category_index )
+        g_hash_table_insert ( category_index, GINT_TO_POINTER ( number ), category );
 
     category_buffer = category;
 
@@ -507,6 +578,8 @@ gboolean gsb_data_category_remove ( gint no_category )
 
     category_list = g_slist_remove ( category_list,
 				     category );
+    if ( category_index )
+        g_hash_table_remove ( category_index, GINT_TO_POINTER ( no_category ) );
 
     _gsb_data_category_free (category);
 
@@ -763,7 +836,7 @@ gint gsb_data_category_get_number_by_name ( const gchar *name,
 	{
 	    category_number = gsb_data_category_new (name);
 	    gsb_data_category_set_type ( category_number, category_type );
-	    gsb_category_update_combofix ( FALSE );
+	    gsb_category_append_to_combofix ( category_number, 0 );
 	}
     }
     return category_number;
@@ -811,7 +884,7 @@ gint gsb_data_category_get_sub_category_number_by_name ( gint category_number,
 	{
 	    sub_category_number = gsb_data_category_new_sub_category ( category_number,
 								       name);
-	    gsb_category_update_combofix ( FALSE );
+	    gsb_category_append_to_combofix ( category_number, sub_category_number );
 	}
     }
     return sub_category_number;
@@ -1397,62 +1470,72 @@ void gsb_data_category_reset_counters ( void )
     empty_category -> category_nb_transactions = 0;
     empty_category -> category_direct_balance = null_real;
     empty_category -> category_nb_direct_transactions = 0;
+
+    if ( category_counters )
+        g_array_set_size ( category_counters, 0 );
 }
 
 
 
 /**
- * update the counters of the categories
+ * return what the transaction has added to the counters
  *
- * \param
+ * \param transaction_number
+ * \param create TRUE to grow the array if necessary
  *
- * \return
+ * \return the structure or NULL
  * */
-void gsb_data_category_update_counters ( void )
+static CategoryCounterStruct *gsb_data_category_get_counter ( gint transaction_number,
+                        gboolean create )
 {
-    GSList *list_tmp_transactions;
-	GrisbiWinEtat *w_etat;
+    if ( transaction_number <= 0 )
+        return NULL;
 
-	w_etat = grisbi_win_get_w_etat ();
-
-    gsb_data_category_reset_counters ();
-
-    if ( w_etat->metatree_add_archive_in_totals )
-        list_tmp_transactions = gsb_data_transaction_get_complete_transactions_list ();
-    else
-        list_tmp_transactions = gsb_data_transaction_get_transactions_list ();
-
-    while ( list_tmp_transactions )
+    if ( !category_counters )
     {
-    gint transaction_number_tmp;
-    transaction_number_tmp = gsb_data_transaction_get_transaction_number (
-                        list_tmp_transactions -> data );
-
-    gsb_data_category_add_transaction_to_category ( transaction_number_tmp,
-                        gsb_data_transaction_get_category_number ( transaction_number_tmp ),
-                        gsb_data_transaction_get_sub_category_number (
-                        transaction_number_tmp ) );
+        if ( !create )
+            return NULL;
+        category_counters = g_array_new ( FALSE, TRUE, sizeof ( CategoryCounterStruct ) );
+    }
 
-    list_tmp_transactions = list_tmp_transactions -> next;
+    if ( (guint) transaction_number >= category_counters -> len )
+    {
+        if ( !create )
+            return NULL;
+        g_array_set_size ( category_counters, transaction_number + 1 );
     }
-}
 
+    return &g_array_index ( category_counters, CategoryCounterStruct, transaction_number );
+}
 
 
 /**
  * Add the given transaction to a category in the counters if no
  * category is specified, add it to the blank category.
+ * if the transaction was already counted, it is removed before from its
+ * previous category
  *
  * \param transaction_number the transaction we want to work with
+ * \param category_id
+ * \param sub_category_id
+ * \param batch a batch of balances to sum the amount later, NULL to add it now
  *
  * \return
  * */
-void gsb_data_category_add_transaction_to_category ( gint transaction_number,
-						     gint category_id,
-						     gint sub_category_id )
+void gsb_data_category_add_transaction_to_counters ( gint transaction_number,
+                        gint category_id,
+                        gint sub_category_id,
+                        GHashTable *batch )
 {
     CategoryStruct *category;
     SubCategoryStruct *sub_category;
+    CategoryCounterStruct *counter;
+    GsbReal amount = null_real;
+
+    gsb_data_category_remove_transaction_from_category ( transaction_number );
+
+    if ( !gsb_data_transaction_is_in_counters ( transaction_number ) )
+        return;
 
     /* if the transaction is a transfer or a split transaction, don't take it */
     if (gsb_data_transaction_get_split_of_transaction (transaction_number)
@@ -1462,7 +1545,7 @@ void gsb_data_category_add_transaction_to_category ( gint transaction_number,
 
     category = gsb_data_category_get_structure ( category_id );
     sub_category = gsb_data_category_get_sub_category_structure ( category_id,
-								  sub_category_id );
+                        sub_category_id );
 
     /* should not happen, this is if the transaction has a categ which doesn't exist
      * we show a debug warning and get without categ */
@@ -1479,44 +1562,81 @@ void gsb_data_category_add_transaction_to_category ( gint transaction_number,
         category = empty_category;
     }
 
+    /* if we were on empty category, no sub-category */
+    if ( category == empty_category )
+        sub_category = NULL;
+
+    counter = gsb_data_category_get_counter ( transaction_number, TRUE );
+    counter -> category_number = category -> category_number;
+    counter -> sub_category_number = sub_category ? sub_category -> sub_category_number : 0;
+    counter -> counted = TRUE;
+    gsb_data_transaction_get_counted_amount ( transaction_number, category_tree_currency (), &counter -> amount );
+    if ( !batch )
+        amount = gsb_data_transaction_get_counted_amount_value ( &counter -> amount, category_tree_currency () );
+
     /* ok, now category is on the structure or on empty_category */
-    if ( category )
-    {
-	category -> category_nb_transactions ++;
-    if ( ! gsb_data_transaction_get_split_of_transaction ( transaction_number ) )
-        category -> category_balance = gsb_real_add ( category -> category_balance,
-                        gsb_data_transaction_get_adjusted_amount_for_currency (
-                        transaction_number, category_tree_currency (), -1));
-    }
+    category -> category_nb_transactions ++;
+    if ( batch )
+        gsb_data_transaction_balances_batch_append ( batch, &category -> category_balance, transaction_number );
+    else
+        category -> category_balance = gsb_real_add ( category -> category_balance, amount );
 
-    /* if we were on empty category, no sub-category */
     if (category == empty_category)
 	return;
 
     if ( sub_category )
     {
 	sub_category -> sub_category_nb_transactions ++;
-    if ( ! gsb_data_transaction_get_split_of_transaction ( transaction_number ) )
-        sub_category -> sub_category_balance = gsb_real_add (
-                        sub_category -> sub_category_balance,
-                        gsb_data_transaction_get_adjusted_amount_for_currency (
-                        transaction_number, category_tree_currency (), -1));
+	if ( batch )
+	    gsb_data_transaction_balances_batch_append ( batch, &sub_category -> sub_category_balance, transaction_number );
+	else
+	    sub_category -> sub_category_balance = gsb_real_add ( sub_category -> sub_category_balance, amount );
     }
     else
     {
 	category -> category_nb_direct_transactions ++;
-    if ( ! gsb_data_transaction_get_split_of_transaction ( transaction_number ) )
-        category -> category_direct_balance = gsb_real_add (
-                        category -> category_direct_balance,
-                        gsb_data_transaction_get_adjusted_amount_for_currency (
-                        transaction_number, category_tree_currency (), -1));
+	if ( batch )
+	    gsb_data_transaction_balances_batch_append ( batch, &category -> category_direct_balance, transaction_number );
+	else
+	    category -> category_direct_balance = gsb_real_add ( category -> category_direct_balance, amount );
     }
 }
 
 
 /**
- * remove the given transaction to its category in the counters
- * if the transaction has no category, remove it to the blank category
+ * update the counters of the categories
+ * the payees, the categories and the budgets are counted together,
+ * and only the transactions modified since the last time are counted again
+ *
+ * \param
+ *
+ * \return
+ * */
+void gsb_data_category_update_counters ( void )
+{
+    gsb_data_transaction_update_counters ();
+}
+
+
+/**
+ * Add the given transaction to a category in the counters if no
+ * category is specified, add it to the blank category.
+ *
+ * \param transaction_number the transaction we want to work with
+ *
+ * \return
+ * */
+void gsb_data_category_add_transaction_to_category ( gint transaction_number,
+						     gint category_id,
+						     gint sub_category_id )
+{
+    gsb_data_category_add_transaction_to_counters ( transaction_number, category_id, sub_category_id, NULL );
+}
+
+/**
+ * remove the given transaction from the counters
+ * the transaction is removed from the category it was added to,
+ * even if its category or its amount have been changed since
  *
  * \param transaction_number the transaction we want to work with
  *
@@ -1525,41 +1645,46 @@ void gsb_data_category_add_transaction_to_category ( gint transaction_number,
 void gsb_data_category_remove_transaction_from_category ( gint transaction_number )
 {
     CategoryStruct *category;
-    SubCategoryStruct *sub_category;
+    SubCategoryStruct *sub_category = NULL;
+    CategoryCounterStruct *counter;
+    GsbReal amount;
 
-    category = gsb_data_category_get_structure ( gsb_data_transaction_get_category_number (transaction_number));
-    sub_category = gsb_data_category_get_sub_category_structure ( gsb_data_transaction_get_category_number (transaction_number),
-								  gsb_data_transaction_get_sub_category_number (transaction_number));
+    counter = gsb_data_category_get_counter ( transaction_number, FALSE );
+    if ( !counter || !counter -> counted )
+        return;
 
-    if ( category )
-    {
-	category -> category_nb_transactions --;
-	category -> category_balance = gsb_real_sub ( category -> category_balance,
-						      gsb_data_transaction_get_adjusted_amount_for_currency ( transaction_number,
-													      category_tree_currency (), -1));
-	if ( !category -> category_nb_transactions ) /* Cope with float errors */
-	    category -> category_balance = null_real;
-    }
+    counter -> counted = FALSE;
+    amount = gsb_data_transaction_get_counted_amount_value ( &counter -> amount, category_tree_currency () );
 
-    if ( sub_category )
+    /* the category or the sub-category can have been removed since */
+    category = gsb_data_category_get_structure ( counter -> category_number );
+    if ( !category )
+        return;
+
+    if ( counter -> sub_category_number )
     {
-	sub_category -> sub_category_nb_transactions --;
-	sub_category -> sub_category_balance = gsb_real_sub ( sub_category -> sub_category_balance,
-							      gsb_data_transaction_get_adjusted_amount_for_currency ( transaction_number,
-														      category_tree_currency (), -1));
-	if ( !sub_category -> sub_category_nb_transactions ) /* Cope with float errors */
-	    sub_category -> sub_category_balance = null_real;
+        sub_category = gsb_data_category_get_sub_category_structure ( counter -> category_number,
+                        counter -> sub_category_number );
+        if ( sub_category )
+        {
+            sub_category -> sub_category_nb_transactions --;
+            sub_category -> sub_category_balance = gsb_real_sub ( sub_category -> sub_category_balance,
+                        amount );
+            if ( !sub_category -> sub_category_nb_transactions ) /* Cope with float errors */
+                sub_category -> sub_category_balance = null_real;
+        }
     }
-    else
+    else if ( category != empty_category )
     {
-	if ( category )
-	{
-	    category -> category_nb_direct_transactions --;
-	    category -> category_direct_balance = gsb_real_sub ( category -> category_direct_balance,
-								 gsb_data_transaction_get_adjusted_amount_for_currency ( transaction_number,
-															 category_tree_currency (), -1));
-	}
+        category -> category_nb_direct_transactions --;
+        category -> category_direct_balance = gsb_real_sub ( category -> category_direct_balance,
+                        amount );
     }
+
+    category -> category_nb_transactions --;
+    category -> category_balance = gsb_real_sub ( category -> category_balance, amount );
+    if ( !category -> category_nb_transactions ) /* Cope with float errors */
+        category -> category_balance = null_real;
 }
 
 
@@ -1726,7 +1851,7 @@ gint gsb_data_category_test_create_category ( gint no_category,
         {
             category_number = gsb_data_category_new (name);
             gsb_data_category_set_type ( category_number, category_type );
-            gsb_category_update_combofix ( FALSE );
+            gsb_category_append_to_combofix ( category_number, 0 );
         }
         return category_number;
     }
@@ -1768,8 +1893,8 @@ gboolean gsb_data_category_test_create_sub_category ( gint no_category,
         }
         else
         {
-            gsb_data_category_new_sub_category ( no_category, name );
-            gsb_category_update_combofix ( FALSE );
+            gsb_category_append_to_combofix ( no_category,
+                        gsb_data_category_new_sub_category ( no_category, name ) );
         }
         return TRUE;
     }
@@ -9,6 +9,10 @@
 void 		gsb_data_category_add_transaction_to_category 		(gint transaction_number,
 																 gint category_id,
 																 gint sub_category_id);
+void 		gsb_data_category_add_transaction_to_counters 		(gint transaction_number,
+																 gint category_id,
+																 gint sub_category_id,
+																 GHashTable *batch);
 gboolean 	gsb_data_category_fill_transaction_by_string 		(gint transaction_number,
 																 const gchar *string,
 																 gboolean is_transaction);
@@ -56,6 +60,7 @@ gint 		gsb_data_category_new_sub_category_with_number_and_name 		(gint number,
 gint 		gsb_data_category_new_with_number 					(gint number);
 gboolean 	gsb_data_category_remove 							(gint no_category);
 void 		gsb_data_category_remove_transaction_from_category 	(gint transaction_number);
+void 		gsb_data_category_reset_counters 					(void);
 void		gsb_data_category_set_category_from_string 			(gint transaction_number,
 																 const gchar *string,
 																 gboolean is_transaction);
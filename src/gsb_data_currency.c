@@ -34,6 +34,7 @@
 /*START_INCLUDE*/
 #include "gsb_data_currency.h"
 #include "dialog.h"
+#include "gsb_data_transaction.h"
 #include "grisbi_win.h"
 #include "gsb_file.h"
 #include "structures.h"
@@ -764,6 +765,9 @@ gboolean gsb_data_currency_set_floating_point ( gint currency_number,
 
     currency -> currency_floating_point = floating_point;
 
+    /* the amounts of the counters are rounded with the floating point */
+    gsb_data_transaction_invalidate_counters ();
+
     return TRUE;
 }
 
@@ -32,6 +32,7 @@
 
 /*START_INCLUDE*/
 #include "gsb_data_currency_link.h"
+#include "gsb_data_transaction.h"
 #include "utils_dates.h"
 #include "dialog.h"
 #include "gsb_real.h"
@@ -274,6 +275,9 @@ gboolean gsb_data_currency_link_remove ( gint currency_link_number )
 
     _g_data_currency_link_free ( currency_link );
 
+    /* the amounts converted by that link must be counted again */
+    gsb_data_transaction_invalidate_counters ();
+
     return TRUE;
 }
 
@@ -345,6 +349,7 @@ gboolean gsb_data_currency_link_set_first_currency ( gint currency_link_number,
 
     currency_link -> first_currency = first_currency;
     gsb_data_currency_link_check_for_invalid (currency_link_number);
+    gsb_data_transaction_invalidate_counters ();
 
     return TRUE;
 }
@@ -391,6 +396,7 @@ gboolean gsb_data_currency_link_set_second_currency ( gint currency_link_number,
 
     currency_link -> second_currency = second_currency;
     gsb_data_currency_link_check_for_invalid (currency_link_number);
+    gsb_data_transaction_invalidate_counters ();
 
     return TRUE;
 }
@@ -434,6 +440,7 @@ gboolean gsb_data_currency_link_set_change_rate ( gint currency_link_number,
 	return FALSE;
 
     currency_link -> change_rate = change_rate;
+    gsb_data_transaction_invalidate_counters ();
 
     return TRUE;
 }
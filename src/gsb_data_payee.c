@@ -67,6 +67,19 @@ struct _PayeeStruct
     GsbReal		payee_balance;
 };
 
+/**
+ * \struct
+ * what a transaction has added to the counters of the payees
+ */
+typedef struct _PayeeCounterStruct	PayeeCounterStruct;
+
+struct _PayeeCounterStruct
+{
+    gint		payee_number;		/* 0 for the blank payee */
+    gboolean	counted;
+    TransactionCountedAmount	amount;
+};
+
 /*START_STATIC*/
 /** contains the g_slist of PayeeStruct */
 static GSList *payee_list = NULL;
@@ -77,6 +90,12 @@ static PayeeStruct *payee_buffer = NULL;
 /** a pointer to a "blank" payee structure, used in the list of payee
  * to group the transactions without payee */
 static PayeeStruct *empty_payee = NULL;
+
+/** the payees by number, built at the first use */
+static GHashTable *payee_index = NULL;
+
+/** what the transactions have added to the counters, indexed by transaction number */
+static GArray *payee_counters = NULL;
 /*END_STATIC*/
 
 /*START_EXTERN*/
@@ -204,32 +223,109 @@ static gint gsb_data_payee_max_number (void)
 }
 
 /**
- * reset the counters of the payees
+ * return the payees by number, the index is built at the first call
  *
  * \param
  *
- * \return
+ * \return the index
  **/
-static void gsb_data_payee_reset_counters (void)
+static GHashTable *gsb_data_payee_get_index (void)
 {
-    GSList *list_tmp;
+	GSList *tmp_list;
 
-    list_tmp = payee_list;
-    while (list_tmp)
-    {
+	if (payee_index)
+		return payee_index;
+
+	payee_index = g_hash_table_new (g_direct_hash, g_direct_equal);
+	tmp_list = payee_list;
+	while (tmp_list)
+	{
 		PayeeStruct *payee;
 
-		payee = list_tmp->data;
-		payee->payee_balance = null_real;
-		payee->payee_nb_transactions = 0;
+		payee = tmp_list->data;
+		g_hash_table_insert (payee_index, GINT_TO_POINTER (payee->payee_number), payee);
+		tmp_list = tmp_list->next;
+	}
 
-		list_tmp = list_tmp->next;
-    }
+	return payee_index;
+}
 
-    /* reset the blank payee counters */
+/**
+ * return what the transaction has added to the counters
+ *
+ * \param transaction_number
+ * \param create TRUE to grow the array if necessary
+ *
+ * \return the structure or NULL
+ **/
+static PayeeCounterStruct *gsb_data_payee_get_counter (gint transaction_number,
+													   gboolean create)
+{
+	if (transaction_number <= 0)
+		return NULL;
 
-    empty_payee->payee_balance = null_real;
-    empty_payee->payee_nb_transactions = 0;
+	if (!payee_counters)
+	{
+		if (!create)
+			return NULL;
+		payee_counters = g_array_new (FALSE, TRUE, sizeof (PayeeCounterStruct));
+	}
+
+	if ((guint) transaction_number >= payee_counters->len)
+	{
+		if (!create)
+			return NULL;
+		g_array_set_size (payee_counters, transaction_number + 1);
+	}
+
+	return &g_array_index (payee_counters, PayeeCounterStruct, transaction_number);
+}
+
+/**
+ * return the payee which counts the transaction in the counters
+ * if the transaction has no payee, return the blank payee
+ *
+ * \param transaction_number the transaction we want to work with
+ *
+ * \return the payee or NULL if the transaction is not counted (child of split or contra transaction)
+ **/
+static PayeeStruct *gsb_data_payee_get_counters_structure (gint transaction_number)
+{
+    PayeeStruct *payee;
+	gint contra_number;
+
+	/* if the transaction is a split transaction or a contra transaction don't take it */
+	if (gsb_data_transaction_get_mother_transaction_number (transaction_number))
+	{
+		return NULL;
+	}
+	else if ((contra_number = gsb_data_transaction_get_contra_transaction_number (transaction_number)) > 0)
+	{
+		gint tmp_number;
+
+		tmp_number = gsb_data_transaction_get_contra_transaction_number (contra_number);
+		if (tmp_number > contra_number)
+			return NULL;
+	}
+
+	/* if no payee in that transaction and it's neither a split transaction, we work with empty_payee */
+    payee = gsb_data_payee_get_structure (gsb_data_transaction_get_payee_number (transaction_number));
+
+    /* should not happen, this is if the transaction has a payee which doesn't exists
+     * we show a debug warning and get without payee */
+    if (!payee)
+    {
+        gchar *tmpstr;
+
+        tmpstr = g_strdup_printf ("The transaction %d has a payee %d but it doesn't exist.",
+								  transaction_number,
+								  gsb_data_transaction_get_payee_number (transaction_number));
+        warning_debug (tmpstr);
+        g_free (tmpstr);
+        payee = empty_payee;
+    }
+
+	return payee;
 }
 
 /******************************************************************************/
@@ -256,6 +352,14 @@ gboolean gsb_data_payee_init_variables (gboolean cleanup)
 		_gsb_data_payee_free (payee);
     }
     g_slist_free (payee_list);
+	if (payee_index)
+	{
+		g_hash_table_destroy (payee_index);
+		payee_index = NULL;
+	}
+	if (payee_counters)
+		g_array_set_size (payee_counters, 0);
+
 	if (cleanup)
 	{
 		payee_list = NULL;
@@ -283,7 +387,7 @@ gboolean gsb_data_payee_init_variables (gboolean cleanup)
  **/
 gpointer gsb_data_payee_get_structure (gint no_payee)
 {
-    GSList *tmp;
+    PayeeStruct *payee;
 
     if (!no_payee)
 		return empty_payee;
@@ -292,21 +396,11 @@ gpointer gsb_data_payee_get_structure (gint no_payee)
     if (payee_buffer && payee_buffer->payee_number == no_payee)
 		return payee_buffer;
 
-    tmp = payee_list;
-    while (tmp)
-    {
-		PayeeStruct *payee;
-
-		payee = tmp->data;
-		if (payee->payee_number == no_payee)
-		{
-			payee_buffer = payee;
-			return payee;
-		}
+	payee = g_hash_table_lookup (gsb_data_payee_get_index (), GINT_TO_POINTER (no_payee));
+	if (payee)
+		payee_buffer = payee;
 
-		tmp = tmp->next;
-    }
-    return NULL;
+    return payee;
 }
 
 /**
@@ -383,6 +477,8 @@ gint gsb_data_payee_new (const gchar *name)
         payee->payee_name = NULL;
 
     payee_list = g_slist_append (payee_list, payee);
+	if (payee_index)
+		g_hash_table_insert (payee_index, GINT_TO_POINTER (payee->payee_number), payee);
 
     return payee->payee_number;
 }
@@ -411,6 +507,8 @@ gboolean gsb_data_payee_remove (gint no_payee)
         gtk_combofix_remove_text (GTK_COMBOFIX (combofix), payee->payee_name);
 
     payee_list = g_slist_remove (payee_list, payee);
+	if (payee_index)
+		g_hash_table_remove (payee_index, GINT_TO_POINTER (no_payee));
     _gsb_data_payee_free (payee);
 
     return TRUE;
@@ -436,6 +534,11 @@ gint gsb_data_payee_set_new_number (gint no_payee,
     if (!payee)
 		return 0;
 
+	if (payee_index)
+	{
+		g_hash_table_remove (payee_index, GINT_TO_POINTER (no_payee));
+		g_hash_table_insert (payee_index, GINT_TO_POINTER (new_no_payee), payee);
+	}
     payee->payee_number = new_no_payee;
     return new_no_payee;
 }
@@ -730,90 +833,107 @@ GsbReal gsb_data_payee_get_balance (gint no_payee)
 }
 
 /**
- * update the counters of the payees
+ * reset the counters of the payees
  *
  * \param
  *
  * \return
  **/
-void gsb_data_payee_update_counters (void)
+void gsb_data_payee_reset_counters (void)
 {
-    GSList *list_tmp_transactions;
-	GrisbiWinEtat *w_etat;
-
-	w_etat = grisbi_win_get_w_etat ();
-	gsb_data_payee_reset_counters ();
-
-    if (w_etat->metatree_add_archive_in_totals)
-        list_tmp_transactions = gsb_data_transaction_get_complete_transactions_list ();
-    else
-        list_tmp_transactions = gsb_data_transaction_get_transactions_list ();
+    GSList *list_tmp;
 
-    while (list_tmp_transactions)
+    list_tmp = payee_list;
+    while (list_tmp)
     {
-		gint transaction_number_tmp;
+		PayeeStruct *payee;
 
-		transaction_number_tmp = gsb_data_transaction_get_transaction_number (list_tmp_transactions->data);
-		gsb_data_payee_add_transaction_to_payee (transaction_number_tmp);
+		payee = list_tmp->data;
+		payee->payee_balance = null_real;
+		payee->payee_nb_transactions = 0;
 
-		list_tmp_transactions = list_tmp_transactions->next;
+		list_tmp = list_tmp->next;
     }
+
+    /* reset the blank payee counters */
+
+    empty_payee->payee_balance = null_real;
+    empty_payee->payee_nb_transactions = 0;
+
+	if (payee_counters)
+		g_array_set_size (payee_counters, 0);
+}
+
+/**
+ * update the counters of the payees
+ * the payees, the categories and the budgets are counted together,
+ * and only the transactions modified since the last time are counted again
+ *
+ * \param
+ *
+ * \return
+ **/
+void gsb_data_payee_update_counters (void)
+{
+	gsb_data_transaction_update_counters ();
 }
 
 /**
  * add the given transaction to its payee in the counters
  * if the transaction has no payee, add it to the blank payee
+ * if the transaction was already counted, it is removed before from its previous payee
  *
  * \param transaction_number the transaction we want to work with
+ * \param batch a batch of balances to sum the amount later, NULL to add it now
  *
  * \return
  **/
-void gsb_data_payee_add_transaction_to_payee (gint transaction_number)
+void gsb_data_payee_add_transaction_to_counters (gint transaction_number,
+												 GHashTable *batch)
 {
+	PayeeCounterStruct *counter;
     PayeeStruct *payee;
-	gint contra_number;
-
-	/* if the transaction is a split transaction or a contra transaction don't take it */
-	if (gsb_data_transaction_get_mother_transaction_number (transaction_number))
-	{
-		return;
-	}
-	else if ((contra_number = gsb_data_transaction_get_contra_transaction_number (transaction_number)) > 0)
-	{
-		gint tmp_number;
 
-		tmp_number = gsb_data_transaction_get_contra_transaction_number (contra_number);
-		if (tmp_number > contra_number)
-			return;
-	}
+	gsb_data_payee_remove_transaction_from_payee (transaction_number);
 
-	/* if no payee in that transaction and it's neither a split transaction, we work with empty_payee */
-    payee = gsb_data_payee_get_structure (gsb_data_transaction_get_payee_number (transaction_number));
+	if (!gsb_data_transaction_is_in_counters (transaction_number))
+		return;
 
-    /* should not happen, this is if the transaction has a payee which doesn't exists
-     * we show a debug warning and get without payee */
-    if (!payee)
-    {
-        gchar *tmpstr;
+	payee = gsb_data_payee_get_counters_structure (transaction_number);
+	if (!payee)
+		return;
 
-        tmpstr = g_strdup_printf ("The transaction %d has a payee %d but it doesn't exist.",
-								  transaction_number,
-								  gsb_data_transaction_get_payee_number (transaction_number));
-        warning_debug (tmpstr);
-        g_free (tmpstr);
-        payee = empty_payee;
-    }
+	counter = gsb_data_payee_get_counter (transaction_number, TRUE);
+	counter->payee_number = payee->payee_number;
+	counter->counted = TRUE;
+	gsb_data_transaction_get_counted_amount (transaction_number, payee_tree_currency (), &counter->amount);
 
     payee->payee_nb_transactions ++;
-	payee->payee_balance = gsb_real_add (payee->payee_balance,
-										 gsb_data_transaction_get_adjusted_amount_for_currency
-										 (transaction_number, payee_tree_currency (),
-										  -1));
+	if (batch)
+		gsb_data_transaction_balances_batch_append (batch, &payee->payee_balance, transaction_number);
+	else
+		payee->payee_balance = gsb_real_add (payee->payee_balance,
+											 gsb_data_transaction_get_counted_amount_value (&counter->amount,
+																							payee_tree_currency ()));
+}
+
+/**
+ * add the given transaction to its payee in the counters
+ * if the transaction has no payee, add it to the blank payee
+ *
+ * \param transaction_number the transaction we want to work with
+ *
+ * \return
+ **/
+void gsb_data_payee_add_transaction_to_payee (gint transaction_number)
+{
+	gsb_data_payee_add_transaction_to_counters (transaction_number, NULL);
 }
 
 /**
- * remove the given transaction to its payee in the counters
- * if the transaction has no payee, remove it to the blank payee
+ * remove the given transaction from the counters
+ * the transaction is removed from the payee it was added to,
+ * even if its payee or its amount have been changed since
  *
  * \param transaction_number the transaction we want to work with
  *
@@ -821,31 +941,27 @@ void gsb_data_payee_add_transaction_to_payee (gint transaction_number)
  **/
 void gsb_data_payee_remove_transaction_from_payee (gint transaction_number)
 {
+	PayeeCounterStruct *counter;
     PayeeStruct *payee;
 
-    payee = gsb_data_payee_get_structure (gsb_data_transaction_get_payee_number (transaction_number));
+	counter = gsb_data_payee_get_counter (transaction_number, FALSE);
+	if (!counter || !counter->counted)
+		return;
 
-    /* if no payee in that transaction, and it's neither a split, neither a transfer,
-     * we work with empty_payee */
+	counter->counted = FALSE;
 
-    if (!payee
-		&& !gsb_data_transaction_get_split_of_transaction (transaction_number)
-		&& gsb_data_transaction_get_contra_transaction_number (transaction_number) == 0)
-	{
-        payee = empty_payee;
-	}
+	/* the payee can have been removed since */
+	payee = gsb_data_payee_get_structure (counter->payee_number);
+	if (!payee)
+		return;
 
-    if (payee)
-    {
-        payee->payee_nb_transactions --;
-        payee->payee_balance = gsb_real_sub (payee->payee_balance,
-											 gsb_data_transaction_get_adjusted_amount_for_currency (transaction_number,
-																									payee_tree_currency (),
-																									-1));
-
-        if (!payee->payee_nb_transactions) /* Cope with float errors */
-            payee->payee_balance = null_real;
-    }
+	payee->payee_nb_transactions --;
+	payee->payee_balance = gsb_real_sub (payee->payee_balance,
+										 gsb_data_transaction_get_counted_amount_value (&counter->amount,
+																						payee_tree_currency ()));
+
+	if (!payee->payee_nb_transactions) /* Cope with float errors */
+		payee->payee_balance = null_real;
 }
 
 /**
@@ -8,6 +8,8 @@
 
 
 /* START_DECLARATION */
+void 			gsb_data_payee_add_transaction_to_counters 		(gint transaction_number,
+																 GHashTable *batch);
 void 			gsb_data_payee_add_transaction_to_payee 		(gint transaction_number);
 void 			gsb_data_payee_free_name_and_report_list 		(GSList *liste);
 GsbReal			gsb_data_payee_get_balance 						(gint no_payee);
@@ -34,6 +36,7 @@ gint 			gsb_data_payee_new 								(const gchar *name);
 gboolean 		gsb_data_payee_remove 							(gint no_payee);
 void 			gsb_data_payee_remove_transaction_from_payee 	(gint transaction_number);
 gint 			gsb_data_payee_remove_unused 					(void);
+void 			gsb_data_payee_reset_counters 					(void);
 gboolean 		gsb_data_payee_set_description 					(gint no_payee,
 																 const gchar *description);
 gboolean		gsb_data_payee_set_ignore_case 					(gint no_payee,
@@ -63,9 +63,83 @@ static ScheduledStruct *scheduled_buffer[2];
 /** set the current buffer used */
 static gint current_scheduled_buffer;
 
+/** the scheduleds without mother sorted by date, to find quickly the due ones */
+static GSequence *scheduled_due_index = NULL;
+
 /******************************************************************************/
 /* Private Methods                                                            */
 /******************************************************************************/
+/**
+ * GCompareDataFunc of the index of the due dates : by date then by number
+ *
+ * \param a
+ * \param b
+ * \param data	not used
+ *
+ * \return
+ **/
+static gint gsb_data_scheduled_due_index_compare (gconstpointer a,
+												  gconstpointer b,
+												  gpointer data)
+{
+	const ScheduledStruct *scheduled_a = a;
+	const ScheduledStruct *scheduled_b = b;
+	guint32 julian_a;
+	guint32 julian_b;
+
+	julian_a = g_date_get_julian (scheduled_a->date);
+	julian_b = g_date_get_julian (scheduled_b->date);
+	if (julian_a != julian_b)
+		return julian_a < julian_b ? -1 : 1;
+
+	return scheduled_a->scheduled_number - scheduled_b->scheduled_number;
+}
+
+/**
+ * remove the scheduled from the index of the due dates
+ *
+ * \param scheduled
+ *
+ * \return
+ **/
+static void gsb_data_scheduled_due_index_remove (ScheduledStruct *scheduled)
+{
+	if (!scheduled->due_iter)
+		return;
+
+	g_sequence_remove (scheduled->due_iter);
+	scheduled->due_iter = NULL;
+}
+
+/**
+ * put the scheduled at its place in the index of the due dates,
+ * must be called each time its date or its mother change.
+ * the white lines, the children of split and the scheduleds without
+ * date are not in the index
+ *
+ * \param scheduled
+ *
+ * \return
+ **/
+static void gsb_data_scheduled_due_index_update (ScheduledStruct *scheduled)
+{
+	gsb_data_scheduled_due_index_remove (scheduled);
+
+	if (scheduled->scheduled_number <= 0
+		|| scheduled->mother_scheduled_number
+		|| !scheduled->date
+		|| !g_date_valid (scheduled->date))
+		return;
+
+	if (!scheduled_due_index)
+		scheduled_due_index = g_sequence_new (NULL);
+
+	scheduled->due_iter = g_sequence_insert_sorted (scheduled_due_index,
+													scheduled,
+													gsb_data_scheduled_due_index_compare,
+													NULL);
+}
+
 /**
  * This internal function is called to free memory used by a ScheduledStruct structure.
  *
@@ -78,6 +152,8 @@ static void _gsb_data_scheduled_free (ScheduledStruct *scheduled)
     if (!scheduled)
         return;
 
+    gsb_data_scheduled_due_index_remove (scheduled);
+
     g_free (scheduled->notes);
     g_free (scheduled->method_of_payment_content);
 
@@ -117,6 +193,12 @@ static void gsb_data_scheduled_delete_all_scheduled (void)
         g_slist_free (scheduled_list);
         scheduled_list = NULL;
     }
+
+    if (scheduled_due_index)
+    {
+        g_sequence_free (scheduled_due_index);
+        scheduled_due_index = NULL;
+    }
 }
 
 /**
@@ -392,6 +474,41 @@ GDate *gsb_data_scheduled_get_date (gint scheduled_number)
     return scheduled->date;
 }
 
+/**
+ * return the scheduleds due at or before a date, ie the scheduleds without
+ * mother which date is <= limit_date. Only the due scheduleds are visited.
+ * the list should be freed
+ *
+ * \param limit_date
+ *
+ * \return a GSList of the numbers of the scheduleds, sorted by date
+ **/
+GSList *gsb_data_scheduled_get_due_list (const GDate *limit_date)
+{
+    GSequenceIter *iter;
+    GSList *due_list = NULL;
+    guint32 limit_julian;
+
+    if (!scheduled_due_index || !limit_date || !g_date_valid (limit_date))
+		return NULL;
+
+    limit_julian = g_date_get_julian (limit_date);
+    iter = g_sequence_get_begin_iter (scheduled_due_index);
+    while (!g_sequence_iter_is_end (iter))
+    {
+		ScheduledStruct *scheduled;
+
+		scheduled = g_sequence_get (iter);
+		if (g_date_get_julian (scheduled->date) > limit_julian)
+			break;
+
+		due_list = g_slist_prepend (due_list, GINT_TO_POINTER (scheduled->scheduled_number));
+		iter = g_sequence_iter_next (iter);
+    }
+
+    return g_slist_reverse (due_list);
+}
+
 /**
  * set the GDate of the scheduled
  * if the scheduled has some children, they change too
@@ -414,6 +531,7 @@ gboolean gsb_data_scheduled_set_date (gint scheduled_number,
     if (scheduled->date)
 		g_date_free (scheduled->date);
     scheduled->date = gsb_date_copy (date);
+    gsb_data_scheduled_due_index_update (scheduled);
 
     /* if the scheduled is a split, change all the children */
     if (scheduled->split_of_scheduled)
@@ -431,6 +549,7 @@ gboolean gsb_data_scheduled_set_date (gint scheduled_number,
 			if (scheduled->date)
 			g_date_free (scheduled->date);
 			scheduled->date = gsb_date_copy (date);
+			gsb_data_scheduled_due_index_update (scheduled);
 
 			tmp_list = tmp_list->next;
 		}
@@ -1162,6 +1281,7 @@ gboolean gsb_data_scheduled_set_mother_scheduled_number (gint scheduled_number,
 		return FALSE;
 
     scheduled->mother_scheduled_number = mother_scheduled_number;
+    gsb_data_scheduled_due_index_update (scheduled);
 
     return TRUE;
 }
@@ -1702,9 +1822,11 @@ gboolean gsb_data_scheduled_copy_scheduled (gint source_scheduled_number,
     if (!source_scheduled || !target_scheduled)
         return FALSE;
 
+    gsb_data_scheduled_due_index_remove (target_scheduled);
     memcpy (target_scheduled, source_scheduled, sizeof (ScheduledStruct));
 
     target_scheduled->scheduled_number = target_scheduled_number;
+    target_scheduled->due_iter = NULL;
 
     /* make a new copy of all the pointers */
     if (target_scheduled->notes)
@@ -1718,6 +1840,9 @@ gboolean gsb_data_scheduled_copy_scheduled (gint source_scheduled_number,
 
     if (target_scheduled->method_of_payment_content)
         target_scheduled->method_of_payment_content = my_strdup (source_scheduled->method_of_payment_content);
+
+    gsb_data_scheduled_due_index_update (target_scheduled);
+
     return TRUE;
 }
 
@@ -45,6 +45,9 @@ struct _ScheduledStruct
     gint 		user_interval;					/* <  0=days, 1=monthes, 2=years */
     gint 		user_entry;
     GDate *		limit_date;
+
+    /** @name place in the index of the due dates, NULL if not indexed */
+    GSequenceIter *	due_iter;
 };
 
 /* START_DECLARATION */
@@ -65,6 +68,7 @@ gint 		gsb_data_scheduled_get_contra_method_of_payment_number 		(gint scheduled_
 gint 		gsb_data_scheduled_get_currency_floating_point 				(gint scheduled_number);
 gint 		gsb_data_scheduled_get_currency_number 						(gint scheduled_number);
 GDate *		gsb_data_scheduled_get_date 								(gint scheduled_number);
+GSList *	gsb_data_scheduled_get_due_list 							(const GDate *limit_date);
 gint 		gsb_data_scheduled_get_financial_year_number 				(gint scheduled_number);
 gint 		gsb_data_scheduled_get_fixed_date 							(gint scheduled_number);
 gint 		gsb_data_scheduled_get_frequency 							(gint scheduled_number);
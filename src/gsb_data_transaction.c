@@ -34,6 +34,7 @@
 /*START_INCLUDE*/
 #include "gsb_data_transaction.h"
 #include "bet_data.h"
+#include "bet_hist_cube.h"
 #include "classement_echeances.h"
 #include "dialog.h"
 #include "grisbi_win.h"
@@ -46,9 +47,14 @@
 #include "gsb_data_payee.h"
 #include "gsb_data_payment.h"
 #include "gsb_file.h"
+#include "gsb_file_archive_segment.h"
 #include "gsb_real.h"
+#include "gsb_search_index.h"
 #include "gsb_transactions_list.h"
 #include "gsb_transactions_list_sort.h"
+#include "meta_budgetary.h"
+#include "meta_categories.h"
+#include "meta_payee.h"
 #include "structures.h"
 #include "utils_dates.h"
 #include "utils_str.h"
@@ -75,14 +81,182 @@ static TransactionStruct *transaction_buffer[2];
 
 /** set the current buffer used */
 static gint current_transaction_buffer;
+
+/** index of the non-child transactions by payee, built at the first use
+ * key : the payee number, value : a PayeeLastIndex structure */
+static GHashTable *payee_last_index = NULL;
+
+/** the counters of the payees, categories and budgets are up to date
+ * for the transactions which are not in counters_pending */
+static gboolean counters_valid = FALSE;
+
+/** the transactions modified since the last update of the counters
+ * key : the transaction number */
+static GHashTable *counters_pending = NULL;
+
+/** the settings used by the last complete count */
+static gboolean counters_with_archives;
+static gint counters_payee_currency;
+static gint counters_category_currency;
+static gint counters_budget_currency;
+
+/** the archived transactions loaded into transactions_list
+ * key : the transaction number */
+static GHashTable *loaded_archived_transactions = NULL;
+
+/** incremented each time a transaction is created, deleted, or modified
+ * in a way which changes its place in the metatrees */
+static guint modifications_serial = 0;
+
+/** the lists of transactions set aside while the archive segment is loaded */
+static GSList *transactions_list_aside = NULL;
+static GSList *complete_transactions_list_aside = NULL;
+static GSList *active_transactions_list_aside = NULL;
 /*END_STATIC*/
 
+/** the transactions of a payee sorted by number, for all the accounts and per account,
+ * in GSequence so a transaction is inserted or removed in O(log n) */
+typedef struct _PayeeLastIndex	PayeeLastIndex;
+struct _PayeeLastIndex
+{
+	GSequence *		transactions;
+	GHashTable *	accounts;		/* key : the account number, value : a GSequence */
+};
+
+/** the transactions of a batch summation with the same currency and the same exponent */
+typedef struct _TransactionSumGroup	TransactionSumGroup;
+struct _TransactionSumGroup
+{
+	gint				currency_number;
+	gint				exponent;
+	gint				link_number;	/* 0 for the returned currency, -1 to convert the amounts one by one */
+	GArray *			mantissas;
+	gint64				max_abs;
+	GsbRealAccumulator	fees;
+};
+
 /*START_EXTERN*/
 /*END_EXTERN*/
 
 /******************************************************************************/
 /* Private functions                                                          */
 /******************************************************************************/
+/**
+ * the transaction will be counted again at the next update of the counters
+ * of the payees, categories and budgets
+ *
+ * \param transaction
+ *
+ * \return
+ **/
+static void gsb_data_transaction_counters_mark (TransactionStruct *transaction)
+{
+	if (transaction->transaction_number <= 0)
+		return;
+
+	bet_hist_cube_mark_transaction (transaction->transaction_number);
+	gsb_search_index_mark_transaction (transaction->transaction_number);
+	modifications_serial++;
+	if (!counters_valid)
+		return;
+
+	if (!counters_pending)
+		counters_pending = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+	g_hash_table_add (counters_pending, GINT_TO_POINTER (transaction->transaction_number));
+}
+
+/**
+ * the transaction is deleted, remove it from the sets
+ * used by the counters
+ *
+ * \param transaction_number
+ *
+ * \return
+ **/
+static void gsb_data_transaction_counters_forget (gint transaction_number)
+{
+	bet_hist_cube_mark_transaction (transaction_number);
+	gsb_search_index_mark_transaction (transaction_number);
+	modifications_serial++;
+	if (counters_pending)
+		g_hash_table_remove (counters_pending, GINT_TO_POINTER (transaction_number));
+	if (loaded_archived_transactions)
+		g_hash_table_remove (loaded_archived_transactions, GINT_TO_POINTER (transaction_number));
+}
+
+/**
+ * count all the transactions in the payees, categories and budgets
+ * in one pass, the balances are summed by currency in one time at the end
+ * with gsb_data_transaction_get_adjusted_amounts_sum (), so the amounts
+ * are not converted one by one
+ *
+ * \param
+ *
+ * \return
+ **/
+static void gsb_data_transaction_counters_count_all (void)
+{
+	GHashTable *payee_batch;
+	GHashTable *category_batch;
+	GHashTable *budget_batch;
+	GSList *tmp_list;
+	GrisbiWinEtat *w_etat;
+
+	w_etat = grisbi_win_get_w_etat ();
+
+	counters_with_archives = w_etat->metatree_add_archive_in_totals;
+	counters_payee_currency = payee_tree_currency ();
+	counters_category_currency = category_tree_currency ();
+	counters_budget_currency = budgetary_line_tree_currency ();
+
+	gsb_data_payee_reset_counters ();
+	gsb_data_category_reset_counters ();
+	gsb_data_budget_reset_counters ();
+
+	if (counters_with_archives)
+	{
+		gsb_file_archive_segment_load ();
+		tmp_list = complete_transactions_list;
+	}
+	else
+		tmp_list = transactions_list;
+
+	payee_batch = gsb_data_transaction_balances_batch_new ();
+	category_batch = gsb_data_transaction_balances_batch_new ();
+	budget_batch = gsb_data_transaction_balances_batch_new ();
+
+	while (tmp_list)
+	{
+		TransactionStruct *transaction;
+		gint transaction_number;
+
+		transaction = tmp_list->data;
+		transaction_number = transaction->transaction_number;
+		gsb_data_transaction_save_transaction_pointer (transaction);
+
+		gsb_data_payee_add_transaction_to_counters (transaction_number, payee_batch);
+		gsb_data_category_add_transaction_to_counters (transaction_number,
+													   transaction->category_number,
+													   transaction->sub_category_number,
+													   category_batch);
+		gsb_data_budget_add_transaction_to_counters (transaction_number,
+													 transaction->budgetary_number,
+													 transaction->sub_budgetary_number,
+													 budget_batch);
+
+		tmp_list = tmp_list->next;
+	}
+
+	gsb_data_transaction_balances_batch_finish (payee_batch, counters_payee_currency, -1);
+	gsb_data_transaction_balances_batch_finish (category_batch, counters_category_currency, -1);
+	gsb_data_transaction_balances_batch_finish (budget_batch, counters_budget_currency, -1);
+
+	if (counters_pending)
+		g_hash_table_remove_all (counters_pending);
+	counters_valid = TRUE;
+}
+
 /**
  * internal function which is called to free the memory used by a TransactionStruct structure.
  *
@@ -96,6 +270,8 @@ static void gsb_data_transaction_free (TransactionStruct *transaction)
 		return;
 
 	gsb_data_account_set_balances_are_dirty (transaction->account_number);
+	gsb_data_transaction_payee_index_remove (transaction);
+	gsb_data_transaction_counters_forget (transaction->transaction_number);
 
 	g_free (transaction->transaction_id);
 	g_free (transaction->notes);
@@ -114,6 +290,245 @@ static void gsb_data_transaction_free (TransactionStruct *transaction)
 	transaction_buffer[1] = NULL;
 }
 
+/**
+ * free a PayeeLastIndex structure
+ *
+ * \param payee_index
+ *
+ * \return
+ **/
+static void gsb_data_transaction_payee_index_free (PayeeLastIndex *payee_index)
+{
+	g_sequence_free (payee_index->transactions);
+	g_hash_table_destroy (payee_index->accounts);
+	g_free (payee_index);
+}
+
+/**
+ * compare two transactions of the payee index by number
+ *
+ * \param a
+ * \param b
+ * \param data unused
+ *
+ * \return -1, 0 or 1 as a <=> b
+ **/
+static gint gsb_data_transaction_payee_index_compare (gconstpointer a,
+													  gconstpointer b,
+													  gpointer data)
+{
+	gint number_a;
+	gint number_b;
+
+	number_a = ((const TransactionStruct *) a)->transaction_number;
+	number_b = ((const TransactionStruct *) b)->transaction_number;
+
+	return (number_a > number_b) - (number_a < number_b);
+}
+
+/**
+ * remove the transaction from a sequence of the payee index
+ *
+ * \param sequence
+ * \param transaction
+ *
+ * \return TRUE if the transaction was in the sequence
+ **/
+static gboolean gsb_data_transaction_payee_index_remove_from_sequence (GSequence *sequence,
+																	   TransactionStruct *transaction)
+{
+	GSequenceIter *iter;
+
+	iter = g_sequence_lookup (sequence, transaction, gsb_data_transaction_payee_index_compare, NULL);
+	if (!iter || g_sequence_get (iter) != transaction)
+		return FALSE;
+
+	g_sequence_remove (iter);
+
+	return TRUE;
+}
+
+/**
+ * add the transaction to the payee index if it is built
+ * the children of split and the white lines are not indexed
+ *
+ * \param transaction
+ *
+ * \return
+ **/
+static void gsb_data_transaction_payee_index_add (TransactionStruct *transaction)
+{
+	PayeeLastIndex *payee_index;
+	GSequence *account_sequence;
+
+	if (!payee_last_index
+		|| transaction->transaction_number <= 0
+		|| transaction->mother_transaction_number)
+		return;
+
+	payee_index = g_hash_table_lookup (payee_last_index, GINT_TO_POINTER (transaction->payee_number));
+	if (!payee_index)
+	{
+		payee_index = g_malloc0 (sizeof (PayeeLastIndex));
+		payee_index->transactions = g_sequence_new (NULL);
+		payee_index->accounts = g_hash_table_new_full (g_direct_hash,
+													   g_direct_equal,
+													   NULL,
+													   (GDestroyNotify) g_sequence_free);
+		g_hash_table_insert (payee_last_index, GINT_TO_POINTER (transaction->payee_number), payee_index);
+	}
+
+	account_sequence = g_hash_table_lookup (payee_index->accounts, GINT_TO_POINTER (transaction->account_number));
+	if (!account_sequence)
+	{
+		account_sequence = g_sequence_new (NULL);
+		g_hash_table_insert (payee_index->accounts, GINT_TO_POINTER (transaction->account_number), account_sequence);
+	}
+
+	g_sequence_insert_sorted (payee_index->transactions, transaction, gsb_data_transaction_payee_index_compare, NULL);
+	g_sequence_insert_sorted (account_sequence, transaction, gsb_data_transaction_payee_index_compare, NULL);
+}
+
+/**
+ * remove the transaction from the payee index if it is built
+ * must be called before changing the payee, the account or the mother of the transaction
+ *
+ * \param transaction
+ *
+ * \return
+ **/
+static void gsb_data_transaction_payee_index_remove (TransactionStruct *transaction)
+{
+	PayeeLastIndex *payee_index;
+	GSequence *account_sequence;
+
+	if (!payee_last_index)
+		return;
+
+	payee_index = g_hash_table_lookup (payee_last_index, GINT_TO_POINTER (transaction->payee_number));
+	if (!payee_index)
+		return;
+
+	if (!gsb_data_transaction_payee_index_remove_from_sequence (payee_index->transactions, transaction))
+		return;
+
+	account_sequence = g_hash_table_lookup (payee_index->accounts, GINT_TO_POINTER (transaction->account_number));
+	if (account_sequence)
+		gsb_data_transaction_payee_index_remove_from_sequence (account_sequence, transaction);
+}
+
+/**
+ * build the payee index with all the transactions, archived and not archived
+ *
+ * \param
+ *
+ * \return
+ **/
+static void gsb_data_transaction_payee_index_build (void)
+{
+	GSList *tmp_list;
+
+	payee_last_index = g_hash_table_new_full (g_direct_hash,
+											  g_direct_equal,
+											  NULL,
+											  (GDestroyNotify) gsb_data_transaction_payee_index_free);
+
+	tmp_list = complete_transactions_list;
+	while (tmp_list)
+	{
+		gsb_data_transaction_payee_index_add (tmp_list->data);
+		tmp_list = tmp_list->next;
+	}
+}
+
+/**
+ * find or create the group of the batch summation for the currency and the exponent
+ * the pointer is valid until the next call
+ *
+ * \param groups
+ * \param currency_number
+ * \param exponent
+ * \param return_currency_number
+ *
+ * \return the group
+ **/
+static TransactionSumGroup *gsb_data_transaction_get_sum_group (GArray *groups,
+																gint currency_number,
+																gint exponent,
+																gint return_currency_number)
+{
+	TransactionSumGroup new_group;
+	guint i;
+
+	for (i = 0 ; i < groups->len ; i++)
+	{
+		TransactionSumGroup *group;
+
+		group = &g_array_index (groups, TransactionSumGroup, i);
+		if (group->currency_number == currency_number && group->exponent == exponent)
+			return group;
+	}
+
+	new_group.currency_number = currency_number;
+	new_group.exponent = exponent;
+	if (currency_number == return_currency_number)
+		new_group.link_number = 0;
+	else
+	{
+		/* without hard link, the amounts are converted one by one */
+		new_group.link_number = gsb_data_currency_link_search (currency_number, return_currency_number);
+		if (new_group.link_number <= 0)
+			new_group.link_number = -1;
+	}
+	new_group.mantissas = g_array_new (FALSE, FALSE, sizeof (gint64));
+	new_group.max_abs = 0;
+	gsb_real_accumulator_init (&new_group.fees, exponent);
+	g_array_append_val (groups, new_group);
+
+	return &g_array_index (groups, TransactionSumGroup, groups->len - 1);
+}
+
+/**
+ * sum the mantissas of a group, with a simple loop in 64 bits if
+ * there is no overflow possible, with an accumulator else
+ *
+ * \param group
+ *
+ * \return the sum with the exponent of the group
+ **/
+static GsbReal gsb_data_transaction_sum_group_mantissas (TransactionSumGroup *group)
+{
+	const gint64 *mantissas;
+	guint nb_mantissas;
+	guint i;
+
+	mantissas = (const gint64 *) group->mantissas->data;
+	nb_mantissas = group->mantissas->len;
+
+	if (!nb_mantissas)
+		return gsb_real_new (0, group->exponent);
+
+	if (group->max_abs <= G_MAXINT64 / nb_mantissas)
+	{
+		gint64 sum = 0;
+
+		for (i = 0 ; i < nb_mantissas ; i++)
+			sum += mantissas[i];
+
+		return gsb_real_new (sum, group->exponent);
+	}
+	else
+	{
+		GsbRealAccumulator accumulator;
+
+		gsb_real_accumulator_init (&accumulator, group->exponent);
+		for (i = 0 ; i < nb_mantissas ; i++)
+			gsb_real_accumulator_add (&accumulator, gsb_real_new (mantissas[i], group->exponent));
+
+		return gsb_real_accumulator_get_value (&accumulator);
+	}
+}
+
 /**
  * Delete all transactions and free memory used by them
  *
@@ -123,6 +538,28 @@ static void gsb_data_transaction_free (TransactionStruct *transaction)
  **/
 static void gsb_data_transaction_delete_all_transactions (void)
 {
+	if (payee_last_index)
+	{
+		g_hash_table_destroy (payee_last_index);
+		payee_last_index = NULL;
+	}
+
+	/* the counters will be computed again after the loading of the file */
+	counters_valid = FALSE;
+	bet_hist_cube_reset ();
+	gsb_search_index_reset ();
+	modifications_serial++;
+	if (counters_pending)
+	{
+		g_hash_table_destroy (counters_pending);
+		counters_pending = NULL;
+	}
+	if (loaded_archived_transactions)
+	{
+		g_hash_table_destroy (loaded_archived_transactions);
+		loaded_archived_transactions = NULL;
+	}
+
 	if (complete_transactions_list)
 	{
 		GSList* tmp_list = complete_transactions_list;
@@ -298,16 +735,74 @@ GSList *gsb_data_transaction_get_active_transactions_list (void)
  * it's not a copy, so we must not free or change it
  * if we want to change something, use gsb_data_transaction_copy_transactions_list instead
  * THIS IS THE COMPLETE LIST (WITH THE ARCHIVED TRANSACTIONS)
+ * the transactions of the archive segment are loaded before if necessary
  *
  * \param none
  *
  * \return the slist of transactions structures
  **/
 GSList *gsb_data_transaction_get_complete_transactions_list (void)
+{
+	gsb_file_archive_segment_load ();
+
+	return complete_transactions_list;
+}
+
+/**
+ * return a pointer to the g_slist of the transactions in memory
+ * it's not a copy, so we must not free or change it
+ * THIS IS THE COMPLETE LIST WITHOUT THE TRANSACTIONS OF THE ARCHIVE SEGMENT
+ * WHICH ARE NOT LOADED, the archive segment is not loaded here
+ *
+ * \param none
+ *
+ * \return the slist of transactions structures
+ **/
+GSList *gsb_data_transaction_get_loaded_transactions_list (void)
 {
 	return complete_transactions_list;
 }
 
+/**
+ * set aside the lists of transactions before loading the transactions of the
+ * archive segment : they are created in new lists as at the opening
+ *
+ * \param
+ *
+ * \return
+ **/
+void gsb_data_transaction_begin_archived_loading (void)
+{
+	transactions_list_aside = transactions_list;
+	complete_transactions_list_aside = complete_transactions_list;
+	active_transactions_list_aside = active_transactions_list;
+
+	transactions_list = NULL;
+	complete_transactions_list = NULL;
+	active_transactions_list = NULL;
+}
+
+/**
+ * put the transactions of the archive segment just loaded
+ * before the transactions set aside
+ *
+ * \param
+ *
+ * \return
+ **/
+void gsb_data_transaction_end_archived_loading (void)
+{
+	gsb_data_transaction_reverse_lists ();
+
+	transactions_list = g_slist_concat (transactions_list, transactions_list_aside);
+	complete_transactions_list = g_slist_concat (complete_transactions_list, complete_transactions_list_aside);
+	active_transactions_list = g_slist_concat (active_transactions_list, active_transactions_list_aside);
+
+	transactions_list_aside = NULL;
+	complete_transactions_list_aside = NULL;
+	active_transactions_list_aside = NULL;
+}
+
 /**
  * just append the archived transaction given in param
  * into the non archived transactions list
@@ -327,6 +822,11 @@ gboolean gsb_data_transaction_add_archived_to_list (gint transaction_number)
 
 	transactions_list = g_slist_append (transactions_list, transaction);
 
+	if (!loaded_archived_transactions)
+		loaded_archived_transactions = g_hash_table_new (g_direct_hash, g_direct_equal);
+	g_hash_table_add (loaded_archived_transactions, GINT_TO_POINTER (transaction_number));
+	gsb_data_transaction_counters_mark (transaction);
+
 	return TRUE;
 }
 
@@ -371,6 +871,9 @@ gint gsb_data_transaction_get_last_number (void)
 		transactions_list_tmp = transactions_list_tmp->next;
 	}
 
+	/* the numbers of the transactions not loaded are not given again */
+	last_number = MAX (last_number, gsb_file_archive_segment_get_last_number ());
+
 	return last_number;
 }
 
@@ -482,8 +985,12 @@ gboolean gsb_data_transaction_set_account_number (gint transaction_number,
 		return FALSE;
 
 	gsb_data_account_set_balances_are_dirty (transaction->account_number);
+	gsb_data_transaction_payee_index_remove (transaction);
 	transaction->account_number = no_account;
+	gsb_data_transaction_payee_index_add (transaction);
 	gsb_data_account_set_balances_are_dirty (no_account);
+	bet_hist_cube_mark_transaction (transaction_number);
+	gsb_search_index_mark_transaction (transaction_number);
 
 	/* if the transaction is a split, change all the children */
 	if (transaction->split_of_transaction)
@@ -498,6 +1005,8 @@ gboolean gsb_data_transaction_set_account_number (gint transaction_number,
 		{
 			transaction = tmp_list->data;
 			transaction->account_number = no_account;
+			bet_hist_cube_mark_transaction (transaction->transaction_number);
+			gsb_search_index_mark_transaction (transaction->transaction_number);
 
 			tmp_list = tmp_list->next;
 		}
@@ -547,6 +1056,8 @@ gboolean gsb_data_transaction_set_date (gint transaction_number,
 	if (transaction->date)
 		g_date_free (transaction->date);
 	transaction->date = gsb_date_copy (date);
+	bet_hist_cube_mark_transaction (transaction_number);
+	modifications_serial++;
 
 	/* if the transaction is a split, change all the children */
 	if (transaction->split_of_transaction)
@@ -564,6 +1075,7 @@ gboolean gsb_data_transaction_set_date (gint transaction_number,
 			if (transaction->date)
 				g_date_free (transaction->date);
 			transaction->date = gsb_date_copy (date);
+			bet_hist_cube_mark_transaction (transaction->transaction_number);
 
 			/* si l'opération fille est un transfert on regarde si la contre opération est rapprochée
 			 * si elle ne l'est pas on peut mettre à jour la date */
@@ -694,6 +1206,93 @@ GsbReal gsb_data_transaction_get_amount (gint transaction_number)
 	return transaction->transaction_amount;
 }
 
+/**
+ * get the amount of a transaction to keep in the counters of a tree.
+ * the amount is kept in the currency of the transaction when a hard link gives
+ * its conversion, with the rate of the link now : it is converted with that rate
+ * when it is removed from the counters, so the removed value is the added value
+ * even if the link changes in between ; else (exchange rate in the transaction
+ * or no link) it is converted now
+ *
+ * \param transaction_number
+ * \param return_currency_number	the currency of the tree
+ * \param counted_amount			the structure to fill
+ *
+ * \return
+ **/
+void gsb_data_transaction_get_counted_amount (gint transaction_number,
+											  gint return_currency_number,
+											  TransactionCountedAmount *counted_amount)
+{
+	TransactionStruct *transaction;
+	gint link_number = 0;
+
+	transaction = gsb_data_transaction_get_transaction_by_no (transaction_number);
+	if (transaction
+		&& (transaction->currency_number == return_currency_number
+			|| (!transaction->exchange_rate.mantissa
+				&& (link_number = gsb_data_currency_link_search (transaction->currency_number,
+																 return_currency_number)) > 0)))
+	{
+		counted_amount->amount = transaction->transaction_amount;
+		counted_amount->exchange_fees = transaction->exchange_fees;
+		counted_amount->currency_number = transaction->currency_number;
+		if (link_number > 0)
+		{
+			counted_amount->change_rate = gsb_data_currency_link_get_change_rate (link_number);
+			counted_amount->multiply = (gsb_data_currency_link_get_first_currency (link_number)
+										== transaction->currency_number);
+		}
+		else
+		{
+			counted_amount->change_rate = null_real;
+			counted_amount->multiply = FALSE;
+		}
+	}
+	else
+	{
+		counted_amount->amount = gsb_data_transaction_get_adjusted_amount_for_currency (transaction_number,
+																						return_currency_number,
+																						-1);
+		counted_amount->exchange_fees = null_real;
+		counted_amount->currency_number = 0;
+		counted_amount->change_rate = null_real;
+		counted_amount->multiply = FALSE;
+	}
+}
+
+/**
+ * return an amount of the counters in the currency of the tree
+ *
+ * \param counted_amount			filled by gsb_data_transaction_get_counted_amount ()
+ * \param return_currency_number	the currency of the tree
+ *
+ * \return the amount with the exponent of the currency of the tree
+ **/
+GsbReal gsb_data_transaction_get_counted_amount_value (const TransactionCountedAmount *counted_amount,
+													   gint return_currency_number)
+{
+	GsbReal amount;
+
+	amount = counted_amount->amount;
+
+	if (counted_amount->currency_number
+		&& counted_amount->currency_number != return_currency_number)
+	{
+		/* there was a hard link between the transaction currency and the return currency,
+		 * the rate of the link when the amount was counted is used */
+		if (counted_amount->multiply)
+			amount = gsb_real_mul (amount, counted_amount->change_rate);
+		else
+			amount = gsb_real_div (amount, counted_amount->change_rate);
+
+		/* The costs are still deducted from the transaction. */
+		amount = gsb_real_sub (amount, counted_amount->exchange_fees);
+	}
+
+	return gsb_real_adjust_exponent (amount, gsb_data_currency_get_floating_point (return_currency_number));
+}
+
 /**
  * set the amount of the transaction
  *
@@ -714,6 +1313,8 @@ gboolean gsb_data_transaction_set_amount (gint transaction_number,
 	transaction->transaction_amount = amount;
 	gsb_data_account_set_balances_are_dirty (transaction->account_number);
 
+	gsb_data_transaction_counters_mark (transaction);
+
 	return TRUE;
 }
 
@@ -866,6 +1467,195 @@ GsbReal gsb_data_transaction_get_adjusted_amount_for_currency (gint transaction_
 	return gsb_real_adjust_exponent  (amount, return_exponent);
 }
 
+/**
+ * sum the amounts of a batch of transactions, modified to be ok with the currency
+ * given in param. the transactions are grouped by currency and exponent, the mantissas
+ * of a group are summed in one loop and the group is converted only one time,
+ * so the rounding is done one time per group instead of one time per transaction.
+ * the transactions with their own exchange rate and the currencies without hard link
+ * are converted one by one with gsb_data_transaction_get_adjusted_amount_for_currency
+ *
+ * \param transactions				a GPtrArray of transactions pointers, as in the transactions lists
+ * \param return_currency_number 	the currency we want to adjust the amounts
+ * \param return_exponent 			the exponent we want to have for the returned number,
+ *									or -1 for the exponent of the returned currency
+ *
+ * \return the sum of the amounts, error_real if an amount is wrong
+ **/
+GsbReal gsb_data_transaction_get_adjusted_amounts_sum (GPtrArray *transactions,
+													   gint return_currency_number,
+													   gint return_exponent)
+{
+	GArray *groups;
+	TransactionSumGroup *group = NULL;
+	GsbRealAccumulator accumulator;
+	guint i;
+
+	if (return_exponent == -1)
+		return_exponent = gsb_data_currency_get_floating_point (return_currency_number);
+
+	if (!transactions || !transactions->len || !return_currency_number)
+		return gsb_real_adjust_exponent (null_real, return_exponent);
+
+	gsb_real_accumulator_init (&accumulator, return_exponent);
+	groups = g_array_new (FALSE, FALSE, sizeof (TransactionSumGroup));
+
+	/* first pass : split the mantissas by currency and exponent */
+	for (i = 0 ; i < transactions->len ; i++)
+	{
+		TransactionStruct *transaction;
+		gint64 mantissa;
+
+		transaction = g_ptr_array_index (transactions, i);
+		mantissa = transaction->transaction_amount.mantissa;
+
+		if (mantissa == error_real.mantissa)
+		{
+			gsb_real_accumulator_add (&accumulator, error_real);
+			continue;
+		}
+
+		/* the exchange rate is saved in the transaction itself */
+		if (transaction->currency_number != return_currency_number && transaction->exchange_rate.mantissa)
+		{
+			gsb_real_accumulator_add (&accumulator,
+									  gsb_data_transaction_get_adjusted_amount_for_currency
+									  (transaction->transaction_number, return_currency_number, return_exponent));
+			continue;
+		}
+
+		/* usually the transaction is in the group of the previous one */
+		if (!group
+			|| group->currency_number != transaction->currency_number
+			|| group->exponent != transaction->transaction_amount.exponent)
+			group = gsb_data_transaction_get_sum_group (groups,
+														transaction->currency_number,
+														transaction->transaction_amount.exponent,
+														return_currency_number);
+
+		if (group->link_number < 0)
+		{
+			gsb_real_accumulator_add (&accumulator,
+									  gsb_data_transaction_get_adjusted_amount_for_currency
+									  (transaction->transaction_number, return_currency_number, return_exponent));
+			continue;
+		}
+
+		g_array_append_val (group->mantissas, mantissa);
+		if (ABS (mantissa) > group->max_abs)
+			group->max_abs = ABS (mantissa);
+
+		/* The costs are still deducted from the transaction. */
+		if (group->link_number)
+			gsb_real_accumulator_add (&group->fees, transaction->exchange_fees);
+	}
+
+	/* second pass : sum and convert each group */
+	for (i = 0 ; i < groups->len ; i++)
+	{
+		GsbReal sum;
+
+		group = &g_array_index (groups, TransactionSumGroup, i);
+		sum = gsb_data_transaction_sum_group_mantissas (group);
+
+		if (group->link_number > 0)
+		{
+			/* there is a hard link between the transactions currency and the return currency */
+			if (gsb_data_currency_link_get_first_currency (group->link_number) == group->currency_number)
+				sum = gsb_real_mul (sum, gsb_data_currency_link_get_change_rate (group->link_number));
+			else
+				sum = gsb_real_div (sum, gsb_data_currency_link_get_change_rate (group->link_number));
+
+			sum = gsb_real_sub (sum, gsb_real_accumulator_get_value (&group->fees));
+		}
+
+		if (sum.mantissa == error_real.mantissa)
+			gsb_real_accumulator_add (&accumulator, error_real);
+		else
+			gsb_real_accumulator_add (&accumulator, gsb_real_adjust_exponent (sum, return_exponent));
+
+		g_array_free (group->mantissas, TRUE);
+	}
+	g_array_free (groups, TRUE);
+
+	return gsb_real_accumulator_get_value (&accumulator);
+}
+
+/**
+ * add a transaction to a balance of a batch, the balances of the batch
+ * are summed by gsb_data_transaction_balances_batch_finish ()
+ *
+ * \param batch					a batch from gsb_data_transaction_balances_batch_new ()
+ * \param balance				the balance to which the amount of the transaction is added
+ * \param transaction_number
+ *
+ * \return
+ **/
+void gsb_data_transaction_balances_batch_append (GHashTable *batch,
+												 GsbReal *balance,
+												 gint transaction_number)
+{
+	TransactionStruct *transaction;
+	GPtrArray *transactions;
+
+	transaction = gsb_data_transaction_get_transaction_by_no (transaction_number);
+	if (!transaction)
+		return;
+
+	transactions = g_hash_table_lookup (batch, balance);
+	if (!transactions)
+	{
+		transactions = g_ptr_array_new ();
+		g_hash_table_insert (batch, balance, transactions);
+	}
+	g_ptr_array_add (transactions, transaction);
+}
+
+/**
+ * add to each balance of the batch the sum of its transactions,
+ * and free the batch
+ *
+ * \param batch
+ * \param return_currency_number 	the currency of the balances
+ * \param return_exponent 			the exponent of the balances,
+ *									or -1 for the exponent of the returned currency
+ *
+ * \return
+ **/
+void gsb_data_transaction_balances_batch_finish (GHashTable *batch,
+												 gint return_currency_number,
+												 gint return_exponent)
+{
+	GHashTableIter iter;
+	gpointer key;
+	gpointer value;
+
+	g_hash_table_iter_init (&iter, batch);
+	while (g_hash_table_iter_next (&iter, &key, &value))
+	{
+		GsbReal *balance = key;
+
+		*balance = gsb_real_add (*balance,
+								 gsb_data_transaction_get_adjusted_amounts_sum (value,
+																				return_currency_number,
+																				return_exponent));
+	}
+	g_hash_table_destroy (batch);
+}
+
+/**
+ * create a batch of balances to fill with gsb_data_transaction_balances_batch_append ()
+ * and to sum with gsb_data_transaction_balances_batch_finish ()
+ *
+ * \param
+ *
+ * \return a new batch
+ **/
+GHashTable *gsb_data_transaction_balances_batch_new (void)
+{
+	return g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, (GDestroyNotify) g_ptr_array_unref);
+}
+
 /**
  * get the currency_number
  *
@@ -903,6 +1693,7 @@ gboolean gsb_data_transaction_set_currency_number (gint transaction_number,
 		return FALSE;
 
 	transaction->currency_number = no_currency;
+	gsb_data_transaction_counters_mark (transaction);
 
 	/* if the transaction is a split, change all the children */
 	if (transaction->split_of_transaction)
@@ -917,6 +1708,7 @@ gboolean gsb_data_transaction_set_currency_number (gint transaction_number,
 		{
 			transaction = tmp_list->data;
 			transaction->currency_number = no_currency;
+			gsb_data_transaction_counters_mark (transaction);
 
 			tmp_list = tmp_list->next;
 		}
@@ -967,6 +1759,7 @@ gboolean gsb_data_transaction_set_change_between (gint transaction_number,
 		return FALSE;
 
 	transaction->change_between_account_and_transaction = value;
+	gsb_data_transaction_counters_mark (transaction);
 
 	/* if the transaction is a split, change all the children */
 	if (transaction->split_of_transaction)
@@ -981,6 +1774,7 @@ gboolean gsb_data_transaction_set_change_between (gint transaction_number,
 		{
 			transaction = tmp_list->data;
 			transaction->change_between_account_and_transaction = value;
+			gsb_data_transaction_counters_mark (transaction);
 
 			tmp_list = tmp_list->next;
 		}
@@ -1028,6 +1822,7 @@ gboolean gsb_data_transaction_set_exchange_rate (gint transaction_number,
 		return FALSE;
 
 	transaction->exchange_rate = exchange_rate;
+	gsb_data_transaction_counters_mark (transaction);
 
 	/* if the transaction is a split, change all the children */
 	if (transaction->split_of_transaction)
@@ -1042,6 +1837,7 @@ gboolean gsb_data_transaction_set_exchange_rate (gint transaction_number,
 		{
 			transaction = tmp_list->data;
 			transaction->exchange_rate = exchange_rate;
+			gsb_data_transaction_counters_mark (transaction);
 
 			tmp_list = tmp_list->next;
 		}
@@ -1088,6 +1884,7 @@ gboolean gsb_data_transaction_set_exchange_fees (gint transaction_number,
 		return FALSE;
 
 	transaction->exchange_fees = exchange_fees;
+	gsb_data_transaction_counters_mark (transaction);
 
 	/* if the transaction is a split, change all the children */
 	if (transaction->split_of_transaction)
@@ -1102,6 +1899,7 @@ gboolean gsb_data_transaction_set_exchange_fees (gint transaction_number,
 		{
 			transaction = tmp_list->data;
 			transaction->exchange_fees = exchange_fees;
+			gsb_data_transaction_counters_mark (transaction);
 
 			tmp_list = tmp_list->next;
 		}
@@ -1147,7 +1945,10 @@ gboolean gsb_data_transaction_set_payee_number (gint transaction_number,
 	if (!transaction)
 		return FALSE;
 
+	gsb_data_transaction_payee_index_remove (transaction);
 	transaction->payee_number = no_payee;
+	gsb_data_transaction_counters_mark (transaction);
+	gsb_data_transaction_payee_index_add (transaction);
 
 	/* if the transaction is a split, change all the children */
 	if (transaction->split_of_transaction)
@@ -1162,6 +1963,7 @@ gboolean gsb_data_transaction_set_payee_number (gint transaction_number,
 		{
 			transaction = tmp_list->data;
 			transaction->payee_number = no_payee;
+			gsb_data_transaction_counters_mark (transaction);
 
 			tmp_list = tmp_list->next;
 		}
@@ -1208,6 +2010,8 @@ gboolean gsb_data_transaction_set_category_number (gint transaction_number,
 
 	transaction->category_number = no_category;
 
+	gsb_data_transaction_counters_mark (transaction);
+
 	return TRUE;
 }
 
@@ -1248,6 +2052,8 @@ gboolean gsb_data_transaction_set_sub_category_number (gint transaction_number,
 
 	transaction->sub_category_number = no_sub_category;
 
+	gsb_data_transaction_counters_mark (transaction);
+
 	return TRUE;
 }
 
@@ -1288,6 +2094,8 @@ gboolean gsb_data_transaction_set_split_of_transaction (gint transaction_number,
 
 	transaction->split_of_transaction = is_split;
 
+	gsb_data_transaction_counters_mark (transaction);
+
 	return TRUE;
 }
 
@@ -1330,6 +2138,7 @@ gboolean gsb_data_transaction_set_notes (gint transaction_number,
 
 	g_free (transaction->notes);
 	transaction->notes = my_strdup (notes);
+	gsb_search_index_mark_transaction (transaction_number);
 
 	return TRUE;
 }
@@ -1435,6 +2244,7 @@ gboolean gsb_data_transaction_set_method_of_payment_content (gint transaction_nu
 
 	g_free (transaction->method_of_payment_content);
 	transaction->method_of_payment_content = my_strdup (method_of_payment_content);
+	gsb_search_index_mark_transaction (transaction_number);
 
 	return TRUE;
 }
@@ -1552,6 +2362,8 @@ gboolean gsb_data_transaction_set_archive_number (gint transaction_number,
 
 	transaction->archive_number = archive_number;
 
+	gsb_data_transaction_counters_mark (transaction);
+
 	return TRUE;
 }
 
@@ -1733,6 +2545,8 @@ gboolean gsb_data_transaction_set_budgetary_number (gint transaction_number,
 
 	transaction->budgetary_number = budgetary_number;
 
+	gsb_data_transaction_counters_mark (transaction);
+
 	return TRUE;
 }
 
@@ -1773,6 +2587,8 @@ gboolean gsb_data_transaction_set_sub_budgetary_number (gint transaction_number,
 
 	transaction->sub_budgetary_number = sub_budgetary_number;
 
+	gsb_data_transaction_counters_mark (transaction);
+
 	return TRUE;
 }
 
@@ -1902,6 +2718,8 @@ gboolean gsb_data_transaction_set_contra_transaction_number (gint transaction_nu
 
 	transaction->contra_transaction_number = contra_transaction_number;
 
+	gsb_data_transaction_counters_mark (transaction);
+
 	return TRUE;
 }
 
@@ -1966,7 +2784,11 @@ gboolean gsb_data_transaction_set_mother_transaction_number (gint transaction_nu
 	if (!transaction)
 		return FALSE;
 
+	gsb_data_transaction_payee_index_remove (transaction);
 	transaction->mother_transaction_number = mother_transaction_number;
+	gsb_data_transaction_payee_index_add (transaction);
+
+	gsb_data_transaction_counters_mark (transaction);
 
 	return TRUE;
 }
@@ -2012,6 +2834,8 @@ gint gsb_data_transaction_new_transaction_from_file (gint no_account,
 		active_transactions_list = g_slist_prepend (active_transactions_list, transaction);
 
 	gsb_data_transaction_save_transaction_pointer (transaction);
+	gsb_data_transaction_payee_index_add (transaction);
+	gsb_data_transaction_counters_mark (transaction);
 
 	return transaction->transaction_number;
 }
@@ -2058,6 +2882,8 @@ gint gsb_data_transaction_new_transaction_with_number (gint no_account,
 		active_transactions_list = g_slist_append (active_transactions_list, transaction);
 
 	gsb_data_transaction_save_transaction_pointer (transaction);
+	gsb_data_transaction_payee_index_add (transaction);
+	gsb_data_transaction_counters_mark (transaction);
 
 	return transaction->transaction_number;
 }
@@ -2076,6 +2902,214 @@ gint gsb_data_transaction_new_transaction (gint no_account)
 															 gsb_data_transaction_get_last_number () + 1);
 }
 
+/**
+ * create a batch of new transactions in the account, used by the import
+ * the numbers are reserved in one time : the new transactions are numbered
+ * from the returned number to the returned number + nb_transactions - 1
+ * the lists of transactions are walked only one time for all the batch
+ * instead of one time per transaction with gsb_data_transaction_new_transaction
+ *
+ * \param no_account the number of the account where the transactions should be made
+ * \param nb_transactions the number of transactions to create
+ *
+ * \return the number of the first new transaction, 0 if problem
+ **/
+gint gsb_data_transaction_new_transactions_batch (gint no_account,
+												  gint nb_transactions)
+{
+	GSList *new_list = NULL;
+	GSList *new_active_list = NULL;
+	gint first_number;
+	gint currency_number;
+	gboolean closed_account;
+	gint i;
+
+	if (nb_transactions <= 0)
+		return 0;
+
+	first_number = gsb_data_transaction_get_last_number () + 1;
+	currency_number = gsb_data_account_get_currency (no_account);
+	closed_account = gsb_data_account_get_closed_account (no_account);
+
+	/* the transactions are prepended from the last to keep the order of the numbers */
+	for (i = nb_transactions - 1 ; i >= 0 ; i--)
+	{
+		TransactionStruct *transaction;
+
+		transaction = g_malloc0 (sizeof (TransactionStruct));
+		transaction->account_number = no_account;
+		transaction->transaction_number = first_number + i;
+		transaction->currency_number = currency_number;
+		transaction->voucher = g_strdup("");
+		transaction->bank_references = g_strdup("");
+
+		new_list = g_slist_prepend (new_list, transaction);
+		gsb_data_transaction_payee_index_add (transaction);
+		gsb_data_transaction_counters_mark (transaction);
+		if (!closed_account)
+			new_active_list = g_slist_prepend (new_active_list, transaction);
+	}
+
+	/* we append the batch to the complete transactions list and the non archive transaction list */
+	transactions_list = g_slist_concat (transactions_list, new_list);
+	complete_transactions_list = g_slist_concat (complete_transactions_list, g_slist_copy (new_list));
+
+	/* we append the batch to the active transactions list if the account isn't closed */
+	if (new_active_list)
+		active_transactions_list = g_slist_concat (active_transactions_list, new_active_list);
+
+	gsb_data_transaction_save_transaction_pointer (new_list->data);
+	gsb_data_account_set_balances_are_dirty (no_account);
+
+	return first_number;
+}
+
+/**
+ * return TRUE if the transaction should be in the counters of the payees,
+ * categories and budgets : not a white line, and not archived unless
+ * the archives are in the totals or the archive is loaded
+ *
+ * \param transaction_number
+ *
+ * \return TRUE if the transaction is counted
+ **/
+gboolean gsb_data_transaction_is_in_counters (gint transaction_number)
+{
+	TransactionStruct *transaction;
+	GrisbiWinEtat *w_etat;
+
+	if (transaction_number <= 0)
+		return FALSE;
+
+	transaction = gsb_data_transaction_get_transaction_by_no (transaction_number);
+	if (!transaction)
+		return FALSE;
+
+	if (!transaction->archive_number)
+		return TRUE;
+
+	w_etat = grisbi_win_get_w_etat ();
+	if (w_etat->metatree_add_archive_in_totals)
+		return TRUE;
+
+	return loaded_archived_transactions
+		&& g_hash_table_contains (loaded_archived_transactions, GINT_TO_POINTER (transaction_number));
+}
+
+/**
+ * return TRUE if the transaction is in the list without the archived
+ * transactions : not archived, or its archive is loaded
+ *
+ * \param transaction_number
+ *
+ * \return TRUE if the transaction is in gsb_data_transaction_get_transactions_list
+ **/
+gboolean gsb_data_transaction_is_in_transactions_list (gint transaction_number)
+{
+	TransactionStruct *transaction;
+
+	transaction = gsb_data_transaction_get_transaction_by_no (transaction_number);
+	if (!transaction)
+		return FALSE;
+
+	if (!transaction->archive_number)
+		return TRUE;
+
+	return loaded_archived_transactions
+		&& g_hash_table_contains (loaded_archived_transactions, GINT_TO_POINTER (transaction_number));
+}
+
+/**
+ * all the transactions will be counted again at the next update of the counters
+ * of the payees, categories and budgets. Called when the conversion of the
+ * amounts changes (currency links, floating point of a currency)
+ *
+ * \param
+ *
+ * \return
+ **/
+void gsb_data_transaction_invalidate_counters (void)
+{
+	counters_valid = FALSE;
+	if (counters_pending)
+		g_hash_table_remove_all (counters_pending);
+}
+
+/**
+ * update the counters of the payees, categories and budgets
+ * all the transactions are counted in one pass the first time, or when the
+ * archives option or the currency of a tree is changed ; after that, only the
+ * transactions modified since the last update are counted again
+ *
+ * \param
+ *
+ * \return
+ **/
+void gsb_data_transaction_update_counters (void)
+{
+	GHashTable *pending;
+	GHashTableIter iter;
+	gpointer key;
+	GrisbiWinEtat *w_etat;
+
+	w_etat = grisbi_win_get_w_etat ();
+
+	if (!counters_valid
+		|| counters_with_archives != w_etat->metatree_add_archive_in_totals
+		|| counters_payee_currency != payee_tree_currency ()
+		|| counters_category_currency != category_tree_currency ()
+		|| counters_budget_currency != budgetary_line_tree_currency ())
+	{
+		gsb_data_transaction_counters_count_all ();
+
+		return;
+	}
+
+	if (!counters_pending || !g_hash_table_size (counters_pending))
+		return;
+
+	/* the setters called while counting must not modify the set we walk */
+	pending = counters_pending;
+	counters_pending = NULL;
+
+	g_hash_table_iter_init (&iter, pending);
+	while (g_hash_table_iter_next (&iter, &key, NULL))
+	{
+		TransactionStruct *transaction;
+		gint transaction_number;
+
+		transaction_number = GPOINTER_TO_INT (key);
+		transaction = gsb_data_transaction_get_transaction_by_no (transaction_number);
+		if (!transaction)
+			continue;
+
+		gsb_data_payee_add_transaction_to_counters (transaction_number, NULL);
+		gsb_data_category_add_transaction_to_counters (transaction_number,
+													   transaction->category_number,
+													   transaction->sub_category_number,
+													   NULL);
+		gsb_data_budget_add_transaction_to_counters (transaction_number,
+													 transaction->budgetary_number,
+													 transaction->sub_budgetary_number,
+													 NULL);
+	}
+	g_hash_table_destroy (pending);
+}
+
+/**
+ * return a number incremented each time a transaction is created, deleted,
+ * or modified in a way which can change its place in the metatrees
+ * (divisions, amount, date, archive)
+ *
+ * \param
+ *
+ * \return the serial
+ **/
+guint gsb_data_transaction_get_modifications_serial (void)
+{
+	return modifications_serial;
+}
+
 /**
  * create a new white line
  * if there is a mother transaction, it's a split and we increment in the negatives values
@@ -2153,6 +3187,7 @@ gboolean gsb_data_transaction_copy_transaction (gint source_transaction_number,
 	/* on sauvegarde le numéro de compte initial */
 	target_transaction_account_number = target_transaction->account_number;
 
+	gsb_data_transaction_payee_index_remove (target_transaction);
 	memcpy (target_transaction, source_transaction, sizeof (TransactionStruct));
 	target_transaction->transaction_number = target_transaction_number;
 	target_transaction->account_number = target_transaction_account_number;
@@ -2185,6 +3220,9 @@ gboolean gsb_data_transaction_copy_transaction (gint source_transaction_number,
 	if (source_transaction->method_of_payment_content)
 		target_transaction->method_of_payment_content = my_strdup (source_transaction->method_of_payment_content);
 
+	gsb_data_transaction_payee_index_add (target_transaction);
+	gsb_data_transaction_counters_mark (target_transaction);
+
 	return TRUE;
 }
 
@@ -2307,9 +3345,15 @@ gboolean gsb_data_transaction_remove_transaction_without_check (gint transaction
 	if (!transaction)
 		return FALSE;
 
-	/* delete the transaction from the lists */
+	/* delete the transaction from the lists and the counters */
+	gsb_data_payee_remove_transaction_from_payee (transaction_number);
+	gsb_data_category_remove_transaction_from_category (transaction_number);
+	gsb_data_budget_remove_transaction_from_budget (transaction_number);
+	gsb_data_transaction_counters_forget (transaction_number);
+
 	transactions_list = g_slist_remove (transactions_list, transaction);
 	complete_transactions_list = g_slist_remove (complete_transactions_list, transaction);
+	gsb_data_transaction_payee_index_remove (transaction);
 
 	/* we free the buffer to avoid big possibly crashes */
 	transaction_buffer[0] = NULL;
@@ -2507,7 +3551,7 @@ GSList *gsb_data_transaction_get_metatree_transactions_list (void)
 	w_etat = grisbi_win_get_w_etat ();
 
 	if (w_etat->metatree_add_archive_in_totals)
-		list_tmp = g_slist_copy (complete_transactions_list);
+		list_tmp = g_slist_copy (gsb_data_transaction_get_complete_transactions_list ());
 	else
 		list_tmp = g_slist_copy (transactions_list);
 
@@ -2585,6 +3629,61 @@ GsbReal gsb_data_transaction_get_last_transaction_with_div_sub_div (gint account
 	return null_real;
 }
 
+/**
+ * return the last non-child transaction (the biggest number) with the payee,
+ * archived transactions included, using the payee index. the transactions
+ * of the archive segment are not loaded for that
+ * the index is built at the first call and updated when the transactions
+ * are created, modified or deleted
+ *
+ * \param payee_number
+ * \param account_number
+ * \param in_account TRUE to look in account_number, FALSE to look in the other accounts
+ * \param excluded_transaction a transaction to ignore, 0 if none
+ *
+ * \return the number of the transaction found or 0
+ **/
+gint gsb_data_transaction_get_last_transaction_with_payee (gint payee_number,
+														   gint account_number,
+														   gboolean in_account,
+														   gint excluded_transaction)
+{
+	PayeeLastIndex *payee_index;
+	GSequence *sequence;
+	GSequenceIter *iter;
+
+	if (!payee_last_index)
+		gsb_data_transaction_payee_index_build ();
+
+	payee_index = g_hash_table_lookup (payee_last_index, GINT_TO_POINTER (payee_number));
+	if (!payee_index)
+		return 0;
+
+	if (in_account)
+	{
+		sequence = g_hash_table_lookup (payee_index->accounts, GINT_TO_POINTER (account_number));
+		if (!sequence)
+			return 0;
+	}
+	else
+		sequence = payee_index->transactions;
+
+	/* walk from the biggest number */
+	iter = g_sequence_get_end_iter (sequence);
+	while (!g_sequence_iter_is_begin (iter))
+	{
+		TransactionStruct *transaction;
+
+		iter = g_sequence_iter_prev (iter);
+		transaction = g_sequence_get (iter);
+		if (transaction->transaction_number != excluded_transaction
+			&& (in_account || transaction->account_number != account_number))
+			return transaction->transaction_number;
+	}
+
+	return 0;
+}
+
 /**
  * get floating point of the currency of the transaction given
  *
@@ -2625,6 +3724,10 @@ gboolean gsb_data_transaction_remove_transaction_in_transaction_list (gint trans
 	/* delete the transaction from the lists */
 	transactions_list = g_slist_remove (transactions_list, transaction);
 
+	if (loaded_archived_transactions)
+		g_hash_table_remove (loaded_archived_transactions, GINT_TO_POINTER (transaction_number));
+	gsb_data_transaction_counters_mark (transaction);
+
 	return TRUE;
 }
 
@@ -56,6 +56,23 @@ struct _TransactionStruct
     gchar *method_of_payment_content;
 };
 
+/**
+ * \struct
+ * the amount of a transaction counted in the payees, categories or budgets,
+ * kept in the currency of the transaction when a hard link gives its conversion,
+ * with the rate of the link when it was counted, so the same value is removed
+ */
+typedef struct _TransactionCountedAmount	TransactionCountedAmount;
+
+struct _TransactionCountedAmount
+{
+    GsbReal amount;
+    GsbReal exchange_fees;              /**< deducted after the conversion */
+    gint currency_number;               /**< 0 if amount is already in the currency of the tree */
+    GsbReal change_rate;                /**< rate of the link when the amount was counted */
+    gboolean multiply;                  /**< TRUE if the amount is multiplied by change_rate */
+};
+
 /** Etat de rapprochement d'une opération */
 enum OperationEtatRapprochement
 {
@@ -68,11 +85,20 @@ enum OperationEtatRapprochement
 
 /* START_DECLARATION */
 gboolean 		gsb_data_transaction_add_archived_to_list 						(gint transaction_number);
+void			gsb_data_transaction_balances_batch_append						(GHashTable *batch,
+																				 GsbReal *balance,
+																				 gint transaction_number);
+void			gsb_data_transaction_balances_batch_finish						(GHashTable *batch,
+																				 gint return_currency_number,
+																				 gint return_exponent);
+GHashTable *	gsb_data_transaction_balances_batch_new							(void);
+void			gsb_data_transaction_begin_archived_loading						(void);
 gint 			gsb_data_transaction_check_content_payment 						(gint payment_number,
 																				 const gchar *number);
 gboolean 		gsb_data_transaction_copy_transaction 							(gint source_transaction_number,
 																				 gint target_transaction_number,
 																				 gboolean reset_mark);
+void			gsb_data_transaction_end_archived_loading						(void);
 gint 			gsb_data_transaction_find_by_id 								(gchar *id,
 																				 gint account_number);
 gint 			gsb_data_transaction_get_account_number 						(gint transaction_number);
@@ -81,7 +107,15 @@ GsbReal 		gsb_data_transaction_get_adjusted_amount 						(gint transaction_numbe
 GsbReal 		gsb_data_transaction_get_adjusted_amount_for_currency 			(gint transaction_number,
 																				 gint return_currency_number,
 																				 gint return_exponent);
+GsbReal			gsb_data_transaction_get_adjusted_amounts_sum					(GPtrArray *transactions,
+																				 gint return_currency_number,
+																				 gint return_exponent);
 GsbReal 		gsb_data_transaction_get_amount 								(gint transaction_number);
+void			gsb_data_transaction_get_counted_amount							(gint transaction_number,
+																				 gint return_currency_number,
+																				 TransactionCountedAmount *counted_amount);
+GsbReal			gsb_data_transaction_get_counted_amount_value					(const TransactionCountedAmount *counted_amount,
+																				 gint return_currency_number);
 gint 			gsb_data_transaction_get_archive_number 						(gint transaction_number);
 GSList *		gsb_data_transaction_get_active_transactions_list				(void);
 gint 			gsb_data_transaction_get_automatic_transaction 					(gint transaction_number);
@@ -107,12 +141,18 @@ GsbReal 		gsb_data_transaction_get_last_transaction_with_div_sub_div 		(gint acc
 																				 gint div_number,
 																				 gint sub_div_nb,
 																				 gint type_div);
+gint			gsb_data_transaction_get_last_transaction_with_payee			(gint payee_number,
+																				 gint account_number,
+																				 gboolean in_account,
+																				 gint excluded_transaction);
 GSList *		gsb_data_transaction_get_list_for_import 						(gint account_number,
 																				 GDate *first_date_import);
+GSList *		gsb_data_transaction_get_loaded_transactions_list				(void);
 gint 			gsb_data_transaction_get_marked_transaction 					(gint transaction_number);
 GSList *		gsb_data_transaction_get_metatree_transactions_list 			(void);
 const gchar *	gsb_data_transaction_get_method_of_payment_content				(gint transaction_number);
 gint 			gsb_data_transaction_get_method_of_payment_number 				(gint transaction_number);
+guint			gsb_data_transaction_get_modifications_serial					(void);
 gint 			gsb_data_transaction_get_mother_transaction_number 				(gint transaction_number);
 const gchar *	gsb_data_transaction_get_notes 									(gint transaction_number);
 gint 			gsb_data_transaction_get_payee_number 							(gint transaction_number);
@@ -129,11 +169,16 @@ const GDate *	gsb_data_transaction_get_value_date_or_date 					(gint transaction
 const gchar *	gsb_data_transaction_get_voucher 								(gint transaction_number);
 gint 			gsb_data_transaction_get_white_line 							(gint transaction_number);
 gboolean 		gsb_data_transaction_init_variables 							(void);
+void			gsb_data_transaction_invalidate_counters						(void);
+gboolean		gsb_data_transaction_is_in_counters								(gint transaction_number);
+gboolean		gsb_data_transaction_is_in_transactions_list						(gint transaction_number);
 gint 			gsb_data_transaction_new_transaction 							(gint no_account);
 gint 			gsb_data_transaction_new_transaction_from_file	 				(gint no_account,
                         														 gint transaction_number);
 gint 			gsb_data_transaction_new_transaction_with_number 				(gint no_account,
                         														 gint transaction_number);
+gint			gsb_data_transaction_new_transactions_batch 					(gint no_account,
+																				 gint nb_transactions);
 gint 			gsb_data_transaction_new_white_line								(gint mother_transaction_number);
 gboolean 		gsb_data_transaction_remove_transaction							(gint transaction_number);
 gboolean 		gsb_data_transaction_remove_transaction_in_transaction_list 	(gint transaction_number);
@@ -194,6 +239,7 @@ gboolean 		gsb_data_transaction_set_value_date 							(gint transaction_number,
                         														 const GDate *date);
 gboolean 		gsb_data_transaction_set_voucher 								(gint transaction_number,
                         														 const gchar *voucher);
+void			gsb_data_transaction_update_counters							(void);
 /* END_DECLARATION */
 
 
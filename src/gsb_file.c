@@ -44,6 +44,7 @@
 #include "gsb_data_account.h"
 #include "gsb_data_archive_store.h"
 #include "gsb_dirs.h"
+#include "gsb_file_archive_segment.h"
 #include "gsb_file_load.h"
 #include "gsb_file_save.h"
 #include "gsb_file_util.h"
@@ -240,11 +241,19 @@ static void gsb_file_remove_old_backup (const gchar *filename,
     {
 		GFile *file;
 		gchar *path;
+		gchar *segment_path;
 
 		path = iterator->data;
 
 		file = g_file_new_for_path (path);
 		g_file_delete (file, FALSE, NULL);
+
+		/* the archived transactions saved with the backup */
+		segment_path = gsb_file_archive_segment_get_filename (path);
+		if (g_file_test (segment_path, G_FILE_TEST_EXISTS))
+			g_remove (segment_path);
+		g_free (segment_path);
+
 		iterator = iterator->next;
 	}
 
@@ -666,6 +675,7 @@ static gboolean gsb_file_save_file (gint origine)
     if (result)
     {
 		grisbi_win_set_filename (NULL, nouveau_nom_enregistrement);
+		gsb_file_archive_segment_set_filename (nouveau_nom_enregistrement);
 
 		/* on ajoute un item au menu recent_file si origine = -2 */
 		if (origine == -2)
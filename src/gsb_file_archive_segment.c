@@ -0,0 +1,745 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*     Copyright (C)         2026 Grisbi Development Team                     */
+/*             https://www.grisbi.org/                                         */
+/*                                                                            */
+/*  This program is free software; you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation; either version 2 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This program is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program; if not, see <https://www.gnu.org/licenses/>.     */
+/*                                                                            */
+/* ************************************************************************** */
+
+/**
+ * \file gsb_file_archive_segment.c
+ * keep the archived transactions out of memory
+ * when the option is set, the transactions of the archives are saved in a
+ * second file next to the grisbi file (the archive segment), and the grisbi
+ * file keeps only a summary for each archive and each account.
+ * at the opening, only the summaries are loaded : they make the archive stores
+ * and are added to the balances of the accounts. the transactions of the segment
+ * are loaded the first time the complete list of transactions is asked (archive
+ * line expanded, report or search with the archives...)
+ * only the archives whose transactions are reconciled, in the past, and without
+ * transfer or split with a transaction out of the archives can go in the segment,
+ * so the balances of the accounts can be computed with the summaries
+ */
+
+
+#include "config.h"
+
+#include "include.h"
+#include <glib/gi18n.h>
+#include <glib/gstdio.h>
+#include <sys/stat.h>
+
+/*START_INCLUDE*/
+#include "gsb_file_archive_segment.h"
+#include "dialog.h"
+#include "grisbi_app.h"
+#include "grisbi_win.h"
+#include "gsb_data_account.h"
+#include "gsb_data_archive_store.h"
+#include "gsb_data_transaction.h"
+#include "gsb_file_load.h"
+#include "gsb_file_save.h"
+#include "structures.h"
+#include "utils_dates.h"
+#include "erreur.h"
+/*END_INCLUDE*/
+
+
+/*START_STATIC*/
+/*END_STATIC*/
+
+/*START_EXTERN*/
+/*END_EXTERN*/
+
+/** the name of the archive segment of the opened file */
+static gchar *segment_filename = NULL;
+
+/** the list of ArchiveSegmentSummary of the archives in the segment */
+static GSList *segment_summaries = NULL;
+
+/** the numbers of the archives in the segment */
+static GHashTable *segment_archives = NULL;
+
+/** TRUE while the transactions of the segment are not in memory */
+static gboolean segment_is_cold = FALSE;
+
+/** TRUE if the segment couldn't be loaded, we don't try again */
+static gboolean segment_failed = FALSE;
+
+/** TRUE while the segment is loaded */
+static gboolean segment_loading = FALSE;
+
+
+/******************************************************************************/
+/* Private functions                                                          */
+/******************************************************************************/
+/**
+ * free an ArchiveSegmentSummary
+ *
+ * \param summary
+ *
+ * \return
+ **/
+static void gsb_file_archive_segment_summary_free (ArchiveSegmentSummary *summary)
+{
+	if (summary->last_date)
+		g_date_free (summary->last_date);
+	g_free (summary);
+}
+
+/**
+ * free the summaries and the numbers of the archives in the segment
+ *
+ * \param
+ *
+ * \return
+ **/
+static void gsb_file_archive_segment_free_summaries (void)
+{
+	g_slist_free_full (segment_summaries, (GDestroyNotify) gsb_file_archive_segment_summary_free);
+	segment_summaries = NULL;
+
+	if (segment_archives)
+	{
+		g_hash_table_destroy (segment_archives);
+		segment_archives = NULL;
+	}
+}
+
+/**
+ * add the archive to the excluded archives
+ *
+ * \param excluded
+ * \param archive_number
+ *
+ * \return TRUE if the archive was not already excluded
+ **/
+static gboolean gsb_file_archive_segment_exclude (GHashTable *excluded,
+												  gint archive_number)
+{
+	if (!archive_number || g_hash_table_contains (excluded, GINT_TO_POINTER (archive_number)))
+		return FALSE;
+
+	g_hash_table_add (excluded, GINT_TO_POINTER (archive_number));
+
+	return TRUE;
+}
+
+/**
+ * find the archives of the transactions in memory which can go in the segment :
+ * all their transactions are reconciled and in the past, they have an
+ * archive store, and their transfers and splits stay between archives of
+ * the segment
+ *
+ * \param
+ *
+ * \return a new set of the archive numbers
+ **/
+static GHashTable *gsb_file_archive_segment_find_archives (void)
+{
+	GHashTable *archives;
+	GHashTable *excluded;
+	GHashTable *transactions;
+	GHashTableIter iter;
+	gpointer key;
+	GSList *tmp_list;
+	GDate *today;
+	gboolean changed = TRUE;
+
+	archives = g_hash_table_new (g_direct_hash, g_direct_equal);
+	excluded = g_hash_table_new (g_direct_hash, g_direct_equal);
+	transactions = g_hash_table_new (g_direct_hash, g_direct_equal);
+	today = gdate_today ();
+
+	tmp_list = gsb_data_transaction_get_loaded_transactions_list ();
+	while (tmp_list)
+	{
+		TransactionStruct *transaction;
+
+		transaction = tmp_list->data;
+		g_hash_table_insert (transactions, GINT_TO_POINTER (transaction->transaction_number), transaction);
+
+		if (transaction->archive_number)
+		{
+			g_hash_table_add (archives, GINT_TO_POINTER (transaction->archive_number));
+
+			if (transaction->marked_transaction != OPERATION_RAPPROCHEE
+				|| !transaction->date
+				|| g_date_compare (transaction->date, today) > 0
+				|| (transaction->value_date && g_date_compare (transaction->value_date, today) > 0)
+				|| !gsb_data_archive_store_get_structure_by_archive (transaction->archive_number,
+																	 transaction->account_number))
+				gsb_file_archive_segment_exclude (excluded, transaction->archive_number);
+		}
+		tmp_list = tmp_list->next;
+	}
+	g_date_free (today);
+
+	/* the two sides of a transfer or a split are kept in memory or put in the segment together */
+	while (changed)
+	{
+		changed = FALSE;
+
+		tmp_list = gsb_data_transaction_get_loaded_transactions_list ();
+		while (tmp_list)
+		{
+			TransactionStruct *transaction;
+			gint links[2];
+			gint i;
+
+			transaction = tmp_list->data;
+			links[0] = transaction->contra_transaction_number;
+			links[1] = transaction->mother_transaction_number;
+
+			for (i = 0; i < 2; i++)
+			{
+				TransactionStruct *linked;
+				gint linked_archive_number;
+
+				if (links[i] <= 0)
+					continue;
+
+				linked = g_hash_table_lookup (transactions, GINT_TO_POINTER (links[i]));
+				linked_archive_number = linked ? linked->archive_number : 0;
+				if (linked_archive_number == transaction->archive_number)
+					continue;
+
+				if (gsb_file_archive_segment_exclude (excluded, transaction->archive_number))
+					changed = TRUE;
+				if (gsb_file_archive_segment_exclude (excluded, linked_archive_number))
+					changed = TRUE;
+			}
+			tmp_list = tmp_list->next;
+		}
+	}
+
+	g_hash_table_iter_init (&iter, excluded);
+	while (g_hash_table_iter_next (&iter, &key, NULL))
+		g_hash_table_remove (archives, key);
+
+	g_hash_table_destroy (excluded);
+	g_hash_table_destroy (transactions);
+
+	return archives;
+}
+
+/**
+ * return the summary of the archive for the account, create it if necessary
+ *
+ * \param summaries the summaries by archive then by account
+ * \param archive_number
+ * \param account_number
+ *
+ * \return the summary
+ **/
+static ArchiveSegmentSummary *gsb_file_archive_segment_get_summary (GHashTable *summaries,
+																	gint archive_number,
+																	gint account_number)
+{
+	ArchiveSegmentSummary *summary;
+	GHashTable *accounts;
+
+	accounts = g_hash_table_lookup (summaries, GINT_TO_POINTER (archive_number));
+	if (!accounts)
+	{
+		accounts = g_hash_table_new (g_direct_hash, g_direct_equal);
+		g_hash_table_insert (summaries, GINT_TO_POINTER (archive_number), accounts);
+	}
+
+	summary = g_hash_table_lookup (accounts, GINT_TO_POINTER (account_number));
+	if (!summary)
+	{
+		StoreArchive *archive_store;
+
+		archive_store = gsb_data_archive_store_get_structure_by_archive (archive_number, account_number);
+
+		summary = g_malloc0 (sizeof (ArchiveSegmentSummary));
+		summary->archive_number = archive_number;
+		summary->account_number = account_number;
+		summary->balance = null_real;
+		summary->nb_transactions = archive_store->nb_transactions;
+		g_hash_table_insert (accounts, GINT_TO_POINTER (account_number), summary);
+		segment_summaries = g_slist_append (segment_summaries, summary);
+	}
+
+	return summary;
+}
+
+/**
+ * make the summaries of the archives of the segment with the transactions in memory
+ *
+ * \param
+ *
+ * \return
+ **/
+static void gsb_file_archive_segment_make_summaries (void)
+{
+	GHashTable *summaries;
+	GSList *tmp_list;
+
+	summaries = g_hash_table_new_full (g_direct_hash,
+									   g_direct_equal,
+									   NULL,
+									   (GDestroyNotify) g_hash_table_destroy);
+
+	tmp_list = gsb_data_transaction_get_loaded_transactions_list ();
+	while (tmp_list)
+	{
+		TransactionStruct *transaction;
+		ArchiveSegmentSummary *summary;
+
+		transaction = tmp_list->data;
+		tmp_list = tmp_list->next;
+
+		if (!gsb_file_archive_segment_contains_archive (transaction->archive_number))
+			continue;
+
+		summary = gsb_file_archive_segment_get_summary (summaries,
+														transaction->archive_number,
+														transaction->account_number);
+
+		/* the balance is computed as the balance of the account, without the children of splits */
+		if (!transaction->mother_transaction_number)
+			summary->balance = gsb_real_add (summary->balance,
+											 gsb_data_transaction_get_adjusted_amount
+											 (transaction->transaction_number,
+											  gsb_data_account_get_currency_floating_point
+											  (transaction->account_number)));
+		if (!summary->last_date || g_date_compare (transaction->date, summary->last_date) > 0)
+		{
+			if (summary->last_date)
+				g_date_free (summary->last_date);
+			summary->last_date = gsb_date_copy (transaction->date);
+		}
+		if (transaction->value_date && g_date_compare (transaction->value_date, summary->last_date) > 0)
+		{
+			g_date_free (summary->last_date);
+			summary->last_date = gsb_date_copy (transaction->value_date);
+		}
+		if (transaction->transaction_number > summary->last_number)
+			summary->last_number = transaction->transaction_number;
+	}
+	g_hash_table_destroy (summaries);
+}
+
+/**
+ * copy the segment of the opened file to the new name
+ *
+ * \param new_segment_filename
+ *
+ * \return TRUE if ok
+ **/
+static gboolean gsb_file_archive_segment_copy (const gchar *new_segment_filename)
+{
+	GError *error = NULL;
+	gchar *content;
+	gsize length;
+
+	if (!g_file_get_contents (segment_filename, &content, &length, &error)
+		|| !g_file_set_contents (new_segment_filename, content, length, &error))
+	{
+		gchar *tmp_str;
+
+		tmp_str = g_strdup_printf (_("Cannot save file '%s': %s"), new_segment_filename, error->message);
+		dialogue_error (tmp_str);
+		g_free (tmp_str);
+		g_error_free (error);
+
+		return FALSE;
+	}
+	g_free (content);
+	(void)g_chmod (new_segment_filename, S_IRUSR | S_IWUSR);
+
+	return TRUE;
+}
+
+/******************************************************************************/
+/* Public functions                                                           */
+/******************************************************************************/
+/**
+ * set the archive segment global variables to NULL,
+ * usually when we init all the global variables
+ *
+ * \param
+ *
+ * \return
+ **/
+void gsb_file_archive_segment_init_variables (void)
+{
+	gsb_file_archive_segment_free_summaries ();
+
+	g_free (segment_filename);
+	segment_filename = NULL;
+	segment_is_cold = FALSE;
+	segment_failed = FALSE;
+	segment_loading = FALSE;
+}
+
+/**
+ * return the name of the archive segment of the grisbi file
+ *
+ * \param filename the name of the grisbi file
+ *
+ * \return a newly allocated string
+ **/
+gchar *gsb_file_archive_segment_get_filename (const gchar *filename)
+{
+	return g_strconcat (filename, ".archives", NULL);
+}
+
+/**
+ * set the grisbi file whose segment is loaded when needed
+ *
+ * \param filename the name of the grisbi file
+ *
+ * \return
+ **/
+void gsb_file_archive_segment_set_filename (const gchar *filename)
+{
+	g_free (segment_filename);
+	segment_filename = gsb_file_archive_segment_get_filename (filename);
+}
+
+/**
+ * add the summary of an archive for an account, read in the grisbi file,
+ * the transactions of that archive are in the segment
+ *
+ * \param archive_number
+ * \param account_number
+ * \param balance
+ * \param nb_transactions
+ * \param last_date
+ * \param last_number
+ *
+ * \return
+ **/
+void gsb_file_archive_segment_add_summary (gint archive_number,
+										   gint account_number,
+										   GsbReal balance,
+										   gint nb_transactions,
+										   const GDate *last_date,
+										   gint last_number)
+{
+	ArchiveSegmentSummary *summary;
+
+	summary = g_malloc0 (sizeof (ArchiveSegmentSummary));
+	summary->archive_number = archive_number;
+	summary->account_number = account_number;
+	summary->balance = balance;
+	summary->nb_transactions = nb_transactions;
+	if (last_date)
+		summary->last_date = gsb_date_copy (last_date);
+	summary->last_number = last_number;
+	segment_summaries = g_slist_append (segment_summaries, summary);
+
+	if (!segment_archives)
+		segment_archives = g_hash_table_new (g_direct_hash, g_direct_equal);
+	g_hash_table_add (segment_archives, GINT_TO_POINTER (archive_number));
+
+	segment_is_cold = TRUE;
+}
+
+/**
+ * create the archive stores of the archives in the segment with their summaries
+ * called at the opening, after the archive stores of the transactions in memory
+ *
+ * \param
+ *
+ * \return
+ **/
+void gsb_file_archive_segment_add_stores (void)
+{
+	GSList *tmp_list;
+
+	if (!segment_is_cold)
+		return;
+
+	tmp_list = segment_summaries;
+	while (tmp_list)
+	{
+		ArchiveSegmentSummary *summary;
+
+		summary = tmp_list->data;
+		gsb_data_archive_store_new_with_summary (summary->archive_number,
+												 summary->account_number,
+												 summary->balance,
+												 summary->nb_transactions);
+		tmp_list = tmp_list->next;
+	}
+}
+
+/**
+ * return the list of the summaries of the archives in the segment
+ *
+ * \param
+ *
+ * \return the list of ArchiveSegmentSummary
+ **/
+GSList *gsb_file_archive_segment_get_summaries_list (void)
+{
+	return segment_summaries;
+}
+
+/**
+ * return TRUE if the archive is in the segment
+ *
+ * \param archive_number
+ *
+ * \return TRUE if the transactions of that archive are saved in the segment
+ **/
+gboolean gsb_file_archive_segment_contains_archive (gint archive_number)
+{
+	if (!archive_number || !segment_archives)
+		return FALSE;
+
+	return g_hash_table_contains (segment_archives, GINT_TO_POINTER (archive_number));
+}
+
+/**
+ * return TRUE while the transactions of the segment are not in memory
+ *
+ * \param
+ *
+ * \return
+ **/
+gboolean gsb_file_archive_segment_is_cold (void)
+{
+	return segment_is_cold;
+}
+
+/**
+ * return the balance of the transactions of the account which are not in memory
+ * the transactions of the closed accounts are not in the balances
+ *
+ * \param account_number
+ *
+ * \return the balance at the floating point of the account
+ **/
+GsbReal gsb_file_archive_segment_get_account_balance (gint account_number)
+{
+	GSList *tmp_list;
+	GsbReal balance = null_real;
+
+	if (!segment_is_cold || gsb_data_account_get_closed_account (account_number))
+		return null_real;
+
+	tmp_list = segment_summaries;
+	while (tmp_list)
+	{
+		ArchiveSegmentSummary *summary;
+
+		summary = tmp_list->data;
+		if (summary->account_number == account_number)
+			balance = gsb_real_add (balance, summary->balance);
+
+		tmp_list = tmp_list->next;
+	}
+
+	return balance;
+}
+
+/**
+ * return the biggest number of the transactions which are not in memory,
+ * so the new transactions don't take their numbers
+ *
+ * \param
+ *
+ * \return the number or 0
+ **/
+gint gsb_file_archive_segment_get_last_number (void)
+{
+	GSList *tmp_list;
+	gint last_number = 0;
+
+	if (!segment_is_cold)
+		return 0;
+
+	tmp_list = segment_summaries;
+	while (tmp_list)
+	{
+		ArchiveSegmentSummary *summary;
+
+		summary = tmp_list->data;
+		if (summary->last_number > last_number)
+			last_number = summary->last_number;
+
+		tmp_list = tmp_list->next;
+	}
+
+	return last_number;
+}
+
+/**
+ * load in memory the transactions of the segment
+ * the archive stores and the balances don't change
+ *
+ * \param
+ *
+ * \return TRUE if the transactions have been loaded now
+ **/
+gboolean gsb_file_archive_segment_load (void)
+{
+	GSList *tmp_list;
+	gboolean result;
+
+	if (!segment_is_cold || segment_failed || segment_loading)
+		return FALSE;
+
+	devel_debug (segment_filename);
+	segment_loading = TRUE;
+	result = gsb_file_load_archive_segment (segment_filename);
+	segment_loading = FALSE;
+
+	if (!result)
+	{
+		gchar *tmp_str;
+
+		tmp_str = g_strdup_printf (_("Cannot load the archived transactions from '%s'.\n"
+									 "The archives are shown with their balance only."),
+								   segment_filename);
+		dialogue_error (tmp_str);
+		g_free (tmp_str);
+		segment_failed = TRUE;
+
+		return FALSE;
+	}
+
+	segment_is_cold = FALSE;
+	gsb_file_archive_segment_free_summaries ();
+
+	/* the balances are now computed with the transactions */
+	tmp_list = gsb_data_account_get_list_accounts ();
+	while (tmp_list)
+	{
+		gsb_data_account_set_balances_are_dirty (gsb_data_account_get_no_account (tmp_list->data));
+		tmp_list = tmp_list->next;
+	}
+
+	return TRUE;
+}
+
+/**
+ * load the transactions of the segment if some of them for the account
+ * are at the date or after
+ * used before computing a balance at a date
+ *
+ * \param account_number
+ * \param date
+ *
+ * \return TRUE if the transactions have been loaded now
+ **/
+gboolean gsb_file_archive_segment_load_before_date (gint account_number,
+													const GDate *date)
+{
+	GSList *tmp_list;
+
+	if (!segment_is_cold)
+		return FALSE;
+
+	tmp_list = segment_summaries;
+	while (tmp_list)
+	{
+		ArchiveSegmentSummary *summary;
+
+		summary = tmp_list->data;
+		if (summary->account_number == account_number
+			&& (!summary->last_date || !date || g_date_compare (summary->last_date, date) >= 0))
+			return gsb_file_archive_segment_load ();
+
+		tmp_list = tmp_list->next;
+	}
+
+	return FALSE;
+}
+
+/**
+ * save the segment of the grisbi file, called before saving the grisbi file
+ * if the transactions of the segment are not in memory, they didn't change,
+ * the segment is just copied if the grisbi file has a new name. Else
+ * the archives which can go in the segment are searched and saved in it
+ *
+ * \param filename the name of the grisbi file
+ * \param compress TRUE to compress the segment
+ *
+ * \return TRUE if ok
+ **/
+gboolean gsb_file_archive_segment_save (const gchar *filename,
+										gboolean compress)
+{
+	GHashTable *archives;
+	gchar *new_segment_filename;
+	gboolean result = TRUE;
+	GrisbiAppConf *a_conf;
+	GrisbiWinEtat *w_etat;
+
+	a_conf = (GrisbiAppConf *) grisbi_app_get_a_conf ();
+	w_etat = (GrisbiWinEtat *) grisbi_win_get_w_etat ();
+
+	if (segment_is_cold)
+	{
+		/* the segment is loaded if it is not wanted anymore or if new archives can go in it */
+		if (!a_conf->archives_cold_storage || w_etat->crypt_file)
+			gsb_file_archive_segment_load ();
+		else
+		{
+			archives = gsb_file_archive_segment_find_archives ();
+			if (g_hash_table_size (archives))
+				gsb_file_archive_segment_load ();
+			g_hash_table_destroy (archives);
+		}
+	}
+
+	new_segment_filename = gsb_file_archive_segment_get_filename (filename);
+
+	if (segment_is_cold)
+	{
+		/* the transactions are not in memory, the summaries are saved again */
+		if (g_strcmp0 (new_segment_filename, segment_filename))
+			result = gsb_file_archive_segment_copy (new_segment_filename);
+		g_free (new_segment_filename);
+
+		return result;
+	}
+
+	gsb_file_archive_segment_free_summaries ();
+
+	/* the segment is not encrypted, so it is not used with an encrypted file */
+	if (a_conf->archives_cold_storage && !w_etat->crypt_file)
+	{
+		archives = gsb_file_archive_segment_find_archives ();
+		if (g_hash_table_size (archives))
+			segment_archives = archives;
+		else
+			g_hash_table_destroy (archives);
+	}
+
+	if (segment_archives)
+	{
+		gsb_file_archive_segment_make_summaries ();
+		result = gsb_file_save_archive_segment (new_segment_filename, compress);
+	}
+	else if (g_file_test (new_segment_filename, G_FILE_TEST_EXISTS))
+	{
+		/* the file has no segment now */
+		g_remove (new_segment_filename);
+	}
+	g_free (new_segment_filename);
+
+	return result;
+}
+
+/* Local Variables: */
+/* c-basic-offset: 4 */
+/* End: */
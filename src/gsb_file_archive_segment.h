@@ -0,0 +1,53 @@
+#ifndef _GSB_FILE_ARCHIVE_SEGMENT_H
+#define _GSB_FILE_ARCHIVE_SEGMENT_H (1)
+
+#include <glib.h>
+
+/* START_INCLUDE_H */
+#include "gsb_real.h"
+/* END_INCLUDE_H */
+
+/**
+ * \struct
+ * Describe the part of an archive for an account kept in the archive segment
+ */
+typedef struct _ArchiveSegmentSummary	ArchiveSegmentSummary;
+
+struct _ArchiveSegmentSummary
+{
+    gint archive_number;
+    gint account_number;
+
+    /* balance of the archive for the account and number of transactions of its store */
+    GsbReal balance;
+    gint nb_transactions;
+
+    /* the last date (date or value date) and the biggest number of the transactions */
+    GDate *last_date;
+    gint last_number;
+};
+
+
+/* START_DECLARATION */
+void		gsb_file_archive_segment_add_stores				(void);
+void		gsb_file_archive_segment_add_summary			(gint archive_number,
+															 gint account_number,
+															 GsbReal balance,
+															 gint nb_transactions,
+															 const GDate *last_date,
+															 gint last_number);
+gboolean	gsb_file_archive_segment_contains_archive		(gint archive_number);
+GsbReal		gsb_file_archive_segment_get_account_balance	(gint account_number);
+gchar *		gsb_file_archive_segment_get_filename			(const gchar *filename);
+gint		gsb_file_archive_segment_get_last_number		(void);
+GSList *	gsb_file_archive_segment_get_summaries_list		(void);
+void		gsb_file_archive_segment_init_variables			(void);
+gboolean	gsb_file_archive_segment_is_cold				(void);
+gboolean	gsb_file_archive_segment_load					(void);
+gboolean	gsb_file_archive_segment_load_before_date		(gint account_number,
+															 const GDate *date);
+gboolean	gsb_file_archive_segment_save					(const gchar *filename,
+															 gboolean compress);
+void		gsb_file_archive_segment_set_filename			(const gchar *filename);
+/* END_DECLARATION */
+#endif
@@ -67,6 +67,7 @@
 #include "gsb_data_transaction.h"
 #include "gsb_dirs.h"
 #include "gsb_file.h"
+#include "gsb_file_archive_segment.h"
 #include "gsb_file_util.h"
 #include "gsb_locale.h"
 #include "gsb_real.h"
@@ -763,6 +764,98 @@ static void gsb_file_load_archive_part (const gchar **attribute_names,
     while (attribute_names[i]);
 }
 
+/**
+ * load the summary of an archive for an account whose transactions
+ * are in the archive segment
+ *
+ * \param attribute_names
+ * \param attribute_values
+ *
+ * \return
+ **/
+static void gsb_file_load_archive_segment_part (const gchar **attribute_names,
+												const gchar **attribute_values)
+{
+    gint i=0;
+    gint archive_number = 0;
+    gint account_number = 0;
+    gint nb_transactions = 0;
+    gint last_number = 0;
+    GsbReal balance = null_real;
+    GDate *last_date = NULL;
+
+    if (!attribute_names[i])
+    return;
+
+    do
+    {
+    /* we test at the beginning if the attribute_value is NULL, if yes, go to the next */
+    if (!strcmp (attribute_values[i], "(null)"))
+    {
+        i++;
+        continue;
+    }
+
+    if (!strcmp (attribute_names[i], "Ar"))
+    {
+        archive_number = utils_str_atoi (attribute_values[i]);
+        i++;
+        continue;
+    }
+
+    if (!strcmp (attribute_names[i], "Ac"))
+    {
+        account_number = utils_str_atoi (attribute_values[i]);
+        i++;
+        continue;
+    }
+
+    if (!strcmp (attribute_names[i], "Ba"))
+    {
+        balance = gsb_real_safe_real_from_string (attribute_values[i]);
+        i++;
+        continue;
+    }
+
+    if (!strcmp (attribute_names[i], "Nb"))
+    {
+        nb_transactions = utils_str_atoi (attribute_values[i]);
+        i++;
+        continue;
+    }
+
+    if (!strcmp (attribute_names[i], "Ld"))
+    {
+        if (last_date)
+            g_date_free (last_date);
+        last_date = gsb_parse_date_string_safe (attribute_values[i]);
+        i++;
+        continue;
+    }
+
+    if (!strcmp (attribute_names[i], "Ln"))
+    {
+        last_number = utils_str_atoi (attribute_values[i]);
+        i++;
+        continue;
+    }
+
+    /* normally, shouldn't come here */
+    i++;
+    }
+    while (attribute_names[i]);
+
+    if (archive_number && account_number)
+        gsb_file_archive_segment_add_summary (archive_number,
+                                              account_number,
+                                              balance,
+                                              nb_transactions,
+                                              last_date,
+                                              last_number);
+    if (last_date)
+        g_date_free (last_date);
+}
+
 /**
  * load the banks in the grisbi file
  *
@@ -3775,6 +3868,11 @@ static void gsb_file_load_start_element (GMarkupParseContext *context,
                 gsb_file_load_archive_part (attribute_names, attribute_values);
             }
 
+            else if (!strcmp (element_name, "Archive_segment"))
+            {
+                gsb_file_load_archive_segment_part (attribute_names, attribute_values);
+            }
+
             else if (!strcmp (element_name, "Amount_comparison"))
             {
                 gsb_file_load_amount_comparison_part (attribute_names, attribute_values);
@@ -3985,6 +4083,44 @@ static void gsb_file_load_start_element (GMarkupParseContext *context,
     }
 }
 
+/**
+ * called for each new element in the archive segment,
+ * it contains only transactions. Only the transactions of the archives
+ * with a summary in the grisbi file are loaded, the others are in the grisbi file
+ *
+ * \param
+ * \param
+ * \param
+ * \param
+ * \param
+ * \param
+ *
+ * \return
+ **/
+static void gsb_file_load_archive_segment_start_element (GMarkupParseContext *context,
+														 const gchar *element_name,
+														 const gchar **attribute_names,
+														 const gchar **attribute_values,
+														 gpointer user_data,
+														 GError **error)
+{
+    gint i;
+
+    if (strcmp (element_name, "Transaction"))
+        return;
+
+    for (i = 0; attribute_names[i]; i++)
+    {
+        if (!strcmp (attribute_names[i], "Ar"))
+        {
+            if (gsb_file_archive_segment_contains_archive (utils_str_atoi (attribute_values[i])))
+                gsb_file_load_transactions_part (attribute_names, attribute_values);
+
+            return;
+        }
+    }
+}
+
 /******************************************************************************/
 /* Public Methods                                                             */
 /******************************************************************************/
@@ -4146,6 +4282,9 @@ gboolean gsb_file_load_open_file (const gchar *filename)
 		if (!download_tmp_values.download_ok)
 			return FALSE;
 
+		/* the archived transactions out of the file are loaded from there when needed */
+		gsb_file_archive_segment_set_filename (filename);
+
 		if (w_run->account_number_is_0)
 		{
 			gsb_data_account_renum_account_number_0 (filename);
@@ -4215,6 +4354,59 @@ gboolean gsb_file_load_open_file (const gchar *filename)
     return TRUE;
 }
 
+/**
+ * load the transactions of the archive segment of the opened file
+ * the file is checked first, so the transactions are loaded all or none
+ *
+ * \param filename the name of the archive segment
+ *
+ * \return TRUE if ok
+ **/
+gboolean gsb_file_load_archive_segment (const gchar *filename)
+{
+    GMarkupParser *markup_parser;
+    GMarkupParseContext *context;
+    gchar *file_content;
+    gulong length;
+    gboolean result;
+
+    devel_debug (filename);
+
+    if (!gsb_file_util_get_contents (filename, &file_content, &length))
+        return FALSE;
+
+    if (!g_strstr_len (file_content, 64, "<Grisbi_archives>")
+        || !g_utf8_validate (file_content, length, NULL))
+    {
+        g_free (file_content);
+        return FALSE;
+    }
+
+    /* first pass without handler to check the file */
+    markup_parser = g_malloc0 (sizeof (GMarkupParser));
+    context = g_markup_parse_context_new (markup_parser, 0, NULL, NULL);
+    result = g_markup_parse_context_parse (context, file_content, strlen (file_content), NULL)
+        && g_markup_parse_context_end_parse (context, NULL);
+    g_markup_parse_context_free (context);
+
+    if (result)
+    {
+        markup_parser->start_element = (void *) gsb_file_load_archive_segment_start_element;
+        markup_parser->error = (void *) gsb_file_load_error;
+
+        context = g_markup_parse_context_new (markup_parser, 0, NULL, NULL);
+        gsb_data_transaction_begin_archived_loading ();
+        g_markup_parse_context_parse (context, file_content, strlen (file_content), NULL);
+        gsb_data_transaction_end_archived_loading ();
+        g_markup_parse_context_free (context);
+    }
+
+    g_free (markup_parser);
+    g_free (file_content);
+
+    return result;
+}
+
 /**
  * load the amount comparaison structure in the grisbi file
  *
@@ -10,6 +10,7 @@
 /* START_DECLARATION */
 void        gsb_file_load_amount_comparison_part	(const gchar **attribute_names,
 													 const gchar **attribute_values);
+gboolean	gsb_file_load_archive_segment			(const gchar *filename);
 void        gsb_file_load_budgetary_part            (const gchar **attribute_names,
 													 const gchar **attribute_values);
 void        gsb_file_load_category_part				(const gchar **attribute_names,
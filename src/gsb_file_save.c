@@ -69,6 +69,7 @@
 #include "gsb_data_transaction.h"
 #include "gsb_dirs.h"
 #include "gsb_file.h"
+#include "gsb_file_archive_segment.h"
 #include "gsb_locale.h"
 #include "gsb_real.h"
 #include "gsb_rgba.h"
@@ -1542,6 +1543,93 @@ static gulong gsb_file_save_scheduled_part (gulong iterator,
 	return iterator;
 }
 
+/**
+ * return the line of a transaction in the file
+ *
+ * \param transaction_number
+ * \param account_number
+ * \param transaction_archive_number the archive number to save for the transaction
+ *
+ * \return a newly allocated string
+ **/
+static gchar *gsb_file_save_transaction_line (gint transaction_number,
+											  gint account_number,
+											  gint transaction_archive_number)
+{
+	gchar *new_string;
+	gchar *amount;
+	gchar *exchange_rate;
+	gchar *exchange_fees;
+	gchar *date;
+	gchar *value_date;
+	gint floating_point;
+	gint floating_fees;
+
+	/* set the reals. On met en forme le résultat pour avoir une cohérence dans les montants
+	 * enregistrés dans le fichier à valider */
+	floating_point = gsb_data_transaction_get_currency_floating_point (transaction_number);
+	amount = gsb_real_safe_real_to_string (gsb_data_transaction_get_amount (transaction_number),
+										   floating_point);
+	exchange_rate = gsb_real_safe_real_to_string (gsb_data_transaction_get_exchange_rate
+												  (transaction_number),
+												  -1);
+	floating_fees = gsb_data_account_get_currency_floating_point (gsb_data_transaction_get_account_number
+																  (transaction_number));
+	exchange_fees = gsb_real_safe_real_to_string (gsb_data_transaction_get_exchange_fees
+												  (transaction_number),
+												  floating_fees );
+
+	/* set the dates */
+	date = gsb_format_gdate_safe (gsb_data_transaction_get_date (transaction_number));
+	value_date = gsb_format_gdate_safe (gsb_data_transaction_get_value_date (transaction_number));
+
+	/* now we can fill the file content */
+	new_string = g_markup_printf_escaped ("\t<Transaction Ac=\"%d\" Nb=\"%d\" Id=\"%s\" Dt=\"%s\" "
+										  "Dv=\"%s\" Cu=\"%d\" Am=\"%s\" Exb=\"%d\" Exr=\"%s\" Exf=\"%s\" "
+										  "Pa=\"%d\" Ca=\"%d\" Sca=\"%d\" Br=\"%d\" No=\"%s\" Pn=\"%d\" "
+										  "Pc=\"%s\" Ma=\"%d\" Ar=\"%d\" Au=\"%d\" Re=\"%d\" Fi=\"%d\" "
+										  "Bu=\"%d\" Sbu=\"%d\" Vo=\"%s\" Ba=\"%s\" Trt=\"%d\" Mo=\"%d\" />\n",
+										  account_number,
+										  transaction_number,
+										  my_safe_null_str(gsb_data_transaction_get_transaction_id (transaction_number)),
+										  my_safe_null_str(date),
+										  my_safe_null_str(value_date),
+										  gsb_data_transaction_get_currency_number (transaction_number),
+										  my_safe_null_str(amount),
+										  gsb_data_transaction_get_change_between (transaction_number),
+										  my_safe_null_str(exchange_rate),
+										  my_safe_null_str(exchange_fees),
+										  gsb_data_transaction_get_payee_number (transaction_number),
+										  gsb_data_transaction_get_category_number (transaction_number),
+										  gsb_data_transaction_get_sub_category_number (transaction_number),
+										  gsb_data_transaction_get_split_of_transaction (transaction_number),
+										  my_safe_null_str(gsb_data_transaction_get_notes
+														   (transaction_number)),
+										  gsb_data_transaction_get_method_of_payment_number (transaction_number),
+										  my_safe_null_str(gsb_data_transaction_get_method_of_payment_content
+														   (transaction_number)),
+										  gsb_data_transaction_get_marked_transaction (transaction_number),
+										  transaction_archive_number,
+										  gsb_data_transaction_get_automatic_transaction (transaction_number),
+										  gsb_data_transaction_get_reconcile_number (transaction_number),
+										  gsb_data_transaction_get_financial_year_number (transaction_number),
+										  gsb_data_transaction_get_budgetary_number (transaction_number),
+										  gsb_data_transaction_get_sub_budgetary_number (transaction_number),
+										  my_safe_null_str(gsb_data_transaction_get_voucher (transaction_number)),
+										  my_safe_null_str(gsb_data_transaction_get_bank_references
+														   (transaction_number)),
+										  gsb_data_transaction_get_contra_transaction_number (transaction_number),
+										  gsb_data_transaction_get_mother_transaction_number (transaction_number));
+
+	g_free (amount);
+	g_free (exchange_rate);
+	g_free (exchange_fees);
+	g_free (date);
+	g_free (value_date);
+
+	return new_string;
+}
+
 /**
  * save the transactions
  *
@@ -1559,21 +1647,18 @@ static gulong gsb_file_save_transaction_part (gulong iterator,
 {
 	GSList *list_tmp;
 
-	list_tmp = gsb_data_transaction_get_complete_transactions_list ();
+	/* the transactions of the archive segment are saved in the segment */
+	if (archive_number)
+		list_tmp = gsb_data_transaction_get_complete_transactions_list ();
+	else
+		list_tmp = gsb_data_transaction_get_loaded_transactions_list ();
 
 	while (list_tmp)
 	{
 		gint transaction_number;
 		gchar *new_string;
-		gchar *amount;
-		gchar *exchange_rate;
-		gchar *exchange_fees;
-		gchar *date;
-		gchar *value_date;
 		gint account_number;
 		gint transaction_archive_number;
-		gint floating_point;
-		gint floating_fees;
 
 		transaction_number = gsb_data_transaction_get_transaction_number (list_tmp->data);
 
@@ -1608,68 +1693,74 @@ static gulong gsb_file_save_transaction_part (gulong iterator,
 			 * we set its archive number to 0, to show it when we open an archive */
 			transaction_archive_number = 0;
 		}
+		else if (gsb_file_archive_segment_contains_archive (transaction_archive_number))
+		{
+			list_tmp = list_tmp->next;
+			continue;
+		}
 
-		/* set the reals. On met en forme le résultat pour avoir une cohérence dans les montants
-		 * enregistrés dans le fichier à valider */
-		floating_point = gsb_data_transaction_get_currency_floating_point (transaction_number);
-		amount = gsb_real_safe_real_to_string (gsb_data_transaction_get_amount (transaction_number),
-											   floating_point);
-		exchange_rate = gsb_real_safe_real_to_string (gsb_data_transaction_get_exchange_rate
-													  (transaction_number),
-													  -1);
-		floating_fees = gsb_data_account_get_currency_floating_point (gsb_data_transaction_get_account_number
-																	  (transaction_number));
-		exchange_fees = gsb_real_safe_real_to_string (gsb_data_transaction_get_exchange_fees
-													  (transaction_number),
-													  floating_fees );
+		new_string = gsb_file_save_transaction_line (transaction_number,
+													 account_number,
+													 transaction_archive_number);
 
-		/* set the dates */
-		date = gsb_format_gdate_safe (gsb_data_transaction_get_date (transaction_number));
-		value_date = gsb_format_gdate_safe (gsb_data_transaction_get_value_date (transaction_number));
+		/* append the new string to the file content and take the new iterator */
+		iterator = gsb_file_save_append_part (iterator,
+											  length_calculated,
+											  file_content,
+											  new_string);
+		g_free(new_string);
 
-		/* now we can fill the file content */
-		new_string = g_markup_printf_escaped ("\t<Transaction Ac=\"%d\" Nb=\"%d\" Id=\"%s\" Dt=\"%s\" "
-											  "Dv=\"%s\" Cu=\"%d\" Am=\"%s\" Exb=\"%d\" Exr=\"%s\" Exf=\"%s\" "
-											  "Pa=\"%d\" Ca=\"%d\" Sca=\"%d\" Br=\"%d\" No=\"%s\" Pn=\"%d\" "
-											  "Pc=\"%s\" Ma=\"%d\" Ar=\"%d\" Au=\"%d\" Re=\"%d\" Fi=\"%d\" "
-											  "Bu=\"%d\" Sbu=\"%d\" Vo=\"%s\" Ba=\"%s\" Trt=\"%d\" Mo=\"%d\" />\n",
-											  account_number,
-											  transaction_number,
-											  my_safe_null_str(gsb_data_transaction_get_transaction_id (transaction_number)),
-											  my_safe_null_str(date),
-											  my_safe_null_str(value_date),
-											  gsb_data_transaction_get_currency_number (transaction_number),
-											  my_safe_null_str(amount),
-											  gsb_data_transaction_get_change_between (transaction_number),
-											  my_safe_null_str(exchange_rate),
-											  my_safe_null_str(exchange_fees),
-											  gsb_data_transaction_get_payee_number (transaction_number),
-											  gsb_data_transaction_get_category_number (transaction_number),
-											  gsb_data_transaction_get_sub_category_number (transaction_number),
-											  gsb_data_transaction_get_split_of_transaction (transaction_number),
-											  my_safe_null_str(gsb_data_transaction_get_notes
-															   (transaction_number)),
-											  gsb_data_transaction_get_method_of_payment_number (transaction_number),
-											  my_safe_null_str(gsb_data_transaction_get_method_of_payment_content
-															   (transaction_number)),
-											  gsb_data_transaction_get_marked_transaction (transaction_number),
-											  transaction_archive_number,
-											  gsb_data_transaction_get_automatic_transaction (transaction_number),
-											  gsb_data_transaction_get_reconcile_number (transaction_number),
-											  gsb_data_transaction_get_financial_year_number (transaction_number),
-											  gsb_data_transaction_get_budgetary_number (transaction_number),
-											  gsb_data_transaction_get_sub_budgetary_number (transaction_number),
-											  my_safe_null_str(gsb_data_transaction_get_voucher (transaction_number)),
-											  my_safe_null_str(gsb_data_transaction_get_bank_references
-															   (transaction_number)),
-											  gsb_data_transaction_get_contra_transaction_number (transaction_number),
-											  gsb_data_transaction_get_mother_transaction_number (transaction_number));
+		list_tmp = list_tmp->next;
+	}
 
-		g_free (amount);
-		g_free (exchange_rate);
-		g_free (exchange_fees);
-		g_free (date);
-		g_free (value_date);
+	/* and return the new iterator */
+	return iterator;
+}
+
+/**
+ * save the summaries of the archives whose transactions are in the archive segment
+ *
+ * \param iterator the current iterator
+ * \param length_calculated a pointer to the variable lengh_calculated
+ * \param file_content a pointer to the variable file_content
+ *
+ * \return the new iterator
+ **/
+static gulong gsb_file_save_archive_segment_part (gulong iterator,
+												  gulong *length_calculated,
+												  gchar **file_content)
+{
+	GSList *list_tmp;
+
+	list_tmp = gsb_file_archive_segment_get_summaries_list ();
+
+	while (list_tmp)
+	{
+		ArchiveSegmentSummary *summary;
+		gchar *new_string;
+		gchar *balance;
+		gchar *last_date;
+
+		summary = list_tmp->data;
+
+		balance = gsb_real_safe_real_to_string (summary->balance,
+												gsb_data_account_get_currency_floating_point
+												(summary->account_number));
+		last_date = gsb_format_gdate_safe (summary->last_date);
+
+		/* now we can fill the file content */
+		new_string = g_markup_printf_escaped ("\t<Archive_segment Ar=\"%d\" Ac=\"%d\" Ba=\"%s\" "
+											  "Nb=\"%d\" Ld=\"%s\" Ln=\"%d\" />\n",
+											  summary->archive_number,
+											  summary->account_number,
+											  my_safe_null_str(balance),
+											  summary->nb_transactions,
+											  my_safe_null_str(last_date),
+											  summary->last_number);
+
+		g_free (balance);
+		if (last_date)
+			g_free (last_date);
 
 		/* append the new string to the file content and take the new iterator */
 		iterator = gsb_file_save_append_part (iterator,
@@ -1685,6 +1776,79 @@ static gulong gsb_file_save_transaction_part (gulong iterator,
 	return iterator;
 }
 
+/**
+ * write the content of the file on the disk and free it
+ * i didn't succeed to save a "proper" file with zlib without compression,
+ * it always append some extra characters, so use glib without compression, and
+ * zlib if compression
+ *
+ * \param filename the name of the file
+ * \param file_content the content, freed here
+ * \param length the length of the content
+ * \param compress TRUE if we want to compress the file
+ *
+ * \return TRUE : ok, FALSE : problem
+ **/
+static gboolean gsb_file_save_write_content (const gchar *filename,
+											 gchar *file_content,
+											 gulong length,
+											 gboolean compress)
+{
+	if (compress)
+	{
+		gzFile grisbi_file;
+		gchar *os_filename;
+
+#ifdef G_OS_WIN32
+		os_filename = g_locale_from_utf8(filename, -1, NULL, NULL, NULL);
+#else
+		os_filename = strdup(filename);
+#endif
+		grisbi_file = gzopen (os_filename, "wb9");
+		g_free (os_filename);
+
+		if (!grisbi_file
+		 ||
+		 !gzwrite (grisbi_file, file_content, (unsigned)length))
+		{
+			gchar* tmpstr = g_strdup_printf (_("Cannot save file '%s': %s"),
+				              filename,
+                              g_strerror(errno));
+            dialogue_error (tmpstr);
+            g_free (tmpstr);
+            g_free (file_content);
+            if (grisbi_file)
+                gzclose (grisbi_file);
+
+            return (FALSE);
+        }
+
+        g_free (file_content);
+        gzclose (grisbi_file);
+    }
+    else
+    {
+        GError *error = NULL;
+		gboolean ret;
+
+		ret = g_file_set_contents (filename, file_content, length, &error);
+		g_free (file_content);
+		if (!ret)
+        {
+            gchar* tmpstr = g_strdup_printf (_("Cannot save file '%s': %s"),
+                              filename,
+                              error->message);
+            dialogue_error (tmpstr);
+            g_free (tmpstr);
+            g_error_free (error);
+
+			return (FALSE);
+        }
+    }
+
+    return (TRUE);
+}
+
 /******************************************************************************/
 /* Public functions                                                           */
 /******************************************************************************/
@@ -1739,6 +1903,10 @@ gboolean gsb_file_save_save_file (const gchar *filename,
 	w_etat = grisbi_win_get_w_etat ();
 	w_run = (GrisbiWinRun *) grisbi_win_get_w_run ();
 
+	/* the archive segment is saved first, the file gives its content */
+	if (!archive_number && !gsb_file_archive_segment_save (filename, compress))
+		return FALSE;
+
 	if (g_file_test (filename, G_FILE_TEST_EXISTS))
 	{
 		/* the file exists, we need to get the chmod values because gtk will overwrite it */
@@ -1762,7 +1930,7 @@ gboolean gsb_file_save_save_file (const gchar *filename,
 
 	length_calculated = general_part
 	+ account_part * gsb_data_account_get_number_of_accounts ()
-	+ transaction_part * g_slist_length (gsb_data_transaction_get_complete_transactions_list ())
+	+ transaction_part * g_slist_length (gsb_data_transaction_get_loaded_transactions_list ())
 	+ party_part * g_slist_length (gsb_data_payee_get_payees_list ())
 	+ category_part * g_slist_length (gsb_data_category_get_categories_list ())
 	+ budgetary_part * g_slist_length (gsb_data_budget_get_budgets_list ())
@@ -1852,9 +2020,15 @@ gboolean gsb_file_save_save_file (const gchar *filename,
 
 	/* if we export an archive, no archive information */
 	if (!archive_number)
-	iterator = gsb_file_save_archive_part (iterator,
-						&length_calculated,
-						&file_content);
+	{
+		iterator = gsb_file_save_archive_part (iterator,
+							&length_calculated,
+							&file_content);
+
+		iterator = gsb_file_save_archive_segment_part (iterator,
+							&length_calculated,
+							&file_content);
+	}
 
 	iterator = gsb_file_save_reconcile_part (iterator,
 						  &length_calculated,
@@ -1918,60 +2092,8 @@ gboolean gsb_file_save_save_file (const gchar *filename,
 	}
 
 	/* the file is in memory, we can save it */
-	/* i didn't succeed to save a "proper" file with zlib without compression,
-	 * it always append some extra characters, so use glib without compression, and
-	 * zlib if compression */
-	if (compress)
-	{
-		gzFile grisbi_file;
-		gchar *os_filename;
-
-#ifdef G_OS_WIN32
-		os_filename = g_locale_from_utf8(filename, -1, NULL, NULL, NULL);
-#else
-		os_filename = strdup(filename);
-#endif
-		grisbi_file = gzopen (os_filename, "wb9");
-		g_free (os_filename);
-
-		if (!grisbi_file
-		 ||
-		 !gzwrite (grisbi_file, file_content, (unsigned)iterator))
-		{
-			gchar* tmpstr = g_strdup_printf (_("Cannot save file '%s': %s"),
-				              filename,
-                              g_strerror(errno));
-            dialogue_error (tmpstr);
-            g_free (tmpstr);
-            g_free (file_content);
-            if (grisbi_file)
-                gzclose (grisbi_file);
-
-            return (FALSE);
-        }
-
-        g_free (file_content);
-        gzclose (grisbi_file);
-    }
-    else
-    {
-        GError *error = NULL;
-		gboolean ret;
-
-		ret = g_file_set_contents (filename, file_content, iterator, &error);
-		g_free (file_content);
-		if (!ret)
-        {
-            gchar* tmpstr = g_strdup_printf (_("Cannot save file '%s': %s"),
-                              filename,
-                              error->message);
-            dialogue_error (tmpstr);
-            g_free (tmpstr);
-            g_error_free (error);
-
-			return (FALSE);
-        }
-    }
+	if (!gsb_file_save_write_content (filename, file_content, iterator, compress))
+		return FALSE;
 
     /* if it's a new file, we set the permission */
     if (do_chmod)
@@ -2006,6 +2128,74 @@ gboolean gsb_file_save_save_file (const gchar *filename,
     return (TRUE);
 }
 
+/**
+ * save the archive segment of the grisbi file : the transactions
+ * of the archives kept out of memory, in the same format as the grisbi file
+ *
+ * \param filename the name of the archive segment
+ * \param compress TRUE if we want to compress the file
+ *
+ * \return TRUE : ok, FALSE : problem
+ **/
+gboolean gsb_file_save_archive_segment (const gchar *filename,
+										gboolean compress)
+{
+	GSList *list_tmp;
+	gulong iterator;
+	gulong length_calculated;
+	gchar *file_content;
+	gint transaction_part = 350;
+
+	devel_debug (filename);
+
+	length_calculated = 64 + transaction_part * g_slist_length (gsb_data_transaction_get_loaded_transactions_list ());
+
+	iterator = 0;
+	file_content = g_malloc0 (length_calculated * sizeof (gchar));
+
+	iterator = gsb_file_save_append_part (iterator,
+										  &length_calculated,
+										  &file_content,
+										  "<?xml version=\"1.0\"?>\n<Grisbi_archives>\n");
+
+	list_tmp = gsb_data_transaction_get_loaded_transactions_list ();
+	while (list_tmp)
+	{
+		gint transaction_number;
+		gint transaction_archive_number;
+		gchar *new_string;
+
+		transaction_number = gsb_data_transaction_get_transaction_number (list_tmp->data);
+		transaction_archive_number = gsb_data_transaction_get_archive_number (transaction_number);
+		list_tmp = list_tmp->next;
+
+		if (!gsb_file_archive_segment_contains_archive (transaction_archive_number))
+			continue;
+
+		new_string = gsb_file_save_transaction_line (transaction_number,
+													 gsb_data_transaction_get_account_number (transaction_number),
+													 transaction_archive_number);
+		iterator = gsb_file_save_append_part (iterator,
+											  &length_calculated,
+											  &file_content,
+											  new_string);
+		g_free (new_string);
+	}
+
+	iterator = gsb_file_save_append_part (iterator,
+										  &length_calculated,
+										  &file_content,
+										  "</Grisbi_archives>");
+
+	if (!gsb_file_save_write_content (filename, file_content, iterator, compress))
+		return FALSE;
+
+	/* the segment has the same content as the grisbi file, only the user can see it */
+	(void)chmod (filename, S_IRUSR | S_IWUSR);
+
+	return TRUE;
+}
+
 /**
  * add the string given in arg and
  * check if we don't go throw the upper limit of file_content
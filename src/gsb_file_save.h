@@ -12,6 +12,8 @@ gulong			gsb_file_save_append_part		(gulong iterator,
 												 gulong *length_calculated,
                         						 gchar **file_content,
                         						 const gchar *new_string);
+gboolean		gsb_file_save_archive_segment	(const gchar *filename,
+												 gboolean compress);
 gulong			gsb_file_save_budgetary_part	(gulong iterator,
                         						 gulong *length_calculated,
                         						 gchar **file_content);
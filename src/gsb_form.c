@@ -37,6 +37,7 @@
 #include "accueil.h"
 #include "bet_data.h"
 #include "bet_finance_ui.h"
+#include "bet_tab.h"
 #include "dialog.h"
 #include "grisbi_app.h"
 #include "grisbi_prefs.h"
@@ -3453,8 +3454,11 @@ gboolean gsb_form_finish_edition (void)
     /* as we modify or create a transaction, we invalidate the current report */
     gsb_report_set_current (0);
 
-    /* force the update module budget */
-    gsb_data_account_set_bet_maj (account_number, BET_MAJ_ALL);
+    /* force the update module budget, a scheduled transaction changes only its lines */
+    if (is_transaction)
+        gsb_data_account_set_bet_maj (account_number, BET_MAJ_ALL);
+    else
+        bet_array_mark_source_changed (account_number, SPP_ORIGIN_SCHEDULED, transaction_number);
 
     gsb_file_set_modified (TRUE);
 
@@ -229,42 +229,28 @@ gint gsb_form_transactions_look_for_last_payee (gint no_payee,
 												gint no_new_transaction,
 												gint account_number)
 {
-	GSList *list_tmp_transactions;
-	gint last_transaction_with_payee_in_account = 0;
-	gint last_transaction_with_payee_not_in_account = 0;
+	gint last_transaction_with_payee;
 	GrisbiAppConf *a_conf;
 
 	a_conf = (GrisbiAppConf *) grisbi_app_get_a_conf ();
-	list_tmp_transactions = gsb_data_transaction_get_complete_transactions_list ();
-
-	while (list_tmp_transactions)
-	{
-		gint transaction_number_tmp;
-
-		transaction_number_tmp = gsb_data_transaction_get_transaction_number (list_tmp_transactions->data);
-
-		if (gsb_data_transaction_get_payee_number (transaction_number_tmp) == no_payee
-			&& transaction_number_tmp != no_new_transaction
-			&& !gsb_data_transaction_get_mother_transaction_number (transaction_number_tmp))
-		{
-			/* we are on a transaction with the same payee, it's also a split, so we keep it */
-			if (gsb_data_transaction_get_account_number (transaction_number_tmp) == account_number)
-				last_transaction_with_payee_in_account = transaction_number_tmp;
-			else
-				last_transaction_with_payee_not_in_account = transaction_number_tmp;
-		}
-		list_tmp_transactions = list_tmp_transactions->next;
-	}
 
-	if (last_transaction_with_payee_in_account)
-		return last_transaction_with_payee_in_account;
+	/* the data layer keeps the last transaction of each payee per account */
+	last_transaction_with_payee = gsb_data_transaction_get_last_transaction_with_payee (no_payee,
+																						account_number,
+																						TRUE,
+																						no_new_transaction);
+	if (last_transaction_with_payee)
+		return last_transaction_with_payee;
 
 	/* if we don't want to complete with a transaction in another account,
 	 * go away here */
 	if (a_conf->limit_completion_to_current_account)
 		return 0;
 
-	return last_transaction_with_payee_not_in_account;
+	return gsb_data_transaction_get_last_transaction_with_payee (no_payee,
+																 account_number,
+																 FALSE,
+																 no_new_transaction);
 }
 
 /**
@@ -33,6 +33,9 @@
 static struct lconv *_locale = NULL;
 static gchar *langue;
 
+/* incremented each time the monetary separators change */
+static guint locale_serial = 0;
+
 /******************************************************************************/
 /* Public functions                                                           */
 /******************************************************************************/
@@ -103,6 +106,8 @@ void gsb_locale_init_lconv_struct (void)
 	_locale->p_sep_by_space    = locale->p_sep_by_space;
 	_locale->n_cs_precedes     = locale->n_cs_precedes;
 	_locale->n_sep_by_space    = locale->n_sep_by_space;
+
+	locale_serial++;
 }
 
 /**
@@ -163,6 +168,7 @@ void gsb_locale_set_mon_decimal_point (const gchar *decimal_point)
 {
     g_free (_locale->mon_decimal_point);
     _locale->mon_decimal_point = g_strdup (decimal_point);
+	locale_serial++;
 }
 
 /**
@@ -191,6 +197,20 @@ void gsb_locale_set_mon_thousands_sep (const gchar *thousands_sep)
 		_locale->mon_thousands_sep = NULL;
 	else
 		_locale->mon_thousands_sep = g_strdup (thousands_sep);
+	locale_serial++;
+}
+
+/**
+ * return a number which changes each time the monetary separators
+ * of the locale are modified, so the callers can keep formats built with them
+ *
+ * \param
+ *
+ * \return the serial of the locale
+ **/
+guint gsb_locale_get_serial (void)
+{
+	return locale_serial;
 }
 
 /**
@@ -9,6 +9,7 @@ struct lconv *	gsb_locale_get_locale 				(void);
 gchar *			gsb_locale_get_mon_decimal_point 	(void);
 gchar *			gsb_locale_get_mon_thousands_sep 	(void);
 gchar *			gsb_locale_get_print_locale_var		(void);
+guint			gsb_locale_get_serial				(void);
 void          	gsb_locale_init_language       		(const gchar *new_language);
 void          	gsb_locale_init_lconv_struct	    (void);
 void          	gsb_locale_set_mon_decimal_point 	(const gchar *decimal_point);
@@ -46,6 +46,37 @@
 #endif /*G_OS_WIN32 */
 
 /*START_STATIC*/
+/** the powers of 10 which fit in a gint64 */
+#define GSB_REAL_POWER_10_MAX 18
+static const gint64 gsb_real_power_10[GSB_REAL_POWER_10_MAX + 1] =
+{
+	G_GINT64_CONSTANT (1),
+	G_GINT64_CONSTANT (10),
+	G_GINT64_CONSTANT (100),
+	G_GINT64_CONSTANT (1000),
+	G_GINT64_CONSTANT (10000),
+	G_GINT64_CONSTANT (100000),
+	G_GINT64_CONSTANT (1000000),
+	G_GINT64_CONSTANT (10000000),
+	G_GINT64_CONSTANT (100000000),
+	G_GINT64_CONSTANT (1000000000),
+	G_GINT64_CONSTANT (10000000000),
+	G_GINT64_CONSTANT (100000000000),
+	G_GINT64_CONSTANT (1000000000000),
+	G_GINT64_CONSTANT (10000000000000),
+	G_GINT64_CONSTANT (100000000000000),
+	G_GINT64_CONSTANT (1000000000000000),
+	G_GINT64_CONSTANT (10000000000000000),
+	G_GINT64_CONSTANT (100000000000000000),
+	G_GINT64_CONSTANT (1000000000000000000)
+};
+
+/** the biggest mantissa kept by an accumulator */
+#ifdef GSB_REAL_HAVE_INT128
+#define GSB_REAL_WIDE_MAX ((GsbRealWide) G_MAXINT64 * gsb_real_power_10[GSB_REAL_POWER_10_MAX])
+#else
+#define GSB_REAL_WIDE_MAX G_MAXINT64
+#endif
 /*END_STATIC*/
 
 /*START_EXTERN*/
@@ -55,97 +86,145 @@
 /* Private functions                                                          */
 /******************************************************************************/
 /**
- * remplace le tableau gsb_real_power_10[]
+ * retourne 10 puissance exposant à partir du tableau gsb_real_power_10[]
  *
  * \param	exposant
  *
  * \return
  **/
-static glong gsb_real_get_power_10 (gint exponent)
+static gint64 gsb_real_get_power_10 (gint exponent)
 {
-	glong power_10 = 1;
+	if (exponent <= 0)
+		return 1;
+	if (exponent > GSB_REAL_POWER_10_MAX)
+		exponent = GSB_REAL_POWER_10_MAX;
 
-    while (exponent > 0)
-    {
-		power_10 *= 10;
-		exponent--;
-	}
+	return gsb_real_power_10[exponent];
+}
 
-	return power_10;
+/**
+ * check if the sum of 2 mantissas fits in a gint64 without giving G_MININT64,
+ * which is reserved to error_real
+ *
+ * \param mantissa_1
+ * \param mantissa_2
+ *
+ * \return TRUE if mantissa_1 + mantissa_2 can be done without overflow
+ **/
+static inline gboolean gsb_real_raw_add_is_safe (gint64 mantissa_1,
+												 gint64 mantissa_2)
+{
+	if (mantissa_2 >= 0)
+		return mantissa_1 <= G_MAXINT64 - mantissa_2;
+	else
+		return mantissa_1 > G_MININT64 - mantissa_2;
 }
 
 /**
- * ajoute le séparateur des milliers passé en paramètre
+ * multiply the mantissa by 10^exponent_diff in the wide type
+ * with 128 bits, exponent_diff <= GSB_REAL_POWER_10_MAX can't overflow
  *
- * \param string to modify WARNING string is free
- * \param
+ * \param mantissa
+ * \param exponent_diff
  *
- * \return a new allocated sring
+ * \return the rescaled mantissa
  **/
-static gchar *gsb_real_add_thousands_sep (gchar *str_number,
-										  const gchar *thousands_sep)
+static inline GsbRealWide gsb_real_wide_rescale (gint64 mantissa,
+												 gint exponent_diff)
 {
-    gchar *mon_thousands_sep;
-    gchar *result = NULL;
-    gchar *ptr;
-    gchar *dest;
-    gchar *tmp_ptr;
-    gchar **tab_str = NULL;
-    gssize nbre_char;
-    gint i = 0;
-    gint j = 0;
-    gint sep = 0;
-    gssize longueur;
-
-    if (thousands_sep == NULL)
-        return str_number;
-
-    nbre_char = strlen (str_number);
-    g_strreverse (str_number);
-    ptr = str_number;
-
-    if ((longueur = strlen (thousands_sep)) == 1)
-        mon_thousands_sep = g_strndup (thousands_sep, 1);
-    else
-        mon_thousands_sep = g_strndup ("&", 1);
+	return (GsbRealWide) mantissa * gsb_real_get_power_10 (exponent_diff);
+}
 
-    dest = g_malloc0 (128 * sizeof (gchar));
-    tmp_ptr = dest;
+/**
+ * build a GsbReal from a wide mantissa,
+ * the exponent is reduced only if the mantissa doesn't fit in a gint64
+ * (exactly if possible, else with truncation)
+ *
+ * \param mantissa
+ * \param exponent
+ *
+ * \return the GsbReal or error_real if the number can't be represented
+ **/
+static GsbReal gsb_real_wide_to_real (GsbRealWide mantissa,
+									  gint exponent)
+{
+	GsbReal number;
 
-    while (i < nbre_char)
-    {
-        dest[i+sep] = ptr[0];
+	while ((mantissa > G_MAXINT64 || mantissa <= G_MININT64) && exponent > 0)
+	{
+		mantissa = mantissa / 10;
+		exponent--;
+	}
 
-        ptr++;
-        tmp_ptr++;
-        i++;
-        j++;
-        if (i < nbre_char && j == 3)
-        {
-            tmp_ptr = g_stpcpy (tmp_ptr, mon_thousands_sep);
-            j = 0;
-            sep++;
-        }
-    };
+	if (mantissa > G_MAXINT64 || mantissa <= G_MININT64)
+		return error_real;
 
-    result = g_strndup (dest, nbre_char + sep);
-    g_strreverse (result);
+	number.mantissa = (gint64) mantissa;
+	number.exponent = exponent;
 
-    /* on met le bon séparateur si necessaire */
-    if (longueur > 1)
-    {
-        tab_str = g_strsplit (result, "&", 0);
-        g_free (result);
+	return number;
+}
 
-        result = g_strjoinv (thousands_sep, tab_str);
-        g_strfreev (tab_str);
-    }
+/**
+ * copy a separator or a currency symbol in a field of GsbRealFormat
+ * a too long string is cut at the end of its last complete utf8 character
+ *
+ * \param field		the field of the format
+ * \param field_size	sizeof the field
+ * \param string		the string to copy, can be NULL
+ * \param space_before	TRUE to add a space before the string
+ * \param space_after	TRUE to add a space after the string
+ *
+ * \return the length of the field
+ **/
+static gsize gsb_real_format_set_field (gchar *field,
+										gsize field_size,
+										const gchar *string,
+										gboolean space_before,
+										gboolean space_after)
+{
+	gsize len = 0;
+	gsize string_len;
 
-    g_free (mon_thousands_sep);
-    g_free (str_number);
-    g_free (dest);
+	if (space_before)
+		field[len++] = ' ';
 
-    return result;
+	string_len = string ? strlen (string) : 0;
+	if (len + string_len + (space_after ? 1 : 0) >= field_size)
+	{
+		string_len = field_size - len - (space_after ? 2 : 1);
+		while (string_len > 0 && ((guchar) string[string_len] & 0xC0) == 0x80)
+			string_len--;
+	}
+	if (string_len)
+		memcpy (field + len, string, string_len);
+	len += string_len;
+
+	if (space_after)
+		field[len++] = ' ';
+	field[len] = 0;
+
+	return len;
+}
+
+/**
+ * write a string before the position ptr, used to build the number
+ * from the end of the buffer
+ *
+ * \param ptr		the current beginning of the string
+ * \param string
+ * \param len		length of string
+ *
+ * \return the new beginning of the string
+ **/
+static inline gchar *gsb_real_format_prepend (gchar *ptr,
+											  const gchar *string,
+											  gsize len)
+{
+	ptr -= len;
+	memcpy (ptr, string, len);
+
+	return ptr;
 }
 
 /**
@@ -246,80 +325,170 @@ static GsbReal gsb_real_double_to_real_add_exponent (gdouble number,
 static gboolean gsb_real_grow_exponent (GsbReal *num,
 										gint target_exponent)
 {
-    gint64 mantissa = num->mantissa;
-    gint exponent = num->exponent;
-    gboolean succes = TRUE;
+	gint64 power_10;
+	gint exponent_diff;
 
-    while (exponent < target_exponent)
-    {
-        gint64 new_mantissa;
+	exponent_diff = target_exponent - num->exponent;
+	if (exponent_diff <= 0)
+		return TRUE;
 
-        new_mantissa = mantissa * 10;
-        if ((new_mantissa > G_MAXINT64) || (new_mantissa < G_MININT64))
-        {
-            succes = FALSE;
-            break;
-        }
-        mantissa = new_mantissa;
-        ++exponent;
-    }
-    num->mantissa = mantissa;
-    num->exponent = exponent;
+	if (exponent_diff > GSB_REAL_POWER_10_MAX)
+		return FALSE;
+
+	power_10 = gsb_real_power_10[exponent_diff];
+	if (num->mantissa > G_MAXINT64 / power_10 || num->mantissa < -(G_MAXINT64 / power_10))
+		return FALSE;
+
+	num->mantissa *= power_10;
+	num->exponent = target_exponent;
 
-    return succes;
+	return TRUE;
 }
 
+/******************************************************************************/
+/* Public functions                                                           */
+/******************************************************************************/
 /**
- * truncate the number. WARNING there loss of accuracy
+ * prepare the separators and the currency symbol of a locale
+ * for gsb_real_raw_format_to_buffer ()
  *
- * \param mantissa a pointer to the 64 bits mantissa to be truncate
- * \param exponent a pointer to the exponent to be truncate
+ * \param format			the format to fill
+ * \param locale      		the locale obtained with gsb_locale_get_locale (), or built manually
+ * \param currency_symbol 	the currency symbol, NULL for none
  *
  * \return
  **/
-static gboolean gsb_real_raw_truncate_number (gint64 *mantissa,
-											  gint *exponent)
+void gsb_real_format_init (GsbRealFormat *format,
+						   struct lconv *locale,
+						   const gchar *currency_symbol)
 {
-    gint64 new_mantissa = *mantissa;
-    gint new_exponent = *exponent;
+	gboolean cs_precedes;
+	gboolean sep_by_space;
+
+	cs_precedes = currency_symbol && locale->p_cs_precedes;
+	sep_by_space = currency_symbol && locale->p_sep_by_space;
+
+	format->cs_start_len = gsb_real_format_set_field (format->cs_start,
+													  GSB_REAL_FORMAT_SYMBOL_SIZE,
+													  cs_precedes ? currency_symbol : NULL,
+													  FALSE,
+													  cs_precedes && sep_by_space);
+	format->cs_end_len = gsb_real_format_set_field (format->cs_end,
+													GSB_REAL_FORMAT_SYMBOL_SIZE,
+													cs_precedes ? NULL : currency_symbol,
+													currency_symbol && !cs_precedes && sep_by_space,
+													FALSE);
+	format->positive_sign_len = gsb_real_format_set_field (format->positive_sign,
+														   GSB_REAL_FORMAT_SEP_SIZE,
+														   locale->positive_sign,
+														   FALSE,
+														   FALSE);
+	format->negative_sign_len = gsb_real_format_set_field (format->negative_sign,
+														   GSB_REAL_FORMAT_SEP_SIZE,
+														   locale->negative_sign,
+														   FALSE,
+														   FALSE);
+	format->decimal_point_len = gsb_real_format_set_field (format->decimal_point,
+														   GSB_REAL_FORMAT_SEP_SIZE,
+														   locale->mon_decimal_point,
+														   FALSE,
+														   FALSE);
+	format->thousands_sep_len = gsb_real_format_set_field (format->thousands_sep,
+														   GSB_REAL_FORMAT_SEP_SIZE,
+														   locale->mon_thousands_sep,
+														   FALSE,
+														   FALSE);
+}
 
-    if (new_mantissa > G_MAXINT64)
-    {
-        do
-        {
-            --new_exponent;
-            new_mantissa = new_mantissa / 10;
-        } while (new_mantissa > G_MAXINT64);
-    }
-    else if (new_mantissa < G_MININT64)
-    {
-        do
-        {
-            --new_exponent;
-            new_mantissa = new_mantissa / 10;
-        } while (new_mantissa < G_MININT64);
-    }
-    else
-    {
-        return FALSE;
-    }
+/**
+ * write the real in the buffer given by the caller, according to a format
+ * prepared by gsb_real_format_init (), without any allocation
+ * the number is built from the end of a local buffer, then copied
+ *
+ * \param number		Number to format.
+ * \param format		the separators and the currency symbol
+ * \param buffer		the buffer which receives the string
+ * \param buffer_size	size of buffer, GSB_REAL_FORMAT_BUF_SIZE is always enough
+ *
+ * \return the length of the string written in buffer
+ **/
+gsize gsb_real_raw_format_to_buffer (GsbReal number,
+									 const GsbRealFormat *format,
+									 gchar *buffer,
+									 gsize buffer_size)
+{
+	gchar work[GSB_REAL_FORMAT_BUF_SIZE];
+	gchar *end;
+	gchar *ptr;
+	guint64 abs_mantissa;
+	guint64 units;
+	guint64 decimals;
+	gint nb_decimals;
+	gint nb_digits = 0;
+	gsize len;
+
+	if (!buffer_size)
+		return 0;
+
+	end = work + sizeof (work) - 1;
+	*end = 0;
+	ptr = end;
 
-    /* exponent must be greater or equal to 0 */
-    if (new_exponent < 0)
-    {
-        return FALSE;
-    }
-    else
-    {
-        *exponent = new_exponent;
-        *mantissa = new_mantissa;
-        return TRUE;
-    }
+	/* on retourne 0.00 avec mon_decimal_point */
+	if (number.mantissa == 0)
+	{
+		ptr = gsb_real_format_prepend (ptr, "00", 2);
+		if (format->decimal_point_len)
+			ptr = gsb_real_format_prepend (ptr, format->decimal_point, format->decimal_point_len);
+		else
+			ptr = gsb_real_format_prepend (ptr, ".", 1);
+		ptr = gsb_real_format_prepend (ptr, "0", 1);
+	}
+	else
+	{
+		abs_mantissa = number.mantissa < 0 ? - (guint64) number.mantissa : (guint64) number.mantissa;
+		units = abs_mantissa / (guint64) gsb_real_get_power_10 (number.exponent);
+		decimals = abs_mantissa % (guint64) gsb_real_get_power_10 (number.exponent);
+
+		ptr = gsb_real_format_prepend (ptr, format->cs_end, format->cs_end_len);
+
+		/* the decimals, with the leading 0 */
+		if (number.exponent > 0)
+		{
+			nb_decimals = MIN (number.exponent, 3 * GSB_REAL_POWER_10_MAX);
+			while (nb_decimals--)
+			{
+				*--ptr = '0' + decimals % 10;
+				decimals /= 10;
+			}
+			ptr = gsb_real_format_prepend (ptr, format->decimal_point, format->decimal_point_len);
+		}
+
+		/* the units, with the thousands separator */
+		do
+		{
+			if (nb_digits && nb_digits % 3 == 0)
+				ptr = gsb_real_format_prepend (ptr, format->thousands_sep, format->thousands_sep_len);
+			*--ptr = '0' + units % 10;
+			units /= 10;
+			nb_digits++;
+		}
+		while (units);
+
+		if (number.mantissa < 0)
+			ptr = gsb_real_format_prepend (ptr, format->negative_sign, format->negative_sign_len);
+		else
+			ptr = gsb_real_format_prepend (ptr, format->positive_sign, format->positive_sign_len);
+		ptr = gsb_real_format_prepend (ptr, format->cs_start, format->cs_start_len);
+	}
+
+	len = MIN ((gsize) (end - ptr), buffer_size - 1);
+	memcpy (buffer, ptr, len);
+	buffer[len] = 0;
+
+	return len;
 }
 
-/******************************************************************************/
-/* Public functions                                                           */
-/******************************************************************************/
 /**
  * Return the real in a formatted string with an optional currency
  * symbol, according to the given locale regarding decimal separator,
@@ -336,70 +505,14 @@ gchar *gsb_real_raw_format_string (GsbReal number,
 								   struct lconv *locale,
 								   const gchar *currency_symbol)
 {
-    gchar buffer[G_ASCII_DTOSTR_BUF_SIZE];
-    gchar *result = NULL, *temp = NULL;
-	const gchar *cs_start;
-    const gchar *cs_start_space;
-    const gchar *sign;
-    const gchar *mon_decimal_point;
-    const gchar *cs_end_space;
-    const gchar *cs_end;
-    gint nbre_char;
-	long long denominateur = 1;
-	lldiv_t units;
-
-    cs_start = (currency_symbol && locale->p_cs_precedes) ? currency_symbol : "";
-    cs_start_space = (currency_symbol && locale->p_cs_precedes && locale->p_sep_by_space) ? " " : "";
-    sign = (number.mantissa < 0) ? locale->negative_sign : locale->positive_sign;
-    mon_decimal_point = locale->mon_decimal_point && *locale->mon_decimal_point ? locale->mon_decimal_point : "";
-    cs_end_space = (currency_symbol && !locale->p_cs_precedes && locale->p_sep_by_space) ? " " : "";
-    cs_end = (currency_symbol && !locale->p_cs_precedes) ? currency_symbol : "";
-
-	/* on retourne 0.00 avec mon_decimal_point */
-	if (number.mantissa == 0)
-	{
-		if (mon_decimal_point && strlen (mon_decimal_point) == 0)
-        	return g_strdup ("0.00");
-		else
-			return g_strconcat ("0",mon_decimal_point, "00", NULL);
-	}
-
-	denominateur = gsb_real_get_power_10 (number.exponent);
-	units = lldiv (llabs (number.mantissa), denominateur);
+	GsbRealFormat format;
+	gchar buffer[GSB_REAL_FORMAT_BUF_SIZE];
+	gsize len;
 
-    nbre_char = g_sprintf (buffer, "%.0f", (gdouble) units.quot);
-
-    temp = g_strndup (buffer, nbre_char);
-
-    if (units.quot >= 1000)
-    {
-        temp = gsb_real_add_thousands_sep (temp, locale->mon_thousands_sep);
-    }
-
-	if (number.exponent > 0)
-		result = g_strdup_printf ("%s%s%s%s%s%0*lld%s%s",
-								  cs_start,
-								  cs_start_space,
-								  sign,
-								  temp,
-								  mon_decimal_point,
-								  number.exponent,
-								  units.rem,
-								  cs_end_space,
-								  cs_end);
-	else
-		/* no decimal point and no decimals */
-		result = g_strdup_printf ("%s%s%s%s%s%s",
-								  cs_start,
-								  cs_start_space,
-								  sign,
-								  temp,
-								  cs_end_space,
-								  cs_end);
+	gsb_real_format_init (&format, locale, currency_symbol);
+	len = gsb_real_raw_format_to_buffer (number, &format, buffer, sizeof (buffer));
 
-    g_free (temp);
-
-    return result;
+	return g_strndup (buffer, len);
 }
 
 /**
@@ -632,6 +745,37 @@ GsbReal gsb_real_safe_real_from_string (const gchar *string)
 gint gsb_real_cmp (GsbReal number_1,
 				   GsbReal number_2)
 {
+	/* fast path : same exponent */
+	if (G_LIKELY (number_1.exponent == number_2.exponent))
+	{
+		if (number_1.mantissa < number_2.mantissa)
+			return -1;
+		if (number_1.mantissa == number_2.mantissa)
+			return 0;
+
+		return 1;
+	}
+
+#ifdef GSB_REAL_HAVE_INT128
+	if (abs (number_1.exponent - number_2.exponent) <= GSB_REAL_POWER_10_MAX)
+	{
+		GsbRealWide mantissa_1;
+		GsbRealWide mantissa_2;
+		gint exponent;
+
+		/* exact comparison */
+		exponent = MAX (number_1.exponent, number_2.exponent);
+		mantissa_1 = gsb_real_wide_rescale (number_1.mantissa, exponent - number_1.exponent);
+		mantissa_2 = gsb_real_wide_rescale (number_2.mantissa, exponent - number_2.exponent);
+		if (mantissa_1 < mantissa_2)
+			return -1;
+		if (mantissa_1 == mantissa_2)
+			return 0;
+
+		return 1;
+	}
+#endif
+
     gsb_real_normalize (&number_1,
 			 &number_2);
     if (number_1.mantissa < number_2.mantissa)
@@ -771,20 +915,46 @@ GsbReal gsb_real_adjust_exponent (GsbReal number,
 GsbReal gsb_real_add (GsbReal number_1,
                       GsbReal number_2)
 {
-    gint64 mantissa;
-
     if ((number_1.mantissa == error_real.mantissa)
-      || (number_2.mantissa == error_real.mantissa)
-      || !gsb_real_normalize (&number_1, &number_2))
+      || (number_2.mantissa == error_real.mantissa))
 		return error_real;
 
-	mantissa = (gint64) number_1.mantissa + number_2.mantissa;
-    if ((mantissa > G_MAXINT64) || (mantissa < G_MININT64))
-    {
-        if (!gsb_real_raw_truncate_number (&mantissa, &number_1.exponent))
-            return error_real;
-    }
-    number_1.mantissa = mantissa;
+	/* fast path : same exponent and no overflow, the exponent is kept */
+	if (G_LIKELY (number_1.exponent == number_2.exponent
+				  && gsb_real_raw_add_is_safe (number_1.mantissa, number_2.mantissa)))
+	{
+		number_1.mantissa += number_2.mantissa;
+
+		return number_1;
+	}
+
+#ifdef GSB_REAL_HAVE_INT128
+	if (abs (number_1.exponent - number_2.exponent) <= GSB_REAL_POWER_10_MAX)
+	{
+		GsbRealWide mantissa;
+		gint exponent;
+
+		/* exact sum with the biggest exponent, reduced only if necessary */
+		exponent = MAX (number_1.exponent, number_2.exponent);
+		mantissa = gsb_real_wide_rescale (number_1.mantissa, exponent - number_1.exponent)
+				   + gsb_real_wide_rescale (number_2.mantissa, exponent - number_2.exponent);
+
+		return gsb_real_wide_to_real (mantissa, exponent);
+	}
+#endif
+
+	/* grow the smallest exponent, the numbers are minimized only if it overflows */
+	if (!gsb_real_grow_exponent (&number_1, number_2.exponent)
+		|| !gsb_real_grow_exponent (&number_2, number_1.exponent))
+	{
+		if (!gsb_real_normalize (&number_1, &number_2))
+			return error_real;
+	}
+
+	if (!gsb_real_raw_add_is_safe (number_1.mantissa, number_2.mantissa))
+		return error_real;
+
+    number_1.mantissa += number_2.mantissa;
 
     return number_1;
 }
@@ -834,27 +1004,46 @@ GsbReal gsb_real_opposite (GsbReal number)
 GsbReal gsb_real_mul (GsbReal number_1,
                       GsbReal number_2)
 {
-    gint64 mantissa;
-
     if (number_1.mantissa == error_real.mantissa
          || number_2.mantissa == error_real.mantissa)
     {
         return error_real;
     }
 
-    mantissa = (gint64) number_1.mantissa * number_2.mantissa;
-    number_1.exponent += number_2.exponent;
+#ifdef GSB_REAL_HAVE_INT128
+	{
+		GsbRealWide mantissa;
+		gint exponent;
 
-    gsb_real_raw_minimize_exponent (&mantissa, &number_1.exponent);
+		mantissa = (GsbRealWide) number_1.mantissa * number_2.mantissa;
+		exponent = number_1.exponent + number_2.exponent;
 
-    if ((mantissa > G_MAXINT64) || (mantissa < G_MININT64))
-    {
-        if (!gsb_real_raw_truncate_number (&mantissa, &number_1.exponent))
-            return error_real;
-    }
-    number_1.mantissa = mantissa;
+		/* reduce the exponent to its smallest possible value */
+		while (exponent > 0 && mantissa % 10 == 0)
+		{
+			mantissa = mantissa / 10;
+			exponent--;
+		}
 
-    return number_1;
+		return gsb_real_wide_to_real (mantissa, exponent);
+	}
+#else
+	{
+		gint64 mantissa;
+
+		if (number_1.mantissa
+			&& (llabs (number_2.mantissa) > G_MAXINT64 / llabs (number_1.mantissa)))
+			return error_real;
+
+		mantissa = number_1.mantissa * number_2.mantissa;
+		number_1.exponent += number_2.exponent;
+
+		gsb_real_raw_minimize_exponent (&mantissa, &number_1.exponent);
+		number_1.mantissa = mantissa;
+
+		return number_1;
+	}
+#endif
 }
 
 /**
@@ -980,6 +1169,106 @@ gdouble gsb_real_real_to_double (GsbReal number)
     return result;
 }
 
+/**
+ * initialize an accumulator to sum many GsbReal
+ * the exponent grows if a number with a bigger exponent is added
+ *
+ * \param accumulator
+ * \param exponent the initial exponent, usually the floating point of the currency
+ *
+ * \return
+ **/
+void gsb_real_accumulator_init (GsbRealAccumulator *accumulator,
+								gint exponent)
+{
+	accumulator->mantissa = 0;
+	accumulator->exponent = MAX (exponent, 0);
+	accumulator->error = FALSE;
+}
+
+/**
+ * add a number to the accumulator, without normalization of the sum
+ * when the exponent of the number is the exponent of the accumulator
+ *
+ * \param accumulator
+ * \param number
+ *
+ * \return
+ **/
+void gsb_real_accumulator_add (GsbRealAccumulator *accumulator,
+							   GsbReal number)
+{
+	gint exponent_diff;
+
+	if (accumulator->error)
+		return;
+
+	if (number.mantissa == error_real.mantissa)
+	{
+		accumulator->error = TRUE;
+		return;
+	}
+
+	exponent_diff = number.exponent - accumulator->exponent;
+	if (G_UNLIKELY (exponent_diff))
+	{
+		if (abs (exponent_diff) > GSB_REAL_POWER_10_MAX)
+		{
+			accumulator->error = TRUE;
+			return;
+		}
+
+		if (exponent_diff > 0)
+		{
+			/* the accumulator takes the exponent of the number */
+			if (accumulator->mantissa > GSB_REAL_WIDE_MAX / gsb_real_power_10[exponent_diff]
+				|| accumulator->mantissa < -(GSB_REAL_WIDE_MAX / gsb_real_power_10[exponent_diff]))
+			{
+				accumulator->error = TRUE;
+				return;
+			}
+			accumulator->mantissa *= gsb_real_power_10[exponent_diff];
+			accumulator->exponent = number.exponent;
+		}
+		else if (!gsb_real_grow_exponent (&number, accumulator->exponent))
+		{
+#ifdef GSB_REAL_HAVE_INT128
+			accumulator->mantissa += gsb_real_wide_rescale (number.mantissa, -exponent_diff);
+			if (accumulator->mantissa > GSB_REAL_WIDE_MAX || accumulator->mantissa < -GSB_REAL_WIDE_MAX)
+				accumulator->error = TRUE;
+#else
+			accumulator->error = TRUE;
+#endif
+			return;
+		}
+	}
+
+#ifdef GSB_REAL_HAVE_INT128
+	/* fast path : no overflow possible before GSB_REAL_WIDE_MAX / G_MAXINT64 additions */
+	accumulator->mantissa += number.mantissa;
+#else
+	if (gsb_real_raw_add_is_safe (accumulator->mantissa, number.mantissa))
+		accumulator->mantissa += number.mantissa;
+	else
+		accumulator->error = TRUE;
+#endif
+}
+
+/**
+ * return the sum of the numbers added to the accumulator
+ *
+ * \param accumulator
+ *
+ * \return the sum or error_real if an error_real was added or the sum overflows
+ **/
+GsbReal gsb_real_accumulator_get_value (GsbRealAccumulator *accumulator)
+{
+	if (accumulator->error)
+		return error_real;
+
+	return gsb_real_wide_to_real (accumulator->mantissa, accumulator->exponent);
+}
+
 /**
  *
  *
@@ -7,6 +7,11 @@
 #define EXPONENT_MAX 15
 #define ERROR_REAL_STRING "###ERR###"
 
+/* size of the buffers given to gsb_real_raw_format_to_buffer */
+#define GSB_REAL_FORMAT_BUF_SIZE 256
+#define GSB_REAL_FORMAT_SEP_SIZE 8
+#define GSB_REAL_FORMAT_SYMBOL_SIZE 40
+
 /* structure describe a real number. */
 typedef struct _GsbReal		GsbReal;
 struct _GsbReal
@@ -18,12 +23,52 @@ struct _GsbReal
 static const GsbReal null_real = { 0 , 0 };
 static const GsbReal error_real = { G_MININT64, 0 };
 
+/* intermediate mantissa : 128 bits when the compiler provides them */
+#ifdef __SIZEOF_INT128__
+#define GSB_REAL_HAVE_INT128 1
+__extension__ typedef __int128 GsbRealWide;
+#else
+typedef gint64 GsbRealWide;
+#endif
+
+/* sum of many GsbReal, the result is rounded only once by gsb_real_accumulator_get_value */
+typedef struct _GsbRealAccumulator	GsbRealAccumulator;
+struct _GsbRealAccumulator
+{
+    GsbRealWide mantissa;
+    gint exponent;
+    gboolean error;
+};
+
+/* separators and currency symbol prepared once for gsb_real_raw_format_to_buffer */
+typedef struct _GsbRealFormat	GsbRealFormat;
+struct _GsbRealFormat
+{
+    gchar cs_start[GSB_REAL_FORMAT_SYMBOL_SIZE];		/* currency symbol and space before the number */
+    gchar cs_end[GSB_REAL_FORMAT_SYMBOL_SIZE];			/* space and currency symbol after the number */
+    gchar positive_sign[GSB_REAL_FORMAT_SEP_SIZE];
+    gchar negative_sign[GSB_REAL_FORMAT_SEP_SIZE];
+    gchar decimal_point[GSB_REAL_FORMAT_SEP_SIZE];
+    gchar thousands_sep[GSB_REAL_FORMAT_SEP_SIZE];
+    gsize cs_start_len;
+    gsize cs_end_len;
+    gsize positive_sign_len;
+    gsize negative_sign_len;
+    gsize decimal_point_len;
+    gsize thousands_sep_len;
+};
+
 
 /* START_INCLUDE_H */
 /* END_INCLUDE_H */
 
 /* START_DECLARATION */
 GsbReal		gsb_real_abs					(GsbReal number);
+void		gsb_real_accumulator_add		(GsbRealAccumulator *accumulator,
+											 GsbReal number);
+GsbReal		gsb_real_accumulator_get_value	(GsbRealAccumulator *accumulator);
+void		gsb_real_accumulator_init		(GsbRealAccumulator *accumulator,
+											 gint exponent);
 GsbReal		gsb_real_add					(GsbReal number_1,
                         					 GsbReal number_2);
 GsbReal		gsb_real_adjust_exponent		(GsbReal number,
@@ -33,6 +78,9 @@ gint		gsb_real_cmp					(GsbReal number_1,
 GsbReal		gsb_real_div					(GsbReal number_1,
                         					 GsbReal number_2);
 GsbReal		gsb_real_double_to_real			(gdouble number);
+void		gsb_real_format_init			(GsbRealFormat *format,
+											 struct lconv *locale,
+											 const gchar *currency_symbol);
 GsbReal		gsb_real_mul					(GsbReal number_1,
                         					 GsbReal number_2);
 GsbReal		gsb_real_new					(gint64 mantissa,
@@ -40,6 +88,10 @@ GsbReal		gsb_real_new					(gint64 mantissa,
 gboolean	gsb_real_normalize				(GsbReal *number_1,
 											 GsbReal *number_2);
 GsbReal		gsb_real_opposite				(GsbReal number);
+gsize		gsb_real_raw_format_to_buffer	(GsbReal number,
+											 const GsbRealFormat *format,
+											 gchar *buffer,
+											 gsize buffer_size);
 gchar *		gsb_real_raw_format_string		(GsbReal number,
                         					 struct lconv *locale,
                         					 const gchar *currency_symbol);
@@ -27,6 +27,8 @@
 
 #include "config.h"
 
+#include <string.h>
+
 /*START_INCLUDE*/
 #include "gsb_scheduler.h"
 #include "accueil.h"
@@ -270,6 +272,133 @@ static gint gsb_scheduler_create_transaction_from_scheduled_transaction (gint sc
 	return transaction_number;
 }
 
+/**
+ * return the julian day of a day of a month, the day is set to the last day
+ * of the month if the month is too short, like g_date_add_months does
+ *
+ * \param month_number	year * 12 + month - 1
+ * \param day
+ *
+ * \return the julian day or 0 if the year is out of the range of GDate
+ **/
+static guint32 gsb_scheduler_recurrence_get_julian (gint month_number,
+													gint day)
+{
+	GDate date;
+	GDateYear year;
+	GDateMonth month;
+
+	year = month_number / 12;
+	month = month_number % 12 + 1;
+	if (!g_date_valid_year (year))
+		return 0;
+
+	day = MIN (day, g_date_get_days_in_month (month, year));
+	g_date_clear (&date, 1);
+	g_date_set_dmy (&date, day, month, year);
+
+	return g_date_get_julian (&date);
+}
+
+/**
+ * return the number of the month of a julian day
+ *
+ * \param julian_day
+ * \param day		set to the day of the month if not NULL
+ *
+ * \return year * 12 + month - 1
+ **/
+static gint gsb_scheduler_recurrence_get_month_number (guint32 julian_day,
+													   gint *day)
+{
+	GDate date;
+
+	g_date_clear (&date, 1);
+	g_date_set_julian (&date, julian_day);
+	if (day)
+		*day = g_date_get_day (&date);
+
+	return g_date_get_year (&date) * 12 + g_date_get_month (&date) - 1;
+}
+
+/**
+ * set the current occurrence of the recurrence and check the limit date
+ *
+ * \param recurrence
+ * \param julian_day	the occurrence, 0 if there is no more occurrence
+ *
+ * \return the occurrence or 0 if over the limit
+ **/
+static guint32 gsb_scheduler_recurrence_set_current (GsbSchedulerRecurrence *recurrence,
+													 guint32 julian_day)
+{
+	if (julian_day && !g_date_valid_julian (julian_day))
+		julian_day = 0;
+	if (julian_day && recurrence->limit_day && julian_day > recurrence->limit_day)
+		julian_day = 0;
+
+	recurrence->current_day = julian_day;
+
+	return julian_day;
+}
+
+/**
+ * go directly to an occurrence of the recurrence
+ *
+ * \param recurrence
+ * \param index		0 for the date of the scheduled transaction
+ *
+ * \return the occurrence or 0 if over the limit
+ **/
+static guint32 gsb_scheduler_recurrence_set_index (GsbSchedulerRecurrence *recurrence,
+												   guint index)
+{
+	guint64 julian_day = 0;
+
+	recurrence->index = index;
+	if (index == 0)
+	{
+		gsb_scheduler_recurrence_get_month_number (recurrence->first_day, &recurrence->month_day);
+		julian_day = recurrence->first_day;
+	}
+	else if (recurrence->days)
+		julian_day = recurrence->first_day + (guint64) index * recurrence->days;
+	else if (recurrence->months)
+	{
+		gint first_month;
+		gint day;
+		guint i;
+
+		first_month = gsb_scheduler_recurrence_get_month_number (recurrence->first_day, &day);
+		if ((guint64) index * recurrence->months > G_MAXINT - first_month)
+			return gsb_scheduler_recurrence_set_current (recurrence, 0);
+
+		if (recurrence->fixed_day)
+			day = recurrence->fixed_day;
+		else
+		{
+			/* g_date_add_months keeps the shortest day met, only the months
+			 * of less than 31 days can change it */
+			for (i = 1; i <= index && day > 28; i++)
+			{
+				gint month_number;
+
+				month_number = first_month + i * recurrence->months;
+				if (!g_date_valid_year (month_number / 12))
+					break;
+				day = MIN (day, g_date_get_days_in_month (month_number % 12 + 1, month_number / 12));
+			}
+			recurrence->month_day = day;
+		}
+		julian_day = gsb_scheduler_recurrence_get_julian (first_month + index * recurrence->months, day);
+	}
+
+	if (julian_day > G_MAXUINT32)
+		julian_day = 0;
+
+	return gsb_scheduler_recurrence_set_current (recurrence, (guint32) julian_day);
+}
+
 /******************************************************************************/
 /* Public functions                                                           */
 /******************************************************************************/
@@ -501,6 +630,205 @@ GDate *gsb_scheduler_get_next_date (gint scheduled_number,
 	return (return_date);
 }
 
+/**
+ * initialise the iteration of the occurrences of a scheduled transaction
+ * on julian days. The occurrences are the same as the ones given by
+ * gsb_scheduler_get_next_date from the date of the scheduled transaction,
+ * without allocation. The limit date applies to the first occurrence too.
+ *
+ * \param recurrence	the recurrence to initialise
+ * \param scheduled_number
+ *
+ * \return FALSE if the scheduled transaction has no valid date
+ **/
+gboolean gsb_scheduler_recurrence_init (GsbSchedulerRecurrence *recurrence,
+										gint scheduled_number)
+{
+	GDate *date;
+	GDate *limit_date;
+	gint fixed_date;
+	gint user_entry;
+
+	memset (recurrence, 0, sizeof (GsbSchedulerRecurrence));
+
+	date = gsb_data_scheduled_get_date (scheduled_number);
+	if (!date || !g_date_valid (date))
+		return FALSE;
+
+	recurrence->first_day = g_date_get_julian (date);
+	limit_date = gsb_data_scheduled_get_limit_date (scheduled_number);
+	if (limit_date && g_date_valid (limit_date))
+		recurrence->limit_day = g_date_get_julian (limit_date);
+
+	/* the fixed date is used only for the periods in months */
+	fixed_date = gsb_data_scheduled_get_fixed_date (scheduled_number);
+
+	switch (gsb_data_scheduled_get_frequency (scheduled_number))
+	{
+		case SCHEDULER_PERIODICITY_WEEK_VIEW:
+			recurrence->days = 7;
+			break;
+
+		case SCHEDULER_PERIODICITY_MONTH_VIEW:
+			recurrence->months = 1;
+			recurrence->fixed_day = fixed_date;
+			break;
+
+		case SCHEDULER_PERIODICITY_TWO_MONTHS_VIEW:
+			recurrence->months = 2;
+			recurrence->fixed_day = fixed_date;
+			break;
+
+		case SCHEDULER_PERIODICITY_TRIMESTER_VIEW:
+			recurrence->months = 3;
+			recurrence->fixed_day = fixed_date;
+			break;
+
+		case SCHEDULER_PERIODICITY_YEAR_VIEW:
+			recurrence->months = 12;
+			break;
+
+		case SCHEDULER_PERIODICITY_CUSTOM_VIEW:
+			user_entry = gsb_data_scheduled_get_user_entry (scheduled_number);
+			if (user_entry <= 0)
+				break;
+
+			switch (gsb_data_scheduled_get_user_interval (scheduled_number))
+			{
+				case PERIODICITY_DAYS:
+					recurrence->days = user_entry;
+					break;
+
+				case PERIODICITY_WEEKS:
+					recurrence->days = user_entry * 7;
+					break;
+
+				case PERIODICITY_MONTHS:
+					recurrence->months = user_entry;
+					recurrence->fixed_day = fixed_date;
+					break;
+
+				case PERIODICITY_YEARS:
+					recurrence->months = user_entry * 12;
+					break;
+			}
+			break;
+	}
+
+	gsb_scheduler_recurrence_set_index (recurrence, 0);
+
+	return TRUE;
+}
+
+/**
+ * go to the first occurrence at or after a julian day
+ *
+ * \param recurrence
+ * \param julian_day
+ *
+ * \return the julian day of the occurrence or 0 if there is none
+ **/
+guint32 gsb_scheduler_recurrence_first_from (GsbSchedulerRecurrence *recurrence,
+											  guint32 julian_day)
+{
+	guint index = 0;
+
+	if (julian_day > recurrence->first_day)
+	{
+		if (recurrence->days)
+			index = (julian_day - recurrence->first_day + recurrence->days - 1) / recurrence->days;
+		else if (recurrence->months)
+			index = (gsb_scheduler_recurrence_get_month_number (julian_day, NULL)
+					 - gsb_scheduler_recurrence_get_month_number (recurrence->first_day, NULL))
+					/ recurrence->months;
+	}
+
+	gsb_scheduler_recurrence_set_index (recurrence, index);
+	while (recurrence->current_day && recurrence->current_day < julian_day)
+		gsb_scheduler_recurrence_next (recurrence);
+
+	return recurrence->current_day;
+}
+
+/**
+ * go to the next occurrence
+ *
+ * \param recurrence
+ *
+ * \return the julian day of the occurrence or 0 if there is no more occurrence
+ **/
+guint32 gsb_scheduler_recurrence_next (GsbSchedulerRecurrence *recurrence)
+{
+	guint64 julian_day = 0;
+
+	if (!recurrence->current_day)
+		return 0;
+
+	recurrence->index++;
+	if (recurrence->days)
+		julian_day = (guint64) recurrence->current_day + recurrence->days;
+	else if (recurrence->months)
+	{
+		gint month_number;
+		gint day;
+
+		month_number = gsb_scheduler_recurrence_get_month_number (recurrence->current_day, NULL);
+		if (month_number > G_MAXINT - recurrence->months)
+			return gsb_scheduler_recurrence_set_current (recurrence, 0);
+
+		month_number += recurrence->months;
+		if (recurrence->fixed_day)
+			day = recurrence->fixed_day;
+		else
+		{
+			if (g_date_valid_year (month_number / 12))
+				recurrence->month_day = MIN (recurrence->month_day,
+											 g_date_get_days_in_month (month_number % 12 + 1,
+																	   month_number / 12));
+			day = recurrence->month_day;
+		}
+		julian_day = gsb_scheduler_recurrence_get_julian (month_number, day);
+	}
+
+	if (julian_day > G_MAXUINT32)
+		julian_day = 0;
+
+	return gsb_scheduler_recurrence_set_current (recurrence, (guint32) julian_day);
+}
+
+/**
+ * fill an array with the occurrences between two julian days. If the array
+ * is full, the recurrence stays on the first occurrence not copied, and
+ * the filling can go on with gsb_scheduler_recurrence_first_from
+ * (recurrence, recurrence->current_day).
+ *
+ * \param recurrence
+ * \param first_day	the first julian day of the period
+ * \param last_day		the last julian day of the period
+ * \param days			array of nb_days julian days to fill
+ * \param nb_days
+ *
+ * \return the number of occurrences copied in days
+ **/
+guint gsb_scheduler_recurrence_fill (GsbSchedulerRecurrence *recurrence,
+									 guint32 first_day,
+									 guint32 last_day,
+									 guint32 *days,
+									 guint nb_days)
+{
+	guint32 julian_day;
+	guint nb_occurrences = 0;
+
+	julian_day = gsb_scheduler_recurrence_first_from (recurrence, first_day);
+	while (julian_day && julian_day <= last_day && nb_occurrences < nb_days)
+	{
+		days[nb_occurrences++] = julian_day;
+		julian_day = gsb_scheduler_recurrence_next (recurrence);
+	}
+
+	return nb_occurrences;
+}
+
 /**
  * get the children of a split scheduled transaction,
  * make the transactions from them and append them to the transactions list
@@ -576,6 +904,8 @@ void gsb_scheduler_update_children_from_split_scheduled (gint scheduled_number)
 void gsb_scheduler_check_scheduled_transactions_time_limit (void)
 {
 	GDate *date;
+	GSList *due_list;
+	GSList *taken_list = NULL;
 	GSList *tmp_list;
 	gboolean automatic_transactions_taken = FALSE;
 	GrisbiAppConf *a_conf;
@@ -587,6 +917,7 @@ void gsb_scheduler_check_scheduled_transactions_time_limit (void)
 
 	/* the scheduled transactions to take will be check here, */
 	/* but the scheduled transactions taken will be add to the already appended ones */
+	g_slist_free (scheduled_transactions_to_take);
 	scheduled_transactions_to_take = NULL;
 
 	/* get the date today + a_conf->nb_days_before_scheduled */
@@ -615,59 +946,51 @@ void gsb_scheduler_check_scheduled_transactions_time_limit (void)
 		g_date_add_days (date, a_conf->nb_days_before_scheduled);
 	}
 
-	/* check all the scheduled transactions, */
-	/* if automatic, it's taken */
+	/* check only the due scheduled transactions, given by the index of the due dates, */
+	/* if automatic, all its occurrences until date are taken in one go */
 	/* if manual, appended into scheduled_transactions_to_take */
-	tmp_list = gsb_data_scheduled_get_scheduled_list ();
+	due_list = gsb_data_scheduled_get_due_list (date);
+	tmp_list = due_list;
 
 	while (tmp_list)
 	{
 		gint scheduled_number;
 
-		scheduled_number = gsb_data_scheduled_get_scheduled_number (tmp_list->data);
+		scheduled_number = GPOINTER_TO_INT (tmp_list->data);
 
-		/* we check that scheduled transaction only if it's not a child of a split */
-		if (!gsb_data_scheduled_get_mother_scheduled_number (scheduled_number)
-			 && gsb_data_scheduled_get_date (scheduled_number)
-			 && g_date_compare (gsb_data_scheduled_get_date (scheduled_number), date) <= 0)
+		if (gsb_data_scheduled_get_automatic_scheduled (scheduled_number))
 		{
-			if (gsb_data_scheduled_get_automatic_scheduled (scheduled_number))
+			/* this is an automatic scheduled, we take it untill date */
+			do
 			{
-				/* this is an automatic scheduled, we get it */
 				gint transaction_number;
 
-				/* take automatically the scheduled transaction untill today */
 				transaction_number = gsb_scheduler_create_transaction_from_scheduled_transaction (scheduled_number, 0);
 				if (gsb_data_scheduled_get_split_of_scheduled (scheduled_number))
 					gsb_scheduler_execute_children_of_scheduled_transaction (scheduled_number, transaction_number);
 
-				scheduled_transactions_taken = g_slist_append (scheduled_transactions_taken,
-															   GINT_TO_POINTER (transaction_number));
+				taken_list = g_slist_prepend (taken_list, GINT_TO_POINTER (transaction_number));
 				automatic_transactions_taken = TRUE;
 
-				/* set the scheduled transaction to the next date, */
-				/* if it's not finished, we check them again if it need to be */
-				/* executed more than one time (the easiest way is to check */
-				/* all again, i don't think it will have thousand of scheduled transactions, */
-				/* so no much waste of time...) */
-
-				/* fixe probablement le bug bug 2255 */
-				if (gsb_scheduler_increase_scheduled (scheduled_number))
-					scheduled_transactions_to_take = NULL;
-
-				tmp_list = gsb_data_scheduled_get_scheduled_list ();
-			}
-			else
-			{
-				/* it's a manual scheduled transaction, we put it in the slist */
-				scheduled_transactions_to_take = g_slist_append (scheduled_transactions_to_take ,
-																 GINT_TO_POINTER (scheduled_number));
-				tmp_list = tmp_list->next;
+				/* set the scheduled transaction to the next date, stop if it's finished (bug 2255) */
+				if (!gsb_scheduler_increase_scheduled (scheduled_number))
+					break;
 			}
+			while (g_date_compare (gsb_data_scheduled_get_date (scheduled_number), date) <= 0);
 		}
 		else
-			tmp_list = tmp_list->next;
+		{
+			/* it's a manual scheduled transaction, we put it in the slist */
+			scheduled_transactions_to_take = g_slist_prepend (scheduled_transactions_to_take,
+															  GINT_TO_POINTER (scheduled_number));
+		}
+		tmp_list = tmp_list->next;
 	}
+	g_slist_free (due_list);
+
+	/* the index gives the manual ones sorted by date */
+	scheduled_transactions_to_take = g_slist_reverse (scheduled_transactions_to_take);
+	scheduled_transactions_taken = g_slist_concat (scheduled_transactions_taken, g_slist_reverse (taken_list));
 
 	if (automatic_transactions_taken)
 	{
@@ -6,6 +6,22 @@
 /* START_INCLUDE_H */
 /* END_INCLUDE_H */
 
+/* iteration of the occurrences of a scheduled transaction on julian days */
+typedef struct _GsbSchedulerRecurrence	GsbSchedulerRecurrence;
+struct _GsbSchedulerRecurrence
+{
+	guint32		first_day;		/* date of the scheduled transaction */
+	guint32		limit_day;		/* limit date, 0 if none */
+	gint		days;			/* days between two occurrences, 0 if counted in months */
+	gint		months;			/* months between two occurrences, 0 if counted in days */
+	gint		fixed_day;		/* day of the month of the occurrences, 0 if none */
+
+	/* current occurrence */
+	guint		index;			/* 0 for first_day */
+	guint32		current_day;	/* 0 when there is no more occurrence */
+	gint		month_day;		/* day of the month kept by g_date_add_months */
+};
+
 /* START_DECLARATION */
 void		gsb_scheduler_check_scheduled_transactions_time_limit	(void);
 gboolean	gsb_scheduler_execute_children_of_scheduled_transaction	(gint scheduled_number,
@@ -13,6 +29,16 @@ gboolean	gsb_scheduler_execute_children_of_scheduled_transaction	(gint scheduled
 GDate *		gsb_scheduler_get_next_date								(gint scheduled_number,
 				     												 const GDate *date);
 gboolean	gsb_scheduler_increase_scheduled						(gint scheduled_number);
+guint		gsb_scheduler_recurrence_fill							(GsbSchedulerRecurrence *recurrence,
+																	 guint32 first_day,
+																	 guint32 last_day,
+																	 guint32 *days,
+																	 guint nb_days);
+guint32		gsb_scheduler_recurrence_first_from						(GsbSchedulerRecurrence *recurrence,
+																	 guint32 julian_day);
+gboolean	gsb_scheduler_recurrence_init							(GsbSchedulerRecurrence *recurrence,
+																	 gint scheduled_number);
+guint32		gsb_scheduler_recurrence_next							(GsbSchedulerRecurrence *recurrence);
 void		gsb_scheduler_update_children_from_split_scheduled		(gint scheduled_number);
 
 /* END_DECLARATION */
@@ -0,0 +1,1086 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*     Copyright (C)         2026 Grisbi Development Team                     */
+/*             https://www.grisbi.org/                                         */
+/*                                                                            */
+/*  This program is free software; you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation; either version 2 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This program is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program; if not, see <https://www.gnu.org/licenses/>.     */
+/*                                                                            */
+/* ************************************************************************** */
+
+/**
+ * \file gsb_search_index.c
+ * inverted index of the words of the transactions, used by the search of
+ * transactions. The notes and the cheque number are cut in words, the words
+ * are put in lower case and without accents. The words are found from their
+ * n-grams of one to three characters, so a search for a part of a word
+ * doesn't read all the words of the index. The payees are indexed by their
+ * number, so a renamed payee doesn't need to index its transactions again.
+ * The amounts are kept for each account, sorted by absolute value, to
+ * search an amount with or without sign and with a delta.
+ * The index is built at the first use from all the transactions, archives
+ * included, then the modified transactions are marked by gsb_data_transaction
+ * and indexed again at the next use.
+ */
+
+#include "config.h"
+
+#include "include.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*START_INCLUDE*/
+#include "gsb_search_index.h"
+#include "gsb_data_account.h"
+#include "gsb_data_payee.h"
+#include "gsb_data_transaction.h"
+#include "utils_str.h"
+/*END_INCLUDE*/
+
+/*START_EXTERN*/
+/*END_EXTERN*/
+
+/* les champs coupés en mots */
+#define SEARCH_FIELDS_WORDS (SEARCH_FIELD_NOTES | SEARCH_FIELD_CHEQUE)
+
+/* longueur maximale des n-grammes des mots, en caractères */
+#define SEARCH_GRAM_MAX_LENGTH 3
+
+/* ce qui a été indexé pour une opération, pour pouvoir le retirer */
+typedef struct _SearchIndexEntry	SearchIndexEntry;
+struct _SearchIndexEntry
+{
+	gint			account_number;
+	gint			payee_number;
+	GPtrArray *		words;						/* keys of index_words, not owned */
+};
+
+/* le montant absolu d'une opération dans la devise de son compte */
+typedef struct _SearchIndexAmount	SearchIndexAmount;
+struct _SearchIndexAmount
+{
+	gint64			abs_mantissa;				/* at the exponent of the SearchIndexAmounts */
+	gint			transaction_number;
+};
+
+/* les montants des opérations d'un compte */
+typedef struct _SearchIndexAmounts	SearchIndexAmounts;
+struct _SearchIndexAmounts
+{
+	gint			currency_number;			/* currency of the account */
+	gint			exponent;					/* floating point of the currency of the account */
+	GArray *		amounts;					/* the SearchIndexAmount, the first nb_sorted are sorted */
+	guint			nb_sorted;
+	GArray *		others;						/* transactions in another currency, the first nb_others are checked */
+	guint			nb_others;
+	gboolean		modified;
+};
+
+/*START_STATIC*/
+/** the transactions of each word, key : the word, value : a GHashTable with
+ * the transaction number as key and the GsbSearchField of the word as value */
+static GHashTable *index_words = NULL;
+
+/** the words of each n-gram, key : the n-gram, value : a set of the keys of
+ * index_words which contain it */
+static GHashTable *index_grams = NULL;
+
+/** the SearchIndexEntry of each transaction, key : the transaction number */
+static GHashTable *index_entries = NULL;
+
+/** the transactions of each payee, key : the payee number, value : a set of transactions */
+static GHashTable *index_payees = NULL;
+
+/** the SearchIndexAmounts of each account, key : the account number */
+static GHashTable *index_amounts = NULL;
+
+/** the transactions modified since the last use, key : the transaction number */
+static GHashTable *index_pending = NULL;
+
+/** the index is built */
+static gboolean index_valid = FALSE;
+/*END_STATIC*/
+
+/******************************************************************************/
+/* Private functions                                                          */
+/******************************************************************************/
+/**
+ * cut a text in words : the letters and the digits make separate words,
+ * the other characters are separators. The words are case folded and
+ * without accents.
+ *
+ * \param text
+ *
+ * \return a GPtrArray of the words, to free with g_ptr_array_unref
+ **/
+static GPtrArray *gsb_search_index_get_words (const gchar *text)
+{
+	GPtrArray *words;
+	const gchar *ptr;
+	const gchar *start = NULL;
+	gint start_class = 0;
+
+	words = g_ptr_array_new_with_free_func (g_free);
+	if (!text || !g_utf8_validate (text, -1, NULL))
+		return words;
+
+	for (ptr = text; ; ptr = g_utf8_next_char (ptr))
+	{
+		gunichar ch;
+		gint ch_class = 0;
+
+		ch = g_utf8_get_char (ptr);
+		if (ch && g_unichar_isalpha (ch))
+			ch_class = 1;
+		else if (ch && g_unichar_isdigit (ch))
+			ch_class = 2;
+
+		if (start && ch_class != start_class)
+		{
+			gchar *word;
+			gchar *tmp_str;
+
+			tmp_str = g_utf8_casefold (start, ptr - start);
+			word = utils_str_remove_accents (tmp_str);
+			g_free (tmp_str);
+
+			if (word && *word)
+				g_ptr_array_add (words, word);
+			else
+				g_free (word);
+
+			start = NULL;
+		}
+
+		if (!ch)
+			break;
+
+		if (ch_class && !start)
+		{
+			start = ptr;
+			start_class = ch_class;
+		}
+	}
+
+	return words;
+}
+
+/**
+ * check that each word of the search is in a word of a text
+ *
+ * \param search_words
+ * \param text
+ *
+ * \return TRUE if all the words are found
+ **/
+static gboolean gsb_search_index_text_contains (GPtrArray *search_words,
+												const gchar *text)
+{
+	GPtrArray *words;
+	gboolean found = TRUE;
+	guint i;
+
+	words = gsb_search_index_get_words (text);
+	for (i = 0; i < search_words->len && found; i++)
+	{
+		guint j;
+
+		found = FALSE;
+		for (j = 0; j < words->len && !found; j++)
+			found = strstr (g_ptr_array_index (words, j), g_ptr_array_index (search_words, i)) != NULL;
+	}
+	g_ptr_array_unref (words);
+
+	return found;
+}
+
+/**
+ * add a transaction to the set of a payee
+ *
+ * \param sets
+ * \param number			payee number
+ * \param transaction_number
+ *
+ * \return
+ **/
+static void gsb_search_index_set_add (GHashTable *sets,
+									  gint number,
+									  gint transaction_number)
+{
+	GHashTable *set;
+
+	set = g_hash_table_lookup (sets, GINT_TO_POINTER (number));
+	if (!set)
+	{
+		set = g_hash_table_new (g_direct_hash, g_direct_equal);
+		g_hash_table_insert (sets, GINT_TO_POINTER (number), set);
+	}
+	g_hash_table_add (set, GINT_TO_POINTER (transaction_number));
+}
+
+/**
+ * remove a transaction from the set of a payee
+ *
+ * \param sets
+ * \param number			payee number
+ * \param transaction_number
+ *
+ * \return
+ **/
+static void gsb_search_index_set_remove (GHashTable *sets,
+										 gint number,
+										 gint transaction_number)
+{
+	GHashTable *set;
+
+	set = g_hash_table_lookup (sets, GINT_TO_POINTER (number));
+	if (!set)
+		return;
+
+	g_hash_table_remove (set, GINT_TO_POINTER (transaction_number));
+	if (g_hash_table_size (set) == 0)
+		g_hash_table_remove (sets, GINT_TO_POINTER (number));
+}
+
+/**
+ * call a function for each n-gram of one to SEARCH_GRAM_MAX_LENGTH
+ * characters of a word. An n-gram may be given several times.
+ *
+ * \param word
+ * \param func			called with the n-gram, freed after the call, and user_data
+ * \param user_data
+ *
+ * \return
+ **/
+static void gsb_search_index_grams_foreach (const gchar *word,
+											GFunc func,
+											gpointer user_data)
+{
+	const gchar *start;
+
+	for (start = word; *start; start = g_utf8_next_char (start))
+	{
+		const gchar *end;
+		gint length;
+
+		end = start;
+		for (length = 1; length <= SEARCH_GRAM_MAX_LENGTH && *end; length++)
+		{
+			gchar *gram;
+
+			end = g_utf8_next_char (end);
+			gram = g_strndup (start, end - start);
+			func (gram, user_data);
+			g_free (gram);
+		}
+	}
+}
+
+/**
+ * add a word of index_words to the set of one of its n-grams
+ *
+ * \param gram
+ * \param word			key of index_words
+ *
+ * \return
+ **/
+static void gsb_search_index_gram_add (gpointer gram,
+									   gpointer word)
+{
+	GHashTable *words;
+
+	words = g_hash_table_lookup (index_grams, gram);
+	if (!words)
+	{
+		words = g_hash_table_new (g_direct_hash, g_direct_equal);
+		g_hash_table_insert (index_grams, g_strdup (gram), words);
+	}
+	g_hash_table_add (words, word);
+}
+
+/**
+ * remove a word of index_words from the set of one of its n-grams
+ *
+ * \param gram
+ * \param word			key of index_words
+ *
+ * \return
+ **/
+static void gsb_search_index_gram_remove (gpointer gram,
+										  gpointer word)
+{
+	GHashTable *words;
+
+	words = g_hash_table_lookup (index_grams, gram);
+	if (!words)
+		return;
+
+	g_hash_table_remove (words, word);
+	if (g_hash_table_size (words) == 0)
+		g_hash_table_remove (index_grams, gram);
+}
+
+/**
+ * return the words of the index which may contain a word of the search :
+ * the set of its n-gram which has the fewest words. A word up to
+ * SEARCH_GRAM_MAX_LENGTH characters is itself an n-gram and the set is
+ * exact, a longer word needs a check with strstr.
+ *
+ * \param search_word
+ *
+ * \return a set of keys of index_words, not to free, NULL if no word
+ **/
+static GHashTable *gsb_search_index_grams_find (const gchar *search_word)
+{
+	GHashTable *result = NULL;
+	const gchar *start;
+	glong length;
+
+	length = g_utf8_strlen (search_word, -1);
+	if (length <= SEARCH_GRAM_MAX_LENGTH)
+		return g_hash_table_lookup (index_grams, search_word);
+
+	for (start = search_word; length >= SEARCH_GRAM_MAX_LENGTH; start = g_utf8_next_char (start), length--)
+	{
+		GHashTable *words;
+		gchar *gram;
+
+		gram = g_strndup (start, g_utf8_offset_to_pointer (start, SEARCH_GRAM_MAX_LENGTH) - start);
+		words = g_hash_table_lookup (index_grams, gram);
+		g_free (gram);
+
+		/* a missing n-gram : no word contains the search */
+		if (!words)
+			return NULL;
+
+		if (!result || g_hash_table_size (words) < g_hash_table_size (result))
+			result = words;
+	}
+
+	return result;
+}
+
+/**
+ * index the words of a field of a transaction
+ *
+ * \param transaction_number
+ * \param entry
+ * \param text
+ * \param field				a GsbSearchField
+ *
+ * \return
+ **/
+static void gsb_search_index_add_text (gint transaction_number,
+									   SearchIndexEntry *entry,
+									   const gchar *text,
+									   guint field)
+{
+	GPtrArray *words;
+	guint i;
+
+	if (!text || !*text)
+		return;
+
+	words = gsb_search_index_get_words (text);
+	for (i = 0; i < words->len; i++)
+	{
+		GHashTable *transactions;
+		gpointer key;
+		guint fields;
+
+		if (!g_hash_table_lookup_extended (index_words,
+										   g_ptr_array_index (words, i),
+										   &key,
+										   (gpointer *) &transactions))
+		{
+			key = g_strdup (g_ptr_array_index (words, i));
+			transactions = g_hash_table_new (g_direct_hash, g_direct_equal);
+			g_hash_table_insert (index_words, key, transactions);
+			gsb_search_index_grams_foreach (key, gsb_search_index_gram_add, key);
+		}
+
+		fields = GPOINTER_TO_UINT (g_hash_table_lookup (transactions, GINT_TO_POINTER (transaction_number)));
+		if (!fields)
+			g_ptr_array_add (entry->words, key);
+		g_hash_table_insert (transactions, GINT_TO_POINTER (transaction_number), GUINT_TO_POINTER (fields | field));
+	}
+	g_ptr_array_unref (words);
+}
+
+/**
+ * GCompareFunc of the SearchIndexAmount
+ *
+ * \param a
+ * \param b
+ *
+ * \return
+ **/
+static gint gsb_search_index_amount_compare (gconstpointer a,
+											 gconstpointer b)
+{
+	const SearchIndexAmount *amount_a = a;
+	const SearchIndexAmount *amount_b = b;
+
+	if (amount_a->abs_mantissa != amount_b->abs_mantissa)
+		return amount_a->abs_mantissa < amount_b->abs_mantissa ? -1 : 1;
+
+	return amount_a->transaction_number - amount_b->transaction_number;
+}
+
+/**
+ * free the amounts of an account
+ *
+ * \param amounts
+ *
+ * \return
+ **/
+static void gsb_search_index_amounts_free (SearchIndexAmounts *amounts)
+{
+	g_array_free (amounts->amounts, TRUE);
+	g_array_free (amounts->others, TRUE);
+	g_free (amounts);
+}
+
+/**
+ * return the amounts of an account
+ *
+ * \param account_number
+ *
+ * \return the SearchIndexAmounts, created if necessary
+ **/
+static SearchIndexAmounts *gsb_search_index_get_amounts (gint account_number)
+{
+	SearchIndexAmounts *amounts;
+
+	amounts = g_hash_table_lookup (index_amounts, GINT_TO_POINTER (account_number));
+	if (!amounts)
+	{
+		amounts = g_malloc0 (sizeof (SearchIndexAmounts));
+		amounts->currency_number = gsb_data_account_get_currency (account_number);
+		amounts->exponent = gsb_data_account_get_currency_floating_point (account_number);
+		amounts->amounts = g_array_new (FALSE, FALSE, sizeof (SearchIndexAmount));
+		amounts->others = g_array_new (FALSE, FALSE, sizeof (gint));
+		g_hash_table_insert (index_amounts, GINT_TO_POINTER (account_number), amounts);
+	}
+
+	return amounts;
+}
+
+/**
+ * add the amount of a transaction at the end of the amounts of its
+ * account, gsb_search_index_amounts_sort puts it at its place
+ *
+ * \param transaction_number
+ * \param account_number
+ *
+ * \return
+ **/
+static void gsb_search_index_add_amount (gint transaction_number,
+										 gint account_number)
+{
+	SearchIndexAmounts *amounts;
+	GsbReal amount;
+
+	amounts = gsb_search_index_get_amounts (account_number);
+	amounts->modified = TRUE;
+
+	/* the amounts in another currency depend on the exchange rates */
+	amount = gsb_data_transaction_get_amount (transaction_number);
+	if (gsb_data_transaction_get_currency_number (transaction_number) == amounts->currency_number
+		&& amount.mantissa != error_real.mantissa)
+	{
+		SearchIndexAmount index_amount;
+
+		amount = gsb_real_adjust_exponent (amount, amounts->exponent);
+		index_amount.abs_mantissa = amount.mantissa < 0 ? -amount.mantissa : amount.mantissa;
+		index_amount.transaction_number = transaction_number;
+		g_array_append_val (amounts->amounts, index_amount);
+	}
+	else
+		g_array_append_val (amounts->others, transaction_number);
+}
+
+/**
+ * remove the transactions marked as modified from the amounts of an
+ * account and sort the added amounts in the others
+ *
+ * \param amounts
+ * \param removed		set of the transactions to remove or NULL
+ *
+ * \return
+ **/
+static void gsb_search_index_amounts_sort (SearchIndexAmounts *amounts,
+										   GHashTable *removed)
+{
+	GArray *merged;
+	GArray *others;
+	guint i;
+	guint j;
+
+	if (!amounts->modified)
+		return;
+
+	/* the added amounts are after the sorted ones */
+	if (amounts->amounts->len > amounts->nb_sorted)
+		qsort (&g_array_index (amounts->amounts, SearchIndexAmount, amounts->nb_sorted),
+			   amounts->amounts->len - amounts->nb_sorted,
+			   sizeof (SearchIndexAmount),
+			   gsb_search_index_amount_compare);
+
+	merged = g_array_sized_new (FALSE, FALSE, sizeof (SearchIndexAmount), amounts->amounts->len);
+	i = 0;
+	j = amounts->nb_sorted;
+	while (i < amounts->nb_sorted || j < amounts->amounts->len)
+	{
+		SearchIndexAmount *old_amount = NULL;
+		SearchIndexAmount *new_amount = NULL;
+
+		if (i < amounts->nb_sorted)
+			old_amount = &g_array_index (amounts->amounts, SearchIndexAmount, i);
+		if (j < amounts->amounts->len)
+			new_amount = &g_array_index (amounts->amounts, SearchIndexAmount, j);
+
+		if (old_amount && (!new_amount || gsb_search_index_amount_compare (old_amount, new_amount) <= 0))
+		{
+			if (!removed || !g_hash_table_contains (removed, GINT_TO_POINTER (old_amount->transaction_number)))
+				g_array_append_val (merged, *old_amount);
+			i++;
+		}
+		else
+		{
+			g_array_append_val (merged, *new_amount);
+			j++;
+		}
+	}
+	g_array_free (amounts->amounts, TRUE);
+	amounts->amounts = merged;
+	amounts->nb_sorted = merged->len;
+
+	others = g_array_new (FALSE, FALSE, sizeof (gint));
+	for (i = 0; i < amounts->others->len; i++)
+	{
+		gint transaction_number;
+
+		transaction_number = g_array_index (amounts->others, gint, i);
+		if (i >= amounts->nb_others
+			|| !removed
+			|| !g_hash_table_contains (removed, GINT_TO_POINTER (transaction_number)))
+			g_array_append_val (others, transaction_number);
+	}
+	g_array_free (amounts->others, TRUE);
+	amounts->others = others;
+	amounts->nb_others = others->len;
+
+	amounts->modified = FALSE;
+}
+
+/**
+ * sort the amounts of all the modified accounts
+ *
+ * \param removed		set of the transactions to remove or NULL
+ *
+ * \return
+ **/
+static void gsb_search_index_amounts_sort_all (GHashTable *removed)
+{
+	GHashTableIter iter;
+	gpointer value;
+
+	g_hash_table_iter_init (&iter, index_amounts);
+	while (g_hash_table_iter_next (&iter, NULL, &value))
+		gsb_search_index_amounts_sort (value, removed);
+}
+
+/**
+ * index a transaction
+ *
+ * \param transaction_number
+ *
+ * \return
+ **/
+static void gsb_search_index_add_transaction (gint transaction_number)
+{
+	SearchIndexEntry *entry;
+
+	if (transaction_number <= 0 || !gsb_data_transaction_get_pointer_of_transaction (transaction_number))
+		return;
+
+	entry = g_malloc0 (sizeof (SearchIndexEntry));
+	entry->account_number = gsb_data_transaction_get_account_number (transaction_number);
+	entry->payee_number = gsb_data_transaction_get_payee_number (transaction_number);
+	entry->words = g_ptr_array_new ();
+
+	gsb_search_index_add_text (transaction_number,
+							   entry,
+							   gsb_data_transaction_get_notes (transaction_number),
+							   SEARCH_FIELD_NOTES);
+	gsb_search_index_add_text (transaction_number,
+							   entry,
+							   gsb_data_transaction_get_method_of_payment_content (transaction_number),
+							   SEARCH_FIELD_CHEQUE);
+
+	if (entry->account_number > 0)
+		gsb_search_index_add_amount (transaction_number, entry->account_number);
+	if (entry->payee_number > 0)
+		gsb_search_index_set_add (index_payees, entry->payee_number, transaction_number);
+
+	g_hash_table_insert (index_entries, GINT_TO_POINTER (transaction_number), entry);
+}
+
+/**
+ * remove a transaction from the index
+ *
+ * \param transaction_number
+ *
+ * \return
+ **/
+static void gsb_search_index_remove_transaction (gint transaction_number)
+{
+	SearchIndexEntry *entry;
+	guint i;
+
+	entry = g_hash_table_lookup (index_entries, GINT_TO_POINTER (transaction_number));
+	if (!entry)
+		return;
+
+	for (i = 0; i < entry->words->len; i++)
+	{
+		GHashTable *transactions;
+		gpointer key;
+
+		key = g_ptr_array_index (entry->words, i);
+		transactions = g_hash_table_lookup (index_words, key);
+		if (!transactions)
+			continue;
+
+		g_hash_table_remove (transactions, GINT_TO_POINTER (transaction_number));
+		if (g_hash_table_size (transactions) == 0)
+		{
+			gsb_search_index_grams_foreach (key, gsb_search_index_gram_remove, key);
+			g_hash_table_remove (index_words, key);
+		}
+	}
+
+	/* the amount is removed by gsb_search_index_amounts_sort */
+	if (entry->account_number > 0)
+		gsb_search_index_get_amounts (entry->account_number)->modified = TRUE;
+	if (entry->payee_number > 0)
+		gsb_search_index_set_remove (index_payees, entry->payee_number, transaction_number);
+
+	g_hash_table_remove (index_entries, GINT_TO_POINTER (transaction_number));
+}
+
+/**
+ * free an entry of the index
+ *
+ * \param entry
+ *
+ * \return
+ **/
+static void gsb_search_index_entry_free (SearchIndexEntry *entry)
+{
+	g_ptr_array_free (entry->words, TRUE);
+	g_free (entry);
+}
+
+/**
+ * build the index at the first use, then index again the transactions
+ * modified since the last use
+ *
+ * \param
+ *
+ * \return
+ **/
+static void gsb_search_index_update (void)
+{
+	GHashTableIter iter;
+	gpointer key;
+
+	if (!index_valid)
+	{
+		GSList *tmp_list;
+
+		gsb_search_index_reset ();
+		index_words = g_hash_table_new_full (g_str_hash,
+											 g_str_equal,
+											 g_free,
+											 (GDestroyNotify) g_hash_table_destroy);
+		index_grams = g_hash_table_new_full (g_str_hash,
+											 g_str_equal,
+											 g_free,
+											 (GDestroyNotify) g_hash_table_destroy);
+		index_entries = g_hash_table_new_full (g_direct_hash,
+											   g_direct_equal,
+											   NULL,
+											   (GDestroyNotify) gsb_search_index_entry_free);
+		index_payees = g_hash_table_new_full (g_direct_hash,
+											  g_direct_equal,
+											  NULL,
+											  (GDestroyNotify) g_hash_table_destroy);
+		index_amounts = g_hash_table_new_full (g_direct_hash,
+											   g_direct_equal,
+											   NULL,
+											   (GDestroyNotify) gsb_search_index_amounts_free);
+		index_pending = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+		/* the transactions of the archive segment are added when it is loaded */
+		tmp_list = gsb_data_transaction_get_loaded_transactions_list ();
+		while (tmp_list)
+		{
+			gsb_search_index_add_transaction (gsb_data_transaction_get_transaction_number (tmp_list->data));
+			tmp_list = tmp_list->next;
+		}
+		gsb_search_index_amounts_sort_all (NULL);
+		index_valid = TRUE;
+
+		return;
+	}
+
+	g_hash_table_iter_init (&iter, index_pending);
+	while (g_hash_table_iter_next (&iter, &key, NULL))
+	{
+		gsb_search_index_remove_transaction (GPOINTER_TO_INT (key));
+		gsb_search_index_add_transaction (GPOINTER_TO_INT (key));
+	}
+	gsb_search_index_amounts_sort_all (index_pending);
+	g_hash_table_remove_all (index_pending);
+}
+
+/**
+ * check that the other words of the search are in the words of a
+ * transaction, for the fields searched
+ *
+ * \param entry
+ * \param transaction_number
+ * \param search_words
+ * \param first_word		the word already found
+ * \param fields
+ *
+ * \return TRUE if all the words are found
+ **/
+static gboolean gsb_search_index_entry_contains (SearchIndexEntry *entry,
+												 gint transaction_number,
+												 GPtrArray *search_words,
+												 const gchar *first_word,
+												 guint fields)
+{
+	guint i;
+
+	for (i = 0; i < search_words->len; i++)
+	{
+		const gchar *search_word;
+		gboolean found = FALSE;
+		guint j;
+
+		search_word = g_ptr_array_index (search_words, i);
+		if (search_word == first_word)
+			continue;
+
+		for (j = 0; j < entry->words->len && !found; j++)
+		{
+			GHashTable *transactions;
+			const gchar *word;
+
+			word = g_ptr_array_index (entry->words, j);
+			transactions = g_hash_table_lookup (index_words, word);
+			found = (GPOINTER_TO_UINT (g_hash_table_lookup (transactions,
+															GINT_TO_POINTER (transaction_number))) & fields)
+					&& strstr (word, search_word) != NULL;
+		}
+		if (!found)
+			return FALSE;
+	}
+
+	return TRUE;
+}
+
+/**
+ * add to result the transactions which have the words of the search in
+ * the words of their notes or cheque number.
+ * Only the words of the index which have the rarest n-gram of the longest
+ * word of the search are read.
+ *
+ * \param search_words
+ * \param fields
+ * \param result
+ *
+ * \return
+ **/
+static void gsb_search_index_find_in_words (GPtrArray *search_words,
+											guint fields,
+											GHashTable *result)
+{
+	GHashTable *words;
+	GHashTableIter iter;
+	gpointer key;
+	const gchar *first_word = NULL;
+	guint i;
+
+	for (i = 0; i < search_words->len; i++)
+	{
+		const gchar *search_word;
+
+		search_word = g_ptr_array_index (search_words, i);
+		if (!first_word || strlen (search_word) > strlen (first_word))
+			first_word = search_word;
+	}
+
+	words = gsb_search_index_grams_find (first_word);
+	if (!words)
+		return;
+
+	g_hash_table_iter_init (&iter, words);
+	while (g_hash_table_iter_next (&iter, &key, NULL))
+	{
+		GHashTableIter iter_transactions;
+		gpointer transaction;
+		gpointer word_fields;
+
+		if (!strstr (key, first_word))
+			continue;
+
+		g_hash_table_iter_init (&iter_transactions, g_hash_table_lookup (index_words, key));
+		while (g_hash_table_iter_next (&iter_transactions, &transaction, &word_fields))
+		{
+			SearchIndexEntry *entry;
+
+			if (!(GPOINTER_TO_UINT (word_fields) & fields)
+				|| g_hash_table_contains (result, transaction))
+				continue;
+
+			entry = g_hash_table_lookup (index_entries, transaction);
+			if (entry
+				&& gsb_search_index_entry_contains (entry,
+													GPOINTER_TO_INT (transaction),
+													search_words,
+													first_word,
+													fields))
+				g_hash_table_add (result, transaction);
+		}
+	}
+}
+
+/**
+ * add to result the transactions of the payees whose name has the words
+ * of the search
+ *
+ * \param search_words
+ * \param result
+ *
+ * \return
+ **/
+static void gsb_search_index_find_in_payees (GPtrArray *search_words,
+											 GHashTable *result)
+{
+	GHashTableIter iter;
+	gpointer key;
+	gpointer value;
+
+	g_hash_table_iter_init (&iter, index_payees);
+	while (g_hash_table_iter_next (&iter, &key, &value))
+	{
+		GHashTableIter iter_transactions;
+		gpointer transaction;
+
+		if (!gsb_search_index_text_contains (search_words,
+											 gsb_data_payee_get_name (GPOINTER_TO_INT (key), TRUE)))
+			continue;
+
+		g_hash_table_iter_init (&iter_transactions, value);
+		while (g_hash_table_iter_next (&iter_transactions, &transaction, NULL))
+			g_hash_table_add (result, transaction);
+	}
+}
+
+/******************************************************************************/
+/* Public functions                                                           */
+/******************************************************************************/
+/**
+ * find the transactions, archives included, which may contain a text in
+ * some fields : each word of the text, without case and accents, is in a
+ * word of one of these fields. The caller checks the result with its own
+ * comparison and keeps the transactions of its account.
+ *
+ * \param text
+ * \param fields		the GsbSearchField to search
+ *
+ * \return a set of transaction numbers to free with g_hash_table_destroy,
+ * NULL if the text has no word and the index can't be used
+ **/
+GHashTable *gsb_search_index_find (const gchar *text,
+								   guint fields)
+{
+	GHashTable *result;
+	GPtrArray *search_words;
+
+	search_words = gsb_search_index_get_words (text);
+	if (search_words->len == 0)
+	{
+		g_ptr_array_unref (search_words);
+
+		return NULL;
+	}
+
+	gsb_search_index_update ();
+
+	result = g_hash_table_new (g_direct_hash, g_direct_equal);
+	if (fields & SEARCH_FIELDS_WORDS)
+		gsb_search_index_find_in_words (search_words, fields & SEARCH_FIELDS_WORDS, result);
+	if (fields & SEARCH_FIELD_PAYEE)
+		gsb_search_index_find_in_payees (search_words, result);
+
+	g_ptr_array_unref (search_words);
+
+	return result;
+}
+
+/**
+ * find the transactions of an account, archives included, whose absolute
+ * amount may be between two values. The transactions in another currency
+ * than the account are always returned, the caller checks the result with
+ * gsb_data_transaction_get_adjusted_amount.
+ *
+ * \param account_number
+ * \param abs_min		minimum of the absolute amount
+ * \param abs_max		maximum of the absolute amount
+ *
+ * \return a GArray of the transaction numbers, to free with g_array_unref
+ **/
+GArray *gsb_search_index_find_amount (gint account_number,
+									  GsbReal abs_min,
+									  GsbReal abs_max)
+{
+	SearchIndexAmounts *amounts;
+	GArray *result;
+	gint64 mantissa_min;
+	gint64 mantissa_max;
+	guint low = 0;
+	guint high;
+
+	gsb_search_index_update ();
+
+	/* the index is built again if the currency of the account has changed */
+	amounts = gsb_search_index_get_amounts (account_number);
+	if (amounts->currency_number != gsb_data_account_get_currency (account_number)
+		|| amounts->exponent != gsb_data_account_get_currency_floating_point (account_number))
+	{
+		gsb_search_index_reset ();
+		gsb_search_index_update ();
+		amounts = gsb_search_index_get_amounts (account_number);
+	}
+
+	result = g_array_new (FALSE, FALSE, sizeof (gint));
+	g_array_append_vals (result, amounts->others->data, amounts->others->len);
+
+	/* one more unit on each side for the rounding to the exponent of the account */
+	mantissa_min = gsb_real_adjust_exponent (abs_min, amounts->exponent).mantissa - 1;
+	mantissa_max = gsb_real_adjust_exponent (abs_max, amounts->exponent).mantissa + 1;
+
+	/* first amount not lower than mantissa_min */
+	high = amounts->amounts->len;
+	while (low < high)
+	{
+		guint middle;
+
+		middle = low + (high - low) / 2;
+		if (g_array_index (amounts->amounts, SearchIndexAmount, middle).abs_mantissa < mantissa_min)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+
+	for (; low < amounts->amounts->len; low++)
+	{
+		SearchIndexAmount *amount;
+
+		amount = &g_array_index (amounts->amounts, SearchIndexAmount, low);
+		if (amount->abs_mantissa > mantissa_max)
+			break;
+
+		g_array_append_val (result, amount->transaction_number);
+	}
+
+	return result;
+}
+
+/**
+ * the transaction has been created, modified or deleted, it will be
+ * indexed again at the next use
+ *
+ * \param transaction_number
+ *
+ * \return
+ **/
+void gsb_search_index_mark_transaction (gint transaction_number)
+{
+	if (!index_valid || transaction_number <= 0)
+		return;
+
+	g_hash_table_add (index_pending, GINT_TO_POINTER (transaction_number));
+}
+
+/**
+ * free the index, it will be built again at the next use
+ *
+ * \param
+ *
+ * \return
+ **/
+void gsb_search_index_reset (void)
+{
+	index_valid = FALSE;
+
+	/* the entries point to the keys of index_words */
+	if (index_entries)
+	{
+		g_hash_table_destroy (index_entries);
+		index_entries = NULL;
+	}
+	/* the n-grams point to the keys of index_words */
+	if (index_grams)
+	{
+		g_hash_table_destroy (index_grams);
+		index_grams = NULL;
+	}
+	if (index_words)
+	{
+		g_hash_table_destroy (index_words);
+		index_words = NULL;
+	}
+	if (index_payees)
+	{
+		g_hash_table_destroy (index_payees);
+		index_payees = NULL;
+	}
+	if (index_amounts)
+	{
+		g_hash_table_destroy (index_amounts);
+		index_amounts = NULL;
+	}
+	if (index_pending)
+	{
+		g_hash_table_destroy (index_pending);
+		index_pending = NULL;
+	}
+}
+
+/**
+ *
+ *
+ * \param
+ *
+ * \return
+ **/
+/* Local Variables: */
+/* c-basic-offset: 4 */
+/* End: */
@@ -0,0 +1,29 @@
+#ifndef _GSB_SEARCH_INDEX_H
+#define _GSB_SEARCH_INDEX_H
+
+#include <glib.h>
+
+/* START_INCLUDE_H */
+#include "gsb_real.h"
+/* END_INCLUDE_H */
+
+/* champs des opérations indexés pour la recherche */
+typedef enum _GsbSearchField		GsbSearchField;
+enum _GsbSearchField
+{
+	SEARCH_FIELD_PAYEE				= 1 << 0,
+	SEARCH_FIELD_NOTES				= 1 << 1,
+	SEARCH_FIELD_CHEQUE				= 1 << 2
+};
+
+/* START_DECLARATION */
+GHashTable *	gsb_search_index_find					(const gchar *text,
+														 guint fields);
+GArray *		gsb_search_index_find_amount			(gint account_number,
+														 GsbReal abs_min,
+														 GsbReal abs_max);
+void			gsb_search_index_mark_transaction		(gint transaction_number);
+void			gsb_search_index_reset					(void);
+/* END_DECLARATION */
+
+#endif
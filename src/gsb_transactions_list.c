@@ -3289,6 +3289,54 @@ gboolean gsb_transactions_list_append_new_transaction (gint transaction_number,
 	return FALSE;
 }
 
+/**
+ * append a batch of new transactions in the tree_view, used by the import
+ * the transactions are appended to the model in one time, the counters of
+ * payees, categories and budgets were already marked by the creation of the batch.
+ * the tree view is filtered, sorted and colorized only one time at the end
+ * if the account is showed
+ *
+ * \param account_number		the account of the transactions
+ * \param first_number		the first number of the batch
+ * \param nb_transactions		the number of transactions of the batch
+ *
+ * \return FALSE
+ **/
+gboolean gsb_transactions_list_append_new_transactions_batch (gint account_number,
+															  gint first_number,
+															  gint nb_transactions)
+{
+	GSList *numbers_list = NULL;
+	gint i;
+	GrisbiWinRun *w_run;
+
+	if (nb_transactions <= 0)
+		return FALSE;
+
+	w_run = (GrisbiWinRun *) grisbi_win_get_w_run ();
+
+	for (i = nb_transactions - 1 ; i >= 0 ; i--)
+		numbers_list = g_slist_prepend (numbers_list, GINT_TO_POINTER (first_number + i));
+
+	/* append the transactions to the model without informing the tree view */
+	transaction_list_append_transactions (numbers_list);
+	g_slist_free (numbers_list);
+
+	/* one update of the tree view for all the batch */
+	if (gsb_gui_navigation_get_current_account () == account_number)
+	{
+		gsb_transactions_list_update_tree_view (account_number, TRUE);
+		gsb_data_account_colorize_current_balance (account_number);
+	}
+
+	/* on réaffichera l'accueil */
+	w_run->mise_a_jour_liste_comptes_accueil = TRUE;
+	w_run->mise_a_jour_soldes_minimaux = TRUE;
+	w_run->mise_a_jour_fin_comptes_passifs = TRUE;
+
+	return FALSE;
+}
+
 /**
  * take in a transaction the content to set in a cell of the transaction's list
  * all the value are dupplicate and have to be freed after use (except when NULL)
@@ -21,6 +21,9 @@ gboolean	gsb_transactions_list_add_transactions_from_archive			(gint archive_num
 																		 gboolean show_warning);
 gboolean	gsb_transactions_list_append_new_transaction				(gint transaction_number,
 																		 gboolean update_tree_view);
+gboolean	gsb_transactions_list_append_new_transactions_batch			(gint account_number,
+																		 gint first_number,
+																		 gint nb_transactions);
 void		gsb_transactions_list_clone_template						(GtkWidget *menu_item,
 																		 gpointer null);
 void		gsb_transactions_list_convert_transaction_to_sheduled		(void);
@@ -78,10 +78,30 @@ struct _GtkComboFixPrivate
 
 	gint				type;					/* type : 0 : payee, 1 : category, 2 : budget */
 
+	/* completion index */
+	GPtrArray *			completion_keys;		/* CombofixCompletionKey sorted by key */
+	gchar *				completion_search;		/* last text searched by the completion */
+	gchar *				completion_search_key;	/* normalized completion_search */
+	gsize				completion_search_len;	/* length of completion_search_key */
+	gboolean			completion_found;		/* TRUE if some keys begin by completion_search_key */
+
+	/* index of the first level rows of the store */
+	GHashTable *		parent_rows;			/* list number and normalized text -> GtkTreeIter */
+
     /* old entry */
     gchar *				old_entry;
 };
 
+/* normalized key of a row of the completion, computed once when the row is added */
+typedef struct _CombofixCompletionKey	CombofixCompletionKey;
+
+struct _CombofixCompletionKey
+{
+	gchar *				text;					/* text of the row */
+	gchar *				key;					/* text without accents (casefolded if not case sensitive) */
+	GtkTreeIter			iter;					/* row of the completion store */
+};
+
 G_DEFINE_TYPE_WITH_PRIVATE (GtkComboFix, gtk_combofix, GTK_TYPE_BOX)
 
 enum CombofixColumns
@@ -94,6 +114,13 @@ enum CombofixColumns
     COMBOFIX_N_COLUMNS
 };
 
+enum CombofixCompletionColumns
+{
+    COMBOFIX_COMPLETION_COL_TEXT = 0,   /* string : the text of the completion */
+    COMBOFIX_COMPLETION_COL_KEY,        /* pointer : the CombofixCompletionKey of the row */
+    COMBOFIX_COMPLETION_N_COLUMNS
+};
+
 enum CombofixKeyDirection
 {
     COMBOFIX_UP = 0,
@@ -105,6 +132,371 @@ enum CombofixKeyDirection
 /******************************************************************************/
 /* Private functions                                                          */
 /******************************************************************************/
+/**
+ * return the key used to compare a text in the completion.
+ * Same comparison as gtk when the combofix is not case sensitive,
+ * accents are ignored else.
+ *
+ * \param priv
+ * \param text
+ *
+ * \return a newly allocated string
+ **/
+static gchar *gtk_combofix_completion_normalize (GtkComboFixPrivate *priv,
+												 const gchar *text)
+{
+	gchar *key;
+	gchar *tmp_str;
+
+	if (priv->case_sensitive)
+		return utils_str_remove_accents (text);
+
+	tmp_str = g_utf8_normalize (text, -1, G_NORMALIZE_ALL);
+	if (!tmp_str)
+		return g_strdup ("");
+
+	key = g_utf8_casefold (tmp_str, -1);
+	g_free (tmp_str);
+
+	return key;
+}
+
+/**
+ *
+ *
+ * \param data
+ *
+ * \return
+ **/
+static void gtk_combofix_completion_key_free (gpointer data)
+{
+	CombofixCompletionKey *item = data;
+
+	g_free (item->text);
+	g_free (item->key);
+	g_free (item);
+}
+
+/**
+ * sort function of completion_keys
+ *
+ * \param a
+ * \param b
+ *
+ * \return
+ **/
+static gint gtk_combofix_completion_key_cmp (gconstpointer a,
+											 gconstpointer b)
+{
+	const CombofixCompletionKey *item_a = *(CombofixCompletionKey * const *) a;
+	const CombofixCompletionKey *item_b = *(CombofixCompletionKey * const *) b;
+
+	return strcmp (item_a->key, item_b->key);
+}
+
+/**
+ * return the first index of completion_keys which key is >= key
+ * if prefix is TRUE only the first bytes of the keys are compared
+ * and the search returns the index after the keys beginning by key
+ *
+ * \param priv
+ * \param key
+ * \param prefix
+ *
+ * \return
+ **/
+static guint gtk_combofix_completion_keys_search (GtkComboFixPrivate *priv,
+												  const gchar *key,
+												  gboolean prefix)
+{
+	gsize len;
+	guint low = 0;
+	guint high;
+
+	len = strlen (key);
+	high = priv->completion_keys->len;
+	while (low < high)
+	{
+		CombofixCompletionKey *item;
+		guint middle;
+		gint result;
+
+		middle = low + (high - low) / 2;
+		item = g_ptr_array_index (priv->completion_keys, middle);
+		if (prefix)
+			result = strncmp (item->key, key, len) <= 0;
+		else
+			result = strcmp (item->key, key) < 0;
+
+		if (result)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+
+	return low;
+}
+
+/**
+ * forget the last search of the completion after a change of the keys
+ *
+ * \param priv
+ *
+ * \return
+ **/
+static void gtk_combofix_completion_search_reset (GtkComboFixPrivate *priv)
+{
+	g_free (priv->completion_search);
+	priv->completion_search = NULL;
+	g_free (priv->completion_search_key);
+	priv->completion_search_key = NULL;
+}
+
+/**
+ * sort the keys after a change of the list or of the case sensitivity
+ *
+ * \param priv
+ * \param normalize	TRUE to compute again the keys
+ *
+ * \return
+ **/
+static void gtk_combofix_completion_keys_sort (GtkComboFixPrivate *priv,
+											   gboolean normalize)
+{
+	if (normalize)
+	{
+		guint i;
+
+		for (i = 0; i < priv->completion_keys->len; i++)
+		{
+			CombofixCompletionKey *item;
+
+			item = g_ptr_array_index (priv->completion_keys, i);
+			g_free (item->key);
+			item->key = gtk_combofix_completion_normalize (priv, item->text);
+		}
+	}
+
+	g_ptr_array_sort (priv->completion_keys, gtk_combofix_completion_key_cmp);
+	gtk_combofix_completion_search_reset (priv);
+}
+
+/**
+ * set a row of the completion store and its key
+ *
+ * \param priv
+ * \param store
+ * \param iter		the new row
+ * \param text
+ * \param sorted		TRUE to insert the key at its place, FALSE if
+ * 					gtk_combofix_completion_keys_sort () will be called after
+ *
+ * \return
+ **/
+static void gtk_combofix_completion_set_row (GtkComboFixPrivate *priv,
+											 GtkTreeModel *store,
+											 GtkTreeIter *iter,
+											 const gchar *text,
+											 gboolean sorted)
+{
+	CombofixCompletionKey *item;
+
+	item = g_malloc0 (sizeof (CombofixCompletionKey));
+	item->text = g_strdup (text);
+	item->key = gtk_combofix_completion_normalize (priv, text);
+
+	if (sorted)
+	{
+		g_ptr_array_insert (priv->completion_keys,
+							gtk_combofix_completion_keys_search (priv, item->key, FALSE),
+							item);
+		gtk_combofix_completion_search_reset (priv);
+	}
+	else
+		g_ptr_array_add (priv->completion_keys, item);
+
+	item->iter = *iter;
+	gtk_list_store_set (GTK_LIST_STORE (store),
+						iter,
+						COMBOFIX_COMPLETION_COL_TEXT, text,
+						COMBOFIX_COMPLETION_COL_KEY, item,
+						-1);
+}
+
+/**
+ * remove a row of the completion store and its key
+ *
+ * \param priv
+ * \param store
+ * \param iter
+ *
+ * \return
+ **/
+static void gtk_combofix_completion_remove_row (GtkComboFixPrivate *priv,
+												GtkTreeModel *store,
+												GtkTreeIter *iter)
+{
+	CombofixCompletionKey *item = NULL;
+
+	gtk_tree_model_get (store, iter, COMBOFIX_COMPLETION_COL_KEY, &item, -1);
+	gtk_list_store_remove (GTK_LIST_STORE (store), iter);
+	if (item)
+	{
+		guint index;
+
+		/* the key is found by its place, then among the same keys */
+		index = gtk_combofix_completion_keys_search (priv, item->key, FALSE);
+		while (index < priv->completion_keys->len
+			   && g_ptr_array_index (priv->completion_keys, index) != item)
+			index++;
+
+		if (index < priv->completion_keys->len)
+			g_ptr_array_remove_index (priv->completion_keys, index);
+		gtk_combofix_completion_search_reset (priv);
+	}
+}
+
+/**
+ * return the key of the completion equal to text
+ *
+ * \param priv
+ * \param text
+ *
+ * \return the key or NULL
+ **/
+static CombofixCompletionKey *gtk_combofix_completion_find_item (GtkComboFixPrivate *priv,
+																 const gchar *text)
+{
+	CombofixCompletionKey *item = NULL;
+	gchar *key;
+	guint index;
+
+	key = gtk_combofix_completion_normalize (priv, text);
+	index = gtk_combofix_completion_keys_search (priv, key, FALSE);
+	if (index < priv->completion_keys->len)
+	{
+		item = g_ptr_array_index (priv->completion_keys, index);
+		if (strcmp (item->key, key))
+			item = NULL;
+	}
+	g_free (key);
+
+	return item;
+}
+
+/**
+ * return the key of a first level row in parent_rows
+ *
+ * \param priv
+ * \param text
+ * \param list_number
+ *
+ * \return a newly allocated string
+ **/
+static gchar *gtk_combofix_parent_rows_key (GtkComboFixPrivate *priv,
+											const gchar *text,
+											gint list_number)
+{
+	gchar *key;
+	gchar *tmp_str;
+
+	if (priv->case_sensitive)
+		return g_strdup_printf ("%d:%s", list_number, text);
+
+	tmp_str = g_utf8_casefold (text, -1);
+	key = g_strdup_printf ("%d:%s", list_number, tmp_str);
+	g_free (tmp_str);
+
+	return key;
+}
+
+/**
+ * add a first level row in parent_rows
+ * the reports of the payees are not added, they are removed separately
+ *
+ * \param priv
+ * \param text
+ * \param list_number
+ * \param iter
+ *
+ * \return
+ **/
+static void gtk_combofix_parent_rows_add (GtkComboFixPrivate *priv,
+										  const gchar *text,
+										  gint list_number,
+										  GtkTreeIter *iter)
+{
+	gchar *key;
+
+	if (!text || (priv->type == METATREE_PAYEE && list_number))
+		return;
+
+	key = gtk_combofix_parent_rows_key (priv, text, list_number);
+	if (g_hash_table_contains (priv->parent_rows, key))
+		g_free (key);
+	else
+		g_hash_table_insert (priv->parent_rows, key, gtk_tree_iter_copy (iter));
+}
+
+/**
+ * return the first level row of the store for text
+ *
+ * \param priv
+ * \param text
+ * \param list_number
+ *
+ * \return the iter or NULL
+ **/
+static GtkTreeIter *gtk_combofix_parent_rows_lookup (GtkComboFixPrivate *priv,
+													 const gchar *text,
+													 gint list_number)
+{
+	GtkTreeIter *iter;
+	gchar *key;
+
+	key = gtk_combofix_parent_rows_key (priv, text, list_number);
+	iter = g_hash_table_lookup (priv->parent_rows, key);
+	g_free (key);
+
+	return iter;
+}
+
+/**
+ * fill parent_rows with the first level rows of the store
+ *
+ * \param priv
+ *
+ * \return
+ **/
+static void gtk_combofix_parent_rows_rebuild (GtkComboFixPrivate *priv)
+{
+	GtkTreeIter iter;
+	gboolean valid;
+
+	g_hash_table_remove_all (priv->parent_rows);
+
+	valid = gtk_tree_model_get_iter_first (GTK_TREE_MODEL (priv->store), &iter);
+	while (valid)
+	{
+		gchar *tmp_str;
+		gboolean separator;
+		gint list_number;
+
+		gtk_tree_model_get (GTK_TREE_MODEL (priv->store),
+							&iter,
+							COMBOFIX_COL_REAL_STRING, &tmp_str,
+							COMBOFIX_COL_LIST_NUMBER, &list_number,
+							COMBOFIX_COL_SEPARATOR, &separator,
+							-1);
+
+		if (!separator)
+			gtk_combofix_parent_rows_add (priv, tmp_str, list_number, &iter);
+
+		g_free (tmp_str);
+		valid = gtk_tree_model_iter_next (GTK_TREE_MODEL (priv->store), &iter);
+	}
+}
+
 /**
  *
  *
@@ -222,7 +614,7 @@ static void gtk_combofix_completion_choose_first_item (GtkWidget *entry)
 }
 
 /**
- * insert un item dans la completion
+ * insert un item dans la completion, à sa place dans l'ordre des clés
  *
  * \param
  * \param
@@ -234,8 +626,9 @@ static void gtk_combofix_completion_insert_new_item (GtkComboFix *combofix,
 {
 	GtkEntryCompletion *completion;
 	GtkTreeModel *store;
-	GtkTreeIter iter;
 	GtkTreeIter new_iter;
+	gchar *key;
+	guint index;
     GtkComboFixPrivate *priv;
 
 	priv = gtk_combofix_get_instance_private (combofix);
@@ -243,97 +636,71 @@ static void gtk_combofix_completion_insert_new_item (GtkComboFix *combofix,
 	completion = gtk_entry_get_completion (GTK_ENTRY (priv->entry));
 	store = gtk_entry_completion_get_model (completion);
 
-	if (gtk_tree_model_get_iter_first (store, &iter))
-	{
-		do
-		{
-			gchar *tmp_str;
-			gchar *str_to_free1;
-			gchar *str_to_free2;
-
-			gtk_tree_model_get (store, &iter, 0, &tmp_str, -1);
-			if (!tmp_str)
-				continue;
-
-			str_to_free1 = g_utf8_casefold (text, -1);
-			str_to_free2 = g_utf8_casefold (tmp_str, -1);
-			if (g_utf8_collate (str_to_free1, str_to_free2) < 0)
-			{
-				gtk_list_store_insert_before (GTK_LIST_STORE (store), &new_iter, &iter);
-				gtk_list_store_set (GTK_LIST_STORE (store), &new_iter, 0, text, -1);
-				g_free (str_to_free1);
-				g_free (str_to_free2);
-				g_free (tmp_str);
+	key = gtk_combofix_completion_normalize (priv, text);
+	index = gtk_combofix_completion_keys_search (priv, key, FALSE);
+	g_free (key);
 
-				return;
-			}
-			g_free (str_to_free1);
-			g_free (str_to_free2);
-			g_free (tmp_str);
-		}
-		while (gtk_tree_model_iter_next (store, &iter));
+	if (index < priv->completion_keys->len)
+	{
+		CombofixCompletionKey *item;
 
-		/* si on est là c'est qu'on est à la fin de la liste on ajoute le texte */
-		gtk_list_store_append (GTK_LIST_STORE (store), &new_iter);
-		gtk_list_store_set (GTK_LIST_STORE (store), &new_iter, 0, text, -1);
+		item = g_ptr_array_index (priv->completion_keys, index);
+		gtk_list_store_insert_before (GTK_LIST_STORE (store), &new_iter, &item->iter);
 	}
 	else
-	{
 		gtk_list_store_append (GTK_LIST_STORE (store), &new_iter);
-		gtk_list_store_set (GTK_LIST_STORE (store), &new_iter, 0, text, -1);
-	}
+
+	gtk_combofix_completion_set_row (priv, store, &new_iter, text, TRUE);
 }
 
 /**
+ * match function of the completion. The text of the entry is normalized
+ * once by search and the sorted keys tell if some rows begin by it, so
+ * each row is tested without allocation.
  *
+ * \param completion
+ * \param key			unused, the text of the entry is used
+ * \param iter
+ * \param combofix
  *
- * \param
- *
- * \return
+ * \return TRUE if the row begins with the text of the entry
  **/
 static gboolean  gtk_combofix_completion_match_func (GtkEntryCompletion *completion,
 													 const gchar *key,
 													 GtkTreeIter *iter,
-													 gpointer user_data)
+													 GtkComboFix *combofix)
 {
+	CombofixCompletionKey *item = NULL;
 	GtkTreeModel *model;
-	gchar *new_key;
-	gchar *new_text;
 	const gchar *search;
-	gchar *text;
-	gchar *tmp_text;
-	gssize nbre_bytes;
-
-	model = gtk_entry_completion_get_model (completion);
-	gtk_tree_model_get (model, iter, 0, &text, -1);
+	GtkComboFixPrivate *priv;
 
-	if (!text)
-		return FALSE;
+	priv = gtk_combofix_get_instance_private (combofix);
 
 	search = gtk_entry_get_text (GTK_ENTRY (gtk_entry_completion_get_entry (completion)));
 	if (!search)
 		return FALSE;
 
-	new_key = utils_str_remove_accents (search);
-	tmp_text = utils_str_remove_accents (text);
-	nbre_bytes = strlen (new_key);
-	new_text = g_strndup (tmp_text, nbre_bytes);
-	g_free (tmp_text);
-
-	if (g_strcmp0 (new_text, new_key) == 0)
+	/* new search: normalize the text and look if some keys begin by it */
+	if (!priv->completion_search || strcmp (search, priv->completion_search))
 	{
-		g_free (new_key);
-		g_free (new_text);
-		return TRUE;
+		gtk_combofix_completion_search_reset (priv);
+		priv->completion_search = g_strdup (search);
+		priv->completion_search_key = gtk_combofix_completion_normalize (priv, search);
+		priv->completion_search_len = strlen (priv->completion_search_key);
+		priv->completion_found = gtk_combofix_completion_keys_search (priv, priv->completion_search_key, FALSE)
+								 < gtk_combofix_completion_keys_search (priv, priv->completion_search_key, TRUE);
 	}
-	else
-	{
-		g_free (new_key);
-		g_free (new_text);
+
+	if (!priv->completion_found)
 		return FALSE;
-	}
 
-	return FALSE;
+	model = gtk_entry_completion_get_model (completion);
+	gtk_tree_model_get (model, iter, COMBOFIX_COMPLETION_COL_KEY, &item, -1);
+	if (!item)
+		return FALSE;
+
+	return strncmp (item->key, priv->completion_search_key, priv->completion_search_len) == 0;
 }
 
 /**
@@ -465,50 +832,6 @@ static gboolean gtk_combofix_search_report (GtkTreeModel *model,
     return FALSE;
 }
 
-/**
- * vérifie si la chaine text existe déjà
- *
- * \param
- * \param
- * \param
- * \param
- *
- * \return TRUE si trouvé FALSE autrement
- **/
-static gboolean gtk_combofix_search_for_text (GtkTreeModel *model,
-											  GtkTreePath *path,
-											  GtkTreeIter *iter,
-											  gpointer *data)
-{
-    gchar *tmp_str;
-    gboolean case_sensitive;
-    gboolean separator;
-    gint return_value;
-
-    gtk_tree_model_get (GTK_TREE_MODEL(model),
-						iter,
-			            COMBOFIX_COL_REAL_STRING, &tmp_str,
-                        COMBOFIX_COL_SEPARATOR, &separator,
-			            -1);
-
-    if (separator)
-    {
-        g_free (tmp_str);
-        return FALSE;
-    }
-
-    case_sensitive = GPOINTER_TO_INT (data[2]);
-    if (case_sensitive)
-        return_value = !strcmp ((gchar *) data[0], tmp_str);
-    else
-        return_value = !g_utf8_collate (g_utf8_casefold ((gchar *) data[0], -1),
-                                         g_utf8_casefold (tmp_str, -1));
-    if (return_value)
-        data[1] = GINT_TO_POINTER (1);
-
-    return return_value;
-}
-
 /**
  * fill a parent_iter of the model given in param
  * with the string given in param
@@ -634,7 +957,7 @@ static gboolean gtk_combofix_fill_store (GtkComboFix *combofix,
 
 					/* append a row in the completion */
 					gtk_list_store_append (GTK_LIST_STORE (completion_store), &new_iter);
-					gtk_list_store_set (GTK_LIST_STORE (completion_store), &new_iter, 0, tmp_str, -1);
+					gtk_combofix_completion_set_row (priv, completion_store, &new_iter, tmp_str, FALSE);
 					g_free (tmp_str);
 				}
 				else
@@ -653,7 +976,7 @@ static gboolean gtk_combofix_fill_store (GtkComboFix *combofix,
 					if (g_utf8_collate (free_str1, free_str2))
 					{
 						gtk_list_store_append (GTK_LIST_STORE (completion_store), &new_iter);
-						gtk_list_store_set (GTK_LIST_STORE (completion_store), &new_iter, 0, string, -1);
+						gtk_combofix_completion_set_row (priv, completion_store, &new_iter, string, FALSE);
 					}
 					g_free (free_str2);
 				}
@@ -680,13 +1003,13 @@ static gboolean gtk_combofix_fill_store (GtkComboFix *combofix,
 						if (nbre_sub_division == 0)
 						{
 							gtk_list_store_append (GTK_LIST_STORE (completion_store), &new_iter);
-							gtk_list_store_set (GTK_LIST_STORE (completion_store), &new_iter, 0, string, -1);
+							gtk_combofix_completion_set_row (priv, completion_store, &new_iter, string, FALSE);
 						}
 					}
 					else
 					{
 						gtk_list_store_append (GTK_LIST_STORE (completion_store), &new_iter);
-						gtk_list_store_set (GTK_LIST_STORE (completion_store), &new_iter, 0, string, -1);
+						gtk_combofix_completion_set_row (priv, completion_store, &new_iter, string, FALSE);
 					}
 				}
 
@@ -1676,17 +1999,17 @@ static void gtk_combofix_create_entry (GtkComboFix *combofix)
 	/* set completion */
 	completion = gtk_entry_completion_new ();
 	gtk_entry_completion_set_inline_selection (completion, TRUE);
-	if (w_etat->combofix_case_sensitive)
-		gtk_entry_completion_set_match_func (completion,
-											 (GtkEntryCompletionMatchFunc) gtk_combofix_completion_match_func,
-											 NULL,
-											 NULL);
+	priv->case_sensitive = w_etat->combofix_case_sensitive;
+	gtk_entry_completion_set_match_func (completion,
+										 (GtkEntryCompletionMatchFunc) gtk_combofix_completion_match_func,
+										 combofix,
+										 NULL);
 	gtk_entry_completion_set_minimum_key_length (completion, a_conf->completion_minimum_key_length);
 	gtk_entry_completion_set_popup_single_match (completion, TRUE);
 	gtk_entry_completion_set_text_column (completion, 0);
 
 	/* set store */
-	completion_store = gtk_list_store_new (1, G_TYPE_STRING);
+	completion_store = gtk_list_store_new (COMBOFIX_COMPLETION_N_COLUMNS, G_TYPE_STRING, G_TYPE_POINTER);
 	gtk_entry_completion_set_model (completion, GTK_TREE_MODEL (completion_store));
 
 	/* set entry completion */
@@ -1843,6 +2166,11 @@ static void gtk_combofix_init (GtkComboFix *combofix)
     priv->visible_items = 0;
 	priv->ignore_accents = TRUE;		/* reproduit le fonctionnement de la completion de gtk */
 	priv->minimum_key_length = 1;		/* la recherche commence au premier caractère */
+	priv->completion_keys = g_ptr_array_new_with_free_func (gtk_combofix_completion_key_free);
+	priv->parent_rows = g_hash_table_new_full (g_str_hash,
+											   g_str_equal,
+											   g_free,
+											   (GDestroyNotify) gtk_tree_iter_free);
 
     /* the combofix is a vbox */
     vbox = gtk_box_new (GTK_ORIENTATION_VERTICAL, 0);
@@ -1894,6 +2222,9 @@ static void gtk_combofix_finalize (GObject *combofix)
     if (priv->old_entry && strlen (priv->old_entry))
         g_free (priv->old_entry);
 
+	g_free (priv->completion_search);
+	g_free (priv->completion_search_key);
+
     /* Unref/free the model first, to workaround gtk/gail bug #694711 */
     gtk_tree_view_set_model (GTK_TREE_VIEW (priv->tree_view), NULL);
     g_object_unref (priv->model_sort);
@@ -1903,6 +2234,10 @@ static void gtk_combofix_finalize (GObject *combofix)
     gtk_widget_destroy (priv->popup);
     g_object_unref (priv->popup);
 
+	/* the completion store is freed with the entry */
+	g_ptr_array_unref (priv->completion_keys);
+	g_hash_table_destroy (priv->parent_rows);
+
     G_OBJECT_CLASS (gtk_combofix_parent_class)->finalize (combofix);
 }
 
@@ -2099,22 +2434,12 @@ void gtk_combofix_set_properties (GtkWidget *combofix)
 		priv->mixed_sort = FALSE;
 	}
     priv->case_sensitive = w_etat->combofix_case_sensitive;
+
+	/* the keys of the completion depend on the case sensitivity */
 	if (old_case_sensitive - w_etat->combofix_case_sensitive)
 	{
-		GtkEntryCompletion *completion;
-
-		completion = gtk_entry_get_completion (GTK_ENTRY (priv->entry));
-		if (old_case_sensitive)
-		{
-			gtk_entry_completion_set_match_func (completion, NULL, NULL, NULL);
-		}
-		else
-		{
-			gtk_entry_completion_set_match_func (completion,
-												 (GtkEntryCompletionMatchFunc) gtk_combofix_completion_match_func,
-												 NULL,
-												 NULL);
-		}
+		gtk_combofix_completion_keys_sort (priv, TRUE);
+		gtk_combofix_parent_rows_rebuild (priv);
 	}
 }
 
@@ -2159,22 +2484,12 @@ void gtk_combofix_set_case_sensitive (GtkComboFix *combofix,
     priv = gtk_combofix_get_instance_private (combofix);
 	old_case_sensitive = priv->case_sensitive;
     priv->case_sensitive = case_sensitive;
+
+	/* the keys of the completion depend on the case sensitivity */
 	if (old_case_sensitive - case_sensitive)
 	{
-		GtkEntryCompletion *completion;
-
-		completion = gtk_entry_get_completion (GTK_ENTRY (priv->entry));
-		if (old_case_sensitive)
-		{
-			gtk_entry_completion_set_match_func (completion, NULL, NULL, NULL);
-		}
-		else
-		{
-			gtk_entry_completion_set_match_func (completion,
-												 (GtkEntryCompletionMatchFunc) gtk_combofix_completion_match_func,
-												 NULL,
-												 NULL);
-		}
+		gtk_combofix_completion_keys_sort (priv, TRUE);
+		gtk_combofix_parent_rows_rebuild (priv);
 	}
 }
 
@@ -2280,6 +2595,7 @@ gboolean gtk_combofix_set_list (GtkComboFix *combofix,
 	completion_store = gtk_entry_completion_get_model (completion);
 	if (GTK_LIST_STORE (completion_store))
 		gtk_list_store_clear (GTK_LIST_STORE (completion_store));
+	g_ptr_array_set_size (priv->completion_keys, 0);
 
     tmp_list = list;
     length = g_slist_length (list);
@@ -2303,6 +2619,10 @@ gboolean gtk_combofix_set_list (GtkComboFix *combofix,
         tmp_list = tmp_list->next;
     }
 
+	/* the keys of the completion are sorted only one time */
+	gtk_combofix_completion_keys_sort (priv, FALSE);
+	gtk_combofix_parent_rows_rebuild (priv);
+
     return TRUE;
 }
 
@@ -2318,7 +2638,6 @@ void gtk_combofix_append_text (GtkComboFix *combofix,
 {
 	GtkTreeIter iter_parent;
     gint empty;
-    gpointer pointeurs[3] = { (gpointer) text, NULL, NULL };
     GtkComboFixPrivate *priv;
 
 	if (!combofix || !GTK_IS_COMBOFIX (combofix))
@@ -2330,8 +2649,6 @@ void gtk_combofix_append_text (GtkComboFix *combofix,
 	if (priv-> type)
 		return;
 
-	pointeurs[2] = GINT_TO_POINTER (priv->case_sensitive);
-
     empty = GPOINTER_TO_INT (g_object_get_data (G_OBJECT (priv->entry), "empty"));
 	if (empty || priv->force)
 		return;
@@ -2339,14 +2656,12 @@ void gtk_combofix_append_text (GtkComboFix *combofix,
 	if (priv->old_entry && strcmp (text, priv->old_entry) == 0)
         return;
 
-    gtk_tree_model_foreach (GTK_TREE_MODEL (priv->store),
-							(GtkTreeModelForeachFunc) gtk_combofix_search_for_text,
-							pointeurs);
-
-	if (pointeurs[1] && GINT_TO_POINTER (pointeurs[1]))
+	/* the text exists already */
+	if (gtk_combofix_parent_rows_lookup (priv, text, 0))
 		return;
 
 	gtk_combofix_fill_iter_parent (priv->store, &iter_parent, text, 0);
+	gtk_combofix_parent_rows_add (priv, text, 0, &iter_parent);
 
     if (priv->old_entry && strlen (priv->old_entry))
         g_free (priv->old_entry);
@@ -2356,6 +2671,67 @@ void gtk_combofix_append_text (GtkComboFix *combofix,
 	gtk_combofix_completion_insert_new_item (combofix, text);
 }
 
+/**
+ * append a division or a sub-division in a combofix of categories
+ * or budgets without rebuilding the list
+ *
+ * \param combofix
+ * \param div_name		name of the division
+ * \param sub_div_name	name of the sub-division or NULL
+ * \param list_number	the number of the list (0 debit, 1 credit)
+ *
+ * \return
+ **/
+void gtk_combofix_append_division (GtkComboFix *combofix,
+								   const gchar *div_name,
+								   const gchar *sub_div_name,
+								   gint list_number)
+{
+	GtkTreeIter iter_parent;
+	GtkTreeIter *parent_iter;
+    GtkComboFixPrivate *priv;
+
+	if (!combofix || !GTK_IS_COMBOFIX (combofix) || !div_name)
+		return;
+
+    priv = gtk_combofix_get_instance_private (combofix);
+
+	parent_iter = gtk_combofix_parent_rows_lookup (priv, div_name, list_number);
+	if (parent_iter)
+		iter_parent = *parent_iter;
+	else
+	{
+		gtk_combofix_fill_iter_parent (priv->store, &iter_parent, div_name, list_number);
+		gtk_combofix_parent_rows_add (priv, div_name, list_number, &iter_parent);
+		priv->visible_items++;
+
+		/* same rule as gtk_combofix_fill_store () for the completion */
+		if (!sub_div_name || !priv->force)
+			gtk_combofix_completion_insert_new_item (combofix, div_name);
+	}
+
+	if (sub_div_name)
+	{
+		CombofixCompletionKey *item;
+		gchar *real_string;
+
+		real_string = g_strconcat (div_name, " : ", sub_div_name, NULL);
+		gtk_combofix_fill_iter_child (priv->store, &iter_parent, sub_div_name, real_string, list_number);
+		priv->visible_items++;
+		gtk_combofix_completion_insert_new_item (combofix, real_string);
+		g_free (real_string);
+
+		/* if force is set, a division with sub-divisions is not in the completion */
+		if (priv->force && (item = gtk_combofix_completion_find_item (priv, div_name)))
+		{
+			GtkEntryCompletion *completion;
+
+			completion = gtk_entry_get_completion (GTK_ENTRY (priv->entry));
+			gtk_combofix_completion_remove_row (priv, gtk_entry_completion_get_model (completion), &item->iter);
+		}
+	}
+}
+
 /**
  * append a report as payee in a combofix
  *
@@ -2406,7 +2782,7 @@ void gtk_combofix_append_report (GtkComboFix *combofix,
 	completion = gtk_entry_get_completion (GTK_ENTRY (priv->entry));
 	completion_model = gtk_entry_completion_get_model (completion);
 	gtk_list_store_append (GTK_LIST_STORE (completion_model), &new_iter);
-	gtk_list_store_set (GTK_LIST_STORE (completion_model), &new_iter, 0, tmp_str2, -1);
+	gtk_combofix_completion_set_row (priv, completion_model, &new_iter, tmp_str2, TRUE);
     g_free (tmp_str2);
 }
 
@@ -2420,82 +2796,30 @@ void gtk_combofix_append_report (GtkComboFix *combofix,
 void gtk_combofix_remove_text (GtkComboFix *combofix,
 							   const gchar *text)
 {
+	CombofixCompletionKey *item;
 	GtkEntryCompletion *completion;
-	GtkTreeModel *completion_model;
-    GtkTreeIter iter;
-    gboolean case_sensitive;
-    gboolean valid;
+	GtkTreeIter *iter;
+	gchar *key;
     GtkComboFixPrivate *priv;
 
     priv = gtk_combofix_get_instance_private (combofix);
 
-	case_sensitive = priv->case_sensitive;
-    valid = gtk_tree_model_get_iter_first (GTK_TREE_MODEL (priv->store), &iter);
-
-    while (valid)
-    {
-        gchar *tmp_str;
-        gboolean separator;
-
-        gtk_tree_model_get (GTK_TREE_MODEL (priv->store),
-							&iter,
-							COMBOFIX_COL_REAL_STRING, &tmp_str,
-							COMBOFIX_COL_SEPARATOR, &separator,
-							-1);
-
-        if (separator)
-        {
-            valid = gtk_tree_model_iter_next (GTK_TREE_MODEL (priv->store), &iter);
-            continue;
-        }
-        if (case_sensitive && !strcmp (text, tmp_str))
-        {
-            g_free (tmp_str);
-            break;
-        }
-        else if (!g_utf8_collate (g_utf8_casefold (text, -1), g_utf8_casefold (tmp_str, -1)))
-        {
-            g_free (tmp_str);
-            break;
-        }
-
-        g_free (tmp_str);
-
-        valid = gtk_tree_model_iter_next (GTK_TREE_MODEL (priv->store), &iter);
-    }
-
-	if (valid)
-		gtk_tree_store_remove (priv->store, &iter);
+	key = gtk_combofix_parent_rows_key (priv, text, 0);
+	iter = g_hash_table_lookup (priv->parent_rows, key);
+	if (iter)
+	{
+		gtk_tree_store_remove (priv->store, iter);
+		g_hash_table_remove (priv->parent_rows, key);
+	}
+	g_free (key);
 
 	/* update completion */
-	completion = gtk_entry_get_completion (GTK_ENTRY (priv->entry));
-	completion_model = gtk_entry_completion_get_model (completion);
-    valid = gtk_tree_model_get_iter_first (completion_model, &iter);
-
-    while (valid)
-    {
-        gchar *tmp_str;
-
-        gtk_tree_model_get (completion_model, &iter, 0, &tmp_str, -1);
-
-        if (case_sensitive && !strcmp (text, tmp_str))
-        {
-            g_free (tmp_str);
-            break;
-}
-        else if (!g_utf8_collate (g_utf8_casefold (text, -1), g_utf8_casefold (tmp_str, -1)))
-        {
-            g_free (tmp_str);
-            break;
-        }
-
-        g_free (tmp_str);
-
-        valid = gtk_tree_model_iter_next (completion_model, &iter);
-    }
-
-    if (valid)
-        gtk_list_store_remove (GTK_LIST_STORE (completion_model), &iter);
+	item = gtk_combofix_completion_find_item (priv, text);
+	if (item)
+	{
+		completion = gtk_entry_get_completion (GTK_ENTRY (priv->entry));
+		gtk_combofix_completion_remove_row (priv, gtk_entry_completion_get_model (completion), &item->iter);
+	}
 }
 
 
@@ -2510,13 +2834,13 @@ void gtk_combofix_remove_text (GtkComboFix *combofix,
 void gtk_combofix_remove_report (GtkComboFix *combofix,
 								 const gchar *report_name)
 {
+	CombofixCompletionKey *item;
 	GtkEntryCompletion *completion;
 	GtkTreeModel *completion_model;
     GtkTreeIter iter;
     gchar *tmp_str;
     gchar *tmp_str2;
     gboolean valid;
-	GrisbiWinEtat *w_etat;
     GtkComboFixPrivate *priv;
 
     /* on récupère le nom de l'état */
@@ -2583,33 +2907,13 @@ void gtk_combofix_remove_report (GtkComboFix *combofix,
     }
 
 	/* update completion */
-	completion = gtk_entry_get_completion (GTK_ENTRY (priv->entry));
-	completion_model = gtk_entry_completion_get_model (completion);
-	valid = gtk_tree_model_get_iter_first (completion_model, &iter);
-	w_etat = grisbi_win_get_w_etat ();
-
-    while (valid)
-    {
-        gtk_tree_model_get (completion_model, &iter, 0, &tmp_str, -1);
-
-        if (w_etat->combofix_case_sensitive && !strcmp (tmp_str2, tmp_str))
-        {
-            g_free (tmp_str);
-            break;
-        }
-        else if (!g_utf8_collate (g_utf8_casefold (tmp_str2, -1), g_utf8_casefold (tmp_str, -1)))
-        {
-            g_free (tmp_str);
-            break;
-        }
-
-        g_free (tmp_str);
-
-        valid = gtk_tree_model_iter_next (completion_model, &iter);
-    }
-
-    if (valid)
-        gtk_list_store_remove (GTK_LIST_STORE (completion_model), &iter);
+	item = gtk_combofix_completion_find_item (priv, tmp_str2);
+	if (item)
+	{
+		completion = gtk_entry_get_completion (GTK_ENTRY (priv->entry));
+		completion_model = gtk_entry_completion_get_model (completion);
+		gtk_combofix_completion_remove_row (priv, completion_model, &item->iter);
+	}
     g_free (tmp_str2);
 }
 
@@ -66,6 +66,10 @@ gboolean 		gtk_combofix_show_popup					(GtkComboFix *combofix);
 gboolean 		gtk_combofix_hide_popup					(GtkComboFix *combofix);
 
 /* list of items */
+void			gtk_combofix_append_division			(GtkComboFix *combofix,
+														 const gchar *div_name,
+														 const gchar *sub_div_name,
+														 gint list_number);
 void 			gtk_combofix_append_report				(GtkComboFix *combofix,
 														 const gchar *report_name);
 void 			gtk_combofix_append_text				(GtkComboFix *combofix,
@@ -113,6 +113,9 @@ gchar *				charmap_imported;
 
 static gboolean		add_csv_page = FALSE;
 
+/* TRUE when the files are imported without user (gsb_import_by_rule_directory) */
+static gboolean		import_unattended = FALSE;
+
 /* gestion des associations entre un tiers et sa chaine de recherche */
 GSList *			liste_associations_tiers = NULL;
 ImportPayeeAsso *	last_added_assoc;
@@ -120,6 +123,22 @@ ImportPayeeAsso *	last_added_assoc;
 /* nombre de transaction à importer qui affiche une barre de progression */
 #define NBRE_TRANSACTION_FOR_PROGRESS_BAR 250
 
+static GtkWidget *gsb_import_show_orphan_transactions (GSList *orphan_list,
+													   gint account_number);
+
+/* clé de l'index des virements importés à lier :
+ * compte de l'opé, compte destinataire, date et valeur absolue du montant */
+typedef struct _ImportTransferKey		ImportTransferKey;
+
+struct _ImportTransferKey
+{
+	gint		account_number;
+	gint		contra_account_number;
+	guint32		julian_day;
+	gint		currency_number;
+	gint64		abs_mantissa;
+};
+
 /** Known built-in import formats.  Others are plugins. */
 static ImportFormat builtin_formats[] =
 {
@@ -2276,13 +2295,16 @@ static void gsb_import_progress_bar_pulse (GtkWidget *progress,
  *
  * \param imported_transaction the transaction to import
  * \param account_number the account where to put the new transaction
- * \param
+ * \param origine
+ * \param reserved_number the number of a transaction created before by
+ * 		  gsb_data_transaction_new_transactions_batch, 0 to create a new transaction
  *
  * \return the number of the new transaction
  **/
 static gint gsb_import_create_transaction (ImportTransaction *imported_transaction,
 										   gint account_number,
-										   gchar *origine)
+										   gchar *origine,
+										   gint reserved_number)
 {
 	gchar **tab_str;
 	gchar *tmp_str = NULL;
@@ -2298,6 +2320,9 @@ static gint gsb_import_create_transaction (ImportTransaction *imported_transacti
 
 	if (w_etat->fusion_import_transactions && imported_transaction->ope_correspondante > 0)
 		transaction_number = imported_transaction->ope_correspondante;
+	else if (reserved_number > 0)
+		/* the transaction was created before with the batch */
+		transaction_number = reserved_number;
 	else
 		/* we create the new transaction */
 		transaction_number = gsb_data_transaction_new_transaction (account_number);
@@ -2697,7 +2722,10 @@ static gint gsb_import_create_transaction (ImportTransaction *imported_transacti
 					tmp_str = g_strdup_printf (_("Warning: the cheque number %s is already used.\n"
 												 "We skip it"),
 											   imported_transaction->cheque);
-					dialogue_warning (tmp_str);
+					if (import_unattended)
+						g_message ("%s", tmp_str);
+					else
+						dialogue_warning (tmp_str);
 					g_free (tmp_str);
 				}
 				else
@@ -3818,6 +3846,10 @@ static gboolean gsb_import_set_id_compte (gint account_nb,
 			gchar *tmp_str;
 			gchar *tmp_str2;
 
+			/* without user, we don't change the id and the account is ignored */
+			if (import_unattended)
+				return FALSE;
+
 		/* l'id du compte choisi et l'id du compte importé sont différents */
 		/* on propose encore d'arrêter... */
 			tmp_str2 = my_strdup (imported_id);
@@ -3856,15 +3888,19 @@ static gboolean gsb_import_set_id_compte (gint account_nb,
  * \param imported_account an imported structure account which contains the transactions
  * \param account_number the number of account where we want to put the new transations
  *
- * \return
+ * \return the number of created or merged transactions
  **/
-static void gsb_import_add_imported_transactions (ImportAccount *imported_account,
+static gint gsb_import_add_imported_transactions (ImportAccount *imported_account,
 												  gint account_number,
 												  GtkWindow *parent)
 {
 	GSList *tmp_list;
 	GDate *first_date_import = NULL;
 	gint demande_confirmation;
+	gint first_number;
+	gint nb_merged_transactions = 0;
+	gint nb_new_transactions = 0;
+	gint reserved_number;
 	GrisbiWinEtat *w_etat;
 
 	w_etat = grisbi_win_get_w_etat ();
@@ -3874,7 +3910,7 @@ static void gsb_import_add_imported_transactions (ImportAccount *imported_accoun
 	if (imported_account->id_compte)
 	{
 		if (!gsb_import_set_id_compte (account_number, imported_account->id_compte))
-			return;
+			return 0;
 	}
 
 	/* on fait un premier tour de la liste des opés pour repérer celles qui sont déjà entrées
@@ -3896,13 +3932,45 @@ static void gsb_import_add_imported_transactions (ImportAccount *imported_accoun
 
 	g_date_free (first_date_import);
 
-	/* if we are not sure about some transactions, ask now */
+	/* if we are not sure about some transactions, ask now. Without user,
+	 * the doubtful transactions are left to not create duplicates */
 	if (demande_confirmation)
-		gsb_import_confirmation_enregistrement_ope_import (imported_account, account_number, parent);
+	{
+		if (import_unattended)
+		{
+			for (tmp_list = imported_account->operations_importees; tmp_list; tmp_list = tmp_list->next)
+			{
+				ImportTransaction *imported_transaction;
+
+				imported_transaction = tmp_list->data;
+				if (imported_transaction->action == IMPORT_TRANSACTION_ASK_FOR_TRANSACTION)
+					imported_transaction->action = IMPORT_TRANSACTION_LEAVE_TRANSACTION;
+			}
+		}
+		else
+			gsb_import_confirmation_enregistrement_ope_import (imported_account, account_number, parent);
+	}
 
 	/* ok, now we know what to do for each transactions, can import to the account */
 	mother_transaction_number = 0;
 
+	/* count the new transactions to create them in one time */
+	tmp_list = imported_account->operations_importees;
+	while (tmp_list)
+	{
+		ImportTransaction *imported_transaction;
+
+		imported_transaction = tmp_list->data;
+		if (imported_transaction->action == IMPORT_TRANSACTION_GET_TRANSACTION
+			&& !(w_etat->fusion_import_transactions && imported_transaction->ope_correspondante > 0))
+			nb_new_transactions++;
+
+		tmp_list = tmp_list->next;
+	}
+
+	first_number = gsb_data_transaction_new_transactions_batch (account_number, nb_new_transactions);
+	reserved_number = first_number;
+
 	tmp_list = imported_account->operations_importees;
 	while (tmp_list)
 	{
@@ -3922,39 +3990,46 @@ static void gsb_import_add_imported_transactions (ImportAccount *imported_accoun
 				imported_transaction->devise = gsb_data_currency_get_number_by_code_iso4217 (
 						imported_account->devise);
 
-		transaction_number = gsb_import_create_transaction (imported_transaction,
-																account_number,
-																imported_account->origine);
-
 			if (w_etat->fusion_import_transactions
 				&& imported_transaction->ope_correspondante > 0)
-		{
-			transaction_list_update_transaction (transaction_number);
-			tmp_list = tmp_list->next;
+			{
+				transaction_number = gsb_import_create_transaction (imported_transaction,
+																	account_number,
+																	imported_account->origine,
+																	0);
+				transaction_list_update_transaction (transaction_number);
+				nb_merged_transactions++;
+				tmp_list = tmp_list->next;
 				continue;
 			}
 
-		/* invert the amount of the transaction if asked */
-		if (imported_account->invert_transaction_amount)
-		{
-			gsb_data_transaction_set_amount (transaction_number,
+			transaction_number = gsb_import_create_transaction (imported_transaction,
+																account_number,
+																imported_account->origine,
+																reserved_number);
+			reserved_number++;
+
+			/* invert the amount of the transaction if asked */
+			if (imported_account->invert_transaction_amount)
+			{
+				gsb_data_transaction_set_amount (transaction_number,
 												 gsb_real_opposite
 												 (gsb_data_transaction_get_amount (transaction_number)));
-		}
-
-		/* we need to add the transaction now to the tree model here
-		 * to avoid to write again all the account */
-			gsb_transactions_list_append_new_transaction (transaction_number, FALSE);
+			}
 		}
 		tmp_list = tmp_list->next;
 	}
 
-	/* if we are on the current account, we need to update the tree_view */
-	if (gsb_gui_navigation_get_current_account () == account_number)
+	/* we add now all the new transactions to the tree model and update the tree_view
+	 * only one time if we are on the current account */
+	gsb_transactions_list_append_new_transactions_batch (account_number, first_number, nb_new_transactions);
+	if (!nb_new_transactions && gsb_gui_navigation_get_current_account () == account_number)
 	{
 		gsb_transactions_list_update_tree_view (account_number, TRUE);
 		gsb_data_account_colorize_current_balance (account_number);
 	}
+
+	return nb_new_transactions + nb_merged_transactions;
 }
 
 /**
@@ -4013,13 +4088,307 @@ static gboolean gsb_import_check_transaction_link (gint transaction_number,
 	return TRUE;
 }
 
+/**
+ * hash function of the index of the imported transfers
+ *
+ * \param key an ImportTransferKey
+ *
+ * \return the hash
+ **/
+static guint gsb_import_transfer_key_hash (gconstpointer key)
+{
+	const ImportTransferKey *transfer_key = key;
+	guint hash;
+
+	hash = (guint) transfer_key->account_number;
+	hash = hash * 31 + (guint) transfer_key->contra_account_number;
+	hash = hash * 31 + transfer_key->julian_day;
+	hash = hash * 31 + (guint) transfer_key->currency_number;
+	hash = hash * 31 + (guint) (transfer_key->abs_mantissa ^ (transfer_key->abs_mantissa >> 32));
+
+	return hash;
+}
+
+/**
+ * equal function of the index of the imported transfers
+ *
+ * \param a an ImportTransferKey
+ * \param b an ImportTransferKey
+ *
+ * \return TRUE if the keys are the same
+ **/
+static gboolean gsb_import_transfer_key_equal (gconstpointer a,
+											   gconstpointer b)
+{
+	const ImportTransferKey *key_a = a;
+	const ImportTransferKey *key_b = b;
+
+	return (key_a->account_number == key_b->account_number
+			&& key_a->contra_account_number == key_b->contra_account_number
+			&& key_a->julian_day == key_b->julian_day
+			&& key_a->currency_number == key_b->currency_number
+			&& key_a->abs_mantissa == key_b->abs_mantissa);
+}
+
+/**
+ * fill the key of the index for an imported transfer
+ * the amount is set in the given currency, usually the currency of the transaction,
+ * with the floating point of that currency, so the mantissas can be compared directly
+ *
+ * \param transfer_key the key to fill
+ * \param transaction_number
+ * \param account_number account of the key
+ * \param contra_account_number contra account of the key
+ * \param currency_number the currency of the amount
+ *
+ * \return
+ **/
+static void gsb_import_transfer_key_fill (ImportTransferKey *transfer_key,
+										  gint transaction_number,
+										  gint account_number,
+										  gint contra_account_number,
+										  gint currency_number)
+{
+	const GDate *date;
+	GsbReal amount;
+
+	amount = gsb_data_transaction_get_adjusted_amount_for_currency (transaction_number,
+																	currency_number,
+																	gsb_data_currency_get_floating_point
+																	(currency_number));
+
+	transfer_key->account_number = account_number;
+	transfer_key->contra_account_number = contra_account_number;
+	date = gsb_data_transaction_get_date (transaction_number);
+	transfer_key->julian_day = date ? g_date_get_julian (date) : 0;
+	transfer_key->currency_number = currency_number;
+	transfer_key->abs_mantissa = amount.mantissa < 0 ? -amount.mantissa : amount.mantissa;
+}
+
+/**
+ * get the number of the contra account from the bank references of an imported transfer
+ * the names already found are kept in a hash table to avoid to look for them in the
+ * list of accounts for each transfer
+ *
+ * \param accounts_names hash table name of account -> number of account
+ * \param bank_references the name of the contra account with [ ]
+ *
+ * \return the number of the contra account or -1 if not found
+ **/
+static gint gsb_import_transfer_get_contra_account (GHashTable *accounts_names,
+													const gchar *bank_references)
+{
+	gchar *contra_account_name;
+	gpointer value;
+	gint contra_account_number;
+
+	contra_account_name = my_strdelimit (bank_references, "[]", "");
+	if (!contra_account_name)
+		return -1;
+
+	if (g_hash_table_lookup_extended (accounts_names, contra_account_name, NULL, &value))
+	{
+		g_free (contra_account_name);
+
+		return GPOINTER_TO_INT (value);
+	}
+
+	contra_account_number = gsb_data_account_get_no_account_by_name (contra_account_name);
+
+	/* the hash table takes the name */
+	g_hash_table_insert (accounts_names, contra_account_name, GINT_TO_POINTER (contra_account_number));
+
+	return contra_account_number;
+}
+
+/**
+ * look for the contra-transaction of an imported transfer in the index
+ * the index is keyed on the currency of the transactions, so we look first
+ * with the currency of the transfer, and then with its amount converted
+ * into the others currencies of the imported transfers
+ * the contra-transaction found is removed from the index
+ *
+ * \param transfers_index the index of the imported transfers
+ * \param currencies the currencies of the imported transfers
+ * \param transaction_number the imported transfer
+ * \param contra_account_number
+ *
+ * \return the number of the contra-transaction or 0 if not found
+ **/
+static gint gsb_import_transfer_find_contra_transaction (GHashTable *transfers_index,
+														 GHashTable *currencies,
+														 gint transaction_number,
+														 gint contra_account_number)
+{
+	GHashTableIter iter;
+	gpointer key;
+	gint transaction_account;
+	gint transaction_currency;
+	gint currency_number;
+
+	transaction_account = gsb_data_transaction_get_account_number (transaction_number);
+	transaction_currency = gsb_data_transaction_get_currency_number (transaction_number);
+
+	/* the currency of the transfer first, then the others */
+	currency_number = transaction_currency;
+	g_hash_table_iter_init (&iter, currencies);
+	while (TRUE)
+	{
+		ImportTransferKey search_key;
+		GQueue *bucket;
+		GList *bucket_tmp = NULL;
+
+		/* the contra-transaction is in the contra account and its contra account is our account */
+		gsb_import_transfer_key_fill (&search_key,
+									  transaction_number,
+									  contra_account_number,
+									  transaction_account,
+									  currency_number);
+
+		bucket = g_hash_table_lookup (transfers_index, &search_key);
+		if (bucket)
+			bucket_tmp = bucket->head;
+
+		while (bucket_tmp)
+		{
+			gint contra_transaction_number;
+
+			contra_transaction_number = GPOINTER_TO_INT (bucket_tmp->data);
+
+			if (contra_transaction_number != transaction_number
+				&& gsb_import_check_transaction_link (transaction_number, contra_transaction_number))
+			{
+				/* the contra-transaction is used, remove it from the index */
+				g_queue_delete_link (bucket, bucket_tmp);
+
+				return contra_transaction_number;
+			}
+			bucket_tmp = bucket_tmp->next;
+		}
+
+		/* next currency */
+		do
+		{
+			if (!g_hash_table_iter_next (&iter, &key, NULL))
+				return 0;
+			currency_number = GPOINTER_TO_INT (key);
+		}
+		while (currency_number == transaction_currency);
+	}
+}
+
+/**
+ * create the contra-transaction of an imported transfer in the contra account
+ * and link the two transactions
+ *
+ * \param transaction_number the imported transfer
+ * \param contra_account_number
+ *
+ * \return the number of the contra-transaction
+ **/
+static gint gsb_import_create_contra_transaction (gint transaction_number,
+												 gint contra_account_number)
+{
+	gint contra_transaction_number;
+	gint mother_number;
+	gint payment_number;
+
+	/* on crée une transaction dans le compte destinataire */
+	contra_transaction_number = gsb_data_transaction_new_transaction (contra_account_number);
+	gsb_data_transaction_copy_transaction (transaction_number, contra_transaction_number, TRUE);
+
+	/* fixe les données si le virement est une opération fille */
+	mother_number = gsb_data_transaction_get_mother_transaction_number (transaction_number);
+	if (mother_number)
+	{
+		gint payee_number;
+
+		gsb_data_transaction_set_mother_transaction_number (contra_transaction_number, 0);
+		payee_number = gsb_data_transaction_get_payee_number (mother_number);
+		gsb_data_transaction_set_payee_number (contra_transaction_number, payee_number);
+	}
+
+	/* we have to change the amount by the opposite */
+	gsb_data_transaction_set_amount (contra_transaction_number,
+									 gsb_real_opposite (gsb_data_transaction_get_amount (transaction_number)));
+
+	/* we have to check the change */
+	gsb_currency_check_for_change (contra_transaction_number);
+
+	/* set default payment number of contra */
+	payment_number = gsb_data_payment_get_transfer_payment_number (contra_account_number);
+	if (payment_number)
+		gsb_data_transaction_set_method_of_payment_number (contra_transaction_number, payment_number);
+
+	/* set the link between the transactions */
+	gsb_data_transaction_set_contra_transaction_number (transaction_number, contra_transaction_number);
+	gsb_data_transaction_set_contra_transaction_number (contra_transaction_number, transaction_number);
+
+	return contra_transaction_number;
+}
+
+/**
+ * describe the contra-transaction of an orphan transfer for the dialog of
+ * the orphan transactions, the contra-transaction is created if the user
+ * marks it
+ *
+ * \param transaction_number the imported transfer
+ * \param contra_account_number
+ *
+ * \return a new ImportTransaction
+ **/
+static ImportTransaction *gsb_import_new_orphan_transfer (gint transaction_number,
+														  gint contra_account_number)
+{
+	ImportTransaction *ope_import;
+	const GDate *date;
+	gint mother_number;
+	gint payee_number;
+
+	ope_import = g_malloc0 (sizeof (ImportTransaction));
+	ope_import->no_compte = contra_account_number;
+	ope_import->transfer_number = transaction_number;
+	ope_import->devise = gsb_data_transaction_get_currency_number (transaction_number);
+	ope_import->montant = gsb_real_opposite (gsb_data_transaction_get_amount (transaction_number));
+
+	date = gsb_data_transaction_get_date (transaction_number);
+	if (date)
+		ope_import->date = gsb_date_copy (date);
+
+	mother_number = gsb_data_transaction_get_mother_transaction_number (transaction_number);
+	if (mother_number)
+		payee_number = gsb_data_transaction_get_payee_number (mother_number);
+	else
+		payee_number = gsb_data_transaction_get_payee_number (transaction_number);
+	ope_import->tiers = g_strdup (gsb_data_payee_get_name (payee_number, TRUE));
+
+	return ope_import;
+}
+
+/**
+ * free the contra-transactions of orphan transfers given to a dialog
+ *
+ * \param orphan_transfers
+ *
+ * \return
+ **/
+static void gsb_import_free_orphan_transfers (GSList *orphan_transfers)
+{
+	g_slist_free_full (orphan_transfers, (GDestroyNotify) gsb_import_free_transaction);
+}
+
 /**
  * called at the end of an import, check all the transactions which need a link
  * to another transaction.
  * we can find that transactions because they have contra_transaction_number to -1
- * and the bank_references is the name of the contra account, with [ ]
+ * and the bank_references is the name of the contra account, with [ ]
  *
- * that function try to find the contra-transaction and create the link
+ * the imported transfers are first indexed by (account, contra account, date, |amount|)
+ * so each contra-transaction is found with one lookup. the transfers without
+ * contra-transaction are collected in the same pass : without user their
+ * contra-transaction is created, else they are shown by contra account in the
+ * dialog of the orphan transactions where the user chooses the contra-transactions
+ * to create
  *
  * \param
  *
@@ -4027,138 +4396,234 @@ static gboolean gsb_import_check_transaction_link (gint transaction_number,
  **/
 static void gsb_import_cree_liens_virements_ope_import (void)
 {
-	GSList *tmp_list_transactions;
+	GHashTable *accounts_names;
+	GHashTable *transfers_index;
+	GHashTable *transfers_currencies;
+	GHashTable *updated_accounts;
+	GHashTable *orphans_by_account;
+	GHashTableIter iter;
+	gpointer key;
+	gpointer value;
+	GSList *pending_list = NULL;
+	GSList *orphans_list = NULL;
+	GSList *tmp_list;
+	gint current_account;
 
-	tmp_list_transactions = gsb_data_transaction_get_transactions_list ();
-	while (tmp_list_transactions)
+	accounts_names = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	transfers_index = g_hash_table_new_full (gsb_import_transfer_key_hash,
+											 gsb_import_transfer_key_equal,
+											 g_free,
+											 (GDestroyNotify) g_queue_free);
+	transfers_currencies = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+	/* first pass : get the imported transfers and index them */
+	tmp_list = gsb_data_transaction_get_transactions_list ();
+	while (tmp_list)
 	{
 		gint transaction_number_tmp;
 
-		transaction_number_tmp = gsb_data_transaction_get_transaction_number (tmp_list_transactions->data);
+		transaction_number_tmp = gsb_data_transaction_get_transaction_number (tmp_list->data);
 
 		/* if the contra transaction number is -1, it's a transfer, */
 		/* in that case, the name of the contra account is in the bank_references */
 		if (gsb_data_transaction_get_contra_transaction_number (transaction_number_tmp)== -1
 			 && gsb_data_transaction_get_bank_references (transaction_number_tmp))
 		{
-			/* the name of the contra account is in the bank references with [and] */
-			gchar *contra_account_name;
 			gint contra_account_number;
 
-			contra_account_name = my_strdelimit (gsb_data_transaction_get_bank_references (transaction_number_tmp),
-												 "[]", "");
-			contra_account_number = gsb_data_account_get_no_account_by_name (contra_account_name);
+			pending_list = g_slist_prepend (pending_list, GINT_TO_POINTER (transaction_number_tmp));
 
-			/* now we needn't the bank reference anymore */
-			gsb_data_transaction_set_bank_references (transaction_number_tmp, NULL);
-
-			if (contra_account_number == -1)
+			contra_account_number = gsb_import_transfer_get_contra_account (accounts_names,
+																			gsb_data_transaction_get_bank_references
+																			(transaction_number_tmp));
+			if (contra_account_number != -1)
 			{
-				gchar *tmp_str;
-
-				/* we have not found the contra-account */
-				gsb_data_transaction_set_contra_transaction_number (transaction_number_tmp, 0);
-				tmp_str = g_strdup_printf (_("You have imported transaction of transfer to an "
-											 "inexistent account: '%s'"),
-										   contra_account_name);
-				dialogue_warning_hint (tmp_str, _("Transfer transaction in error"));
-				g_free (tmp_str);
-				g_free (contra_account_name);
+				ImportTransferKey *transfer_key;
+				GQueue *bucket;
+				gint currency_number;
+
+				/* the transfer is indexed with its amount in its own currency */
+				currency_number = gsb_data_transaction_get_currency_number (transaction_number_tmp);
+				g_hash_table_add (transfers_currencies, GINT_TO_POINTER (currency_number));
+
+				transfer_key = g_malloc0 (sizeof (ImportTransferKey));
+				gsb_import_transfer_key_fill (transfer_key,
+											  transaction_number_tmp,
+											  gsb_data_transaction_get_account_number (transaction_number_tmp),
+											  contra_account_number,
+											  currency_number);
+
+				bucket = g_hash_table_lookup (transfers_index, transfer_key);
+				if (bucket)
+					g_free (transfer_key);
+				else
+				{
+					bucket = g_queue_new ();
+					g_hash_table_insert (transfers_index, transfer_key, bucket);
+				}
+				g_queue_push_tail (bucket, GINT_TO_POINTER (transaction_number_tmp));
 			}
-			else
-			{
-				/* we have found the contra-account, we look for the contra-transaction */
-				GSList *tmp_list_transactions_2;
-				gint transaction_account;
+		}
+		tmp_list = tmp_list->next;
+	}
+	pending_list = g_slist_reverse (pending_list);
 
-				transaction_account = gsb_data_transaction_get_account_number (transaction_number_tmp);
-				tmp_list_transactions_2 = gsb_data_transaction_get_transactions_list ();
-				while (tmp_list_transactions_2)
-				{
-					gint contra_transaction_number_tmp;
-					gint contra_transaction_account;
+	/* second pass : look for the contra-transaction of each imported transfer */
+	tmp_list = pending_list;
+	while (tmp_list)
+	{
+		gint transaction_number_tmp;
+		gint contra_account_number;
 
-					contra_transaction_number_tmp = gsb_data_transaction_get_transaction_number (tmp_list_transactions_2->data);
-					contra_transaction_account = gsb_data_transaction_get_account_number (contra_transaction_number_tmp);
+		transaction_number_tmp = GPOINTER_TO_INT (tmp_list->data);
+		tmp_list = tmp_list->next;
 
-					if (contra_account_number == contra_transaction_account
-						&& gsb_import_check_transaction_link (transaction_number_tmp, contra_transaction_number_tmp))
-					{
-						/* we have found the contra transaction, set all the values */
-						gint payment_number;
+		/* the transaction was already linked as contra-transaction of another one */
+		if (gsb_data_transaction_get_contra_transaction_number (transaction_number_tmp) != -1)
+			continue;
 
-						gsb_data_transaction_set_contra_transaction_number (transaction_number_tmp,
-																			contra_transaction_number_tmp);
-						gsb_data_transaction_set_contra_transaction_number (contra_transaction_number_tmp,
-																			transaction_number_tmp);
+		contra_account_number = gsb_import_transfer_get_contra_account (accounts_names,
+																		gsb_data_transaction_get_bank_references
+																		(transaction_number_tmp));
 
-						/* unset the reference of the contra transaction */
-						gsb_data_transaction_set_bank_references (contra_transaction_number_tmp, NULL);
+		if (contra_account_number == -1)
+		{
+			gchar *tmp_str;
+			gchar *contra_account_name;
+
+			/* we have not found the contra-account */
+			contra_account_name = my_strdelimit (gsb_data_transaction_get_bank_references (transaction_number_tmp),
+												 "[]", "");
+			gsb_data_transaction_set_bank_references (transaction_number_tmp, NULL);
+			gsb_data_transaction_set_contra_transaction_number (transaction_number_tmp, 0);
+			tmp_str = g_strdup_printf (_("You have imported transaction of transfer to an "
+										 "inexistent account: '%s'"),
+									   contra_account_name);
+			if (import_unattended)
+				g_message ("%s", tmp_str);
+			else
+				dialogue_warning_hint (tmp_str, _("Transfer transaction in error"));
+			g_free (tmp_str);
+			g_free (contra_account_name);
+		}
+		else
+		{
+			/* we have found the contra-account, we look for the contra-transaction in the index */
+			gint contra_transaction_number_tmp;
+			gint transaction_account;
+
+			transaction_account = gsb_data_transaction_get_account_number (transaction_number_tmp);
+			contra_transaction_number_tmp = gsb_import_transfer_find_contra_transaction (transfers_index,
+																						 transfers_currencies,
+																						 transaction_number_tmp,
+																						 contra_account_number);
+			if (contra_transaction_number_tmp)
+			{
+				/* we have found the contra transaction, set all the values */
+				gint payment_number;
+
+				gsb_data_transaction_set_contra_transaction_number (transaction_number_tmp,
+																	contra_transaction_number_tmp);
+				gsb_data_transaction_set_contra_transaction_number (contra_transaction_number_tmp,
+																	transaction_number_tmp);
+
+				/* now we needn't the bank references anymore */
+				gsb_data_transaction_set_bank_references (transaction_number_tmp, NULL);
+				gsb_data_transaction_set_bank_references (contra_transaction_number_tmp, NULL);
+
+				/* try to set the good method of payment to transfer */
+				payment_number = gsb_data_payment_get_transfer_payment_number (transaction_account);
+				if (payment_number)
+					gsb_data_transaction_set_method_of_payment_number (transaction_number_tmp, payment_number);
+
+				payment_number = gsb_data_payment_get_transfer_payment_number (contra_account_number);
+				if (payment_number)
+					gsb_data_transaction_set_method_of_payment_number (contra_transaction_number_tmp, payment_number);
+			}
 
-						/* try to set the good method of payment to transfer */
-						payment_number = gsb_data_payment_get_transfer_payment_number (transaction_account);
-						if (payment_number)
-							gsb_data_transaction_set_method_of_payment_number (transaction_number_tmp, payment_number);
+			/* if no contra-transaction, keep the transfer to create its contra-transaction later */
+			if (gsb_data_transaction_get_contra_transaction_number (transaction_number_tmp) == -1)
+				orphans_list = g_slist_prepend (orphans_list, GINT_TO_POINTER (transaction_number_tmp));
+		}
+	}
 
-						payment_number = gsb_data_payment_get_transfer_payment_number (contra_transaction_account);
-						if (payment_number)
-							gsb_data_transaction_set_method_of_payment_number (contra_transaction_number_tmp, payment_number);
-					}
-					tmp_list_transactions_2 = tmp_list_transactions_2->next;
-				}
+	g_slist_free (pending_list);
+	g_hash_table_destroy (transfers_index);
+	g_hash_table_destroy (transfers_currencies);
 
-				/* if no contra-transaction, that transaction becomes normal */
-				/* on retouve notre virement dans la deuxième liste */
-				if (gsb_data_transaction_get_contra_transaction_number (transaction_number_tmp) == -1)
-				{
-					gint contra_transaction_number = 0;
-					gint mother_number;
-					gint payment_number;
+	/* the transfers without contra-transaction */
+	orphans_list = g_slist_reverse (orphans_list);
+	updated_accounts = g_hash_table_new (g_direct_hash, g_direct_equal);
+	orphans_by_account = g_hash_table_new (g_direct_hash, g_direct_equal);
+	tmp_list = orphans_list;
+	while (tmp_list)
+	{
+		gint transaction_number_tmp;
+		gint contra_account_number;
 
-					/* on crée une transaction dans le compte destinataire */
-					contra_transaction_number = gsb_data_transaction_new_transaction (contra_account_number);
-					gsb_data_transaction_copy_transaction (transaction_number_tmp, contra_transaction_number, TRUE);
+		transaction_number_tmp = GPOINTER_TO_INT (tmp_list->data);
+		contra_account_number = gsb_import_transfer_get_contra_account (accounts_names,
+																		gsb_data_transaction_get_bank_references
+																		(transaction_number_tmp));
 
-					/* fixe les données si le virement est une opération fille */
-					mother_number = gsb_data_transaction_get_mother_transaction_number (transaction_number_tmp);
-					if (mother_number)
-					{
-						gint payee_number;
+		/* now we needn't the bank reference anymore */
+		gsb_data_transaction_set_bank_references (transaction_number_tmp, NULL);
 
-						gsb_data_transaction_set_mother_transaction_number (contra_transaction_number, 0);
-						payee_number = gsb_data_transaction_get_payee_number (mother_number);
-						gsb_data_transaction_set_payee_number (contra_transaction_number, payee_number);
+		if (import_unattended)
+		{
+			gint contra_transaction_number;
 
-					}
+			contra_transaction_number = gsb_import_create_contra_transaction (transaction_number_tmp,
+																			  contra_account_number);
 
-					/* we have to change the amount by the opposite */
-					gsb_data_transaction_set_amount (contra_transaction_number,
-													 gsb_real_opposite (gsb_data_transaction_get_amount
-																		(transaction_number_tmp)));
+			/* the tree view is updated only one time at the end */
+			gsb_transactions_list_append_new_transaction (contra_transaction_number, FALSE);
+			g_hash_table_add (updated_accounts, GINT_TO_POINTER (contra_account_number));
+		}
+		else
+		{
+			GSList *orphan_transfers;
+
+			/* the transfer is a normal transaction until the user creates its contra-transaction */
+			gsb_data_transaction_set_contra_transaction_number (transaction_number_tmp, 0);
+			orphan_transfers = g_hash_table_lookup (orphans_by_account, GINT_TO_POINTER (contra_account_number));
+			orphan_transfers = g_slist_prepend (orphan_transfers,
+												gsb_import_new_orphan_transfer (transaction_number_tmp,
+																				contra_account_number));
+			g_hash_table_insert (orphans_by_account, GINT_TO_POINTER (contra_account_number), orphan_transfers);
+		}
 
-					/* we have to check the change */
-					gsb_currency_check_for_change (contra_transaction_number);
+		tmp_list = tmp_list->next;
+	}
+	g_slist_free (orphans_list);
 
-					/* set default payment number of contra */
-					payment_number = gsb_data_payment_get_transfer_payment_number (contra_account_number);
-					if (payment_number)
-						gsb_data_transaction_set_method_of_payment_number (contra_transaction_number,
-																		   payment_number);
+	/* update the tree view if the account showed received contra-transactions */
+	current_account = gsb_gui_navigation_get_current_account ();
+	if (current_account >= 0 && g_hash_table_contains (updated_accounts, GINT_TO_POINTER (current_account)))
+	{
+		gsb_transactions_list_update_tree_view (current_account, TRUE);
+		gsb_data_account_colorize_current_balance (current_account);
+	}
+	g_hash_table_destroy (updated_accounts);
 
-					/* set the link between the transactions */
-					gsb_data_transaction_set_contra_transaction_number (transaction_number_tmp,
-																		contra_transaction_number);
-					gsb_data_transaction_set_contra_transaction_number (contra_transaction_number,
-																		transaction_number_tmp);
+	/* show the orphan transfers by contra account */
+	g_hash_table_iter_init (&iter, orphans_by_account);
+	while (g_hash_table_iter_next (&iter, &key, &value))
+	{
+		GtkWidget *dialog;
+		GSList *orphan_transfers;
 
-					gsb_transactions_list_append_new_transaction (contra_transaction_number, TRUE);
-				}
-				g_free (contra_account_name);
-			}
-		}
+		orphan_transfers = g_slist_reverse (value);
+		dialog = gsb_import_show_orphan_transactions (orphan_transfers, GPOINTER_TO_INT (key));
 
-		tmp_list_transactions = tmp_list_transactions->next;
+		/* the dialog removes the created transactions from its list, so it keeps a copy to free them */
+		g_object_set_data_full (G_OBJECT (dialog),
+								"orphan_transfers",
+								g_slist_copy (orphan_transfers),
+								(GDestroyNotify) gsb_import_free_orphan_transfers);
 	}
+	g_hash_table_destroy (orphans_by_account);
+	g_hash_table_destroy (accounts_names);
 
 	/* the transactions were already set in the list,
 	 * and the transfer was not written, we need to update the categories values
@@ -4230,8 +4695,17 @@ static gboolean gsb_import_click_dialog_ope_orphelines (GtkWidget *dialog,
 
 					ope_import = tmp_list->data;
 
-					transaction_number = gsb_import_create_transaction (ope_import, ope_import->no_compte, NULL);
-					gsb_data_transaction_set_marked_transaction (transaction_number, OPERATION_TELEPOINTEE);
+					if (ope_import->transfer_number)
+					{
+						/* contra-transaction of an orphan transfer */
+						transaction_number = gsb_import_create_contra_transaction (ope_import->transfer_number,
+																				   ope_import->no_compte);
+					}
+					else
+					{
+						transaction_number = gsb_import_create_transaction (ope_import, ope_import->no_compte, NULL, 0);
+						gsb_data_transaction_set_marked_transaction (transaction_number, OPERATION_TELEPOINTEE);
+					}
 
 					/* we need to add the transaction now to the tree model and update the tree_view */
 					gsb_transactions_list_append_new_transaction (transaction_number, FALSE);
@@ -4334,12 +4808,20 @@ static void gsb_import_create_imported_transactions (ImportAccount *imported_acc
 	GSList *tmp_list;
 	gint nbre_transaction;
 	gint devise;
+	gint first_number;
+	gint nb_new_transactions;
+	gint reserved_number;
 
 	mother_transaction_number = 0;
 
 	tmp_list = imported_account->operations_importees;
 	nbre_transaction = g_slist_length (tmp_list);
 
+	/* create all the transactions in one time */
+	nb_new_transactions = nbre_transaction;
+	first_number = gsb_data_transaction_new_transactions_batch (account_number, nb_new_transactions);
+	reserved_number = first_number;
+
 	if (nbre_transaction > NBRE_TRANSACTION_FOR_PROGRESS_BAR)
 		progress = gsb_import_progress_bar_affiche (imported_account);
 
@@ -4369,7 +4851,9 @@ static void gsb_import_create_imported_transactions (ImportAccount *imported_acc
 
 		transaction_number = gsb_import_create_transaction (imported_transaction,
 															account_number,
-															imported_account->origine);
+															imported_account->origine,
+															reserved_number);
+		reserved_number++;
 
 		/* invert the amount of the transaction if asked */
 		if (imported_account->invert_transaction_amount)
@@ -4377,13 +4861,12 @@ static void gsb_import_create_imported_transactions (ImportAccount *imported_acc
 											 gsb_real_opposite (gsb_data_transaction_get_amount
 																(transaction_number)));
 
-		/* we need to add the transaction now to the tree model here
-		 * to avoid to write again all the account */
-		gsb_transactions_list_append_new_transaction (transaction_number, FALSE);
-
 		tmp_list = tmp_list->next;
 	}
 
+	/* we add now all the transactions to the tree model in one time */
+	gsb_transactions_list_append_new_transactions_batch (account_number, first_number, nb_new_transactions);
+
 	if (progress)
 		gtk_widget_destroy (progress);
 }
@@ -4394,10 +4877,10 @@ static void gsb_import_create_imported_transactions (ImportAccount *imported_acc
  * \param
  * \param
  *
- * \return
+ * \return the dialog
  **/
-static void gsb_import_show_orphan_transactions (GSList *orphan_list,
-												 gint account_number)
+static GtkWidget *gsb_import_show_orphan_transactions (GSList *orphan_list,
+													   gint account_number)
 {
 	GtkWidget *dialog;
 	GtkWidget *button_cancel;
@@ -4514,6 +4997,8 @@ static void gsb_import_show_orphan_transactions (GSList *orphan_list,
 					  liste_ope_celibataires);
 
 	gtk_widget_show_all (dialog);
+
+	return dialog;
 }
 
 /**
@@ -4525,15 +5010,16 @@ static void gsb_import_show_orphan_transactions (GSList *orphan_list,
  * \param
  * \param
  *
- * \return
+ * \return le nombre d'opérations pointées
  **/
-static void gsb_import_pointe_opes_importees (ImportAccount *imported_account,
+static gint gsb_import_pointe_opes_importees (ImportAccount *imported_account,
 											  gint account_number)
 {
 	GSList *list_ope_import_celibataires;
 	GSList *list_ope_retenues;
 	GSList *tmp_list_ope_importees;
 	GDate *first_date_import = NULL;
+	gint nb_marked_transactions = 0;
 	GrisbiWinEtat *w_etat;
 
 	w_etat = grisbi_win_get_w_etat ();
@@ -4544,7 +5030,7 @@ static void gsb_import_pointe_opes_importees (ImportAccount *imported_account,
 	if (imported_account->id_compte)
 	{
 		if (!gsb_import_set_id_compte (account_number, imported_account->id_compte))
-			return;
+			return 0;
 	}
 
 	/* pour gagner en rapidité, on va récupérer la date de la première */
@@ -4672,13 +5158,15 @@ static void gsb_import_pointe_opes_importees (ImportAccount *imported_account,
 						gsb_data_transaction_set_transaction_id (transaction_number, ope_import->id_operation);
 
 					gsb_data_transaction_set_marked_transaction (transaction_number, OPERATION_TELEPOINTEE);
+					nb_marked_transactions++;
 
 					/* on traite la fusion des opérations si besoin */
 					if (w_etat->fusion_import_transactions && ope_import->ope_correspondante > 0)
 					{
 						transaction_number = gsb_import_create_transaction (ope_import,
 																			account_number,
-																			imported_account->origine);
+																			imported_account->origine,
+																			0);
 						transaction_list_update_transaction (transaction_number);
 					}
 				}
@@ -4706,8 +5194,16 @@ static void gsb_import_pointe_opes_importees (ImportAccount *imported_account,
 	/* a ce niveau, list_ope_import_celibataires contient les opés d'import dont on */
 	/* n'a pas retrouvé l'opé correspondante */
 	/* on les affiche dans une liste en proposant de les ajouter à la liste  des transactions */
+	/* sans utilisateur elles sont ignorées */
 	if (list_ope_import_celibataires)
-		gsb_import_show_orphan_transactions (list_ope_import_celibataires, account_number);
+	{
+		if (import_unattended)
+			g_slist_free (list_ope_import_celibataires);
+		else
+			gsb_import_show_orphan_transactions (list_ope_import_celibataires, account_number);
+	}
+
+	return nb_marked_transactions;
 }
 
 /**
@@ -5411,6 +5907,310 @@ static gchar **gsb_import_by_rule_ask_filename (gint rule,
 	return array;
 }
 
+/**
+ * check if a rule can be used to import a type of file
+ *
+ * \param rule
+ * \param type	"OFX", "QIF" or "CSV"
+ *
+ * \return TRUE if the rule can be used
+ **/
+static gboolean gsb_import_by_rule_type_match (gint rule,
+											   const gchar *type)
+{
+	const gchar *rule_type;
+
+	rule_type = gsb_data_import_rule_get_type (rule);
+
+	/* old rules have no type, they are not CSV rules */
+	if (!rule_type)
+		return strcmp (type, "CSV") != 0;
+
+	return strcmp (rule_type, type) == 0;
+}
+
+/**
+ * get the transactions of a file imported with a rule
+ * fill liste_comptes_importes and liste_comptes_importes_error
+ *
+ * \param rule		the rule used (needed for the CSV files)
+ * \param imported	the file to import
+ *
+ * \return TRUE : ok, FALSE : an error occurred while getting the transactions
+ **/
+static gboolean gsb_import_by_rule_get_transactions (gint rule,
+													 ImportFile *imported)
+{
+	liste_comptes_importes_error = NULL;
+	liste_comptes_importes = NULL;
+
+	if (!strcmp (imported->type, "CSV"))
+	{
+		csv_import_file_by_rule (rule, imported);
+	}
+	else
+	{
+		GSList *tmp_list;
+
+		for (tmp_list = ImportFormats; tmp_list; tmp_list = tmp_list->next)
+		{
+			ImportFormat *format = (ImportFormat *) tmp_list->data;
+
+			if (!strcmp (imported->type, format->name))
+				format->import (NULL, imported);
+		}
+	}
+
+	return liste_comptes_importes_error == NULL;
+}
+
+/**
+ * free the imported accounts read by gsb_import_by_rule_get_transactions ()
+ * when they are not imported
+ *
+ * \param
+ *
+ * \return
+ **/
+static void gsb_import_by_rule_free_imported_accounts (void)
+{
+	GSList *tmp_list;
+
+	for (tmp_list = liste_comptes_importes; tmp_list; tmp_list = tmp_list->next)
+	{
+		ImportAccount *account;
+
+		account = tmp_list->data;
+		g_slist_free_full (account->operations_importees, (GDestroyNotify) gsb_import_free_transaction);
+		g_free (account);
+	}
+	g_slist_free (liste_comptes_importes);
+	liste_comptes_importes = NULL;
+	g_slist_free (liste_comptes_importes_error);
+	liste_comptes_importes_error = NULL;
+}
+
+/**
+ * add or mark the transactions of liste_comptes_importes following the rule
+ * and free liste_comptes_importes
+ *
+ * \param rule
+ * \param type				type of the imported file
+ * \param nb_transactions	set to the number of transactions read in the file
+ *
+ * \return the number of transactions added, merged or marked
+ **/
+static gint gsb_import_by_rule_import_accounts (gint rule,
+												const gchar *type,
+												gint *nb_transactions)
+{
+	GSList *tmp_list;
+	gint account_number;
+	gint nb_imported = 0;
+
+	account_number = gsb_data_import_rule_get_account (rule);
+	*nb_transactions = 0;
+
+	for (tmp_list = liste_comptes_importes; tmp_list; tmp_list = tmp_list->next)
+	{
+		GSList *new_list;
+		ImportAccount *account;
+
+		account = tmp_list->data;
+		account->invert_transaction_amount = gsb_data_import_rule_get_invert (rule);
+
+		/* on fixe la devise pour les fichiers QIF et CSV */
+		if (strcmp (type, "QIF") == 0 || strcmp (type, "CSV") == 0)
+		{
+			account->devise = g_strdup (gsb_data_currency_get_code_iso4217 (gsb_data_import_rule_get_currency (rule)));
+		}
+
+		new_list = gsb_import_limits_number_imported_ope (account->operations_importees);
+		g_slist_free (account->operations_importees);
+		account->operations_importees = new_list;
+		*nb_transactions += g_slist_length (new_list);
+
+		switch (gsb_data_import_rule_get_action (rule))
+		{
+			case IMPORT_ADD_TRANSACTIONS:
+			nb_imported += gsb_import_add_imported_transactions (account, account_number, NULL);
+			break;
+
+			case IMPORT_MARK_TRANSACTIONS:
+			nb_imported += gsb_import_pointe_opes_importees (account, account_number);
+			transaction_list_update_element (ELEMENT_MARK);
+			break;
+		}
+		g_slist_free (account->operations_importees);
+		g_free (account);
+	}
+
+	g_slist_free (liste_comptes_importes);
+	liste_comptes_importes = NULL;
+
+	return nb_imported;
+}
+
+/**
+ * find the rule to use for a file imported without user
+ * for the CSV files, the account id is read at the place given by each CSV rule.
+ * for the OFX and QIF files, the file is read and the id of the imported account
+ * gives the grisbi account. In that case, liste_comptes_importes is filled
+ * with the charmap of the returned rule.
+ * if the file has no account id, the first rule named rule_name is used.
+ *
+ * \param filename
+ * \param type			"OFX", "QIF" or "CSV"
+ * \param rule_name		name of the rule to use or NULL for the first rule of the account
+ *
+ * \return the number of the rule or 0 if no rule found
+ **/
+static gint gsb_import_by_rule_find_rule (gchar *filename,
+										  const gchar *type,
+										  const gchar *rule_name)
+{
+	GSList *tmp_list;
+	GHashTable *csv_cache = NULL;
+	ImportFile imported;
+	const gchar *account_id = NULL;
+	gint account_number;
+	gint rule = 0;
+	gint rule_by_name = 0;
+
+	imported.name = filename;
+	imported.type = type;
+	imported.import_categories = FALSE;
+
+	/* the CSV file is read only one time for all the rules */
+	if (!strcmp (type, "CSV"))
+		csv_cache = csv_import_account_id_cache_new ();
+
+	/* first rule of that type, used for the files without account id */
+	for (tmp_list = gsb_data_import_rule_get_list (); tmp_list; tmp_list = tmp_list->next)
+	{
+		gint tmp_rule;
+
+		tmp_rule = gsb_data_import_rule_get_number (tmp_list->data);
+		if (!gsb_import_by_rule_type_match (tmp_rule, type))
+			continue;
+
+		if (!strcmp (type, "CSV"))
+		{
+			gchar *csv_account_id;
+
+			imported.coding_system = gsb_data_import_rule_get_charmap (tmp_rule);
+			csv_account_id = csv_import_get_account_id_by_rule (tmp_rule, &imported, csv_cache);
+			if (csv_account_id)
+			{
+				account_number = gsb_data_account_get_account_by_id (csv_account_id);
+				g_free (csv_account_id);
+				if (account_number == gsb_data_import_rule_get_account (tmp_rule)
+					&& (!rule_name || !g_utf8_collate (rule_name, gsb_data_import_rule_get_name (tmp_rule))))
+				{
+					g_hash_table_destroy (csv_cache);
+					return tmp_rule;
+				}
+			}
+		}
+		if (!rule_by_name
+			&& (!rule_name || !g_utf8_collate (rule_name, gsb_data_import_rule_get_name (tmp_rule))))
+			rule_by_name = tmp_rule;
+	}
+
+	if (!strcmp (type, "CSV"))
+	{
+		g_hash_table_destroy (csv_cache);
+
+		/* no account id in the file, the rule must be given by name */
+		if (rule_name)
+			return rule_by_name;
+		return 0;
+	}
+
+	/* OFX and QIF: read the file to get the account id */
+	g_free (charmap_imported);
+	charmap_imported = my_strdup (rule_by_name ? gsb_data_import_rule_get_charmap (rule_by_name) : NULL);
+	imported.coding_system = charmap_imported;
+	if (!gsb_import_by_rule_get_transactions (rule_by_name, &imported))
+		return 0;
+
+	for (tmp_list = liste_comptes_importes; tmp_list; tmp_list = tmp_list->next)
+	{
+		ImportAccount *account;
+
+		account = tmp_list->data;
+		if (account->id_compte)
+		{
+			account_id = account->id_compte;
+			break;
+		}
+	}
+
+	if (account_id)
+	{
+		account_number = gsb_data_account_get_account_by_id (account_id);
+		if (rule_name)
+		{
+			rule = gsb_data_import_rule_account_has_rule_name (account_number, rule_name);
+			if (rule && !gsb_import_by_rule_type_match (rule, type))
+				rule = 0;
+		}
+		else if (account_number >= 0)
+		{
+			GSList *rules_list;
+
+			rules_list = gsb_data_import_rule_get_from_account (account_number);
+			for (tmp_list = rules_list; tmp_list; tmp_list = tmp_list->next)
+			{
+				gint tmp_rule;
+
+				tmp_rule = gsb_data_import_rule_get_number (tmp_list->data);
+				if (gsb_import_by_rule_type_match (tmp_rule, type))
+				{
+					rule = tmp_rule;
+					break;
+				}
+			}
+			g_slist_free (rules_list);
+		}
+	}
+	else if (rule_name)
+		rule = rule_by_name;
+
+	if (!rule)
+	{
+		gsb_import_by_rule_free_imported_accounts ();
+		return 0;
+	}
+
+	/* read again the file if the rule uses another charmap */
+	if (g_strcmp0 (charmap_imported, gsb_data_import_rule_get_charmap (rule)))
+	{
+		gsb_import_by_rule_free_imported_accounts ();
+		g_free (charmap_imported);
+		charmap_imported = my_strdup (gsb_data_import_rule_get_charmap (rule));
+		imported.coding_system = charmap_imported;
+		if (!gsb_import_by_rule_get_transactions (rule, &imported))
+			return 0;
+	}
+
+	return rule;
+}
+
+/**
+ * sort function for the names of the files to import
+ *
+ * \param a
+ * \param b
+ *
+ * \return
+ **/
+static gint gsb_import_by_rule_cmp_filenames (gconstpointer a,
+											  gconstpointer b)
+{
+	return g_strcmp0 (*(const gchar **) a, *(const gchar **) b);
+}
+
 /******************************************************************************/
 /* Public functions                                                           */
 /******************************************************************************/
@@ -5452,8 +6252,8 @@ void gsb_import_by_rule (gint rule)
 		gchar *filename = array[i];
 		const gchar *type;
 		gchar *nom_fichier;
+		gint nb_transactions;
 		ImportFile imported;
-		GSList *tmp_list = ImportFormats;
 
 		/* check if we are on ofx or qif or CSV file */
 		type = gsb_import_autodetect_file_type (filename, NULL);
@@ -5477,31 +6277,8 @@ void gsb_import_by_rule (gint rule)
 		imported.coding_system =  charmap_imported;
 		imported.type = type;
 
-		liste_comptes_importes_error = NULL;
-		liste_comptes_importes = NULL;
-
-		if (!strcmp (type, "CSV"))
-		{
-			csv_import_file_by_rule (rule, &imported);
-		}
-		else
-		{
-			while (tmp_list)
-			{
-				ImportFormat *format = (ImportFormat *) tmp_list->data;
-
-				if (!strcmp (imported.type, format->name))
-				{
-					format->import (NULL, &imported);
-					tmp_list = tmp_list->next;
-						continue;
-				}
-				tmp_list = tmp_list->next;
-			}
-		}
-
 		/* now liste_comptes_importes contains the account structure of imported transactions */
-		if (liste_comptes_importes_error)
+		if (!gsb_import_by_rule_get_transactions (rule, &imported))
 		{
 			gchar *tmp_str = g_path_get_basename (filename);
 			gchar *tmp_str2 = g_strdup_printf (_("%s was not imported successfully. An error occurred "
@@ -5510,45 +6287,12 @@ void gsb_import_by_rule (gint rule)
 			dialogue_error (tmp_str2);
 			g_free (tmp_str);
 			g_free (tmp_str2);
+			g_free (nom_fichier);
 			i++;
 			continue;
 		}
 
-		while (liste_comptes_importes)
-		{
-			GSList *new_list;
-			ImportAccount *account;
-
-			account = liste_comptes_importes->data;
-			account->invert_transaction_amount = gsb_data_import_rule_get_invert (rule);
-
-			/* on fixe la devise pour les fichiers QIF et CSV */
-			if (strcmp (type, "QIF") == 0 || strcmp (type, "CSV") == 0)
-			{
-				account->devise = g_strdup (gsb_data_currency_get_code_iso4217 (gsb_data_import_rule_get_currency (rule)));
-			}
-
-			new_list = gsb_import_limits_number_imported_ope (account->operations_importees);
-			g_slist_free (account->operations_importees);
-			account->operations_importees = new_list;
-
-			switch (gsb_data_import_rule_get_action (rule))
-			{
-				case IMPORT_ADD_TRANSACTIONS:
-				gsb_import_add_imported_transactions (account, account_number, NULL);
-
-				break;
-
-				case IMPORT_MARK_TRANSACTIONS:
-				gsb_import_pointe_opes_importees (account, account_number);
-				transaction_list_update_element (ELEMENT_MARK);
-				break;
-			}
-			g_slist_free (account->operations_importees);
-			g_free (account);
-
-			liste_comptes_importes = liste_comptes_importes->next;
-		}
+		gsb_import_by_rule_import_accounts (rule, type, &nb_transactions);
 
 		/* save the charmap for the last file used */
 		gsb_data_import_rule_set_charmap (rule, charmap_imported);
@@ -5560,7 +6304,6 @@ void gsb_import_by_rule (gint rule)
 			g_remove (filename);
 		}
 
-		g_slist_free (liste_comptes_importes);
 		g_free (nom_fichier);
 		i++;
 	}
@@ -5583,6 +6326,185 @@ void gsb_import_by_rule (gint rule)
 	gsb_file_set_modified (TRUE);
 }
 
+/**
+ * import without user all the OFX, QIF and CSV files of a directory
+ * with the import rules of the opened file.
+ * the rule of each file is chosen by the account id found in the file
+ * (see gsb_import_by_rule_find_rule ()). The doubtful transactions
+ * and the orphans transactions are left, no dialog is shown.
+ * a summary with one line per file and the times of import is written
+ * in report_filename or on the standard output
+ *
+ * \param dirname			directory of the files to import
+ * \param rule_name			name of the rule to use or NULL
+ * \param report_filename	file for the summary or NULL
+ *
+ * \return the number of imported files or -1 if the directory can't be read
+ **/
+gint gsb_import_by_rule_directory (const gchar *dirname,
+								   const gchar *rule_name,
+								   const gchar *report_filename)
+{
+	GDir *dir;
+	GPtrArray *filenames;
+	GString *report;
+	const gchar *name;
+	gint64 start_time;
+	gint nb_files = 0;
+	gint total_read = 0;
+	gint total_imported = 0;
+	guint i;
+	GError *error = NULL;
+	GrisbiAppConf *a_conf;
+
+	devel_debug (dirname);
+	dir = g_dir_open (dirname, 0, &error);
+	if (!dir)
+	{
+		g_printerr ("%s\n", error->message);
+		g_error_free (error);
+
+		return -1;
+	}
+
+	a_conf = (GrisbiAppConf *) grisbi_app_get_a_conf ();
+
+	/* the files are imported in the order of their names */
+	filenames = g_ptr_array_new_with_free_func (g_free);
+	while ((name = g_dir_read_name (dir)))
+	{
+		gchar *filename;
+
+		filename = g_build_filename (dirname, name, NULL);
+		if (g_file_test (filename, G_FILE_TEST_IS_REGULAR))
+			g_ptr_array_add (filenames, filename);
+		else
+			g_free (filename);
+	}
+	g_dir_close (dir);
+	g_ptr_array_sort (filenames, gsb_import_by_rule_cmp_filenames);
+
+	report = g_string_new (NULL);
+	import_unattended = TRUE;
+	start_time = g_get_monotonic_time ();
+
+	for (i = 0; i < filenames->len; i++)
+	{
+		gchar *filename;
+		gchar *basename;
+		const gchar *type;
+		gint64 file_time;
+		gint account_number;
+		gint nb_imported;
+		gint nb_transactions;
+		gint rule;
+
+		filename = g_ptr_array_index (filenames, i);
+		basename = g_path_get_basename (filename);
+		file_time = g_get_monotonic_time ();
+
+		type = gsb_import_autodetect_file_type (filename, NULL);
+		if (strcmp (type, "OFX") && strcmp (type, "QIF") && strcmp (type, "CSV"))
+		{
+			g_string_append_printf (report, "%s\t%s\n", basename, _("ignored: unknown format"));
+			g_free (basename);
+			continue;
+		}
+
+		rule = gsb_import_by_rule_find_rule (filename, type, rule_name);
+		if (!rule)
+		{
+			g_string_append_printf (report, "%s\t%s\n", basename, _("ignored: no rule for this file"));
+			g_free (basename);
+			continue;
+		}
+
+		/* the CSV files are read only with their rule */
+		if (!strcmp (type, "CSV"))
+		{
+			ImportFile imported;
+
+			g_free (charmap_imported);
+			charmap_imported = my_strdup (gsb_data_import_rule_get_charmap (rule));
+			imported.name = filename;
+			imported.coding_system = charmap_imported;
+			imported.type = type;
+			imported.import_categories = FALSE;
+			gsb_import_by_rule_get_transactions (rule, &imported);
+		}
+
+		if (liste_comptes_importes_error)
+		{
+			gsb_import_by_rule_free_imported_accounts ();
+			g_string_append_printf (report, "%s\t%s\t%s\n",
+									basename,
+									gsb_data_import_rule_get_name (rule),
+									_("error while getting the transactions"));
+			g_free (basename);
+			continue;
+		}
+
+		nb_imported = gsb_import_by_rule_import_accounts (rule, type, &nb_transactions);
+
+		gsb_data_import_rule_set_charmap (rule, charmap_imported);
+		gsb_data_import_rule_set_last_file_name (rule, filename);
+		if (a_conf->import_remove_file)
+			g_remove (filename);
+
+		account_number = gsb_data_import_rule_get_account (rule);
+		if (a_conf->balances_with_scheduled == FALSE)
+			gsb_data_account_set_balances_are_dirty (account_number);
+		gsb_data_account_set_bet_maj (account_number, BET_MAJ_ALL);
+
+		/* file, rule, account, imported, skipped, time */
+		g_string_append_printf (report, "%s\t%s\t%s\t%d\t%d\t%.3f s\n",
+								basename,
+								gsb_data_import_rule_get_name (rule),
+								gsb_data_account_get_name (account_number),
+								nb_imported,
+								nb_transactions - nb_imported,
+								(g_get_monotonic_time () - file_time) / (gdouble) G_USEC_PER_SEC);
+		nb_files++;
+		total_read += nb_transactions;
+		total_imported += nb_imported;
+		g_free (basename);
+	}
+
+	import_unattended = FALSE;
+	g_string_append_printf (report, _("%d files imported, %d transactions read, %d imported in %.3f s\n"),
+							nb_files,
+							total_read,
+							total_imported,
+							(g_get_monotonic_time () - start_time) / (gdouble) G_USEC_PER_SEC);
+
+	if (nb_files)
+	{
+		GrisbiWinRun *w_run;
+
+		w_run = (GrisbiWinRun *) grisbi_win_get_w_run ();
+		w_run->mise_a_jour_liste_comptes_accueil = TRUE;
+		w_run->mise_a_jour_soldes_minimaux = TRUE;
+		mise_a_jour_accueil (FALSE);
+		gsb_file_set_modified (TRUE);
+	}
+
+	if (report_filename)
+	{
+		if (!g_file_set_contents (report_filename, report->str, -1, &error))
+		{
+			g_printerr ("%s\n", error->message);
+			g_error_free (error);
+		}
+	}
+	else
+		g_print ("%s", report->str);
+
+	g_string_free (report, TRUE);
+	g_ptr_array_free (filenames, TRUE);
+
+	return nb_files;
+}
+
 /**
  *
  *
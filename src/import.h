@@ -107,6 +107,7 @@ struct _ImportTransaction
 
 	gboolean transfert;			/* Pour fichier QIF */
 	gchar *dest_account_name;	/* Nom du compte destinataire */
+	gint transfer_number;		/* virement importé sans contre-opération, dont c'est la contre-opération */
 
 	/* Used by gnucash import */
 	gchar * guid;
@@ -162,6 +163,9 @@ gint 		gsb_import_associations_list_append_assoc 		(gint payee_number,
 void 		gsb_import_associations_remove_assoc 			(gint payee_number);
 
 void	 	gsb_import_by_rule 								(gint rule);
+gint		gsb_import_by_rule_directory					(const gchar *dirname,
+															 const gchar *rule_name,
+															 const gchar *report_filename);
 void		gsb_import_free_transaction						(ImportTransaction *transaction);
 gchar *		gsb_ImportFormats_get_list_formats_to_string 	(void);
 GSList *	gsb_import_import_selected_files 				(GtkWidget *assistant);
@@ -1303,9 +1303,113 @@ static gpointer my_strdup_null(gconstpointer src, gpointer data)
 	return g_strdup(src);
 }
 
+/**
+ * free the lines of a csv file read to get its account id
+ * csv_import_free_lines_tab () depends on csv_fields_config, not set here
+ *
+ * \param lines_tab
+ *
+ * \return
+ **/
+static void csv_import_free_account_id_lines_tab (GArray *lines_tab)
+{
+	guint index;
+
+	if (!lines_tab)
+		return;
+
+	for (index = 0; index < lines_tab->len; index++)
+	{
+		GSList *list;
+		GSList *tmp_list;
+
+		list = g_array_index (lines_tab, GSList *, index);
+		for (tmp_list = list; tmp_list; tmp_list = tmp_list->next)
+		{
+			if (tmp_list->data && strlen (tmp_list->data))
+				g_free (tmp_list->data);
+		}
+		g_slist_free (list);
+	}
+	g_array_unref (lines_tab);
+}
+
 /******************************************************************************/
 /* Public functions                                                           */
 /******************************************************************************/
+/**
+ * create the cache of the lines of a csv file given to
+ * csv_import_get_account_id_by_rule (), free it with g_hash_table_destroy ()
+ *
+ * \return a new GHashTable
+ **/
+GHashTable *csv_import_account_id_cache_new (void)
+{
+	return g_hash_table_new_full (g_str_hash,
+								  g_str_equal,
+								  g_free,
+								  (GDestroyNotify) csv_import_free_account_id_lines_tab);
+}
+
+/**
+ * return the account id stored in a csv file, at the position
+ * defined by the rule (used to choose a rule without any dialog)
+ * the file is read and parsed only one time for all the rules with
+ * the same charmap and separator, the lines are kept in the cache
+ *
+ * \param rule		number of the import rule
+ * \param imported	file to read
+ * \param cache		lines of the file already read, from csv_import_account_id_cache_new ()
+ *
+ * \return a newly allocated id or NULL
+ **/
+gchar *csv_import_get_account_id_by_rule (gint rule,
+										  ImportFile *imported,
+										  GHashTable *cache)
+{
+	GArray *lines_tab = NULL;
+	gchar *key;
+	gint csv_account_id_col;
+	gint csv_account_id_row;
+
+	csv_account_id_col = gsb_data_import_rule_get_csv_account_id_col (rule);
+	csv_account_id_row = gsb_data_import_rule_get_csv_account_id_row (rule);
+	if (csv_account_id_col <= 0 || csv_account_id_row <= 0)
+		return NULL;
+
+	key = g_strconcat (imported->coding_system ? imported->coding_system : "",
+					   "\n",
+					   gsb_data_import_rule_get_csv_separator (rule),
+					   NULL);
+
+	if (!g_hash_table_lookup_extended (cache, key, NULL, (gpointer *) &lines_tab))
+	{
+		gchar *contents;
+
+		contents = gsb_file_test_and_load_csv_file (imported);
+		if (contents && strlen (contents))
+		{
+			gchar *tmp_contents;
+
+			/* csv_import_init_lines_tab () moves the pointer to the end of the contents */
+			tmp_contents = contents;
+			lines_tab = csv_import_init_lines_tab (&tmp_contents,
+												   (gchar *) gsb_data_import_rule_get_csv_separator (rule));
+		}
+		g_free (contents);
+
+		/* an empty file is kept too, to be read only one time */
+		g_hash_table_insert (cache, key, lines_tab);
+	}
+	else
+		g_free (key);
+
+	if (lines_tab && (guint) csv_account_id_row <= lines_tab->len)
+		return csv_import_button_rule_get_account_id (lines_tab, csv_account_id_col, csv_account_id_row);
+
+	return NULL;
+}
+
 /**
  *	prepare l'importation du fichier csv
  *
@@ -14,6 +14,10 @@ gboolean 		csv_import_csv_account 				(GtkWidget *assistant,
 													 ImportFile *imported);
 gboolean		csv_import_file_by_rule				(gint rule,
 													 ImportFile *imported);
+GHashTable *	csv_import_account_id_cache_new		(void);
+gchar *			csv_import_get_account_id_by_rule	(gint rule,
+													 ImportFile *imported,
+													 GHashTable *cache);
 GSList *		csv_import_get_columns_list			(GtkWidget *assistant);
 void			csv_import_set_first_data_line		(gint first_data_line);
 GtkWidget * 	import_create_csv_preview_page 		(GtkWidget *assistant);
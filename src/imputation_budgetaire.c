@@ -202,11 +202,11 @@ GtkWidget *budgetary_lines_create_list ( void )
     cell = gtk_cell_renderer_text_new ();
 	gtk_cell_renderer_set_padding (GTK_CELL_RENDERER (cell), MARGIN_BOX, 0);
 	column = gtk_tree_view_column_new_with_attributes (_("Amount"), cell,
-						       "text", META_TREE_BALANCE_COLUMN,
 						       "weight", META_TREE_FONT_COLUMN,
 						       "xalign", META_TREE_XALIGN_COLUMN,
                                "cell-background-rgba", META_TREE_BACKGROUND_COLOR,
 						       NULL);
+    gtk_tree_view_column_set_cell_data_func ( column, cell, metatree_balance_cell_data_func, NULL, NULL );
     gtk_tree_view_column_set_alignment ( column, 1.0 );
     gtk_tree_view_append_column ( GTK_TREE_VIEW ( budgetary_line_tree ),
 				  GTK_TREE_VIEW_COLUMN ( column ) );
@@ -281,7 +281,7 @@ GtkWidget *budgetary_lines_create_list ( void )
 void budgetary_lines_fill_list ( void )
 {
     GSList *budget_list;
-    GtkTreeIter iter_budgetary_line, iter_sub_budgetary_line;
+    GtkTreeIter iter_budgetary_line;
     GtkTreeSelection *selection;
 
     devel_debug (NULL);
@@ -314,49 +314,13 @@ void budgetary_lines_fill_list ( void )
 
 	budget_number = gsb_data_budget_get_no_budget (budget_list -> data);
 
+	/* the sub-budgets are added when the budget is expanded */
 	gtk_tree_store_append ( GTK_TREE_STORE ( budgetary_line_tree_model ), &iter_budgetary_line, NULL);
 	fill_division_row ( GTK_TREE_MODEL ( budgetary_line_tree_model ),
                         budgetary_line_get_metatree_interface ( ),
                         &iter_budgetary_line,
                         budget_number );
 
-	/** Each budget has sub budgetary lines. */
-	if ( budget_number )
-	{
-	    GSList *sub_budget_list;
-
-	    sub_budget_list = gsb_data_budget_get_sub_budget_list ( budget_number );
-
-	    while ( sub_budget_list )
-	    {
-		gint sub_budget_number;
-
-		sub_budget_number = gsb_data_budget_get_no_sub_budget (sub_budget_list -> data);
-
-		gtk_tree_store_append ( GTK_TREE_STORE (budgetary_line_tree_model),
-				       &iter_sub_budgetary_line, &iter_budgetary_line);
-		fill_sub_division_row ( GTK_TREE_MODEL ( budgetary_line_tree_model ),
-                        budgetary_line_get_metatree_interface ( ),
-                        &iter_sub_budgetary_line,
-                        budget_number,
-                        sub_budget_number );
-
-		sub_budget_list = sub_budget_list -> next;
-	    }
-	}
-
-	/* add the no-sub-budget only if budget exists */
-	if (budget_number)
-	{
-	    gtk_tree_store_append ( GTK_TREE_STORE ( budgetary_line_tree_model ),
-                        &iter_sub_budgetary_line,
-                        &iter_budgetary_line );
-	    fill_sub_division_row ( GTK_TREE_MODEL(budgetary_line_tree_model),
-                        budgetary_line_get_metatree_interface ( ),
-                        &iter_sub_budgetary_line,
-                        budget_number,
-                        0 );
-	}
 	budget_list = budget_list -> next;
     }
 
@@ -424,6 +388,45 @@ gboolean budgetary_line_drag_data_get ( GtkTreeDragSource * drag_source, GtkTree
 }
 
 
+/**
+ * append a new budget or sub-budget to the form's combofix
+ * without rebuilding the whole list
+ *
+ * \param budget_number
+ * \param sub_budget_number	0 for a budget
+ *
+ * \return
+ * */
+void gsb_budget_append_to_combofix ( gint budget_number,
+                        gint sub_budget_number )
+{
+    GtkWidget *widget;
+    gchar *budget_name;
+    gchar *sub_budget_name = NULL;
+
+    if ( !gsb_data_form_check_for_value ( TRANSACTION_FORM_BUDGET ) )
+        return;
+
+    widget = gsb_form_widget_get_widget (TRANSACTION_FORM_BUDGET);
+    if ( !widget )
+        return;
+
+    budget_name = gsb_data_budget_get_name ( budget_number, 0, NULL );
+    if ( sub_budget_number )
+        sub_budget_name = gsb_data_budget_get_sub_budget_name ( budget_number,
+                        sub_budget_number,
+                        NULL );
+
+    /* same lists as gsb_budget_update_combofix () : debit first, then credit */
+    gtk_combofix_append_division ( GTK_COMBOFIX (widget),
+                        budget_name,
+                        sub_budget_name,
+                        gsb_data_budget_get_type ( budget_number ) ? 0 : 1 );
+
+    g_free ( budget_name );
+    g_free ( sub_budget_name );
+}
+
 /**
  * update the form's combofix for the budget
  *
@@ -23,6 +23,8 @@ void			budgetary_lines_edit_budgetary_line			(void);
 GtkTreePath *	budgetary_hold_position_get_path			(void);
 gboolean		budgetary_hold_position_set_expand			(gboolean expand);
 gboolean		budgetary_hold_position_set_path			(GtkTreePath *path);
+void			gsb_budget_append_to_combofix				(gint budget_number,
+															 gint sub_budget_number);
 gboolean		gsb_budget_update_combofix					(gboolean force);
 void			gsb_gui_budgetary_lines_toolbar_set_style	(gint toolbar_style);
 /* END_DECLARATION */
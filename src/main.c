@@ -66,6 +66,7 @@
  */
 int main (int argc, char **argv)
 {
+	GrisbiApp *app;
 	gint status;
 	GSList *goffice_plugins_dirs = NULL;
 
@@ -106,7 +107,12 @@ int main (int argc, char **argv)
 #endif /* HAVE_GOFFICE */
 
 	/* on execute la boucle principale de grisbi */
-	status = g_application_run (G_APPLICATION (grisbi_app_new ()), argc, argv);
+	app = grisbi_app_new ();
+	status = g_application_run (G_APPLICATION (app), argc, argv);
+
+	/* the import without user of --import-dir can fail */
+	if (status == EXIT_SUCCESS)
+		status = grisbi_app_get_import_status (app);
 
 #ifdef HAVE_GOFFICE
 	/* liberation libgoffice */
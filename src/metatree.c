@@ -68,6 +68,50 @@ static gint button_action_selected = 0;
 static gint metatree_find_payee = 0;
 static gint metatree_find_notes = 0;
 
+/* pack a division and a sub-division in a key of the indexes */
+#define METATREE_DIV_KEY(div,sub_div) (((gint64) (div) << 32) | (guint32) (sub_div))
+
+/* a balance of a division or a sub-division formatted for the amount column */
+typedef struct _MetatreeBalanceString	MetatreeBalanceString;
+struct _MetatreeBalanceString
+{
+	GsbReal			balance;				/* the balance when the string was formatted */
+	gint			currency;				/* the currency of the tree when the string was formatted */
+	gchar			string[GSB_REAL_FORMAT_BUF_SIZE];
+};
+
+/* the indexes of a metatree model, attached to the model with the key "metatree-index"
+ * the iters of a GtkTreeStore persist, they are valid until the row is removed */
+typedef struct _MetatreeIndex	MetatreeIndex;
+struct _MetatreeIndex
+{
+	GHashTable *	div_rows;				/* key : (div, sub_div) packed in a gint64, value : a GtkTreeIter */
+	GHashTable *	transaction_rows;		/* key : the transaction number, value : a GtkTreeIter */
+	gboolean		rows_complete;			/* FALSE if some rows of the model are not in the indexes */
+	gboolean		removing_row;			/* TRUE while metatree_remove_row removes a row */
+
+	GHashTable *	div_transactions;		/* key : (div, sub_div) packed in a gint64, value : a GArray of numbers */
+	GArray *		no_div_transactions;	/* all the transactions without division */
+	guint			serial;					/* the transactions serial when div_transactions was built */
+	gint			sort_transactions;
+	gboolean		add_archive_in_totals;
+
+	GHashTable *	balance_strings;		/* key : (div, sub_div) packed in a gint64, -1 as sub_div for
+											 * the division row, value : a MetatreeBalanceString */
+};
+
+/* choose the transactions moved by metatree_move_div_transactions */
+typedef gboolean (* MetatreeTransactionFilter) (gint transaction_number,
+												gpointer data);
+
+/* the strings looked for by metatree_transaction_is_identical */
+typedef struct _MetatreeIdenticalSearch	MetatreeIdenticalSearch;
+struct _MetatreeIdenticalSearch
+{
+	gchar *			payee_key;				/* collate key of the payee or NULL */
+	gchar *			notes_key;				/* collate key of the notes or NULL */
+};
+
 /******************************************************************************/
 /* Private functions                                                          */
 /******************************************************************************/
@@ -179,8 +223,35 @@ static void move_transactions_to_division_payee (GtkTreeModel *model,
 							gint orig_div, gint dest_div);
 static gboolean search_for_div_or_subdiv (GtkTreeModel *model, GtkTreePath *path,
 							GtkTreeIter *iter, gpointer *pointers);
-static gboolean search_for_transaction (GtkTreeModel *model, GtkTreePath *path,
-							GtkTreeIter *iter, gpointer *pointers);
+static MetatreeIndex *metatree_get_index (GtkTreeModel *model);
+static GArray *metatree_get_div_transactions (GtkTreeModel *model,
+							MetatreeInterface *iface,
+							gint division, gint sub_division);
+static gboolean metatree_get_sub_division_child (GtkTreeModel *model,
+							GtkTreeIter *parent_iter,
+							gint sub_division,
+							GtkTreeIter *child_iter);
+static void metatree_fill_sub_divisions (GtkTreeModel *model,
+							MetatreeInterface *iface,
+							GtkTreeIter *iter,
+							gint division);
+static void metatree_invalidate_division (GtkTreeModel *model,
+							MetatreeInterface *iface,
+							gint division,
+							gint sub_division);
+static gint metatree_move_div_transactions (MetatreeInterface *iface,
+							gint no_division,
+							gint no_sub_division,
+							gint new_division,
+							gint new_sub_division,
+							MetatreeTransactionFilter filter,
+							gpointer filter_data);
+static gboolean metatree_transaction_is_identical (gint transaction_number,
+							MetatreeIdenticalSearch *search);
+static void metatree_register_row (GtkTreeModel *model, GtkTreeIter *iter,
+							gint division, gint sub_division,
+							gint transaction_number);
+static gboolean metatree_remove_row (GtkTreeModel *model, GtkTreeIter *iter);
 static void supprimer_sub_division (GtkTreeView *tree_view, GtkTreeModel *model,
 							MetatreeInterface *iface,
 							gint sub_division, gint division);
@@ -313,7 +384,9 @@ gboolean metatree_get (GtkTreeModel *model, GtkTreePath *path,
 
 /**
  * Fill a division row with textual representation of a division
- * structure, in the form: "Name (num transactions) Balance".
+ * structure, in the form: "Name (num transactions)".
+ * the balance is formatted by metatree_balance_cell_data_func when the row is drawn
+ * and the sub-divisions are added when the division is expanded
  *
  * \param model		The GtkTreeModel that contains iter.
  * \param iface		A pointer to the metatree interface to use
@@ -323,7 +396,6 @@ gboolean metatree_get (GtkTreeModel *model, GtkTreePath *path,
 void fill_division_row (GtkTreeModel *model, MetatreeInterface *iface,
 						GtkTreeIter *iter, gint division)
 {
-	gchar *balance = NULL;
 	gchar *string_tmp;
 	GtkTreeIter dumb_iter;
 	GtkTreePath *path;
@@ -350,19 +422,22 @@ void fill_division_row (GtkTreeModel *model, MetatreeInterface *iface,
 	label = g_strdup_printf ("%s (%d)", string_tmp, number_transactions);
 	g_free (string_tmp);
 	string_tmp = label;
-	balance = utils_real_get_string_with_currency (iface->div_balance (division), iface->tree_currency (), TRUE);
 
 	/* add a white child to show the arrow to open it */
 	if (! gtk_tree_model_iter_has_child (model, iter) && (iface->depth == 1 || !division))
 		gtk_tree_store_append (GTK_TREE_STORE (model), &dumb_iter, iter);
 	}
 
+	/* a white child too for the sub-divisions, there is always at least the "no sub-division" one */
+	if (division && iface->depth > 1 && ! gtk_tree_model_iter_has_child (model, iter))
+		gtk_tree_store_append (GTK_TREE_STORE (model), &dumb_iter, iter);
+
 	/* set 0 for the sub-div, so no categ/no budget have 0 for div and 0 for sub-div */
 	gtk_tree_store_set (GTK_TREE_STORE(model),
 						iter,
 						META_TREE_TEXT_COLUMN, string_tmp,
 						META_TREE_POINTER_COLUMN, division,
-						META_TREE_BALANCE_COLUMN, balance,
+						META_TREE_BALANCE_COLUMN, NULL,
 						META_TREE_XALIGN_COLUMN, 1.0,
 						META_TREE_NO_DIV_COLUMN, division,
 						META_TREE_NO_SUB_DIV_COLUMN, 0,
@@ -371,14 +446,13 @@ void fill_division_row (GtkTreeModel *model, MetatreeInterface *iface,
 						META_TREE_DATE_COLUMN, NULL,
 						-1);
 	g_free (string_tmp);
-	if (balance)
-		g_free (balance);
+	metatree_register_row (model, iter, division, 0, 0);
 }
 
 /**
  * Fill a sub-division row with textual representation of a
- * sub-division structure, in the form: "Name (num transactions)
- * Balance".
+ * sub-division structure, in the form: "Name (num transactions)".
+ * the balance is formatted by metatree_balance_cell_data_func
  *
  * \param model		The GtkTreeModel that contains iter.
  * \param iface		A pointer to the metatree interface to use
@@ -392,7 +466,6 @@ void fill_sub_division_row (GtkTreeModel *model,
 						gint division,
 						gint sub_division)
 {
-	gchar *balance = NULL;
 	gchar *string_tmp;
 	GtkTreeIter dumb_iter;
 	GtkTreePath *path;
@@ -428,15 +501,12 @@ void fill_sub_division_row (GtkTreeModel *model,
 
 	if (! gtk_tree_model_iter_has_child (model, iter))
 		gtk_tree_store_append (GTK_TREE_STORE (model), &dumb_iter, iter);
-
-	balance = utils_real_get_string_with_currency (iface->sub_div_balance (division, sub_division),
-							  iface->tree_currency (), TRUE);
 	}
 
 	gtk_tree_store_set (GTK_TREE_STORE (model), iter,
 			 META_TREE_TEXT_COLUMN, string_tmp,
 			 META_TREE_POINTER_COLUMN, sub_division,
-			 META_TREE_BALANCE_COLUMN, balance,
+			 META_TREE_BALANCE_COLUMN, NULL,
 			 META_TREE_XALIGN_COLUMN, 1.0,
 			 META_TREE_NO_DIV_COLUMN, division,
 			 META_TREE_NO_SUB_DIV_COLUMN, sub_division,
@@ -445,8 +515,10 @@ void fill_sub_division_row (GtkTreeModel *model,
 			 META_TREE_DATE_COLUMN, NULL,
 			 -1);
 	g_free (string_tmp);
-	if (balance)
-	g_free (balance);
+
+	/* the row without sub-division is found with the division */
+	if (sub_division)
+		metatree_register_row (model, iter, division, sub_division, 0);
 }
 
 /**
@@ -461,7 +533,7 @@ void fill_transaction_row (GtkTreeModel *model,
 							gint transaction_number)
 {
 	gchar *account; /* no need to be freed */
-	gchar *amount = NULL;
+	gchar amount[GSB_REAL_FORMAT_BUF_SIZE];
 	gchar *label = NULL;
 	gchar *notes = NULL;
 	gchar *str_to_free;
@@ -532,8 +604,11 @@ void fill_transaction_row (GtkTreeModel *model,
 		g_free (str_to_free);
 	}
 
-	amount = utils_real_get_string_with_currency (gsb_data_transaction_get_amount (transaction_number),
-						 gsb_data_transaction_get_currency_number (transaction_number), TRUE);
+	utils_real_write_string_with_currency (gsb_data_transaction_get_amount (transaction_number),
+										   gsb_data_transaction_get_currency_number (transaction_number),
+										   TRUE,
+										   amount,
+										   sizeof (amount));
 	account = gsb_data_account_get_name (gsb_data_transaction_get_account_number (transaction_number));
 	gtk_tree_store_set (GTK_TREE_STORE(model), iter,
 			 META_TREE_POINTER_COLUMN, transaction_number,
@@ -547,8 +622,8 @@ void fill_transaction_row (GtkTreeModel *model,
 			 META_TREE_FONT_COLUMN, 400,
 			 META_TREE_DATE_COLUMN, gsb_data_transaction_get_date (transaction_number),
 			 -1);
-	g_free(amount);
 	g_free(label);
+	metatree_register_row (model, iter, 0, 0, transaction_number);
 }
 
 /**
@@ -585,7 +660,7 @@ void metatree_fill_new_division (MetatreeInterface *iface,
 						GtkTreeModel *model,
 						gint div_id)
 {
-	GtkTreeIter iter, sub_iter;
+	GtkTreeIter iter;
 	GtkTreeView *tree_view;
 
 	gchar*strtmp = g_strdup_printf ("metatree_fill_new_division %d", div_id);
@@ -596,16 +671,10 @@ void metatree_fill_new_division (MetatreeInterface *iface,
 	if (! metatree_model_is_displayed (model))
 	return;
 
+	/* the "no sub-division" row will be added when the division is expanded */
 	gtk_tree_store_append (GTK_TREE_STORE(model), &iter, NULL);
 	fill_division_row (model, iface, &iter, div_id);
 
-	if (iface->depth > 1)
-	{
-	gtk_tree_store_append (GTK_TREE_STORE (model), &sub_iter, &iter);
-	fill_sub_division_row (GTK_TREE_MODEL(model), iface, &sub_iter,
-				div_id, 0);
-	}
-
 	tree_view = g_object_get_data (G_OBJECT(model), "tree-view");
 	g_return_if_fail (tree_view);
 
@@ -666,11 +735,19 @@ void metatree_fill_new_sub_division (MetatreeInterface *iface,
 	g_free (strtmp);
 
 	parent_iter = get_iter_from_div (model, div_id, 0);
+	if (!parent_iter)
+		return;
+
+	/* add first the other sub-divisions if the division was not expanded yet,
+	 * the new one can be one of them */
+	metatree_fill_sub_divisions (model, iface, parent_iter, div_id);
+	if (!metatree_get_sub_division_child (model, parent_iter, sub_div_id, &iter))
+		gtk_tree_store_append (GTK_TREE_STORE(model), &iter, parent_iter);
 
-	gtk_tree_store_append (GTK_TREE_STORE(model), &iter, parent_iter);
 	fill_sub_division_row (model, iface, &iter,
 				div_id,
 				sub_div_id);
+	gtk_tree_iter_free (parent_iter);
 
 	tree_view = g_object_get_data (G_OBJECT(model), "tree-view");
 	g_return_if_fail (tree_view);
@@ -1010,6 +1087,116 @@ void metatree_remove_transaction (GtkTreeView *tree_view,
 	gsb_file_set_modified (TRUE);
 }
 
+/**
+ * cell data function of the amount column of the metatrees
+ * the balances of the divisions and sub-divisions are formatted only
+ * when their row is drawn, and the string is kept until the balance changes
+ *
+ * \param tree_column
+ * \param cell
+ * \param model
+ * \param iter
+ * \param data not used
+ *
+ * \return
+ **/
+void metatree_balance_cell_data_func (GtkTreeViewColumn *tree_column,
+									  GtkCellRenderer *cell,
+									  GtkTreeModel *model,
+									  GtkTreeIter *iter,
+									  gpointer data)
+{
+	MetatreeBalanceString *balance_string;
+	MetatreeIndex *index;
+	MetatreeInterface *iface;
+	GsbReal balance;
+	gchar *amount;
+	gchar *text;
+	gint currency;
+	gint no_div;
+	gint no_sub_div;
+	gint no_transaction;
+	gint number_transactions;
+	gint64 key;
+
+	gtk_tree_model_get (model, iter,
+						META_TREE_TEXT_COLUMN, &text,
+						META_TREE_BALANCE_COLUMN, &amount,
+						META_TREE_NO_DIV_COLUMN, &no_div,
+						META_TREE_NO_SUB_DIV_COLUMN, &no_sub_div,
+						META_TREE_NO_TRANSACTION_COLUMN, &no_transaction,
+						-1);
+
+	/* the "dummy" iters and the transactions */
+	if (!text || no_transaction || amount)
+	{
+		g_object_set (G_OBJECT (cell), "text", amount, NULL);
+		g_free (text);
+		g_free (amount);
+		return;
+	}
+	g_free (text);
+
+	iface = g_object_get_data (G_OBJECT (model), "metatree-interface");
+	if (!iface)
+	{
+		g_object_set (G_OBJECT (cell), "text", NULL, NULL);
+		return;
+	}
+
+	/* the row without sub-division has 0 as sub-division, like its division */
+	if (gtk_tree_store_iter_depth (GTK_TREE_STORE (model), iter) == 0)
+	{
+		number_transactions = iface->div_nb_transactions (no_div);
+		key = METATREE_DIV_KEY (no_div, -1);
+	}
+	else
+	{
+		number_transactions = iface->sub_div_nb_transactions (no_div, no_sub_div);
+		key = METATREE_DIV_KEY (no_div, no_sub_div);
+	}
+
+	if (!number_transactions)
+	{
+		g_object_set (G_OBJECT (cell), "text", NULL, NULL);
+		return;
+	}
+
+	if (gtk_tree_store_iter_depth (GTK_TREE_STORE (model), iter) == 0)
+		balance = iface->div_balance (no_div);
+	else
+		balance = iface->sub_div_balance (no_div, no_sub_div);
+	currency = iface->tree_currency ();
+
+	index = metatree_get_index (model);
+	balance_string = g_hash_table_lookup (index->balance_strings, &key);
+	if (!balance_string)
+	{
+		gint64 *new_key;
+
+		new_key = g_malloc (sizeof (gint64));
+		*new_key = key;
+		balance_string = g_malloc0 (sizeof (MetatreeBalanceString));
+		balance_string->currency = -1;
+		g_hash_table_insert (index->balance_strings, new_key, balance_string);
+	}
+
+	if (balance_string->currency != currency
+		|| balance_string->balance.mantissa != balance.mantissa
+		|| balance_string->balance.exponent != balance.exponent)
+	{
+		utils_real_write_string_with_currency (balance,
+											   currency,
+											   TRUE,
+											   balance_string->string,
+											   sizeof (balance_string->string));
+		balance_string->balance = balance;
+		balance_string->currency = currency;
+	}
+
+	g_object_set (G_OBJECT (cell), "text", balance_string->string, NULL);
+}
+
 /**
  * callback when expand a row
  *
@@ -1037,54 +1224,59 @@ void metatree_division_column_expanded  (GtkTreeView *treeview,
 	if (!gtk_tree_model_iter_children(model, &child_iter, iter))
 		return;
 
+	iface = g_object_get_data (G_OBJECT(model), "metatree-interface");
+	gtk_tree_model_get (model, iter,
+						META_TREE_NO_DIV_COLUMN, &no_division,
+						META_TREE_NO_SUB_DIV_COLUMN, &no_sub_division,
+						-1);
+
+	/* the sub-divisions are added the first time the division is expanded */
+	if (iface->depth > 1 && no_division && gtk_tree_path_get_depth (tree_path) == 1)
+	{
+		metatree_fill_sub_divisions (model, iface, iter, no_division);
+
+		/* on colorise les lignes du tree_view */
+		utils_set_tree_store_background_color (GTK_WIDGET (treeview), META_TREE_BACKGROUND_COLOR);
+		return;
+	}
+
 	gtk_tree_model_get (model, &child_iter, META_TREE_TEXT_COLUMN, &name, -1);
 
 	/* If there is already an entry there, don't populate it. */
 	if (!name)
 	{
 		gboolean first = TRUE;
-		GSList *list_tmp_transactions;
-
-		iface = g_object_get_data (G_OBJECT(model), "metatree-interface");
-
-		gtk_tree_model_get (model, iter,
-							META_TREE_NO_DIV_COLUMN, &no_division,
-							META_TREE_NO_SUB_DIV_COLUMN, &no_sub_division,
-							-1);
+		GArray *transactions;
+		guint i;
 
-		list_tmp_transactions = gsb_data_transaction_get_metatree_transactions_list ();
+		/* only the transactions of the div/sub-div, in the order of the metatree */
+		transactions = metatree_get_div_transactions (model, iface, no_division, no_sub_division);
 
-		while (list_tmp_transactions)
+		for (i = 0 ; transactions && i < transactions->len ; i++)
 		{
 			gint transaction_number_tmp;
 
-			transaction_number_tmp = gsb_data_transaction_get_transaction_number (list_tmp_transactions->data);
+			transaction_number_tmp = g_array_index (transactions, gint, i);
 
-			/* set the transaction if the same div/sub-div
+			/* without division, set the transaction if the same sub-div
 			 * or if no categ (must check if no transfer or split) */
-			if (transaction_number_tmp
-				&& ((iface->transaction_div_id (transaction_number_tmp) == no_division
-					 && iface->transaction_sub_div_id (transaction_number_tmp) == no_sub_division)
-					|| (!no_division
-					    && !iface->transaction_div_id (transaction_number_tmp)
-					    && !gsb_data_transaction_get_split_of_transaction (transaction_number_tmp)
-					    && gsb_data_transaction_get_contra_transaction_number (transaction_number_tmp) == 0)))
+			if (!no_division
+				&& iface->transaction_sub_div_id (transaction_number_tmp) != no_sub_division
+				&& (gsb_data_transaction_get_split_of_transaction (transaction_number_tmp)
+					|| gsb_data_transaction_get_contra_transaction_number (transaction_number_tmp) != 0))
+				continue;
 
+			if (!first)
 			{
-				if (!first)
-				{
-					gtk_tree_store_append (GTK_TREE_STORE(model), &child_iter, iter);
-				}
-				else
-				{
-					first = FALSE;
-				}
-
-				fill_transaction_row (model, &child_iter, transaction_number_tmp);
+				gtk_tree_store_append (GTK_TREE_STORE(model), &child_iter, iter);
+			}
+			else
+			{
+				first = FALSE;
 			}
-			list_tmp_transactions = list_tmp_transactions->next;
+
+			fill_transaction_row (model, &child_iter, transaction_number_tmp);
 		}
-			g_slist_free (list_tmp_transactions);
 
 		/* on colorise les lignes du tree_view */
 		utils_set_tree_store_background_color (GTK_WIDGET (treeview), META_TREE_BACKGROUND_COLOR);
@@ -1337,6 +1529,9 @@ gboolean division_drag_data_received (GtkTreeDragDest *drag_dest,
 		move_sub_division_to_division (model,
 						   no_dest_division,
 						   no_orig_division, no_orig_sub_division);
+
+		/* update the transactions list once */
+		metatree_update_tree_view (iface);
 		break;
 
 		case META_TREE_DIV:
@@ -1480,7 +1675,7 @@ void move_transaction_to_sub_division (gint transaction_number,
 				fill_division_row (model, iface, &parent_iter, old_div);
 		}
 		/* Remove old row */
-		gtk_tree_store_remove (GTK_TREE_STORE (model), &orig_iter);
+		metatree_remove_row (model, &orig_iter);
 	}
 
 	/* We did some modifications */
@@ -1506,7 +1701,6 @@ void move_sub_division_to_division (GtkTreeModel *model,
 	GtkTreeIter *orig_iter, *iter_parent;
 	MetatreeInterface *iface;
 	gint no_dest_sub_division = 0;
-	GSList *list_tmp_transactions;
 
 	if (!model)
 	return;
@@ -1526,8 +1720,10 @@ void move_sub_division_to_division (GtkTreeModel *model,
 	if (no_orig_sub_division)
 	{
 	/* there is a sub-division, append a new one to the new division
-	 * to add the transactions */
-	gtk_tree_store_append (GTK_TREE_STORE(model), &iter, iter_parent);
+	 * to add the transactions, if it is not there once the division is filled */
+	metatree_fill_sub_divisions (model, iface, iter_parent, no_dest_division);
+	if (!metatree_get_sub_division_child (model, iter_parent, no_dest_sub_division, &iter))
+		gtk_tree_store_append (GTK_TREE_STORE(model), &iter, iter_parent);
 	}
 	else
 	{
@@ -1536,27 +1732,8 @@ void move_sub_division_to_division (GtkTreeModel *model,
 	}
 
 	/* fill the new sub-division (or dest division for payee) with the transactions */
-	list_tmp_transactions = gsb_data_transaction_get_complete_transactions_list ();
-
-	while (list_tmp_transactions)
-	{
-	gint transaction_number_tmp;
-	transaction_number_tmp = gsb_data_transaction_get_transaction_number (list_tmp_transactions->data);
-
-	if (transaction_number_tmp &&
-		 iface->transaction_div_id (transaction_number_tmp) == no_orig_division &&
-		 iface->transaction_sub_div_id (transaction_number_tmp) == no_orig_sub_division)
-	{
-		GtkTreePath *path;
-
-		path = gtk_tree_model_get_path (model, &iter);
-		move_transaction_to_sub_division (transaction_number_tmp, model,
-						   NULL, path,
-						   no_dest_division,
-						   no_dest_sub_division);
-	}
-	list_tmp_transactions = list_tmp_transactions->next;
-	}
+	metatree_move_div_transactions (iface, no_orig_division, no_orig_sub_division,
+									no_dest_division, no_dest_sub_division, NULL, NULL);
 
 	/* set orig_iter to the initial sub-division */
 	orig_iter = get_iter_from_div (model, no_orig_division, no_orig_sub_division);
@@ -1569,7 +1746,7 @@ void move_sub_division_to_division (GtkTreeModel *model,
 
 	/* Remove original division. */
 	iface->remove_sub_div (no_orig_division, no_orig_sub_division);
-	gtk_tree_store_remove (GTK_TREE_STORE(model), orig_iter);
+	metatree_remove_row (model, orig_iter);
 	gtk_tree_iter_free (orig_iter);
 
 	/* If it was no sub-division, recreate it. */
@@ -1579,9 +1756,10 @@ void move_sub_division_to_division (GtkTreeModel *model,
 					 no_orig_division, no_orig_sub_division);
 	}
 
-	/* Update dest at last. */
+	/* Update dest at last, its transactions are shown again if it was expanded */
 	fill_sub_division_row (model, iface, &iter,
 				no_dest_division, no_dest_sub_division);
+	metatree_invalidate_division (model, iface, no_dest_division, no_dest_sub_division);
 	gtk_tree_iter_free (iter_parent);
 	gsb_file_set_modified (TRUE);
 }
@@ -1995,157 +2173,861 @@ gboolean find_associated_transactions (MetatreeInterface *iface,
 }
 
 /**
- * return the the iter of a div and sub_div
+ * free the indexes of a metatree model
+ *
+ * \param index
+ *
+ * \return
+ **/
+static void metatree_index_free (MetatreeIndex *index)
+{
+	g_hash_table_destroy (index->div_rows);
+	g_hash_table_destroy (index->transaction_rows);
+	if (index->div_transactions)
+		g_hash_table_destroy (index->div_transactions);
+	if (index->no_div_transactions)
+		g_array_free (index->no_div_transactions, TRUE);
+	g_hash_table_destroy (index->balance_strings);
+	g_free (index);
+}
+
+/**
+ * callback when a row is deleted from a metatree model
+ * if the row was not removed by metatree_remove_row, we don't know which
+ * iters are invalid, so the rows will be indexed again when needed
  *
  * \param model
- * \param div
- * \param sub_div 0 if just div
+ * \param path
+ * \param index
  *
- * \return a newly allocated GtkTreeIter or NULL
+ * \return
  **/
-GtkTreeIter *get_iter_from_div (GtkTreeModel *model, int div, int sub_div)
+static void metatree_index_row_deleted (GtkTreeModel *model,
+										GtkTreePath *path,
+										MetatreeIndex *index)
 {
-	gpointer pointeurs[3] = { GINT_TO_POINTER (div), GINT_TO_POINTER (sub_div), NULL };
+	GtkTreeIter iter;
 
-	gtk_tree_model_foreach (model, (GtkTreeModelForeachFunc) search_for_div_or_subdiv,
-				 pointeurs);
+	if (index->removing_row)
+		return;
 
-	return (GtkTreeIter *) pointeurs[2];
+	g_hash_table_remove_all (index->div_rows);
+	g_hash_table_remove_all (index->transaction_rows);
+
+	/* an empty model (cleared before filling it again) has no row to index
+	 * and the balances will be formatted again */
+	index->rows_complete = !gtk_tree_model_get_iter_first (model, &iter);
+	if (index->rows_complete)
+		g_hash_table_remove_all (index->balance_strings);
 }
 
 /**
- * this is a tree model foreach function
+ * this is a tree model foreach function which indexes the rows
+ * as metatree_register_row
  *
  * \param model
  * \param path
  * \param iter
- * \param pointers a structure { gpointer div, gpointer sub_div, gpointer }
- * 		div and sub-div transformed by GINT_TO_POINTER
+ * \param index
  *
- * \return FALSE not found, TRUE found
+ * \return FALSE to continue
  **/
-gboolean search_for_div_or_subdiv (GtkTreeModel *model,
-									GtkTreePath *path,
-									GtkTreeIter *iter,
-									gpointer *pointers)
+static gboolean metatree_index_add_row (GtkTreeModel *model,
+										GtkTreePath *path,
+										GtkTreeIter *iter,
+										MetatreeIndex *index)
 {
-    int no_div, no_sub_div;
-    gchar *text;
+	gchar *text;
+	gint no_div;
+	gint no_sub_div;
+	gint no_transaction;
+	gint64 key;
+
+	gtk_tree_model_get (model, iter,
+						META_TREE_TEXT_COLUMN, &text,
+						META_TREE_NO_DIV_COLUMN, &no_div,
+						META_TREE_NO_SUB_DIV_COLUMN, &no_sub_div,
+						META_TREE_NO_TRANSACTION_COLUMN, &no_transaction,
+						-1);
 
-    gtk_tree_model_get (GTK_TREE_MODEL(model), iter,
-			 META_TREE_TEXT_COLUMN, &text,
-			 META_TREE_NO_DIV_COLUMN, &no_div,
-			 META_TREE_NO_SUB_DIV_COLUMN, &no_sub_div,
-			 -1);
+	/* skip the "dummy" iters which are here only to provide a slider */
+	if (!text)
+		return FALSE;
+	g_free (text);
 
-    /* This is a kludge because we want to skip "dummy" iters that are
-     * here only to provide a slider.*/
-    if (!text)
-	return FALSE;
+	if (no_transaction)
+	{
+		if (!g_hash_table_contains (index->transaction_rows, GINT_TO_POINTER (no_transaction)))
+			g_hash_table_insert (index->transaction_rows,
+								 GINT_TO_POINTER (no_transaction),
+								 gtk_tree_iter_copy (iter));
 
-    if (! pointers[0] && (!pointers[1] || !GPOINTER_TO_INT (pointers[1]))
-	 &&
-	 !no_div && !no_sub_div)
-    {
-	pointers[2] = gtk_tree_iter_copy (iter);
-	return TRUE;
-    }
+		return FALSE;
+	}
 
-    if (no_div == GPOINTER_TO_INT (pointers[0]))
-    {
-	if ((!GPOINTER_TO_INT (pointers[1])) ||
-	     (no_sub_div == GPOINTER_TO_INT (pointers[1])))
+	/* the row without sub-division is found with the division */
+	if (!no_sub_div && gtk_tree_path_get_depth (path) > 1)
+		return FALSE;
+
+	key = METATREE_DIV_KEY (no_div, no_sub_div);
+	if (!g_hash_table_contains (index->div_rows, &key))
 	{
-	    pointers[2] = gtk_tree_iter_copy (iter);
-	    return TRUE;
+		gint64 *new_key;
+
+		new_key = g_malloc (sizeof (gint64));
+		*new_key = key;
+		g_hash_table_insert (index->div_rows, new_key, gtk_tree_iter_copy (iter));
 	}
-    }
-    return FALSE;
+
+	return FALSE;
 }
 
 /**
- * return the the iter of a transaction
+ * index again all the rows of the model if some of them are missing
  *
  * \param model
- * \param transaction_number
+ * \param index
  *
- * \return a newly allocated GtkTreeIter or NULL
+ * \return
  **/
-GtkTreeIter *get_iter_from_transaction (GtkTreeModel *model,
-										gint transaction_number)
+static void metatree_index_complete_rows (GtkTreeModel *model,
+										  MetatreeIndex *index)
 {
-	gpointer pointeurs[2] = { GINT_TO_POINTER (transaction_number), NULL };
+	if (index->rows_complete)
+		return;
 
-	gtk_tree_model_foreach (model, (GtkTreeModelForeachFunc)
-						search_for_transaction, pointeurs);
+	gtk_tree_model_foreach (model, (GtkTreeModelForeachFunc) metatree_index_add_row, index);
+	index->rows_complete = TRUE;
+}
 
-	return (GtkTreeIter *) pointeurs[1];
+/**
+ * return the indexes of the model, create them if necessary
+ *
+ * \param model
+ *
+ * \return the indexes
+ **/
+static MetatreeIndex *metatree_get_index (GtkTreeModel *model)
+{
+	MetatreeIndex *index;
+
+	index = g_object_get_data (G_OBJECT (model), "metatree-index");
+	if (index)
+		return index;
+
+	index = g_malloc0 (sizeof (MetatreeIndex));
+	index->rows_complete = FALSE;
+	index->div_rows = g_hash_table_new_full (g_int64_hash,
+											 g_int64_equal,
+											 (GDestroyNotify) g_free,
+											 (GDestroyNotify) gtk_tree_iter_free);
+	index->transaction_rows = g_hash_table_new_full (g_direct_hash,
+													 g_direct_equal,
+													 NULL,
+													 (GDestroyNotify) gtk_tree_iter_free);
+	index->balance_strings = g_hash_table_new_full (g_int64_hash,
+													g_int64_equal,
+													(GDestroyNotify) g_free,
+													(GDestroyNotify) g_free);
+	g_object_set_data_full (G_OBJECT (model), "metatree-index", index, (GDestroyNotify) metatree_index_free);
+	g_signal_connect (G_OBJECT (model),
+					  "row-deleted",
+					  G_CALLBACK (metatree_index_row_deleted),
+					  index);
+
+	return index;
 }
 
 /**
- * this is a tree model foreach function
+ * keep the iter of a row filled with a division, a sub-division
+ * or a transaction
  *
  * \param model
- * \param path
  * \param iter
- * \param pointers a structure { gpointer transaction_number, gpointer }
- * 		transaction_number transformed by GINT_TO_POINTER
+ * \param division
+ * \param sub_division
+ * \param transaction_number 0 for a division or a sub-division
  *
- * \return FALSE not found, TRUE found
+ * \return
  **/
-gboolean search_for_transaction (GtkTreeModel *model,
-						GtkTreePath *path,
-						GtkTreeIter *iter,
-						gpointer *pointers)
+static void metatree_register_row (GtkTreeModel *model,
+								   GtkTreeIter *iter,
+								   gint division,
+								   gint sub_division,
+								   gint transaction_number)
 {
-	gint current_number;
-
-	gtk_tree_model_get (GTK_TREE_MODEL(model), iter,
-			 META_TREE_POINTER_COLUMN, &current_number,
-			 -1);
+	MetatreeIndex *index;
 
-	if (current_number == GPOINTER_TO_INT (pointers[0]))
+	index = metatree_get_index (model);
+	if (transaction_number)
+		g_hash_table_replace (index->transaction_rows,
+							  GINT_TO_POINTER (transaction_number),
+							  gtk_tree_iter_copy (iter));
+	else
 	{
-	pointers[1] = gtk_tree_iter_copy (iter);
-	return TRUE;
+		gint64 *key;
+
+		key = g_malloc (sizeof (gint64));
+		*key = METATREE_DIV_KEY (division, sub_division);
+		g_hash_table_replace (index->div_rows, key, gtk_tree_iter_copy (iter));
 	}
-	return FALSE;
 }
 
 /**
- * Update a transaction in a tree model if it is possible to find its
- * associated GtkTreeIter.  This function is not responsible to remove
- * old transaction if transaction has changed in a way that would
- * move it in the tree (i.e, its category has changed and we want to
- * update the category tree).
+ * forget the iters of a row and its children before removing them
  *
- * \param iface		A MetatreeInterface to use.
- * \param model		Tree model to update.
- * \param transaction_number   Transaction to update if associated GtkTreeIter exists.
+ * \param model
+ * \param index
+ * \param iter
+ *
+ * \return
  **/
-void update_transaction_in_tree (MetatreeInterface *iface,
-						GtkTreeModel *model,
-						gint transaction_number)
+static void metatree_unregister_rows (GtkTreeModel *model,
+									  MetatreeIndex *index,
+									  GtkTreeIter *iter)
 {
-	GtkTreeIter *transaction_iter;
-	GtkTreeIter *div_iter;
-	GtkTreeIter *sub_div_iter = NULL;
-	GtkTreePath *transaction_path;
-	GtkTreePath *div_path;
-	GtkTreePath *sub_div_path = NULL;
-	gint div_id;
-	gint sub_div_id;
 	GtkTreeIter child_iter;
+	GtkTreeIter *registered_iter;
+	gchar *text;
+	gint no_div;
+	gint no_sub_div;
+	gint no_transaction;
+
+	gtk_tree_model_get (model, iter,
+						META_TREE_TEXT_COLUMN, &text,
+						META_TREE_NO_DIV_COLUMN, &no_div,
+						META_TREE_NO_SUB_DIV_COLUMN, &no_sub_div,
+						META_TREE_NO_TRANSACTION_COLUMN, &no_transaction,
+						-1);
 
-	if (!transaction_number || !metatree_model_is_displayed (model))
-		return;
+	if (text)
+	{
+		/* the iters of a GtkTreeStore are the same if they point to the same node */
+		if (no_transaction)
+		{
+			registered_iter = g_hash_table_lookup (index->transaction_rows, GINT_TO_POINTER (no_transaction));
+			if (registered_iter && registered_iter->user_data == iter->user_data)
+				g_hash_table_remove (index->transaction_rows, GINT_TO_POINTER (no_transaction));
+		}
+		else
+		{
+			gint64 key;
 
-	div_id = iface->transaction_div_id (transaction_number);
-	sub_div_id = iface->transaction_sub_div_id (transaction_number);
+			key = METATREE_DIV_KEY (no_div, no_sub_div);
+			registered_iter = g_hash_table_lookup (index->div_rows, &key);
+			if (registered_iter && registered_iter->user_data == iter->user_data)
+				g_hash_table_remove (index->div_rows, &key);
+		}
+		g_free (text);
+	}
 
-	/* Fill in division if existing. */
-	div_iter = get_iter_from_div (model, div_id, 0);
-	if (div_iter)
+	if (gtk_tree_model_iter_children (model, &child_iter, iter))
+	{
+		do
+			metatree_unregister_rows (model, index, &child_iter);
+		while (gtk_tree_model_iter_next (model, &child_iter));
+	}
+}
+
+/**
+ * remove a row of a metatree and keep the indexes valid
+ *
+ * \param model
+ * \param iter the row to remove, set to the next row as gtk_tree_store_remove
+ *
+ * \return TRUE if iter is valid
+ **/
+static gboolean metatree_remove_row (GtkTreeModel *model,
+									 GtkTreeIter *iter)
+{
+	MetatreeIndex *index;
+	gboolean valid;
+
+	index = metatree_get_index (model);
+	metatree_unregister_rows (model, index, iter);
+
+	index->removing_row = TRUE;
+	valid = gtk_tree_store_remove (GTK_TREE_STORE (model), iter);
+	index->removing_row = FALSE;
+
+	return valid;
+}
+
+/**
+ * append a transaction to the transactions of a div/sub-div
+ *
+ * \param table
+ * \param division
+ * \param sub_division
+ * \param transaction_number
+ *
+ * \return
+ **/
+static void metatree_div_transactions_append (GHashTable *table,
+											  gint division,
+											  gint sub_division,
+											  gint transaction_number)
+{
+	GArray *transactions;
+	gint64 key;
+
+	key = METATREE_DIV_KEY (division, sub_division);
+	transactions = g_hash_table_lookup (table, &key);
+	if (!transactions)
+	{
+		gint64 *new_key;
+
+		new_key = g_malloc (sizeof (gint64));
+		*new_key = key;
+		transactions = g_array_new (FALSE, FALSE, sizeof (gint));
+		g_hash_table_insert (table, new_key, transactions);
+	}
+	g_array_append_val (transactions, transaction_number);
+}
+
+/**
+ * return the transactions of a div/sub-div, in the order of the metatree
+ * the transactions are grouped in one pass over the transactions, done again
+ * only when a transaction or the options of the metatrees have changed
+ * for the empty division, return all the transactions without division
+ *
+ * \param model
+ * \param iface
+ * \param division
+ * \param sub_division
+ *
+ * \return a GArray of transactions numbers which must not be freed, or NULL
+ **/
+static GArray *metatree_get_div_transactions (GtkTreeModel *model,
+											  MetatreeInterface *iface,
+											  gint division,
+											  gint sub_division)
+{
+	MetatreeIndex *index;
+	GrisbiWinEtat *w_etat;
+	gint64 key;
+
+	index = metatree_get_index (model);
+	w_etat = grisbi_win_get_w_etat ();
+
+	if (!index->div_transactions
+		|| index->serial != gsb_data_transaction_get_modifications_serial ()
+		|| index->sort_transactions != w_etat->metatree_sort_transactions
+		|| index->add_archive_in_totals != w_etat->metatree_add_archive_in_totals)
+	{
+		GSList *list_tmp_transactions;
+		GSList *tmp_list;
+
+		if (index->div_transactions)
+			g_hash_table_destroy (index->div_transactions);
+		if (index->no_div_transactions)
+			g_array_free (index->no_div_transactions, TRUE);
+
+		index->div_transactions = g_hash_table_new_full (g_int64_hash,
+														 g_int64_equal,
+														 (GDestroyNotify) g_free,
+														 (GDestroyNotify) g_array_unref);
+		index->no_div_transactions = g_array_new (FALSE, FALSE, sizeof (gint));
+
+		list_tmp_transactions = gsb_data_transaction_get_metatree_transactions_list ();
+		tmp_list = list_tmp_transactions;
+		while (tmp_list)
+		{
+			gint transaction_number_tmp;
+			gint div_id;
+
+			transaction_number_tmp = gsb_data_transaction_get_transaction_number (tmp_list->data);
+			if (transaction_number_tmp)
+			{
+				gsb_data_transaction_save_transaction_pointer (tmp_list->data);
+				div_id = iface->transaction_div_id (transaction_number_tmp);
+				if (div_id)
+					metatree_div_transactions_append (index->div_transactions,
+													  div_id,
+													  iface->transaction_sub_div_id (transaction_number_tmp),
+													  transaction_number_tmp);
+				else
+					g_array_append_val (index->no_div_transactions, transaction_number_tmp);
+			}
+			tmp_list = tmp_list->next;
+		}
+		g_slist_free (list_tmp_transactions);
+
+		index->serial = gsb_data_transaction_get_modifications_serial ();
+		index->sort_transactions = w_etat->metatree_sort_transactions;
+		index->add_archive_in_totals = w_etat->metatree_add_archive_in_totals;
+	}
+
+	if (!division)
+		return index->no_div_transactions;
+
+	key = METATREE_DIV_KEY (division, sub_division);
+
+	return g_hash_table_lookup (index->div_transactions, &key);
+}
+
+/**
+ * look for the row of a sub-division in the children of a division row
+ *
+ * \param model
+ * \param parent_iter the row of the division
+ * \param sub_division 0 for the "no sub-division" row
+ * \param child_iter set to the row of the sub-division if found
+ *
+ * \return TRUE if found
+ **/
+static gboolean metatree_get_sub_division_child (GtkTreeModel *model,
+												 GtkTreeIter *parent_iter,
+												 gint sub_division,
+												 GtkTreeIter *child_iter)
+{
+	if (!gtk_tree_model_iter_children (model, child_iter, parent_iter))
+		return FALSE;
+
+	do
+	{
+		gchar *text;
+		gint no_sub_div;
+		gint no_transaction;
+
+		gtk_tree_model_get (model, child_iter,
+							META_TREE_TEXT_COLUMN, &text,
+							META_TREE_NO_SUB_DIV_COLUMN, &no_sub_div,
+							META_TREE_NO_TRANSACTION_COLUMN, &no_transaction,
+							-1);
+
+		/* skip the "dummy" iters */
+		if (!text)
+			continue;
+		g_free (text);
+
+		if (!no_transaction && no_sub_div == sub_division)
+			return TRUE;
+	}
+	while (gtk_tree_model_iter_next (model, child_iter));
+
+	return FALSE;
+}
+
+/**
+ * add the rows of the sub-divisions to a division row, the first time
+ * the division is needed. Until then, the division has only a "dummy" child
+ * to show the arrow to open it
+ *
+ * \param model
+ * \param iface
+ * \param iter the row of the division
+ * \param division
+ *
+ * \return
+ **/
+static void metatree_fill_sub_divisions (GtkTreeModel *model,
+										 MetatreeInterface *iface,
+										 GtkTreeIter *iter,
+										 gint division)
+{
+	GtkTreeIter child_iter;
+	GtkTreeIter dummy_iter;
+	GSList *sub_div_list;
+	gboolean has_dummy = FALSE;
+	gint nb_filled_rows = 0;
+
+	if (!division || iface->depth == 1)
+		return;
+
+	if (!gtk_tree_model_iter_children (model, &child_iter, iter))
+		return;
+
+	do
+	{
+		gchar *text;
+
+		gtk_tree_model_get (model, &child_iter, META_TREE_TEXT_COLUMN, &text, -1);
+		if (text)
+		{
+			nb_filled_rows++;
+			g_free (text);
+		}
+		else if (!has_dummy)
+		{
+			dummy_iter = child_iter;
+			has_dummy = TRUE;
+		}
+	}
+	while (gtk_tree_model_iter_next (model, &child_iter));
+
+	/* the sub-divisions are already there */
+	if (!has_dummy)
+		return;
+
+	/* the "no sub-division" row is the last one */
+	sub_div_list = g_slist_copy (iface->div_sub_div_list (division));
+	sub_div_list = g_slist_append (sub_div_list, NULL);
+
+	while (sub_div_list)
+	{
+		gint sub_division;
+
+		sub_division = sub_div_list->data ? iface->sub_div_id (sub_div_list->data) : 0;
+		sub_div_list = g_slist_delete_link (sub_div_list, sub_div_list);
+
+		/* some sub-divisions may have been added before the division was expanded */
+		if (nb_filled_rows && metatree_get_sub_division_child (model, iter, sub_division, &child_iter))
+			continue;
+
+		if (has_dummy)
+		{
+			child_iter = dummy_iter;
+			has_dummy = FALSE;
+		}
+		else
+			gtk_tree_store_append (GTK_TREE_STORE (model), &child_iter, iter);
+
+		fill_sub_division_row (model, iface, &child_iter, division, sub_division);
+	}
+
+	if (has_dummy)
+		metatree_remove_row (model, &dummy_iter);
+}
+
+/**
+ * update the rows of a div/sub-div after a move of many transactions :
+ * the counters are shown again and the rows of the transactions, if they
+ * were shown, are replaced once from the grouped transactions
+ *
+ * \param model
+ * \param iface
+ * \param division
+ * \param sub_division
+ *
+ * \return
+ **/
+static void metatree_invalidate_division (GtkTreeModel *model,
+										  MetatreeInterface *iface,
+										  gint division,
+										  gint sub_division)
+{
+	GtkTreeIter *div_iter;
+	GtkTreeIter *iter;
+	GtkTreeIter sub_div_iter;
+	GtkTreeIter child_iter;
+	GtkTreePath *path;
+	GtkTreeView *tree_view;
+	gboolean expanded = FALSE;
+
+	if (!metatree_model_is_displayed (model))
+		return;
+
+	div_iter = get_iter_from_div (model, division, 0);
+	if (!div_iter)
+		return;
+
+	/* the row which contains the transactions */
+	if (iface->depth > 1 && division)
+	{
+		if (!metatree_get_sub_division_child (model, div_iter, sub_division, &sub_div_iter))
+		{
+			/* the sub-divisions are not shown yet */
+			fill_division_row (model, iface, div_iter, division);
+			gtk_tree_iter_free (div_iter);
+			return;
+		}
+		iter = &sub_div_iter;
+	}
+	else
+		iter = div_iter;
+
+	path = gtk_tree_model_get_path (model, iter);
+	tree_view = g_object_get_data (G_OBJECT (model), "tree-view");
+	if (tree_view)
+		expanded = gtk_tree_view_row_expanded (tree_view, path);
+
+	while (gtk_tree_model_iter_children (model, &child_iter, iter))
+		metatree_remove_row (model, &child_iter);
+
+	if (iter == div_iter)
+		fill_division_row (model, iface, div_iter, division);
+	else
+	{
+		if (sub_division)
+			fill_sub_division_row (model, iface, iter, division, sub_division);
+		else
+			fill_sub_division_zero (model, iface, iter, division);
+		fill_division_row (model, iface, div_iter, division);
+	}
+
+	/* the transactions are added again by metatree_division_column_expanded */
+	if (expanded)
+		gtk_tree_view_expand_row (tree_view, path, FALSE);
+
+	gtk_tree_path_free (path);
+	gtk_tree_iter_free (div_iter);
+}
+
+/**
+ * move the transactions of a div/sub-div to another div/sub-div in one pass,
+ * archived transactions too. The counters are updated once at the end.
+ * The transactions list is not updated, see metatree_update_tree_view,
+ * and the tree neither, see metatree_invalidate_division
+ *
+ * \param iface
+ * \param no_division
+ * \param no_sub_division -1 for all the sub-divisions of the division
+ * \param new_division
+ * \param new_sub_division
+ * \param filter NULL or a function which returns TRUE for the transactions to move
+ * \param filter_data
+ *
+ * \return the number of moved transactions
+ **/
+static gint metatree_move_div_transactions (MetatreeInterface *iface,
+											gint no_division,
+											gint no_sub_division,
+											gint new_division,
+											gint new_sub_division,
+											MetatreeTransactionFilter filter,
+											gpointer filter_data)
+{
+	GSList *list_tmp;
+	gint nb_transactions = 0;
+
+	list_tmp = gsb_data_transaction_get_complete_transactions_list ();
+
+	while (list_tmp)
+	{
+		gint transaction_number_tmp;
+
+		transaction_number_tmp = gsb_data_transaction_get_transaction_number (list_tmp->data);
+		list_tmp = list_tmp->next;
+
+		if (!transaction_number_tmp
+			|| iface->transaction_div_id (transaction_number_tmp) != no_division
+			|| (no_sub_division >= 0
+				&& iface->transaction_sub_div_id (transaction_number_tmp) != no_sub_division))
+			continue;
+
+		if (filter && !filter (transaction_number_tmp, filter_data))
+			continue;
+
+		/* the setters keep the transaction to count it again */
+		iface->transaction_set_div_id (transaction_number_tmp, new_division);
+		iface->transaction_set_sub_div_id (transaction_number_tmp, new_sub_division);
+		nb_transactions++;
+	}
+
+	if (nb_transactions)
+		gsb_data_transaction_update_counters ();
+
+	return nb_transactions;
+}
+
+/**
+ * filter of metatree_move_div_transactions : the transactions with the same
+ * payee and/or the same notes
+ *
+ * \param transaction_number
+ * \param search a MetatreeIdenticalSearch
+ *
+ * \return TRUE if the transaction must be moved
+ **/
+static gboolean metatree_transaction_is_identical (gint transaction_number,
+												   MetatreeIdenticalSearch *search)
+{
+	gchar *tmp_key;
+	const gchar *tmp_str;
+	gboolean trouve = FALSE;
+
+	if (search->payee_key)
+	{
+		tmp_str = gsb_data_payee_get_name (gsb_data_transaction_get_payee_number (transaction_number), TRUE);
+		tmp_key = tmp_str ? g_utf8_collate_key (tmp_str, -1) : NULL;
+		trouve = tmp_key && !strcmp (tmp_key, search->payee_key);
+		g_free (tmp_key);
+	}
+	if (search->notes_key)
+	{
+		tmp_str = gsb_data_transaction_get_notes (transaction_number);
+		tmp_key = tmp_str ? g_utf8_collate_key (tmp_str, -1) : NULL;
+		trouve = tmp_key && !strcmp (tmp_key, search->notes_key);
+		g_free (tmp_key);
+	}
+
+	return trouve;
+}
+
+/**
+ * return the the iter of a div and sub_div
+ *
+ * \param model
+ * \param div
+ * \param sub_div 0 if just div
+ *
+ * \return a newly allocated GtkTreeIter or NULL
+ **/
+GtkTreeIter *get_iter_from_div (GtkTreeModel *model, int div, int sub_div)
+{
+	gpointer pointeurs[3] = { GINT_TO_POINTER (div), GINT_TO_POINTER (sub_div), NULL };
+	MetatreeIndex *index;
+	GtkTreeIter *iter;
+	gint64 key;
+	gint no_div;
+	gint no_sub_div;
+
+	/* all the rows of divisions are filled by the fill_*_row functions,
+	 * so when the index is complete, a missing division is not displayed */
+	index = metatree_get_index (model);
+	metatree_index_complete_rows (model, index);
+
+	key = METATREE_DIV_KEY (div, sub_div);
+	iter = g_hash_table_lookup (index->div_rows, &key);
+	if (!iter && sub_div)
+	{
+		MetatreeInterface *iface;
+		GtkTreeIter *div_iter;
+		gint64 div_key;
+
+		/* the sub-divisions are added when the division is needed */
+		div_key = METATREE_DIV_KEY (div, 0);
+		div_iter = g_hash_table_lookup (index->div_rows, &div_key);
+		iface = g_object_get_data (G_OBJECT (model), "metatree-interface");
+		if (div_iter && iface)
+		{
+			metatree_fill_sub_divisions (model, iface, div_iter, div);
+			iter = g_hash_table_lookup (index->div_rows, &key);
+		}
+	}
+	if (!iter)
+		return NULL;
+
+	gtk_tree_model_get (model, iter,
+						META_TREE_NO_DIV_COLUMN, &no_div,
+						META_TREE_NO_SUB_DIV_COLUMN, &no_sub_div,
+						-1);
+	if (no_div == div && no_sub_div == sub_div)
+		return gtk_tree_iter_copy (iter);
+
+	/* the row was filled again with another division */
+	gtk_tree_model_foreach (model, (GtkTreeModelForeachFunc) search_for_div_or_subdiv,
+				 pointeurs);
+
+	return (GtkTreeIter *) pointeurs[2];
+}
+
+/**
+ * this is a tree model foreach function
+ *
+ * \param model
+ * \param path
+ * \param iter
+ * \param pointers a structure { gpointer div, gpointer sub_div, gpointer }
+ * 		div and sub-div transformed by GINT_TO_POINTER
+ *
+ * \return FALSE not found, TRUE found
+ **/
+gboolean search_for_div_or_subdiv (GtkTreeModel *model,
+									GtkTreePath *path,
+									GtkTreeIter *iter,
+									gpointer *pointers)
+{
+    int no_div, no_sub_div;
+    gchar *text;
+
+    gtk_tree_model_get (GTK_TREE_MODEL(model), iter,
+			 META_TREE_TEXT_COLUMN, &text,
+			 META_TREE_NO_DIV_COLUMN, &no_div,
+			 META_TREE_NO_SUB_DIV_COLUMN, &no_sub_div,
+			 -1);
+
+    /* This is a kludge because we want to skip "dummy" iters that are
+     * here only to provide a slider.*/
+    if (!text)
+	return FALSE;
+
+    if (! pointers[0] && (!pointers[1] || !GPOINTER_TO_INT (pointers[1]))
+	 &&
+	 !no_div && !no_sub_div)
+    {
+	pointers[2] = gtk_tree_iter_copy (iter);
+	return TRUE;
+    }
+
+    if (no_div == GPOINTER_TO_INT (pointers[0]))
+    {
+	if ((!GPOINTER_TO_INT (pointers[1])) ||
+	     (no_sub_div == GPOINTER_TO_INT (pointers[1])))
+	{
+	    pointers[2] = gtk_tree_iter_copy (iter);
+	    return TRUE;
+	}
+    }
+    return FALSE;
+}
+
+/**
+ * return the the iter of a transaction
+ *
+ * \param model
+ * \param transaction_number
+ *
+ * \return a newly allocated GtkTreeIter or NULL
+ **/
+GtkTreeIter *get_iter_from_transaction (GtkTreeModel *model,
+										gint transaction_number)
+{
+	MetatreeIndex *index;
+	GtkTreeIter *iter;
+	gint current_number;
+
+	/* all the rows of transactions are filled by fill_transaction_row,
+	 * so when the index is complete, a missing transaction is not displayed */
+	index = metatree_get_index (model);
+	metatree_index_complete_rows (model, index);
+
+	iter = g_hash_table_lookup (index->transaction_rows, GINT_TO_POINTER (transaction_number));
+	if (!iter)
+		return NULL;
+
+	gtk_tree_model_get (model, iter, META_TREE_NO_TRANSACTION_COLUMN, &current_number, -1);
+	if (current_number != transaction_number)
+		return NULL;
+
+	return gtk_tree_iter_copy (iter);
+}
+
+/**
+ * Update a transaction in a tree model if it is possible to find its
+ * associated GtkTreeIter.  This function is not responsible to remove
+ * old transaction if transaction has changed in a way that would
+ * move it in the tree (i.e, its category has changed and we want to
+ * update the category tree).
+ *
+ * \param iface		A MetatreeInterface to use.
+ * \param model		Tree model to update.
+ * \param transaction_number   Transaction to update if associated GtkTreeIter exists.
+ **/
+void update_transaction_in_tree (MetatreeInterface *iface,
+						GtkTreeModel *model,
+						gint transaction_number)
+{
+	GtkTreeIter *transaction_iter;
+	GtkTreeIter *div_iter;
+	GtkTreeIter *sub_div_iter = NULL;
+	GtkTreePath *transaction_path;
+	GtkTreePath *div_path;
+	GtkTreePath *sub_div_path = NULL;
+	gint div_id;
+	gint sub_div_id;
+	GtkTreeIter child_iter;
+
+	if (!transaction_number || !metatree_model_is_displayed (model))
+		return;
+
+	div_id = iface->transaction_div_id (transaction_number);
+	sub_div_id = iface->transaction_sub_div_id (transaction_number);
+
+	/* Fill in division if existing. */
+	div_iter = get_iter_from_div (model, div_id, 0);
+	if (div_iter)
 	{
 		fill_division_row (model, iface, div_iter, div_id);
 	}
@@ -2183,7 +3065,7 @@ void update_transaction_in_tree (MetatreeInterface *iface,
 			   ! gtk_tree_path_is_ancestor (sub_div_path, transaction_path)) ||
 			 ! gtk_tree_path_is_ancestor (div_path, transaction_path))
 		{
-			gtk_tree_store_remove (GTK_TREE_STORE(model), transaction_iter);
+			metatree_remove_row (model, transaction_iter);
 			transaction_iter = NULL;
 		}
 	}
@@ -2245,7 +3127,7 @@ void metatree_remove_iter_and_select_next (GtkTreeView *tree_view,
 				gtk_tree_path_next (path);
 		}
 
-		gtk_tree_store_remove (GTK_TREE_STORE(model), iter);
+		metatree_remove_row (model, iter);
 		gtk_tree_selection_select_path (selection, path);
 
 		gtk_tree_iter_free (next);
@@ -2544,7 +3426,7 @@ gboolean metatree_sort_column  (GtkTreeModel *model,
 
 /**
  * Fill an empty division row with textual representation of a division
- * structure, in the form: "Name (num transactions) Balance".
+ * structure, in the form: "Name (num transactions)".
  *
  * \param model		The GtkTreeModel that contains iter.
  * \param iface		A pointer to the metatree interface to use
@@ -2555,7 +3437,6 @@ void fill_division_zero (GtkTreeModel *model,
 							MetatreeInterface *iface,
 							GtkTreeIter *iter)
 {
-	gchar *balance = NULL;
 	gchar *string_tmp;
 	GtkTreeIter dumb_iter;
 	gint number_transactions;
@@ -2577,9 +3458,6 @@ void fill_division_zero (GtkTreeModel *model,
 	g_free (string_tmp);
 	string_tmp = label;
 
-	balance = utils_real_get_string_with_currency (iface->div_balance (0),
-							  iface->tree_currency (), TRUE);
-
 	/* add a white child to show the arrow to open it */
 	if (! gtk_tree_model_iter_has_child (model, iter)
 		 &&
@@ -2591,7 +3469,7 @@ void fill_division_zero (GtkTreeModel *model,
 	gtk_tree_store_set (GTK_TREE_STORE(model), iter,
 			META_TREE_TEXT_COLUMN, string_tmp,
 			META_TREE_POINTER_COLUMN, 0,
-			META_TREE_BALANCE_COLUMN, balance,
+			META_TREE_BALANCE_COLUMN, NULL,
 			META_TREE_XALIGN_COLUMN, 1.0,
 			META_TREE_NO_DIV_COLUMN, 0,
 			META_TREE_NO_SUB_DIV_COLUMN, 0,
@@ -2600,14 +3478,12 @@ void fill_division_zero (GtkTreeModel *model,
 			META_TREE_DATE_COLUMN, NULL,
 			-1);
 	g_free (string_tmp);
-	if (balance)
-	g_free (balance);
+	metatree_register_row (model, iter, 0, 0, 0);
 }
 
 /**
  * Fill an empty sub-division row with textual representation of a
- * sub-division structure, in the form: "Name (num transactions)
- * Balance".
+ * sub-division structure, in the form: "Name (num transactions)".
  *
  * \param model		The GtkTreeModel that contains iter.
  * \param iface		A pointer to the metatree interface to use
@@ -2620,7 +3496,6 @@ void fill_sub_division_zero (GtkTreeModel *model,
 						GtkTreeIter *iter,
 						gint division)
 {
-	gchar *balance = NULL;
 	gchar *string_tmp;
 	GtkTreeIter dumb_iter;
 	gint number_transactions = 0;
@@ -2653,15 +3528,12 @@ void fill_sub_division_zero (GtkTreeModel *model,
 
 	if (! gtk_tree_model_iter_has_child (model, iter))
 		gtk_tree_store_append (GTK_TREE_STORE (model), &dumb_iter, iter);
-
-	balance = utils_real_get_string_with_currency (iface->sub_div_balance (division, 0),
-							  iface->tree_currency (), TRUE);
 	}
 
 	gtk_tree_store_set (GTK_TREE_STORE (model), iter,
 			 META_TREE_TEXT_COLUMN, string_tmp,
 			 META_TREE_POINTER_COLUMN, 0,
-			 META_TREE_BALANCE_COLUMN, balance,
+			 META_TREE_BALANCE_COLUMN, NULL,
 			 META_TREE_XALIGN_COLUMN, 1.0,
 			 META_TREE_NO_DIV_COLUMN, division,
 			 META_TREE_NO_SUB_DIV_COLUMN, 0,
@@ -2670,8 +3542,6 @@ void fill_sub_division_zero (GtkTreeModel *model,
 			 META_TREE_DATE_COLUMN, NULL,
 			 -1);
 	g_free (string_tmp);
-	if (balance)
-		g_free (balance);
 }
 
 /**
@@ -2687,8 +3557,13 @@ GtkTreeIter *get_iter_from_sub_div_zero (GtkTreeModel *model,
 {
 	GtkTreeIter dest_iter;
 	GtkTreeIter child_iter;
+	gint division;
 	gint i;
 
+	/* the "no sub-division" row is added when the division is needed */
+	gtk_tree_model_get (model, parent_iter, META_TREE_NO_DIV_COLUMN, &division, -1);
+	metatree_fill_sub_divisions (model, iface, parent_iter, division);
+
 	dest_iter = *parent_iter;
 	for (i = 0; i< gtk_tree_model_iter_n_children (model, &dest_iter); i++)
 	{
@@ -2718,8 +3593,6 @@ void move_transactions_to_division_payee (GtkTreeModel *model,
 						MetatreeInterface *iface,
 						gint orig_div, gint dest_div)
 {
-	GSList *list_tmp_transactions;
-
 	devel_debug_int (dest_div);
 
 	if (!model)
@@ -2728,28 +3601,8 @@ void move_transactions_to_division_payee (GtkTreeModel *model,
 	iface = g_object_get_data (G_OBJECT(model), "metatree-interface");
 
 	/* fill the dest division for payee with the transactions */
-	list_tmp_transactions = gsb_data_transaction_get_complete_transactions_list ();
-
-	while (list_tmp_transactions)
-	{
-		gint transaction_number_tmp;
-		transaction_number_tmp = gsb_data_transaction_get_transaction_number (
-						list_tmp_transactions->data);
-
-		if (transaction_number_tmp &&
-			 iface->transaction_div_id (transaction_number_tmp) == orig_div)
-		{
-			iface->transaction_set_div_id (
-					transaction_number_tmp, dest_div);
-			iface->transaction_set_sub_div_id (
-					transaction_number_tmp, 0);
-			gsb_transactions_list_update_transaction (
-					transaction_number_tmp);
-			iface->add_transaction_to_div (transaction_number_tmp,
-					dest_div);
-		}
-		list_tmp_transactions = list_tmp_transactions->next;
-	}
+	if (metatree_move_div_transactions (iface, orig_div, -1, dest_div, 0, NULL, NULL))
+		metatree_invalidate_division (model, iface, dest_div, 0);
 
 	/* We did some modifications */
 	gsb_file_set_modified (TRUE);
@@ -3303,25 +4156,13 @@ void metatree_reset_transactions_without_div_sub_div (MetatreeInterface *iface,
 						gint new_division,
 						gint new_sub_division)
 {
-	GSList *list_tmp;
-
-	/* move the transactions, need to to that for archived transactions too */
-	list_tmp = gsb_data_transaction_get_complete_transactions_list ();
-
-	while (list_tmp)
-	{
-		gint transaction_number_tmp;
-
-		transaction_number_tmp =
-				gsb_data_transaction_get_transaction_number (list_tmp->data);
+	/* move the transactions of all the sub-divisions, archived transactions too */
+	if (metatree_move_div_transactions (iface, no_division, -1,
+										new_division, new_sub_division, NULL, NULL))
+		metatree_invalidate_division (model, iface, new_division, new_sub_division);
 
-		if (iface->transaction_div_id (transaction_number_tmp) == no_division)
-			move_transaction_to_sub_division (transaction_number_tmp, model,
-								NULL, NULL,
-								new_division, new_sub_division);
-
-		list_tmp = list_tmp->next;
-	}
+	/* We did some modifications */
+	gsb_file_set_modified (TRUE);
 }
 
 /**
@@ -3524,30 +4365,10 @@ void metatree_move_transactions_to_sub_div (MetatreeInterface *iface,
 						gint new_division,
 						gint new_sub_division)
 {
-	GSList *list_tmp;
-
 	/* move the transactions, need to to that for archived transactions too */
-	list_tmp = gsb_data_transaction_get_complete_transactions_list ();
-
-	while (list_tmp)
-	{
-		gint transaction_number_tmp;
-
-		transaction_number_tmp =
-				gsb_data_transaction_get_transaction_number (list_tmp->data);
-
-		if (iface->transaction_div_id (transaction_number_tmp) == no_division
-		 &&
-		 iface->transaction_sub_div_id (transaction_number_tmp) == no_sub_division)
-		{
-			/* Change parameters of the transaction */
-			iface->transaction_set_div_id (transaction_number_tmp, new_division);
-			iface->transaction_set_sub_div_id (transaction_number_tmp, new_sub_division);
-			gsb_transactions_list_update_transaction (transaction_number_tmp);
-		}
-
-		list_tmp = list_tmp->next;
-	}
+	if (metatree_move_div_transactions (iface, no_division, no_sub_division,
+										new_division, new_sub_division, NULL, NULL))
+		metatree_invalidate_division (model, iface, new_division, new_sub_division);
 }
 
 /**
@@ -3562,7 +4383,6 @@ gint metatree_move_sub_division_to_division (MetatreeInterface *iface,
 						gint no_sub_division,
 						gint new_division)
 {
-	GSList *list_tmp;
 	gint new_sub_division = 0;
 
 	/* create the new_sub_division */
@@ -3577,27 +4397,8 @@ gint metatree_move_sub_division_to_division (MetatreeInterface *iface,
 	iface->remove_sub_div (no_division, no_sub_division);
 
 	/* move the transactions, need to to that for archived transactions too */
-	list_tmp = gsb_data_transaction_get_complete_transactions_list ();
-
-	while (list_tmp)
-	{
-		gint transaction_number_tmp;
-
-		transaction_number_tmp =
-				gsb_data_transaction_get_transaction_number (list_tmp->data);
-
-		if (iface->transaction_div_id (transaction_number_tmp) == no_division
-		 &&
-		 iface->transaction_sub_div_id (transaction_number_tmp) == no_sub_division)
-		{
-			/* Change parameters of the transaction */
-			iface->transaction_set_div_id (transaction_number_tmp, new_division);
-			iface->transaction_set_sub_div_id (transaction_number_tmp, new_sub_division);
-			gsb_transactions_list_update_transaction (transaction_number_tmp);
-		}
-
-		list_tmp = list_tmp->next;
-	}
+	metatree_move_div_transactions (iface, no_division, no_sub_division,
+									new_division, new_sub_division, NULL, NULL);
 
 	return new_sub_division;
 }
@@ -3613,7 +4414,6 @@ gint metatree_create_division_from_sub_division (MetatreeInterface *iface,
 						gint no_division,
 						gint no_sub_division)
 {
-	GSList *list_tmp;
 	gint new_division = 0;
 
 	/* create the new_sub_division */
@@ -3628,27 +4428,8 @@ gint metatree_create_division_from_sub_division (MetatreeInterface *iface,
 	iface->remove_sub_div (no_division, no_sub_division);
 
 	/* move the transactions, need to to that for archived transactions too */
-	list_tmp = gsb_data_transaction_get_complete_transactions_list ();
-
-	while (list_tmp)
-	{
-		gint transaction_number_tmp;
-
-		transaction_number_tmp =
-				gsb_data_transaction_get_transaction_number (list_tmp->data);
-
-		if (iface->transaction_div_id (transaction_number_tmp) == no_division
-		 &&
-		 iface->transaction_sub_div_id (transaction_number_tmp) == no_sub_division)
-		{
-			/* Change parameters of the transaction */
-			iface->transaction_set_div_id (transaction_number_tmp, new_division);
-			iface->transaction_set_sub_div_id (transaction_number_tmp, 0);
-			gsb_transactions_list_update_transaction (transaction_number_tmp);
-		}
-
-		list_tmp = list_tmp->next;
-	}
+	metatree_move_div_transactions (iface, no_division, no_sub_division,
+									new_division, 0, NULL, NULL);
 
 	return new_division;
 }
@@ -3927,10 +4708,8 @@ void metatree_transfer_identical_transactions (GtkWidget *tree_view)
 	GtkTreeIter parent;
 	GtkTreeIter *it;
 	GtkTreePath *path = NULL;
-	GSList *list_tmp;
+	MetatreeIdenticalSearch search = {NULL, NULL};
 	gchar *tmp_str = NULL;
-	gchar *search_str_1 = NULL;
-	gchar *search_str_2 = NULL;
 	gint no_division = 0;
 	gint no_sub_division = 0;
 	gint no_transaction = 0;
@@ -3970,15 +4749,12 @@ void metatree_transfer_identical_transactions (GtkWidget *tree_view)
 						&new_division, &new_sub_division))
 		return;
 
-	/* move the transactions, need to to that for archived transactions too */
-	list_tmp = gsb_data_transaction_get_complete_transactions_list ();
-
 	if (metatree_find_payee)
 	{
 		tmp_str = g_strdup (gsb_data_payee_get_name (
 						gsb_data_transaction_get_payee_number (no_transaction), TRUE));
 		if (tmp_str)
-			search_str_1 = g_utf8_collate_key (tmp_str, -1);
+			search.payee_key = g_utf8_collate_key (tmp_str, -1);
 		g_free (tmp_str);
 	}
 
@@ -3986,73 +4762,23 @@ void metatree_transfer_identical_transactions (GtkWidget *tree_view)
 	{
 		tmp_str = g_strdup (gsb_data_transaction_get_notes (no_transaction));
 		if (tmp_str)
-			search_str_2 = g_utf8_collate_key (tmp_str, -1);
+			search.notes_key = g_utf8_collate_key (tmp_str, -1);
 		g_free (tmp_str);
 	}
 
-	while (list_tmp)
+	/* move the transactions in one pass, need to to that for archived transactions too */
+	if ((search.payee_key || search.notes_key)
+		&& metatree_move_div_transactions (iface, no_division, no_sub_division,
+										   new_division, new_sub_division,
+										   (MetatreeTransactionFilter) metatree_transaction_is_identical,
+										   &search))
 	{
-		gint transaction_number_tmp;
-		TransactionStruct *transaction;
-
-		transaction = list_tmp->data;
-		transaction_number_tmp = transaction->transaction_number;
-
-		if (iface->transaction_div_id (transaction_number_tmp) == no_division
-		 &&
-		 iface->transaction_sub_div_id (transaction_number_tmp) == no_sub_division)
-		{
-			gboolean trouve = FALSE;
-
-			if (search_str_1)
-			{
-				gchar *tmp_key = NULL;
-
-				tmp_str = g_strdup (gsb_data_payee_get_name (transaction->payee_number, TRUE));
-
-				if (tmp_str)
-					tmp_key = g_utf8_collate_key (tmp_str, -1);
-
-				if (tmp_key)
-					trouve = !strcmp (tmp_key, search_str_1);
-				else
-					trouve = FALSE;
-
-				g_free (tmp_key);
-				g_free (tmp_str);
-			}
-			if (search_str_2)
-			{
-				gchar *tmp_key = NULL;
-
-				tmp_str = g_strdup (transaction->notes);
-
-				if (tmp_str)
-					tmp_key = g_utf8_collate_key (tmp_str, -1);
-
-				if (tmp_key)
-					trouve = !strcmp (tmp_key, search_str_2);
-				else
-					trouve = FALSE;
-
-				g_free (tmp_key);
-				g_free (tmp_str);
-			}
-
-			if (trouve)
-			{
-				/* Change parameters of the transaction */
-				iface->transaction_set_div_id (transaction_number_tmp, new_division);
-				iface->transaction_set_sub_div_id (transaction_number_tmp, new_sub_division);
-				gsb_transactions_list_update_transaction (transaction_number_tmp);
-			}
-		}
-
-		list_tmp = list_tmp->next;
+		metatree_invalidate_division (model, iface, no_division, no_sub_division);
+		metatree_invalidate_division (model, iface, new_division, new_sub_division);
 	}
 
-	g_free (search_str_1);
-	g_free (search_str_2);
+	g_free (search.payee_key);
+	g_free (search.notes_key);
 
 	/* met à jour le tree_view */
 	metatree_update_tree_view (iface);
@@ -135,6 +135,11 @@ void					fill_sub_division_row 							(GtkTreeModel *model,
 GtkTreeIter *			get_iter_from_div								(GtkTreeModel *model,
 																		 int div,
 																		 int sub_div);
+void					metatree_balance_cell_data_func					(GtkTreeViewColumn *tree_column,
+																		 GtkCellRenderer *cell,
+																		 GtkTreeModel *model,
+																		 GtkTreeIter *iter,
+																		 gpointer data);
 void					metatree_division_column_expanded				(GtkTreeView *treeview,
 																		 GtkTreeIter *iter,
                         												 GtkTreePath *tree_path,
@@ -74,6 +74,8 @@ struct _PrefsPageArchivesPrivate
 	GtkWidget *			checkbutton_archives_check_auto;
     GtkWidget *         spinbutton_archives_check_auto;
 
+	GtkWidget *			checkbutton_archives_cold_storage;
+
 };
 
 G_DEFINE_TYPE_WITH_PRIVATE (PrefsPageArchives, prefs_page_archives, GTK_TYPE_BOX)
@@ -637,6 +639,16 @@ static void prefs_page_archives_setup_page (PrefsPageArchives *page)
 					  "value-changed",
 					  G_CALLBACK (utils_prefs_spinbutton_changed),
 					  &a_conf->max_non_archived_transactions_for_check);
+
+	/* set the checkbutton for the archives kept out of memory */
+    gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (priv->checkbutton_archives_cold_storage),
+								  a_conf->archives_cold_storage);
+
+	/* Connect signal */
+    g_signal_connect (priv->checkbutton_archives_cold_storage,
+					  "toggled",
+					  G_CALLBACK (utils_prefs_page_checkbutton_changed),
+					  &a_conf->archives_cold_storage);
 }
 
 /******************************************************************************/
@@ -673,6 +685,8 @@ static void prefs_page_archives_class_init (PrefsPageArchivesClass *klass)
 
 	gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), PrefsPageArchives, checkbutton_archives_check_auto);
 	gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), PrefsPageArchives, spinbutton_archives_check_auto);
+
+	gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), PrefsPageArchives, checkbutton_archives_cold_storage);
 }
 
 /******************************************************************************/
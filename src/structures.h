@@ -251,6 +251,7 @@ struct _GrisbiAppConf
 /* archive stuff */
     gboolean    archives_check_auto;                  		/* TRUE if we want to check the number of non archived transactions at the opening */
     gint        max_non_archived_transactions_for_check;    /* the max number of transaction before grisbi warm at the opening */
+    gboolean    archives_cold_storage;                      /* TRUE to keep the archived transactions in a file loaded when needed */
 
 /* form part*/
     gboolean    affichage_exercice_automatique;             /* automatic fyear :FALSE = according to the date, TRUE = according to value date */
@@ -464,7 +465,8 @@ enum BetTypeMaj
     BET_MAJ_ESTIMATE,
     BET_MAJ_HISTORICAL,
     BET_MAJ_FINANCIAL,
-    BET_MAJ_ALL
+    BET_MAJ_ALL,
+    BET_MAJ_SOURCES						/* seules les sources notées par bet_array_mark_source_changed */
 };
 
 
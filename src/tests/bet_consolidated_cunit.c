@@ -0,0 +1,198 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                  bet_consolidated_cunit                    */
+/*                                                                            */
+/*          https://www.grisbi.org/                                           */
+/*                                                                            */
+/*  This program is free software; you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation; either version 2 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This program is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program; if not, see <https://www.gnu.org/licenses/>.     */
+/*                                                                            */
+/* ************************************************************************** */
+
+/**
+ * \file bet_consolidated_cunit.c
+ * cunit tests for the consolidated forecast of a group of accounts
+ */
+
+#include "config.h"
+
+#include "include.h"
+
+/* START_INCLUDE */
+#include "bet_consolidated_cunit.h"
+#include "bet_consolidated.h"
+#include "gsb_data_account.h"
+#include "gsb_data_currency.h"
+#include "gsb_data_scheduled.h"
+#include "gsb_data_transaction.h"
+#include "gsb_real.h"
+#include "structures.h"
+/* END_INCLUDE */
+
+/* START_STATIC */
+static void bet_consolidated_cunit__bet_consolidated_new ( void );
+static gint bet_consolidated_cunit_new_transaction ( gint account_number,
+                        gint currency_number,
+                        gint64 mantissa,
+                        GDate *date,
+                        GDate *value_date );
+static int bet_consolidated_cunit_clean_suite ( void );
+static int bet_consolidated_cunit_init_suite ( void );
+/* END_STATIC */
+
+/* START_EXTERN */
+/* END_EXTERN */
+
+
+/* The suite initialization function.
+ * Returns zero on success, non-zero otherwise.
+ */
+int bet_consolidated_cunit_init_suite ( void )
+{
+    /* the accounts, transactions and scheduled transactions of the other suites */
+    gsb_data_transaction_init_variables ();
+    gsb_data_scheduled_init_variables ();
+    gsb_data_account_init_variables ();
+
+    return 0;
+}
+
+/* The suite cleanup function.
+ * Returns zero on success, non-zero otherwise.
+ */
+int bet_consolidated_cunit_clean_suite ( void )
+{
+    gsb_data_transaction_init_variables ();
+    gsb_data_account_init_variables ();
+
+    return 0;
+}
+
+/**
+ * create a transaction with an amount with 2 decimals
+ *
+ * \param account_number
+ * \param currency_number
+ * \param mantissa
+ * \param date
+ * \param value_date     NULL if none
+ *
+ * \return the number of the transaction
+ **/
+gint bet_consolidated_cunit_new_transaction ( gint account_number,
+                        gint currency_number,
+                        gint64 mantissa,
+                        GDate *date,
+                        GDate *value_date )
+{
+    GsbReal amount = { mantissa, 2 };
+    gint transaction_number;
+
+    transaction_number = gsb_data_transaction_new_transaction ( account_number );
+    gsb_data_transaction_set_currency_number ( transaction_number, currency_number );
+    gsb_data_transaction_set_amount ( transaction_number, amount );
+    gsb_data_transaction_set_date ( transaction_number, date );
+    if ( value_date )
+        gsb_data_transaction_set_value_date ( transaction_number, value_date );
+
+    return transaction_number;
+}
+
+void bet_consolidated_cunit__bet_consolidated_new ( void )
+{
+    BetConsolidated *consolidated;
+    GsbReal init_balance = { 10000, 2 };
+    GDate *date_min;
+    GDate *date_max;
+    GDate *date;
+    GDate *value_date;
+    gint accounts[2];
+    gint currency_number;
+    gint moved_number;
+    gint later_number;
+    guint32 lowest_day;
+
+    currency_number = gsb_data_currency_new ( "EUR" );
+    gsb_data_currency_set_floating_point ( currency_number, 2 );
+
+    accounts[0] = gsb_data_account_new ( GSB_TYPE_BANK );
+    accounts[1] = gsb_data_account_new ( GSB_TYPE_CASH );
+    gsb_data_account_set_currency ( accounts[0], currency_number );
+    gsb_data_account_set_currency ( accounts[1], currency_number );
+    gsb_data_account_set_init_balance ( accounts[0], init_balance );
+
+    date_min = g_date_new_dmy ( 1, 3, 2024 );
+    date_max = g_date_new_dmy ( 31, 3, 2024 );
+
+    /* before the period : in the initial balance */
+    date = g_date_new_dmy ( 15, 2, 2024 );
+    bet_consolidated_cunit_new_transaction ( accounts[0], currency_number, 5000, date, NULL );
+
+    /* dated before the period but with a value date in the period : an event */
+    g_date_set_dmy ( date, 28, 2, 2024 );
+    value_date = g_date_new_dmy ( 2, 3, 2024 );
+    moved_number = bet_consolidated_cunit_new_transaction ( accounts[0], currency_number, -2000, date, value_date );
+
+    /* in the period, in the other account */
+    g_date_set_dmy ( date, 10, 3, 2024 );
+    later_number = bet_consolidated_cunit_new_transaction ( accounts[1], currency_number, -20000, date, NULL );
+
+    /* after the period : ignored */
+    g_date_set_dmy ( date, 10, 4, 2024 );
+    bet_consolidated_cunit_new_transaction ( accounts[1], currency_number, 100000, date, NULL );
+
+    consolidated = bet_consolidated_new ( accounts, 2, currency_number, date_min, date_max );
+    CU_ASSERT_PTR_NOT_NULL_FATAL ( consolidated );
+
+    /* 100.00 + 50.00 */
+    CU_ASSERT_EQUAL ( 0, gsb_real_cmp ( consolidated -> forecast -> initial_balance,
+                        gsb_real_new ( 15000, 2 ) ) );
+
+    /* the two events in the order of their dates, with their account */
+    CU_ASSERT_EQUAL_FATAL ( 2, bet_forecast_get_nb_events ( consolidated -> forecast ) );
+    CU_ASSERT_EQUAL ( moved_number, bet_forecast_get_event ( consolidated -> forecast, 0 ) -> number );
+    CU_ASSERT_EQUAL ( g_date_get_julian ( value_date ),
+                        bet_forecast_get_event ( consolidated -> forecast, 0 ) -> julian_day );
+    CU_ASSERT_EQUAL ( accounts[0], g_array_index ( consolidated -> accounts, gint, 0 ) );
+    CU_ASSERT_EQUAL ( later_number, bet_forecast_get_event ( consolidated -> forecast, 1 ) -> number );
+    CU_ASSERT_EQUAL ( accounts[1], g_array_index ( consolidated -> accounts, gint, 1 ) );
+
+    /* 150.00 - 20.00 - 200.00 */
+    CU_ASSERT_EQUAL ( 0, gsb_real_cmp ( bet_consolidated_get_final_balance ( consolidated ),
+                        gsb_real_new ( -7000, 2 ) ) );
+    CU_ASSERT_EQUAL ( 0, gsb_real_cmp ( bet_consolidated_get_minimum_balance ( consolidated, &lowest_day ),
+                        gsb_real_new ( -7000, 2 ) ) );
+    g_date_set_dmy ( date, 10, 3, 2024 );
+    CU_ASSERT_EQUAL ( g_date_get_julian ( date ), lowest_day );
+
+    bet_consolidated_free ( consolidated );
+    g_date_free ( date );
+    g_date_free ( value_date );
+    g_date_free ( date_min );
+    g_date_free ( date_max );
+    gsb_data_currency_remove ( currency_number );
+}
+
+CU_pSuite bet_consolidated_cunit_create_suite ( void )
+{
+    CU_pSuite pSuite = CU_add_suite ( "bet_consolidated",
+                        bet_consolidated_cunit_init_suite,
+                        bet_consolidated_cunit_clean_suite );
+    if ( NULL == pSuite )
+        return NULL;
+
+    if ( NULL == CU_add_test ( pSuite, "of bet_consolidated_new()", bet_consolidated_cunit__bet_consolidated_new ) )
+        return NULL;
+
+    return pSuite;
+}
@@ -0,0 +1,191 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                  bet_data_finance_cunit                    */
+/*                                                                            */
+/*          https://www.grisbi.org/                                           */
+/*                                                                            */
+/*  This program is free software; you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation; either version 2 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This program is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program; if not, see <https://www.gnu.org/licenses/>.     */
+/*                                                                            */
+/* ************************************************************************** */
+
+/**
+ * \file bet_data_finance_cunit.c
+ * cunit tests for the amortization schedules of the credit simulator
+ */
+
+#include "config.h"
+
+#include "include.h"
+
+/* START_INCLUDE */
+#include "bet_data_finance_cunit.h"
+#include "bet_data_finance.h"
+/* END_INCLUDE */
+
+/* START_STATIC */
+static void bet_data_finance_cunit__bet_data_finance_schedule_get ( void );
+static void bet_data_finance_cunit__bet_data_finance_schedule_get__exponent ( void );
+static void bet_data_finance_cunit__bet_data_finance_schedule_get__null_rate ( void );
+static void bet_data_finance_cunit__bet_data_finance_schedule_unref ( void );
+static int bet_data_finance_cunit_clean_suite ( void );
+static int bet_data_finance_cunit_init_suite ( void );
+/* END_STATIC */
+
+/* START_EXTERN */
+/* END_EXTERN */
+
+
+/* The suite initialization function.
+ * Returns zero on success, non-zero otherwise.
+ */
+int bet_data_finance_cunit_init_suite ( void )
+{
+    bet_data_finance_schedule_cache_clear ( );
+
+    return 0;
+}
+
+/* The suite cleanup function.
+ * Returns zero on success, non-zero otherwise.
+ */
+int bet_data_finance_cunit_clean_suite ( void )
+{
+    bet_data_finance_schedule_cache_clear ( );
+
+    return 0;
+}
+
+void bet_data_finance_cunit__bet_data_finance_schedule_get ( void )
+{
+    BetFinanceSchedule *schedule;
+    gint64 principal = 0;
+    gint i;
+
+    /* 10000.00 at 1 % a month in 12 installments */
+    schedule = bet_data_finance_schedule_get ( 10000.0, 0.01, 0.0, 12, 2 );
+    CU_ASSERT_PTR_NOT_NULL_FATAL ( schedule );
+    CU_ASSERT_EQUAL ( 2, schedule -> exponent );
+    CU_ASSERT_EQUAL ( 1000000, schedule -> capital );
+    CU_ASSERT_EQUAL ( 88849, schedule -> echeance );
+    CU_ASSERT_EQUAL ( 88847, schedule -> last_echeance );
+    CU_ASSERT_EQUAL ( 66186, schedule -> total_cost );
+
+    /* first installment : 100.00 of interests */
+    CU_ASSERT_EQUAL ( 10000, schedule -> interets[0] );
+    CU_ASSERT_EQUAL ( 78849, schedule -> principal[0] );
+    CU_ASSERT_EQUAL ( 1000000 - 78849, schedule -> capital_du[1] );
+
+    /* the whole capital is paid back */
+    for ( i = 0; i < schedule -> nbre_echeances; i++ )
+        principal += schedule -> principal[i];
+    CU_ASSERT_EQUAL ( schedule -> capital, principal );
+    bet_data_finance_schedule_unref ( schedule );
+
+    /* the fees are in the last installment and in the total cost */
+    schedule = bet_data_finance_schedule_get ( 10000.0, 0.01, 1.5, 12, 2 );
+    CU_ASSERT_PTR_NOT_NULL_FATAL ( schedule );
+    CU_ASSERT_EQUAL ( 150, schedule -> frais );
+    CU_ASSERT_EQUAL ( 88849, schedule -> echeance );
+    CU_ASSERT_EQUAL ( 88997, schedule -> last_echeance );
+    CU_ASSERT_EQUAL ( 67986, schedule -> total_cost );
+    bet_data_finance_schedule_unref ( schedule );
+
+    /* no schedule without installment */
+    CU_ASSERT_PTR_NULL ( bet_data_finance_schedule_get ( 10000.0, 0.01, 0.0, 0, 2 ) );
+}
+
+void bet_data_finance_cunit__bet_data_finance_schedule_get__null_rate ( void )
+{
+    BetFinanceSchedule *schedule;
+
+    /* 1000.00 in 3 installments without interest */
+    schedule = bet_data_finance_schedule_get ( 1000.0, 0.0, 0.0, 3, 2 );
+    CU_ASSERT_PTR_NOT_NULL_FATAL ( schedule );
+    CU_ASSERT_EQUAL ( 33333, schedule -> echeance );
+    CU_ASSERT_EQUAL ( 33334, schedule -> last_echeance );
+    CU_ASSERT_EQUAL ( 0, schedule -> total_cost );
+    CU_ASSERT_EQUAL ( 0, schedule -> interets[2] );
+    bet_data_finance_schedule_unref ( schedule );
+
+    /* 1.00 in 8 installments : 12.5 cents, the half goes away from zero */
+    schedule = bet_data_finance_schedule_get ( 1.0, 0.0, 0.0, 8, 2 );
+    CU_ASSERT_PTR_NOT_NULL_FATAL ( schedule );
+    CU_ASSERT_EQUAL ( 13, schedule -> echeance );
+    CU_ASSERT_EQUAL ( 9, schedule -> last_echeance );
+    bet_data_finance_schedule_unref ( schedule );
+}
+
+void bet_data_finance_cunit__bet_data_finance_schedule_get__exponent ( void )
+{
+    BetFinanceSchedule *schedule;
+
+    /* a currency without decimals */
+    schedule = bet_data_finance_schedule_get ( 100000.0, 0.01, 0.0, 12, 0 );
+    CU_ASSERT_PTR_NOT_NULL_FATAL ( schedule );
+    CU_ASSERT_EQUAL ( 0, schedule -> exponent );
+    CU_ASSERT_EQUAL ( 100000, schedule -> capital );
+    CU_ASSERT_EQUAL ( 8885, schedule -> echeance );
+    CU_ASSERT_EQUAL ( 8884, schedule -> last_echeance );
+    CU_ASSERT_EQUAL ( 6619, schedule -> total_cost );
+    bet_data_finance_schedule_unref ( schedule );
+
+    /* and a currency with three decimals */
+    schedule = bet_data_finance_schedule_get ( 1000.0, 0.0, 0.0, 3, 3 );
+    CU_ASSERT_PTR_NOT_NULL_FATAL ( schedule );
+    CU_ASSERT_EQUAL ( 333333, schedule -> echeance );
+    CU_ASSERT_EQUAL ( 333334, schedule -> last_echeance );
+    bet_data_finance_schedule_unref ( schedule );
+}
+
+void bet_data_finance_cunit__bet_data_finance_schedule_unref ( void )
+{
+    BetFinanceSchedule *schedule;
+    BetFinanceSchedule *same_schedule;
+    gint i;
+
+    /* the same parameters give the same schedule */
+    schedule = bet_data_finance_schedule_get ( 5000.0, 0.005, 0.0, 24, 2 );
+    CU_ASSERT_PTR_NOT_NULL_FATAL ( schedule );
+    same_schedule = bet_data_finance_schedule_get ( 5000.0, 0.005, 0.0, 24, 2 );
+    CU_ASSERT_PTR_EQUAL ( schedule, same_schedule );
+    bet_data_finance_schedule_unref ( same_schedule );
+
+    /* the cache is emptied several times, the schedule stays valid */
+    for ( i = 1; i <= 200; i++ )
+        bet_data_finance_schedule_unref ( bet_data_finance_schedule_get ( 5000.0, 0.005, 0.0, i + 24, 2 ) );
+    bet_data_finance_schedule_cache_clear ( );
+
+    CU_ASSERT_EQUAL ( 500000, schedule -> capital );
+    CU_ASSERT_EQUAL ( 24, schedule -> nbre_echeances );
+    CU_ASSERT_EQUAL ( 500000, schedule -> capital_du[0] );
+    bet_data_finance_schedule_unref ( schedule );
+}
+
+CU_pSuite bet_data_finance_cunit_create_suite ( void )
+{
+    CU_pSuite pSuite = CU_add_suite ( "bet_data_finance",
+                        bet_data_finance_cunit_init_suite,
+                        bet_data_finance_cunit_clean_suite );
+    if ( NULL == pSuite )
+        return NULL;
+
+    if ( ( NULL == CU_add_test ( pSuite, "of bet_data_finance_schedule_get()", bet_data_finance_cunit__bet_data_finance_schedule_get ) )
+     || ( NULL == CU_add_test ( pSuite, "of bet_data_finance_schedule_get() without interest", bet_data_finance_cunit__bet_data_finance_schedule_get__null_rate ) )
+     || ( NULL == CU_add_test ( pSuite, "of bet_data_finance_schedule_get() with other exponents", bet_data_finance_cunit__bet_data_finance_schedule_get__exponent ) )
+     || ( NULL == CU_add_test ( pSuite, "of bet_data_finance_schedule_unref()", bet_data_finance_cunit__bet_data_finance_schedule_unref ) )
+       )
+        return NULL;
+
+    return pSuite;
+}
@@ -0,0 +1,347 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                  bet_forecast_cunit                        */
+/*                                                                            */
+/*          https://www.grisbi.org/                                           */
+/*                                                                            */
+/*  This program is free software; you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation; either version 2 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This program is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program; if not, see <https://www.gnu.org/licenses/>.     */
+/*                                                                            */
+/* ************************************************************************** */
+
+/**
+ * \file bet_forecast_cunit.c
+ * cunit tests for the computation of the balances of the array of forecast
+ */
+
+#include "config.h"
+
+#include "include.h"
+
+/* START_INCLUDE */
+#include "bet_forecast_cunit.h"
+#include "bet_forecast.h"
+#include "gsb_real.h"
+#include "structures.h"
+#ifdef HAVE_GOFFICE
+#include "bet_graph.h"
+#endif /* HAVE_GOFFICE */
+/* END_INCLUDE */
+
+/* START_STATIC */
+static void bet_forecast_cunit__bet_forecast_compute_balances ( void );
+static void bet_forecast_cunit__bet_forecast_get_balance_series ( void );
+static void bet_forecast_cunit__bet_forecast_get_balance_series__max_points ( void );
+static void bet_forecast_cunit__bet_forecast_remove_event ( void );
+static void bet_forecast_cunit__bet_forecast_sort ( void );
+static BetForecastEvent *bet_forecast_cunit_append ( BetForecast *forecast,
+                        guint32 julian_day,
+                        gint origin,
+                        gint64 mantissa,
+                        guint key );
+static gboolean bet_forecast_cunit_check_balances ( BetForecast *forecast,
+                        const gint64 *balances );
+static int bet_forecast_cunit_clean_suite ( void );
+static int bet_forecast_cunit_init_suite ( void );
+/* END_STATIC */
+
+/* START_EXTERN */
+/* END_EXTERN */
+
+
+/* The suite initialization function.
+ * Returns zero on success, non-zero otherwise.
+ */
+int bet_forecast_cunit_init_suite ( void )
+{
+    return 0;
+}
+
+/* The suite cleanup function.
+ * Returns zero on success, non-zero otherwise.
+ */
+int bet_forecast_cunit_clean_suite ( void )
+{
+    return 0;
+}
+
+/**
+ * append an event with an amount with 2 decimals
+ *
+ * \param forecast
+ * \param julian_day
+ * \param origin
+ * \param mantissa
+ * \param key
+ *
+ * \return the new event
+ **/
+BetForecastEvent *bet_forecast_cunit_append ( BetForecast *forecast,
+                        guint32 julian_day,
+                        gint origin,
+                        gint64 mantissa,
+                        guint key )
+{
+    BetForecastEvent *event;
+
+    event = bet_forecast_append_event ( forecast, julian_day, origin, key, gsb_real_new ( mantissa, 2 ), FALSE );
+    event -> key = key;
+
+    return event;
+}
+
+/**
+ * check the balances of the events, with 2 decimals
+ *
+ * \param forecast
+ * \param balances      one balance for each event
+ *
+ * \return TRUE if all the balances are the expected ones
+ **/
+gboolean bet_forecast_cunit_check_balances ( BetForecast *forecast,
+                        const gint64 *balances )
+{
+    guint i;
+
+    for ( i = 0; i < bet_forecast_get_nb_events ( forecast ); i++ )
+    {
+        if ( gsb_real_cmp ( bet_forecast_get_event ( forecast, i ) -> balance,
+                        gsb_real_new ( balances[i], 2 ) ) != 0 )
+            return FALSE;
+    }
+
+    return TRUE;
+}
+
+void bet_forecast_cunit__bet_forecast_sort ( void )
+{
+    BetForecast *forecast;
+    guint32 day = 738000;
+    guint index;
+
+    forecast = bet_forecast_new ( gsb_real_new ( 10000, 2 ), SPP_ORIGIN_SOLDE, 0 );
+
+    bet_forecast_cunit_append ( forecast, day, SPP_ORIGIN_TRANSACTION, -1000, 1 );
+    bet_forecast_cunit_append ( forecast, day, SPP_ORIGIN_SCHEDULED, 5000, 2 );
+    bet_forecast_cunit_append ( forecast, day, SPP_ORIGIN_SOLDE, 0, 3 );
+    bet_forecast_cunit_append ( forecast, day, SPP_ORIGIN_TRANSACTION, 2000, 4 );
+    bet_forecast_cunit_append ( forecast, day, SPP_ORIGIN_TRANSACTION, 2000, 5 );
+    bet_forecast_cunit_append ( forecast, day - 1, SPP_ORIGIN_SCHEDULED, -500, 6 );
+    bet_forecast_sort ( forecast );
+
+    /* by date, the balance line first, then by origin, the biggest amount
+     * first and the equal events in the order of their key */
+    CU_ASSERT_EQUAL_FATAL ( 6, bet_forecast_get_nb_events ( forecast ) );
+    CU_ASSERT_EQUAL ( 6, bet_forecast_get_event ( forecast, 0 ) -> key );
+    CU_ASSERT_EQUAL ( 3, bet_forecast_get_event ( forecast, 1 ) -> key );
+    CU_ASSERT_EQUAL ( 4, bet_forecast_get_event ( forecast, 2 ) -> key );
+    CU_ASSERT_EQUAL ( 5, bet_forecast_get_event ( forecast, 3 ) -> key );
+    CU_ASSERT_EQUAL ( 1, bet_forecast_get_event ( forecast, 4 ) -> key );
+    CU_ASSERT_EQUAL ( 2, bet_forecast_get_event ( forecast, 5 ) -> key );
+
+    /* a new equal event goes after the others */
+    index = bet_forecast_insert_event ( forecast, day, SPP_ORIGIN_TRANSACTION, 7,
+                        gsb_real_new ( 2000, 2 ), FALSE );
+    CU_ASSERT_EQUAL ( 4, index );
+
+    /* and a new balance line before the events of its day */
+    index = bet_forecast_insert_event ( forecast, day + 1, SPP_ORIGIN_SOLDE, 0, null_real, FALSE );
+    CU_ASSERT_EQUAL ( 7, index );
+    index = bet_forecast_insert_event ( forecast, day + 1, SPP_ORIGIN_TRANSACTION, 8,
+                        gsb_real_new ( -100, 2 ), FALSE );
+    CU_ASSERT_EQUAL ( 8, index );
+
+    bet_forecast_free ( forecast );
+}
+
+void bet_forecast_cunit__bet_forecast_compute_balances ( void )
+{
+    BetForecast *forecast;
+    BetForecastEvent *event;
+    const gint64 all_balances[] = { 15000, 12000, 10000 };
+    const gint64 without_second[] = { 15000, 15000, 13000 };
+    const gint64 without_first[] = { 10000, 7000, 5000 };
+
+    forecast = bet_forecast_new ( gsb_real_new ( 10000, 2 ), SPP_ORIGIN_SOLDE, 0 );
+    bet_forecast_cunit_append ( forecast, 738001, SPP_ORIGIN_TRANSACTION, 5000, 1 );
+    event = bet_forecast_cunit_append ( forecast, 738002, SPP_ORIGIN_TRANSACTION, -3000, 2 );
+    event -> selected = TRUE;
+    bet_forecast_cunit_append ( forecast, 738003, SPP_ORIGIN_TRANSACTION, -2000, 3 );
+
+    /* a selected event is left out of the balance */
+    bet_forecast_compute_balances ( forecast, 0 );
+    CU_ASSERT ( bet_forecast_cunit_check_balances ( forecast, without_second ) );
+
+    bet_forecast_set_selected ( forecast, 1, FALSE );
+    CU_ASSERT ( bet_forecast_cunit_check_balances ( forecast, all_balances ) );
+
+    bet_forecast_set_selected ( forecast, 0, TRUE );
+    CU_ASSERT ( bet_forecast_cunit_check_balances ( forecast, without_first ) );
+
+    /* the same from the start */
+    bet_forecast_compute_balances ( forecast, 0 );
+    CU_ASSERT ( bet_forecast_cunit_check_balances ( forecast, without_first ) );
+
+    bet_forecast_free ( forecast );
+}
+
+void bet_forecast_cunit__bet_forecast_remove_event ( void )
+{
+    BetForecast *forecast;
+    const gint64 all_balances[] = { 15000, 12000, 10000 };
+    const gint64 without_second[] = { 15000, 13000 };
+    guint index;
+
+    forecast = bet_forecast_new ( gsb_real_new ( 10000, 2 ), SPP_ORIGIN_SOLDE, 0 );
+    bet_forecast_cunit_append ( forecast, 738001, SPP_ORIGIN_TRANSACTION, 5000, 1 );
+    bet_forecast_cunit_append ( forecast, 738002, SPP_ORIGIN_SCHEDULED, -3000, 2 );
+    bet_forecast_cunit_append ( forecast, 738003, SPP_ORIGIN_TRANSACTION, -2000, 3 );
+    bet_forecast_sort ( forecast );
+    bet_forecast_compute_balances ( forecast, 0 );
+    CU_ASSERT ( bet_forecast_cunit_check_balances ( forecast, all_balances ) );
+
+    /* the balances before the removed event stay */
+    bet_forecast_remove_event ( forecast, 1 );
+    bet_forecast_compute_balances ( forecast, 1 );
+    CU_ASSERT_EQUAL_FATAL ( 2, bet_forecast_get_nb_events ( forecast ) );
+    CU_ASSERT ( bet_forecast_cunit_check_balances ( forecast, without_second ) );
+
+    /* inserted again at the same place with the same balances */
+    index = bet_forecast_insert_event ( forecast, 738002, SPP_ORIGIN_SCHEDULED, 2,
+                        gsb_real_new ( -3000, 2 ), FALSE );
+    CU_ASSERT_EQUAL ( 1, index );
+    bet_forecast_compute_balances ( forecast, index );
+    CU_ASSERT ( bet_forecast_cunit_check_balances ( forecast, all_balances ) );
+
+    /* removing the last event changes no other balance */
+    bet_forecast_remove_event ( forecast, 2 );
+    bet_forecast_compute_balances ( forecast, 2 );
+    CU_ASSERT_EQUAL ( 2, bet_forecast_get_nb_events ( forecast ) );
+    CU_ASSERT ( bet_forecast_cunit_check_balances ( forecast, all_balances ) );
+
+    bet_forecast_free ( forecast );
+}
+
+void bet_forecast_cunit__bet_forecast_get_balance_series ( void )
+{
+    BetForecast *forecast;
+    guint32 first_day = 738000;
+    guint32 days[20];
+    gdouble balances[20];
+    guint nb_points;
+
+    forecast = bet_forecast_new ( null_real, SPP_ORIGIN_SOLDE, 0 );
+    bet_forecast_cunit_append ( forecast, first_day + 1, SPP_ORIGIN_TRANSACTION, 10000, 1 );
+    bet_forecast_cunit_append ( forecast, first_day + 2, SPP_ORIGIN_TRANSACTION, -15000, 2 );
+    bet_forecast_cunit_append ( forecast, first_day + 7, SPP_ORIGIN_TRANSACTION, 8000, 3 );
+    bet_forecast_compute_balances ( forecast, 0 );
+
+    /* one point by day when there is room */
+    nb_points = bet_forecast_get_balance_series ( forecast, first_day, first_day + 9, 20, days, balances );
+    CU_ASSERT_EQUAL_FATAL ( 10, nb_points );
+    CU_ASSERT_EQUAL ( first_day, days[0] );
+    CU_ASSERT_DOUBLE_EQUAL ( 0.0, balances[0], 0.001 );
+    CU_ASSERT_DOUBLE_EQUAL ( 100.0, balances[1], 0.001 );
+    CU_ASSERT_DOUBLE_EQUAL ( -50.0, balances[6], 0.001 );
+    CU_ASSERT_EQUAL ( first_day + 9, days[9] );
+    CU_ASSERT_DOUBLE_EQUAL ( 30.0, balances[9], 0.001 );
+
+    /* two buckets of five days, each gives its lowest and its highest
+     * balance in the order of their dates */
+    nb_points = bet_forecast_get_balance_series ( forecast, first_day, first_day + 9, 4, days, balances );
+    CU_ASSERT_EQUAL_FATAL ( 4, nb_points );
+    CU_ASSERT_EQUAL ( first_day + 1, days[0] );
+    CU_ASSERT_DOUBLE_EQUAL ( 100.0, balances[0], 0.001 );
+    CU_ASSERT_EQUAL ( first_day + 2, days[1] );
+    CU_ASSERT_DOUBLE_EQUAL ( -50.0, balances[1], 0.001 );
+    CU_ASSERT_EQUAL ( first_day + 5, days[2] );
+    CU_ASSERT_DOUBLE_EQUAL ( -50.0, balances[2], 0.001 );
+    CU_ASSERT_EQUAL ( first_day + 7, days[3] );
+    CU_ASSERT_DOUBLE_EQUAL ( 30.0, balances[3], 0.001 );
+
+    bet_forecast_free ( forecast );
+}
+
+void bet_forecast_cunit__bet_forecast_get_balance_series__max_points ( void )
+{
+    BetForecast *forecast;
+    guint32 first_day = 738000;
+    guint32 days[5];
+    gdouble balances[5];
+    guint nb_points;
+    guint i;
+
+    /* the balance goes up and down every day : each bucket gives two points */
+    forecast = bet_forecast_new ( null_real, SPP_ORIGIN_SOLDE, 0 );
+    for ( i = 0; i < 100; i++ )
+        bet_forecast_cunit_append ( forecast, first_day + i, SPP_ORIGIN_TRANSACTION,
+                        i % 2 ? -10000 : 10000, i + 1 );
+    bet_forecast_compute_balances ( forecast, 0 );
+
+    /* no room for the two points of a bucket */
+    CU_ASSERT_EQUAL ( 0, bet_forecast_get_balance_series ( forecast, first_day, first_day + 99, 0, days, balances ) );
+    CU_ASSERT_EQUAL ( 0, bet_forecast_get_balance_series ( forecast, first_day, first_day + 99, 1, days, balances ) );
+
+    /* an odd size : two buckets */
+    nb_points = bet_forecast_get_balance_series ( forecast, first_day, first_day + 99, 5, days, balances );
+    CU_ASSERT_EQUAL ( 4, nb_points );
+
+#ifdef HAVE_GOFFICE
+    /* the size of the arrays of the graph */
+    {
+        guint32 *graph_days;
+        gdouble *graph_balances;
+        guint nb_days = 3 * MAX_POINTS_GRAPHIQUE;
+
+        for ( i = 100; i < nb_days; i++ )
+            bet_forecast_cunit_append ( forecast, first_day + i, SPP_ORIGIN_TRANSACTION,
+                        i % 2 ? -10000 : 10000, i + 1 );
+        bet_forecast_compute_balances ( forecast, 0 );
+
+        graph_days = g_new0 ( guint32, MAX_POINTS_GRAPHIQUE );
+        graph_balances = g_new0 ( gdouble, MAX_POINTS_GRAPHIQUE );
+        nb_points = bet_forecast_get_balance_series ( forecast, first_day, first_day + nb_days - 1,
+                        MAX_POINTS_GRAPHIQUE, graph_days, graph_balances );
+        CU_ASSERT_EQUAL ( 2 * ( MAX_POINTS_GRAPHIQUE / 2 ), nb_points );
+        CU_ASSERT ( nb_points <= MAX_POINTS_GRAPHIQUE );
+        CU_ASSERT_EQUAL ( first_day, graph_days[0] );
+        CU_ASSERT ( graph_days[nb_points - 1] <= first_day + nb_days - 1 );
+        for ( i = 1; i < nb_points; i++ )
+            CU_ASSERT ( graph_days[i - 1] < graph_days[i] );
+
+        g_free ( graph_days );
+        g_free ( graph_balances );
+    }
+#endif /* HAVE_GOFFICE */
+
+    bet_forecast_free ( forecast );
+}
+
+CU_pSuite bet_forecast_cunit_create_suite ( void )
+{
+    CU_pSuite pSuite = CU_add_suite ( "bet_forecast",
+                        bet_forecast_cunit_init_suite,
+                        bet_forecast_cunit_clean_suite );
+    if ( NULL == pSuite )
+        return NULL;
+
+    if ( ( NULL == CU_add_test ( pSuite, "of bet_forecast_sort()", bet_forecast_cunit__bet_forecast_sort ) )
+     || ( NULL == CU_add_test ( pSuite, "of bet_forecast_compute_balances()", bet_forecast_cunit__bet_forecast_compute_balances ) )
+     || ( NULL == CU_add_test ( pSuite, "of bet_forecast_remove_event()", bet_forecast_cunit__bet_forecast_remove_event ) )
+     || ( NULL == CU_add_test ( pSuite, "of bet_forecast_get_balance_series()", bet_forecast_cunit__bet_forecast_get_balance_series ) )
+     || ( NULL == CU_add_test ( pSuite, "of bet_forecast_get_balance_series() with max_points", bet_forecast_cunit__bet_forecast_get_balance_series__max_points ) )
+       )
+        return NULL;
+
+    return pSuite;
+}
@@ -0,0 +1,13 @@
+#ifndef _BET_FORECAST_CUNIT_H
+#define _BET_FORECAST_CUNIT_H (1)
+
+#include <CUnit/Basic.h>
+
+/* START_INCLUDE_H */
+/* END_INCLUDE_H */
+
+/* START_DECLARATION */
+CU_pSuite bet_forecast_cunit_create_suite ( void );
+/* END_DECLARATION */
+
+#endif /*_BET_FORECAST_CUNIT_H */
@@ -0,0 +1,399 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                  bet_hist_cube_cunit                       */
+/*                                                                            */
+/*          https://www.grisbi.org/                                           */
+/*                                                                            */
+/*  This program is free software; you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation; either version 2 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This program is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program; if not, see <https://www.gnu.org/licenses/>.     */
+/*                                                                            */
+/* ************************************************************************** */
+
+/**
+ * \file bet_hist_cube_cunit.c
+ * cunit tests for the monthly aggregates of the historical data : their
+ * totals are compared with the transactions read one by one, as the
+ * historical data did before the aggregates
+ */
+
+#include "config.h"
+
+#include "include.h"
+
+/* START_INCLUDE */
+#include "bet_hist_cube_cunit.h"
+#include "bet_hist_cube.h"
+#include "gsb_data_account.h"
+#include "gsb_data_transaction.h"
+#include "gsb_real.h"
+#include "structures.h"
+/* END_INCLUDE */
+
+/* les totaux d'une lecture, par période et par catégorie et imputation */
+typedef struct _BetHistCubeCunitTotals	BetHistCubeCunitTotals;
+struct _BetHistCubeCunitTotals
+{
+    GHashTable *totals;         /* key : the period and the divisions, value : a GsbReal */
+    guint32 cut_day;            /* first day of the second period */
+    guint nb_sums;              /* number of sums of a month */
+    guint nb_transactions;      /* number of transactions given one by one */
+};
+
+/* START_STATIC */
+static void bet_hist_cube_cunit__bet_hist_cube_foreach ( void );
+static void bet_hist_cube_cunit_add_total ( BetHistCubeCunitTotals *totals,
+                        const GDate *date,
+                        gint category_number,
+                        gint sub_category_number,
+                        gint budgetary_number,
+                        gint sub_budgetary_number,
+                        GsbReal amount );
+static void bet_hist_cube_cunit_add_item ( const BetHistCubeItem *item,
+                        gpointer data );
+static void bet_hist_cube_cunit_check ( gint account_number,
+                        const GDate *date_min,
+                        const GDate *date_max,
+                        const GDate *cut_date,
+                        guint nb_sums_min );
+static gint bet_hist_cube_cunit_new_transaction ( gint account_number,
+                        gint64 mantissa,
+                        gint day,
+                        gint month,
+                        gint category_number,
+                        gint sub_category_number );
+static int bet_hist_cube_cunit_clean_suite ( void );
+static int bet_hist_cube_cunit_init_suite ( void );
+/* END_STATIC */
+
+/* START_EXTERN */
+/* END_EXTERN */
+
+
+/* The suite initialization function.
+ * Returns zero on success, non-zero otherwise.
+ */
+int bet_hist_cube_cunit_init_suite ( void )
+{
+    /* the accounts and transactions of the other suites, the aggregates are reset */
+    gsb_data_transaction_init_variables ();
+    gsb_data_account_init_variables ();
+
+    return 0;
+}
+
+/* The suite cleanup function.
+ * Returns zero on success, non-zero otherwise.
+ */
+int bet_hist_cube_cunit_clean_suite ( void )
+{
+    gsb_data_transaction_init_variables ();
+    gsb_data_account_init_variables ();
+
+    return 0;
+}
+
+/**
+ * create a transaction of 2024 with an amount with 2 decimals
+ *
+ * \param account_number
+ * \param mantissa
+ * \param day
+ * \param month
+ * \param category_number
+ * \param sub_category_number
+ *
+ * \return the number of the transaction
+ **/
+gint bet_hist_cube_cunit_new_transaction ( gint account_number,
+                        gint64 mantissa,
+                        gint day,
+                        gint month,
+                        gint category_number,
+                        gint sub_category_number )
+{
+    GsbReal amount = { mantissa, 2 };
+    GDate *date;
+    gint transaction_number;
+
+    date = g_date_new_dmy ( day, month, 2024 );
+    transaction_number = gsb_data_transaction_new_transaction ( account_number );
+    gsb_data_transaction_set_amount ( transaction_number, amount );
+    gsb_data_transaction_set_date ( transaction_number, date );
+    gsb_data_transaction_set_category_number ( transaction_number, category_number );
+    gsb_data_transaction_set_sub_category_number ( transaction_number, sub_category_number );
+    g_date_free ( date );
+
+    return transaction_number;
+}
+
+/**
+ * add an amount to the totals of its period and of its divisions
+ *
+ * \param totals
+ * \param date
+ * \param category_number
+ * \param sub_category_number
+ * \param budgetary_number
+ * \param sub_budgetary_number
+ * \param amount
+ *
+ * \return
+ **/
+void bet_hist_cube_cunit_add_total ( BetHistCubeCunitTotals *totals,
+                        const GDate *date,
+                        gint category_number,
+                        gint sub_category_number,
+                        gint budgetary_number,
+                        gint sub_budgetary_number,
+                        GsbReal amount )
+{
+    GsbReal *total;
+    gchar *key;
+
+    key = g_strdup_printf ( "%d:%d:%d:%d:%d",
+                        g_date_get_julian ( date ) >= totals -> cut_day,
+                        category_number,
+                        sub_category_number,
+                        budgetary_number,
+                        sub_budgetary_number );
+    total = g_hash_table_lookup ( totals -> totals, key );
+    if ( total )
+    {
+        *total = gsb_real_add ( *total, amount );
+        g_free ( key );
+    }
+    else
+    {
+        total = g_malloc ( sizeof ( GsbReal ) );
+        *total = amount;
+        g_hash_table_insert ( totals -> totals, key, total );
+    }
+}
+
+/**
+ * BetHistCubeFunc : add the amount given by the aggregates to the totals
+ *
+ * \param item
+ * \param data      BetHistCubeCunitTotals
+ *
+ * \return
+ **/
+void bet_hist_cube_cunit_add_item ( const BetHistCubeItem *item,
+                        gpointer data )
+{
+    BetHistCubeCunitTotals *totals = data;
+
+    if ( item -> transaction_number )
+        totals -> nb_transactions++;
+    else
+        totals -> nb_sums++;
+
+    bet_hist_cube_cunit_add_total ( totals,
+                        item -> date,
+                        item -> category_number,
+                        item -> sub_category_number,
+                        item -> budgetary_number,
+                        item -> sub_budgetary_number,
+                        item -> amount );
+}
+
+/**
+ * compare the totals of the aggregates with the totals of the transactions
+ * read one by one : the transactions of the account between the 2 dates,
+ * without the split transactions whose children are read
+ *
+ * \param account_number
+ * \param date_min
+ * \param date_max
+ * \param cut_date      first day of the second period
+ * \param nb_sums_min   the months given as sums by the aggregates
+ *
+ * \return
+ **/
+void bet_hist_cube_cunit_check ( gint account_number,
+                        const GDate *date_min,
+                        const GDate *date_max,
+                        const GDate *cut_date,
+                        guint nb_sums_min )
+{
+    BetHistCubeCunitTotals cube;
+    BetHistCubeCunitTotals reference;
+    const GDate *cut_dates[1];
+    GHashTableIter iter;
+    GSList *tmp_list;
+    gpointer key;
+    gpointer value;
+
+    cube.totals = g_hash_table_new_full ( g_str_hash, g_str_equal, g_free, g_free );
+    cube.cut_day = g_date_get_julian ( cut_date );
+    cube.nb_sums = 0;
+    cube.nb_transactions = 0;
+    reference = cube;
+    reference.totals = g_hash_table_new_full ( g_str_hash, g_str_equal, g_free, g_free );
+    cut_dates[0] = cut_date;
+
+    bet_hist_cube_foreach ( account_number,
+                        date_min,
+                        date_max,
+                        cut_dates,
+                        G_N_ELEMENTS ( cut_dates ),
+                        bet_hist_cube_cunit_add_item,
+                        &cube );
+
+    tmp_list = gsb_data_transaction_get_complete_transactions_list ();
+    while ( tmp_list )
+    {
+        const GDate *date;
+        gint transaction_number;
+
+        transaction_number = gsb_data_transaction_get_transaction_number ( tmp_list -> data );
+        tmp_list = tmp_list -> next;
+
+        date = gsb_data_transaction_get_date ( transaction_number );
+        if ( gsb_data_transaction_get_account_number ( transaction_number ) != account_number
+             || g_date_compare ( date, date_min ) < 0
+             || g_date_compare ( date, date_max ) > 0
+             || gsb_data_transaction_get_split_of_transaction ( transaction_number ) )
+            continue;
+
+        bet_hist_cube_cunit_add_total ( &reference,
+                        date,
+                        gsb_data_transaction_get_category_number ( transaction_number ),
+                        gsb_data_transaction_get_sub_category_number ( transaction_number ),
+                        gsb_data_transaction_get_budgetary_number ( transaction_number ),
+                        gsb_data_transaction_get_sub_budgetary_number ( transaction_number ),
+                        gsb_data_transaction_get_amount ( transaction_number ) );
+    }
+
+    /* the months without cut date are read as sums */
+    CU_ASSERT ( cube.nb_sums >= nb_sums_min );
+
+    CU_ASSERT_EQUAL ( g_hash_table_size ( reference.totals ), g_hash_table_size ( cube.totals ) );
+    g_hash_table_iter_init ( &iter, reference.totals );
+    while ( g_hash_table_iter_next ( &iter, &key, &value ) )
+    {
+        GsbReal *total;
+
+        total = g_hash_table_lookup ( cube.totals, key );
+        CU_ASSERT_PTR_NOT_NULL ( total );
+        if ( total )
+            CU_ASSERT_EQUAL ( 0, gsb_real_cmp ( *total, *( GsbReal * ) value ) );
+    }
+
+    g_hash_table_destroy ( cube.totals );
+    g_hash_table_destroy ( reference.totals );
+}
+
+void bet_hist_cube_cunit__bet_hist_cube_foreach ( void )
+{
+    GDate *date_min;
+    GDate *date_max;
+    GDate *cut_date;
+    GDate *date;
+    gint account_number;
+    gint other_account_number;
+    gint january_number;
+    gint february_number;
+    gint march_number;
+    gint split_number;
+    gint child_number;
+    gint other_child_number;
+
+    account_number = gsb_data_account_new ( GSB_TYPE_BANK );
+    other_account_number = gsb_data_account_new ( GSB_TYPE_BANK );
+
+    /* the period is cut on the 15th of march */
+    date_min = g_date_new_dmy ( 1, 1, 2024 );
+    date_max = g_date_new_dmy ( 30, 4, 2024 );
+    cut_date = g_date_new_dmy ( 15, 3, 2024 );
+
+    /* creation, the aggregates are built at the first use */
+    january_number = bet_hist_cube_cunit_new_transaction ( account_number, -1000, 10, 1, 1, 1 );
+    bet_hist_cube_cunit_new_transaction ( account_number, -550, 20, 1, 1, 1 );
+    february_number = bet_hist_cube_cunit_new_transaction ( account_number, 10000, 5, 2, 2, 0 );
+    gsb_data_transaction_set_budgetary_number ( february_number, 3 );
+    march_number = bet_hist_cube_cunit_new_transaction ( account_number, -700, 10, 3, 1, 1 );
+    bet_hist_cube_cunit_new_transaction ( account_number, -300, 20, 3, 1, 1 );
+    bet_hist_cube_cunit_new_transaction ( account_number, -2500, 25, 4, 6, 0 );
+    bet_hist_cube_cunit_new_transaction ( other_account_number, -4000, 10, 1, 1, 1 );
+
+    /* before the period */
+    date = g_date_new_dmy ( 15, 12, 2023 );
+    gsb_data_transaction_set_date ( bet_hist_cube_cunit_new_transaction ( account_number, -900, 1, 1, 1, 1 ), date );
+
+    /* a split : only the children are counted */
+    split_number = bet_hist_cube_cunit_new_transaction ( account_number, -5000, 25, 2, 0, 0 );
+    gsb_data_transaction_set_split_of_transaction ( split_number, TRUE );
+    child_number = bet_hist_cube_cunit_new_transaction ( account_number, -3000, 25, 2, 4, 0 );
+    gsb_data_transaction_set_mother_transaction_number ( child_number, split_number );
+    other_child_number = bet_hist_cube_cunit_new_transaction ( account_number, -2000, 25, 2, 5, 0 );
+    gsb_data_transaction_set_mother_transaction_number ( other_child_number, split_number );
+
+    /* january, february and april are sums, march is cut */
+    bet_hist_cube_cunit_check ( account_number, date_min, date_max, cut_date, 3 );
+
+    /* edit of the amount, the date, the account and the category */
+    gsb_data_transaction_set_amount ( january_number, gsb_real_new ( -1200, 2 ) );
+    bet_hist_cube_cunit_check ( account_number, date_min, date_max, cut_date, 3 );
+
+    g_date_set_dmy ( date, 18, 3, 2024 );
+    gsb_data_transaction_set_date ( february_number, date );
+    bet_hist_cube_cunit_check ( account_number, date_min, date_max, cut_date, 3 );
+
+    gsb_data_transaction_set_account_number ( march_number, other_account_number );
+    bet_hist_cube_cunit_check ( account_number, date_min, date_max, cut_date, 3 );
+    bet_hist_cube_cunit_check ( other_account_number, date_min, date_max, cut_date, 1 );
+
+    gsb_data_transaction_set_category_number ( january_number, 2 );
+    gsb_data_transaction_set_sub_category_number ( january_number, 3 );
+    bet_hist_cube_cunit_check ( account_number, date_min, date_max, cut_date, 3 );
+
+    /* the date of a split moves its children into the cut month */
+    g_date_set_dmy ( date, 1, 3, 2024 );
+    gsb_data_transaction_set_date ( split_number, date );
+    bet_hist_cube_cunit_check ( account_number, date_min, date_max, cut_date, 2 );
+
+    /* a child becomes a simple transaction */
+    gsb_data_transaction_set_split_of_transaction ( split_number, FALSE );
+    gsb_data_transaction_set_amount ( split_number, gsb_real_new ( 0, 2 ) );
+    bet_hist_cube_cunit_check ( account_number, date_min, date_max, cut_date, 2 );
+
+    /* deletion */
+    gsb_data_transaction_remove_transaction_without_check ( child_number );
+    bet_hist_cube_cunit_check ( account_number, date_min, date_max, cut_date, 2 );
+    gsb_data_transaction_remove_transaction_without_check ( january_number );
+    bet_hist_cube_cunit_check ( account_number, date_min, date_max, cut_date, 2 );
+
+    /* the same totals when the cut is on the first day of a month */
+    g_date_set_dmy ( cut_date, 1, 4, 2024 );
+    bet_hist_cube_cunit_check ( account_number, date_min, date_max, cut_date, 2 );
+
+    g_date_free ( date );
+    g_date_free ( date_min );
+    g_date_free ( date_max );
+    g_date_free ( cut_date );
+}
+
+CU_pSuite bet_hist_cube_cunit_create_suite ( void )
+{
+    CU_pSuite pSuite = CU_add_suite ( "bet_hist_cube",
+                        bet_hist_cube_cunit_init_suite,
+                        bet_hist_cube_cunit_clean_suite );
+    if ( NULL == pSuite )
+        return NULL;
+
+    if ( NULL == CU_add_test ( pSuite, "of bet_hist_cube_foreach()", bet_hist_cube_cunit__bet_hist_cube_foreach ) )
+        return NULL;
+
+    return pSuite;
+}
@@ -37,11 +37,13 @@
 #include "gsb_data_account.h"
 #include "gsb_data_currency.h"
 #include "gsb_data_transaction.h"
+#include "gsb_file_archive_segment.h"
 #include "gsb_real.h"
 /* END_INCLUDE */
 
 /* START_STATIC */
 static void gsb_data_account_cunit__gsb_data_account_calculate_current_and_marked_balances(void);
+static void gsb_data_account_cunit__gsb_data_account_balances_with_archive_segment(void);
 static int gsb_data_account_cunit_clean_suite(void);
 static int gsb_data_account_cunit_init_suite(void);
 /* END_STATIC */
@@ -118,6 +120,42 @@ void gsb_data_account_cunit__gsb_data_account_calculate_current_and_marked_balan
     CU_ASSERT_EQUAL(TRUE, gsb_data_currency_remove ( cur_number ));
 }
 
+void gsb_data_account_cunit__gsb_data_account_balances_with_archive_segment(void)
+{
+    GDate *date = g_date_new_dmy (31, 12, 2000);
+
+    gint account_number = gsb_data_account_new(GSB_TYPE_BANK);
+    gint cur_number = gsb_data_currency_new("EUR");
+    CU_ASSERT_EQUAL(TRUE, gsb_data_currency_set_floating_point(cur_number, 2));
+    CU_ASSERT_EQUAL(TRUE, gsb_data_account_set_currency(account_number, cur_number));
+
+    GsbReal before = gsb_data_account_calculate_current_and_marked_balances(account_number);
+    gint last_number = gsb_data_transaction_get_last_number();
+
+    /* the archived transactions not loaded are in the balances and keep their numbers */
+    GsbReal archived = { 12345, 2 };
+    gsb_file_archive_segment_add_summary (1, account_number, archived, 3, date, last_number + 100);
+    CU_ASSERT_EQUAL(TRUE, gsb_file_archive_segment_is_cold());
+    CU_ASSERT_EQUAL(TRUE, gsb_file_archive_segment_contains_archive(1));
+    CU_ASSERT_EQUAL(FALSE, gsb_file_archive_segment_contains_archive(2));
+
+    GsbReal balance = gsb_data_account_calculate_current_and_marked_balances(account_number);
+    CU_ASSERT_EQUAL(before.mantissa + 12345, balance.mantissa);
+    CU_ASSERT_EQUAL(2, balance.exponent);
+    balance = gsb_data_account_get_marked_balance(account_number);
+    CU_ASSERT_EQUAL(before.mantissa + 12345, balance.mantissa);
+    CU_ASSERT_EQUAL(last_number + 100, gsb_data_transaction_get_last_number());
+
+    gsb_file_archive_segment_init_variables ();
+    balance = gsb_data_account_calculate_current_and_marked_balances(account_number);
+    CU_ASSERT_EQUAL(before.mantissa, balance.mantissa);
+    CU_ASSERT_EQUAL(last_number, gsb_data_transaction_get_last_number());
+
+    gsb_data_account_delete( account_number );
+    g_date_free(date);
+    CU_ASSERT_EQUAL(TRUE, gsb_data_currency_remove ( cur_number ));
+}
+
 CU_pSuite gsb_data_account_cunit_create_suite(void)
 {
     CU_pSuite pSuite = CU_add_suite("gsb_data_account",
@@ -127,6 +165,7 @@ CU_pSuite gsb_data_account_cunit_create_suite(void)
         return NULL;
 
     if((NULL == CU_add_test(pSuite, "of gsb_data_account()", gsb_data_account_cunit__gsb_data_account_calculate_current_and_marked_balances))
+       || (NULL == CU_add_test(pSuite, "of balances with archive segment", gsb_data_account_cunit__gsb_data_account_balances_with_archive_segment))
        )
         return NULL;
 
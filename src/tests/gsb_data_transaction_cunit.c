@@ -0,0 +1,155 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                  gsb_data_transaction_cunit                */
+/*                                                                            */
+/*          https://www.grisbi.org/                                           */
+/*                                                                            */
+/*  This program is free software; you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation; either version 2 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This program is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program; if not, see <https://www.gnu.org/licenses/>.     */
+/*                                                                            */
+/* ************************************************************************** */
+
+/**
+ * \file gsb_data_transaction_cunit.c
+ * cunit tests for gsb_data_transaction
+ */
+
+#include "config.h"
+
+#include "include.h"
+
+/* START_INCLUDE */
+#include "gsb_data_transaction_cunit.h"
+#include "gsb_data_account.h"
+#include "gsb_data_currency.h"
+#include "gsb_data_currency_link.h"
+#include "gsb_data_transaction.h"
+#include "gsb_real.h"
+#include "structures.h"
+/* END_INCLUDE */
+
+/* START_STATIC */
+static void gsb_data_transaction_cunit__gsb_data_transaction_get_counted_amount ( void );
+static int gsb_data_transaction_cunit_clean_suite ( void );
+static int gsb_data_transaction_cunit_init_suite ( void );
+/* END_STATIC */
+
+/* START_EXTERN */
+/* END_EXTERN */
+
+
+/* The suite initialization function.
+ * Returns zero on success, non-zero otherwise.
+ */
+int gsb_data_transaction_cunit_init_suite ( void )
+{
+    gsb_data_transaction_init_variables ();
+    gsb_data_account_init_variables ();
+    gsb_data_currency_link_init_variables ();
+
+    return 0;
+}
+
+/* The suite cleanup function.
+ * Returns zero on success, non-zero otherwise.
+ */
+int gsb_data_transaction_cunit_clean_suite ( void )
+{
+    gsb_data_transaction_init_variables ();
+    gsb_data_account_init_variables ();
+    gsb_data_currency_link_init_variables ();
+
+    return 0;
+}
+
+void gsb_data_transaction_cunit__gsb_data_transaction_get_counted_amount ( void )
+{
+    TransactionCountedAmount first_count;
+    TransactionCountedAmount second_count;
+    GsbReal amount = { 10000, 2 };
+    GsbReal first_rate = { 90, 2 };
+    GsbReal second_rate = { 50, 2 };
+    GDate *date;
+    gint account_number;
+    gint euro;
+    gint dollar;
+    gint link_number;
+    gint transaction_number;
+
+    euro = gsb_data_currency_new ( "EUR" );
+    gsb_data_currency_set_floating_point ( euro, 2 );
+    dollar = gsb_data_currency_new ( "USD" );
+    gsb_data_currency_set_floating_point ( dollar, 2 );
+
+    /* 1 USD = 0.90 EUR */
+    link_number = gsb_data_currency_link_new ( 0 );
+    gsb_data_currency_link_set_first_currency ( link_number, dollar );
+    gsb_data_currency_link_set_second_currency ( link_number, euro );
+    gsb_data_currency_link_set_change_rate ( link_number, first_rate );
+
+    account_number = gsb_data_account_new ( GSB_TYPE_BANK );
+    gsb_data_account_set_currency ( account_number, dollar );
+
+    /* first edit : 100.00 USD counted in a tree in EUR */
+    date = g_date_new_dmy ( 1, 3, 2024 );
+    transaction_number = gsb_data_transaction_new_transaction ( account_number );
+    gsb_data_transaction_set_date ( transaction_number, date );
+    gsb_data_transaction_set_currency_number ( transaction_number, dollar );
+    gsb_data_transaction_set_amount ( transaction_number, amount );
+
+    gsb_data_transaction_get_counted_amount ( transaction_number, euro, &first_count );
+    CU_ASSERT_EQUAL ( dollar, first_count.currency_number );
+    CU_ASSERT_EQUAL ( 0, gsb_real_cmp ( gsb_real_new ( 9000, 2 ),
+                        gsb_data_transaction_get_counted_amount_value ( &first_count, euro ) ) );
+
+    /* the rate of the link changes before the second edit */
+    gsb_data_currency_link_set_change_rate ( link_number, second_rate );
+
+    /* the second edit removes the value added by the first one */
+    CU_ASSERT_EQUAL ( 0, gsb_real_cmp ( gsb_real_new ( 9000, 2 ),
+                        gsb_data_transaction_get_counted_amount_value ( &first_count, euro ) ) );
+
+    /* and adds the value with the new rate */
+    gsb_data_transaction_get_counted_amount ( transaction_number, euro, &second_count );
+    CU_ASSERT_EQUAL ( 0, gsb_real_cmp ( gsb_real_new ( 5000, 2 ),
+                        gsb_data_transaction_get_counted_amount_value ( &second_count, euro ) ) );
+
+    /* without the link, the counted value is still converted with its rate */
+    gsb_data_currency_link_remove ( link_number );
+    CU_ASSERT_EQUAL ( 0, gsb_real_cmp ( gsb_real_new ( 5000, 2 ),
+                        gsb_data_transaction_get_counted_amount_value ( &second_count, euro ) ) );
+
+    /* in the currency of the transaction, nothing is converted */
+    gsb_data_transaction_get_counted_amount ( transaction_number, dollar, &second_count );
+    CU_ASSERT_EQUAL ( 0, gsb_real_cmp ( amount,
+                        gsb_data_transaction_get_counted_amount_value ( &second_count, dollar ) ) );
+
+    g_date_free ( date );
+    gsb_data_currency_remove ( dollar );
+    gsb_data_currency_remove ( euro );
+}
+
+CU_pSuite gsb_data_transaction_cunit_create_suite ( void )
+{
+    CU_pSuite pSuite = CU_add_suite ( "gsb_data_transaction",
+                        gsb_data_transaction_cunit_init_suite,
+                        gsb_data_transaction_cunit_clean_suite );
+    if ( NULL == pSuite )
+        return NULL;
+
+    if ( NULL == CU_add_test ( pSuite, "of gsb_data_transaction_get_counted_amount()",
+                        gsb_data_transaction_cunit__gsb_data_transaction_get_counted_amount ) )
+        return NULL;
+
+    return pSuite;
+}
@@ -0,0 +1,169 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                  gsb_real_bench                            */
+/*                                                                            */
+/*          https://www.grisbi.org/                                           */
+/*                                                                            */
+/*  This program is free software; you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation; either version 2 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This program is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program; if not, see <https://www.gnu.org/licenses/>.     */
+/*                                                                            */
+/* ************************************************************************** */
+
+/**
+ * \file gsb_real_bench.c
+ * benchmark of the arithmetic of gsb_real, not run by make check
+ * usage : gsb_real_bench [number of operations]
+ */
+
+#include "config.h"
+
+#include "include.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* START_INCLUDE */
+#include "gsb_real.h"
+/* END_INCLUDE */
+
+#define BENCH_NB_AMOUNTS 4096
+
+/* the amounts, like in a file : mostly 2 decimals, some other exponents */
+static GsbReal amounts[BENCH_NB_AMOUNTS];
+
+static void gsb_real_bench_init_amounts ( void )
+{
+    guint32 seed = 12345;
+    gint i;
+
+    for ( i = 0 ; i < BENCH_NB_AMOUNTS ; i++ )
+    {
+        seed = seed * 1103515245 + 12345;
+        amounts[i].mantissa = ( gint64 ) ( seed % 2000001 ) - 1000000;
+        amounts[i].exponent = ( i % 16 ) ? 2 : ( i % 5 );
+    }
+}
+
+static void gsb_real_bench_print ( const gchar *name, gint64 start, gint nb_operations, GsbReal result )
+{
+    gint64 duration;
+
+    duration = g_get_monotonic_time () - start;
+    g_print ( "%-40s %8.2f ms %8.2f ns/op   (%" G_GINT64_FORMAT "e-%d)\n",
+              name,
+              duration / 1000.0,
+              duration * 1000.0 / nb_operations,
+              result.mantissa,
+              result.exponent );
+}
+
+int main ( int argc, char **argv )
+{
+    GsbRealAccumulator accumulator;
+    GsbRealFormat format;
+    GsbReal sum;
+    struct lconv conv;
+    gchar buffer[GSB_REAL_FORMAT_BUF_SIZE];
+    gsize nb_chars = 0;
+    gint64 start;
+    gint nb_operations = 10000000;
+    gint nb_lower = 0;
+    gint i;
+
+    if ( argc > 1 )
+        nb_operations = atoi ( argv[1] );
+    if ( nb_operations <= 0 )
+        return 1;
+
+    gsb_real_bench_init_amounts ();
+#ifdef GSB_REAL_HAVE_INT128
+    g_print ( "gsb_real with 128 bits intermediates, %d operations\n", nb_operations );
+#else
+    g_print ( "gsb_real without 128 bits intermediates, %d operations\n", nb_operations );
+#endif
+
+    /* sum with the same exponent : the fast path */
+    start = g_get_monotonic_time ();
+    sum = gsb_real_new ( 0, 2 );
+    for ( i = 0 ; i < nb_operations ; i++ )
+    {
+        GsbReal amount = amounts[i % BENCH_NB_AMOUNTS];
+
+        amount.exponent = 2;
+        sum = gsb_real_add ( sum, amount );
+    }
+    gsb_real_bench_print ( "gsb_real_add, same exponent", start, nb_operations, sum );
+
+    /* sum with mixed exponents */
+    start = g_get_monotonic_time ();
+    sum = null_real;
+    for ( i = 0 ; i < nb_operations ; i++ )
+        sum = gsb_real_add ( sum, amounts[i % BENCH_NB_AMOUNTS] );
+    gsb_real_bench_print ( "gsb_real_add, mixed exponents", start, nb_operations, sum );
+
+    /* the same sum with an accumulator */
+    start = g_get_monotonic_time ();
+    gsb_real_accumulator_init ( &accumulator, 2 );
+    for ( i = 0 ; i < nb_operations ; i++ )
+        gsb_real_accumulator_add ( &accumulator, amounts[i % BENCH_NB_AMOUNTS] );
+    sum = gsb_real_accumulator_get_value ( &accumulator );
+    gsb_real_bench_print ( "gsb_real_accumulator_add, mixed exponents", start, nb_operations, sum );
+
+    /* comparisons */
+    start = g_get_monotonic_time ();
+    for ( i = 0 ; i < nb_operations ; i++ )
+    {
+        if ( gsb_real_cmp ( amounts[i % BENCH_NB_AMOUNTS], amounts[( i + 1 ) % BENCH_NB_AMOUNTS] ) < 0 )
+            nb_lower++;
+    }
+    gsb_real_bench_print ( "gsb_real_cmp, mixed exponents", start, nb_operations, gsb_real_new ( nb_lower, 0 ) );
+
+    /* products */
+    start = g_get_monotonic_time ();
+    sum = null_real;
+    for ( i = 0 ; i < nb_operations ; i++ )
+        sum = gsb_real_add ( sum,
+                             gsb_real_mul ( amounts[i % BENCH_NB_AMOUNTS], gsb_real_new ( 12345, 4 ) ) );
+    gsb_real_bench_print ( "gsb_real_mul + gsb_real_add", start, nb_operations, sum );
+
+    /* formatting, like the balances of the lists */
+    memset ( &conv, 0, sizeof ( conv ) );
+    conv.positive_sign = (gchar *) "";
+    conv.negative_sign = (gchar *) "-";
+    conv.mon_thousands_sep = (gchar *) " ";
+    conv.mon_decimal_point = (gchar *) ",";
+    conv.p_sep_by_space = 1;
+
+    start = g_get_monotonic_time ();
+    for ( i = 0 ; i < nb_operations / 10 ; i++ )
+    {
+        gchar *string;
+
+        string = gsb_real_raw_format_string ( amounts[i % BENCH_NB_AMOUNTS], &conv, "EUR" );
+        nb_chars += strlen ( string );
+        g_free ( string );
+    }
+    gsb_real_bench_print ( "gsb_real_raw_format_string", start, nb_operations / 10, gsb_real_new ( nb_chars, 0 ) );
+
+    nb_chars = 0;
+    start = g_get_monotonic_time ();
+    gsb_real_format_init ( &format, &conv, "EUR" );
+    for ( i = 0 ; i < nb_operations / 10 ; i++ )
+        nb_chars += gsb_real_raw_format_to_buffer ( amounts[i % BENCH_NB_AMOUNTS], &format, buffer, sizeof ( buffer ) );
+    gsb_real_bench_print ( "gsb_real_raw_format_to_buffer", start, nb_operations / 10, gsb_real_new ( nb_chars, 0 ) );
+
+    return 0;
+}
+
+/* Local Variables: */
+/* c-basic-offset: 4 */
+/* End: */
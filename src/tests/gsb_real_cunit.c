@@ -42,10 +42,16 @@ static void gsb_real_cunit__gsb_real_add ( void );
 static void gsb_real_cunit__gsb_real_mul( void );
 static void gsb_real_cunit__gsb_real_normalize( void );
 static void gsb_real_cunit__gsb_real_raw_format_string ( void );
+static void gsb_real_cunit__gsb_real_raw_format_to_buffer ( void );
 static void gsb_real_cunit__gsb_real_raw_get_from_string( void );
 static void gsb_real_cunit__gsb_real_raw_get_from_string__locale( void );
 static void gsb_real_cunit__gsb_real_sub( void );
 static void gsb_real_cunit__gsb_real_adjust_exponent ( void );
+static void gsb_real_cunit__gsb_real_accumulator ( void );
+static void gsb_real_cunit__gsb_real_add_properties ( void );
+static void gsb_real_cunit__gsb_real_cmp_properties ( void );
+static void gsb_real_cunit__gsb_real_mul_properties ( void );
+static void gsb_real_cunit__gsb_real_overflow ( void );
 static int gsb_real_cunit_clean_suite ( void );
 static int gsb_real_cunit_init_suite ( void );
 /* END_STATIC */
@@ -53,6 +59,47 @@ static int gsb_real_cunit_init_suite ( void );
 /* START_EXTERN */
 /* END_EXTERN */
 
+/* the numbers used by the property tests : all the mantissas with all the exponents */
+#define PROPERTY_EXPONENT_MAX 6
+static const gint64 property_mantissas[] =
+{
+    -999999999, -123456789, -100000, -31415, -1000, -10, -7, -1, 0,
+    1, 5, 10, 99, 1000, 27182, 100000, 987654321, 999999999
+};
+#define PROPERTY_NB_MANTISSAS (gint) (sizeof (property_mantissas) / sizeof (property_mantissas[0]))
+
+/* the powers of 10 used to compute the expected values */
+static gint64 property_power_10 ( gint exponent )
+{
+    gint64 power_10 = 1;
+
+    while ( exponent-- > 0 )
+        power_10 *= 10;
+
+    return power_10;
+}
+
+/* the mantissa of the number expressed with the exponent, which must be >= number.exponent */
+static gint64 property_scale ( GsbReal number, gint exponent )
+{
+    return number.mantissa * property_power_10 ( exponent - number.exponent );
+}
+
+/* pseudo-random generator, to get the same numbers at each run */
+static guint32 property_seed = 12345;
+
+static GsbReal property_random_real ( void )
+{
+    GsbReal number;
+
+    property_seed = property_seed * 1103515245 + 12345;
+    number.mantissa = ( gint64 ) ( property_seed % 2000000001 ) - 1000000000;
+    property_seed = property_seed * 1103515245 + 12345;
+    number.exponent = ( property_seed >> 16 ) % ( PROPERTY_EXPONENT_MAX + 1 );
+
+    return number;
+}
+
 /* The suite initialization function.
  * Returns zero on success, non-zero otherwise.
  */
@@ -394,6 +441,58 @@ void gsb_real_cunit__gsb_real_raw_format_string ( void )
 }
 
 
+void gsb_real_cunit__gsb_real_raw_format_to_buffer ( void )
+{
+    GsbRealFormat format;
+    gchar buffer[GSB_REAL_FORMAT_BUF_SIZE];
+    gchar small_buffer[6];
+    gchar *s;
+    gsize len;
+    gint i;
+    gint j;
+    struct lconv conv;
+    memset(&conv, 0, sizeof(conv));
+    conv.positive_sign = "";
+    conv.negative_sign = "-";
+    conv.mon_thousands_sep = "\xe2\x80\xaf";
+    conv.mon_decimal_point = ",";
+    conv.p_sep_by_space = 1;
+
+    /* the same strings as gsb_real_raw_format_string */
+    gsb_real_format_init ( &format, &conv, "EUR" );
+    for ( i = 0 ; i < PROPERTY_NB_MANTISSAS ; i++ )
+        for ( j = 0 ; j <= PROPERTY_EXPONENT_MAX ; j++ )
+        {
+            GsbReal n = gsb_real_new ( property_mantissas[i], j );
+
+            len = gsb_real_raw_format_to_buffer ( n, &format, buffer, sizeof ( buffer ) );
+            s = gsb_real_raw_format_string ( n, &conv, "EUR" );
+            CU_ASSERT_STRING_EQUAL ( s, buffer );
+            CU_ASSERT_EQUAL ( strlen ( s ), len );
+            g_free ( s );
+        }
+
+    len = gsb_real_raw_format_to_buffer ( gsb_real_new ( -123456789, 2 ), &format, buffer, sizeof ( buffer ) );
+    CU_ASSERT_STRING_EQUAL ( "-1\xe2\x80\xaf" "234\xe2\x80\xaf" "567,89 EUR", buffer );
+
+    /* the biggest mantissas, exactly */
+    gsb_real_raw_format_to_buffer ( gsb_real_new ( G_MAXINT64, 0 ), &format, buffer, sizeof ( buffer ) );
+    CU_ASSERT_STRING_EQUAL ( "9\xe2\x80\xaf" "223\xe2\x80\xaf" "372\xe2\x80\xaf" "036\xe2\x80\xaf"
+                             "854\xe2\x80\xaf" "775\xe2\x80\xaf" "807 EUR", buffer );
+
+    /* currency symbol before the number */
+    conv.p_cs_precedes = 1;
+    gsb_real_format_init ( &format, &conv, "$" );
+    gsb_real_raw_format_to_buffer ( gsb_real_new ( 150, 2 ), &format, buffer, sizeof ( buffer ) );
+    CU_ASSERT_STRING_EQUAL ( "$ 1,50", buffer );
+
+    /* a too small buffer is truncated */
+    len = gsb_real_raw_format_to_buffer ( gsb_real_new ( 150, 2 ), &format, small_buffer, sizeof ( small_buffer ) );
+    CU_ASSERT_EQUAL ( 5, len );
+    CU_ASSERT_STRING_EQUAL ( "$ 1,5", small_buffer );
+}
+
+
 void gsb_real_cunit__gsb_real_normalize( void )
 {
     GsbReal a;
@@ -596,6 +695,173 @@ void gsb_real_cunit__gsb_real_adjust_exponent ( void )
     CU_ASSERT_EQUAL(2, r.exponent);
 }
 
+void gsb_real_cunit__gsb_real_add_properties ( void )
+{
+    gint i, j, e1, e2;
+
+    for ( i = 0 ; i < PROPERTY_NB_MANTISSAS ; i++ )
+    for ( j = 0 ; j < PROPERTY_NB_MANTISSAS ; j++ )
+    for ( e1 = 0 ; e1 <= PROPERTY_EXPONENT_MAX ; e1++ )
+    for ( e2 = 0 ; e2 <= PROPERTY_EXPONENT_MAX ; e2++ )
+    {
+        GsbReal a = { property_mantissas[i], e1 };
+        GsbReal b = { property_mantissas[j], e2 };
+        GsbReal r = gsb_real_add ( a, b );
+        GsbReal r2 = gsb_real_add ( b, a );
+        GsbReal d = gsb_real_sub ( r, b );
+
+        /* exact result, with the biggest exponent */
+        CU_ASSERT_EQUAL ( MAX ( e1, e2 ), r.exponent );
+        CU_ASSERT_EQUAL ( property_scale ( a, PROPERTY_EXPONENT_MAX ) + property_scale ( b, PROPERTY_EXPONENT_MAX ),
+                          property_scale ( r, PROPERTY_EXPONENT_MAX ) );
+
+        /* commutativity */
+        CU_ASSERT_EQUAL ( r.mantissa, r2.mantissa );
+        CU_ASSERT_EQUAL ( r.exponent, r2.exponent );
+
+        /* (a + b) - b = a */
+        CU_ASSERT_EQUAL ( 0, gsb_real_cmp ( d, a ) );
+    }
+
+    for ( i = 0 ; i < 100000 ; i++ )
+    {
+        GsbReal a = property_random_real ();
+        GsbReal b = property_random_real ();
+        GsbReal r = gsb_real_add ( a, b );
+
+        CU_ASSERT_EQUAL ( property_scale ( a, PROPERTY_EXPONENT_MAX ) + property_scale ( b, PROPERTY_EXPONENT_MAX ),
+                          property_scale ( r, PROPERTY_EXPONENT_MAX ) );
+    }
+}
+
+void gsb_real_cunit__gsb_real_cmp_properties ( void )
+{
+    gint i, j, e1, e2;
+
+    for ( i = 0 ; i < PROPERTY_NB_MANTISSAS ; i++ )
+    for ( j = 0 ; j < PROPERTY_NB_MANTISSAS ; j++ )
+    for ( e1 = 0 ; e1 <= PROPERTY_EXPONENT_MAX ; e1++ )
+    for ( e2 = 0 ; e2 <= PROPERTY_EXPONENT_MAX ; e2++ )
+    {
+        GsbReal a = { property_mantissas[i], e1 };
+        GsbReal b = { property_mantissas[j], e2 };
+        gint64 scaled_a = property_scale ( a, PROPERTY_EXPONENT_MAX );
+        gint64 scaled_b = property_scale ( b, PROPERTY_EXPONENT_MAX );
+        gint expected = ( scaled_a > scaled_b ) - ( scaled_a < scaled_b );
+
+        CU_ASSERT_EQUAL ( expected, gsb_real_cmp ( a, b ) );
+        CU_ASSERT_EQUAL ( -expected, gsb_real_cmp ( b, a ) );
+    }
+
+    /* exact comparison of big numbers with different exponents */
+    {
+        GsbReal a = { G_GINT64_CONSTANT(922337203685477580), 0 };
+        GsbReal b = { G_GINT64_CONSTANT(9223372036854775801), 1 };
+        CU_ASSERT_EQUAL ( -1, gsb_real_cmp ( a, b ) );
+        CU_ASSERT_EQUAL ( 1, gsb_real_cmp ( b, a ) );
+    }
+}
+
+void gsb_real_cunit__gsb_real_mul_properties ( void )
+{
+    gint i, j, e1, e2;
+
+    for ( i = 0 ; i < PROPERTY_NB_MANTISSAS ; i++ )
+    for ( j = 0 ; j < PROPERTY_NB_MANTISSAS ; j++ )
+    for ( e1 = 0 ; e1 <= 3 ; e1++ )
+    for ( e2 = 0 ; e2 <= 3 ; e2++ )
+    {
+        GsbReal a = { property_mantissas[i], e1 };
+        GsbReal b = { property_mantissas[j], e2 };
+        GsbReal r = gsb_real_mul ( a, b );
+        GsbReal r2 = gsb_real_mul ( b, a );
+
+        /* exact result, with the smallest exponent */
+        CU_ASSERT_EQUAL ( a.mantissa * b.mantissa, property_scale ( r, e1 + e2 ) );
+        CU_ASSERT ( r.exponent == 0 || r.mantissa % 10 != 0 );
+        CU_ASSERT_EQUAL ( r.mantissa, r2.mantissa );
+        CU_ASSERT_EQUAL ( r.exponent, r2.exponent );
+    }
+}
+
+void gsb_real_cunit__gsb_real_overflow ( void )
+{
+    GsbReal a = { G_MAXINT64, 0 };
+    GsbReal b = { 1, 0 };
+    GsbReal r;
+
+    r = gsb_real_add ( a, b );
+    CU_ASSERT_EQUAL ( G_MININT64, r.mantissa );
+
+    a.mantissa = -G_MAXINT64;
+    r = gsb_real_sub ( a, b );
+    CU_ASSERT_EQUAL ( G_MININT64, r.mantissa );
+
+    a.mantissa = G_GINT64_CONSTANT(4000000000000000000);
+    b.mantissa = G_GINT64_CONSTANT(4000000000000000000);
+    r = gsb_real_mul ( a, b );
+    CU_ASSERT_EQUAL ( G_MININT64, r.mantissa );
+
+#ifdef GSB_REAL_HAVE_INT128
+    /* with 128 bits intermediates, the exponent is reduced instead of an error */
+    a.mantissa = G_MAXINT64;
+    a.exponent = 2;
+    b.mantissa = 1;
+    b.exponent = 2;
+    r = gsb_real_add ( a, b );
+    CU_ASSERT_EQUAL ( G_GINT64_CONSTANT(922337203685477580), r.mantissa );
+    CU_ASSERT_EQUAL ( 1, r.exponent );
+
+    a.mantissa = G_GINT64_CONSTANT(4000000000000000000);
+    a.exponent = 2;
+    b.mantissa = 25;
+    b.exponent = 1;
+    r = gsb_real_mul ( a, b );
+    CU_ASSERT_EQUAL ( G_GINT64_CONSTANT(100000000000000000), r.mantissa );
+    CU_ASSERT_EQUAL ( 0, r.exponent );
+#endif
+}
+
+void gsb_real_cunit__gsb_real_accumulator ( void )
+{
+    GsbRealAccumulator accumulator;
+    GsbReal sum = null_real;
+    GsbReal r;
+    gint i;
+
+    gsb_real_accumulator_init ( &accumulator, 2 );
+    for ( i = 0 ; i < 10000 ; i++ )
+    {
+        GsbReal a = property_random_real ();
+
+        gsb_real_accumulator_add ( &accumulator, a );
+        sum = gsb_real_add ( sum, a );
+    }
+    r = gsb_real_accumulator_get_value ( &accumulator );
+    CU_ASSERT_EQUAL ( 0, gsb_real_cmp ( sum, r ) );
+    CU_ASSERT_EQUAL ( PROPERTY_EXPONENT_MAX, r.exponent );
+
+    /* the sum can exceed a gint64 during the accumulation */
+    gsb_real_accumulator_init ( &accumulator, 0 );
+    gsb_real_accumulator_add ( &accumulator, gsb_real_new ( G_MAXINT64, 0 ) );
+    gsb_real_accumulator_add ( &accumulator, gsb_real_new ( 10, 0 ) );
+    gsb_real_accumulator_add ( &accumulator, gsb_real_new ( -20, 0 ) );
+    r = gsb_real_accumulator_get_value ( &accumulator );
+#ifdef GSB_REAL_HAVE_INT128
+    CU_ASSERT_EQUAL ( G_MAXINT64 - 10, r.mantissa );
+#else
+    CU_ASSERT_EQUAL ( G_MININT64, r.mantissa );
+#endif
+
+    /* an error_real in the sum gives an error_real */
+    gsb_real_accumulator_init ( &accumulator, 2 );
+    gsb_real_accumulator_add ( &accumulator, gsb_real_new ( 100, 2 ) );
+    gsb_real_accumulator_add ( &accumulator, error_real );
+    gsb_real_accumulator_add ( &accumulator, gsb_real_new ( 100, 2 ) );
+    r = gsb_real_accumulator_get_value ( &accumulator );
+    CU_ASSERT_EQUAL ( G_MININT64, r.mantissa );
+}
+
 
 CU_pSuite gsb_real_cunit_create_suite ( void )
 {
@@ -608,11 +874,17 @@ CU_pSuite gsb_real_cunit_create_suite ( void )
     if ( ( NULL == CU_add_test( pSuite, "of gsb_real_raw_get_from_string()", gsb_real_cunit__gsb_real_raw_get_from_string ) )
       || ( NULL == CU_add_test( pSuite, "of gsb_real_raw_get_from_string() with locale", gsb_real_cunit__gsb_real_raw_get_from_string__locale ) )
       || ( NULL == CU_add_test( pSuite, "of gsb_real_raw_format_string()",   gsb_real_cunit__gsb_real_raw_format_string ) )
+      || ( NULL == CU_add_test( pSuite, "of gsb_real_raw_format_to_buffer()", gsb_real_cunit__gsb_real_raw_format_to_buffer ) )
       || ( NULL == CU_add_test( pSuite, "of gsb_real_gsb_real_normalize()",  gsb_real_cunit__gsb_real_normalize ) )
       || ( NULL == CU_add_test( pSuite, "of gsb_real_add()",                 gsb_real_cunit__gsb_real_add ) )
       || ( NULL == CU_add_test( pSuite, "of gsb_real_sub()",                 gsb_real_cunit__gsb_real_sub ) )
       || ( NULL == CU_add_test( pSuite, "of gsb_real_mul()",                 gsb_real_cunit__gsb_real_mul ) )
       || ( NULL == CU_add_test( pSuite, "of gsb_real_adjust_exponent()",     gsb_real_cunit__gsb_real_adjust_exponent ) )
+      || ( NULL == CU_add_test( pSuite, "properties of gsb_real_add()",      gsb_real_cunit__gsb_real_add_properties ) )
+      || ( NULL == CU_add_test( pSuite, "properties of gsb_real_cmp()",      gsb_real_cunit__gsb_real_cmp_properties ) )
+      || ( NULL == CU_add_test( pSuite, "properties of gsb_real_mul()",      gsb_real_cunit__gsb_real_mul_properties ) )
+      || ( NULL == CU_add_test( pSuite, "overflows of gsb_real",             gsb_real_cunit__gsb_real_overflow ) )
+      || ( NULL == CU_add_test( pSuite, "of gsb_real_accumulator",           gsb_real_cunit__gsb_real_accumulator ) )
        )
         return NULL;
 
@@ -0,0 +1,319 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                  gsb_scheduler_cunit                       */
+/*                                                                            */
+/*          https://www.grisbi.org/                                           */
+/*                                                                            */
+/*  This program is free software; you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation; either version 2 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This program is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program; if not, see <https://www.gnu.org/licenses/>.     */
+/*                                                                            */
+/* ************************************************************************** */
+
+/**
+ * \file gsb_scheduler_cunit.c
+ * cunit tests for the occurrences of the scheduled transactions
+ */
+
+#include "config.h"
+
+#include "include.h"
+
+/* START_INCLUDE */
+#include "gsb_scheduler_cunit.h"
+#include "gsb_data_scheduled.h"
+#include "gsb_scheduler.h"
+#include "gsb_scheduler_list.h"
+#include "utils_dates.h"
+/* END_INCLUDE */
+
+#define CUNIT_NB_OCCURRENCES 300
+
+/* a scheduled transaction to check */
+typedef struct _SchedulerCunitCase SchedulerCunitCase;
+struct _SchedulerCunitCase
+{
+    gint frequency;
+    gint user_interval;
+    gint user_entry;
+    gint fixed_date;
+    GDateDay day;
+    GDateMonth month;
+    GDateYear year;
+    GDateDay limit_day;         /* 0 for no limit date */
+    GDateMonth limit_month;
+    GDateYear limit_year;
+};
+
+/* START_STATIC */
+static void gsb_scheduler_cunit__gsb_data_scheduled_get_due_list ( void );
+static void gsb_scheduler_cunit__gsb_scheduler_recurrence ( void );
+static void gsb_scheduler_cunit__gsb_scheduler_recurrence_fill ( void );
+static guint gsb_scheduler_cunit_get_reference ( gint scheduled_number,
+                        guint32 *days );
+static gint gsb_scheduler_cunit_new_scheduled ( const SchedulerCunitCase *test_case );
+static int gsb_scheduler_cunit_clean_suite ( void );
+static int gsb_scheduler_cunit_init_suite ( void );
+/* END_STATIC */
+
+/* START_EXTERN */
+/* END_EXTERN */
+
+
+static const SchedulerCunitCase scheduler_cunit_cases[] =
+{
+    { SCHEDULER_PERIODICITY_ONCE_VIEW,       0, 0, 0, 12, 3, 2021, 0, 0, 0 },
+    { SCHEDULER_PERIODICITY_WEEK_VIEW,       0, 0, 0, 29, 2, 2020, 0, 0, 0 },
+    { SCHEDULER_PERIODICITY_WEEK_VIEW,       0, 0, 0, 3, 1, 2022, 31, 12, 2023 },
+    { SCHEDULER_PERIODICITY_MONTH_VIEW,      0, 0, 0, 31, 1, 2021, 0, 0, 0 },
+    { SCHEDULER_PERIODICITY_MONTH_VIEW,      0, 0, 31, 31, 1, 2021, 0, 0, 0 },
+    { SCHEDULER_PERIODICITY_MONTH_VIEW,      0, 0, 15, 2, 1, 2021, 14, 6, 2022 },
+    { SCHEDULER_PERIODICITY_MONTH_VIEW,      0, 0, 0, 30, 4, 2021, 0, 0, 0 },
+    { SCHEDULER_PERIODICITY_TWO_MONTHS_VIEW, 0, 0, 0, 31, 12, 2019, 0, 0, 0 },
+    { SCHEDULER_PERIODICITY_TWO_MONTHS_VIEW, 0, 0, 30, 30, 8, 2021, 0, 0, 0 },
+    { SCHEDULER_PERIODICITY_TRIMESTER_VIEW,  0, 0, 0, 31, 3, 2021, 0, 0, 0 },
+    { SCHEDULER_PERIODICITY_TRIMESTER_VIEW,  0, 0, 29, 29, 11, 2021, 0, 0, 0 },
+    { SCHEDULER_PERIODICITY_YEAR_VIEW,       0, 0, 0, 29, 2, 2020, 0, 0, 0 },
+    { SCHEDULER_PERIODICITY_YEAR_VIEW,       0, 0, 10, 10, 7, 2021, 10, 7, 2030 },
+    { SCHEDULER_PERIODICITY_CUSTOM_VIEW, PERIODICITY_DAYS, 10, 0, 25, 12, 2021, 0, 0, 0 },
+    { SCHEDULER_PERIODICITY_CUSTOM_VIEW, PERIODICITY_DAYS, 0, 0, 25, 12, 2021, 0, 0, 0 },
+    { SCHEDULER_PERIODICITY_CUSTOM_VIEW, PERIODICITY_WEEKS, 2, 0, 1, 3, 2021, 0, 0, 0 },
+    { SCHEDULER_PERIODICITY_CUSTOM_VIEW, PERIODICITY_MONTHS, 5, 0, 31, 5, 2021, 0, 0, 0 },
+    { SCHEDULER_PERIODICITY_CUSTOM_VIEW, PERIODICITY_MONTHS, 7, 30, 30, 1, 2021, 0, 0, 0 },
+    { SCHEDULER_PERIODICITY_CUSTOM_VIEW, PERIODICITY_YEARS, 4, 0, 29, 2, 2024, 0, 0, 0 },
+    { SCHEDULER_PERIODICITY_CUSTOM_VIEW, PERIODICITY_YEARS, 3, 0, 29, 2, 2024, 1, 1, 2040 },
+    { SCHEDULER_PERIODICITY_MONTH_VIEW,      0, 0, 0, 20, 5, 2021, 1, 5, 2021 },
+};
+
+/* The suite initialization function.
+ * Returns zero on success, non-zero otherwise.
+ */
+int gsb_scheduler_cunit_init_suite ( void )
+{
+    gsb_data_scheduled_init_variables ();
+    return 0;
+}
+
+/* The suite cleanup function, removes the scheduled transactions of the tests.
+ * Returns zero on success, non-zero otherwise.
+ */
+int gsb_scheduler_cunit_clean_suite ( void )
+{
+    gsb_data_scheduled_init_variables ();
+    return 0;
+}
+
+/**
+ * create the scheduled transaction of a case
+ *
+ * \param test_case
+ *
+ * \return the number of the scheduled transaction
+ **/
+static gint gsb_scheduler_cunit_new_scheduled ( const SchedulerCunitCase *test_case )
+{
+    GDate *date;
+    gint scheduled_number;
+
+    scheduled_number = gsb_data_scheduled_new_scheduled ();
+    date = g_date_new_dmy ( test_case -> day, test_case -> month, test_case -> year );
+    gsb_data_scheduled_set_date ( scheduled_number, date );
+    g_date_free ( date );
+    if ( test_case -> limit_day )
+    {
+        date = g_date_new_dmy ( test_case -> limit_day, test_case -> limit_month, test_case -> limit_year );
+        gsb_data_scheduled_set_limit_date ( scheduled_number, date );
+        g_date_free ( date );
+    }
+    gsb_data_scheduled_set_frequency ( scheduled_number, test_case -> frequency );
+    gsb_data_scheduled_set_user_interval ( scheduled_number, test_case -> user_interval );
+    gsb_data_scheduled_set_user_entry ( scheduled_number, test_case -> user_entry );
+    gsb_data_scheduled_set_fixed_date ( scheduled_number, test_case -> fixed_date );
+
+    return scheduled_number;
+}
+
+/**
+ * the occurrences given by gsb_scheduler_get_next_date
+ *
+ * \param scheduled_number
+ * \param days  array of CUNIT_NB_OCCURRENCES julian days
+ *
+ * \return the number of occurrences
+ **/
+static guint gsb_scheduler_cunit_get_reference ( gint scheduled_number,
+                        guint32 *days )
+{
+    GDate *date;
+    GDate *limit_date;
+    guint nb_days = 0;
+
+    limit_date = gsb_data_scheduled_get_limit_date ( scheduled_number );
+    date = gsb_date_copy ( gsb_data_scheduled_get_date ( scheduled_number ) );
+    if ( limit_date && g_date_compare ( date, limit_date ) > 0 )
+    {
+        g_date_free ( date );
+        return 0;
+    }
+
+    while ( date && nb_days < CUNIT_NB_OCCURRENCES )
+    {
+        GDate *next_date;
+
+        days[nb_days++] = g_date_get_julian ( date );
+        next_date = gsb_scheduler_get_next_date ( scheduled_number, date );
+        g_date_free ( date );
+        date = next_date;
+    }
+    if ( date )
+        g_date_free ( date );
+
+    return nb_days;
+}
+
+void gsb_scheduler_cunit__gsb_scheduler_recurrence ( void )
+{
+    guint test_case;
+
+    for ( test_case = 0 ; test_case < G_N_ELEMENTS ( scheduler_cunit_cases ) ; test_case++ )
+    {
+        GsbSchedulerRecurrence recurrence;
+        guint32 days[CUNIT_NB_OCCURRENCES];
+        guint nb_days;
+        guint32 julian_day;
+        guint i;
+        gint scheduled_number;
+
+        scheduled_number = gsb_scheduler_cunit_new_scheduled ( &scheduler_cunit_cases[test_case] );
+        nb_days = gsb_scheduler_cunit_get_reference ( scheduled_number, days );
+
+        /* all the occurrences, one after the other */
+        CU_ASSERT_TRUE ( gsb_scheduler_recurrence_init ( &recurrence, scheduled_number ) );
+        julian_day = recurrence.current_day;
+        for ( i = 0 ; i < nb_days ; i++ )
+        {
+            CU_ASSERT_EQUAL ( days[i], julian_day );
+            julian_day = gsb_scheduler_recurrence_next ( &recurrence );
+        }
+        if ( nb_days < CUNIT_NB_OCCURRENCES )
+            CU_ASSERT_EQUAL ( 0, julian_day );
+
+        /* the first occurrence from a day, before, on and after each occurrence */
+        for ( i = 0 ; i + 1 < nb_days ; i++ )
+        {
+            CU_ASSERT_EQUAL ( days[i], gsb_scheduler_recurrence_first_from ( &recurrence, days[i] - 1 ) );
+            CU_ASSERT_EQUAL ( i, recurrence.index );
+            CU_ASSERT_EQUAL ( days[i], gsb_scheduler_recurrence_first_from ( &recurrence, days[i] ) );
+            CU_ASSERT_EQUAL ( days[i + 1], gsb_scheduler_recurrence_first_from ( &recurrence, days[i] + 1 ) );
+            CU_ASSERT_EQUAL ( i + 1, recurrence.index );
+        }
+        if ( nb_days && nb_days < CUNIT_NB_OCCURRENCES )
+            CU_ASSERT_EQUAL ( 0, gsb_scheduler_recurrence_first_from ( &recurrence, days[nb_days - 1] + 1 ) );
+    }
+}
+
+void gsb_scheduler_cunit__gsb_scheduler_recurrence_fill ( void )
+{
+    GsbSchedulerRecurrence recurrence;
+    guint32 days[CUNIT_NB_OCCURRENCES];
+    guint32 filled_days[7];
+    guint nb_days;
+    guint nb_filled;
+    guint32 first_day;
+    guint32 last_day;
+    gint scheduled_number;
+
+    /* every 2 weeks, a period of 120 days filled 7 days at a time */
+    scheduled_number = gsb_scheduler_cunit_new_scheduled ( &scheduler_cunit_cases[15] );
+    nb_days = gsb_scheduler_cunit_get_reference ( scheduled_number, days );
+    CU_ASSERT_EQUAL ( CUNIT_NB_OCCURRENCES, nb_days );
+
+    first_day = days[3] + 1;
+    last_day = first_day + 120;
+    CU_ASSERT_TRUE ( gsb_scheduler_recurrence_init ( &recurrence, scheduled_number ) );
+
+    nb_filled = gsb_scheduler_recurrence_fill ( &recurrence, first_day, last_day, filled_days, 7 );
+    CU_ASSERT_EQUAL ( 7, nb_filled );
+    CU_ASSERT_EQUAL ( days[4], filled_days[0] );
+    CU_ASSERT_EQUAL ( days[10], filled_days[6] );
+    CU_ASSERT_EQUAL ( days[11], recurrence.current_day );
+
+    nb_filled = gsb_scheduler_recurrence_fill ( &recurrence, recurrence.current_day, last_day, filled_days, 7 );
+    CU_ASSERT_EQUAL ( 1, nb_filled );
+    CU_ASSERT_EQUAL ( days[11], filled_days[0] );
+
+    /* nothing in an empty period */
+    nb_filled = gsb_scheduler_recurrence_fill ( &recurrence, days[0] + 1, days[1] - 1, filled_days, 7 );
+    CU_ASSERT_EQUAL ( 0, nb_filled );
+}
+
+void gsb_scheduler_cunit__gsb_data_scheduled_get_due_list ( void )
+{
+    GDate *date;
+    GSList *due_list;
+    gint first_number;
+    gint second_number;
+    gint third_number;
+    gint child_number;
+
+    gsb_data_scheduled_init_variables ();
+
+    /* 31/01/2021, 29/02/2020 and 12/03/2021 */
+    first_number = gsb_scheduler_cunit_new_scheduled ( &scheduler_cunit_cases[3] );
+    second_number = gsb_scheduler_cunit_new_scheduled ( &scheduler_cunit_cases[1] );
+    third_number = gsb_scheduler_cunit_new_scheduled ( &scheduler_cunit_cases[0] );
+
+    /* a child of split is never given */
+    child_number = gsb_scheduler_cunit_new_scheduled ( &scheduler_cunit_cases[1] );
+    gsb_data_scheduled_set_mother_scheduled_number ( child_number, first_number );
+
+    date = g_date_new_dmy ( 31, 1, 2021 );
+    due_list = gsb_data_scheduled_get_due_list ( date );
+    CU_ASSERT_EQUAL ( 2, g_slist_length ( due_list ) );
+    CU_ASSERT_EQUAL ( second_number, GPOINTER_TO_INT ( g_slist_nth_data ( due_list, 0 ) ) );
+    CU_ASSERT_EQUAL ( first_number, GPOINTER_TO_INT ( g_slist_nth_data ( due_list, 1 ) ) );
+    g_slist_free ( due_list );
+
+    /* the index follows the change of date */
+    g_date_set_dmy ( date, 1, 1, 2019 );
+    gsb_data_scheduled_set_date ( third_number, date );
+    g_date_set_dmy ( date, 31, 1, 2021 );
+    due_list = gsb_data_scheduled_get_due_list ( date );
+    CU_ASSERT_EQUAL ( 3, g_slist_length ( due_list ) );
+    CU_ASSERT_EQUAL ( third_number, GPOINTER_TO_INT ( g_slist_nth_data ( due_list, 0 ) ) );
+    g_slist_free ( due_list );
+
+    /* nothing before the first date */
+    g_date_set_dmy ( date, 31, 12, 2018 );
+    CU_ASSERT_PTR_NULL ( gsb_data_scheduled_get_due_list ( date ) );
+    g_date_free ( date );
+
+    gsb_data_scheduled_init_variables ();
+}
+
+
+CU_pSuite gsb_scheduler_cunit_create_suite ( void )
+{
+    CU_pSuite pSuite = CU_add_suite("gsb_scheduler",
+                                    gsb_scheduler_cunit_init_suite,
+                                    gsb_scheduler_cunit_clean_suite);
+    if ( NULL == pSuite )
+        return NULL;
+
+    if ( ( NULL == CU_add_test( pSuite, "of gsb_scheduler_recurrence", gsb_scheduler_cunit__gsb_scheduler_recurrence ) )
+      || ( NULL == CU_add_test( pSuite, "of gsb_scheduler_recurrence_fill()", gsb_scheduler_cunit__gsb_scheduler_recurrence_fill ) )
+      || ( NULL == CU_add_test( pSuite, "of gsb_data_scheduled_get_due_list()", gsb_scheduler_cunit__gsb_data_scheduled_get_due_list ) )
+       )
+        return NULL;
+
+    return pSuite;
+}
@@ -0,0 +1,358 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                  gsb_search_index_cunit                    */
+/*                                                                            */
+/*          https://www.grisbi.org/                                           */
+/*                                                                            */
+/*  This program is free software; you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation; either version 2 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This program is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program; if not, see <https://www.gnu.org/licenses/>.     */
+/*                                                                            */
+/* ************************************************************************** */
+
+/**
+ * \file gsb_search_index_cunit.c
+ * cunit tests for the index of the search of transactions
+ */
+
+#include "config.h"
+
+#include "include.h"
+
+/* START_INCLUDE */
+#include "gsb_search_index_cunit.h"
+#include "gsb_data_account.h"
+#include "gsb_data_currency.h"
+#include "gsb_data_transaction.h"
+#include "gsb_real.h"
+#include "gsb_search_index.h"
+#include "structures.h"
+/* END_INCLUDE */
+
+/* START_STATIC */
+static void gsb_search_index_cunit__gsb_search_index_find ( void );
+static void gsb_search_index_cunit__gsb_search_index_find_amount ( void );
+static void gsb_search_index_cunit__gsb_search_index_mark_transaction ( void );
+static gboolean gsb_search_index_cunit_array_contains ( GArray *numbers,
+                        gint transaction_number );
+static gint gsb_search_index_cunit_new_transaction ( gint account_number,
+                        gint currency_number,
+                        gint64 mantissa );
+static int gsb_search_index_cunit_clean_suite ( void );
+static int gsb_search_index_cunit_init_suite ( void );
+/* END_STATIC */
+
+/* START_EXTERN */
+/* END_EXTERN */
+
+
+/* The suite initialization function.
+ * Returns zero on success, non-zero otherwise.
+ */
+int gsb_search_index_cunit_init_suite ( void )
+{
+    /* the accounts and transactions of the other suites, the index is reset */
+    gsb_data_transaction_init_variables ();
+    gsb_data_account_init_variables ();
+
+    return 0;
+}
+
+/* The suite cleanup function.
+ * Returns zero on success, non-zero otherwise.
+ */
+int gsb_search_index_cunit_clean_suite ( void )
+{
+    gsb_data_transaction_init_variables ();
+    gsb_data_account_init_variables ();
+
+    return 0;
+}
+
+/**
+ * create a transaction with an amount with 2 decimals
+ *
+ * \param account_number
+ * \param currency_number
+ * \param mantissa
+ *
+ * \return the number of the transaction
+ **/
+gint gsb_search_index_cunit_new_transaction ( gint account_number,
+                        gint currency_number,
+                        gint64 mantissa )
+{
+    GsbReal amount = { mantissa, 2 };
+    GDate *date;
+    gint transaction_number;
+
+    date = g_date_new_dmy ( 15, 3, 2024 );
+    transaction_number = gsb_data_transaction_new_transaction ( account_number );
+    gsb_data_transaction_set_currency_number ( transaction_number, currency_number );
+    gsb_data_transaction_set_amount ( transaction_number, amount );
+    gsb_data_transaction_set_date ( transaction_number, date );
+    g_date_free ( date );
+
+    return transaction_number;
+}
+
+/**
+ * check that a transaction is in the result of gsb_search_index_find_amount
+ *
+ * \param numbers
+ * \param transaction_number
+ *
+ * \return TRUE if found
+ **/
+gboolean gsb_search_index_cunit_array_contains ( GArray *numbers,
+                        gint transaction_number )
+{
+    guint i;
+
+    for ( i = 0 ; i < numbers -> len ; i++ )
+        if ( g_array_index ( numbers, gint, i ) == transaction_number )
+            return TRUE;
+
+    return FALSE;
+}
+
+void gsb_search_index_cunit__gsb_search_index_find ( void )
+{
+    GHashTable *result;
+    gint account_number;
+    gint cafe_number;
+    gint cafeteria_number;
+    gint cheque_number;
+
+    account_number = gsb_data_account_new ( GSB_TYPE_BANK );
+
+    cafe_number = gsb_data_transaction_new_transaction ( account_number );
+    gsb_data_transaction_set_notes ( cafe_number, "Café-Restaurant L'ÉTÉ 2024" );
+    cafeteria_number = gsb_data_transaction_new_transaction ( account_number );
+    gsb_data_transaction_set_notes ( cafeteria_number, "cafeteria" );
+    cheque_number = gsb_data_transaction_new_transaction ( account_number );
+    gsb_data_transaction_set_notes ( cheque_number, "Ref ABC123" );
+    gsb_data_transaction_set_method_of_payment_content ( cheque_number, "001234" );
+
+    /* a text without letters or digits can't use the index */
+    CU_ASSERT_PTR_NULL ( gsb_search_index_find ( " -- ' ", SEARCH_FIELD_NOTES ) );
+
+    /* the case and the accents are folded, in the text and in the search */
+    result = gsb_search_index_find ( "CAFÉ", SEARCH_FIELD_NOTES );
+    CU_ASSERT_PTR_NOT_NULL_FATAL ( result );
+    CU_ASSERT_EQUAL ( 2, g_hash_table_size ( result ) );
+    CU_ASSERT ( g_hash_table_contains ( result, GINT_TO_POINTER ( cafe_number ) ) );
+    CU_ASSERT ( g_hash_table_contains ( result, GINT_TO_POINTER ( cafeteria_number ) ) );
+    g_hash_table_destroy ( result );
+
+    /* a part of a word is found inside the words, each word of the search
+     * must be in the transaction */
+    result = gsb_search_index_find ( "été", SEARCH_FIELD_NOTES );
+    CU_ASSERT_EQUAL ( 2, g_hash_table_size ( result ) );
+    g_hash_table_destroy ( result );
+    result = gsb_search_index_find ( "ete 2024", SEARCH_FIELD_NOTES );
+    CU_ASSERT_EQUAL ( 1, g_hash_table_size ( result ) );
+    CU_ASSERT ( g_hash_table_contains ( result, GINT_TO_POINTER ( cafe_number ) ) );
+    g_hash_table_destroy ( result );
+
+    /* the separators cut the words, the letters and the digits make separate words */
+    result = gsb_search_index_find ( "restaurant,l", SEARCH_FIELD_NOTES );
+    CU_ASSERT_EQUAL ( 1, g_hash_table_size ( result ) );
+    g_hash_table_destroy ( result );
+    result = gsb_search_index_find ( "abc123", SEARCH_FIELD_NOTES );
+    CU_ASSERT_EQUAL ( 1, g_hash_table_size ( result ) );
+    CU_ASSERT ( g_hash_table_contains ( result, GINT_TO_POINTER ( cheque_number ) ) );
+    g_hash_table_destroy ( result );
+    result = gsb_search_index_find ( "c1", SEARCH_FIELD_NOTES );
+    CU_ASSERT_EQUAL ( 1, g_hash_table_size ( result ) );
+    g_hash_table_destroy ( result );
+    result = gsb_search_index_find ( "refabc", SEARCH_FIELD_NOTES );
+    CU_ASSERT_EQUAL ( 0, g_hash_table_size ( result ) );
+    g_hash_table_destroy ( result );
+
+    /* only the fields searched */
+    result = gsb_search_index_find ( "1234", SEARCH_FIELD_CHEQUE );
+    CU_ASSERT_EQUAL ( 1, g_hash_table_size ( result ) );
+    CU_ASSERT ( g_hash_table_contains ( result, GINT_TO_POINTER ( cheque_number ) ) );
+    g_hash_table_destroy ( result );
+    result = gsb_search_index_find ( "1234", SEARCH_FIELD_NOTES );
+    CU_ASSERT_EQUAL ( 0, g_hash_table_size ( result ) );
+    g_hash_table_destroy ( result );
+    result = gsb_search_index_find ( "1234", SEARCH_FIELD_NOTES | SEARCH_FIELD_CHEQUE );
+    CU_ASSERT_EQUAL ( 1, g_hash_table_size ( result ) );
+    g_hash_table_destroy ( result );
+}
+
+void gsb_search_index_cunit__gsb_search_index_mark_transaction ( void )
+{
+    GHashTable *result;
+    gint account_number;
+    gint first_number;
+    gint second_number;
+    gint new_number;
+
+    /* the index is built here, then only the marked transactions are read again */
+    gsb_data_transaction_init_variables ();
+    account_number = gsb_data_account_new ( GSB_TYPE_BANK );
+    first_number = gsb_data_transaction_new_transaction ( account_number );
+    gsb_data_transaction_set_notes ( first_number, "cafeteria" );
+    second_number = gsb_data_transaction_new_transaction ( account_number );
+    gsb_data_transaction_set_notes ( second_number, "cafeteria" );
+
+    result = gsb_search_index_find ( "teri", SEARCH_FIELD_NOTES );
+    CU_ASSERT_EQUAL ( 2, g_hash_table_size ( result ) );
+    g_hash_table_destroy ( result );
+
+    /* a word still used by another transaction stays in the index */
+    gsb_data_transaction_set_notes ( first_number, "Boulangerie" );
+    result = gsb_search_index_find ( "teri", SEARCH_FIELD_NOTES );
+    CU_ASSERT_EQUAL ( 1, g_hash_table_size ( result ) );
+    CU_ASSERT ( g_hash_table_contains ( result, GINT_TO_POINTER ( second_number ) ) );
+    g_hash_table_destroy ( result );
+    result = gsb_search_index_find ( "boulang", SEARCH_FIELD_NOTES );
+    CU_ASSERT_EQUAL ( 1, g_hash_table_size ( result ) );
+    CU_ASSERT ( g_hash_table_contains ( result, GINT_TO_POINTER ( first_number ) ) );
+    g_hash_table_destroy ( result );
+
+    /* the last use of a word removes it with its n-grams */
+    gsb_data_transaction_set_notes ( second_number, NULL );
+    result = gsb_search_index_find ( "teri", SEARCH_FIELD_NOTES );
+    CU_ASSERT_EQUAL ( 0, g_hash_table_size ( result ) );
+    g_hash_table_destroy ( result );
+    result = gsb_search_index_find ( "ter", SEARCH_FIELD_NOTES );
+    CU_ASSERT_EQUAL ( 0, g_hash_table_size ( result ) );
+    g_hash_table_destroy ( result );
+
+    /* a new transaction is indexed, the word comes back */
+    new_number = gsb_data_transaction_new_transaction ( account_number );
+    gsb_data_transaction_set_notes ( new_number, "Cafétéria" );
+    result = gsb_search_index_find ( "teri", SEARCH_FIELD_NOTES );
+    CU_ASSERT_EQUAL ( 1, g_hash_table_size ( result ) );
+    CU_ASSERT ( g_hash_table_contains ( result, GINT_TO_POINTER ( new_number ) ) );
+    g_hash_table_destroy ( result );
+}
+
+void gsb_search_index_cunit__gsb_search_index_find_amount ( void )
+{
+    GArray *result;
+    gint account_number;
+    gint euro_number;
+    gint dollar_number;
+    gint yen_number;
+    gint debit_number;
+    gint credit_number;
+    gint near_number;
+    gint far_number;
+    gint dollar_transaction_number;
+
+    euro_number = gsb_data_currency_new ( "EUR" );
+    gsb_data_currency_set_floating_point ( euro_number, 2 );
+    dollar_number = gsb_data_currency_new ( "USD" );
+    gsb_data_currency_set_floating_point ( dollar_number, 2 );
+    yen_number = gsb_data_currency_new ( "JPY" );
+    gsb_data_currency_set_floating_point ( yen_number, 0 );
+
+    account_number = gsb_data_account_new ( GSB_TYPE_BANK );
+    gsb_data_account_set_currency ( account_number, euro_number );
+
+    debit_number = gsb_search_index_cunit_new_transaction ( account_number, euro_number, -1234 );
+    credit_number = gsb_search_index_cunit_new_transaction ( account_number, euro_number, 1234 );
+    near_number = gsb_search_index_cunit_new_transaction ( account_number, euro_number, 1500 );
+    far_number = gsb_search_index_cunit_new_transaction ( account_number, euro_number, 10000 );
+    dollar_transaction_number = gsb_search_index_cunit_new_transaction ( account_number, dollar_number, 5500 );
+
+    /* 12.34 without sign : the debit and the credit, and the transaction in
+     * another currency which is always returned */
+    result = gsb_search_index_find_amount ( account_number,
+                        gsb_real_new ( 1234, 2 ),
+                        gsb_real_new ( 1234, 2 ) );
+    CU_ASSERT_EQUAL ( 3, result -> len );
+    CU_ASSERT ( gsb_search_index_cunit_array_contains ( result, debit_number ) );
+    CU_ASSERT ( gsb_search_index_cunit_array_contains ( result, credit_number ) );
+    CU_ASSERT ( gsb_search_index_cunit_array_contains ( result, dollar_transaction_number ) );
+    g_array_unref ( result );
+
+    /* -12.34 with a delta of 3.00 : the caller keeps the sign, the index
+     * gives the absolute amounts from 9.34 to 15.34 */
+    result = gsb_search_index_find_amount ( account_number,
+                        gsb_real_new ( 934, 2 ),
+                        gsb_real_new ( 1534, 2 ) );
+    CU_ASSERT_EQUAL ( 4, result -> len );
+    CU_ASSERT ( gsb_search_index_cunit_array_contains ( result, debit_number ) );
+    CU_ASSERT ( gsb_search_index_cunit_array_contains ( result, credit_number ) );
+    CU_ASSERT ( gsb_search_index_cunit_array_contains ( result, near_number ) );
+    CU_ASSERT ( !gsb_search_index_cunit_array_contains ( result, far_number ) );
+    g_array_unref ( result );
+
+    /* the edit of an amount moves the transaction in the index */
+    gsb_data_transaction_set_amount ( near_number, gsb_real_new ( -9950, 2 ) );
+    result = gsb_search_index_find_amount ( account_number,
+                        gsb_real_new ( 934, 2 ),
+                        gsb_real_new ( 1534, 2 ) );
+    CU_ASSERT_EQUAL ( 3, result -> len );
+    CU_ASSERT ( !gsb_search_index_cunit_array_contains ( result, near_number ) );
+    g_array_unref ( result );
+
+    result = gsb_search_index_find_amount ( account_number,
+                        gsb_real_new ( 9900, 2 ),
+                        gsb_real_new ( 10100, 2 ) );
+    CU_ASSERT_EQUAL ( 3, result -> len );
+    CU_ASSERT ( gsb_search_index_cunit_array_contains ( result, near_number ) );
+    CU_ASSERT ( gsb_search_index_cunit_array_contains ( result, far_number ) );
+    CU_ASSERT ( gsb_search_index_cunit_array_contains ( result, dollar_transaction_number ) );
+    g_array_unref ( result );
+
+    /* the currency of the account changes : the index is built again and the
+     * transactions in euros are now in another currency than the account */
+    gsb_data_account_set_currency ( account_number, yen_number );
+    result = gsb_search_index_find_amount ( account_number,
+                        gsb_real_new ( 12, 0 ),
+                        gsb_real_new ( 12, 0 ) );
+    CU_ASSERT_EQUAL ( 5, result -> len );
+    g_array_unref ( result );
+
+    /* the transactions in yens are at the exponent of the yen */
+    gsb_data_transaction_set_currency_number ( debit_number, yen_number );
+    gsb_data_transaction_set_currency_number ( credit_number, yen_number );
+    gsb_data_transaction_set_currency_number ( far_number, yen_number );
+    result = gsb_search_index_find_amount ( account_number,
+                        gsb_real_new ( 12, 0 ),
+                        gsb_real_new ( 12, 0 ) );
+    CU_ASSERT_EQUAL ( 4, result -> len );
+    CU_ASSERT ( gsb_search_index_cunit_array_contains ( result, debit_number ) );
+    CU_ASSERT ( gsb_search_index_cunit_array_contains ( result, credit_number ) );
+    CU_ASSERT ( gsb_search_index_cunit_array_contains ( result, near_number ) );
+    CU_ASSERT ( gsb_search_index_cunit_array_contains ( result, dollar_transaction_number ) );
+    CU_ASSERT ( !gsb_search_index_cunit_array_contains ( result, far_number ) );
+    g_array_unref ( result );
+
+    gsb_data_currency_remove ( euro_number );
+    gsb_data_currency_remove ( dollar_number );
+    gsb_data_currency_remove ( yen_number );
+}
+
+CU_pSuite gsb_search_index_cunit_create_suite ( void )
+{
+    CU_pSuite pSuite = CU_add_suite ( "gsb_search_index",
+                        gsb_search_index_cunit_init_suite,
+                        gsb_search_index_cunit_clean_suite );
+    if ( NULL == pSuite )
+        return NULL;
+
+    if ( ( NULL == CU_add_test ( pSuite, "of gsb_search_index_find()", gsb_search_index_cunit__gsb_search_index_find ) )
+         || ( NULL == CU_add_test ( pSuite, "of gsb_search_index_mark_transaction()", gsb_search_index_cunit__gsb_search_index_mark_transaction ) )
+         || ( NULL == CU_add_test ( pSuite, "of gsb_search_index_find_amount()", gsb_search_index_cunit__gsb_search_index_find_amount ) )
+       )
+        return NULL;
+
+    return pSuite;
+}
@@ -36,8 +36,15 @@
 #include <CUnit/Automated.h>
 #include <CUnit/Basic.h>
 #include <gtk/gtk.h>
+#include "bet_consolidated_cunit.h"
+#include "bet_data_finance_cunit.h"
+#include "bet_forecast_cunit.h"
+#include "bet_hist_cube_cunit.h"
 #include "gsb_data_account_cunit.h"
+#include "gsb_data_transaction_cunit.h"
 #include "gsb_real_cunit.h"
+#include "gsb_scheduler_cunit.h"
+#include "gsb_search_index_cunit.h"
 #include "utils_dates_cunit.h"
 #include "utils_real_cunit.h"
 #include "structures.h"
@@ -73,6 +80,13 @@ int main(int argc, char** argv)
 	utils_dates_cunit_create_suite();
 	gsb_data_account_cunit_create_suite();
 	gsb_real_cunit_create_suite();
+	gsb_scheduler_cunit_create_suite();
+	bet_consolidated_cunit_create_suite();
+	gsb_data_transaction_cunit_create_suite();
+	bet_forecast_cunit_create_suite();
+	bet_data_finance_cunit_create_suite();
+	gsb_search_index_cunit_create_suite();
+	bet_hist_cube_cunit_create_suite();
 
 	CU_basic_run_tests();
 
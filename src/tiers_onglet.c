@@ -840,11 +840,11 @@ GtkWidget *payees_create_list (void)
 	gtk_cell_renderer_set_padding (GTK_CELL_RENDERER (cell), MARGIN_BOX, 0);
 	column = gtk_tree_view_column_new_with_attributes (_("Amount"),
 													   cell,
-													   "text", META_TREE_BALANCE_COLUMN,
 													   "weight", META_TREE_FONT_COLUMN,
 													   "xalign", META_TREE_XALIGN_COLUMN,
 													   "cell-background-rgba", META_TREE_BACKGROUND_COLOR,
 													   NULL);
+	gtk_tree_view_column_set_cell_data_func (column, cell, metatree_balance_cell_data_func, NULL, NULL);
     gtk_tree_view_append_column (GTK_TREE_VIEW (payee_tree), GTK_TREE_VIEW_COLUMN (column));
     gtk_tree_view_column_set_alignment (column, COLUMN_RIGHT);
     gtk_container_add (GTK_CONTAINER (scroll_window), payee_tree);
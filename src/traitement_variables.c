@@ -66,6 +66,7 @@
 #include "gsb_data_report_text_comparison.h"
 #include "gsb_data_scheduled.h"
 #include "gsb_data_transaction.h"
+#include "gsb_file_archive_segment.h"
 #include "gsb_form_scheduler.h"
 #include "gsb_form_widget.h"
 #include "gsb_fyear.h"
@@ -135,6 +136,8 @@ void init_variables (void)
      * erase now */
     transaction_model_set_model (NULL);
 
+    /* the archive segment of the previous file must not be loaded now */
+    gsb_file_archive_segment_init_variables ();
     gsb_data_account_init_variables ();
     gsb_data_transaction_init_variables ();
     gsb_data_payee_init_variables (TRUE);
@@ -297,6 +300,7 @@ void free_variables (void)
 	/* free functions */
     gsb_data_archive_init_variables ();
     gsb_data_archive_store_init_variables ();
+    gsb_file_archive_segment_init_variables ();
     gsb_data_bank_init_variables ();
     gsb_data_budget_init_variables (FALSE);
     gsb_data_category_init_variables (FALSE);
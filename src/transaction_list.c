@@ -63,6 +63,9 @@
 /* this is a buffer which contains the last mother appended, to increase
  * the speed when filling the list and adding children */
 static CustomRecord *last_mother_appended = NULL;
+
+static void transaction_list_append_mother (gint transaction_number,
+                                            gboolean batch);
 /*END_STATIC*/
 
 /*START_EXTERN*/
@@ -423,14 +426,18 @@ gboolean transaction_list_create (void)
 
 
 /**
- * append a transaction to the list
- * that transaction can be a mother or a child (split)
+ * append a mother transaction to the list
+ * this function is called internally by transaction_list_append_transaction
+ * and transaction_list_append_transactions
  *
  * \param transaction_number    the transaction to append
+ * \param batch                 TRUE if the arrays of the list are already big enough
+ *                              and the tree view will be filtered later
  *
  * \return
  * */
-void transaction_list_append_transaction (gint transaction_number)
+static void transaction_list_append_mother (gint transaction_number,
+                                            gboolean batch)
 {
     gulong newsize;
     guint pos;
@@ -446,17 +453,11 @@ void transaction_list_append_transaction (gint transaction_number)
 
     custom_list = transaction_model_get_model ();
 
-    g_return_if_fail (custom_list != NULL);
-
-    /* if this is a child, go to append_child_record */
-    if (gsb_data_transaction_get_mother_transaction_number (transaction_number))
-    {
-        transaction_list_append_child (transaction_number);
-        return;
-    }
-
-    /* the transaction is a mother */
-    account_number = gsb_gui_navigation_get_current_account ();
+    /* in batch mode, the rows are not shown here, the list will be filtered after */
+    if (batch)
+        account_number = -1;
+    else
+        account_number = gsb_gui_navigation_get_current_account ();
 
     /* if the transaction is a split, create a white line, we will append it later */
     if (gsb_data_transaction_get_split_of_transaction (transaction_number))
@@ -501,12 +502,17 @@ void transaction_list_append_transaction (gint transaction_number)
     /* we add the 4 rows of the transaction in one time,
      * so increase 4*sizeof (CustomRecord *) */
     custom_list->num_rows = custom_list->num_rows + TRANSACTION_LIST_ROWS_NB;
-    newsize = custom_list->num_rows * sizeof(CustomRecord*);
-    custom_list->rows = g_realloc(custom_list->rows, newsize);
 
-    /* increase too the size of visibles rows, either if that row is not visible,
-     * it's the only way to be sure to never go throw the end while filtering */
-    custom_list->visibles_rows = g_realloc(custom_list->visibles_rows, newsize);
+    /* in batch mode, the tables were increased for all the batch before */
+    if (!batch)
+    {
+        newsize = custom_list->num_rows * sizeof(CustomRecord*);
+        custom_list->rows = g_realloc(custom_list->rows, newsize);
+
+        /* increase too the size of visibles rows, either if that row is not visible,
+         * it's the only way to be sure to never go throw the end while filtering */
+        custom_list->visibles_rows = g_realloc(custom_list->visibles_rows, newsize);
+    }
 
     /* now we can save the 4 new rows, ie the complete transaction */
     for (i=0 ; i<TRANSACTION_LIST_ROWS_NB ; i++)
@@ -600,6 +606,88 @@ void transaction_list_append_transaction (gint transaction_number)
 }
 
 
+/**
+ * append a transaction to the list
+ * that transaction can be a mother or a child (split)
+ *
+ * \param transaction_number    the transaction to append
+ *
+ * \return
+ * */
+void transaction_list_append_transaction (gint transaction_number)
+{
+    CustomList *custom_list;
+
+    custom_list = transaction_model_get_model ();
+
+    g_return_if_fail (custom_list != NULL);
+
+    /* if this is a child, go to append_child_record */
+    if (gsb_data_transaction_get_mother_transaction_number (transaction_number))
+    {
+        transaction_list_append_child (transaction_number);
+        return;
+    }
+
+    /* the transaction is a mother */
+    transaction_list_append_mother (transaction_number, FALSE);
+}
+
+
+/**
+ * append a batch of transactions to the list, used by the import
+ * the tables of the list are increased only one time for all the batch
+ * and the tree view is not informed : the rows will be shown by the next
+ * call to transaction_list_filter (usually by gsb_transactions_list_update_tree_view)
+ *
+ * \param transactions_numbers    a list of transactions numbers (GINT_TO_POINTER)
+ *
+ * \return
+ * */
+void transaction_list_append_transactions (GSList *transactions_numbers)
+{
+    GSList *tmp_list;
+    gulong newsize;
+    gint nb_mothers = 0;
+    CustomList *custom_list;
+
+    custom_list = transaction_model_get_model ();
+
+    g_return_if_fail (custom_list != NULL);
+
+    /* count the mothers to increase the tables in one time */
+    tmp_list = transactions_numbers;
+    while (tmp_list)
+    {
+        if (!gsb_data_transaction_get_mother_transaction_number (GPOINTER_TO_INT (tmp_list->data)))
+            nb_mothers++;
+        tmp_list = tmp_list->next;
+    }
+
+    if (nb_mothers)
+    {
+        newsize = (custom_list->num_rows + nb_mothers * TRANSACTION_LIST_ROWS_NB) * sizeof(CustomRecord*);
+        custom_list->rows = g_realloc(custom_list->rows, newsize);
+        custom_list->visibles_rows = g_realloc(custom_list->visibles_rows, newsize);
+    }
+
+    tmp_list = transactions_numbers;
+    while (tmp_list)
+    {
+        gint transaction_number;
+
+        transaction_number = GPOINTER_TO_INT (tmp_list->data);
+
+        if (gsb_data_transaction_get_mother_transaction_number (transaction_number))
+            transaction_list_append_child (transaction_number);
+        else
+            transaction_list_append_mother (transaction_number, TRUE);
+
+        tmp_list = tmp_list->next;
+    }
+}
+
+
 /**
  * append an archive to the list
  * create the CustomList if still not created
@@ -1238,6 +1326,10 @@ void transaction_list_set_balances (void)
     GtkTreeIter iter;
     GtkTreePath *path;
     gpointer last_transaction_pointer = NULL;
+    gchar balance_str[GSB_REAL_FORMAT_BUF_SIZE];
+    gchar *amount_color;
+    gchar *positive_color;
+    gchar *negative_color;
     CustomList *custom_list;
 
     custom_list = transaction_model_get_model ();
@@ -1272,6 +1364,10 @@ void transaction_list_set_balances (void)
     /* get the beginning balance */
     current_total = gsb_transactions_list_get_solde_debut_affichage (account_number, floating_point);
 
+    /* the colors of the balances, shared by the rows */
+    positive_color = gsb_rgba_get_couleur_with_indice_to_str ("text_color", 0);
+    negative_color = gsb_rgba_get_couleur_with_indice_to_str ("text_color", 1);
+
     for (i=0 ; i < custom_list->num_visibles_rows ; i++)
     {
         CustomRecord *record;
@@ -1306,12 +1402,22 @@ void transaction_list_set_balances (void)
 
         /* calculate the new balance */
         current_total = gsb_real_add (current_total, amount);
-        record->visible_col[column_balance] = utils_real_get_string_with_currency (current_total,
-                                                 currency_number , TRUE);
+        utils_real_write_string_with_currency (current_total, currency_number, TRUE,
+                                               balance_str, sizeof (balance_str));
         if (current_total.mantissa >= 0)
-            record->amount_color = gsb_rgba_get_couleur_with_indice_to_str ("text_color", 0);
+            amount_color = positive_color;
         else
-            record->amount_color = gsb_rgba_get_couleur_with_indice_to_str ("text_color", 1);
+            amount_color = negative_color;
+
+        /* the row is unchanged */
+        if (record->visible_col[column_balance]
+            && !strcmp (record->visible_col[column_balance], balance_str)
+            && !g_strcmp0 (record->amount_color, amount_color))
+            continue;
+
+        g_free (record->visible_col[column_balance]);
+        record->visible_col[column_balance] = g_strdup (balance_str);
+        record->amount_color = amount_color;
 
         /* inform the tree view the row has changed */
         /* set the iter */
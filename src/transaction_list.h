@@ -9,6 +9,7 @@
 /* START_DECLARATION */
 void		transaction_list_append_archive				(gint archive_store_number);
 void		transaction_list_append_transaction			(gint transaction_number);
+void		transaction_list_append_transactions		(GSList *transactions_numbers);
 gboolean 	transaction_list_check_line_is_visible		(gint line_in_transaction,
 														 gint visibles_lines);
 void		transaction_list_colorize					(void);
@@ -32,6 +32,7 @@
 #include "gsb_data_budget.h"
 #include "gsb_data_category.h"
 #include "gsb_data_payee.h"
+#include "gsb_data_transaction.h"
 #include "imputation_budgetaire.h"
 #include "meta_budgetary.h"
 #include "meta_categories.h"
@@ -66,6 +67,9 @@ void update_transaction_in_trees ( gint transaction_number )
 {
     devel_debug_int (transaction_number);
 
+    /* only the transactions modified since the last time are counted again */
+    gsb_data_transaction_update_counters ();
+
     update_transaction_in_categ_tree ( transaction_number );
     update_transaction_in_payee_tree ( transaction_number );
     update_transaction_in_budgetary_line_tree ( transaction_number );
@@ -100,8 +104,6 @@ void update_transaction_in_categ_tree ( gint transaction_number )
     MetatreeInterface *category_interface;
 
     category_interface = category_get_metatree_interface ( );
-    /* FIXME: Kludgeish, we should maintain a state. */
-    gsb_data_category_update_counters ( );
     update_transaction_in_tree ( category_interface,
                                  GTK_TREE_MODEL ( categories_get_tree_store ( ) ),
                                  transaction_number );
@@ -118,8 +120,6 @@ void update_transaction_in_budgetary_line_tree ( gint transaction_number )
     MetatreeInterface *budgetary_interface;
 
     budgetary_interface = budgetary_line_get_metatree_interface ( );
-    /* FIXME: Kludgeish, we should maintain a state. */
-    gsb_data_budget_update_counters ( );
     update_transaction_in_tree ( budgetary_interface,
                         GTK_TREE_MODEL ( budgetary_lines_get_tree_store ( ) ),
                         transaction_number );
@@ -136,8 +136,6 @@ void update_transaction_in_payee_tree ( gint transaction_number )
     MetatreeInterface *payee_interface;
 
     payee_interface = payee_get_metatree_interface ( );
-    /* FIXME: Kludgeish, we should maintain a state. */
-    gsb_data_payee_update_counters ();
     update_transaction_in_tree ( payee_interface,
                         GTK_TREE_MODEL ( payees_get_tree_store ( ) ),
                         transaction_number );
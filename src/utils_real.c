@@ -33,6 +33,82 @@
 /*START_EXTERN*/
 /*END_EXTERN*/
 
+/* format of the amounts of a currency for utils_real_write_string_with_currency */
+typedef struct _UtilsRealCurrencyFormat		UtilsRealCurrencyFormat;
+struct _UtilsRealCurrencyFormat
+{
+    gchar *currency_symbol;		/* the symbol used to build format, NULL for none */
+    guint locale_serial;		/* the serial of the locale used to build format */
+    GsbRealFormat format;
+};
+
+/* the formats by currency number, 0 for the amounts without symbol */
+static GHashTable *currency_formats = NULL;
+
+/******************************************************************************/
+/* Private functions                                                          */
+/******************************************************************************/
+/**
+ * free a UtilsRealCurrencyFormat
+ *
+ * \param data
+ *
+ * \return
+ **/
+static void utils_real_currency_format_free (gpointer data)
+{
+    UtilsRealCurrencyFormat *currency_format = data;
+
+    g_free (currency_format->currency_symbol);
+    g_free (currency_format);
+}
+
+/**
+ * return the format of a currency, built again only when the currency
+ * symbol or the separators of the locale have changed
+ *
+ * \param currency_number	0 for the amounts without symbol
+ * \param currency_symbol	the symbol of the currency or NULL
+ * \param locale
+ *
+ * \return the format, owned by the cache
+ **/
+static const GsbRealFormat *utils_real_get_currency_format (gint currency_number,
+															const gchar *currency_symbol,
+															struct lconv *locale)
+{
+    UtilsRealCurrencyFormat *currency_format;
+
+    if (!currency_formats)
+        currency_formats = g_hash_table_new_full (g_direct_hash,
+                                                  g_direct_equal,
+                                                  NULL,
+                                                  utils_real_currency_format_free);
+
+    currency_format = g_hash_table_lookup (currency_formats, GINT_TO_POINTER (currency_number));
+    if (currency_format
+        && currency_format->locale_serial == gsb_locale_get_serial ()
+        && g_strcmp0 (currency_format->currency_symbol, currency_symbol) == 0)
+        return &currency_format->format;
+
+    if (!currency_format)
+    {
+        currency_format = g_malloc0 (sizeof (UtilsRealCurrencyFormat));
+        g_hash_table_insert (currency_formats, GINT_TO_POINTER (currency_number), currency_format);
+    }
+
+    g_free (currency_format->currency_symbol);
+    currency_format->currency_symbol = g_strdup (currency_symbol);
+    currency_format->locale_serial = gsb_locale_get_serial ();
+    gsb_real_format_init (&currency_format->format, locale, currency_symbol);
+
+    return &currency_format->format;
+}
+
+/******************************************************************************/
+/* Public functions                                                           */
+/******************************************************************************/
+
 
 /**
  * Return the real in a formatted string, according to the currency
@@ -82,22 +158,28 @@ gchar *utils_real_get_string_intl ( GsbReal number )
 }
 
 /**
- * Return the real in a formatted string with an optional currency
- * symbol, according to the locale regarding decimal separator,
+ * Write the real in the buffer given by the caller with an optional
+ * currency symbol, according to the locale regarding decimal separator,
  * thousands separator and positive or negative sign.
+ * Nothing is allocated : the separators and the symbol of each currency
+ * are prepared once, so this is the function to use to fill many cells.
  *
  * \param number		Number to format.
  * \param currency_number 	the currency we want to adapt the number, 0 for no adaptation
  * \param show_symbol 		TRUE to add the currency symbol in the string
+ * \param buffer			the buffer which receives the string
+ * \param buffer_size		size of buffer, GSB_REAL_FORMAT_BUF_SIZE is always enough
  *
- * \return		A newly allocated string of the number (this
- *			function will never return NULL)
+ * \return		buffer
  */
-gchar *utils_real_get_string_with_currency ( GsbReal number,
+gchar *utils_real_write_string_with_currency ( GsbReal number,
                         gint currency_number,
-                        gboolean show_symbol )
+                        gboolean show_symbol,
+                        gchar *buffer,
+                        gsize buffer_size )
 {
     struct lconv *locale = gsb_locale_get_locale ( );
+    const GsbRealFormat *format;
     gint floating_point;
 
     const gchar *currency_symbol = (currency_number && show_symbol)
@@ -107,28 +189,28 @@ gchar *utils_real_get_string_with_currency ( GsbReal number,
     /* First of all if number = 0 I return 0 with the symbol of the currency if necessary */
     if (number.mantissa == 0)
     {
-		gchar *zero_str;
-		gchar *str_to_free;
-		gchar *tmp_str;
+		gchar zero_str[GSB_REAL_FORMAT_SEP_SIZE + 3] = "0";
 
-		str_to_free = gsb_locale_get_mon_decimal_point ();
-		zero_str = g_strconcat ("0", str_to_free, "00", NULL);
-		g_free (str_to_free);
+		if (locale -> mon_decimal_point)
+			g_snprintf (zero_str, sizeof (zero_str), "0%s00", locale -> mon_decimal_point);
 
         if (currency_symbol && locale -> p_cs_precedes)
-            tmp_str = g_strdup_printf ( "%s %s", currency_symbol, zero_str);
+            g_snprintf (buffer, buffer_size, "%s %s", currency_symbol, zero_str);
         else if (currency_symbol && ! locale -> p_cs_precedes)
-            tmp_str = g_strdup_printf ( "%s %s", zero_str, currency_symbol );
+            g_snprintf (buffer, buffer_size, "%s %s", zero_str, currency_symbol);
         else
-            tmp_str = g_strdup (zero_str);
-		g_free (zero_str);
+            g_strlcpy (buffer, zero_str, buffer_size);
 
-		return tmp_str;
+		return buffer;
     }
     else if ( (number.exponent < 0)
     || (number.exponent > EXPONENT_MAX )
     || (number.mantissa == error_real.mantissa) )
-        return g_strdup ( ERROR_REAL_STRING );
+    {
+        g_strlcpy (buffer, ERROR_REAL_STRING, buffer_size);
+
+        return buffer;
+    }
 
     /* first we need to adapt the exponent to the currency */
     /* if the exponent of the real is not the same of the currency, need to adapt it */
@@ -136,7 +218,35 @@ gchar *utils_real_get_string_with_currency ( GsbReal number,
     if ( currency_number && number.exponent != floating_point )
         number = gsb_real_adjust_exponent ( number, floating_point );
 
-    return gsb_real_raw_format_string ( number, locale, currency_symbol );
+    format = utils_real_get_currency_format (currency_symbol ? currency_number : 0, currency_symbol, locale);
+    gsb_real_raw_format_to_buffer ( number, format, buffer, buffer_size );
+
+    return buffer;
+}
+
+/**
+ * Return the real in a formatted string with an optional currency
+ * symbol, according to the locale regarding decimal separator,
+ * thousands separator and positive or negative sign.
+ *
+ * \param number		Number to format.
+ * \param currency_number 	the currency we want to adapt the number, 0 for no adaptation
+ * \param show_symbol 		TRUE to add the currency symbol in the string
+ *
+ * \return		A newly allocated string of the number (this
+ *			function will never return NULL)
+ */
+gchar *utils_real_get_string_with_currency ( GsbReal number,
+                        gint currency_number,
+                        gboolean show_symbol )
+{
+    gchar buffer[GSB_REAL_FORMAT_BUF_SIZE];
+
+    return g_strdup ( utils_real_write_string_with_currency ( number,
+                        currency_number,
+                        show_symbol,
+                        buffer,
+                        sizeof (buffer) ) );
 }
 
 
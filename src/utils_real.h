@@ -14,6 +14,12 @@ gchar *		utils_real_get_string_with_currency					(GsbReal number,
                         										 gint currency_number,
                         										 gboolean show_symbol);
 
+gchar *		utils_real_write_string_with_currency				(GsbReal number,
+                        										 gint currency_number,
+                        										 gboolean show_symbol,
+                        										 gchar *buffer,
+                        										 gsize buffer_size);
+
 gchar *		utils_real_get_string_with_currency_from_double		(gdouble number,
 																 gint account_number);
 
@@ -39,6 +39,8 @@
 #include "gsb_data_payee.h"
 #include "gsb_data_transaction.h"
 #include "gsb_file.h"
+#include "gsb_file_archive_segment.h"
+#include "gsb_search_index.h"
 #include "gsb_transactions_list.h"
 #include "menu.h"
 #include "navigation.h"
@@ -53,6 +55,9 @@
 /*END_INCLUDE*/
 
 /*START_STATIC*/
+/* nombre d'opérations examinées à chaque étape de la recherche globale */
+#define SEARCH_CHUNK_SIZE 2000
+
 static gint				search_active = -1;
 static gint				search_result = 0;
 static gint				last_transaction = -1;
@@ -78,6 +83,7 @@ struct _WidgetSearchTransactionPrivate
 	GtkWidget *			checkbutton_backwards_search;
 	GtkWidget *			checkbutton_delta_amount;
 	GtkWidget *			checkbutton_ignore_case;
+	GtkWidget *			checkbutton_search_all_accounts;
 	GtkWidget *			checkbutton_search_archive;
 	GtkWidget *			combo_other_account;
 	GtkWidget *			entry_search_str;
@@ -98,9 +104,20 @@ struct _WidgetSearchTransactionPrivate
 	gboolean			ignore_sign;
 	gboolean			search_archive;
 	gint				search_type;			/* 1 = payee, 2 = note, 3 = all, 4 = amount */
+	GsbReal				search_amount;			/* montant et écart recherchés */
+	GsbReal				search_delta;
 
 	GSList *			list;					/* liste des resultats de la recherche */
 
+	/* recherche dans tous les comptes */
+	gboolean			global_search;
+	guint				global_source_id;		/* étape en cours de la recherche, 0 si finie */
+	GArray *			global_candidates;		/* opérations à examiner */
+	guint				global_index;			/* prochaine opération à examiner */
+	gchar *				global_text;
+	guint				global_nb_found;		/* nombre d'opérations trouvées */
+	GHashTable *		global_ranked;			/* opérations trouvées par leur numéro ou leur chèque */
+
 	gboolean			file_is_modified;
 	glong				file_modified;
 
@@ -110,6 +127,30 @@ G_DEFINE_TYPE_WITH_PRIVATE (WidgetSearchTransaction, widget_search_transaction,
 /******************************************************************************/
 /* Private functions                                                          */
 /******************************************************************************/
+/**
+ * arrête la recherche dans tous les comptes, les opérations déjà trouvées
+ * restent dans la liste
+ *
+ * \param priv
+ *
+ * \return
+ **/
+static void widget_search_transaction_global_search_stop (WidgetSearchTransactionPrivate *priv)
+{
+	if (priv->global_source_id)
+	{
+		g_source_remove (priv->global_source_id);
+		priv->global_source_id = 0;
+	}
+	if (priv->global_candidates)
+	{
+		g_array_unref (priv->global_candidates);
+		priv->global_candidates = NULL;
+	}
+	g_free (priv->global_text);
+	priv->global_text = NULL;
+}
+
 /**
  * reset la recherche
  *
@@ -119,6 +160,14 @@ G_DEFINE_TYPE_WITH_PRIVATE (WidgetSearchTransaction, widget_search_transaction,
  **/
 static void widget_search_transaction_reset_search (WidgetSearchTransactionPrivate *priv)
 {
+	/* on arrête la recherche globale en cours */
+	widget_search_transaction_global_search_stop (priv);
+	if (priv->global_ranked)
+	{
+		g_hash_table_destroy (priv->global_ranked);
+		priv->global_ranked = NULL;
+	}
+
 	/* on retablit le bouton search */
 	gtk_button_set_image (GTK_BUTTON (priv->button_search), priv->image_search);
 	gtk_button_set_label (GTK_BUTTON (priv->button_search), _("Find"));
@@ -157,6 +206,19 @@ static gint widget_search_transaction_sort_result (gconstpointer a,
 	transaction_number_1 = GPOINTER_TO_INT (a);
 	transaction_number_2 = GPOINTER_TO_INT (b);
 
+	/* les opérations trouvées par leur numéro ou leur chèque sont affichées en premier,
+	 * donc à la fin de la liste */
+	if (priv->global_ranked)
+	{
+		gboolean ranked_1;
+		gboolean ranked_2;
+
+		ranked_1 = g_hash_table_contains (priv->global_ranked, a);
+		ranked_2 = g_hash_table_contains (priv->global_ranked, b);
+		if (ranked_1 != ranked_2)
+			return ranked_1 ? 1 : -1;
+	}
+
 	value_date_1 = gsb_data_transaction_get_value_date_or_date (transaction_number_1);
 	value_date_2 = gsb_data_transaction_get_value_date_or_date (transaction_number_2);
 
@@ -210,6 +272,43 @@ static void widget_search_transaction_select_archived (gint transaction_number,
 	transaction_list_select (transaction_number);
 }
 
+/**
+ * sélectionne une opération trouvée, en ouvrant son compte s'il n'est pas
+ * le compte affiché
+ *
+ * \param transaction_number
+ * \param priv
+ *
+ * \return TRUE if the transaction is archived
+ **/
+static gboolean widget_search_transaction_select_transaction (gint transaction_number,
+															  WidgetSearchTransactionPrivate *priv)
+{
+	gint account_number;
+	gint archive_number = 0;
+
+	account_number = gsb_data_transaction_get_account_number (transaction_number);
+	if (account_number != gsb_gui_navigation_get_current_account ())
+	{
+		gsb_gui_navigation_change_account (account_number);
+		widget_account_property_fill ();
+		gsb_gui_navigation_set_selection (GSB_ACCOUNT_PAGE, account_number, 0);
+		gsb_transactions_list_change_aspect_liste (1);
+	}
+
+	if (priv->search_archive)
+		archive_number = gsb_data_transaction_get_archive_number (transaction_number);
+	if (archive_number)
+	{
+		widget_search_transaction_select_archived (transaction_number, account_number, archive_number);
+
+		return TRUE;
+	}
+	transaction_list_select (transaction_number);
+
+	return FALSE;
+}
+
 /**
  *
  *
@@ -257,17 +356,14 @@ static gboolean widget_search_transaction_amount_is_valide (gint transaction_num
 {
 	GsbReal amount;
 
-	amount = utils_real_get_calculate_entry (priv->entry_search_str);
+	amount = priv->search_amount;
 	if (priv->delta_amount)
 	{
 		GsbReal number_sup;
 		GsbReal number_inf;
-		GsbReal spin_number;
 
-		spin_number = gsb_real_double_to_real (gtk_spin_button_get_value (GTK_SPIN_BUTTON
-																		  (priv->spinbutton_delta_amount)));
-		number_inf = gsb_real_sub (amount, spin_number);
-		number_sup = gsb_real_add (amount, spin_number);
+		number_inf = gsb_real_sub (amount, priv->search_delta);
+		number_sup = gsb_real_add (amount, priv->search_delta);
 
 		if (gsb_real_cmp (number, amount) == 0)
 			return TRUE;
@@ -414,6 +510,139 @@ static gboolean widget_search_transaction_str_is_valide (gint transaction_number
 	return FALSE;
 }
 
+/**
+ * test a transaction, the search by amount accepts the opposite amount
+ * if the sign is ignored
+ *
+ * \param transaction_number
+ * \param text
+ * \param priv
+ *
+ * \return TRUE if the transaction is found
+ **/
+static gboolean widget_search_transaction_is_valide (gint transaction_number,
+													 const gchar *text,
+													 WidgetSearchTransactionPrivate *priv)
+{
+	if (priv->search_type == 4)
+	{
+		GsbReal number;
+
+		number = gsb_data_transaction_get_adjusted_amount (transaction_number, -1);
+		if (widget_search_transaction_amount_is_valide (transaction_number, number, priv))
+			return TRUE;
+
+		return priv->ignore_sign
+			&& widget_search_transaction_amount_is_valide (transaction_number, gsb_real_opposite (number), priv);
+	}
+	else
+		return widget_search_transaction_str_is_valide (transaction_number, text, priv);
+}
+
+/**
+ * add a transaction given by the index to the result if it is in the
+ * account and the list searched and if it is valid
+ *
+ * \param list
+ * \param transaction_number
+ * \param account_number
+ * \param text
+ * \param priv
+ *
+ * \return the list
+ **/
+static GSList *widget_search_transaction_add_candidate (GSList *list,
+														gint transaction_number,
+														gint account_number,
+														const gchar *text,
+														WidgetSearchTransactionPrivate *priv)
+{
+	if (gsb_data_transaction_get_account_number (transaction_number) != account_number)
+		return list;
+	if (!priv->search_archive && !gsb_data_transaction_is_in_transactions_list (transaction_number))
+		return list;
+
+	if (widget_search_transaction_is_valide (transaction_number, text, priv))
+		list = g_slist_prepend (list, GINT_TO_POINTER (transaction_number));
+
+	return list;
+}
+
+/**
+ * return the transactions of the account whose absolute amount may be
+ * the searched amount, with the delta
+ *
+ * \param account_number
+ * \param priv
+ *
+ * \return a GArray of transaction numbers or NULL if the amount is not valid
+ **/
+static GArray *widget_search_transaction_get_amount_candidates (gint account_number,
+																WidgetSearchTransactionPrivate *priv)
+{
+	GsbReal number_inf;
+	GsbReal number_sup;
+	GsbReal abs_inf;
+	GsbReal abs_sup;
+
+	if (priv->search_amount.mantissa == error_real.mantissa
+		|| priv->search_delta.mantissa == error_real.mantissa)
+		return NULL;
+
+	number_inf = gsb_real_sub (priv->search_amount, gsb_real_abs (priv->search_delta));
+	number_sup = gsb_real_add (priv->search_amount, gsb_real_abs (priv->search_delta));
+	abs_inf = gsb_real_abs (number_inf);
+	abs_sup = gsb_real_abs (number_sup);
+
+	/* the same range is used with or without the sign */
+	if (number_inf.mantissa <= 0 && number_sup.mantissa >= 0)
+		return gsb_search_index_find_amount (account_number,
+											 null_real,
+											 gsb_real_cmp (abs_inf, abs_sup) > 0 ? abs_inf : abs_sup);
+	else if (gsb_real_cmp (abs_inf, abs_sup) > 0)
+		return gsb_search_index_find_amount (account_number, abs_sup, abs_inf);
+	else
+		return gsb_search_index_find_amount (account_number, abs_inf, abs_sup);
+}
+
+/**
+ * set the searched amount and delta from the entries
+ *
+ * \param priv
+ *
+ * \return
+ **/
+static void widget_search_transaction_init_search_amount (WidgetSearchTransactionPrivate *priv)
+{
+	priv->search_amount = utils_real_get_calculate_entry (priv->entry_search_str);
+	if (priv->delta_amount)
+		priv->search_delta = gsb_real_double_to_real (gtk_spin_button_get_value (GTK_SPIN_BUTTON
+																				 (priv->spinbutton_delta_amount)));
+	else
+		priv->search_delta = null_real;
+}
+
+/**
+ * return the transactions which may contain the text in the searched fields
+ *
+ * \param text
+ * \param priv
+ *
+ * \return a set of transaction numbers or NULL if the index can't be used
+ **/
+static GHashTable *widget_search_transaction_get_text_candidates (const gchar *text,
+																  WidgetSearchTransactionPrivate *priv)
+{
+	if (priv->search_type == 1)
+		return gsb_search_index_find (text, SEARCH_FIELD_PAYEE);
+	else if (priv->search_type == 2)
+		return gsb_search_index_find (text, SEARCH_FIELD_NOTES);
+	else if (priv->search_type == 3)
+		return gsb_search_index_find (text, SEARCH_FIELD_PAYEE | SEARCH_FIELD_NOTES);
+
+	return NULL;
+}
+
 /**
  *
  *
@@ -427,47 +656,62 @@ static GSList *widget_search_transaction_get_list (gint account_number,
 												   WidgetSearchTransaction *dialog)
 {
 	GSList *list = NULL;
-	GSList *tmp_list;
+	GHashTable *candidates = NULL;
+	GArray *amount_candidates = NULL;
 	WidgetSearchTransactionPrivate *priv;
 
 	priv = widget_search_transaction_get_instance_private (dialog);
-	if (priv->search_archive)
-		tmp_list = gsb_data_transaction_get_complete_transactions_list ();
+
+	/* the index gives the transactions which may be found */
+	if (priv->search_type == 4)
+	{
+		widget_search_transaction_init_search_amount (priv);
+		amount_candidates = widget_search_transaction_get_amount_candidates (account_number, priv);
+	}
 	else
-		tmp_list = gsb_data_transaction_get_transactions_list ();
-	while (tmp_list)
+		candidates = widget_search_transaction_get_text_candidates (text, priv);
+
+	if (amount_candidates)
 	{
-		gint transaction_number;
-		TransactionStruct *transaction;
+		guint i;
+
+		for (i = 0; i < amount_candidates->len; i++)
+			list = widget_search_transaction_add_candidate (list,
+															g_array_index (amount_candidates, gint, i),
+															account_number,
+															text,
+															priv);
+		g_array_unref (amount_candidates);
+	}
+	else if (candidates)
+	{
+		GHashTableIter iter;
+		gpointer key;
 
-		transaction = tmp_list->data;
+		g_hash_table_iter_init (&iter, candidates);
+		while (g_hash_table_iter_next (&iter, &key, NULL))
+			list = widget_search_transaction_add_candidate (list, GPOINTER_TO_INT (key), account_number, text, priv);
+		g_hash_table_destroy (candidates);
+	}
+	else
+	{
+		GSList *tmp_list;
 
-		transaction_number = gsb_data_transaction_get_transaction_number (transaction);
-		if (gsb_data_transaction_get_account_number (transaction_number) == account_number)
+		if (priv->search_archive)
+			tmp_list = gsb_data_transaction_get_complete_transactions_list ();
+		else
+			tmp_list = gsb_data_transaction_get_transactions_list ();
+		while (tmp_list)
 		{
-			if (priv->search_type == 4)
-			{
-				GsbReal number;
+			gint transaction_number;
 
-				number = gsb_data_transaction_get_adjusted_amount (transaction_number, -1);
-				if (widget_search_transaction_amount_is_valide (transaction_number, number, priv))
-				{
-					list = g_slist_append (list, GINT_TO_POINTER (transaction_number));
-				}
-				if (priv->ignore_sign)
-				{
-					if (widget_search_transaction_amount_is_valide (transaction_number, gsb_real_opposite (number), priv))
-					{
-						list = g_slist_append (list, GINT_TO_POINTER (transaction_number));
-					}
-				}
-			}
-			else if (widget_search_transaction_str_is_valide (transaction_number, text, priv))
-			{
-				list = g_slist_append (list, GINT_TO_POINTER (transaction_number));
-			}
+			transaction_number = gsb_data_transaction_get_transaction_number (tmp_list->data);
+			if (gsb_data_transaction_get_account_number (transaction_number) == account_number
+				&& widget_search_transaction_is_valide (transaction_number, text, priv))
+				list = g_slist_prepend (list, GINT_TO_POINTER (transaction_number));
+
+			tmp_list = tmp_list->next;
 		}
-		tmp_list = tmp_list->next;
 	}
 
 	/* tri de la liste en fonction des dates */
@@ -476,6 +720,442 @@ static GSList *widget_search_transaction_get_list (gint account_number,
 	return list;
 }
 
+/**
+ * sélectionne la première opération trouvée, à la fin de la liste
+ *
+ * \param priv
+ *
+ * \return
+ **/
+static void widget_search_transaction_select_first (WidgetSearchTransactionPrivate *priv)
+{
+	gint transaction_number;
+
+	/* on change eventuellement l'affichage pour une ligne */
+	gsb_transactions_list_change_aspect_liste (1);
+	if (!priv->file_is_modified)
+	{
+		GrisbiWinRun *w_run;
+
+		w_run = (GrisbiWinRun *) grisbi_win_get_w_run ();
+		priv->file_modified = w_run->file_modification;
+	}
+
+	transaction_number = GPOINTER_TO_INT (g_slist_last (priv->list)->data);
+	if (widget_search_transaction_select_transaction (transaction_number, priv))
+		gsb_transactions_list_set_visible_archived_button (TRUE);
+}
+
+/**
+ * affiche le résultat de la recherche et sélectionne la première opération
+ * trouvée, sauf si la recherche globale en a déjà sélectionné une
+ *
+ * \param dialog
+ *
+ * \return
+ **/
+static void widget_search_transaction_show_result (WidgetSearchTransaction *dialog)
+{
+	gchar *tmp_str;
+	WidgetSearchTransactionPrivate *priv;
+
+	priv = widget_search_transaction_get_instance_private (dialog);
+
+	search_result = g_slist_length (priv->list);
+	if (search_result > 0)
+	{
+		gchar *str_number;
+
+		/* on affiche le résultat */
+		str_number = utils_str_itoa (search_result);
+		if (search_result == 1)
+			tmp_str = g_strdup (_("1 transaction were found"));
+		else
+			tmp_str = g_strconcat (str_number, _(" transactions were found"), NULL);
+		g_free (str_number);
+
+		if (search_active < 0)
+		{
+			widget_search_transaction_select_first (priv);
+			search_active = search_result - 1;
+		}
+
+		/* on modifie le bouton search */
+		gtk_button_set_image (GTK_BUTTON (priv->button_search), priv->image_search);
+		gtk_button_set_label (GTK_BUTTON (priv->button_search), _("Close"));
+
+		/* on initialise les boutons next et previous si search_result > 1 */
+		if (search_result > 1)
+		{
+			gtk_button_set_image (GTK_BUTTON (priv->button_search), priv->image_cancel);
+			gtk_widget_set_sensitive (priv->button_next, search_active > 0);
+			gtk_widget_set_sensitive (priv->button_previous, search_active < search_result - 1);
+		}
+
+		/* on desensibilise le combo other_account */
+		gtk_widget_set_sensitive (priv->box_other_account, FALSE);
+	}
+	else
+	{
+		tmp_str = g_strdup (_("No transaction was found"));
+		gtk_button_set_image (GTK_BUTTON (priv->button_search), priv->image_search);
+		gtk_button_set_label (GTK_BUTTON (priv->button_search), _("Find"));
+		gtk_widget_set_sensitive (priv->box_other_account, !priv->global_search);
+		search_active = -1;
+	}
+
+	/* set info label text */
+	gtk_label_set_text (GTK_LABEL (priv->label_search_info), tmp_str);
+	g_free (tmp_str);
+
+	/* on affiche le resultat */
+	gtk_widget_show (priv->box_result);
+}
+
+/**
+ * add a transaction found by its number or its cheque to the result,
+ * it is shown before the others
+ *
+ * \param transaction_number
+ * \param priv
+ *
+ * \return
+ **/
+static void widget_search_transaction_add_ranked (gint transaction_number,
+												  WidgetSearchTransactionPrivate *priv)
+{
+	if (g_hash_table_contains (priv->global_ranked, GINT_TO_POINTER (transaction_number)))
+		return;
+	if (!priv->search_archive && !gsb_data_transaction_is_in_transactions_list (transaction_number))
+		return;
+
+	g_hash_table_add (priv->global_ranked, GINT_TO_POINTER (transaction_number));
+	priv->list = g_slist_prepend (priv->list, GINT_TO_POINTER (transaction_number));
+	priv->global_nb_found++;
+}
+
+/**
+ * find the transaction whose number is the text and the transactions
+ * whose cheque number is the text
+ *
+ * \param text
+ * \param priv
+ *
+ * \return
+ **/
+static void widget_search_transaction_find_ranked (const gchar *text,
+												   WidgetSearchTransactionPrivate *priv)
+{
+	GHashTable *cheques;
+	const gchar *ptr;
+
+	for (ptr = text; g_ascii_isdigit (*ptr); ptr++);
+	if (*ptr == 0)
+	{
+		gint transaction_number;
+
+		transaction_number = utils_str_atoi (text);
+		if (transaction_number > 0 && gsb_data_transaction_get_pointer_of_transaction (transaction_number))
+			widget_search_transaction_add_ranked (transaction_number, priv);
+	}
+
+	cheques = gsb_search_index_find (text, SEARCH_FIELD_CHEQUE);
+	if (cheques)
+	{
+		GHashTableIter iter;
+		gpointer key;
+
+		g_hash_table_iter_init (&iter, cheques);
+		while (g_hash_table_iter_next (&iter, &key, NULL))
+		{
+			const gchar *content;
+
+			content = gsb_data_transaction_get_method_of_payment_content (GPOINTER_TO_INT (key));
+			if (content && strcmp (content, text) == 0)
+				widget_search_transaction_add_ranked (GPOINTER_TO_INT (key), priv);
+		}
+		g_hash_table_destroy (cheques);
+	}
+}
+
+/**
+ * return the transactions of all the accounts which may be found
+ *
+ * \param text
+ * \param priv
+ *
+ * \return a GArray of transaction numbers
+ **/
+static GArray *widget_search_transaction_get_global_candidates (const gchar *text,
+																WidgetSearchTransactionPrivate *priv)
+{
+	GArray *candidates;
+	GHashTable *text_candidates = NULL;
+	GSList *tmp_list;
+	gboolean indexed = FALSE;
+
+	candidates = g_array_new (FALSE, FALSE, sizeof (gint));
+
+	if (priv->search_type == 4)
+	{
+		widget_search_transaction_init_search_amount (priv);
+
+		tmp_list = gsb_data_account_get_list_accounts ();
+		indexed = TRUE;
+		while (tmp_list && indexed)
+		{
+			GArray *amount_candidates;
+
+			amount_candidates = widget_search_transaction_get_amount_candidates
+				(gsb_data_account_get_no_account (tmp_list->data), priv);
+			if (amount_candidates)
+			{
+				g_array_append_vals (candidates, amount_candidates->data, amount_candidates->len);
+				g_array_unref (amount_candidates);
+			}
+			else
+				indexed = FALSE;
+
+			tmp_list = tmp_list->next;
+		}
+	}
+	else
+		text_candidates = widget_search_transaction_get_text_candidates (text, priv);
+
+	if (text_candidates)
+	{
+		GHashTableIter iter;
+		gpointer key;
+
+		g_hash_table_iter_init (&iter, text_candidates);
+		while (g_hash_table_iter_next (&iter, &key, NULL))
+		{
+			gint transaction_number;
+
+			transaction_number = GPOINTER_TO_INT (key);
+			g_array_append_val (candidates, transaction_number);
+		}
+		g_hash_table_destroy (text_candidates);
+	}
+	else if (!indexed)
+	{
+		/* the index can't be used, all the transactions are checked */
+		g_array_set_size (candidates, 0);
+		if (priv->search_archive)
+			tmp_list = gsb_data_transaction_get_complete_transactions_list ();
+		else
+			tmp_list = gsb_data_transaction_get_transactions_list ();
+		while (tmp_list)
+		{
+			gint transaction_number;
+
+			transaction_number = gsb_data_transaction_get_transaction_number (tmp_list->data);
+			g_array_append_val (candidates, transaction_number);
+
+			tmp_list = tmp_list->next;
+		}
+	}
+
+	return candidates;
+}
+
+/**
+ * affiche le nombre d'opérations trouvées pendant la recherche globale
+ *
+ * \param priv
+ *
+ * \return
+ **/
+static void widget_search_transaction_global_search_update_info (WidgetSearchTransactionPrivate *priv)
+{
+	gchar *tmp_str;
+
+	tmp_str = g_strdup_printf (_("Search in progress: %u transactions found"), priv->global_nb_found);
+	gtk_label_set_text (GTK_LABEL (priv->label_search_info), tmp_str);
+	g_free (tmp_str);
+}
+
+/**
+ * ajoute à la liste triée les opérations trouvées par un paquet de la
+ * recherche globale. La première opération trouvée est sélectionnée
+ * aussitôt, ensuite la sélection est gardée et les boutons next et
+ * previous suivent la liste pendant la recherche
+ *
+ * \param found		les opérations trouvées, libérée par la fonction
+ * \param priv
+ *
+ * \return
+ **/
+static void widget_search_transaction_global_search_add_found (GSList *found,
+															   WidgetSearchTransactionPrivate *priv)
+{
+	GSList *merged = NULL;
+	GSList *tmp_list;
+	GSList *tmp_found;
+	gpointer current = NULL;
+
+	if (!found)
+		return;
+
+	if (search_active >= 0)
+		current = g_slist_nth_data (priv->list, search_active);
+
+	/* tri : les opérations trouvées par leur numéro ou leur chèque
+	 * puis les autres en fonction des dates */
+	found = g_slist_sort_with_data (found, (GCompareDataFunc) widget_search_transaction_sort_result, priv);
+	tmp_list = priv->list;
+	tmp_found = found;
+	while (tmp_list || tmp_found)
+	{
+		if (tmp_found
+			&& (!tmp_list || widget_search_transaction_sort_result (tmp_found->data, tmp_list->data, priv) < 0))
+		{
+			merged = g_slist_prepend (merged, tmp_found->data);
+			tmp_found = tmp_found->next;
+		}
+		else
+		{
+			merged = g_slist_prepend (merged, tmp_list->data);
+			tmp_list = tmp_list->next;
+		}
+	}
+	g_slist_free (priv->list);
+	g_slist_free (found);
+	priv->list = g_slist_reverse (merged);
+
+	search_result = g_slist_length (priv->list);
+	if (current)
+		search_active = g_slist_index (priv->list, current);
+	else
+	{
+		widget_search_transaction_select_first (priv);
+		search_active = search_result - 1;
+	}
+
+	gtk_widget_set_sensitive (priv->button_next, search_active > 0);
+	gtk_widget_set_sensitive (priv->button_previous, search_active < search_result - 1);
+}
+
+/**
+ * arrête la recherche dans tous les comptes et affiche le résultat
+ *
+ * \param dialog
+ *
+ * \return
+ **/
+static void widget_search_transaction_global_search_finish (WidgetSearchTransaction *dialog)
+{
+	WidgetSearchTransactionPrivate *priv;
+
+	priv = widget_search_transaction_get_instance_private (dialog);
+
+	widget_search_transaction_global_search_stop (priv);
+
+	/* la liste est déjà triée par widget_search_transaction_global_search_add_found */
+	widget_search_transaction_show_result (dialog);
+}
+
+/**
+ * examine un paquet d'opérations de la recherche globale
+ *
+ * \param dialog
+ *
+ * \return TRUE tant qu'il reste des opérations à examiner
+ **/
+static gboolean widget_search_transaction_global_search_step (WidgetSearchTransaction *dialog)
+{
+	GSList *found = NULL;
+	guint end;
+	WidgetSearchTransactionPrivate *priv;
+
+	priv = widget_search_transaction_get_instance_private (dialog);
+
+	end = MIN (priv->global_index + SEARCH_CHUNK_SIZE, priv->global_candidates->len);
+	for (; priv->global_index < end; priv->global_index++)
+	{
+		gint transaction_number;
+
+		transaction_number = g_array_index (priv->global_candidates, gint, priv->global_index);
+		if (g_hash_table_contains (priv->global_ranked, GINT_TO_POINTER (transaction_number)))
+			continue;
+		if (!priv->search_archive && !gsb_data_transaction_is_in_transactions_list (transaction_number))
+			continue;
+
+		if (widget_search_transaction_is_valide (transaction_number, priv->global_text, priv))
+		{
+			found = g_slist_prepend (found, GINT_TO_POINTER (transaction_number));
+			priv->global_nb_found++;
+		}
+	}
+
+	/* les opérations trouvées peuvent être parcourues sans attendre la fin */
+	widget_search_transaction_global_search_add_found (found, priv);
+
+	if (priv->global_index < priv->global_candidates->len)
+	{
+		widget_search_transaction_global_search_update_info (priv);
+
+		return TRUE;
+	}
+
+	/* the source is removed by the return value */
+	priv->global_source_id = 0;
+	widget_search_transaction_global_search_finish (dialog);
+
+	return FALSE;
+}
+
+/**
+ * lance la recherche dans tous les comptes. Les opérations sont examinées
+ * par paquets dans la boucle principale pour que la fenêtre reste utilisable
+ * et que la recherche puisse être arrêtée
+ *
+ * \param dialog
+ * \param text
+ *
+ * \return
+ **/
+static void widget_search_transaction_global_search_start (WidgetSearchTransaction *dialog,
+														   const gchar *text)
+{
+	GSList *found;
+	WidgetSearchTransactionPrivate *priv;
+
+	priv = widget_search_transaction_get_instance_private (dialog);
+
+	widget_search_transaction_global_search_stop (priv);
+	g_slist_free (priv->list);
+	priv->list = NULL;
+	priv->global_nb_found = 0;
+	if (priv->global_ranked)
+		g_hash_table_remove_all (priv->global_ranked);
+	else
+		priv->global_ranked = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+	priv->global_text = g_strdup (text);
+	priv->global_candidates = widget_search_transaction_get_global_candidates (text, priv);
+	priv->global_index = 0;
+
+	/* the transaction with this number and the cheques with this number are found first */
+	if (priv->search_type != 4)
+		widget_search_transaction_find_ranked (text, priv);
+
+	/* le bouton search arrête la recherche */
+	gtk_button_set_image (GTK_BUTTON (priv->button_search), priv->image_cancel);
+	gtk_button_set_label (GTK_BUTTON (priv->button_search), _("Stop"));
+	gtk_widget_set_sensitive (priv->box_other_account, FALSE);
+
+	widget_search_transaction_global_search_update_info (priv);
+	gtk_widget_show (priv->box_result);
+
+	/* les opérations trouvées par leur numéro ou leur chèque sont sélectionnées tout de suite */
+	found = priv->list;
+	priv->list = NULL;
+	widget_search_transaction_global_search_add_found (found, priv);
+
+	priv->global_source_id = g_idle_add ((GSourceFunc) widget_search_transaction_global_search_step, dialog);
+}
+
 /**
  *
  *
@@ -488,15 +1168,9 @@ static void widget_search_transaction_button_next_clicked (GtkButton *button,
 														   WidgetSearchTransactionPrivate *priv)
 {
 	gint transaction_number;
-	gint archive_number = 0;
 
 	transaction_number = GPOINTER_TO_INT (g_slist_nth_data (priv->list, search_active-1));
-	if (priv->search_archive)
-		archive_number = gsb_data_transaction_get_archive_number (transaction_number);
-	if (archive_number)
-		widget_search_transaction_select_archived (transaction_number, priv->account_number, archive_number);
-	else
-		transaction_list_select (transaction_number);
+	widget_search_transaction_select_transaction (transaction_number, priv);
 	search_active--;
 
 	if (search_active == search_result - 1)
@@ -522,15 +1196,9 @@ static void widget_search_transaction_button_previous_clicked (GtkButton *button
 															   WidgetSearchTransactionPrivate *priv)
 {
 	gint transaction_number;
-	gint archive_number = 0;
 
 	transaction_number = GPOINTER_TO_INT (g_slist_nth_data (priv->list, search_active+1));
-	if (priv->search_archive)
-		archive_number = gsb_data_transaction_get_archive_number (transaction_number);
-	if (archive_number)
-		widget_search_transaction_select_archived (transaction_number, priv->account_number, archive_number);
-	else
-		transaction_list_select (transaction_number);
+	widget_search_transaction_select_transaction (transaction_number, priv);
 	search_active++;
 
 	if (search_active == search_result - 1)
@@ -556,13 +1224,18 @@ static void widget_search_transaction_button_search_clicked (GtkButton *button,
 															 WidgetSearchTransaction *dialog)
 {
 	const gchar *text;
-	gchar *tmp_str;
-	gint transaction_number;
-	gint archive_number = 0;
 	WidgetSearchTransactionPrivate *priv;
 
 	priv = widget_search_transaction_get_instance_private (dialog);
 
+	/* le bouton arrête la recherche globale en cours, les opérations trouvées sont affichées */
+	if (priv->global_source_id)
+	{
+		widget_search_transaction_global_search_finish (dialog);
+
+		return;
+	}
+
 	/* regarde si on a un text avant toute chose */
 	text = gtk_entry_get_text (GTK_ENTRY (priv->entry_search_str));
 	if (strlen (text) == 0)
@@ -585,73 +1258,20 @@ static void widget_search_transaction_button_search_clicked (GtkButton *button,
 
 	if (search_active == -1)
 	{
-		/* on remplit list */
-		priv->list = widget_search_transaction_get_list (priv->account_number, text, WIDGET_SEARCH_TRANSACTION (dialog));
-		search_active = g_slist_length (priv->list);
-		search_result = search_active;
-		if (search_active > 0)
-		{
-			gchar *str_number;
-
-			/* on change eventuellement l'affichage pour une ligne */
-			gsb_transactions_list_change_aspect_liste (1);
-			if (!priv->file_is_modified)
-			{
-				GrisbiWinRun *w_run;
-
-				w_run = (GrisbiWinRun *) grisbi_win_get_w_run ();
-				priv->file_modified = w_run->file_modification;
-			}
+		/* the archived transactions out of memory are loaded to be searched */
+		if (priv->search_archive)
+			gsb_file_archive_segment_load ();
 
-			/* on affiche le résultat */
-			str_number = utils_str_itoa (search_active);
-			if (search_active == 1)
-				tmp_str = g_strdup (_("1 transaction were found"));
-			else
-				tmp_str = g_strconcat (str_number, _(" transactions were found"), NULL);
-			g_free (str_number);
-
-			transaction_number = GPOINTER_TO_INT (g_slist_nth_data (priv->list, search_active-1));
-			if (priv->search_archive)
-				archive_number = gsb_data_transaction_get_archive_number (transaction_number);
-			if (archive_number)
-			{
-				widget_search_transaction_select_archived (transaction_number, priv->account_number, archive_number);
-				gsb_transactions_list_set_visible_archived_button (TRUE);
-			}
-			else
-				transaction_list_select (transaction_number);
-
-			/* on modifie le bouton search */
-			gtk_button_set_label (GTK_BUTTON (priv->button_search), _("Close"));
-
-			/* on initialise les boutons next et previous si search_active > 1 */
-			if (search_active > 1)
-			{
-				gtk_button_set_image (GTK_BUTTON (priv->button_search), priv->image_cancel);
-				gtk_widget_set_sensitive (priv->button_next, TRUE);
-				gtk_widget_set_sensitive (priv->button_previous, FALSE);
-			}
-
-			/* on desensibilise le combo other_account */
-			gtk_widget_set_sensitive (priv->box_other_account, FALSE);
-
-			/* on prépare la suite */
-			search_active--;
-		}
-		else
+		if (priv->global_search)
 		{
-			tmp_str = g_strdup (_("No transaction was found"));
-			gtk_widget_set_sensitive (priv->box_other_account, TRUE);
-			search_active = -1;
-		}
+			widget_search_transaction_global_search_start (dialog, text);
 
-		/* set info label text */
-		gtk_label_set_text (GTK_LABEL (priv->label_search_info), tmp_str);
-		g_free (tmp_str);
+			return;
+		}
 
-		/* on affiche le resultat */
-		gtk_widget_show (priv->box_result);
+		/* on remplit list */
+		priv->list = widget_search_transaction_get_list (priv->account_number, text, WIDGET_SEARCH_TRANSACTION (dialog));
+		widget_search_transaction_show_result (dialog);
 	}
 	else /* on ferme la fenêtre de recherche */
 	{
@@ -718,6 +1338,23 @@ static void widget_search_transaction_checkbutton_ignore_case_sign_toggled (GtkT
 	widget_search_transaction_reset_search (priv);
 }
 
+/**
+ *
+ *
+ * \param
+ * \param
+ *
+ * \return
+ **/
+static void widget_search_transaction_checkbutton_search_all_accounts_toggled (GtkToggleButton *togglebutton,
+																			   WidgetSearchTransactionPrivate *priv)
+{
+	priv->global_search = gtk_toggle_button_get_active (togglebutton);
+
+	/* on reinitialise la recherche */
+	widget_search_transaction_reset_search (priv);
+}
+
 /**
  *
  *
@@ -1113,6 +1750,10 @@ static void widget_search_transaction_setup_dialog (WidgetSearchTransaction *dia
 					  "toggled",
 					  G_CALLBACK (widget_search_transaction_checkbutton_ignore_case_sign_toggled),
 					  priv);
+	g_signal_connect (G_OBJECT (priv->checkbutton_search_all_accounts),
+					  "toggled",
+					  G_CALLBACK (widget_search_transaction_checkbutton_search_all_accounts_toggled),
+					  priv);
 	g_signal_connect (G_OBJECT (priv->checkbutton_search_archive),
 					  "toggled",
 					  G_CALLBACK (widget_search_transaction_checkbutton_search_archive_toggled),
@@ -1163,6 +1804,14 @@ static void widget_search_transaction_dispose (GObject *object)
 
 	priv = widget_search_transaction_get_instance_private (WIDGET_SEARCH_TRANSACTION (object));
 
+	/* on arrête la recherche globale en cours */
+	widget_search_transaction_global_search_stop (priv);
+	if (priv->global_ranked)
+	{
+		g_hash_table_destroy (priv->global_ranked);
+		priv->global_ranked = NULL;
+	}
+
 	/* On recupere le numero de la derniere transaction */
 	if (last_transaction == -1)
 	{
@@ -1205,6 +1854,7 @@ static void widget_search_transaction_class_init (WidgetSearchTransactionClass *
 	gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), WidgetSearchTransaction, checkbutton_backwards_search);
 	gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), WidgetSearchTransaction, checkbutton_delta_amount);
 	gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), WidgetSearchTransaction, checkbutton_ignore_case);
+	gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), WidgetSearchTransaction, checkbutton_search_all_accounts);
 	gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), WidgetSearchTransaction, checkbutton_search_archive);
 	gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), WidgetSearchTransaction, combo_other_account);
 	gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), WidgetSearchTransaction, entry_search_str);